@@ -16,17 +16,42 @@ include $(N64_INST)/include/t3d.mk
 N64_CXXFLAGS += -std=gnu++20 -ftrivial-auto-var-init=uninitialized -fno-exceptions -Os -Isrc -Isrc/user \
 	-I$(ENGINE_DIR)/include
 
+# heap allocation tracking ('make P64_ALLOC_TRACK=1'), hooks all allocations at link time, see 'debug/allocTracker.h'
+ifeq ($(P64_ALLOC_TRACK),1)
+N64_CXXFLAGS += -DP64_ALLOC_TRACK=1
+N64_LDFLAGS += --wrap=malloc --wrap=calloc --wrap=realloc --wrap=memalign --wrap=free
+endif
+
+# joypad input recording/replay ('make P64_INPUT_REPLAY=1'), hooks the joypad getters at link time, see 'debug/inputReplay.h'
+ifeq ($(P64_INPUT_REPLAY),1)
+N64_CXXFLAGS += -DP64_INPUT_REPLAY=1
+N64_LDFLAGS += --wrap=joypad_poll --wrap=joypad_is_connected --wrap=joypad_get_inputs --wrap=joypad_get_buttons \
+	--wrap=joypad_get_buttons_pressed --wrap=joypad_get_buttons_released --wrap=joypad_get_buttons_held \
+	--wrap=joypad_get_direction
+endif
+
+# scene load-time report ('make P64_LOAD_REPORT=1'), hooks the PI DMA reads at link time, see 'debug/loadReport.h'
+ifeq ($(P64_LOAD_REPORT),1)
+N64_CXXFLAGS += -DP64_LOAD_REPORT=1
+N64_LDFLAGS += --wrap=dma_read --wrap=dma_read_async --wrap=dma_wait
+endif
+
 # Allow custom attributes, otherwise GCC (rightfully) complains unknown ones
 $(BUILD_DIR)/src/user/%.o: N64_CXXFLAGS += -Wno-attributes
 
 src =  $(wildcard src/*.cpp) $(wildcard src/p64/*.cpp) $(wildcard src/user/*.cpp)
 
-{{USER_CODE_DIRS}}
+# generated as well, but kept apart so changes to them don't need a clean build
+include Makefile.code
+include Makefile.assets
 
 all: $(ROM_NAME).z64
 
 include Makefile.custom
 
+# only the conversions, used before patching them into the last ROM (see 'Build::patchRom')
+assets: $(assets_conv)
+
 $(src): $(ENGINE_DIR)/build/engine.a
 
 $(ENGINE_DIR)/build/engine.a: FORCE
@@ -35,7 +60,6 @@ FORCE: ;
 
 AUDIOCONV_FLAGS = --wav-resample 24000 --wav-compress 1
 
-assets_conv = {{ASSET_LIST}}
 assets_conv += filesystem/p64/font.ia4.sprite
 
 # Images
@@ -49,13 +73,27 @@ filesystem/p64/%: assets/p64/%
 	@echo "    [P64-BIN] $@"
 	$(N64_BINDIR)/mkasset -c 1 -w 256 -o $(dir $@) "$<"
 
+# packed from hard-links, without outputs that are identical to another asset (see 'assets_dedup')
 build/%.dfs:
 	@mkdir -p $(dir $@)
 	@echo "    [DFS*] $@ $(<D)"
-	$(N64_MKDFS) $@ filesystem >/dev/null
-
-$(BUILD_DIR)/$(ROM_NAME).dfs: $(assets_conv)
-$(BUILD_DIR)/$(ROM_NAME).elf: $(src:%.cpp=$(BUILD_DIR)/%.o) $(ENGINE_DIR)/build/engine.a
+	@rm -rf $(BUILD_DIR)/dfs && cp -rl filesystem $(BUILD_DIR)/dfs
+	@rm -f $(assets_dedup:filesystem/%=$(BUILD_DIR)/dfs/%)
+	$(N64_MKDFS) $@ $(BUILD_DIR)/dfs >/dev/null
+
+# per-scene script overlays (see 'Makefile.code'), their scripts are not linked into the main binary.
+# in a unity build, the combined sources replace the ones they include ('src_unity_parts')
+src_main = $(filter-out $(src_overlay) $(src_unity_parts),$(src))
+ifneq ($(DSO_LIST),)
+MAIN_ELF_EXTERNS := $(BUILD_DIR)/$(ROM_NAME).externs
+$(MAIN_ELF_EXTERNS): $(DSO_LIST)
+$(BUILD_DIR)/$(ROM_NAME).msym: $(BUILD_DIR)/$(ROM_NAME).elf
+$(ROM_NAME).z64: $(BUILD_DIR)/$(ROM_NAME).msym
+endif
+
+# removed assets don't change any file, the list itself does
+$(BUILD_DIR)/$(ROM_NAME).dfs: $(assets_conv) Makefile.assets $(DSO_LIST)
+$(BUILD_DIR)/$(ROM_NAME).elf: $(src_main:%.cpp=$(BUILD_DIR)/%.o) $(ENGINE_DIR)/build/engine.a $(MAIN_ELF_EXTERNS)
 
 $(ROM_NAME).z64: N64_ROM_TITLE="{{PROJECT_NAME}}"
 $(ROM_NAME).z64: $(BUILD_DIR)/$(ROM_NAME).dfs
@@ -76,4 +114,4 @@ p64:
 
 -include $(wildcard $(BUILD_DIR)/src/*.d)
 
-.PHONY: all clean
+.PHONY: all assets clean
@@ -9,6 +9,21 @@ namespace P64::Assets
     {{ASSET_MAP}}
     assertf(false, "Asset unknown!");
   }
+
+  struct AtlasRegion
+  {
+    uint16_t s, t, width, height;
+  };
+
+  /**
+   * Region of an image inside its atlas, or the entire sprite (all 0) for images not in one.
+   * Images packed into an atlas load the atlas sprite instead, pass this as the region to 'Batch2D::sprite'.
+   */
+  consteval AtlasRegion getAtlasRegion(std::string_view path)
+  {
+    {{ATLAS_MAP}}
+    return {0, 0, 0, 0};
+  }
 }
 
 consteval uint32_t operator"" _asset(const char *str, size_t len) {
@@ -8,7 +8,9 @@ namespace P64::GlobalScript
 {
   __CODE_DECL__
 
-  void callHooks(HookType type)
+  const uint32_t HOOK_MASK = __HOOK_MASK__;
+
+  void dispatchHooks(HookType type)
   {
     switch (type)
     {
@@ -12,6 +12,9 @@ namespace P64::SceneManager
   }
 
   extern const char* SCENE_NAMES[{{SCENE_COUNT}}];
+  extern const uint16_t SCENE_IDS[{{SCENE_COUNT}}];
+  extern const uint32_t SCENE_HASH_MASK;
+  extern const uint16_t SCENE_HASH_SLOTS[];
 }
 
 consteval uint16_t operator"" _scene(const char *str, size_t len) {
@@ -0,0 +1,16 @@
+// NOTE: Auto-Generated File!
+// Scripts used by this scene, linked into its overlay (DSO) instead of the main binary
+
+#include <script/scriptTable.h>
+
+namespace P64 { class Object; }
+
+namespace P64::Script
+{
+__CODE_DECL__
+
+  extern "C" void p64RegisterScripts(ScriptEntry* table, uint16_t* sizeTable)
+  {
+__CODE_REGISTER__
+  }
+}
@@ -2,6 +2,7 @@
 
 #include <script/scriptTable.h>
 #include <script/nodeGraph.h>
+#include <dlfcn.h>
 
 namespace P64 { class Object; }
 
@@ -39,6 +40,81 @@ __CODE_SIZE_ENTRIES__
     return 0;
   }
 
+  // user functions called by node graphs, sorted by the CRC32 of their name.
+  // The last entry only exists so the table is never empty, and is not part of the search
+  constexpr uint32_t userFuncHashes[] = {
+__USER_FUNC_HASHES__
+    0xFFFF'FFFF
+  };
+  constexpr uint32_t USER_FUNC_COUNT = sizeof(userFuncHashes)/sizeof(userFuncHashes[0]) - 1;
+
+  constinit NodeGraph::UserFunc userFuncSlots[USER_FUNC_COUNT + 1]{};
+
+  NodeGraph::UserFunc* getUserFuncSlot(uint32_t strCRC32)
+  {
+    uint32_t left = 0;
+    uint32_t right = USER_FUNC_COUNT;
+    while(left < right)
+    {
+      uint32_t mid = (left + right) / 2;
+      if(userFuncHashes[mid] < strCRC32) {
+        left = mid + 1;
+      } else {
+        right = mid;
+      }
+    }
+    if(left < USER_FUNC_COUNT && userFuncHashes[left] == strCRC32) {
+      return &userFuncSlots[left];
+    }
+    return nullptr;
+  }
+
+  // scenes with an overlay (DSO), and the scripts only linked into overlays.
+  // The last entries only exist so the tables are never empty, and are not part of the search
+  constexpr uint16_t overlayScenes[] = {
+__OVERLAY_SCENES__
+    0xFFFF
+  };
+  constexpr uint32_t OVERLAY_SCENE_COUNT = sizeof(overlayScenes)/sizeof(overlayScenes[0]) - 1;
+
+  constexpr uint16_t overlayScripts[] = {
+__OVERLAY_SCRIPTS__
+    0xFFFF
+  };
+  constexpr uint32_t OVERLAY_SCRIPT_COUNT = sizeof(overlayScripts)/sizeof(overlayScripts[0]) - 1;
+
+  constinit void* overlayHandle{nullptr};
+
+  typedef void(*FuncRegisterScripts)(ScriptEntry* table, uint16_t* sizeTable);
+
+  void loadSceneOverlay(uint16_t sceneId)
+  {
+    unloadSceneOverlay();
+    for(uint32_t i=0; i<OVERLAY_SCENE_COUNT; ++i)
+    {
+      if(overlayScenes[i] != sceneId)continue;
+
+      char path[32];
+      sprintf(path, "rom:/p64/s%04d.dso", sceneId);
+      overlayHandle = dlopen(path, RTLD_LOCAL);
+      auto fnRegister = (FuncRegisterScripts)dlsym(overlayHandle, "p64RegisterScripts");
+      assertf(fnRegister, "Invalid script overlay: %s", path);
+      fnRegister(codeTable, codeSizeTable);
+      return;
+    }
+  }
+
+  void unloadSceneOverlay()
+  {
+    if(!overlayHandle)return;
+    for(uint32_t i=0; i<OVERLAY_SCRIPT_COUNT; ++i) {
+      codeTable[overlayScripts[i]] = {};
+      codeSizeTable[overlayScripts[i]] = 0;
+    }
+    dlclose(overlayHandle);
+    overlayHandle = nullptr;
+  }
+
   NodeGraph::GraphFunc getGraphFuncByUUID(uint64_t uuid)
   {
     switch (uuid)
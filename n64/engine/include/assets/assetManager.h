@@ -9,9 +9,89 @@
 namespace P64::AssetManager
 {
   void init();
-  void freeAll();
+
+  /**
+   * Frees all loaded assets, except fonts marked to stay loaded.
+   * Assets in the keep-list stay loaded as well, used to retain assets across scenes.
+   * @param keepIndices asset indices to keep, can be null
+   * @param keepCount number of indices
+   */
+  void freeAll(const uint16_t* keepIndices = nullptr, uint32_t keepCount = 0);
+
+  /**
+   * Frees a single asset (and removes it from the load queue), NOP if not loaded or marked to stay loaded.
+   * The caller has to make sure nothing uses it anymore, incl. draws still queued on the RSP.
+   * @param idx asset index
+   */
+  void free(uint32_t idx);
+
+  constexpr uint32_t INVALID_INDEX = 0xFFFF;
 
   void* getByIndex(uint32_t idx);
+
+  /**
+   * Looks up an asset by its path at runtime, in constant time via a hash-table.
+   * For paths known at compile time, prefer the '_asset' literal instead.
+   * @param path path, with or without the "rom:/" prefix (e.g. "model/box.t3dm")
+   * @return asset index, or 'INVALID_INDEX' if not found
+   */
+  [[nodiscard]] uint32_t getIndexByPath(const char* path);
+
+  /**
+   * Same as 'getIndexByPath()', but returns the asset itself (loading it if needed).
+   * @param path path, with or without the "rom:/" prefix
+   * @return asset, or null if not found
+   */
+  void* getByFilePath(const char* path);
+
+  [[nodiscard]] bool isLoaded(uint32_t idx);
+
+  /**
+   * ROM path of an asset, for APIs that open files themselves (e.g. streamed music).
+   * @return path, null for an invalid index
+   */
+  [[nodiscard]] const char* getPath(uint32_t idx);
+
+  // called before each asset that needs to be loaded in 'preload()'
+  typedef void(*ProgressFunc)(uint32_t loaded, uint32_t total);
+
+  /**
+   * Loads a list of assets right away, used for the per-scene preload lists.
+   * @param indices asset indices, invalid ones are ignored
+   * @param count number of indices
+   * @param fnProgress optional progress callback, 'total' only counts assets not loaded yet
+   */
+  void preload(const uint16_t* indices, uint32_t count, ProgressFunc fnProgress = nullptr);
+
+  /**
+   * Queues an asset to be loaded in the background, see 'processQueue()'.
+   * This avoids a hitch on first use (e.g. spawning a prefab).
+   * NOP if the asset is already loaded or queued.
+   * @param idx asset index
+   */
+  void prefetch(uint32_t idx);
+
+  /**
+   * Loads queued assets until the time budget is used up, called once per frame by the scene.
+   * Single assets can't be split up, so at least one is loaded per call if any are queued.
+   * @param budgetUs time budget in microseconds
+   */
+  void processQueue(uint32_t budgetUs);
+
+  /**
+   * Limits the heap usage up to which queued assets are loaded, the queue pauses once reached.
+   * Reset to unlimited by 'freeAll()'.
+   * @param maxHeapUsed total used heap in bytes, 0 for no limit
+   */
+  void setQueueHeapLimit(uint32_t maxHeapUsed);
+
+  [[nodiscard]] uint32_t getQueueSize();
+
+  /**
+   * Prints all assets loaded so far to the debug log, with their heap size and load time.
+   * The load time depends on the compression level of the asset (set in the editor).
+   */
+  void logStats();
 }
 
 namespace P64
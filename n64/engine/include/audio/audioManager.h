@@ -8,6 +8,15 @@
 
 namespace P64::Audio
 {
+  /**
+   * Priorities for playing audio, used if all channels are in use.
+   * A new sound can only take over channels from sounds with the same or a lower priority.
+   */
+  constexpr uint8_t PRIO_LOW = 64;
+  constexpr uint8_t PRIO_DEFAULT = 128;
+  constexpr uint8_t PRIO_HIGH = 192;
+  constexpr uint8_t PRIO_CRITICAL = 255;
+
   /**
    * Audio handle, returned by the audio manager when playing audio.
    * This can be used to change settings after it started playing.
@@ -36,7 +45,23 @@ namespace P64::Audio
        */
       void stop();
       void setVolume(float volume);
+
+      /**
+       * Sets volume and stereo panning at once.
+       * @param volume volume
+       * @param pan 0.0 = left, 0.5 = center, 1.0 = right
+       */
+      void setVolume(float volume, float pan);
+
       void setSpeed(float speed);
+
+      /**
+       * Playback position in samples, can be used to resume audio later on.
+       * @return position, 0 if the handle is invalid
+       */
+      float getPosition();
+      void setPosition(float pos);
+
       bool isDone();
   };
 }
@@ -51,11 +76,74 @@ namespace P64::AudioManager
 
   void setMasterVolume(float volume);
 
-  Audio::Handle play2D(wav64_t *audio);
+  /**
+   * (Re-)initializes audio output and the mixer, called by each scene with its settings.
+   * Nothing happens if the settings didn't change, otherwise all audio (incl. music) is stopped.
+   * The RSP cost of mixing scales with the sample-rate and number of playing channels.
+   * 4 of the channels are reserved for music, the rest is used by sound effects.
+   * @param sampleRate output sample-rate in Hz, 0 for the default (32000)
+   * @param bufferCount number of audio buffers, 0 for the default (3)
+   * @param channelCount mixer channels incl. music, 0 for the default (32)
+   */
+  void configure(uint32_t sampleRate, uint32_t bufferCount, uint32_t channelCount);
+
+  [[nodiscard]] uint32_t getSampleRate();
+  [[nodiscard]] uint32_t getChannelCount();
+
+  // bit per mixer channel currently playing, for debugging
+  [[nodiscard]] uint32_t getActiveChannelMask();
+
+  /**
+   * Plays audio on the next free channel (two for stereo).
+   * If all are in use, the voice with the lowest priority is stopped to make room,
+   * within the same priority the quietest and then the oldest one is picked.
+   * Voices with a higher priority than the new sound are never stopped.
+   *
+   * @param audio audio to play
+   * @param priority priority, see 'Audio::PRIO_*'
+   * @param maxInstances max. number of times this audio can play at once,
+   *                     the oldest one is replaced when exceeded. 0 for no limit.
+   * @return handle, invalid if no channel was available
+   */
+  Audio::Handle play2D(wav64_t *audio, uint8_t priority = Audio::PRIO_DEFAULT, uint8_t maxInstances = 0);
 
-  inline Audio::Handle play2D(uint32_t assetId) {
-    return play2D((wav64_t*)AssetManager::getByIndex(assetId));
+  inline Audio::Handle play2D(uint32_t assetId, uint8_t priority = Audio::PRIO_DEFAULT, uint8_t maxInstances = 0) {
+    return play2D((wav64_t*)AssetManager::getByIndex(assetId), priority, maxInstances);
   }
 
+  /**
+   * Stops all sound effects, music keeps playing (e.g. across scenes).
+   */
   void stopAll();
+
+  /**
+   * Plays music on a dedicated channel, streamed from ROM instead of being loaded as an asset.
+   * Only one track plays at a time, a new one crossfades with the current one.
+   * Looping and the loop start are set in the asset settings of the editor.
+   * @param path file path (e.g. "rom:/music/title.wav64")
+   * @param fadeTime crossfade duration in seconds, 0 to switch instantly
+   */
+  void playMusic(const char* path, float fadeTime = 0.0f);
+
+  inline void playMusic(uint32_t assetId, float fadeTime = 0.0f) {
+    playMusic(AssetManager::getPath(assetId), fadeTime);
+  }
+
+  /**
+   * Stops the music, fading it out if a time is given.
+   * @param fadeTime duration in seconds, 0 to stop instantly
+   */
+  void stopMusic(float fadeTime = 0.0f);
+
+  void setMusicVolume(float volume);
+
+  /**
+   * Sets the size of the stream buffer for music, applies to the next 'playMusic()'.
+   * Larger buffers read further ahead, so fewer (but bigger) ROM reads happen,
+   * which avoids drop-outs when other data is loaded at the same time.
+   * @param bytes buffer size in bytes, 0 for the mixer default
+   */
+  void setMusicBufferSize(uint32_t bytes);
+
+  [[nodiscard]] bool isMusicPlaying();
 }
\ No newline at end of file
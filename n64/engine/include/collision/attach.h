@@ -11,6 +11,7 @@ namespace P64::Coll
    * Helper to attach something to a transforming mesh collider.
    * This will track the relative movement at given point.
    * Which can be later applied to an object in order to move it with the mesh.
+   * For a BCS, use 'Coll::Scene::attachToMesh' instead, which moves all riders of a mesh at once.
    */
   class Attach
   {
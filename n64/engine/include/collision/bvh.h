@@ -3,6 +3,7 @@
 * @license MIT
 */
 #pragma once
+#include <libdragon.h>
 #include <vector>
 #include "shapes.h"
 
@@ -24,11 +25,143 @@ namespace P64::Coll
   static_assert(sizeof(BVHNode) == (7 * sizeof(int16_t)));
 
   struct BVH {
+    // max. tree depth the traversal can handle, the builder produces far shallower trees
+    constexpr static int STACK_SIZE = 64;
+    // max. rays in a packet for 'queryRays', one bit each in the active-mask
+    constexpr static int RAY_PACKET_SIZE = 32;
+
     uint16_t nodeCount;
     uint16_t dataCount;
     BVHNode nodes[];
     // uint16_t data[];
 
+    [[nodiscard]] const int16_t* getData() const {
+      return (int16_t*)&nodes[nodeCount]; // data starts right after nodes
+    }
+
+    /**
+     * Iterative depth-first traversal, calls 'callback(dataIdx)' for every data entry
+     * in a leaf whose node (and all parents) passed 'testNode(node)'.
+     * The index is the position in leaf order, 'getData()[dataIdx]' is the triangle index.
+     * Doesn't use any global state, so it's reentrant and safe to use from coroutines.
+     * The callback may run other queries, but must not modify the BVH itself.
+     */
+    template<typename FTest, typename FCallback>
+    void traverse(FTest &&testNode, FCallback &&callback) const
+    {
+      const BVHNode *stack[STACK_SIZE];
+      int stackSize = 0;
+      stack[stackSize++] = nodes;
+
+      while(stackSize > 0)
+      {
+        const BVHNode *node = stack[--stackSize];
+        if(!testNode(*node))continue;
+
+        int nodeDataCount = node->value & 0b1111;
+        int offset = (int16_t)node->value >> 4;
+
+        if(nodeDataCount == 0) {
+          assertf(stackSize + 2 <= STACK_SIZE, "BVH: tree too deep");
+          // push right first, so the left child is visited first (same order as recursion)
+          stack[stackSize++] = &node[offset + 1];
+          stack[stackSize++] = &node[offset];
+          continue;
+        }
+
+        int offsetEnd = offset + nodeDataCount;
+        while(offset < offsetEnd) {
+          callback(offset++);
+        }
+      }
+    }
+
+    /**
+     * Streams all triangles potentially overlapping the AABB into the callback.
+     */
+    template<typename FCallback>
+    void queryAABB(const AABB &aabb, FCallback &&callback) const {
+      const int16_t *data = getData();
+      traverse(
+        [&aabb](const BVHNode &node) { return node.aabb.vsAABB(aabb); },
+        [data, &callback](int dataIdx) { callback(data[dataIdx]); }
+      );
+    }
+
+    /**
+     * Same as 'queryAABB', but passes the position in leaf order instead of the triangle index.
+     * Used to read from data laid out in the same order (e.g. 'PackedTri').
+     */
+    template<typename FCallback>
+    void queryAABBLeaf(const AABB &aabb, FCallback &&callback) const {
+      traverse([&aabb](const BVHNode &node) { return node.aabb.vsAABB(aabb); }, callback);
+    }
+
+    /**
+     * Streams all triangles potentially hit by the ray into the callback.
+     */
+    template<typename FCallback>
+    void queryRay(const fm_vec3_t &pos, const fm_vec3_t &dir, FCallback &&callback) const {
+      const int16_t *data = getData();
+      traverse(
+        [&pos, &dir](const BVHNode &node) { return node.aabb.vsRay(pos, dir); },
+        [data, &callback](int dataIdx) { callback(data[dataIdx]); }
+      );
+    }
+
+    /**
+     * Traverses the BVH once for a packet of rays, a node is only entered
+     * if at least one of the rays that reached its parent hits it.
+     * Calls 'callback(triIndex, rayMask)' with the bit-mask of rays that reached the leaf.
+     * @param count number of rays, at most 'RAY_PACKET_SIZE'
+     */
+    template<typename FCallback>
+    void queryRays(const Ray *rays, uint32_t count, FCallback &&callback) const
+    {
+      assertf(count <= RAY_PACKET_SIZE, "BVH: too many rays in packet (%lu)", count);
+      if(count == 0)return;
+
+      struct StackEntry {
+        const BVHNode *node;
+        uint32_t rayMask;
+      };
+
+      const int16_t *data = getData();
+      StackEntry stack[STACK_SIZE];
+      int stackSize = 0;
+      stack[stackSize++] = {nodes, count == 32 ? 0xFFFF'FFFF : ((1u << count) - 1)};
+
+      while(stackSize > 0)
+      {
+        auto entry = stack[--stackSize];
+        uint32_t rayMask = 0;
+        for(uint32_t m = entry.rayMask; m; m &= m - 1) {
+          uint32_t i = __builtin_ctz(m);
+          if(entry.node->aabb.vsRay(rays[i].pos, rays[i].dir))rayMask |= 1u << i;
+        }
+        if(!rayMask)continue;
+
+        int nodeDataCount = entry.node->value & 0b1111;
+        int offset = (int16_t)entry.node->value >> 4;
+
+        if(nodeDataCount == 0) {
+          assertf(stackSize + 2 <= STACK_SIZE, "BVH: tree too deep");
+          stack[stackSize++] = {&entry.node[offset + 1], rayMask};
+          stack[stackSize++] = {&entry.node[offset], rayMask};
+          continue;
+        }
+
+        int offsetEnd = offset + nodeDataCount;
+        while(offset < offsetEnd) {
+          callback(data[offset++], rayMask);
+        }
+      }
+    }
+
+    /**
+     * Collects triangles into a fixed-size result, anything beyond 'MAX_RESULT_COUNT' is dropped.
+     * Prefer 'queryAABB' for dense meshes.
+     */
     void vsAABB(const AABB &aabb, BVHResult &res) const;
 
     inline void vsBCS(const BCS &bcs, BVHResult &res) const {
@@ -37,4 +170,4 @@ namespace P64::Coll
 
     void raycast(const fm_vec3_t &pos, const fm_vec3_t &dir, BVHResult &res) const;
   };
-}
\ No newline at end of file
+}
@@ -16,14 +16,34 @@ namespace P64::Coll
 {
   struct BVH;
 
+  /**
+   * Pre-decoded triangle for the narrow-phase, stored in BVH leaf order.
+   * Avoids the index, vertex and normal lookups of the packed mesh format.
+   */
+  struct PackedTri
+  {
+    fm_vec3_t v[3];
+    fm_vec3_t normal;
+    float planeDist; // dot(normal, v[0])
+  };
+  static_assert(sizeof(PackedTri) == 13 * sizeof(float));
+
   struct Mesh
   {
+    // vertices are int16 ('vertsQuant'), multiplied by 'collScale' to get the position.
+    // triangles are decoded into floats once per BVH leaf, the narrow-phase itself is the same for both modes
+    constexpr static uint16_t FLAG_QUANTIZED = 1 << 0;
+
     // NOTE: don't place any extra members here!
     // mirrors the collion data in the t3dm extension
     uint32_t triCount{};
-    uint32_t vertCount{};
+    uint16_t flags{}; // shares the 32-bit vertex count of older files, which was always below 0x10000
+    uint16_t vertCount{};
     float collScale{};
-    fm_vec3_t *verts{};
+    union {
+      fm_vec3_t *verts{};
+      IVec3 *vertsQuant;
+    };
     IVec3 *normals{};
     BVH* bvh{};
     // data follows here: indices, normals, verts, BVH
@@ -31,8 +51,52 @@ namespace P64::Coll
 
     [[nodiscard]] CollInfo vsSphere(const BCS &sphere, const Triangle& triangle) const;
     [[nodiscard]] CollInfo vsBox(const BCS &box, const Triangle& triangle) const;
+    /**
+     * Time-of-impact of a moving shape against the face of a triangle,
+     * only reports motion that ends too far behind the face to be resolved by 'vsSphere'/'vsBox'.
+     * @param bcs shape at the start of the motion
+     * @param motion motion for this frame
+     * @return time in [0, 1] (as a fraction of 'motion'), INFINITY if there is no such hit
+     */
+    [[nodiscard]] float vsSweep(const BCS &bcs, const fm_vec3_t &motion, const Triangle& triangle, bool isBox) const;
     [[nodiscard]] RaycastRes vsRay(const fm_vec3_t &pos, const fm_vec3_t &dir, const Triangle& triangle) const;
 
+    [[nodiscard]] bool isQuantized() const {
+      return flags & FLAG_QUANTIZED;
+    }
+
+    [[nodiscard]] fm_vec3_t getVert(uint32_t v) const {
+      if(!isQuantized())return verts[v];
+      auto &q = vertsQuant[v];
+      return {(float)q.v[0] * collScale, (float)q.v[1] * collScale, (float)q.v[2] * collScale};
+    }
+
+    /**
+     * Decodes a triangle (copy of its vertices).
+     * @param t triangle index
+     */
+    [[nodiscard]] Triangle getTriangle(uint32_t t) const;
+
+    /**
+     * Returns a triangle cache in BVH leaf order (one entry per BVH data entry).
+     * It's shared across all users of the same mesh and created on the first call.
+     * Each call must be paired with 'releaseTriCache()'.
+     */
+    [[nodiscard]] const PackedTri* acquireTriCache() const;
+    void releaseTriCache() const;
+
+    /**
+     * Total size of the mesh data (header, indices, normals, verts and BVH).
+     */
+    [[nodiscard]] uint32_t getDataSize() const;
+
+    /**
+     * Creates a heap allocated copy with all vertices, normals and the BVH
+     * transformed into world-space. The result must be freed via 'free()'.
+     * @return copy or nullptr if the transformed bounds exceed the BVH range
+     */
+    [[nodiscard]] Mesh* cloneTransformed(const fm_vec3_t &pos, const fm_vec3_t &scale, const fm_quat_t &rot) const;
+
     static Mesh* load(void* rawData);
   };
 
@@ -43,8 +107,47 @@ namespace P64::Coll
     fm_vec3_t invScale{};
     fm_quat_t invRot{};
 
+    // world-space bounds of the whole mesh
+    fm_vec3_t aabbMin{};
+    fm_vec3_t aabbMax{};
+
+    // transform of the last update, used to only recalculate things if the object moved
+    fm_vec3_t lastPos{};
+    fm_vec3_t lastScale{};
+    fm_quat_t lastRot{};
+
+    // static instances never move, 'update()' is skipped for them.
+    // if baked, 'mesh' is an owned world-space copy, so no local-space transforms are needed
+    bool isStatic{};
+    bool isBaked{};
+
+    // collision layers, only BCS with a matching 'maskRead' check against this mesh
+    uint8_t maskWrite{0xFF};
+
+    // optional triangle cache, if set the narrow-phase reads from it instead of the mesh
+    const PackedTri *triCache{};
+
     fm_vec3_t intoLocalSpace(const fm_vec3_t &p) const;
     fm_vec3_t outOfLocalSpace(const fm_vec3_t &p) const;
-    void update();
+    /**
+     * Updates the inverse transform and bounds if the object moved.
+     * @return true if anything changed
+     */
+    bool update();
+
+    /**
+     * Marks the instance as static and bakes its current transform into a copy of the mesh.
+     * Falls back to a static local-space instance if the mesh can't be baked.
+     */
+    void bake();
+
+    /**
+     * Frees the baked copy (if any), must be called before the instance is destroyed.
+     */
+    void freeBaked();
+
+    [[nodiscard]] bool vsAABB(const fm_vec3_t &min, const fm_vec3_t &max) const {
+      return Math::aabbOverlap(min, max, aabbMin, aabbMax);
+    }
   };
 }
@@ -11,5 +11,9 @@ namespace P64::Coll
 {
   bool sphereVsSphere(BCS &collA, BCS &collB);
   bool sphereVsBox(BCS &sphere, BCS &box);
-  bool boxVsBox(BCS &boxA, BCS &boxB);
+  /**
+   * @param warmAxis optional, separating axis of the last frame (0-2, or 0xFF if none), updated to the one used.
+   *                 it's kept as long as it's not clearly worse, so resting boxes don't flip between axes
+   */
+  bool boxVsBox(BCS &boxA, BCS &boxB, uint8_t *warmAxis = nullptr);
 }
\ No newline at end of file
@@ -6,7 +6,9 @@
 
 #include "mesh.h"
 #include "shapes.h"
-#include <set>
+#include "bvh.h"
+#include "lib/rspJobs.h"
+#include <unordered_map>
 #include <vector>
 
 namespace P64::Coll
@@ -15,37 +17,188 @@ namespace P64::Coll
     private:
       constexpr static uint32_t VOID_SPHERE_COUNT = 2;
 
-      std::set<MeshInstance*> meshes{};
+      std::vector<MeshInstance*> meshes{};
       std::vector<BCS*> collBCS{};
 
+      // broadphase (sweep-and-prune on the X-axis), kept across frames to sort faster
+      struct SweepEntry {
+        float min;
+        float max;
+        uint32_t index; // index into 'collBCS'
+      };
+      std::vector<SweepEntry> sweepList{};
+      bool sweepDirty{true};
+
+      // triangles touched by the swept bounds of the BCS currently checked, re-used across calls.
+      // with 'rspNarrowphase' this holds the triangles of all BCS in the frame
+      struct CandidateTri {
+        MeshInstance *meshInst;
+        Triangle tri;
+        int32_t rspIdx; // pair index of the RSP narrow-phase, -1 if done on the CPU
+      };
+      std::vector<CandidateTri> candidateTris{};
+
+      // BCS waiting for the RSP narrow-phase, with their range in 'candidateTris'
+      struct PendingBCS {
+        BCS *bcs;
+        uint32_t candBegin;
+        uint32_t candEnd;
+        fm_vec3_t centerIn;
+        fm_vec3_t velocityIn;
+      };
+      std::vector<PendingBCS> pendingBCS{};
+
+      /**
+       * Contacts of the last frame, to skip the checks of bodies resting in the exact same state.
+       * Mesh contacts store the result for a BCS against all meshes, pair contacts the result of two BCS.
+       * Since the same input gives the same result, anything still matching bit-for-bit can be re-used as-is.
+       */
+      struct MeshContact {
+        fm_vec3_t centerIn;
+        fm_vec3_t velocityIn;
+        fm_vec3_t halfExtend;
+        fm_vec3_t centerOut;
+        CollInfo res;
+        uint8_t hitTriTypes;
+        uint8_t flags;
+        uint8_t maskRead;
+        uint32_t frame;
+      };
+      std::unordered_map<const BCS*, MeshContact> meshContacts{};
+
+      struct PairContact {
+        fm_vec3_t centerInA;
+        fm_vec3_t centerInB;
+        fm_vec3_t halfExtendA;
+        fm_vec3_t halfExtendB;
+        fm_vec3_t centerOutA;
+        fm_vec3_t centerOutB;
+        uint8_t hitTriTypesA; // types set by this pair
+        uint8_t hitTriTypesB;
+        uint8_t boxAxis; // separating axis of box vs. box, kept as a warm-start even if the bodies move
+        uint8_t flagsA;
+        uint8_t flagsB;
+        uint32_t frame;
+      };
+      std::unordered_map<uint64_t, PairContact> pairContacts{};
+
+      uint32_t frameIdx{0};
+      // any mesh added, removed or moved this frame, this invalidates all mesh contacts
+      bool meshesChanged{true};
+      uint32_t meshMaskHash{0};
+
+      // BCS riding on a mesh, sorted by mesh before each update, see 'attachToMesh'
+      struct Rider {
+        BCS *bcs;
+        const MeshInstance *meshInst;
+      };
+      std::vector<Rider> riders{};
+
+      RSPJobs::SphereTriBlock *rspBlocks{};
+      RSPJobs::SphereTriRes *rspResults{};
+      uint32_t rspBlockCapacity{0};
+
       CollInfo vsBCS(BCS &bcs, const fm_vec3_t &velocity, float deltaTime);
+      void collectCandidates(BCS &bcs, const fm_vec3_t &velocity, float deltaTime);
+      CollInfo resolveCandidates(BCS &bcs, uint32_t candBegin, uint32_t candEnd);
+      void packSphereTris();
+      void updateMeshCollision(BCS &bcs, float deltaTime);
+      void updateMeshCollisionRSP(float deltaTime);
+      void applyMeshCollision(BCS &bcs, const CollInfo &res);
+      bool reuseMeshContact(BCS &bcs);
+      void storeMeshContact(const BCS &bcs, const fm_vec3_t &centerIn, const fm_vec3_t &velocityIn, const CollInfo &res);
+      void forgetContacts(const BCS *bcs);
+      void moveRiders(const MeshInstance &meshInst, const fm_vec3_t &lastPos, const fm_vec3_t &lastScale, const fm_quat_t &lastRot);
+      void updateBroadphase();
+      void testPair(BCS &bcsA, BCS &bcsB);
+      void updateSleepState(BCS &bcs, bool beforeUpdate);
+      void raycastPacket(const Ray *rays, RaycastRes *results, uint32_t count);
 
     public:
       uint64_t ticks{0};
       uint64_t ticksBVH{0};
       uint64_t raycastCount{0};
+      uint32_t pairCount{0}; // BCS pairs without any broadphase
+      uint32_t pairCountBroad{0}; // BCS pairs after broadphase and mask check
+      uint32_t meshesSkipped{0}; // BCS vs. mesh checks skipped by the bounding box test
+      uint32_t bcsActive{0}; // solid, non-fixed BCS running mesh collision this frame
+      uint32_t bcsSleeping{0};
+      uint32_t rspTriCount{0}; // sphere-triangle pairs done on the RSP this frame
+      uint32_t contactsReused{0}; // mesh and pair contacts skipped this frame, since nothing changed
+
+      // speed (units per second) below which a body counts as still, can be tuned per game.
+      // any velocity below that set on a sleeping body gets discarded, this includes gravity
+      float sleepVelocity{16.0f};
+
+      // runs the sphere vs. triangle narrow-phase of all BCS in one RSP job, instead of per triangle on the CPU.
+      // pays off for dense meshes, results are slightly less precise (about 1/256 of the radius)
+      bool rspNarrowphase{false};
+
+      Scene() = default;
+      Scene(const Scene&) = delete;
+      Scene& operator=(const Scene&) = delete;
+      ~Scene();
 
       void registerMesh(MeshInstance *mesh) {
-        mesh->update();
-        meshes.insert(mesh);
+        if(mesh->update())meshesChanged = true;
+        for(auto m : meshes) {
+          if(m == mesh)return;
+        }
+        meshes.push_back(mesh);
+        meshesChanged = true;
       }
 
       void unregisterMesh(MeshInstance *mesh) {
-        meshes.erase(mesh);
+        for(auto it = meshes.begin(); it != meshes.end(); ++it) {
+          if(*it == mesh) {
+            meshes.erase(it);
+            meshesChanged = true;
+            std::erase_if(riders, [mesh](const Rider &r) { return r.meshInst == mesh; });
+            return;
+          }
+        }
       }
 
       void registerBCS(BCS *bcs) {
         collBCS.push_back(bcs);
+        sweepDirty = true;
       }
 
       void unregisterBCS(BCS *bcs) {
         for(auto it = collBCS.begin(); it != collBCS.end(); ++it) {
-          if(*it == bcs)return (void)collBCS.erase(it);
+          if(*it == bcs) {
+            collBCS.erase(it);
+            sweepDirty = true;
+            forgetContacts(bcs);
+            std::erase_if(riders, [bcs](const Rider &r) { return r.bcs == bcs; });
+            return;
+          }
         }
       }
 
+      /**
+       * Lets a BCS ride on a mesh, moving it along if the mesh moves in the next update.
+       * This is done right after the mesh transform updates, for all riders of a mesh in one pass.
+       * Needs to be called every frame while attached, e.g. in the collision event with the mesh.
+       * @param bcs body to move
+       * @param meshInst mesh to follow, NOP if null
+       */
+      void attachToMesh(BCS &bcs, const MeshInstance *meshInst) {
+        if(meshInst)riders.push_back({&bcs, meshInst});
+      }
+
       RaycastRes raycast(const fm_vec3_t &pos, const fm_vec3_t &dir);
 
+      /**
+       * Casts multiple rays at once, with the same results as calling 'raycast' for each.
+       * Rays are processed in packets, sharing the transform into a meshes local-space
+       * and the BVH traversal, which is a lot cheaper when casting many rays per frame.
+       * @param rays input rays
+       * @param results output, one entry per ray
+       * @param count number of rays
+       */
+      void raycast(const Ray *rays, RaycastRes *results, uint32_t count);
+
       [[nodiscard]] const std::vector<BCS*> &getSpheres() const {
         return collBCS;
       }
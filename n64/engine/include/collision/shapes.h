@@ -46,6 +46,11 @@ namespace P64::Coll
     uint8_t maskWrite{0};
     uint8_t flags{0};
     uint8_t hitTriTypes{0}; // mask of triangle types the sphere last collided with
+    uint8_t sleepFrames{0}; // frames spent (almost) still, sleeps once it reaches 'SLEEP_FRAME_COUNT'
+
+    fm_vec3_t sleepCenter{}; // center when it fell asleep, moving it away wakes it up
+
+    static constexpr uint8_t SLEEP_FRAME_COUNT = 30;
 
     [[nodiscard]] constexpr float getRadius() const {
       return halfExtend.y;
@@ -66,6 +71,21 @@ namespace P64::Coll
       return flags & BCSFlags::FIXED_XYZ;
     }
 
+    /**
+     * Sleeping bodies skip mesh collision until they get moved, hit or their velocity is set.
+     */
+    [[nodiscard]] constexpr bool isSleeping() const {
+      return sleepFrames >= SLEEP_FRAME_COUNT;
+    }
+
+    /**
+     * Wakes the body up, moving 'center' or setting a velocity already does this.
+     * Only needed if the surroundings change, e.g. the floor below it got removed.
+     */
+    constexpr void wake() {
+      sleepFrames = 0;
+    }
+
     [[nodiscard]] fm_vec3_t getMinAABB() const {
       return center - halfExtend;
     }
@@ -98,6 +118,11 @@ namespace P64::Coll
     int collCount{};
   };
 
+  struct Ray {
+    fm_vec3_t pos{};
+    fm_vec3_t dir{};
+  };
+
   struct RaycastRes {
     fm_vec3_t hitPos{};
     fm_vec3_t normal{};
@@ -111,8 +136,9 @@ namespace P64::Coll
   struct Triangle
   {
     fm_vec3_t normal{};
-    fm_vec3_t* v[3]{};
+    fm_vec3_t v[3]{}; // copies, since quantized meshes have no float vertices to point to
     AABB aabb{};
+    float planeDist{}; // dot(normal, v[0])
   };
 
   struct Triangle2D {
@@ -0,0 +1,86 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include "debug/trace.h"
+
+#ifndef P64_ALLOC_TRACK
+  // counts heap allocations per frame and zone, build with 'P64_ALLOC_TRACK=1' to enable (see 'baseMakefile.mk')
+  #define P64_ALLOC_TRACK 0
+#endif
+
+/**
+ * Counts heap allocations per frame, attributed to the innermost trace zone (see 'debug/trace.h') they happen in.
+ * Anything outside a zone ends up in 'Zone::FRAME'.
+ * This hooks 'malloc' and friends at link time ('--wrap'), so it includes allocations of libdragon,
+ * libstdc++ ('new', containers, 'std::function') and the user scripts.
+ *
+ * With 'SceneConf::FLAG_NO_ALLOC' (scene setting 'Assert No Alloc') any allocation after the first
+ * frames of a scene asserts, showing the call stack of the allocation in the crash screen.
+ * Zones and counters are not interrupt-safe, allocations must only happen on the main thread.
+ */
+namespace Debug::AllocTracker
+{
+  using Zone = Debug::Trace::Zone;
+
+  // frames after a load that may still allocate in strict mode (lazily grown buffers, first spawns, ...)
+  constexpr uint32_t STRICT_GRACE_FRAMES = 3;
+  constexpr uint32_t MAX_ZONE_DEPTH = 16;
+
+  struct Stats
+  {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t bytes; // requested, not including malloc overhead
+  };
+
+#if P64_ALLOC_TRACK
+  void begin(Zone zone);
+  void end();
+
+  // ends the current frame, its counts are then returned by 'getFrameStats'
+  void frame();
+
+  /**
+   * Asserts on any allocation (after 'STRICT_GRACE_FRAMES' calls to 'frame') until disabled again.
+   * Set by the scene, for 'SceneConf::FLAG_NO_ALLOC'.
+   */
+  void setStrict(bool enable);
+
+  // stats of the last finished frame
+  [[nodiscard]] const Stats& getFrameStats(Zone zone);
+  [[nodiscard]] Stats getFrameTotal();
+
+  // allocations in between are counted, but never assert (e.g. debug tools)
+  struct ScopedIgnore
+  {
+    ScopedIgnore();
+    ~ScopedIgnore();
+  };
+
+  struct ScopedZone
+  {
+    ScopedZone(Zone zone) { begin(zone); }
+    ~ScopedZone() { end(); }
+  };
+#else
+  inline void frame() {}
+  inline void setStrict(bool) {}
+  struct ScopedIgnore { ScopedIgnore() {} };
+#endif
+}
+
+#if P64_ALLOC_TRACK
+  #define P64_ALLOC_CONCAT_(a, b) a##b
+  #define P64_ALLOC_CONCAT(a, b) P64_ALLOC_CONCAT_(a, b)
+
+  #define P64_ALLOC_BEGIN(ZONE) ::Debug::AllocTracker::begin(::Debug::Trace::Zone::ZONE)
+  #define P64_ALLOC_END(ZONE) ::Debug::AllocTracker::end()
+  #define P64_ALLOC_SCOPE(ZONE) ::Debug::AllocTracker::ScopedZone P64_ALLOC_CONCAT(allocZone_, __LINE__)(::Debug::Trace::Zone::ZONE)
+#else
+  #define P64_ALLOC_BEGIN(ZONE)
+  #define P64_ALLOC_END(ZONE)
+  #define P64_ALLOC_SCOPE(ZONE)
+#endif
@@ -7,17 +7,48 @@
 
 namespace Debug
 {
+  /**
+   * Categories for debug primitives, each one can be turned off (see 'setCategoryMask').
+   * Primitives of a disabled category are discarded right away, before any other work.
+   */
+  namespace Category
+  {
+    constexpr uint32_t COLL_MESH = 1 << 0;
+    constexpr uint32_t COLL_BCS  = 1 << 1;
+    constexpr uint32_t USER      = 1 << 2;
+    constexpr uint32_t ALL       = 0xFFFF'FFFF;
+  }
+
   void init();
 
-  void drawAABB(const fm_vec3_t &p, const fm_vec3_t &halfExtend, color_t color = {0xFF, 0xFF, 0xFF, 0xFF});
-  void drawLine(const fm_vec3_t &a, const fm_vec3_t &b, color_t color = {0xFF,0xFF,0xFF,0xFF});
-  void drawSphere(const fm_vec3_t &center, float radius, color_t color = {0xFF,0xFF,0xFF,0xFF});
+  void drawAABB(const fm_vec3_t &p, const fm_vec3_t &halfExtend, color_t color = {0xFF, 0xFF, 0xFF, 0xFF}, uint32_t category = Category::USER);
+  void drawLine(const fm_vec3_t &a, const fm_vec3_t &b, color_t color = {0xFF,0xFF,0xFF,0xFF}, uint32_t category = Category::USER);
+  void drawTriangle(const fm_vec3_t &a, const fm_vec3_t &b, const fm_vec3_t &c, color_t color = {0xFF,0xFF,0xFF,0xFF}, uint32_t category = Category::USER);
+  void drawSphere(const fm_vec3_t &center, float radius, color_t color = {0xFF,0xFF,0xFF,0xFF}, uint32_t category = Category::USER);
+
+  void setCategoryMask(uint32_t mask);
+  [[nodiscard]] uint32_t getCategoryMask();
+  [[nodiscard]] inline bool isCategoryEnabled(uint32_t category) { return getCategoryMask() & category; }
+
+  /**
+   * Max. amount of lines per frame, anything beyond that is dropped.
+   * Limited by the size of the buffer, every line is drawn as two triangles.
+   */
+  void setLineBudget(uint32_t maxLines);
+
+  // lines drawn and dropped (over budget) in the last frame
+  [[nodiscard]] uint32_t getLineCount();
+  [[nodiscard]] uint32_t getDroppedCount();
 
-  void draw(surface_t *fb);
+  /**
+   * Draws all buffered primitives in one pass with the RDP, on top of the current frame.
+   * Uses the current viewport for the projection.
+   */
+  void draw();
 
   void printStart();
   float print(float x, float y, const char* str);
   float printf(float x, float y, const char *fmt, ...);
 
   void destroy();
-}
\ No newline at end of file
+}
@@ -0,0 +1,58 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+#ifndef P64_HOT_RELOAD
+  // receives changed files from the editor over USB, build with '-DP64_HOT_RELOAD=1' to enable
+  #define P64_HOT_RELOAD 0
+#endif
+
+/**
+ * Replaces files of the ROM filesystem at runtime, without flashing a new ROM.
+ * The editor sends a single binary packet over the USB debug channel containing all changed files,
+ * those are kept in RAM and mounted as 'hot:/', shadowing the same path in 'rom:/'.
+ * Once a packet is received the current scene gets reloaded, freeing all assets that changed.
+ *
+ * Packet layout (big-endian, all parts 4-byte aligned):
+ *   u32 magic ('PACKET_MAGIC'), u16 version, u16 file count
+ *   per file: u16 path length, u16 padding, u32 size, path (no terminator), data
+ */
+namespace Debug::HotReload
+{
+  constexpr uint32_t PACKET_MAGIC = 0x50363452; // "P64R"
+  constexpr uint16_t PACKET_VERSION = 1;
+
+#if P64_HOT_RELOAD
+  void init();
+
+  /**
+   * Checks for a pending packet and stores its files.
+   * @return true if files changed and the scene should be reloaded
+   */
+  bool poll();
+
+  /**
+   * Frees all assets that got replaced since the last call.
+   * Must only be called while no scene is loaded.
+   */
+  void freeChangedAssets();
+
+  // true if assets got replaced since the last 'freeChangedAssets()'
+  bool hasChangedAssets();
+
+  /**
+   * Returns the path to load a file from, which is the replaced version in 'hot:/' if one was received.
+   * @param path path in 'rom:/'
+   */
+  const char* resolvePath(const char* path);
+#else
+  inline void init() {}
+  inline bool poll() { return false; }
+  inline void freeChangedAssets() {}
+  inline bool hasChangedAssets() { return false; }
+  inline const char* resolvePath(const char* path) { return path; }
+#endif
+}
@@ -0,0 +1,95 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+#ifndef P64_INPUT_REPLAY
+  // records and replays joypad input, build with 'P64_INPUT_REPLAY=1' to enable (see 'baseMakefile.mk')
+  #define P64_INPUT_REPLAY 0
+#endif
+
+/**
+ * Deterministic input recording and replay, so perf captures (trace, benchmark) can compare identical frame sequences.
+ * While active, every engine poll (see 'Scene::tick') stores or feeds back the state of all joypads,
+ * the RNG is seeded with the recorded seed and the scene runs with a fixed delta-time.
+ *
+ * The joypad getters are hooked at link time ('--wrap'), recording and replay go through the same state
+ * so both see the same input: 'joypad_get_inputs', 'joypad_get_buttons(_pressed/_released/_held)',
+ * 'joypad_get_direction' and 'joypad_is_connected'. Other joypad functions (axis helpers, rumble, accessories)
+ * are not covered, extra 'joypad_poll' calls (e.g. in node graphs) are ignored while active.
+ *
+ * A recording starts by reloading the current scene and is written to the log with 'dump', framed by
+ * 'MARKER_BEGIN'/'MARKER_END'. The editor saves it as 'data/input.replay' in the project (Profiler, 'Save Input'),
+ * which is then replayed at boot ('REPLAY_PATH'), printing 'MARKER_DONE' once all frames were played.
+ * Timing-dependent parts (asset streaming, audio) can still differ between runs.
+ */
+namespace Debug::InputReplay
+{
+  constexpr uint32_t MAGIC = 0x50363449; // "P64I"
+  constexpr uint16_t VERSION = 1;
+  // recordings are capped at 10 minutes of 60Hz polls
+  constexpr uint32_t MAX_FRAMES = 60 * 60 * 10;
+
+  constexpr const char* REPLAY_PATH = "rom:/p64/input.replay";
+  constexpr const char* MARKER_BEGIN = "[P64-INPUT-BEGIN]";
+  constexpr const char* MARKER_END = "[P64-INPUT-END]";
+  constexpr const char* MARKER_DONE = "[P64-INPUT-DONE]";
+
+  /**
+   * File layout (big-endian, as stored in memory):
+   *   'Header', followed by 'frameCount' times 'Frame'
+   */
+  struct Header
+  {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t sceneId;
+    uint32_t seed;
+    float deltaTime;
+    uint32_t frameCount;
+  };
+
+  struct Frame
+  {
+    joypad_inputs_t inputs[JOYPAD_PORT_COUNT];
+    uint8_t connected; // mask of ports
+    uint8_t padding[3];
+  };
+
+#if P64_INPUT_REPLAY
+  /**
+   * Starts replaying 'REPLAY_PATH' if the ROM has one.
+   * @param sceneId scene to boot into
+   * @return scene to boot into, the one the recording started in if replaying
+   */
+  uint16_t init(uint16_t sceneId);
+
+  // reloads the current scene and records from its first tick on
+  void startRecording();
+  void stopRecording();
+  [[nodiscard]] bool isRecording();
+  [[nodiscard]] bool isReplaying();
+
+  /**
+   * Writes the last recording to the log, the editor extracts it from there.
+   * This is slow (several frames), stops recording first.
+   */
+  void dump();
+
+  // called by the scene once loaded, a pending recording starts there
+  void onSceneLoaded(uint16_t sceneId);
+
+  // replaces 'joypad_poll' in the engine, stores or replays one frame
+  void poll();
+
+  // fixed while recording/replaying, otherwise 'deltaTime' is returned as is
+  [[nodiscard]] float getDeltaTime(float deltaTime);
+#else
+  inline uint16_t init(uint16_t sceneId) { return sceneId; }
+  inline void onSceneLoaded(uint16_t) {}
+  inline void poll() { joypad_poll(); }
+  inline float getDeltaTime(float deltaTime) { return deltaTime; }
+#endif
+}
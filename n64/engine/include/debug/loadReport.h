@@ -0,0 +1,93 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+#ifndef P64_LOAD_REPORT
+  // timing breakdown of scene loads, build with 'P64_LOAD_REPORT=1' to enable (see 'baseMakefile.mk')
+  #define P64_LOAD_REPORT 0
+#endif
+
+/**
+ * Time spent in a scene load, split into its phases, per component type, per object and per asset.
+ * A report covers the scene constructor only; assets loaded later on (prefetch queue, first uses)
+ * are listed by 'AssetManager::logStats' instead.
+ *
+ * ROM reads are counted by hooking the PI DMA functions at link time ('--wrap'), so each asset reports
+ * the bytes read from ROM and the time spent waiting on them. The rest of its load time is
+ * decompression and the parsing of its loader. Reads of streamed audio between two assets are only
+ * part of the phase they happen in.
+ *
+ * Once the scene is loaded, a summary is written to the log followed by the full report as one JSON
+ * object per line, framed by 'MARKER_BEGIN'/'MARKER_END'. The editor shows it in its 'Load Report' window.
+ */
+namespace Debug::LoadReport
+{
+  constexpr uint32_t MAX_ASSETS = 256;
+  constexpr uint32_t MAX_SLOW_OBJECTS = 8;
+  // entries per category in the log summary, the dump always has all of them
+  constexpr uint32_t LOG_TOP_COUNT = 5;
+
+  constexpr const char* MARKER_BEGIN = "[P64-LOAD-BEGIN]";
+  constexpr const char* MARKER_END = "[P64-LOAD-END]";
+
+  enum class Phase : uint8_t
+  {
+    CONFIG = 0, // scene config, quality settings, audio setup
+    DRAW_LAYER,
+    PIPELINE,   // creating and initializing the render pipeline
+    PRELOAD,    // the asset list of the scene
+    OBJECTS,    // object file, 'loadObject' incl. component init (and the assets they load)
+    COUNT
+  };
+
+  constexpr const char* PHASE_NAMES[(uint32_t)Phase::COUNT] {
+    "Config", "Draw-Layer", "Pipeline", "Preload", "Objects"
+  };
+
+  // counters at a point in time, the difference to a later one is what got attributed in between
+  struct Mark
+  {
+    uint32_t ticks;
+    uint32_t romBytes;
+    uint32_t romTicks;
+  };
+
+#if P64_LOAD_REPORT
+  // starts a new report, called first thing in the scene constructor
+  void begin(uint16_t sceneId);
+  // finishes the report, writes it to the log
+  void end();
+
+  void beginPhase(Phase phase);
+  void endPhase(Phase phase);
+
+  [[nodiscard]] Mark mark();
+
+  void onComponent(uint8_t compId, const Mark &start);
+  void onObject(uint16_t objId, const Mark &start);
+  /**
+   * Called after an asset got loaded, nested loads are included in the outer asset as well.
+   * @param heapBytes heap used by the asset
+   */
+  void onAsset(uint32_t idx, const Mark &start, uint32_t heapBytes);
+
+  struct ScopedPhase
+  {
+    Phase phase;
+    ScopedPhase(Phase p) : phase{p} { beginPhase(p); }
+    ~ScopedPhase() { endPhase(phase); }
+  };
+#else
+  inline void begin(uint16_t) {}
+  inline void end() {}
+  inline Mark mark() { return {}; }
+  inline void onComponent(uint8_t, const Mark&) {}
+  inline void onObject(uint16_t, const Mark&) {}
+  inline void onAsset(uint32_t, const Mark&, uint32_t) {}
+
+  struct ScopedPhase { ScopedPhase(Phase) {} };
+#endif
+}
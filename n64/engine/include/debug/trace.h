@@ -0,0 +1,109 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+#ifndef P64_TRACE
+  // scoped-zone frame tracer (dumped via 'Debug::Trace::dump'), build with '-DP64_TRACE=1' to enable
+  #define P64_TRACE 0
+#endif
+
+/**
+ * Lightweight tracer recording begin/end ticks of fixed zones into a preallocated ring buffer.
+ * Only the last 'EVENT_COUNT' events are kept, so it can stay enabled and be dumped once something looks off.
+ * The dump is written to the debug log (ISViewer/USB) as Chrome-trace JSON,
+ * framed by 'TRACE_MARKER_BEGIN'/'TRACE_MARKER_END', which can be opened in Perfetto or 'chrome://tracing'.
+ * Recording is not interrupt-safe, zones must only be used from the main thread.
+ */
+namespace Debug::Trace
+{
+  constexpr uint32_t EVENT_COUNT = 4096;
+  // argument for zones without any, otherwise e.g. the component ID or layer index
+  constexpr uint8_t NO_ARG = 0xFF;
+
+  constexpr const char* TRACE_MARKER_BEGIN = "[P64-TRACE-BEGIN]";
+  constexpr const char* TRACE_MARKER_END = "[P64-TRACE-END]";
+
+  enum class Zone : uint8_t
+  {
+    FRAME = 0,
+    SCENE_UPDATE,
+    TICK,
+    GLOBAL_SCRIPT,
+    COMP_UPDATE, // arg: component ID
+    COLLISION,
+    EVENTS,
+    AUDIO,
+    ASSETS,
+    DRAW,
+    CAMERA,      // arg: camera index
+    COMP_DRAW,   // arg: component ID
+    DRAW_QUEUE,
+    PIPELINE,
+    LAYER,       // arg: layer index
+    COUNT
+  };
+
+  constexpr const char* ZONE_NAMES[(uint32_t)Zone::COUNT] {
+    "Frame", "Update", "Tick", "Global-Script", "Comp-Update", "Collision", "Events",
+    "Audio", "Assets", "Draw", "Camera", "Comp-Draw", "Draw-Queue", "Pipeline", "Layer"
+  };
+
+  enum class Counter : uint8_t
+  {
+    RDP_BUSY_US = 0,
+    CPU_WAIT_US,
+    HEAP_KB,
+    OBJECTS,
+    COUNT
+  };
+
+#if P64_TRACE
+  void begin(Zone zone, uint8_t arg = NO_ARG);
+  void end(Zone zone);
+  void counter(Counter cnt, uint32_t value);
+
+  // ends the previous frame and starts a new one, also records the per-frame counters
+  void frame();
+
+  void start();
+  void stop();
+  [[nodiscard]] bool isRecording();
+
+  /**
+   * Writes all recorded events to the debug log and clears them.
+   * This is slow (several frames), events are not recorded while dumping.
+   */
+  void dump();
+
+  struct ScopedZone
+  {
+    Zone zone;
+    ScopedZone(Zone z, uint8_t arg = NO_ARG) : zone{z} { begin(z, arg); }
+    ~ScopedZone() { end(zone); }
+  };
+#endif
+}
+
+// after the zones, which it refers to
+#include "debug/allocTracker.h"
+
+#if P64_TRACE
+  #define P64_TRACE_CONCAT_(a, b) a##b
+  #define P64_TRACE_CONCAT(a, b) P64_TRACE_CONCAT_(a, b)
+
+  #define P64_TRACE_BEGIN(ZONE, ...) ::Debug::Trace::begin(::Debug::Trace::Zone::ZONE __VA_OPT__(,) __VA_ARGS__); P64_ALLOC_BEGIN(ZONE)
+  #define P64_TRACE_END(ZONE) ::Debug::Trace::end(::Debug::Trace::Zone::ZONE); P64_ALLOC_END(ZONE)
+  #define P64_TRACE_SCOPE(ZONE, ...) ::Debug::Trace::ScopedZone P64_TRACE_CONCAT(traceZone_, __LINE__)(::Debug::Trace::Zone::ZONE __VA_OPT__(,) __VA_ARGS__); P64_ALLOC_SCOPE(ZONE)
+  #define P64_TRACE_COUNTER(CNT, VALUE) ::Debug::Trace::counter(::Debug::Trace::Counter::CNT, VALUE)
+  #define P64_TRACE_FRAME() ::Debug::Trace::frame()
+#else
+  // zones still attribute heap allocations, see 'debug/allocTracker.h'
+  #define P64_TRACE_BEGIN(ZONE, ...) P64_ALLOC_BEGIN(ZONE)
+  #define P64_TRACE_END(ZONE) P64_ALLOC_END(ZONE)
+  #define P64_TRACE_SCOPE(ZONE, ...) P64_ALLOC_SCOPE(ZONE)
+  #define P64_TRACE_COUNTER(CNT, VALUE)
+  #define P64_TRACE_FRAME()
+#endif
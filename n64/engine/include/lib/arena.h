@@ -0,0 +1,142 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include "lib/types.h"
+
+namespace P64::Mem
+{
+  /**
+   * Linear (bump) allocator on top of a single heap block.
+   * Allocations can't be freed individually, instead the whole block
+   * is released at once via 'destroy()' (or re-used after a 'reset()').
+   */
+  class Arena
+  {
+    private:
+      uint8_t *base{nullptr};
+      uint32_t capacity{0};
+      uint32_t used{0};
+
+    public:
+      constexpr static uint32_t ALIGN = 8;
+
+      Arena() = default;
+      ~Arena() { destroy(); }
+
+      CLASS_NO_COPY_MOVE(Arena);
+
+      /**
+       * Allocates the backing memory, any previous block is freed first.
+       * @param size total size in bytes
+       */
+      void init(uint32_t size);
+
+      /**
+       * Takes over an existing heap block (malloc/realloc) as the backing memory.
+       * Only the first 'size' bytes are handed out, the rest can be cut off with 'trim()'.
+       * @param block heap block, 8-byte aligned
+       * @param size size in bytes to use
+       */
+      void adopt(void* block, uint32_t size);
+
+      /**
+       * Shrinks the backing block to the arena capacity, this never moves it.
+       */
+      void trim();
+
+      /**
+       * Frees the backing memory, NOP if nothing was allocated.
+       * All pointers handed out by 'alloc()' are invalid afterward.
+       */
+      void destroy();
+
+      /**
+       * Marks all memory as unused again, without freeing the block itself.
+       */
+      void reset() { used = 0; }
+
+      /**
+       * Allocates memory from the arena, the result is 8-byte aligned.
+       * @param size size in bytes
+       * @return pointer or nullptr if the arena is exhausted
+       */
+      void* alloc(uint32_t size);
+
+      [[nodiscard]] bool contains(const void* ptr) const {
+        return ptr >= base && ptr < (base + capacity);
+      }
+
+      [[nodiscard]] uint32_t getUsed() const { return used; }
+      [[nodiscard]] uint32_t getCapacity() const { return capacity; }
+  };
+
+  /**
+   * Pool for variable sized allocations that get created and freed often.
+   * Sizes are rounded up to a few size-classes, freed blocks are put into a
+   * per-class free-list to be re-used by later allocations.
+   * The backing arena is only allocated on first use.
+   * If it is exhausted (or the size is too large), it falls back to the heap.
+   */
+  class Pool
+  {
+    private:
+      constexpr static uint32_t CLASS_COUNT = 6; // 64, 128, ... 2048 bytes
+      constexpr static uint32_t CLASS_MIN_SIZE = 64;
+      constexpr static uint8_t CLASS_HEAP = 0xFF;
+
+      struct FreeBlock {
+        FreeBlock *next;
+      };
+
+      Arena arena{};
+      FreeBlock* freeList[CLASS_COUNT]{};
+      uint32_t poolSize{0};
+
+    public:
+      Pool() = default;
+      ~Pool() { destroy(); }
+
+      CLASS_NO_COPY_MOVE(Pool);
+
+      /**
+       * Sets the size of the backing arena, memory is reserved lazily on the first 'alloc()'.
+       * @param size total size in bytes
+       */
+      void init(uint32_t size);
+
+      /**
+       * Frees the backing arena, all pool allocations are invalid afterward.
+       * Allocations that fell back to the heap must have been freed before.
+       */
+      void destroy();
+
+      /**
+       * Allocates memory from the pool, the result is 8-byte aligned.
+       * @param size size in bytes
+       * @return pointer, never null
+       */
+      void* alloc(uint32_t size);
+
+      /**
+       * Returns memory from 'alloc()' back to the pool.
+       * @param ptr pointer, NOP if null
+       */
+      void free(void* ptr);
+
+      /**
+       * Hands over memory from somewhere else (e.g. an arena) to be re-used by the pool.
+       * The memory is split into blocks of the largest fitting size-classes,
+       * anything smaller than the smallest class is ignored.
+       * The caller must keep the memory alive until the pool is destroyed.
+       * @param mem 8-byte aligned pointer
+       * @param size size in bytes
+       */
+      void recycle(void* mem, uint32_t size);
+
+      [[nodiscard]] uint32_t getUsed() const { return arena.getUsed(); }
+      [[nodiscard]] uint32_t getCapacity() const { return poolSize; }
+  };
+}
@@ -0,0 +1,127 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <malloc.h>
+#include "lib/types.h"
+
+namespace P64::Lib
+{
+  /**
+   * Hash-map from a 16-bit ID to a pointer, using open addressing (linear probing).
+   * Lookups are O(1) for the entire ID range, the table grows when it gets half full.
+   * Null pointers can't be stored, they are used to mark empty slots.
+   */
+  template<typename T>
+  class IdMap
+  {
+    private:
+      struct Entry {
+        T* value;
+        uint16_t key;
+      };
+
+      Entry* entries{nullptr};
+      uint32_t mask{0};
+      uint32_t count{0};
+
+      [[nodiscard]] uint32_t slotOf(uint16_t key) const {
+        return ((key * 2654435761u) >> 16) & mask;
+      }
+
+      void resize(uint32_t newCapacity)
+      {
+        Entry* oldEntries = entries;
+        uint32_t oldCapacity = entries ? (mask + 1) : 0;
+
+        entries = (Entry*)malloc(sizeof(Entry) * newCapacity);
+        memset(entries, 0, sizeof(Entry) * newCapacity);
+        mask = newCapacity - 1;
+        count = 0;
+
+        for(uint32_t i=0; i<oldCapacity; ++i) {
+          if(oldEntries[i].value)set(oldEntries[i].key, oldEntries[i].value);
+        }
+        ::free(oldEntries);
+      }
+
+    public:
+      IdMap() = default;
+      ~IdMap() { clear(); }
+
+      CLASS_NO_COPY_MOVE(IdMap);
+
+      /**
+       * Inserts or replaces the entry for the given ID.
+       * @param key ID
+       * @param value pointer, must not be null
+       */
+      void set(uint16_t key, T* value)
+      {
+        if(!entries || (count+1)*2 > (mask+1)) {
+          resize(entries ? (mask+1)*2 : 256);
+        }
+
+        uint32_t idx = slotOf(key);
+        while(entries[idx].value) {
+          if(entries[idx].key == key) {
+            entries[idx].value = value;
+            return;
+          }
+          idx = (idx + 1) & mask;
+        }
+        entries[idx] = {value, key};
+        ++count;
+      }
+
+      [[nodiscard]] T* get(uint16_t key) const
+      {
+        if(!entries)return nullptr;
+        uint32_t idx = slotOf(key);
+        while(entries[idx].value) {
+          if(entries[idx].key == key)return entries[idx].value;
+          idx = (idx + 1) & mask;
+        }
+        return nullptr;
+      }
+
+      /**
+       * Removes an entry, NOP if the ID is not present.
+       * @param key ID
+       */
+      void remove(uint16_t key)
+      {
+        if(!entries)return;
+        uint32_t idx = slotOf(key);
+        while(entries[idx].value && entries[idx].key != key) {
+          idx = (idx + 1) & mask;
+        }
+        if(!entries[idx].value)return;
+
+        // shift back following entries of the same probe-chain, this avoids tombstones
+        uint32_t next = (idx + 1) & mask;
+        while(entries[next].value) {
+          uint32_t home = slotOf(entries[next].key);
+          if(((next - home) & mask) >= ((next - idx) & mask)) {
+            entries[idx] = entries[next];
+            idx = next;
+          }
+          next = (next + 1) & mask;
+        }
+        entries[idx] = {};
+        --count;
+      }
+
+      void clear()
+      {
+        ::free(entries);
+        entries = nullptr;
+        mask = 0;
+        count = 0;
+      }
+
+      [[nodiscard]] uint32_t size() const { return count; }
+  };
+}
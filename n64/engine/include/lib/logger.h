@@ -4,8 +4,22 @@
 */
 #pragma once
 #include <libdragon.h>
+#include <cstring>
 #include <source_location>
-#include <string>
+#include <tuple>
+#include <type_traits>
+
+#ifndef P64_LOG_LEVEL
+  // 0 = off, 1 = errors, 2 = +warnings, 3 = +info. Calls above the level are compiled out (incl. their strings),
+  // e.g. build release ROMs with '-DP64_LOG_LEVEL=1'
+  #define P64_LOG_LEVEL 3
+#endif
+
+#ifndef P64_LOG_DEFERRED
+  // info/warnings only store their arguments and get printed in 'Log::flush', errors are always printed right away.
+  // build with '-DP64_LOG_DEFERRED=0' to print everything immediately
+  #define P64_LOG_DEFERRED 1
+#endif
 
 namespace P64::Log
 {
@@ -21,29 +35,146 @@ namespace P64::Log
     #define SRC_ROOT_PATH_LENGTH 0
   #endif
 
+  enum class Level : uint8_t
+  {
+    ERROR = 1,
+    WARN  = 2,
+    INFO  = 3,
+  };
+
+  // strings are copied into the record (up to this length), the original may be gone once it's printed
+  constexpr uint32_t MAX_STR_ARG_LEN = 63;
+
+  /**
+   * Header of a deferred message, followed by the raw argument data.
+   * 'format' is instantiated per argument list, it knows how to unpack the data again.
+   */
+  struct Record
+  {
+    void (*format)(const Record &rec, const uint8_t* args);
+    const char* str;
+    const char* file;
+    uint16_t line;
+    uint16_t argSize;
+    Level level;
+  };
+
+  void printHeader(Level level, const char* file, uint32_t line);
+  void printFooter();
+
+  /**
+   * Reserves space for a record + 'argSize' bytes in the ring-buffer.
+   * @return pointer to the argument data, null if full (message is dropped and counted)
+   */
+  uint8_t* pushRecord(const Record &rec);
+
+  /**
+   * Prints all deferred messages, called by the scene-manager once per frame.
+   */
+  void flush();
+
+  // messages lost since the last flush because the buffer was full
+  uint32_t getDroppedCount();
+
+  namespace Detail
+  {
+    template<typename T>
+    constexpr bool IS_STR = std::is_same_v<std::decay_t<T>, const char*> || std::is_same_v<std::decay_t<T>, char*>;
+
+    template<typename T>
+    uint32_t argSize(const T &arg) {
+      if constexpr(IS_STR<T>) {
+        return (arg ? strnlen(arg, MAX_STR_ARG_LEN) : 0) + 1;
+      } else {
+        static_assert(std::is_trivially_copyable_v<T>, "Log arguments must be strings or trivially copyable");
+        return sizeof(T);
+      }
+    }
+
+    template<typename T>
+    void writeArg(uint8_t* &data, const T &arg) {
+      if constexpr(IS_STR<T>) {
+        uint32_t len = argSize(arg) - 1;
+        if(len)memcpy(data, arg, len);
+        data[len] = '\0';
+        data += len + 1;
+      } else {
+        memcpy(data, &arg, sizeof(T));
+        data += sizeof(T);
+      }
+    }
+
+    template<typename T>
+    T readArg(const uint8_t* &data) {
+      if constexpr(IS_STR<T>) {
+        auto str = (T)data;
+        data += strlen((const char*)data) + 1;
+        return str;
+      } else {
+        T res;
+        memcpy(&res, data, sizeof(T));
+        data += sizeof(T);
+        return res;
+      }
+    }
+
+    template <typename... ARGS>
+    void print(const char* str, ARGS... args) {
+      if constexpr(sizeof...(ARGS) == 0) {
+        debugf("%s", str);
+      } else {
+        debugf(str, args...);
+      }
+    }
+
+    template <typename... ARGS>
+    void formatRecord(const Record &rec, [[maybe_unused]] const uint8_t* args) {
+      // braced init, so the arguments are read in order
+      std::tuple<ARGS...> values{readArg<ARGS>(args)...};
+      printHeader(rec.level, rec.file, rec.line);
+      std::apply([&rec](auto... v) { print(rec.str, v...); }, values);
+      printFooter();
+    }
+  }
+
   template <typename... ARGS>
-  void log(const char* str, const srcLoc loc, const char* const prefix,  ARGS &&... args)
+  void log(const char* str, const srcLoc loc, Level level, ARGS &&... args)
   {
-    auto fmt = std::string(prefix) + " [%s:%d] " + str + RESET_SUFFIX;
-    debugf(fmt.c_str(), loc.file_name() + SRC_ROOT_PATH_LENGTH, loc.line(), args...);
+    const char* file = loc.file_name() + SRC_ROOT_PATH_LENGTH;
+    if(!P64_LOG_DEFERRED || level == Level::ERROR) {
+      if(P64_LOG_DEFERRED)flush(); // keeps the order, anything deferred happened before
+      printHeader(level, file, loc.line());
+      Detail::print(str, args...);
+      printFooter();
+      return;
+    }
+
+    uint32_t size = (0 + ... + Detail::argSize<std::decay_t<ARGS>>(args));
+    auto data = pushRecord({
+      .format = Detail::formatRecord<std::decay_t<ARGS>...>,
+      .str = str, .file = file,
+      .line = (uint16_t)loc.line(), .argSize = (uint16_t)size,
+      .level = level
+    });
+    if(data)(Detail::writeArg<std::decay_t<ARGS>>(data, args), ...);
   }
 
   template <typename... ARGS>
   struct info { info(const char* str, ARGS&&... args, srcLoc loc = srcLoc::current()) {
-      log(str, loc, PREFIX_INFO, args...);
+      if constexpr(P64_LOG_LEVEL >= 3)log(str, loc, Level::INFO, args...);
   }};
 
   template <typename... ARGS>
   struct warn { warn(const char* str, ARGS&&... args, srcLoc loc = srcLoc::current()) {
-      log(str, loc, PREFIX_WARN, args...);
+      if constexpr(P64_LOG_LEVEL >= 2)log(str, loc, Level::WARN, args...);
   }};
 
   template <typename... ARGS>
   struct error { error(const char* str, ARGS&&... args, srcLoc loc = srcLoc::current()) {
-      log(str, loc, PREFIX_ERROR, args...);
+      if constexpr(P64_LOG_LEVEL >= 1)log(str, loc, Level::ERROR, args...);
   }};
 
   template <typename... Ts> info(const char* str, Ts&&...args) -> info<Ts...>;
   template <typename... Ts> warn(const char* str, Ts&&...args) -> warn<Ts...>;
   template <typename... Ts> error(const char* str, Ts&&...args) -> error<Ts...>;
-}
\ No newline at end of file
+}
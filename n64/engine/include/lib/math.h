@@ -111,6 +111,89 @@ namespace P64::Math
     }};
   }
 
+  // Kernels for the collision / transform hot paths.
+  // The generic 'fm_quat_*' functions handle non-unit quaternions and go through pointers,
+  // these assume unit quaternions (as used by all objects) and are fully unrolled so GCC can keep everything in FPU registers.
+
+  /**
+   * Inverse of a unit quaternion, which is simply the conjugate (no division by the norm).
+   */
+  inline fm_quat_t quatInvUnit(const fm_quat_t &q) {
+    return fm_quat_t{{-q.x, -q.y, -q.z, q.w}};
+  }
+
+  /**
+   * Rotates 'v' by the unit quaternion 'q' as 'v + w*t + q.xyz x t' with 't = 2 * (q.xyz x v)'.
+   * This needs 15 multiplications, instead of two full quaternion products.
+   */
+  inline fm_vec3_t quatRotate(const fm_quat_t &q, const fm_vec3_t &v)
+  {
+    float tx = 2.0f * (q.y * v.z - q.z * v.y);
+    float ty = 2.0f * (q.z * v.x - q.x * v.z);
+    float tz = 2.0f * (q.x * v.y - q.y * v.x);
+    return fm_vec3_t{{
+      v.x + q.w * tx + (q.y * tz - q.z * ty),
+      v.y + q.w * ty + (q.z * tx - q.x * tz),
+      v.z + q.w * tz + (q.x * ty - q.y * tx)
+    }};
+  }
+
+  /**
+   * Rotates 'v' by the inverse of the unit quaternion 'q', without building the inverse first.
+   */
+  inline fm_vec3_t quatRotateInv(const fm_quat_t &q, const fm_vec3_t &v) {
+    return quatRotate(fm_quat_t{{-q.x, -q.y, -q.z, q.w}}, v);
+  }
+
+  inline bool aabbOverlap(const fm_vec3_t &minA, const fm_vec3_t &maxA, const fm_vec3_t &minB, const fm_vec3_t &maxB)
+  {
+    // bitwise '&' on purpose, avoids a branch per axis
+    return (minA.x <= maxB.x) & (maxA.x >= minB.x)
+         & (minA.y <= maxB.y) & (maxA.y >= minB.y)
+         & (minA.z <= maxB.z) & (maxA.z >= minB.z);
+  }
+
+  inline bool sphereVsAABB(const fm_vec3_t &center, float radius, const fm_vec3_t &min, const fm_vec3_t &max)
+  {
+    float dx = center.x - clamp(center.x, min.x, max.x);
+    float dy = center.y - clamp(center.y, min.y, max.y);
+    float dz = center.z - clamp(center.z, min.z, max.z);
+    return (dx*dx + dy*dy + dz*dz) <= (radius * radius);
+  }
+
+  /**
+   * Batched 'quatRotate', 'in' and 'out' may be the same array.
+   */
+  void quatRotate(const fm_quat_t &q, const fm_vec3_t *in, fm_vec3_t *out, uint32_t count);
+
+  /**
+   * Moves points into the local space of a transform: 'invRot * (p - pos) * invScale'.
+   * 'in' and 'out' may be the same array.
+   */
+  void intoLocalSpace(const fm_quat_t &invRot, const fm_vec3_t &invScale, const fm_vec3_t &pos,
+    const fm_vec3_t *in, fm_vec3_t *out, uint32_t count);
+
+  /**
+   * Moves points out of the local space of a transform: 'rot * (p * scale) + pos'.
+   * 'in' and 'out' may be the same array.
+   */
+  void outOfLocalSpace(const fm_quat_t &rot, const fm_vec3_t &scale, const fm_vec3_t &pos,
+    const fm_vec3_t *in, fm_vec3_t *out, uint32_t count);
+
+  /**
+   * Tests one AABB against up to 32 others.
+   * @return bit-mask of all overlapping boxes
+   */
+  uint32_t aabbOverlapMask(const fm_vec3_t &min, const fm_vec3_t &max,
+    const fm_vec3_t *mins, const fm_vec3_t *maxs, uint32_t count);
+
+  /**
+   * Tests one sphere against up to 32 AABBs.
+   * @return bit-mask of all overlapping boxes
+   */
+  uint32_t sphereVsAABBMask(const fm_vec3_t &center, float radius,
+    const fm_vec3_t *mins, const fm_vec3_t *maxs, uint32_t count);
+
   inline fm_vec3_t randDir3D() {
     fm_vec3_t res{{rand01()-0.5f, rand01()-0.5f, rand01()-0.5f}};
     fm_vec3_norm(&res, &res);
@@ -4,16 +4,67 @@
 */
 #pragma once
 #include <t3d/t3d.h>
+#include <cstring>
 
 namespace P64 {
+  /**
+   * Allocator for persistent (uncached) matrices.
+   * Memory grows in pages on demand, up to a capacity set per scene.
+   * Blocks are rounded up to a power of two, with a free-list for each size.
+   */
   namespace MatrixManager {
+    /**
+     * Frees all matrices, the RSP must no longer use any of them.
+     */
     void reset();
 
+    /**
+     * Sets the max. amount of matrices, only affects future allocations.
+     * @param count number of matrices, 0 for the default
+     */
+    void setCapacity(uint32_t count);
+
     T3DMat4FP* alloc(uint32_t count = 1);
     void free(T3DMat4FP* mat, uint32_t count = 1);
 
     uint32_t getTotalCapacity();
-    bool isUsed(uint32_t index);
+    uint32_t getAllocatedCount();
+    uint32_t getUsedCount();
+    uint32_t getHighWaterMark();
+  }
+
+  /**
+   * Linear allocator for short-lived matrices (debug draws, particles, other dynamic draws).
+   * Allocations are only valid for the frame they were made in, there is no 'free'.
+   * Memory is buffered per frame like the draw-layers, so the RSP can still read
+   * the matrices of previous frames while new ones are written.
+   */
+  namespace FrameMatrices {
+    // must match the buffer count of the draw-layers, which also advance this allocator
+    constexpr uint32_t BUFFER_COUNT = 3;
+
+    /**
+     * Sets the amount of matrices per frame, memory is allocated on the first 'alloc()'.
+     * Any previous memory is freed, the RSP must no longer use it.
+     * @param count matrices per frame, 0 for the default
+     */
+    void init(uint32_t count = 0);
+    void destroy();
+
+    /**
+     * Switches to the next buffer, all allocations in it are discarded.
+     */
+    void nextFrame();
+
+    /**
+     * @param count number of contiguous matrices
+     * @return pointer to uncached memory, or nullptr if the frame is exhausted
+     */
+    T3DMat4FP* alloc(uint32_t count = 1);
+
+    uint32_t getUsedCount();
+    uint32_t getHighWaterMark();
+    uint32_t getCapacity();
   }
 
   struct BuffMat4FP {
@@ -46,4 +97,49 @@ namespace P64 {
       }
     }
   };
+
+  /**
+   * Ring-buffered matrix that is only rebuilt if the transform changed since the last call.
+   * An unchanged transform re-uses the last matrix, which is safe since the slot
+   * the RSP may still be reading is never written to in that case.
+   */
+  struct CachedMat4FP {
+    RingMat4FP ring{};
+    fm_vec3_t lastScale{};
+    fm_quat_t lastRot{};
+    fm_vec3_t lastPos{};
+    bool isValid{false};
+
+    /**
+     * Stores the transform, the caller has to build the matrix in 'ring.getNext()' if this returns true.
+     * @return true if the transform changed
+     */
+    bool update(const fm_vec3_t &scale, const fm_quat_t &rot, const fm_vec3_t &pos)
+    {
+      if(isValid
+        && memcmp(&pos, &lastPos, sizeof(pos)) == 0
+        && memcmp(&rot, &lastRot, sizeof(rot)) == 0
+        && memcmp(&scale, &lastScale, sizeof(scale)) == 0
+      ) {
+        return false;
+      }
+
+      lastScale = scale;
+      lastRot = rot;
+      lastPos = pos;
+      isValid = true;
+      return true;
+    }
+
+    [[nodiscard]] T3DMat4FP* get(const fm_vec3_t &scale, const fm_quat_t &rot, const fm_vec3_t &pos)
+    {
+      if(!update(scale, rot, pos))return ring.get();
+
+      auto mat = ring.getNext();
+      t3d_mat4fp_from_srt(mat, scale, rot, pos);
+      return mat;
+    }
+
+    void invalidate() { isValid = false; }
+  };
 }
\ No newline at end of file
@@ -8,21 +8,19 @@
 namespace P64::Mem
 {
   /**
-   * Lazily allocates a depth buffer of the given size.
-   * If already allocated, it will return the same buffer.
-   * If the given size is different, the old buffer will be freed and a new one created.
+   * Allocates a block at the top of RDRAM, away from the heap.
+   * Used for the depth buffer (see 'RenderGraph::Heap::TOP'), so it ends up in a different bank than the color buffers.
+   * Only one block can exist at a time, falls back to the heap if there is no space left.
    *
-   * @param width
-   * @param height
-   * @return
+   * @param size in bytes
+   * @return uncached pointer
    */
-  surface_t& allocDepthBuffer(uint32_t width, uint32_t height);
+  void* allocTop(uint32_t size);
 
   /**
-   * Free the depth buffer, NOP if none was allocated.
-   * This is also done automatically in 'allocDepthBuffer' if re-allocation is needed.
+   * Frees the block of 'allocTop', NOP if none was allocated.
    */
-  void freeDepthBuffer();
+  void freeTop();
 
   /**
    * Checks heap stats to detect memory leaks.
@@ -33,6 +31,46 @@ namespace P64::Mem
    */
   int32_t getHeapDiff();
 
+  /**
+   * Categories for the memory budget tracking, see 'track()'.
+   */
+  enum class Category : uint8_t
+  {
+    ASSET_IMAGE,
+    ASSET_AUDIO,
+    ASSET_FONT,
+    ASSET_MODEL,
+    ASSET_OTHER,
+    MATRICES,
+    DRAW_LAYERS,
+    PARTICLES,
+    OBJECTS,
+    RENDER_TARGETS,
+    COUNT
+  };
+
+  /**
+   * Adds (or removes) bytes to the counter of a category.
+   * @param cat category
+   * @param bytes size, negative when freeing
+   */
+  void track(Category cat, int32_t bytes);
+
+  [[nodiscard]] uint32_t getTracked(Category cat);
+  [[nodiscard]] uint32_t getTrackedPeak(Category cat);
+  [[nodiscard]] const char* getCategoryName(Category cat);
+
+  /**
+   * Prints all tracked categories and the heap usage to the debug log.
+   */
+  void logTracked();
+
+  /**
+   * Returns the currently used heap in bytes.
+   * Can be used to measure allocations done by external code (e.g. asset loaders).
+   */
+  uint32_t getHeapUsed();
+
   inline void clearSurface(surface_t &surf) {
     sys_hw_memset64(surf.buffer, 0, surf.height * surf.stride);
   }
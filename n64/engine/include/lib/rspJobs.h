@@ -0,0 +1,89 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <t3d/t3d.h>
+
+/**
+ * Compute jobs for the RSP, to move batch work off the CPU while the RSP is idle during the update.
+ * Jobs run in the high-priority queue, so they don't wait for the draws of the last frame still being processed.
+ * Results are only valid after 'sync()', which the scene calls before the collision update and at the end of each tick.
+ *
+ * All buffers are read and written by DMA: they must be 8-byte aligned and left untouched by the CPU until synced.
+ * Outputs should be aligned to cache-lines (16 bytes), since anything sharing a line with them is invalidated.
+ */
+namespace P64::RSPJobs
+{
+  // input and output of 'transform', use w=1 for points and w=0 for directions
+  struct Point
+  {
+    int16_t x, y, z, w;
+  };
+
+  /**
+   * Queues a transformation of points by a matrix, the RSP writes the integer part of the result.
+   * @param mat matrix, read when the job runs
+   * @param in input points
+   * @param out output points, can be the same as 'in'
+   * @param count number of points
+   */
+  void transform(const T3DMat4FP *mat, const Point *in, Point *out, uint32_t count);
+
+  // sphere radius and coordinate limit of 'sphereVsTri', positions are relative to the sphere and scaled to that radius
+  constexpr int16_t SPHERE_TRI_RADIUS = 256;
+  constexpr int16_t SPHERE_TRI_MAX_COORD = 12288;
+
+  namespace SphereTriFlags
+  {
+    constexpr int16_t HIT_FACE = 1 << 0;
+    constexpr int16_t HIT_EDGE = 1 << 1;
+    constexpr int16_t NEAR     = 1 << 2; // within twice the radius
+  }
+
+  // 8 sphere-triangle pairs (one per lane), with 'pos = center - vertex' and the normal as s.15
+  struct alignas(16) SphereTriBlock
+  {
+    int16_t pos[3][3][8]; // [vertex][axis][lane]
+    int16_t normal[3][8];
+  };
+  static_assert(sizeof(SphereTriBlock) == 192);
+
+  struct alignas(16) SphereTriRes
+  {
+    int16_t pen[3][8]; // penetration (same scale as the input), only set on a hit
+    int16_t flags[8];
+  };
+  static_assert(sizeof(SphereTriRes) == 64);
+
+  /**
+   * Queues the sphere vs. triangle narrow-phase for pairs of a sphere and triangle,
+   * with the same results as 'Coll::Mesh::vsSphere', just at a lower precision.
+   * @param in input pairs
+   * @param out results, one per block
+   * @param blockCount number of blocks
+   */
+  void sphereVsTri(const SphereTriBlock *in, SphereTriRes *out, uint32_t blockCount);
+
+  /**
+   * Waits for all queued jobs, NOP if there are none.
+   */
+  void sync();
+
+  [[nodiscard]] bool isPending();
+
+  /**
+   * Waits for pending jobs and frees the ucode, called when the scene gets destroyed.
+   */
+  void destroy();
+
+  // jobs queued in the last frame
+  [[nodiscard]] uint32_t getJobCount();
+  // time the CPU spent waiting in 'sync()' in the last frame
+  [[nodiscard]] uint32_t getWaitTimeUs();
+
+  /**
+   * Resets the per-frame stats, called by the scene.
+   */
+  void nextFrame();
+}
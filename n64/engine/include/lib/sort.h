@@ -0,0 +1,30 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+
+namespace P64::Lib
+{
+  /**
+   * Stable insertion sort, meant for lists kept sorted across frames.
+   * If entries barely change from one frame to the next, this is close to linear.
+   * @param data entries to sort
+   * @param count number of entries
+   * @param less comparison, returns true if the first argument goes before the second one
+   */
+  template<typename T, typename Less>
+  void insertionSort(T* data, uint32_t count, Less &&less)
+  {
+    for(uint32_t i=1; i<count; ++i) {
+      auto entry = data[i];
+      int32_t j = (int32_t)i - 1;
+      while(j >= 0 && less(entry, data[j])) {
+        data[j+1] = data[j];
+        --j;
+      }
+      data[j+1] = entry;
+    }
+  }
+}
@@ -0,0 +1,101 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <vector>
+#include <algorithm>
+#include "lib/sort.h"
+
+namespace P64::Lib
+{
+  /**
+   * Uniform grid on the XZ-plane for proximity queries, 'T' needs a 'pos' member.
+   * Entries are kept sorted by their cell (row by row), which is updated once per frame.
+   * Like the collision broadphase, the order is kept across frames so re-sorting is close to linear.
+   * A query then only needs one binary search per row of cells it touches.
+   */
+  template<typename T>
+  class SpatialGrid
+  {
+    private:
+      struct Entry {
+        uint32_t key;
+        T* value;
+      };
+
+      std::vector<Entry> entries{};
+      float cellSizeInv;
+
+      [[nodiscard]] uint32_t cellOf(float v) const {
+        return (uint32_t)(std::clamp((int32_t)floorf(v * cellSizeInv), -0x7FFF, 0x7FFF) + 0x8000);
+      }
+
+      [[nodiscard]] uint32_t keyOf(const fm_vec3_t &pos) const {
+        return (cellOf(pos.z) << 16) | cellOf(pos.x);
+      }
+
+      static bool lessKey(const Entry &a, const Entry &b) { return a.key < b.key; }
+
+    public:
+      explicit SpatialGrid(float cellSize) : cellSizeInv{1.0f / cellSize} {}
+
+      void insert(T* value) {
+        Entry entry{keyOf(value->pos), value};
+        entries.insert(std::upper_bound(entries.begin(), entries.end(), entry, lessKey), entry);
+      }
+
+      template<typename Pred>
+      void removeIf(Pred &&pred) {
+        std::erase_if(entries, [&](const Entry &e) { return pred(e.value); });
+      }
+
+      void clear() { entries.clear(); }
+
+      /**
+       * Re-assigns all entries to the cell of their current position.
+       * Until the next call, queries find entries in the cell they were in at that time.
+       */
+      void update()
+      {
+        for(auto &entry : entries)entry.key = keyOf(entry.value->pos);
+        insertionSort(entries.data(), entries.size(), lessKey);
+      }
+
+      /**
+       * Calls 'f' for all entries in the cells overlapping the given area (XZ-plane), each only once.
+       * This is a coarse test, the caller still has to check the actual distance/bounds.
+       */
+      template<typename F>
+      void query(float minX, float minZ, float maxX, float maxZ, F &&f) const
+      {
+        uint32_t cellMinX = cellOf(minX);
+        uint32_t cellMaxX = cellOf(maxX);
+        uint32_t cellMinZ = cellOf(minZ);
+        uint32_t cellMaxZ = cellOf(maxZ);
+
+        // with more rows than entries, scanning everything is cheaper than a search per row
+        if(cellMaxZ - cellMinZ >= entries.size()) {
+          for(auto &entry : entries) {
+            uint32_t x = entry.key & 0xFFFF;
+            uint32_t z = entry.key >> 16;
+            if(x >= cellMinX && x <= cellMaxX && z >= cellMinZ && z <= cellMaxZ)f(entry.value);
+          }
+          return;
+        }
+
+        auto it = entries.begin();
+        for(uint32_t z=cellMinZ; z<=cellMaxZ; ++z)
+        {
+          uint32_t keyMax = (z << 16) | cellMaxX;
+          it = std::lower_bound(it, entries.end(), Entry{(z << 16) | cellMinX, nullptr}, lessKey);
+          for(; it != entries.end() && it->key <= keyMax; ++it) {
+            f(it->value);
+          }
+        }
+      }
+
+      [[nodiscard]] uint32_t size() const { return entries.size(); }
+  };
+}
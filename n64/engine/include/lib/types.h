@@ -16,7 +16,8 @@ namespace P64
     }
   #endif
 
-  consteval uint32_t crc32(const char* str, size_t len) {
+  // also used at runtime, e.g. for the path lookup of assets
+  constexpr uint32_t crc32(const char* str, size_t len) {
     uint32_t crc = 0xFFFFFFFF;
     for (size_t i = 0; i < len; i++) {
       crc ^= static_cast<uint8_t>(str[i]);
@@ -0,0 +1,75 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+/**
+ * Batched 2D drawing for HUDs and overlays.
+ * Sprites and rectangles are collected during the frame, 'flush()' then emits them per 2D-layer,
+ * grouped by render mode and texture, so each texture is only loaded into TMEM once.
+ * Draws only keep their relative order when it is given explicitly via 'order',
+ * within the same order value they are free to be re-arranged.
+ * Everything batched is drawn on top of direct 'rdpq' draws into the same layer.
+ */
+namespace P64::Batch2D
+{
+  enum class Blend : uint8_t
+  {
+    NONE,     // alpha-compare only (cut-out)
+    MULTIPLY, // standard alpha blending
+  };
+
+  struct SpriteParams
+  {
+    // region of the sprite to draw, width/height of 0 is the entire sprite
+    uint16_t s{0};
+    uint16_t t{0};
+    uint16_t width{0};
+    uint16_t height{0};
+    float scaleX{1.0f};
+    float scaleY{1.0f};
+    color_t color{0xFF, 0xFF, 0xFF, 0xFF}; // multiplied with the texture
+    Blend blend{Blend::MULTIPLY};
+    uint8_t order{0}; // higher values are drawn on top
+    uint8_t layer{0}; // 2D-layer, see 'DrawLayer::use2D'
+  };
+
+  struct RectParams
+  {
+    color_t color{0xFF, 0xFF, 0xFF, 0xFF};
+    Blend blend{Blend::NONE};
+    uint8_t order{0};
+    uint8_t layer{0};
+  };
+
+  /**
+   * Queues a sprite, the sprite must stay valid until the frame is drawn.
+   * @param sprite sprite to draw
+   * @param x screen position (top-left)
+   * @param y screen position (top-left)
+   * @param params region, color and order
+   */
+  void sprite(sprite_t *sprite, float x, float y, const SpriteParams &params = {});
+
+  /**
+   * Queues a solid rectangle.
+   */
+  void rect(float x0, float y0, float x1, float y1, const RectParams &params = {});
+
+  /**
+   * Emits all queued draws into their 2D-layers, called by the scene after the 2D hooks.
+   */
+  void flush();
+
+  /**
+   * Frees the buffer, done when a scene is unloaded.
+   */
+  void destroy();
+
+  // draws, texture uploads and render-mode changes in the last flush
+  uint32_t getDrawCount();
+  uint32_t getLoadCount();
+  uint32_t getModeCount();
+}
@@ -7,18 +7,54 @@
 #include <libdragon.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace P64::Renderer::BigTex
 {
+  /**
+   * Pool of 64KB pages at 'TEX_BASE_ADDR', each holding one 256x256 texture.
+   * Textures are referenced by a virtual ID and only get a page once drawn ('use'),
+   * so a scene can have more textures than fit into memory.
+   * Missing ones are streamed in from ROM by 'update', evicting the least recently used page.
+   * Until then, 'use' returns a blank fallback page instead.
+   */
   class Textures
   {
+    public:
+      constexpr static uint8_t NO_PAGE = 0xFF;
+
     private:
+      struct Entry {
+        std::string path{};
+        uint32_t romAddr{0}; // 0 if it can't be DMA'd directly, loaded through the filesystem instead
+        uint32_t lastUsed{0};
+        uint8_t page{NO_PAGE};
+        bool pinned{false}; // placeholders, always keep their page
+      };
+
+      struct Page {
+        uint32_t lastUsed{0};
+        uint8_t texId{NO_PAGE};
+      };
+
       uint8_t* buffer{};
+      uint8_t* fallback{};
       uint32_t maxSize{};
-      uint32_t idx{0};
+      uint32_t frame{1};
 
+      std::vector<Entry> entries{};
+      std::vector<Page> pages{};
       std::unordered_map<std::string, uint8_t> texMap{};
 
+      // page currently filled by DMA, becomes usable in the next 'update'
+      uint8_t pendingPage{NO_PAGE};
+      uint8_t pendingTex{NO_PAGE};
+      uint32_t pageInCount{0};
+
+      uint8_t findFreePage(bool allowEvict);
+      void loadPage(uint8_t texId, uint8_t page, bool async);
+      uint8_t getFallbackAddr();
+
     public:
       Textures(uint32_t maxSize_);
       ~Textures();
@@ -28,6 +64,22 @@ namespace P64::Renderer::BigTex
 
       uint8_t setTexture(uint8_t texIdx, const std::string &pathNew);
 
+      /**
+       * Marks a texture as used in this frame.
+       * @return upper address byte (red channel of the UV buffer) to draw it with
+       */
+      uint8_t use(uint8_t texId);
+
+      /**
+       * Finishes the last transfer and starts streaming the most recently requested missing texture.
+       * Called once per frame before drawing.
+       */
+      void update();
+
       [[nodiscard]] const uint8_t* getBuffer() const { return buffer; }
+      [[nodiscard]] uint32_t getTextureCount() const { return entries.size(); }
+      [[nodiscard]] uint32_t getPageCount() const { return maxSize; }
+      // textures loaded since the start of the scene, excl. the initial ones
+      [[nodiscard]] uint32_t getPageInCount() const { return pageInCount; }
   };
-}
\ No newline at end of file
+}
@@ -0,0 +1,72 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+namespace P64
+{
+  class Object;
+}
+
+namespace P64::Coll
+{
+  class Scene;
+}
+
+/**
+ * Simple round drop-shadows below objects, projected onto the collision geometry.
+ * Casters register each tick, the ground below all of them is found with one batched raycast.
+ * All shadows are then drawn as textured quads with a single material setup.
+ * This is managed by the scene, game code only has to call 'addCaster' or 'addShadow'.
+ */
+namespace P64::BlobShadows
+{
+  // shadows per frame, anything beyond that is dropped
+  constexpr uint32_t MAX_SHADOWS = 32;
+
+  /**
+   * Registers an object to cast a shadow for the current tick.
+   * Hits of casters that didn't move since the last tick are reused,
+   * so moving collision meshes below a resting object are not detected.
+   * @param obj object, the ray is cast straight down from its position
+   * @param size radius of the shadow
+   * @param strength opacity (0-1)
+   * @param fadeHeight height above the ground at which the shadow is gone, shrinks and fades linearly
+   */
+  void addCaster(Object &obj, float size, float strength = 1.0f, float fadeHeight = 1000.0f);
+
+  /**
+   * Adds a shadow at a known position for the current frame, e.g. from an existing raycast.
+   * @param pos point on the ground
+   * @param normal ground normal
+   * @param size radius of the shadow
+   * @param strength opacity (0-1)
+   */
+  void addShadow(const fm_vec3_t &pos, const fm_vec3_t &normal, float size, float strength = 1.0f);
+
+  /**
+   * Sets the 3D layer shadows are drawn into, by default the first one.
+   * A separate layer without depth-writes is recommended.
+   */
+  void setLayer(uint8_t layerIdx3D);
+
+  uint32_t getShadowCount();
+  uint32_t getCasterCount();
+  // casters that needed a new raycast in the last tick
+  uint32_t getRaycastCount();
+
+  // called by the scene:
+  void init();
+  void destroy();
+
+  // clears all casters, at the start of every tick
+  void reset();
+  // casts rays for all casters that moved, after the collision update of a tick
+  void resolve(Coll::Scene &collScene);
+  // writes the quads of this frame, once before drawing any camera
+  void prepare();
+  // draws all shadows for the current camera
+  void draw();
+}
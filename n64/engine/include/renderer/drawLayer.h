@@ -31,8 +31,9 @@ namespace P64::DrawLayer
     FogMode fogMode{};
 
     uint8_t padding0{};
-    uint8_t padding1{};
-    uint8_t padding2{};
+    // command buffer size in words (only without libdragon queues), 0 = default.
+    // picked by the build from the peaks of the last benchmark run, unless set in the editor
+    uint16_t bufferWords{};
 
   };
 
@@ -45,7 +46,10 @@ namespace P64::DrawLayer
     Conf layerConf[16]{};
   };
 
-  void init(Setup &setup);
+  /**
+   * @param useDepth false if there is no depth-buffer, depth flags of all layers are then ignored
+   */
+  void init(Setup &setup, bool useDepth = true);
 
   void use(uint32_t idx);
 
@@ -55,6 +59,22 @@ namespace P64::DrawLayer
 
   inline void useDefault() { use(0); }
 
+  // layer commands are currently recorded into, 0 = main queue
+  uint32_t getCurrent();
+
+  /**
+   * Checks if a layer uses a blender, draws in it should then be sorted back-to-front.
+   */
+  bool isTranslucent(uint32_t idx);
+
+  /**
+   * Checks if draws in a layer have to be sorted back-to-front.
+   * Either translucent, or there is no depth-buffer to resolve the order.
+   */
+  bool isBackToFront(uint32_t idx);
+
+  bool hasDepth();
+
 
   void draw(uint32_t layerIdx);
 
@@ -64,4 +84,39 @@ namespace P64::DrawLayer
 
   void nextFrame();
   void reset();
+
+  struct Stats
+  {
+    uint32_t words;    // command words recorded in the last frame
+    uint32_t peak;     // max. words in a frame since the scene was loaded
+    uint32_t average;  // average over the last frames
+    uint32_t capacity; // buffer size in words, 0 if it grows as needed (libdragon queues)
+  };
+
+  /**
+   * Number of layers with their own command buffer, all but the first one (main queue).
+   */
+  uint32_t getBufferedCount();
+
+  /**
+   * Usage of a layers command buffer.
+   * @param idx layer index, 1 to 'getBufferedCount()'
+   */
+  Stats getStats(uint32_t idx);
+
+  /**
+   * Debug view to find fill-rate hot spots: every pixel drawn adds a constant color instead of its own,
+   * without any depth test, so the brightness shows the overdraw. Materials with their own blender are not affected.
+   * While enabled, the RDP cycles spent in each layer are measured as well (adds a full sync per layer).
+   */
+  void setHeatmap(bool enabled);
+  bool isHeatmapEnabled();
+
+  /**
+   * RDP pipeline cycles a layer took in the last measured frame, only updated with the heatmap enabled.
+   * In 1-cycle mode this is roughly the pixel count, 2-cycle mode takes twice as long.
+   * @param idx layer index, 'FILL_IDX_POST' for anything between the particle and 2D layers (e.g. bloom)
+   */
+  uint32_t getFillCycles(uint32_t idx);
+  constexpr uint32_t FILL_IDX_POST = 16;
 }
@@ -0,0 +1,85 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+
+namespace P64
+{
+  class Object;
+}
+
+namespace P64::Renderer
+{
+  struct Material;
+}
+
+/**
+ * Deferred submission of 3D draws, used by model components.
+ * Instead of recording commands in object order, draws are collected
+ * and then emitted sorted by layer, then material and depth.
+ * Opaque layers are drawn front-to-back, layers with a blender back-to-front.
+ * Consecutive draws on the same layer or with identical materials share the layer switch
+ * and the material begin/end calls, different materials only emit the overrides that changed.
+ */
+namespace P64::DrawQueue
+{
+  typedef void(*FuncDraw)(Object& obj, void* data);
+
+  struct Instance
+  {
+    Object *obj;
+    void *data;
+  };
+
+  /**
+   * Draws multiple queued entries at once, all sharing the same 'batchKey', material and layer.
+   * This allows to set up state only once for a run of instances of the same model.
+   */
+  typedef void(*FuncDrawBatch)(const Instance* instances, uint32_t count);
+
+  /**
+   * Queues up a draw for the current camera.
+   * @param obj object to draw, also used for its position to sort by depth
+   * @param data user data passed to 'funcDraw' (e.g. the component)
+   * @param funcDraw records the actual draw (matrix, blocks), layer and material are already set
+   * @param material material to apply, must stay valid until 'flush()'
+   * @param batchKey secondary sort key after the material (e.g. the model pointer)
+   * @param layerIdx 3D layer to draw into
+   * @param funcBatch optional, draws a run of neighboring entries with the same 'batchKey' instead of 'funcDraw'
+   * @param textureGroup sorted by after the material, draws sharing a texture end up next to each other
+   */
+  void submit(Object &obj, void* data, FuncDraw funcDraw,
+    const Renderer::Material &material, uint32_t batchKey, uint8_t layerIdx,
+    FuncDrawBatch funcBatch = nullptr, uint16_t textureGroup = 0
+  );
+
+  /**
+   * Tracks the last material set up by a draw, so a following one can skip loading the same textures again.
+   * Only valid while in 'flush()', which forgets the last one whenever other state may have changed in between.
+   * @param key identifies the material (e.g. the T3DMaterial)
+   * @return true if it has to be set up, false if it is still active
+   */
+  bool useMaterialBlock(const void* key);
+
+  /**
+   * Forgets the last material, needed after recording anything changing textures or modes outside of 'useMaterialBlock'.
+   */
+  void resetMaterialBlock();
+
+  /**
+   * Sorts and emits all queued draws, the queue is empty afterward.
+   * Called by the scene after all components are drawn for a camera.
+   */
+  void flush();
+
+  void reset();
+
+  // stats of the last flush
+  uint32_t getDrawCount();
+  uint32_t getMaterialSwitches();
+  uint32_t getLayerSwitches();
+  uint32_t getBatchCount();
+  uint32_t getSkippedMaterials();
+}
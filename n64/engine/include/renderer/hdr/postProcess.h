@@ -4,23 +4,64 @@
 */
 #pragma once
 #include <libdragon.h>
+#include "lib/types.h"
+#include "renderer/renderGraph.h"
 
 namespace P64::Renderer::HDR
 {
+  enum class Quality : uint8_t
+  {
+    HIGH, // 4:1 bloom, 4 blur steps every frame
+    MEDIUM, // 4:1 bloom, 4 blur steps split across two frames
+    LOW, // 8:1 bloom, 2 blur steps every second frame
+  };
+
+  // how often the bloom (downscale + blur chain) is computed, the final composite happens every frame
+  enum class BloomUpdate : uint8_t
+  {
+    FULL, // every frame
+    HALF_RATE, // every second frame, re-using the last one in between
+    SPLIT, // half the blur steps per frame, each bloom takes two frames to finish
+  };
+
   struct Config {
     int blurSteps{}; // how often to blur the low-res image
     float blurBrightness{}; // brightness of the blur aka bloom
     float hdrFactor{}; // HDR exposure factor, 1.0 to get standard color range
     float bloomThreshold{}; // threshold to ignore pixels before blurring
     bool scalingUseRDP{}; // if true, use RDP for initial downscaling
+    BloomUpdate updateMode{};
   };
 
+  /**
+   * Returns the blur downscale-factor for a quality tier, needed to allocate buffers.
+   */
+  constexpr uint32_t getScaleFactor(Quality quality) {
+    return quality == Quality::LOW ? 8 : 4;
+  }
+
+  /**
+   * Applies the quality tier to a config, keeping brightness/exposure settings.
+   */
+  void applyQuality(Config &conf, Quality quality);
+
+  /**
+   * Enables timing of the post-processing, this waits for the RSP/RDP each frame
+   * so it should only be used to compare settings (e.g. from the debug overlay).
+   */
+  void setMeasurePerf(bool enabled);
+  // time of the last measured frame, 0 if disabled
+  uint32_t getPerfTimeUs();
+
   class PostProcess
   {
     private:
-      surface_t surfHDR{};
-      surface_t surfBlurA{};
-      surface_t surfBlurB{};
+      // owned by the graph of the pipeline, see 'declare'
+      RenderGraph::ResId resHDR{};
+      RenderGraph::ResId resBlurA{};
+      RenderGraph::ResId resBlurB{};
+      uint32_t sizeY{};
+      uint32_t sizeLowY{};
 
       // subsection of the above to allow OOB access in the ucode
       surface_t surfHDRSafe{};
@@ -30,16 +71,61 @@ namespace P64::Renderer::HDR
 
       Config conf{};
       float relBrightness{0.0f};
+      uint32_t scaleFactor{4};
+      // the ucode has a fixed layout (320x240 -> 80x60, RGBA16 out), everything else uses the RDP
+      bool useUcode{false};
+      // whether this frame starts a new bloom, or re-uses/finishes the one from the last frame
+      bool updateBloom{true};
+      // split mode only, blur steps are still left to do
+      bool blurPending{false};
+      // buffer holding the latest blur step
+      surface_t *blurOut{nullptr};
+
+      void downscale();
+      void blur(int stepStart, int stepEnd, float bloomFactor);
+      void blurRDP(surface_t &input, surface_t &output, float threshold);
+      void compositeRDP(const surface_t &bloom, surface_t& dst, float bloomFactor);
 
     public:
-      PostProcess();
+      PostProcess() = default;
       ~PostProcess();
 
+      CLASS_NO_COPY_MOVE(PostProcess);
+
+      /**
+       * Declares all buffers in the graph, they are sized based on the screen and downscale factor.
+       * Their content is used by the following frames (split/half-rate bloom), so they are persistent.
+       * @param graph graph of the pipeline
+       * @param passDraw pass drawing into the HDR buffer, also downscales it
+       * @param passPost pass applying blur and tone-mapping
+       * @param width screen width
+       * @param height screen height
+       * @param scale downscale factor for the bloom (2, 4 or 8)
+       * @param outIs32Bit format of the final output buffer
+       */
+      void declare(RenderGraph &graph, RenderGraph::PassId passDraw, RenderGraph::PassId passPost,
+        uint32_t width, uint32_t height, uint32_t scale, bool outIs32Bit);
+
+      // takes the buffers from the compiled graph
+      void init(RenderGraph &graph);
+
       void setConf(const Config &config) { conf = config; }
 
-      void beginFrame();
+      /**
+       * Starts rendering into the HDR buffer.
+       * @param newBloom if false, the bloom of the previous frame will be re-used
+       */
+      void beginFrame(bool newBloom = true);
       void endFrame();
-      surface_t &applyEffects(surface_t& dst);
+
+      /**
+       * Applies bloom and tone-mapping, writing the final image into 'dst'.
+       * @param dst output buffer
+       * @param lastBloom bloom of the previous frame, used if this frame doesn't compute a new one
+       * @param prev post-process of the previous frame, finishes its bloom in split mode
+       * @return bloom buffer that was used
+       */
+      surface_t &applyEffects(surface_t& dst, surface_t* lastBloom = nullptr, PostProcess* prev = nullptr);
 
       float getBrightness() const { return relBrightness; }
   };
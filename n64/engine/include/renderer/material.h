@@ -35,8 +35,20 @@ namespace P64::Renderer
       return valFlags & 0b10;
     }
 
-    void begin(Object &obj);
-
-    void end();
+    /**
+     * Applies the overrides, only emitting what differs from the state the last material left behind.
+     * Restoring the defaults is deferred until a material without that override is used, or 'restore' is called.
+     * Draws using an override are expected to not set that value themselves (e.g. the prim. color of the model).
+     */
+    void begin(Object &obj) const;
+
+    // ends what can't be shared with the next material (lighting)
+    void end() const;
+
+    /**
+     * Restores the defaults of anything overridden so far, and forgets what was set.
+     * Needed before anything else changes modes or colors, e.g. switching layers.
+     */
+    static void restore();
   };
 }
@@ -0,0 +1,42 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "lib/matrixManager.h"
+
+/**
+ * Batched building of object matrices (scale, rotation, position to 'T3DMat4FP').
+ * Components prepare their matrices while recording draws, 'flush()' then builds all changed ones at once.
+ * Larger batches are handed to a small RSP ucode which writes the fixed-point matrices directly
+ * into their 'MatrixManager' memory, smaller ones are built on the CPU.
+ * Since the RSP runs in order with the draws, the matrices can be used right after 'flush()'.
+ */
+namespace P64::MatrixBatch
+{
+  /**
+   * Queues a rebuild of the cached matrix if the transform changed.
+   * The next 'cache.get()' with the same transform returns the new matrix,
+   * it only has valid contents after the next 'flush()'.
+   */
+  void prepare(CachedMat4FP &cache, const fm_vec3_t &scale, const fm_quat_t &rot, const fm_vec3_t &pos);
+
+  /**
+   * Builds all prepared matrices, must be called before any draw using them is recorded.
+   */
+  void flush();
+
+  /**
+   * Switches to the next input buffer, follows the buffering of the draw-layers.
+   */
+  void nextFrame();
+
+  /**
+   * Frees all buffers and the ucode, the RSP must no longer use them.
+   */
+  void destroy();
+
+  // matrices built in the last frame, and how many of them on the RSP
+  uint32_t getCount();
+  uint32_t getCountRSP();
+}
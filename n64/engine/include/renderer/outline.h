@@ -25,6 +25,8 @@
  *   N64-class hardware that lacks post-processing edge detection.
  *   The vertex expansion is done at load time (baked into a second
  *   vertex buffer) to avoid per-frame computation.
+ *   Hulls are shared between all objects using the same model and
+ *   thickness, see outline_acquire_hull().
  *
  * Integration:
  *   The outline component is attached per-object and can be toggled
@@ -59,9 +61,13 @@ typedef struct {
   
   /** Outline mode: 0 = silhouette (hull back-face), 1 = contour */
   uint8_t mode;
+
+  /** Max. distance to the camera for the hull pass, 0 to always draw.
+   *  Far away the outline is only a few pixels wide anyway. */
+  float drawDistance;
   
   /** The pre-expanded vertex buffer for the hull pass.
-   *  Built by outline_bake_hull() at load time. */
+   *  Fetched via outline_acquire_hull() at load time, may be shared. */
   T3DModel *hullModel;
 } OutlineConf;
 
@@ -86,6 +92,22 @@ T3DModel* outline_bake_hull(const T3DModel *src, float thickness);
  */
 void outline_free_hull(T3DModel *hull);
 
+/**
+ * Shared version of outline_bake_hull().
+ * Objects using the same source model and thickness get the same hull,
+ * it is only baked for the first one and reference counted after that.
+ *
+ * @param src       Source T3DModel
+ * @param thickness Expansion distance in model units
+ * @return          Hull model, must be released via outline_release_hull()
+ */
+T3DModel* outline_acquire_hull(const T3DModel *src, float thickness);
+
+/**
+ * Release a hull from outline_acquire_hull(), freed once no object uses it anymore.
+ */
+void outline_release_hull(T3DModel *hull);
+
 /**
  * Draw the outline hull (back-face pass).
  * Call this BEFORE drawing the normal mesh.
@@ -0,0 +1,54 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "renderer/particles/ptxSystem.h"
+
+/**
+ * Particle simulation on the RSP.
+ * This advances position, velocity and alpha of a (S16) particle system directly in its TPX buffer,
+ * so only spawning and removing particles is left to the CPU.
+ * Any other per-particle data stays untouched.
+ */
+namespace P64::PTX::RspSim
+{
+  /**
+   * Per particle state, stored in a separate (uncached) buffer with the same order as the TPX one.
+   * The last lane acts on the alpha of the particle color, so 'vel[3]' is the fade speed.
+   */
+  struct State
+  {
+    int16_t vel[4]; // x/y/z/alpha per second, 12.4 fixed-point
+    uint16_t frac[4]; // fractional part of the position/alpha
+  };
+
+  // scale of a single 'vel' unit in world units (or alpha) per second
+  constexpr float VEL_SCALE = 16.0f;
+
+  /**
+   * Registers the ucode, reference-counted so each user can call it.
+   * Must be paired with a 'destroy()'.
+   */
+  void init();
+  void destroy();
+
+  /**
+   * Queues a simulation step for all particles of the system.
+   * This runs in order with other RSP commands, so it must be issued before the system is drawn.
+   * Buffers are read and written back by the RSP, they must not be touched by the CPU until it's done.
+   *
+   * @param system particle system, must be of an S16 type
+   * @param state state buffer, sized for 'countMax' particles
+   * @param deltaTime time-step in seconds
+   * @param gravity added to the Y velocity per second, 12.4 fixed-point
+   */
+  void simulate(const System &system, State* state, float deltaTime, int16_t gravity);
+
+  /**
+   * Allocates a state buffer for the given system, all zero.
+   * @return buffer in uncached memory, free with 'freeState()'
+   */
+  State* allocState(const System &system);
+  void freeState(const System &system, State* state);
+}
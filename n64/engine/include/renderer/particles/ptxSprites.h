@@ -16,6 +16,7 @@ namespace P64::PTX
         uint32_t maxSize{};
         uint8_t isRotating{false};
         uint8_t noRng{false};
+        uint8_t cached{false}; // see 'System::isCached'
       };
 
       System system;
@@ -25,8 +25,16 @@ namespace P64::PTX
     uint32_t count{};
 
     const Type type;
+    // buffer is in cached memory, see constructor
+    const bool isCached;
 
-    System(Type ptxType, uint32_t maxSize = 0);
+    /**
+     * @param ptxType particle format
+     * @param maxSize max. particle count
+     * @param cached allocates the buffer in cached memory, which is a lot faster for CPU writes.
+     *               It gets written back once in 'draw()', so it must not be modified by the RSP.
+     */
+    System(Type ptxType, uint32_t maxSize = 0, bool cached = false);
     ~System();
 
     TPXParticleS8* getBufferS8() const {
@@ -53,6 +61,33 @@ namespace P64::PTX
       }
     }
 
+    /**
+     * Removes all particles for which 'isDead(index)' returns true, in a single pass.
+     * Unlike repeated calls to 'removeParticle()' this keeps the order of the remaining ones.
+     * @param isDead callback to check a particle
+     * @param onMove called as 'onMove(dst, src)' for each particle moved in the buffer,
+     *               to move any extra per-particle data alongside it
+     */
+    template<typename FDead, typename FMove>
+    void compact(FDead isDead, FMove onMove)
+    {
+      bool isS16 = type == COLOR_A_S16 || type == TEX_A_S16;
+      uint32_t dst = 0;
+      for(uint32_t src=0; src<count; ++src) {
+        if(isDead(src))continue;
+        if(dst != src) {
+          if(isS16) {
+            tpx_buffer_s16_copy(getBufferS16(), dst, src);
+          } else {
+            tpx_buffer_s8_copy(getBufferS8(), dst, src);
+          }
+          onMove(dst, src);
+        }
+        ++dst;
+      }
+      count = dst;
+    }
+
     void draw() const;
   };
 }
\ No newline at end of file
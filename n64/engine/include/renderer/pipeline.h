@@ -4,6 +4,7 @@
 */
 #pragma once
 #include <libdragon.h>
+#include "renderGraph.h"
 
 namespace P64
 {
@@ -16,8 +17,31 @@ namespace P64
 
       void setupLayer();
 
+      /**
+       * Advances the depth slice used for this frame (see 'SceneConf::FLAG_DEPTH_SLICES').
+       * Slices go from far to near, so a frame always passes the depth test against what is left over.
+       * @return true if the depth buffer has to be cleared this frame
+       */
+      bool nextDepthSlice();
+
+      /**
+       * Clears depth and color according to the scene flags,
+       * with slices or a backdrop this is skipped in most frames.
+       */
+      void clearBuffers();
+
+      /**
+       * Whether the depth buffer has to keep its content across frames (slices, or never cleared).
+       * Otherwise it's only needed during the scene pass, and can share memory with later targets.
+       */
+      [[nodiscard]] bool isDepthPersistent() const;
+
+      // owns all render targets of the pipeline, declared and compiled in 'init()'
+      RenderGraph graph{};
+
       surface_t *surfColor{};
       surface_t *surfDepth{};
+      uint32_t frameCount{0};
 
     public:
       explicit RenderPipeline(Scene &sc) : scene{sc} {}
@@ -34,7 +58,18 @@ namespace P64
   class RenderPipelineDefault final : public RenderPipeline
   {
     private:
-      surface_t surfFbColor[3]{};
+      RenderGraph::ResId resFb[3]{};
+      RenderGraph::ResId resDepth{};
+      surface_t surfFbColor[3]{}; // view into the graph targets, shown by the VI
+      surface_t surfDepthView{};
+
+      // dynamic resolution, see 'updateDynRes'
+      uint32_t ticksPassStart[3]{};
+      uint8_t dynResStep{0};
+      int8_t dynResCounter{0}; // >0: frames over budget, <0: frames with headroom
+      bool dynResEnabled{false};
+
+      void updateDynRes(uint32_t fbIndex);
 
     public:
       using RenderPipeline::RenderPipeline;
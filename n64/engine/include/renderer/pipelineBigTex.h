@@ -21,6 +21,14 @@ namespace P64
       Renderer::BigTex::UVTexture uvTex{};
       uint32_t drawMode{DRAW_MODE_DEF};
 
+      // slices (out of 16) of the texture application done on the RSP, the CPU does the rest.
+      // with 'balanceSlices', this is adjusted each frame to whichever side finishes first
+      uint32_t rspSliceCount{4};
+      bool balanceSlices{true};
+      int8_t balanceCounter{0};
+      // CPU time spent on its slices in the last frame
+      uint64_t ticksTexCPU{0};
+
       using RenderPipeline::RenderPipeline;
       ~RenderPipelineBigTex() override;
 
@@ -22,8 +22,11 @@ namespace P64
       // Output
       constexpr static uint32_t BUFF_COUNT = 3;
       surface_t surfFbColor[BUFF_COUNT]{};
+      RenderGraph::ResId resDepth{};
       Renderer::HDR::PostProcess postProc[BUFF_COUNT]{};
       uint32_t frameIdx{};
+      uint32_t bloomFrame{};
+      surface_t *lastBloom{};
 
     public:
       using RenderPipeline::RenderPipeline;
@@ -0,0 +1,114 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+#include <initializer_list>
+#include "lib/types.h"
+
+namespace P64
+{
+  /**
+   * Declares the render targets of a pipeline together with the passes using them.
+   * 'compile()' computes the lifetime of each target (first to last pass using it) and places all of them
+   * in one block per heap, targets whose lifetimes don't overlap share the same memory.
+   *
+   * Passes are only declared for the lifetimes, the pipeline still records them itself in the declared order.
+   * Aliasing relies on the RDP/RSP queue executing them in that order, so anything touched by the CPU
+   * or read by a later frame (frame-buffers, history, async readbacks) has to be 'persistent'.
+   */
+  class RenderGraph
+  {
+    public:
+      using ResId = uint8_t;
+      using PassId = uint8_t;
+
+      constexpr static uint32_t MAX_RESOURCES = 24;
+      constexpr static uint32_t MAX_PASSES = 8;
+      constexpr static uint32_t ALIGNMENT = 64;
+
+      enum class Heap : uint8_t
+      {
+        MAIN, // regular heap, e.g. color buffers
+        TOP,  // top of RDRAM ('Mem::allocTop'), keeps depth in a different bank than the color buffers
+        COUNT
+      };
+
+      struct ResourceDesc
+      {
+        const char* name{};
+        tex_format_t format{};
+        uint16_t width{};
+        uint16_t height{};
+        Heap heap{Heap::MAIN};
+        // content has to stay valid across frames, never shares memory
+        bool persistent{false};
+      };
+
+    private:
+      struct Resource
+      {
+        ResourceDesc desc{};
+        surface_t surf{};
+        uint32_t offset{};
+        uint32_t size{};
+        int8_t firstPass{-1};
+        int8_t lastPass{-1};
+      };
+
+      struct Pass
+      {
+        const char* name{};
+      };
+
+      Resource resources[MAX_RESOURCES]{};
+      Pass passes[MAX_PASSES]{};
+      void* heapData[(uint32_t)Heap::COUNT]{};
+      uint32_t heapSize[(uint32_t)Heap::COUNT]{};
+      uint8_t resCount{0};
+      uint8_t passCount{0};
+      bool compiled{false};
+
+      [[nodiscard]] bool isAliasable(const Resource &a, const Resource &b) const;
+
+    public:
+      RenderGraph() = default;
+      ~RenderGraph() { reset(); }
+
+      CLASS_NO_COPY_MOVE(RenderGraph);
+
+      ResId addResource(const ResourceDesc &desc);
+
+      /**
+       * Adds a pass after all previous ones.
+       * @param name for logging
+       * @param usedRes all targets read or written by the pass
+       */
+      PassId addPass(const char* name, std::initializer_list<ResId> usedRes);
+      // adds a target to an existing pass, for lists only known at runtime (e.g. one per frame-buffer)
+      void use(PassId pass, ResId res);
+
+      /**
+       * Computes lifetimes and allocates all targets, surfaces are valid from here on.
+       * Must be called once after declaring everything.
+       */
+      void compile();
+
+      // frees all memory and declarations, surfaces returned before are invalid afterward
+      void reset();
+
+      [[nodiscard]] surface_t& get(ResId res) {
+        assertf(compiled, "RenderGraph: not compiled");
+        return resources[res].surf;
+      }
+
+      // memory actually allocated, in bytes
+      [[nodiscard]] uint32_t getAllocSize() const;
+      // memory all targets would need on their own, in bytes
+      [[nodiscard]] uint32_t getRequestedSize() const;
+
+      // prints passes, lifetimes and placement to the log
+      void log() const;
+  };
+}
@@ -0,0 +1,48 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+namespace P64
+{
+  /**
+   * Keeps the layout of a text (see 'rdpq_paragraph_build') across frames.
+   * The paragraph is only rebuilt if the text, font or parameters change,
+   * otherwise drawing it just emits the already placed glyphs.
+   * Font styles are applied when drawing, so color changes don't need a rebuild.
+   */
+  class TextCache
+  {
+    private:
+      rdpq_paragraph_t *paragraph{nullptr};
+      rdpq_textparms_t params{};
+      // copy of the text last laid out, comparing it is a lot cheaper than the layout itself
+      char *text{nullptr};
+      uint8_t fontId{0};
+
+    public:
+      constexpr TextCache() = default;
+      ~TextCache() { clear(); }
+
+      TextCache(const TextCache&) = delete;
+      TextCache& operator=(const TextCache&) = delete;
+
+      /**
+       * Draws a text, laying it out again only if anything changed since the last call.
+       * Same as 'rdpq_text_print' otherwise.
+       * @param parms layout parameters (can be null)
+       * @param font font ID
+       * @param x position
+       * @param y position
+       * @param newText UTF-8 text
+       */
+      void print(const rdpq_textparms_t *parms, uint8_t font, float x, float y, const char *newText);
+
+      /**
+       * Frees the cached layout, the next 'print' rebuilds it.
+       */
+      void clear();
+  };
+}
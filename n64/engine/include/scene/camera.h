@@ -19,6 +19,9 @@ namespace P64
       fm_vec3_t up{0,1,0};
       fm_vec3_t pos{};
       fm_vec3_t target{}; // computed
+      T3DFrustum frustum{}; // computed in 'update', same as the viewport's once attached
+      int16_t screenArea[4]{}; // x, y, width, height at full resolution
+      uint16_t areaRenderWidth{0}; // render width 'screenArea' was last applied for
 
       uint8_t needsProjUpdate{false};
     public:
@@ -26,6 +29,8 @@ namespace P64
       float near{};
       float far{};
       float aspectRatio{};
+      // bit per 3D layer this camera draws, allows cheaper secondary cameras
+      uint32_t layerMask{0xFFFF'FFFF};
 
       Camera();
       CLASS_NO_COPY_MOVE(Camera);
@@ -34,6 +39,10 @@ namespace P64
       void update(float deltaTime);
       void attach();
 
+      /**
+       * Sets the viewport area in pixels, relative to the full screen resolution.
+       * With dynamic resolution, this gets scaled to the current render size when attached.
+       */
       void setScreenArea(int x, int y, int width, int height);
 
       /**
@@ -55,6 +64,9 @@ namespace P64
 
       [[nodiscard]] const fm_vec3_t &getTarget() const { return target; }
       [[nodiscard]] const fm_vec3_t &getPos() const { return pos; }
+      [[nodiscard]] const fm_vec3_t &getUp() const { return up; }
+      [[nodiscard]] const T3DFrustum &getFrustum() const { return frustum; }
+      [[nodiscard]] bool drawsLayer(uint32_t layerIdx) const { return layerMask & (1u << layerIdx); }
 
       [[nodiscard]] fm_vec3_t getViewDir() const {
         fm_vec3_t dir{};
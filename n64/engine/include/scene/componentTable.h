@@ -34,4 +34,11 @@ namespace P64
 
   constexpr uint32_t COMP_TABLE_SIZE = 16;
   extern const ComponentDef COMP_TABLE[COMP_TABLE_SIZE];
+
+  /**
+   * Order in which component types get updated and drawn each frame.
+   * This follows the component priority set in the editor,
+   * e.g. constraints before culling, and culling before any models.
+   */
+  extern const uint8_t COMP_DISPATCH_ORDER[COMP_TABLE_SIZE];
 }
@@ -5,11 +5,13 @@
 #pragma once
 #include <t3d/t3dmodel.h>
 #include <t3d/t3danim.h>
+#include <vector>
 
 #include "assets/assetManager.h"
 #include "lib/matrixManager.h"
 #include "renderer/drawLayer.h"
 #include "renderer/material.h"
+#include "scene/lighting.h"
 #include "scene/object.h"
 #include "script/scriptTable.h"
 
@@ -19,40 +21,114 @@ namespace P64::Comp
   {
     static constexpr uint32_t ID = 10;
 
+    // skip skeleton updates while not drawn, time accumulates and is applied once visible again
+    static constexpr uint8_t FLAG_SKIP_CULLED = 1 << 0;
+
     private:
+      // runtime state, reset in each update and set again by draws in between
+      static constexpr uint8_t STATE_DRAWN = 1 << 0;
+      static constexpr uint8_t STATE_FAR   = 1 << 1;
+
       T3DModel *model{};
 
       T3DSkeleton skelMain{};
-      T3DSkeleton *skelAnim{};
-      T3DAnim *anims{};
+      // animation instances, only created once used (nullptr otherwise)
+      T3DAnim **anims{};
+      uint16_t animCount{0};
 
       int16_t animIdxMain{-1};
-      int16_t animIdxBlend{-1};
 
-      RingMat4FP matFP{};
+      CachedMat4FP matFP{}; // only rebuilt if the object moved
       uint8_t layerIdx{0};
       uint8_t flags{0};
+      uint8_t state{STATE_DRAWN};
+
+      float lodDist2{0.0f}; // squared distance for reduced update-rate, 0 to disable
+      float lodInterval{0.0f}; // time between updates when far away
+      float animTime{0.0f}; // time accumulated since the last update
+
+    public:
+      static constexpr uint32_t MAX_LAYERS = 4;
+
+      /**
+       * Animation blended on top of the main one, layers are applied in order.
+       * The bone-mask scales the weight per bone (0-255), if not set all bones are affected.
+       */
+      struct Layer
+      {
+        int16_t animIdx{-1};
+        float weight{0.0f};
+        uint8_t *boneMask{nullptr};
+      };
+
+    private:
+      Layer layers[MAX_LAYERS]{};
+      uint8_t layerCount{0}; // highest used layer + 1
 
     public:
       Renderer::Material material{};
-      float blendFactor{0.5f};
+      Lighting::Selection lightSel{}; // point lights used if the scene has more than fit
 
       void setMainAnim(int16_t idx);
-      void setBlendAnim(int16_t idx);
+
+      /**
+       * Sets the animation of a blend layer, an anim can't be used in multiple layers (or as main) at once.
+       * @param layer layer index
+       * @param idx animation index, -1 to disable the layer
+       */
+      void setLayerAnim(uint32_t layer, int16_t idx);
+
+      void setLayerWeight(uint32_t layer, float weight) { layers[layer].weight = weight; }
+      [[nodiscard]] float getLayerWeight(uint32_t layer) const { return layers[layer].weight; }
+
+      /**
+       * Restricts a layer to a bone and all its children, e.g. "Spine" for upper-body anims.
+       * @param layer layer index
+       * @param boneName root bone of the mask, nullptr to affect all bones again
+       * @param weight weight of the masked bones (0.0 - 1.0), all others are set to zero
+       * @return false if the bone was not found, mask is unchanged in that case
+       */
+      bool setLayerMask(uint32_t layer, const char* boneName, float weight = 1.0f);
+
+      /**
+       * Returns the per-bone weights of a layer (one byte per bone), creating it on first use.
+       * Can be used to directly set custom weights.
+       */
+      uint8_t* getLayerMask(uint32_t layer);
+
+      // for a single blended anim, same as layer 0
+      void setBlendAnim(int16_t idx) { setLayerAnim(0, idx); }
 
       T3DAnim* getMainAnim() {
         if (animIdxMain < 0) return nullptr;
-        return &anims[animIdxMain];
+        return anims[animIdxMain];
       }
 
-      T3DAnim* getBlendAnim() {
-        if (animIdxBlend < 0) return nullptr;
-        return &anims[animIdxBlend];
+      T3DAnim* getLayerAnim(uint32_t layer) {
+        if (layers[layer].animIdx < 0) return nullptr;
+        return anims[layers[layer].animIdx];
       }
 
-      T3DAnim* getAnim(int16_t idx) const {
-        return &anims[idx];
-      }
+      T3DAnim* getBlendAnim() { return getLayerAnim(0); }
+
+      /**
+       * Returns an animation instance, creating it on first use.
+       * New instances are attached to the main skeleton.
+       */
+      T3DAnim* getAnim(int16_t idx);
+
+      struct SkeletonStats
+      {
+        uint32_t instances{};
+        uint32_t animCount{}; // created animation instances
+        uint32_t byteSize{}; // skeletons of all instances, incl. shared blend skeletons
+      };
+
+      /**
+       * Memory used by skeletons, one entry for each loaded model.
+       * @param out list to fill, cleared beforehand
+       */
+      static void getSkeletonStats(std::vector<SkeletonStats> &out);
 
     static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData);
 
@@ -61,5 +137,8 @@ namespace P64::Comp
     static void update(Object& obj, AnimModel* data, [[maybe_unused]] float deltaTime);
 
     static void draw([[maybe_unused]] Object& obj, AnimModel* data, [[maybe_unused]] float deltaTime);
+
+    // called by the draw-queue, layer and material are already set
+    static void drawQueued(Object& obj, void* data);
   };
 }
\ No newline at end of file
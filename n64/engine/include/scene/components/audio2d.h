@@ -24,6 +24,8 @@ namespace P64::Comp
     wav64_t *audio{};
     float volume{1.0f};
     uint8_t flags{0};
+    uint8_t priority{Audio::PRIO_DEFAULT};
+    uint8_t maxInstances{0};
     Audio::Handle handle{};
 
     static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData)
@@ -0,0 +1,70 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "audio/audioManager.h"
+#include "scene/object.h"
+#include "scene/camera.h"
+
+namespace P64::Comp
+{
+  /**
+   * Positional audio, volume and panning are set based on the distance and direction to the active camera.
+   * Outside the max. distance the sound is virtualized: it doesn't use a mixer channel,
+   * only the playback position is tracked, so it can resume once it is back in range.
+   */
+  struct Audio3D
+  {
+    static constexpr uint32_t ID = 12;
+
+    static constexpr uint8_t FLAG_LOOP = 1 << 0;
+    static constexpr uint8_t FLAG_AUTO_PLAY = 1 << 1;
+
+    static constexpr uint8_t STATE_PLAYING = 1 << 0;
+    static constexpr uint8_t STATE_VIRTUAL = 1 << 1;
+
+    // camera data needed by all sources, computed once per frame
+    struct Listener
+    {
+      fm_vec3_t pos{};
+      fm_vec3_t right{};
+    };
+
+    wav64_t *audio{};
+    float volume{1.0f};
+    float distMin{};
+    float distMax{};
+    float virtualPos{}; // playback position in samples while virtualized
+    uint8_t flags{0};
+    uint8_t priority{Audio::PRIO_DEFAULT};
+    uint8_t maxInstances{0};
+    uint8_t state{0};
+    Audio::Handle handle{};
+
+    static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData)
+    {
+      return sizeof(Audio3D);
+    }
+
+    static void initDelete([[maybe_unused]] Object& obj, Audio3D* data, uint16_t* initData);
+
+    /**
+     * Starts playing from the beginning, the channel is only taken once in range.
+     */
+    static void play(Audio3D* data);
+    static void stop(Audio3D* data);
+
+    [[nodiscard]] static bool isPlaying(const Audio3D* data) {
+      return data->state & STATE_PLAYING;
+    }
+
+    [[nodiscard]] static Listener getListener(const Camera &cam);
+
+    /**
+     * Updates attenuation and panning, and (de-)virtualizes the sound based on its distance.
+     * Called by the scene for all instances in one pass after the cameras are updated.
+     */
+    static void updateSpatial(const Object& obj, Audio3D* data, const Listener &listener, float deltaTime);
+  };
+}
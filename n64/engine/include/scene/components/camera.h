@@ -23,6 +23,7 @@ namespace P64::Comp
       float near;
       float far;
       float aspectRatio;
+      uint32_t layerMask;
     };
 
     P64::Camera camera{};
@@ -34,6 +35,8 @@ namespace P64::Comp
 
     static void initDelete([[maybe_unused]] Object& obj, Camera* data, InitData* initData);
 
+    static void onEvent(Object& obj, Camera* data, const ObjectEvent &event);
+
     static void update([[maybe_unused]] Object& obj, [[maybe_unused]] Camera* data, [[maybe_unused]] float deltaTime) {
       obj.pos = data->camera.getPos();
     }
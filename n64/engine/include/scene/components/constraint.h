@@ -31,7 +31,13 @@ namespace P64::Comp
     }
 
     static void initDelete([[maybe_unused]] Object& obj, Constraint* data, uint16_t* initData);
-    static void update(Object& obj, Constraint* data, float deltaTime);
+
+    /**
+     * Applies the constraint with an already resolved reference.
+     * Called by the scene in its own pass after all component updates (see 'Scene::updateConstraints'),
+     * so there is no 'update' function here.
+     */
+    static void apply(Object& obj, const Constraint* data, const Object& refObj);
     static void draw(Object& obj, Constraint* data, float deltaTime);
   };
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 */
 #pragma once
 #include "scene/object.h"
+#include "scene/camera.h"
 
 namespace P64::Comp
 {
@@ -11,9 +12,23 @@ namespace P64::Comp
   {
     static constexpr uint32_t ID = 8;
 
+    // bounds cover all children (computed at build time), culls the entire subtree
+    static constexpr uint8_t FLAG_GROUP = 1 << 0;
+    // no visibility cell assigned
+    static constexpr uint8_t CELL_NONE = 0xFF;
+    static constexpr uint8_t CELL_COUNT = 32;
+    // cameras with a cached visibility result, any further ones test during their draw
+    static constexpr uint8_t MAX_CACHED_CAMERAS = 8;
+
     fm_vec3_t halfExtend{};
     fm_vec3_t offset{};
     uint8_t type;
+    uint8_t flags;
+    // cell / portal visibility: if the camera is inside the volume of a cell,
+    // only the cells in 'visibleCells' (and itself) are drawn, anything else is culled without a frustum test
+    uint8_t cell;
+    uint8_t camVisible; // bit per camera, set by 'updateVisibility' before drawing
+    uint32_t visibleCells;
 
     static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData)
     {
@@ -26,5 +41,27 @@ namespace P64::Comp
     {}
 
     static void draw([[maybe_unused]] Object& obj, Culling* data, float deltaTime);
+
+    /**
+     * Checks if a point (usually the camera) is inside a cell.
+     * @return mask of visible cells, 0 if not inside or no cell is assigned
+     */
+    static uint32_t getCellVisibility(const Object& obj, const Culling* data, const fm_vec3_t &pos);
+
+    /**
+     * Checks the volume against a frustum and the cells visible from a camera.
+     * @return true if the object needs to be drawn
+     */
+    static bool isVisible(const Object& obj, const Culling* data, const T3DFrustum &frustum, uint32_t visibleCells);
+
+    /**
+     * Tests the volume against all cameras at once, the result per camera is used later by 'draw'.
+     * @param cameras cameras, at most 'MAX_CACHED_CAMERAS'
+     * @param cameraCells cell mask visible from each camera
+     * @param camCount number of cameras
+     */
+    static void updateVisibility(const Object& obj, Culling* data,
+      P64::Camera* const* cameras, const uint32_t* cameraCells, uint32_t camCount
+    );
   };
 }
@@ -8,7 +8,9 @@
 #include "assets/assetManager.h"
 #include "lib/matrixManager.h"
 #include "renderer/drawLayer.h"
+#include "renderer/drawQueue.h"
 #include "renderer/material.h"
+#include "scene/lighting.h"
 #include "scene/object.h"
 #include "script/scriptTable.h"
 
@@ -20,14 +22,34 @@ namespace P64::Comp
 
     // performs culling of indiviudal objects
     static constexpr uint8_t FLAG_CULLING = 1 << 0;
+    // draws all models of the same asset in one batch, sharing the material setup
+    static constexpr uint8_t FLAG_INSTANCED = 1 << 1;
+    // set at runtime: textures are paged in by the BigTex pipeline, see 'BigTex::drawT3DM'
+    static constexpr uint8_t FLAG_BIGTEX = 1 << 7;
+
+    // levels of detail, each one has its own set of mesh-indices
+    static constexpr uint8_t LOD_COUNT = 3;
+    // relative distance a camera has to move back closer before switching to a higher detail
+    static constexpr float LOD_HYSTERESIS = 0.1f;
 
     T3DModel *model{};
-    RingMat4FP matFP{};
+    CachedMat4FP matFP{}; // only rebuilt if the object moved
     Renderer::Material material{};
+    Lighting::Selection lightSel{}; // point lights used if the scene has more than fit
+    float drawDistance{0}; // max. distance to the camera, 0 to always draw
+    float lodDist[LOD_COUNT-1]{}; // start distance of each lower detail level, 0 if unused
+    uint16_t textureGroup{0}; // models with the same main texture share it, set by the build
+    uint8_t lodIdxCount[LOD_COUNT]{};
+    uint8_t lodLevel{0};
     uint8_t layerIdx{0};
     uint8_t flags{0};
-    uint8_t meshIdxCount{0};
-    uint8_t meshIndices[];
+    uint8_t meshIdxOffset{0}; // start of the current LOD in 'meshIndices'
+    uint8_t meshIdxCount{0}; // mesh count of the current LOD
+    uint8_t meshIndices[]; // indices of all LODs
+
+    [[nodiscard]] const uint8_t* getMeshIndices() const {
+      return meshIndices + meshIdxOffset;
+    }
 
     static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData);
 
@@ -36,5 +58,11 @@ namespace P64::Comp
     static void update(Object& obj, Model* data, [[maybe_unused]] float deltaTime) {}
 
     static void draw([[maybe_unused]] Object& obj, Model* data, [[maybe_unused]] float deltaTime);
+
+    // called by the draw-queue, layer and material are already set
+    static void drawQueued(Object& obj, void* data);
+
+    // called by the draw-queue for a run of instanced models of the same asset
+    static void drawInstanced(const DrawQueue::Instance* instances, uint32_t count);
   };
 }
\ No newline at end of file
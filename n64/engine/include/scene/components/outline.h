@@ -14,11 +14,13 @@
  *   uint8_t  mode;        // 1 byte (0=silhouette, 1=contour)
  *   uint8_t  enabled;     // 1 byte
  *   uint16_t padding;     // 2 bytes
+ *   float    drawDistance;// 4 bytes (0 = always draw)
  */
 #pragma once
 
 #include "lib/types.h"
 #include "scene/object.h"
+#include "scene/scene.h"
 #include "renderer/outline.h"
 
 namespace P64::Component
@@ -33,6 +35,7 @@ namespace P64::Component
       uint8_t  mode;
       uint8_t  enabled;
       uint16_t padding;
+      float    drawDistance;
     };
 
     OutlineConf conf{};
@@ -44,7 +47,7 @@ namespace P64::Component
         // Destructor path
         auto *comp = static_cast<OutlineComp*>(mem);
         if (comp->conf.hullModel) {
-          outline_free_hull(comp->conf.hullModel);
+          outline_release_hull(comp->conf.hullModel);
           comp->conf.hullModel = nullptr;
         }
         return;
@@ -57,9 +60,10 @@ namespace P64::Component
       comp->conf.thickness = data->thickness;
       comp->conf.mode      = data->mode;
       comp->conf.enabled   = data->enabled != 0;
+      comp->conf.drawDistance = data->drawDistance;
       comp->conf.hullModel = nullptr; // baked later when model is loaded
 
-      // If the object has a model component, bake the hull
+      // If the object has a model component, fetch the (shared) hull via outline_acquire_hull()
       // This happens in the scene loader after all components are init'd
     }
 
@@ -71,6 +75,13 @@ namespace P64::Component
       auto *comp = static_cast<OutlineComp*>(mem);
       if (!comp->conf.enabled || !comp->conf.hullModel) return;
 
+      // skip the hull pass entirely for distant objects, this halves their vertex load
+      if (comp->conf.drawDistance > 0.0f) {
+        auto diff = obj.pos - obj.getScene().getActiveCamera().getPos();
+        float maxDist = comp->conf.drawDistance;
+        if (t3d_vec3_len2(&diff) > (maxDist * maxDist)) return;
+      }
+
       // The outline is drawn by the render pipeline before the normal mesh
       // The pipeline queries the component and calls outline_draw_hull()
       outline_draw_hull(&comp->conf, obj.getModelMatrix());
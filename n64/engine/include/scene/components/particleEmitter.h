@@ -0,0 +1,95 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "scene/object.h"
+#include "renderer/particles/ptxSystem.h"
+#include "renderer/particles/ptxRspSim.h"
+
+namespace P64::Comp
+{
+  /**
+   * Emits and simulates colored particles (TPX), with lifetime, velocity and gravity.
+   * Particles are simulated in world space with fixed-point math,
+   * dead ones are removed in a single compaction pass per frame.
+   *
+   * With 'FLAG_RSP_SIM' position, velocity and alpha are instead advanced by the RSP right before drawing.
+   * Particles then fade out linearly over their lifetime and die once fully transparent,
+   * the color and size ramps are not applied in that mode.
+   */
+  struct ParticleEmitter
+  {
+    static constexpr uint32_t ID = 13;
+
+    // emits particles continuously, otherwise only via 'burst()'
+    static constexpr uint8_t FLAG_EMITTING = 1 << 0;
+    // simulates particles on the RSP instead of the CPU
+    static constexpr uint8_t FLAG_RSP_SIM = 1 << 1;
+
+    // frames between removing dead particles in RSP mode, checking them needs uncached reads
+    static constexpr uint8_t RSP_COMPACT_INTERVAL = 8;
+
+    // per particle simulation state, next to the TPX buffer (which only holds pos/size/color)
+    struct Particle
+    {
+      int32_t pos[3]; // world units, 24.8 fixed-point
+      int16_t vel[3]; // world units per second, 12.4 fixed-point
+      uint16_t age; // 1/1024th seconds
+      uint16_t life; // 1/1024th seconds
+      uint16_t padding;
+    };
+
+    PTX::System system;
+    Particle* particles{}; // CPU simulation only
+    PTX::RspSim::State* rspState{}; // RSP simulation only
+    rspq_syncpoint_t rspSync{};
+
+    float emitRate{}; // particles per second
+    float emitAccum{};
+    float speed{};
+    float spread{};
+    float life{}; // seconds
+    float lifeVar{}; // random extra seconds
+
+    int16_t gravity{}; // velocity change per second, 12.4 fixed-point
+    uint16_t burstCount{};
+    color_t colorStart{};
+    color_t colorEnd{};
+    uint8_t sizeStart{};
+    uint8_t sizeEnd{};
+    uint8_t layer{};
+    uint8_t flags{};
+    uint8_t compactTimer{};
+
+    // only the CPU writes into the buffer without RSP simulation, so it can be cached
+    ParticleEmitter(uint32_t maxCount, bool rspSim)
+      : system{PTX::System::COLOR_A_S16, maxCount, !rspSim} {}
+
+    static uint32_t getAllocSize([[maybe_unused]] uint16_t* initData)
+    {
+      return sizeof(ParticleEmitter);
+    }
+
+    static void initDelete(Object& obj, ParticleEmitter* data, uint16_t* initData);
+
+    static void update(Object& obj, ParticleEmitter* data, float deltaTime);
+
+    static void draw(Object& obj, ParticleEmitter* data, float deltaTime);
+
+    /**
+     * Spawns particles at once at the position of the object.
+     * @param count number of particles, limited by the free space
+     */
+    static void burst(Object& obj, ParticleEmitter* data, uint32_t count);
+
+    static void setEmitting(ParticleEmitter* data, bool emitting) {
+      if(emitting)data->flags |= FLAG_EMITTING;
+      else data->flags &= ~FLAG_EMITTING;
+    }
+
+    static void clear(ParticleEmitter* data) {
+      data->system.count = 0;
+    }
+  };
+}
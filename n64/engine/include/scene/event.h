@@ -4,13 +4,19 @@
 */
 #pragma once
 #include <libdragon.h>
+#include <vector>
 
 namespace P64
 {
+  // initial capacity of a queue, it grows beyond that until the hard limit is reached
   constexpr uint32_t MAX_EVENT_COUNT = 128;
+  constexpr uint32_t MAX_EVENT_COUNT_LIMIT = 2048;
 
   constexpr uint16_t EVENT_TYPE_ENABLE = 0xFFFF;
   constexpr uint16_t EVENT_TYPE_DISABLE = 0xFFFE;
+  // persistent objects moving to the next scene, sent while still in the old / once in the new one
+  constexpr uint16_t EVENT_TYPE_SCENE_LEAVE = 0xFFFD;
+  constexpr uint16_t EVENT_TYPE_SCENE_ENTER = 0xFFFC;
 
   // Safe ranges for user-defined custom events
   constexpr uint16_t EVENT_TYPE_CUSTOM_START = 0x0000;
@@ -23,32 +29,56 @@ namespace P64
     uint32_t value{};
   };
 
+  enum class EventScope : uint8_t
+  {
+    OBJECT,   // single object, 'targetId' is the object ID
+    CHILDREN, // all direct children, 'targetId' is the parent ID
+    ALL,      // all objects in the scene
+  };
+
   struct ObjectEventWrapper
   {
     ObjectEvent event{};
     uint16_t targetId{};
+    EventScope scope{};
+    // for group/broadcast events: only objects that have any of these component types (0 = any)
+    uint16_t compMask{};
   };
 
   struct ObjectEventQueue
   {
-    ObjectEventWrapper events[MAX_EVENT_COUNT]{};
-    uint32_t eventCount{0};
-
-    void add(uint16_t targetId, uint16_t senderId, uint16_t type, uint32_t value) {
-      if (eventCount < MAX_EVENT_COUNT) {
-        events[eventCount].targetId = targetId;
-        events[eventCount].event =
-        {
+    std::vector<ObjectEventWrapper> events{};
+    // stats, reset by the scene each frame
+    uint32_t overflowCount{0}; // events added beyond the initial capacity
+    uint32_t droppedCount{0}; // events dropped due to the hard limit
+
+    ObjectEventQueue() {
+      events.reserve(MAX_EVENT_COUNT);
+    }
+
+    void add(uint16_t targetId, uint16_t senderId, uint16_t type, uint32_t value,
+      EventScope scope = EventScope::OBJECT, uint16_t compMask = 0
+    ) {
+      if(events.size() >= MAX_EVENT_COUNT_LIMIT) {
+        ++droppedCount;
+        return;
+      }
+      if(events.size() >= MAX_EVENT_COUNT)++overflowCount;
+
+      events.push_back({
+        .event = {
           .senderId = senderId,
           .type = type,
           .value = value
-        };
-        eventCount++;
-      }
+        },
+        .targetId = targetId,
+        .scope = scope,
+        .compMask = compMask,
+      });
     }
 
     void clear() {
-      eventCount = 0;
+      events.clear();
     }
   };
 }
\ No newline at end of file
@@ -9,6 +9,11 @@ namespace P64 {
   struct GlobalState
   {
     uint32_t screenSize[2]{};
+    // size actually drawn this frame, only smaller than 'screenSize' with dynamic resolution
+    uint32_t renderSize[2]{};
+    // part of the depth range used this frame, see 'RenderPipeline::nextDepthSlice'
+    uint8_t depthSlice{0};
+    uint8_t depthSliceCount{1};
   };
 
   extern GlobalState state;
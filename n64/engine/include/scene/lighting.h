@@ -9,6 +9,9 @@
 namespace P64
 {
   constexpr uint32_t MAX_LIGHTS = 6;
+  // point lights a scene can have at once, if more than fit into 'MAX_LIGHTS' are active,
+  // each object only uses the most influential ones (see 'Lighting::applyForObject')
+  constexpr uint32_t MAX_POINT_LIGHTS = 32;
 
   struct Light
   {
@@ -19,27 +22,81 @@ namespace P64
 
   class Lighting
   {
+    public:
+      /**
+       * Point lights picked for an object, stored per object (e.g. in the model component).
+       * Only re-evaluated if the object or any of the point lights changed.
+       */
+      struct Selection
+      {
+        fm_vec3_t pos{};
+        uint16_t version{0}; // 0 = never selected
+        uint8_t count{0};
+        uint8_t idx[MAX_LIGHTS]{};
+      };
+
     private:
       uint32_t lightCount{0};
+      uint32_t dirCount{0};
+      uint32_t pointCount{0};
+      uint32_t pointHash{0};
+      uint16_t version{1}; // changes with the point lights, invalidates all selections
 
       void addLight(const Light& l) {
         if(lightCount >= MAX_LIGHTS)return;
+        if(l.strength == 0)++dirCount;
         lights[lightCount++] = l;
       }
 
+      void select(Selection &sel, const fm_vec3_t &pos) const;
+
     public:
+      // ambient and directional lights
       Light lights[MAX_LIGHTS]{};
+      Light pointLights[MAX_POINT_LIGHTS]{};
 
       void reset() {
         lightCount = 0;
+        dirCount = 0;
+        pointCount = 0;
       }
 
       uint32_t getLightCount() const {
-        return lightCount;
+        return lightCount + pointCount;
+      }
+
+      // if there are more point lights than slots left, draws have to pick their own
+      [[nodiscard]] bool needsSelection() const {
+        return pointCount > (MAX_LIGHTS - dirCount);
       }
 
+      /**
+       * Applies ambient, directional and as many point lights as fit.
+       * Only lights that differ from what was last set in the current draw-layer are emitted,
+       * so re-applying the same set (e.g. after an override) is cheap.
+       */
       void apply() const;
 
+      /**
+       * Forgets which lights are set, the next 'apply()' in each layer emits all of them again.
+       * Called by the scene once per frame, only needed otherwise if lights are set through tiny3d directly.
+       */
+      static void invalidate();
+
+      /**
+       * Sets the point lights closest/strongest to a position, NOP if all lights fit anyway.
+       * Must be called after 'apply()' for the current camera, the ambient and directional lights are kept.
+       * @param sel per object cache, updated if outdated
+       * @param pos position of the object
+       */
+      void applyForObject(Selection &sel, const fm_vec3_t &pos) const;
+
+      /**
+       * Detects changes in the point lights since the last call, called by the scene once per frame.
+       * Lights are usually re-added each frame, so this compares the content instead.
+       */
+      void updateVersion();
+
       void addAmbientLight(const color_t col) {
         addLight({.strength = -1, .color = col});
       }
@@ -49,9 +106,10 @@ namespace P64
       }
 
       void addPointLight(const color_t col, const fm_vec3_t& pos, float strength) {
+        if(pointCount >= MAX_POINT_LIGHTS)return;
         strength = fmaxf(strength, 0.001f);
         //strength = fminf(strength, 1.0f);
-        addLight({.dirOrPos = pos, .strength = strength, .color = col});
+        pointLights[pointCount++] = {.dirOrPos = pos, .strength = strength, .color = col};
       }
   };
 }
@@ -21,7 +21,12 @@ namespace P64
    */
   class Object
   {
+    friend class Scene;
+
     private:
+      // direct children in memory order, maintained by the scene
+      Object* firstChild{nullptr};
+      Object* nextSibling{nullptr};
 
     public:
       struct CompRef
@@ -37,6 +42,16 @@ namespace P64
       uint16_t group{};
       uint16_t flags{};
       uint16_t compCount{0};
+      // unique per created object, used to detect stale references if an ID gets re-used
+      uint16_t generation{0};
+      // total size of the allocation, including components
+      uint16_t allocSize{0};
+      // bit per component type present, indexed by component ID
+      uint16_t compMask{0};
+      // components only update every 2^n-th tick (with the time since their last update), set in the editor
+      uint8_t updateTier{0};
+      // tick the updates of this object happen on, spreads objects of a tier across ticks
+      uint8_t updatePhase{0};
 
       // extra data, is overlapping with component data if unused
       fm_quat_t rot{};
@@ -72,9 +87,24 @@ namespace P64
        * @return pointer
        */
       [[nodiscard]] char* getCompData() const {
-        return (char*)getCompRefs() + sizeof(CompRef) * compCount;
+        return compCount ? ((char*)this + getCompRefs()[0].offset) : (char*)getCompRefs();
+      }
+
+      /**
+       * Returns pointer to the per-type offset table, which follows the component references.
+       * For each bit set in 'compMask' (ascending), it stores the offset of the first component of that type.
+       * @return pointer
+       */
+      [[nodiscard]] uint16_t* getTypeOffsets() const {
+        return (uint16_t*)(getCompRefs() + compCount);
       }
 
+      /**
+       * Fills 'compMask' and the per-type offset table from the component references.
+       * This is done by the scene when creating an object.
+       */
+      void buildTypeTable();
+
       /**
        * Returns the first component that matches the given type.
        * The type given must be component in the 'P64::Comp' namespace.
@@ -84,17 +114,22 @@ namespace P64
        */
       template<typename T>
       [[nodiscard]] T* getComponent() const {
-        auto compRefs = getCompRefs();
-        for (uint32_t i=0; i<compCount; ++i) {
-          if(compRefs[i].type == T::ID) {
-            return (T*)((char*)this + compRefs[i].offset);
-          }
-        }
-        return nullptr;
+        constexpr uint32_t bit = 1 << T::ID;
+        if(!(compMask & bit))return nullptr;
+        uint32_t idx = __builtin_popcount(compMask & (bit - 1));
+        return (T*)((char*)this + getTypeOffsets()[idx]);
       }
 
+      /**
+       * Returns the n-th component that matches the given type,
+       * or nullptr if there are not enough components of that type.
+       * @tparam T component type
+       * @param idx index of the component (within that type)
+       * @return pointer to component or nullptr
+       */
       template<typename T>
       [[nodiscard]] T* getComponent(uint32_t idx) const {
+        if(!(compMask & (1 << T::ID)))return nullptr;
         auto compRefs = getCompRefs();
         for (uint32_t i=0; i<compCount; ++i) {
           if(compRefs[i].type == T::ID) {
@@ -124,7 +159,8 @@ namespace P64
 
       /**
        * Changes the state of the object to be enabled or disabled.
-       * Prefer this over changing flags directly, as components may need to be notified.
+       * Prefer this over changing flags directly, as components may need to be notified
+       * and the scene only updates enabled objects (see 'Scene::markActiveDirty').
        * @param isEnabled true to enable, false to disable
        */
       void setEnabled(bool isEnabled);
@@ -202,10 +238,20 @@ namespace P64
       [[nodiscard]] fm_vec3_t outOfLocalSpace(const fm_vec3_t &p) const;
   };
 
+  /**
+   * Reference to an object by ID.
+   * The upper 16 bits optionally store the generation of the object.
+   * If set, a reference to a deleted object whose ID got re-used will resolve to nullptr.
+   * References set in the editor only store the ID.
+   */
   struct ObjectRef
   {
     uint32_t id{};
 
+    [[nodiscard]] static ObjectRef of(const Object &obj) {
+      return {((uint32_t)obj.generation << 16) | obj.id};
+    }
+
     [[nodiscard]] Object* get() const;
 
     [[nodiscard]] Object* operator->() const {
@@ -13,8 +13,11 @@ namespace P64::ObjectFlags
   constexpr uint16_t SELF_ACTIVE    = 1 << 0; // if true, object will be updated this frame
   constexpr uint16_t PARENTS_ACTIVE = 1 << 1; // true if all parent(s) are active, used to determine final active state
   constexpr uint16_t HAS_CHILDREN   = 1 << 2; // true if object has children (aka other objects list this as their parent ID)
+  constexpr uint16_t PERSISTENT     = 1 << 3; // kept alive when the next scene is loaded (set in the editor), see 'SceneManager::load'
   constexpr uint16_t PENDING_REMOVE = 1 << 4; // flagged for removal at the end of the frame
   constexpr uint16_t IS_CULLED      = 1 << 5; // if true, object is not drawn this frame (usually set by culling logic)
+  constexpr uint16_t HAS_EVENTS     = 1 << 6; // true if any component can receive events (set at runtime)
+  constexpr uint16_t HAS_COLL       = 1 << 7; // true if any component has a collision callback (set at runtime)
 
   constexpr uint16_t ACTIVE = SELF_ACTIVE | PARENTS_ACTIVE;
 }
\ No newline at end of file
@@ -0,0 +1,47 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <libdragon.h>
+
+namespace P64 { struct SceneConf; }
+
+/**
+ * Quality tiers, picked from the available RDRAM at boot.
+ * Scenes can define overrides for the low tier (see 'SceneConf::lowTier'),
+ * and optionally step down at runtime if frames keep taking too long.
+ */
+namespace P64::Quality
+{
+  enum class Tier : uint8_t
+  {
+    LOW  = 0, // 4MB
+    HIGH = 1, // 8MB (expansion pak)
+  };
+
+  // detects the tier, must be called once before the first scene is loaded
+  void init();
+
+  // tier for the next scene, can only get lower than the one at boot
+  [[nodiscard]] Tier getTier();
+  [[nodiscard]] bool hasExpansionPak();
+
+  /**
+   * Applies the overrides of the current tier to a scene config,
+   * must happen before anything is allocated from it.
+   */
+  void applyToScene(SceneConf &conf);
+
+  /**
+   * Tracks the frame time, with 'SceneConf::FLAG_QUALITY_AUTO' a frame-rate that misses the budget for a while
+   * switches to the low tier. Settings that can change at runtime (LOD, particles) do so right away,
+   * the rest (resolution, bloom, audio) on the next scene load.
+   */
+  void update(float frameTime, float frameBudget);
+
+  // multiplier for LOD distances, 1.0 unless lowered by the tier
+  [[nodiscard]] float getLodScale();
+  // multiplier for the max. particle count of emitters, 1.0 unless lowered by the tier
+  [[nodiscard]] float getParticleScale();
+}
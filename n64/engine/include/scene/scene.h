@@ -5,20 +5,32 @@
 #pragma once
 #include <libdragon.h>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 
 #include "event.h"
 #include "lighting.h"
 #include "object.h"
 #include "collision/scene.h"
+#include "lib/arena.h"
+#include "lib/idMap.h"
+#include "lib/spatialGrid.h"
 #include "lib/types.h"
 #include "renderer/drawLayer.h"
 #include "renderer/pipeline.h"
 #include "scene/camera.h"
+#include "scene/componentTable.h"
+
+#ifndef P64_COMP_PROFILE
+  // per component-type timings and call counts (debug overlay), build with '-DP64_COMP_PROFILE=0' to remove
+  #define P64_COMP_PROFILE 1
+#endif
 
 namespace P64
 {
   class Object;
   class RenderPipelineBigTex;
+  namespace Comp { struct Constraint; }
 }
 
 namespace P64
@@ -29,6 +41,7 @@ namespace P64
 namespace P64
 {
   class RenderPipeline;
+  struct ObjectLayout;
 
   struct SceneConf {
 
@@ -44,6 +57,41 @@ namespace P64
     constexpr static uint32_t FLAG_CLR_COLOR = 1 << 1;
     // use RGBA32 over RGBA16 buffer for final output or not
     constexpr static uint32_t FLAG_SCR_32BIT = 1 << 2;
+    // lower the render width when over budget (default pipeline only)
+    constexpr static uint32_t FLAG_DYN_RES = 1 << 3;
+    // two instead of three frame-buffers, saves memory but the CPU has to wait for the VI more often
+    constexpr static uint32_t FLAG_FB_DOUBLE = 1 << 4;
+    // streamed objects are stored in chunks (see 'Scene::updateChunks'), loaded around the camera
+    constexpr static uint32_t FLAG_CHUNKS = 1 << 5;
+    // depth is only cleared every few frames, each frame in between draws into a nearer part of the depth range
+    constexpr static uint32_t FLAG_DEPTH_SLICES = 1 << 6;
+    // a sky/backdrop covers the whole screen, color is only cleared until each buffer was drawn once
+    constexpr static uint32_t FLAG_BACKDROP = 1 << 7;
+    // waits for the VI before the update (input is read after that) and only keeps one frame queued, see 'SwapChain::setLowLatency'
+    constexpr static uint32_t FLAG_LOW_LATENCY = 1 << 8;
+    // 'lowTier' is used on consoles without the expansion pak, see 'Quality'
+    constexpr static uint32_t FLAG_LOW_TIER = 1 << 9;
+    // switch to 'lowTier' at runtime if frames keep missing the budget
+    constexpr static uint32_t FLAG_QUALITY_AUTO = 1 << 10;
+    // no depth-buffer at all, draws are sorted back-to-front instead (painter's algorithm).
+    // saves its memory and the RDP bandwidth of the depth reads/writes, meant for top-down or side-view scenes
+    constexpr static uint32_t FLAG_NO_DEPTH = 1 << 11;
+    // has persistent objects, the assets they use are listed in an extra file (see 'Scene::loadAssetList')
+    constexpr static uint32_t FLAG_PERSISTENT = 1 << 12;
+    // any heap allocation after the first frames asserts, only checked with 'P64_ALLOC_TRACK' (see 'debug/allocTracker.h')
+    constexpr static uint32_t FLAG_NO_ALLOC = 1 << 13;
+
+    // fixed-point 1.0 for the scales in 'TierConf'
+    constexpr static uint8_t TIER_SCALE_ONE = 16;
+
+    struct TierConf {
+      uint16_t screenWidth{}; // 0 = keep
+      uint16_t screenHeight{};
+      uint8_t bloomQuality{}; // see Renderer::HDR::Quality
+      uint8_t audioChannelCount{}; // 0 = keep
+      uint8_t lodScale{}; // LOD distances, see 'TIER_SCALE_ONE'
+      uint8_t particleScale{}; // max. particles of emitters, see 'TIER_SCALE_ONE'
+    };
 
     uint16_t screenWidth{};
     uint16_t screenHeight{};
@@ -54,35 +102,142 @@ namespace P64
     Pipeline pipeline{};
     uint8_t frameSkip{};
     uint8_t filter{};
-    uint8_t padding[1]{};
+    uint8_t bloomQuality{}; // see Renderer::HDR::Quality
+    uint32_t matrixCapacity{}; // 0 = default
+    uint16_t audioSampleRate{}; // 0 = default
+    uint8_t audioBufferCount{}; // 0 = default
+    uint8_t audioChannelCount{}; // 0 = default
+    uint8_t tickRate{}; // fixed simulation rate in Hz with interpolated drawing, 0 = once per frame
+    uint8_t padding[3]{};
+    TierConf lowTier{};
 
     DrawLayer::Setup layerSetup{};
+
+    [[nodiscard]] uint32_t getFrameBufferCount() const {
+      return (flags & FLAG_FB_DOUBLE) ? 2 : 3;
+    }
+
+    [[nodiscard]] bool hasDepth() const {
+      return !(flags & FLAG_NO_DEPTH);
+    }
   };
 
   struct PrefabParams
   {
-    void* prefabData{nullptr};
+    uint32_t prefabIdx{0};
     fm_vec3_t pos{0,0,0};
     fm_vec3_t scale{1,1,1};
     fm_quat_t rot{0,0,0,1};
     uint16_t objectId{0};
   };
 
+  /**
+   * Filter for spatial queries (see 'Scene::queryRadius').
+   * Default is all objects.
+   */
+  struct QueryFilter
+  {
+    uint16_t compMask{0}; // only objects with any of these component types (bit per ID), 0 for all
+    uint16_t flags{0}; // only objects with all of these flags set, e.g. 'ObjectFlags::ACTIVE'
+
+    [[nodiscard]] bool matches(const Object &obj) const;
+  };
+
   class Scene
   {
     private:
+      // cell size of the object grid used for spatial queries
+      constexpr static float QUERY_CELL_SIZE = 64.0f;
+
       std::vector<Camera*> cameras{};
       Camera *camMain{nullptr};
+      // cells (see Comp::Culling) the active camera can see into, all if it is outside any cell
+      uint32_t visibleCells{0xFFFF'FFFF};
+      uint8_t camIndex{0};
 
       RenderPipeline *renderPipeline{nullptr};
 
-      // @TODO: avoid vector + fragmented alloc
+      // all objects, sorted by their address in memory.
+      // scene objects are packed in file order (arena), spawned ones come from a pool.
+      // objects never move after creation, so pointers and IDs stay valid until deleted.
       std::vector<Object*> objects{};
       std::vector<PrefabParams> objectsToAdd{};
 
-      // create a direct lookup table for the first few IDs
-      // most scene probably don't exceed that much anyway
-      std::array<Object*, 128> idLookup{};
+      // objects from the scene file live in one block, runtime spawns in a pool
+      Mem::Arena objArena{};
+      Mem::Pool objPool{};
+
+      // pre-parsed prefabs, created on the first spawn.
+      // a prefab can reserve memory for a fixed amount of instances, set in the editor.
+      struct PrefabTemplate {
+        uint32_t allocSize{};
+        uint16_t group{};
+        uint16_t compCount{};
+        uint8_t updateTier{};
+        std::vector<Object::CompRef> compRefs{};
+        std::vector<void*> compInitData{};
+        Mem::Arena instances{};
+        std::vector<Object*> freeInstances{};
+      };
+      std::unordered_map<uint32_t, PrefabTemplate> prefabTemplates{};
+
+      // streamed part of the scene, cells on the XZ-plane with their own objects and assets.
+      // assets of a chunk are only the ones not already used by the rest of the scene (or any prefab)
+      struct Chunk {
+        enum class State : uint8_t {
+          UNLOADED,
+          PREFETCH,  // file is loaded and its assets queued, objects not created yet
+          LOADED,
+          UNLOADING, // objects deleted, memory is freed once the RSP is done with the last draws
+        };
+
+        int16_t cellX{};
+        int16_t cellZ{};
+        State state{};
+        uint8_t framesLeft{};
+        uint8_t* file{};
+        uint32_t fileSize{};
+        Mem::Arena arena{};
+        std::vector<uint16_t> objectIds{};
+        std::vector<uint16_t> assets{};
+      };
+      Chunk* chunks{nullptr};
+      uint32_t chunkCount{0};
+      float chunkSize{0.0f};
+      float chunkLoadDist{0.0f};
+      // how many prefetched/loaded chunks use an asset, freed when this drops to zero
+      std::unordered_map<uint16_t, uint16_t> chunkAssetRefs{};
+
+      // all component instances per type (that can update or draw), in object memory order
+      struct CompInstance {
+        Object* obj;
+        char* data;
+      };
+      std::vector<CompInstance> compLists[COMP_TABLE_SIZE]{};
+      // the same, without disabled objects. rebuilt on first use after objects got enabled/disabled, added or removed,
+      // so the per-frame loops don't touch pooled or inactive objects (see 'getActiveList')
+      mutable std::vector<CompInstance> activeLists[COMP_TABLE_SIZE]{};
+      mutable bool activeDirty{true};
+
+      // constraints with their reference resolved, referenced constraints come first (see 'sortConstraints').
+      // rebuilt whenever objects are added or removed
+      struct ConstraintSlot {
+        Object* obj;
+        Comp::Constraint* data;
+        Object* refObj;
+        uint32_t depth;
+      };
+      std::vector<ConstraintSlot> constraintOrder{};
+      bool constraintsDirty{true};
+      // persistent objects were handed over to the next scene, their matrices must stay allocated
+      bool keepMatrices{false};
+
+      // ID to object, covers the whole ID range (incl. spawned objects)
+      Lib::IdMap<Object> idLookup{};
+      uint16_t nextGeneration{1};
+
+      // all objects by position, updated once per tick after collision
+      Lib::SpatialGrid<Object> objGrid{QUERY_CELL_SIZE};
 
       Coll::Scene collScene{};
       std::vector<Object*> pendingObjDelete{};
@@ -92,32 +247,146 @@ namespace P64
 
       Lighting lighting{};
       Lighting lightingTemp{};
+      bool lightingOverride{false};
 
       SceneConf conf{};
       uint16_t id;
 
+      // fixed tick-rate, transforms before the last tick to interpolate from when drawing
+      struct InterpState {
+        Object* obj;
+        fm_quat_t prevRot;
+        fm_vec3_t prevPos;
+        fm_vec3_t prevScale;
+        fm_quat_t currRot;
+        fm_vec3_t currPos;
+        fm_vec3_t currScale;
+      };
+      struct InterpCamState {
+        Camera* cam;
+        fm_vec3_t prevPos;
+        fm_vec3_t prevTarget;
+        fm_vec3_t prevUp;
+        fm_vec3_t currPos;
+        fm_vec3_t currTarget;
+        fm_vec3_t currUp;
+      };
+      std::vector<InterpState> interpStates{};
+      std::vector<InterpCamState> interpCams{};
+      float tickTimeAccum{0.0f};
+      float tickAlpha{1.0f};
+
+      // update tiers (see 'Object::updateTier'), the time passed over the last 2^n ticks per tier
+      constexpr static uint32_t UPDATE_TIER_COUNT = 4;
+      uint32_t tickIndex{0};
+      float tickDeltas[1 << (UPDATE_TIER_COUNT-1)]{};
+      float tierDeltas[UPDATE_TIER_COUNT]{};
+
+      void tick(float deltaTime);
+      void storeInterpState();
+      void applyInterpState(bool interpolate);
+
       void loadSceneConfig();
-      Object* loadObject(uint8_t* &objFile, std::function<void(Object&)> callback = {});
+      Object* loadObject(uint8_t* &objFile, Mem::Arena &arena, const ObjectLayout &layout);
+      void loadObjects(uint8_t* file, uint32_t fileSize, uint32_t offsetObjects, uint32_t count, Mem::Arena &arena, Object** outObjects);
+      Object* spawnObject(const PrefabParams &params);
+      PrefabTemplate& getPrefabTemplate(uint32_t prefabIdx);
+      void addToScene(Object* obj);
+      void adoptObjects(const std::vector<Object*> &objs);
+      void changeObjectId(Object &obj);
       void loadScene();
+      void updateGroups(Object* const* objList, uint32_t count);
+      void loadChunkTable();
+      void updateChunks();
+      void prefetchChunk(Chunk &chunk);
+      void instantiateChunk(Chunk &chunk);
+      void releaseChunk(Chunk &chunk);
+      void freeChunks();
+      void freeObject(Object* obj);
+      void registerComponents(Object* obj);
+      void sortConstraints();
+      void updateConstraints();
+      void updateActiveLists() const;
+      const std::vector<CompInstance>& getActiveList(uint8_t compId) const {
+        if(activeDirty)updateActiveLists();
+        return activeLists[compId];
+      }
+      uint32_t getCellsVisibleFrom(const fm_vec3_t &pos) const;
+      void linkToParent(Object* obj);
+      void unlinkFromParent(Object* obj);
+      void dispatchEvent(Object &obj, const ObjectEvent &event);
 
     public:
+      /**
+       * Loads the list of assets used by a scene (including the prefabs it may spawn).
+       * The first entry is the count, followed by the asset indices.
+       * @param sceneId scene to load the list for
+       * @param persistent only the assets of persistent objects, requires 'SceneConf::FLAG_PERSISTENT'
+       * @return list, must be freed by the caller
+       */
+      static uint16_t* loadAssetList(uint16_t sceneId, bool persistent = false);
+
       uint64_t ticksActorUpdate{0};
       uint64_t ticksGlobalUpdate{0};
       uint64_t ticksGlobalDraw{0};
       uint64_t ticksDraw{0};
+      uint32_t ticksDelete{0};
+      uint32_t ticksConstraints{0};
+      uint32_t deleteCount{0};
+      uint32_t eventCount{0};
+      uint32_t eventOverflowCount{0};
+      uint32_t eventDroppedCount{0};
+      uint32_t tickCount{0}; // simulation ticks run in the last frame
+
+    #if P64_COMP_PROFILE
+      // time spent and functions called per component type in the last frame, indexed by component ID
+      uint32_t ticksCompUpdate[COMP_TABLE_SIZE]{};
+      uint32_t ticksCompDraw[COMP_TABLE_SIZE]{};
+      uint16_t callsCompUpdate[COMP_TABLE_SIZE]{};
+      uint16_t callsCompDraw[COMP_TABLE_SIZE]{};
+    #endif
 
-      explicit Scene(uint16_t sceneId, Scene** ref);
+      /**
+       * @param sceneId scene to load
+       * @param ref set to the scene before anything is loaded, components access it through the 'SceneManager'
+       * @param persistentObjects objects of the last scene to take over (see 'releasePersistentObjects'), can be null.
+       *        Objects in the scene file with the same ID that are persistent too are not created,
+       *        for any other object with that ID the persistent one gets a new ID.
+       */
+      explicit Scene(uint16_t sceneId, Scene** ref, const std::vector<Object*> *persistentObjects = nullptr);
       ~Scene();
 
       CLASS_NO_COPY_MOVE(Scene);
 
+      /**
+       * Removes all persistent objects from the scene without deleting them, so they can be moved into the next one.
+       * Their components get 'EVENT_TYPE_SCENE_LEAVE' to release anything tied to this scene (e.g. collision).
+       * Called by the 'SceneManager' before the scene is deleted.
+       * @param out receives the objects
+       */
+      void releasePersistentObjects(std::vector<Object*> &out);
+
+      /**
+       * Runs the simulation for one frame and then starts drawing it.
+       * With a fixed tick-rate (see 'SceneConf::tickRate') this may run zero or multiple ticks,
+       * in which case 'deltaTime' is ignored and each tick gets the fixed step instead.
+       */
       void update(float deltaTime);
       void draw(float deltaTime);
 
+      /**
+       * Fraction between the last two ticks used to interpolate transforms for drawing.
+       * Always 1 without a fixed tick-rate.
+       */
+      [[nodiscard]] float getTickAlpha() const { return conf.tickRate ? tickAlpha : 1.0f; }
+
       [[nodiscard]] SceneConf& getConf() { return conf; }
       [[nodiscard]] uint16_t getId() const { return id; }
       [[nodiscard]] Camera* getCamera(uint32_t index = 0) { return cameras[index]; }
       [[nodiscard]] Camera& getActiveCamera() { return *camMain; }
+      [[nodiscard]] uint32_t getVisibleCells() const { return visibleCells; }
+      // index of the camera currently drawing, in the order cameras were added
+      [[nodiscard]] uint32_t getActiveCameraIndex() const { return camIndex; }
       Coll::Scene &getCollision() { return collScene; }
 
       void onObjectCollision(const Coll::CollEvent &event);
@@ -126,6 +395,33 @@ namespace P64
         eventQueue[eventQueueIdx].add(targetId, senderId, type, value);
       }
 
+      /**
+       * Sends an event to all direct children of the given object.
+       * This only takes a single slot in the queue, objects are resolved when dispatching.
+       *
+       * @param groupId ID of the parent object
+       * @param senderId ID of the sender
+       * @param type event type
+       * @param value event value
+       * @param compMask only send to objects with any of these component types (bit per ID), 0 for all
+       */
+      void sendEventToChildren(uint16_t groupId, uint16_t senderId, uint16_t type, uint32_t value, uint16_t compMask = 0) {
+        eventQueue[eventQueueIdx].add(groupId, senderId, type, value, EventScope::CHILDREN, compMask);
+      }
+
+      /**
+       * Sends an event to all objects in the scene.
+       * This only takes a single slot in the queue, objects are resolved when dispatching.
+       *
+       * @param senderId ID of the sender
+       * @param type event type
+       * @param value event value
+       * @param compMask only send to objects with any of these component types (bit per ID), 0 for all
+       */
+      void broadcastEvent(uint16_t senderId, uint16_t type, uint32_t value, uint16_t compMask = 0) {
+        eventQueue[eventQueueIdx].add(0, senderId, type, value, EventScope::ALL, compMask);
+      }
+
       void addCamera(Camera *cam) {
         cameras.push_back(cam);
       }
@@ -179,6 +475,9 @@ namespace P64
       Object* getObjectById(uint16_t objId) const;
 
       uint32_t getObjectCount() const { return objects.size(); }
+      uint32_t getChunkCount() const { return chunkCount; }
+      uint32_t getLoadedChunkCount() const;
+      uint32_t getComponentCount(uint8_t compId) const { return compLists[compId].size(); }
 
       /**
        * Iterates over all direct children of the given parent object ID.
@@ -194,20 +493,96 @@ namespace P64
        */
       template<typename F>
       void iterObjectChildren(uint16_t parentId, F&& f) const {
-        for (auto o : objects) {
-          if(o->group != parentId)continue;
+        if(parentId == 0) { // root has no object, all top-level objects are its children
+          for (auto o : objects) {
+            if(o->group != 0)continue;
+            f(o);
+          }
+          return;
+        }
+
+        auto parent = getObjectById(parentId);
+        if(!parent)return;
+        for(auto o = parent->firstChild; o; o = o->nextSibling) {
           f(o);
         }
       }
 
+      /**
+       * Calls 'f' for all objects within a distance of the given position.
+       * Candidates come from a grid (see 'QUERY_CELL_SIZE'), so only objects nearby are checked.
+       * The grid updates once per tick, objects that moved across a cell since then may be missed.
+       *
+       * @param pos center
+       * @param radius max. distance
+       * @param f callback function, takes Object* as argument
+       * @param filter component/flag filter
+       */
+      template<typename F>
+      void queryRadius(const fm_vec3_t &pos, float radius, F&& f, QueryFilter filter = {}) const {
+        float radius2 = radius * radius;
+        objGrid.query(pos.x - radius, pos.z - radius, pos.x + radius, pos.z + radius, [&](Object* o) {
+          if(!filter.matches(*o))return;
+          auto diff = o->pos - pos;
+          if(t3d_vec3_len2(&diff) <= radius2)f(o);
+        });
+      }
+
+      /**
+       * Calls 'f' for all objects with a position inside the given box.
+       * Same as 'queryRadius', but with an axis-aligned box.
+       *
+       * @param min min. corner
+       * @param max max. corner
+       * @param f callback function, takes Object* as argument
+       * @param filter component/flag filter
+       */
+      template<typename F>
+      void queryAABB(const fm_vec3_t &min, const fm_vec3_t &max, F&& f, QueryFilter filter = {}) const {
+        objGrid.query(min.x, min.z, max.x, max.z, [&](Object* o) {
+          if(!filter.matches(*o))return;
+          if(o->pos.x < min.x || o->pos.y < min.y || o->pos.z < min.z)return;
+          if(o->pos.x > max.x || o->pos.y > max.y || o->pos.z > max.z)return;
+          f(o);
+        });
+      }
+
       void setGroupEnabled(uint16_t groupId, bool enabled) const;
 
+      /**
+       * Called whenever an object gets enabled or disabled, see 'Object::setEnabled'.
+       * Only needed if the active flags are changed directly.
+       */
+      void markActiveDirty() const { activeDirty = true; }
+
+      /**
+       * Marks all (nested) children of an object as culled for the current draw.
+       * Used by group culling, so a failed test on the parent skips the entire subtree.
+       * @param obj parent object, its own flag is not changed
+       */
+      void setChildrenCulled(Object &obj) const;
+
       [[nodiscard]] Lighting& getLighting() { return lighting; }
 
       [[nodiscard]] Lighting& startLightingOverride(bool copyExisting = true);
       void endLightingOverride();
 
+      /**
+       * Picks the point lights for a single draw, only needed with more point lights than slots.
+       * Ignored while an override is active (e.g. fresnel materials).
+       * @param sel per object cache
+       * @param pos position of the object
+       */
+      void applyObjectLights(Lighting::Selection &sel, const fm_vec3_t &pos) {
+        if(!lightingOverride)lighting.applyForObject(sel, pos);
+      }
+
   };
 }
 
-#include "object.h"
\ No newline at end of file
+#include "object.h"
+
+inline bool P64::QueryFilter::matches(const Object &obj) const {
+  if(compMask && !(obj.compMask & compMask))return false;
+  return (obj.flags & flags) == flags;
+}
\ No newline at end of file
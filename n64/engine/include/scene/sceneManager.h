@@ -4,6 +4,7 @@
 */
 #pragma once
 #include <libdragon.h>
+#include "assets/assetManager.h"
 
 namespace P64
 {
@@ -19,10 +20,41 @@ namespace P64::SceneManager
    * Request loading a scene by ID.
    * Note that the actual load will happen at the end of the current frame.
    * If this function was called multiple times, the last ID will be used.
+   *
+   * Objects marked as persistent in the editor (with their children) are not deleted,
+   * but moved into the new scene together with their assets. Their components receive
+   * 'EVENT_TYPE_SCENE_LEAVE' and 'EVENT_TYPE_SCENE_ENTER' around the switch.
+   * References to other objects (e.g. constraints) are not updated and resolve within the new scene.
    * @param sceneId scene to load
    */
   void load(uint16_t newSceneId);
 
+  /**
+   * Starts loading the assets of a scene in the background, while the current one keeps running.
+   * Assets are streamed in over the next frames (see 'AssetManager::processQueue()'),
+   * and stay loaded when switching to that scene via 'load()'.
+   * @param sceneId scene to preload
+   * @param memBudget max. heap memory in bytes the preloaded assets may take, 0 for no limit
+   */
+  void preload(uint16_t sceneId, uint32_t memBudget = 0);
+
+  /**
+   * Sets a function called during a scene load for every asset that wasn't preloaded yet.
+   * It can be used to draw a loading screen, nothing else is drawn at that point.
+   * @param fn callback, null to disable
+   */
+  void setLoadScreen(AssetManager::ProgressFunc fn);
+
+  [[nodiscard]] AssetManager::ProgressFunc getLoadScreen();
+
+  /**
+   * Looks up a scene by its name (as set in the editor) at runtime, in constant time.
+   * For names known at compile time, prefer the '_scene' literal instead.
+   * @param name scene name
+   * @return scene ID, or 0 if not found
+   */
+  [[nodiscard]] uint16_t getSceneId(const char* name);
+
   /**
    * Returns the current scene.
    * @return scene, never NULL
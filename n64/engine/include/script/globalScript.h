@@ -3,6 +3,7 @@
 * @license MIT
 */
 #pragma once
+#include <cstdint>
 
 namespace P64::GlobalScript
 {
@@ -31,5 +32,25 @@ namespace P64::GlobalScript
     _size_,
   };
 
-  void callHooks(HookType type);
+  // bit per 'HookType' that at least one script implements, generated in the project
+  extern const uint32_t HOOK_MASK;
+
+  // ticks spent in each hook since the last 'resetHookTicks' (debug overlay)
+  extern uint32_t hookTicks[(uint32_t)HookType::_size_];
+
+  // calls all implementations of a hook, generated in the project
+  void dispatchHooks(HookType type);
+  void dispatchHooksTimed(HookType type);
+  void resetHookTicks();
+
+  /**
+   * Calls all global scripts implementing the given hook.
+   * Hooks nobody implements are filtered out here, without any call.
+   */
+  inline void callHooks(HookType type)
+  {
+    if(HOOK_MASK & (1u << (uint32_t)type)) {
+      dispatchHooksTimed(type);
+    }
+  }
 }
\ No newline at end of file
@@ -18,12 +18,26 @@ namespace P64::NodeGraph
 
   struct GraphDef;
   struct NodeDef;
+  struct Worker;
+
+  /**
+   * Base of the state of graphs compiled into a state machine (graphs with a stack-size of 0).
+   * These run without a coroutine, 'step' is the case the generated code resumes at.
+   */
+  struct StateBase
+  {
+    constexpr static uint16_t STEP_DONE = 0xFFFF;
+
+    uint64_t wakeTicks;
+    uint16_t step;
+  };
 
   class Instance
   {
     private:
       GraphDef* graphDef{};
-      coroutine_t *corot{};
+      Worker *worker{};
+      void* state{};
 
     public:
       Object *object{};
@@ -36,10 +50,25 @@ namespace P64::NodeGraph
 
       void load(uint16_t assetIdx);
       bool update(float deltaTime);
+
+      /**
+       * Returns the variables of a state machine graph, allocated and zeroed on first use.
+       * Only called by generated code, which knows the actual size.
+       */
+      void* getState(uint32_t size) {
+        if(!state)state = calloc(1, size);
+        return state;
+      }
   };
 
   typedef int(*UserFunc)(uint32_t);
 
   void registerFunction(uint32_t strCRC32, UserFunc fn);
   UserFunc getFunction(uint64_t uuid);
+
+  /**
+   * Frees all idle coroutines kept for reuse, called by the scene on unload.
+   * Graphs that are still running are not affected.
+   */
+  void freePool();
 }
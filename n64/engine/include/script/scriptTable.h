@@ -29,4 +29,15 @@ namespace P64::Script
   ScriptEntry &getCodeByIndex(uint32_t idx);
   uint16_t getCodeSizeByIndex(uint32_t idx);
   NodeGraph::GraphFunc getGraphFuncByUUID(uint64_t uuid);
+
+  /**
+   * Loads the script overlay (DSO) of a scene, NOP if it has none.
+   * Scripts in it have an empty entry and no data size until then, so this has to happen before any object is created.
+   * Only exists if enabled in the project settings, any previous overlay is unloaded first.
+   */
+  void loadSceneOverlay(uint16_t sceneId);
+  void unloadSceneOverlay();
+
+  // slot of a user function called by any node graph, nullptr if no graph uses it
+  NodeGraph::UserFunc* getUserFuncSlot(uint32_t strCRC32);
 }
\ No newline at end of file
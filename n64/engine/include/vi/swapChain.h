@@ -5,9 +5,22 @@
 #pragma once
 #include <libdragon.h>
 #include <functional>
+#include "lib/ringBuffer.h"
 
 namespace P64::VI::SwapChain
 {
+  constexpr uint32_t MAX_FB_COUNT = 3;
+
+  // frame pacing, recorded once per frame
+  struct FrameStats
+  {
+    uint16_t cpuWaitUs; // time 'nextFrame' waited for a free buffer
+    uint16_t rdpBusyUs; // time the RDP pipeline was busy in the last finished pass
+    uint8_t missedVBlanks; // VBlanks without a new buffer to show (excl. frame-skip)
+  };
+  constexpr uint32_t FRAME_STATS_COUNT = 64;
+  using FrameStatsBuffer = RingBuffer<FrameStats, FRAME_STATS_COUNT>;
+
   using RenderPassCB = void(*)(uint32_t fbIndex);
   using RenderPassDrawTask = std::function<void(surface_t* fb, uint32_t fbIndex, RenderPassCB done)>;
 
@@ -15,15 +28,43 @@ namespace P64::VI::SwapChain
 
   void setVBlank(bool enabled);
   float getDeltaTime();
+  // unsmoothed time of the last frame, only capped to filter out broken values
+  float getFrameTime();
   float getFPS();
+  // time a single frame may take to hit the refresh-rate (incl. frame-skip), in seconds
+  float getFrameBudget();
 
+  /**
+   * Blocks until a new frame can be started, 'nextFrame' does the same if not called before.
+   * Calling it before the update shortens the time between input and display.
+   */
+  void waitForFrame();
   void nextFrame();
   void drain();
   void setFrameSkip(uint32_t skip);
 
+  /**
+   * In low-latency mode, a new frame is only started once the VI took all finished ones,
+   * so at most one frame is queued ahead of it. The RSP queue gets flushed after each draw
+   * to start the RDP right away, instead of once the next frame fills up the buffer.
+   * Costs throughput if the CPU and RDP would otherwise overlap more.
+   */
+  void setLowLatency(bool enabled);
+
   void setDrawPass(RenderPassDrawTask task);
   void start();
 
   surface_t *getFrameBuffer(uint32_t idx);
-  void setFrameBuffers(surface_t buffers[3]);
+
+  /**
+   * Sets the buffers to present, this also resets the swap-chain state.
+   * Must only be called while no pass is running (e.g. after 'drain').
+   * @param buffers array of 'count' buffers, must stay valid until replaced
+   * @param count 2 (double) or 3 (triple buffering)
+   */
+  void setFrameBuffers(surface_t *buffers, uint32_t count = MAX_FB_COUNT);
+  uint32_t getFrameBufferCount();
+
+  // oldest entry first, see 'FrameStats'
+  const FrameStatsBuffer &getFrameStats();
 }
\ No newline at end of file
@@ -5,10 +5,16 @@
 #include "assets/assetManager.h"
 
 #include <libdragon.h>
+#include <cstring>
+#include <vector>
 
 #include "assets/assetTypes.h"
 #include "lib/logger.h"
+#include "lib/memory.h"
+#include "lib/types.h"
 #include "scene/components/model.h"
+#include "debug/hotReload.h"
+#include "debug/loadReport.h"
 
 namespace P64::NodeGraph
 {
@@ -20,6 +26,7 @@ namespace
   struct AssetEntry
   {
     constexpr static uint8_t FLAG_KEEP_LOADED = 1 << 0;
+    constexpr static uint8_t FLAG_RETAIN      = 1 << 1; // runtime only, set during 'freeAll()'
 
     const char* path{};
     void* data{};
@@ -32,6 +39,11 @@ namespace
       return (uint32_t)data >> (32-4);
     }
 
+    void setFlag(uint32_t flag, bool enabled) {
+      uint32_t mask = flag << (32-8);
+      data = (void*)(enabled ? ((uint32_t)data | mask) : ((uint32_t)data & ~mask));
+    }
+
     void* getPointer() const {
       return (void*)(
         ((uint32_t)data & 0x00FF'FFFF)
@@ -51,7 +63,12 @@ namespace
   struct AssetTable
   {
     uint32_t count{};
+    uint32_t hashMask{}; // path hash-table, stored after the entries
     AssetEntry entries[];
+
+    [[nodiscard]] const uint16_t* getHashSlots() const {
+      return (const uint16_t*)&entries[count];
+    }
   };
 
   struct AssetHandler
@@ -82,7 +99,46 @@ namespace
   };
 
   constinit AssetTable* assetTable{nullptr};
+  struct AssetStats
+  {
+    uint32_t size; // heap used by the loaded asset, for the memory tracking
+    uint32_t loadTimeUs; // time of the last load, incl. reading and decompression
+  };
+  constinit AssetStats* assetStats{nullptr};
   constinit bool isInit{false};
+
+  P64::Mem::Category getMemCategory(uint32_t type) {
+    switch(type) {
+      case AssetType::IMAGE   : return P64::Mem::Category::ASSET_IMAGE;
+      case AssetType::AUDIO   : return P64::Mem::Category::ASSET_AUDIO;
+      case AssetType::FONT    : return P64::Mem::Category::ASSET_FONT;
+      case AssetType::MODEL_3D: return P64::Mem::Category::ASSET_MODEL;
+      default                 : return P64::Mem::Category::ASSET_OTHER;
+    }
+  }
+
+  // assets requested via 'prefetch()', loaded in order over the next frames
+  std::vector<uint16_t> loadQueue{};
+  constinit uint32_t queueHeapLimit{0};
+
+  void freeEntry(uint32_t idx)
+  {
+    auto &entry = assetTable->entries[idx];
+    auto type = entry.getType();
+    const auto &loader = assetHandler[type];
+    void *data = (void*)((uint32_t)entry.getPointer() | 0x8000'0000);
+    loader.fnFree(data);
+    entry.setPointer(nullptr);
+    P64::Mem::track(getMemCategory(type), -(int32_t)assetStats[idx].size);
+    assetStats[idx].size = 0;
+  }
+
+  bool isQueueHeapLimitReached() {
+    if(queueHeapLimit == 0)return false;
+    heap_stats_t heapStats;
+    sys_get_heap_stats(&heapStats);
+    return (uint32_t)heapStats.used >= queueHeapLimit;
+  }
 }
 
 void P64::AssetManager::init() {
@@ -95,26 +151,44 @@ void P64::AssetManager::init() {
     uint32_t offset = (uint32_t)entry.path;
     entry.path = (char*)assetTable + offset;
   }
+  assetStats = (AssetStats*)calloc(assetTable->count, sizeof(AssetStats));
 }
 
-void P64::AssetManager::freeAll() {
+void P64::AssetManager::freeAll(const uint16_t* keepIndices, uint32_t keepCount) {
+  loadQueue.clear();
+  queueHeapLimit = 0;
+  for (uint32_t i = 0; i < keepCount; ++i) {
+    if(keepIndices[i] < assetTable->count) {
+      assetTable->entries[keepIndices[i]].setFlag(AssetEntry::FLAG_RETAIN, true);
+    }
+  }
+
   for (uint32_t i = 0; i < assetTable->count; ++i)
   {
     auto &entry = assetTable->entries[i];
+    auto flags = entry.getFlags();
+    if(flags & AssetEntry::FLAG_RETAIN) {
+      entry.setFlag(AssetEntry::FLAG_RETAIN, false);
+      continue;
+    }
+
     if(entry.getPointer())
     {
-      auto flags = entry.getFlags();
       if(flags & AssetEntry::FLAG_KEEP_LOADED)continue;
-
-      auto type = entry.getType();
-      const auto &loader = assetHandler[type];
-      void *data = (void*)((uint32_t)entry.getPointer() | 0x8000'0000);
-      loader.fnFree(data);
-      entry.setPointer(nullptr);
+      freeEntry(i);
     }
   }
 }
 
+void P64::AssetManager::free(uint32_t idx) {
+  if(idx >= assetTable->count)return;
+  std::erase(loadQueue, idx);
+
+  auto &entry = assetTable->entries[idx];
+  if(!entry.getPointer() || (entry.getFlags() & AssetEntry::FLAG_KEEP_LOADED))return;
+  freeEntry(idx);
+}
+
 void* P64::AssetManager::getByIndex(uint32_t idx) {
   if (idx >= assetTable->count) {
     return nullptr;
@@ -127,8 +201,19 @@ void* P64::AssetManager::getByIndex(uint32_t idx) {
     auto type = entry.getType();
     const auto &loader = assetHandler[type];
     assertf(loader.fnLoad != nullptr, "No asset loader for type: %lu, %lu:%s", type, idx, entry.path);
-    res = loader.fnLoad(entry.path);
+    // loaders don't report sizes, so measure the heap instead
+    uint32_t heapStart = Mem::getHeapUsed();
+    uint64_t ticksStart = get_ticks();
+    auto reportStart = Debug::LoadReport::mark();
+    res = loader.fnLoad(Debug::HotReload::resolvePath(entry.path));
     entry.setPointer(res);
+
+    auto &stats = assetStats[idx];
+    stats.loadTimeUs = TICKS_TO_US(get_ticks() - ticksStart);
+    uint32_t heapEnd = Mem::getHeapUsed();
+    stats.size = heapEnd > heapStart ? (heapEnd - heapStart) : 0;
+    Mem::track(getMemCategory(type), stats.size);
+    Debug::LoadReport::onAsset(idx, reportStart, stats.size);
     //debugf("Load Asset: %s | %lu\n", entry.path, type);
   } else {
     res = (void*)((uint32_t)res | 0x8000'0000);
@@ -137,13 +222,87 @@ void* P64::AssetManager::getByIndex(uint32_t idx) {
   return res;
 }
 
-/*void* P64::AssetManager::getByFilePath(const std::string &path)
-{
-  for (uint32_t i = 0; i < assetTable->count; ++i) {
-    auto &entry = assetTable->entries[i];
-    if (path == entry.path) {
-      return getByIndex(i);
+bool P64::AssetManager::isLoaded(uint32_t idx) {
+  return idx < assetTable->count && assetTable->entries[idx].getPointer() != nullptr;
+}
+
+const char* P64::AssetManager::getPath(uint32_t idx) {
+  return idx < assetTable->count ? assetTable->entries[idx].path : nullptr;
+}
+
+void P64::AssetManager::preload(const uint16_t* indices, uint32_t count, ProgressFunc fnProgress) {
+  uint32_t total = 0;
+  if(fnProgress) {
+    for(uint32_t i=0; i<count; ++i) {
+      if(indices[i] < assetTable->count && !isLoaded(indices[i]))++total;
     }
   }
-  return nullptr;
-}*/
+
+  uint32_t loaded = 0;
+  for(uint32_t i=0; i<count; ++i) {
+    if(fnProgress && indices[i] < assetTable->count && !isLoaded(indices[i])) {
+      fnProgress(loaded++, total);
+    }
+    getByIndex(indices[i]);
+    mixer_try_play(); // keeps streamed music going during long loads
+  }
+}
+
+void P64::AssetManager::prefetch(uint32_t idx) {
+  if(idx >= assetTable->count || isLoaded(idx))return;
+  for(auto queued : loadQueue) {
+    if(queued == idx)return;
+  }
+  loadQueue.push_back(idx);
+}
+
+void P64::AssetManager::processQueue(uint32_t budgetUs) {
+  if(loadQueue.empty())return;
+
+  uint64_t tStart = get_ticks();
+  uint32_t done = 0;
+  while(done < loadQueue.size()) {
+    if(isQueueHeapLimitReached())break;
+    getByIndex(loadQueue[done++]);
+    if(TICKS_TO_US(get_ticks() - tStart) >= budgetUs)break;
+  }
+  loadQueue.erase(loadQueue.begin(), loadQueue.begin() + done);
+}
+
+void P64::AssetManager::setQueueHeapLimit(uint32_t maxHeapUsed) {
+  queueHeapLimit = maxHeapUsed;
+}
+
+void P64::AssetManager::logStats() {
+  Log::info("Assets (size, last load time):");
+  for (uint32_t i = 0; i < assetTable->count; ++i) {
+    auto &stats = assetStats[i];
+    if(stats.loadTimeUs == 0)continue;
+    Log::info("  %c %8lu %6luus %s", isLoaded(i) ? '*' : ' ', stats.size, stats.loadTimeUs, assetTable->entries[i].path);
+  }
+}
+
+uint32_t P64::AssetManager::getQueueSize() {
+  return loadQueue.size();
+}
+
+uint32_t P64::AssetManager::getIndexByPath(const char* path)
+{
+  if(strncmp(path, "rom:/", 5) == 0)path += 5;
+
+  // open-addressing table created by the editor, slots store the index + 1
+  const uint16_t* slots = assetTable->getHashSlots();
+  uint32_t slot = crc32(path, strlen(path)) & assetTable->hashMask;
+  while(slots[slot] != 0) {
+    uint32_t idx = slots[slot] - 1;
+    if(strcmp(assetTable->entries[idx].path + 5, path) == 0)return idx;
+    slot = (slot + 1) & assetTable->hashMask;
+  }
+  return INVALID_INDEX;
+}
+
+void* P64::AssetManager::getByFilePath(const char* path)
+{
+  uint32_t idx = getIndexByPath(path);
+  return idx == INVALID_INDEX ? nullptr : getByIndex(idx);
+}
@@ -5,38 +5,191 @@
 #include "audio/audioManager.h"
 #include "lib/logger.h"
 #include "audioManagerPrivate.h"
+#include "debug/trace.h"
 
 #include <libdragon.h>
+#include <algorithm>
 #include <array>
 
 namespace
 {
-  constexpr uint32_t CHANNEL_COUNT = 32;
+  constexpr uint32_t MAX_CHANNEL_COUNT = 32;
+  // the last channels are reserved for music, two stereo tracks to crossfade between
+  constexpr uint32_t MUSIC_DECK_COUNT = 2;
+  constexpr uint32_t MUSIC_CHANNEL_COUNT = MUSIC_DECK_COUNT*2;
+  constexpr uint32_t MAX_SFX_CHANNEL_COUNT = MAX_CHANNEL_COUNT - MUSIC_CHANNEL_COUNT;
+
+  // defaults if not set by the scene
+  constexpr uint32_t DEF_SAMPLE_RATE = 32000;
+  constexpr uint32_t DEF_BUFFER_COUNT = 3;
+  constexpr uint32_t DEF_CHANNEL_COUNT = MAX_CHANNEL_COUNT;
+
+  constinit uint32_t sampleRate{0};
+  constinit uint32_t bufferCount{0};
+  constinit uint32_t channelCount{0};
+  constinit uint32_t sfxChannelCount{0};
+  constexpr float VOL_UNSET = -1.0f;
+
   constinit uint16_t nextUUID{1};
+  constinit uint32_t nextPlayIdx{0};
   constinit float masterVol{1.0f};
+  constinit bool masterVolChanged{false};
 
   struct Slot
   {
     wav64_t* audio{nullptr};
     float volume{1.0f};
+    float pan{0.5f};
+    float appliedVolL{VOL_UNSET}; // last volume set in the mixer, incl. master volume and pan
+    float appliedVolR{VOL_UNSET};
     float speed{1.0f};
+    uint32_t playIdx{0}; // increasing with each play, used to find the oldest voice
     uint16_t uuid{0};
+    uint8_t priority{0};
+    uint8_t activeIdx{0}; // position in 'activeSlots'
+    bool stereoRight{false}; // second channel of a stereo voice
   };
 
-  std::array<Slot, CHANNEL_COUNT> slots{};
+  std::array<Slot, MAX_SFX_CHANNEL_COUNT> slots{};
+
+  // slots of all playing voices (only the first channel for stereo), unordered
+  std::array<uint8_t, MAX_SFX_CHANNEL_COUNT> activeSlots{};
+  constinit uint32_t activeCount{0};
+
+  void applyVolume(uint32_t idx) {
+    auto &slot = slots[idx];
+    float vol = slot.volume * masterVol;
+    // linear pan, the center keeps the full volume on both sides
+    float volL = vol * fminf(1.0f, 2.0f - slot.pan * 2.0f);
+    float volR = vol * fminf(1.0f, slot.pan * 2.0f);
+    if(volL == slot.appliedVolL && volR == slot.appliedVolR)return;
+    slot.appliedVolL = volL;
+    slot.appliedVolR = volR;
+    mixer_ch_set_vol((int)idx, volL, volR);
+  }
+
+  void activateSlot(uint32_t idx) {
+    slots[idx].activeIdx = activeCount;
+    activeSlots[activeCount++] = idx;
+  }
+
+  void releaseSlot(uint32_t idx) {
+    uint32_t listIdx = slots[idx].activeIdx;
+    uint8_t lastSlot = activeSlots[--activeCount];
+    activeSlots[listIdx] = lastSlot;
+    slots[lastSlot].activeIdx = listIdx;
+
+    if(slots[idx].audio->wave.channels == 2)slots[idx+1] = {};
+    slots[idx] = {};
+  }
 
-  int32_t getFreeSlot() {
-    for(uint32_t i=0; i<slots.size(); ++i) {
-      if(!slots[i].audio)return (int32_t)i;
+  struct MusicDeck
+  {
+    wav64_t* audio{nullptr};
+    float volume{0.0f}; // fade volume, multiplied with the music volume
+    float fadeSpeed{0.0f}; // volume change per second
+    float appliedVol{VOL_UNSET};
+  };
+
+  std::array<MusicDeck, MUSIC_DECK_COUNT> decks{};
+  constinit uint32_t currDeck{0};
+  constinit float musicVol{1.0f};
+  constinit uint32_t musicBufferSize{0};
+  constinit uint64_t lastUpdateTicks{0};
+
+  int getDeckChannel(uint32_t deck) {
+    return (int)(sfxChannelCount + deck*2);
+  }
+
+  void closeDeck(uint32_t idx) {
+    auto &deck = decks[idx];
+    if(!deck.audio)return;
+    mixer_ch_stop(getDeckChannel(idx));
+    wav64_close(deck.audio);
+    deck = {};
+  }
+
+  void updateDeck(uint32_t idx, float deltaTime) {
+    auto &deck = decks[idx];
+    if(!deck.audio)return;
+    int ch = getDeckChannel(idx);
+    if(!mixer_ch_playing(ch)) {
+      closeDeck(idx);
+      return;
     }
-    return -1;
+
+    if(deck.fadeSpeed != 0.0f) {
+      deck.volume += deck.fadeSpeed * deltaTime;
+      if(deck.volume >= 1.0f) {
+        deck.volume = 1.0f;
+        deck.fadeSpeed = 0.0f;
+      } else if(deck.volume <= 0.0f) {
+        closeDeck(idx);
+        return;
+      }
+    }
+
+    float vol = deck.volume * musicVol * masterVol;
+    if(vol == deck.appliedVol)return;
+    deck.appliedVol = vol;
+    mixer_ch_set_vol(ch, vol, vol);
+  }
+
+  /**
+   * Checks if voice 'a' should rather be stolen than voice 'b'.
+   * Lower priority is stolen first, then the quieter one, and then the older one.
+   * Free slots are always the best candidate.
+   */
+  bool isBetterVictim(const Slot &a, const Slot &b) {
+    if(!a.audio || !b.audio)return !a.audio && b.audio;
+    if(a.priority != b.priority)return a.priority < b.priority;
+    if(a.volume != b.volume)return a.volume < b.volume;
+    return a.playIdx < b.playIdx;
+  }
+
+  void stopSlot(uint32_t idx) {
+    if(slots[idx].stereoRight)--idx;
+    mixer_ch_stop((int)idx);
+    releaseSlot(idx);
+  }
+
+  /**
+   * Returns the oldest voice of a sound if it already plays 'maxInstances' times.
+   * @return slot index or -1 if below the limit (or no limit is set)
+   */
+  int32_t getInstanceToReplace(wav64_t *audio, uint8_t maxInstances) {
+    if(maxInstances == 0)return -1;
+    uint32_t count = 0;
+    int32_t oldest = -1;
+    for(uint32_t i=0; i<activeCount; ++i) {
+      uint32_t idx = activeSlots[i];
+      if(slots[idx].audio != audio)continue;
+      ++count;
+      if(oldest < 0 || slots[idx].playIdx < slots[oldest].playIdx)oldest = (int32_t)idx;
+    }
+    return count >= maxInstances ? oldest : -1;
   }
 
-  int32_t getFreeSlotStereo() {
-    for(uint32_t i=0; i<slots.size()-1; ++i) {
-      if(!slots[i].audio && !slots[i+1].audio)return (int32_t)i;
+  /**
+   * Finds a slot (or two adjacent ones for stereo) to play a new sound in.
+   * If all are in use, the best voice to steal with a priority not above the given one is returned.
+   * @return slot index or -1 if nothing can be used
+   */
+  int32_t getSlot(uint32_t channels, uint8_t priority) {
+    int32_t best = -1;
+    const Slot* bestVictim = nullptr;
+    for(uint32_t i=0; i+channels<=sfxChannelCount; ++i) {
+      const Slot* victim = &slots[i];
+      if(channels == 2 && isBetterVictim(*victim, slots[i+1]))victim = &slots[i+1];
+      if(victim->audio && victim->priority > priority)continue;
+
+      if(!bestVictim || isBetterVictim(*victim, *bestVictim)) {
+        best = (int32_t)i;
+        bestVictim = victim;
+        if(!victim->audio)break; // free, can't get any better
+      }
     }
-    return -1;
+    return best;
   }
 }
 
@@ -45,74 +198,177 @@ namespace P64::AudioManager
   constinit uint64_t ticksUpdate{0};
 
   void setMasterVolume(float volume) {
+    if(volume == masterVol)return;
     masterVol = volume;
+    masterVolChanged = true;
   }
 
   void init() {
-    audio_init(32000, 3);
-    mixer_init(CHANNEL_COUNT);
+    configure(0, 0, 0);
+  }
+
+  void configure(uint32_t newSampleRate, uint32_t newBufferCount, uint32_t newChannelCount)
+  {
+    if(newSampleRate == 0)newSampleRate = DEF_SAMPLE_RATE;
+    if(newBufferCount == 0)newBufferCount = DEF_BUFFER_COUNT;
+    if(newChannelCount == 0)newChannelCount = DEF_CHANNEL_COUNT;
+    newChannelCount = std::clamp(newChannelCount, MUSIC_CHANNEL_COUNT + 2, MAX_CHANNEL_COUNT);
+
+    if(newSampleRate == sampleRate && newBufferCount == bufferCount && newChannelCount == channelCount)return;
+
+    // audio can't be re-configured while running, so anything playing (incl. music) is stopped
+    if(channelCount != 0) {
+      destroy();
+    }
+
+    sampleRate = newSampleRate;
+    bufferCount = newBufferCount;
+    channelCount = newChannelCount;
+    sfxChannelCount = channelCount - MUSIC_CHANNEL_COUNT;
+
+    audio_init((int)sampleRate, (int)bufferCount);
+    mixer_init((int)channelCount);
     slots = {};
+    activeCount = 0;
+    lastUpdateTicks = 0;
+  }
+
+  uint32_t getSampleRate() { return sampleRate; }
+  uint32_t getChannelCount() { return channelCount; }
+
+  uint32_t getActiveChannelMask() {
+    uint32_t mask = 0;
+    for(uint32_t i=0; i<channelCount; ++i) {
+      if(mixer_ch_playing((int)i))mask |= 1u << i;
+    }
+    return mask;
   }
 
   void update()
   {
+    P64_TRACE_SCOPE(AUDIO);
     auto ticks = get_ticks();
     mixer_try_play();
-    for(uint32_t i=0; i<CHANNEL_COUNT; ++i) {
-      if(slots[i].audio && !mixer_ch_playing((int)i))
-      {
-        if(slots[i].audio == slots[i+1].audio) { // stereo
-          slots[i+1].audio = nullptr;
-        }
-        slots[i].audio = nullptr;
-      }
 
-      if (slots[i].audio) { // mono
+    float deltaTime = lastUpdateTicks ? (float)TICKS_TO_US(ticks - lastUpdateTicks) * (1.0f / 1'000'000.0f) : 0.0f;
+    lastUpdateTicks = ticks;
+    for(uint32_t d=0; d<MUSIC_DECK_COUNT; ++d)updateDeck(d, deltaTime);
 
-        if (slots[i].audio->wave.channels == 2) {
-          mixer_ch_set_vol(i, slots[i].volume * masterVol, slots[i].volume * masterVol);
-          ++i;
-        }
+    // only voices that are playing are checked, everything else is handled when it changes
+    for(uint32_t i=0; i<activeCount;) {
+      uint32_t idx = activeSlots[i];
+      if(!mixer_ch_playing((int)idx)) {
+        releaseSlot(idx); // moves the last entry into 'i'
+        continue;
       }
+      if(masterVolChanged)applyVolume(idx);
+      ++i;
     }
+    masterVolChanged = false;
+
     ticksUpdate += get_ticks() - ticks;
   }
 
   void destroy() {
     stopAll();
+    for(uint32_t d=0; d<MUSIC_DECK_COUNT; ++d)closeDeck(d);
     mixer_close();
     audio_close();
   }
 
-  Audio::Handle play2D(wav64_t *audio) {
-    auto slot = audio->wave.channels == 2 ? getFreeSlotStereo() : getFreeSlot();
+  Audio::Handle play2D(wav64_t *audio, uint8_t priority, uint8_t maxInstances) {
+    uint32_t channels = audio->wave.channels == 2 ? 2 : 1;
+    auto slot = getInstanceToReplace(audio, maxInstances);
+    if(slot < 0)slot = getSlot(channels, priority);
     if(slot < 0)return {};
 
+    // steal whatever is still playing, for stereo this can be two different voices
+    for(uint32_t i=0; i<channels; ++i) {
+      if(slots[slot+i].audio)stopSlot(slot+i);
+    }
+
     ++nextUUID;
 
+    slots[slot] = {};
     slots[slot].audio = audio;
     slots[slot].uuid = nextUUID;
-    slots[slot].volume = 1.0f;
+    slots[slot].priority = priority;
+    slots[slot].playIdx = ++nextPlayIdx;
 
-    if(audio->wave.channels == 2) {
+    if(channels == 2) {
       slots[slot+1] = slots[slot];
+      slots[slot+1].stereoRight = true;
     }
 
+    activateSlot(slot);
     wav64_play(audio, slot);
+    applyVolume(slot); // the mixer keeps the volume of the previous voice on this channel
     //Log::info("Playing audio on channel %d, uuid: %d", slot, nextUUID);
     return Audio::Handle{(uint16_t)slot, nextUUID};
   }
 
   void stopAll() {
-    for(uint32_t i=0; i<CHANNEL_COUNT; i++)mixer_ch_stop(i);
+    for(uint32_t i=0; i<sfxChannelCount; i++)mixer_ch_stop(i);
     slots = {};
+    activeCount = 0;
+  }
+
+  void playMusic(const char* path, float fadeTime) {
+    // fade out the current track, any older one still fading out is cut-off
+    auto &oldDeck = decks[currDeck];
+    if(oldDeck.audio) {
+      if(fadeTime > 0.0f) {
+        oldDeck.fadeSpeed = -1.0f / fadeTime;
+      } else {
+        closeDeck(currDeck);
+      }
+    }
+
+    currDeck = (currDeck + 1) % MUSIC_DECK_COUNT;
+    closeDeck(currDeck);
+
+    auto &deck = decks[currDeck];
+    int ch = getDeckChannel(currDeck);
+    // streamed from ROM, only the mixer buffer is kept in memory.
+    // loop points are part of the file (set in the asset settings)
+    deck.audio = wav64_load(path, nullptr);
+    if(musicBufferSize) {
+      mixer_ch_set_limits(ch, 16, deck.audio->wave.frequency, (int)musicBufferSize);
+    }
+    deck.volume = fadeTime > 0.0f ? 0.0f : 1.0f;
+    deck.fadeSpeed = fadeTime > 0.0f ? (1.0f / fadeTime) : 0.0f;
+
+    wav64_play(deck.audio, ch);
+    updateDeck(currDeck, 0.0f);
+  }
+
+  void stopMusic(float fadeTime) {
+    for(uint32_t d=0; d<MUSIC_DECK_COUNT; ++d) {
+      if(fadeTime > 0.0f) {
+        if(decks[d].audio)decks[d].fadeSpeed = -1.0f / fadeTime;
+      } else {
+        closeDeck(d);
+      }
+    }
+  }
+
+  void setMusicVolume(float volume) {
+    musicVol = volume;
+  }
+
+  void setMusicBufferSize(uint32_t bytes) {
+    musicBufferSize = bytes;
+  }
+
+  bool isMusicPlaying() {
+    return decks[currDeck].audio != nullptr;
   }
 }
 
 void P64::Audio::Handle::stop() {
   auto entry = &slots[slot];
   if(entry->uuid != uuid)return;
-  mixer_ch_stop(slot);
+  stopSlot(slot);
   uuid = 0;
 }
 
@@ -120,26 +376,41 @@ void P64::Audio::Handle::setVolume(float volume)
 {
   auto entry = &slots[slot];
   if(entry->uuid != uuid)return;
-
   entry->volume = volume;
+  applyVolume(slot);
+}
 
-  // hack:
-  if (entry->audio->wave.channels == 2) {
-    volume *= masterVol;
-  }
-
-  mixer_ch_set_vol(slot, volume, volume);
+void P64::Audio::Handle::setVolume(float volume, float pan)
+{
+  auto entry = &slots[slot];
+  if(entry->uuid != uuid)return;
+  entry->volume = volume;
+  entry->pan = pan;
+  applyVolume(slot);
 }
 
 void P64::Audio::Handle::setSpeed(float speed)
 {
   auto entry = &slots[slot];
   if(entry->uuid != uuid)return;
+  if(entry->speed == speed)return;
   entry->speed = speed;
   float freq = entry->audio->wave.frequency * speed;
   mixer_ch_set_freq(slot, freq);
 }
 
+float P64::Audio::Handle::getPosition() {
+  auto entry = &slots[slot];
+  if(entry->uuid != uuid)return 0.0f;
+  return mixer_ch_get_pos(slot);
+}
+
+void P64::Audio::Handle::setPosition(float pos) {
+  auto entry = &slots[slot];
+  if(entry->uuid != uuid)return;
+  mixer_ch_set_pos(slot, pos);
+}
+
 bool P64::Audio::Handle::isDone() {
   auto entry = &slots[slot];
   if(entry->uuid != uuid)return true;
@@ -22,6 +22,7 @@ namespace {
   }
 
   constexpr float MIN_PENETRATION = 0.0001f;
+  constexpr float SWEEP_SKIN = 0.1f; // fraction of the radius a swept shape stops inside a face
 
   bool intersectRaySphere(
     const fm_vec3_t &rayStarting, const fm_vec3_t &rayNormalizedDirection,
@@ -108,12 +109,12 @@ namespace {
   {
     const auto &bcsPos = sphere.center;
 
-    const auto &vert0 = *face.v[0];
-    const auto &vert1 = *face.v[1];
-    const auto &vert2 = *face.v[2];
+    const auto &vert0 = face.v[0];
+    const auto &vert1 = face.v[1];
+    const auto &vert2 = face.v[2];
 
     // Face tests
-    float planeDist = pointPlaneDistance(bcsPos, vert0, face.normal);
+    float planeDist = t3d_vec3_dot(&bcsPos, &face.normal) - face.planeDist;
     // when we are behind the face (negative), half the distance that is needed to snap back in
     float planeDistAbs = planeDist < 0.0f ? fabsf(planeDist*2.0f) : planeDist;
     if(planeDistAbs < sphere.getRadius())
@@ -172,9 +173,9 @@ namespace {
   P64::Coll::CollInfo triVsBox(const P64::Coll::BCS &box, const P64::Coll::Triangle &face)
   {
     // move triangle to origin
-    const auto v0 = *face.v[0] - box.center;
-    const auto v1 = *face.v[1] - box.center;
-    const auto v2 = *face.v[2] - box.center;
+    const auto v0 = face.v[0] - box.center;
+    const auto v1 = face.v[1] - box.center;
+    const auto v2 = face.v[2] - box.center;
 
     const auto edge0 = v1 - v0;
     const auto edge1 = v2 - v1;
@@ -291,19 +292,61 @@ namespace {
   }
 }
 
+P64::Coll::Triangle P64::Coll::Mesh::getTriangle(uint32_t t) const
+{
+  auto &norm = normals[t];
+  Triangle tri{
+    .normal = {{
+     (float)norm.v[0] * (1.0f / 32767.0f),
+     (float)norm.v[1] * (1.0f / 32767.0f),
+     (float)norm.v[2] * (1.0f / 32767.0f)
+    }},
+    .v = {getVert(indices[t*3]), getVert(indices[t*3+1]), getVert(indices[t*3+2])}
+  };
+  tri.planeDist = t3d_vec3_dot(&tri.v[0], &tri.normal);
+  return tri;
+}
+
 P64::Coll::CollInfo P64::Coll::Mesh::vsSphere(const P64::Coll::BCS &sphere, const P64::Coll::Triangle &triangle) const {
   return triVsSphere(sphere, triangle);
 }
 
+float P64::Coll::Mesh::vsSweep(const BCS &bcs, const fm_vec3_t &motion, const Triangle &face, bool isBox) const
+{
+  // distance the shape reaches towards the plane, for boxes the extend projected onto the normal
+  float radius = isBox
+    ? t3d_vec3_dot(Math::abs(face.normal), bcs.halfExtend)
+    : bcs.getRadius();
+
+  // stop slightly inside, so the penetration check afterward still registers the contact
+  float targetDist = radius * (1.0f - SWEEP_SKIN);
+
+  auto end = bcs.center + motion;
+  float distStart = t3d_vec3_dot(&bcs.center, &face.normal) - face.planeDist;
+  float distEnd = t3d_vec3_dot(&end, &face.normal) - face.planeDist;
+
+  // anything ending in front, or less than half behind, is handled by the penetration check
+  if(distStart < targetDist || distEnd > -radius * 0.5f)return INFINITY;
+
+  float t = (distStart - targetDist) / (distStart - distEnd);
+  auto contact = bcs.center + motion * t - face.normal * targetDist;
+
+  auto baryPos = getTriBaryCoord(contact, face.v[0], face.v[1], face.v[2]);
+  const bool isInTri = (baryPos.v[0] >= 0.0f) && (baryPos.v[1] >= 0.0f)
+    && ((baryPos.v[0] + baryPos.v[1]) <= 1.0f);
+
+  return isInTri ? t : INFINITY;
+}
+
 P64::Coll::CollInfo P64::Coll::Mesh::vsBox(const P64::Coll::BCS &box, const P64::Coll::Triangle &triangle) const {
   return triVsBox(box, triangle);
 }
 
 Coll::RaycastRes Coll::Mesh::vsRay(const fm_vec3_t &rayStart, const fm_vec3_t &dir, const P64::Coll::Triangle &face) const
 {
-  const auto &vert0 = *face.v[0];
-  const auto &vert1 = *face.v[1];
-  const auto &vert2 = *face.v[2];
+  const auto &vert0 = face.v[0];
+  const auto &vert1 = face.v[1];
+  const auto &vert2 = face.v[2];
 
   // In most cases we want floor ray-casting, which can be  transformed into a 2D case.
   // Otherwise, fallback to a full 3D intersection test.
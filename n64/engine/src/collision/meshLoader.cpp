@@ -4,8 +4,15 @@
 */
 #include "collision/mesh.h"
 #include "collision/bvh.h"
+#include <unordered_map>
 
 namespace {
+  struct TriCacheEntry {
+    P64::Coll::PackedTri *data;
+    uint32_t refCount;
+  };
+  std::unordered_map<const P64::Coll::Mesh*, TriCacheEntry> triCaches{};
+
  char* align(char* ptr, size_t alignment) {
    return (char*)(((uintptr_t)ptr + alignment - 1) & ~(alignment - 1));
  }
@@ -34,6 +41,53 @@ namespace {
     }
   }
 
+  bool toBVHRange(float min, float max, int16_t &outMin, int16_t &outMax) {
+    min = floorf(min);
+    max = ceilf(max);
+    if(min < -32768.0f || max > 32767.0f)return false;
+    outMin = (int16_t)min;
+    outMax = (int16_t)max;
+    return true;
+  }
+
+  // re-calculates the bounds of a node (and all children) from the triangles it contains
+  bool refitNode(const P64::Coll::Mesh &mesh, const int16_t *data, P64::Coll::BVHNode *node)
+  {
+    int dataCount = node->value & 0b1111;
+    int offset = (int16_t)node->value >> 4;
+
+    fm_vec3_t min{INFINITY, INFINITY, INFINITY};
+    fm_vec3_t max{-INFINITY, -INFINITY, -INFINITY};
+
+    if(dataCount == 0) {
+      for(int c=0; c<2; ++c) {
+        auto &child = node[offset + c];
+        if(!refitNode(mesh, data, &child))return false;
+        for(int i=0; i<3; ++i) {
+          min.v[i] = fminf(min.v[i], child.aabb.min.v[i]);
+          max.v[i] = fmaxf(max.v[i], child.aabb.max.v[i]);
+        }
+      }
+    } else {
+      int offsetEnd = offset + dataCount;
+      while(offset < offsetEnd) {
+        int t = data[offset++];
+        for(int v=0; v<3; ++v) {
+          auto vert = mesh.getVert(mesh.indices[t*3 + v]);
+          for(int i=0; i<3; ++i) {
+            min.v[i] = fminf(min.v[i], vert.v[i]);
+            max.v[i] = fmaxf(max.v[i], vert.v[i]);
+          }
+        }
+      }
+    }
+
+    for(int i=0; i<3; ++i) {
+      if(!toBVHRange(min.v[i], max.v[i], node->aabb.min.v[i], node->aabb.max.v[i]))return false;
+    }
+    return true;
+  }
+
   [[maybe_unused]] static void debugDrawBVTree(const P64::Coll::BVH *bvh) {
     const int16_t *data = (int16_t*)&bvh->nodes[bvh->nodeCount]; // data starts right after nodes
     uint32_t basePtr = (uint32_t)(char*)bvh;
@@ -57,7 +111,7 @@ P64::Coll::Mesh* P64::Coll::Mesh::load(void* rawData)
   data = align(data, 4);
   mesh->verts = (fm_vec3_t *)data;
 
-  data += mesh->vertCount * sizeof(fm_vec3_t);
+  data += mesh->vertCount * (mesh->isQuantized() ? sizeof(IVec3) : sizeof(fm_vec3_t));
   data = align(data, 4);
   mesh->bvh = (BVH*)data;
 
@@ -66,3 +120,90 @@ P64::Coll::Mesh* P64::Coll::Mesh::load(void* rawData)
 
   return mesh;
 }
+
+uint32_t P64::Coll::Mesh::getDataSize() const
+{
+  auto dataEnd = (const char*)&bvh->nodes[bvh->nodeCount] + bvh->dataCount * sizeof(int16_t);
+  return dataEnd - (const char*)this;
+}
+
+P64::Coll::Mesh* P64::Coll::Mesh::cloneTransformed(const fm_vec3_t &pos, const fm_vec3_t &scale, const fm_quat_t &rot) const
+{
+  uint32_t size = getDataSize();
+  auto res = (Mesh*)malloc(size);
+  assertf(res, "Coll: failed to allocate baked mesh (%lu bytes)", size);
+  memcpy(res, this, size);
+  load(res);
+
+  // quantized meshes stay quantized with the same scale, anything moved out of the int16 range can't be baked
+  for(uint32_t v=0; v<vertCount; ++v) {
+    auto vert = rot * (getVert(v) * scale) + pos;
+    if(!isQuantized()) {
+      res->verts[v] = vert;
+      continue;
+    }
+    for(int i=0; i<3; ++i) {
+      float q = roundf(vert.v[i] / collScale);
+      if(q < -32768.0f || q > 32767.0f) {
+        free(res);
+        return nullptr;
+      }
+      res->vertsQuant[v].v[i] = (int16_t)q;
+    }
+  }
+
+  // normals use the inverse-transpose, which for scale+rotation is the rotated inverse scale
+  fm_vec3_t invScale{1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z};
+  for(uint32_t t=0; t<triCount; ++t) {
+    fm_vec3_t norm{(float)normals[t].v[0], (float)normals[t].v[1], (float)normals[t].v[2]};
+    norm = rot * (norm * invScale);
+    fm_vec3_norm(&norm, &norm);
+    res->normals[t] = {{
+      (int16_t)(norm.x * 32767.0f),
+      (int16_t)(norm.y * 32767.0f),
+      (int16_t)(norm.z * 32767.0f)
+    }};
+  }
+
+  const int16_t *bvhData = (int16_t*)&res->bvh->nodes[res->bvh->nodeCount];
+  if(!refitNode(*res, bvhData, res->bvh->nodes)) {
+    free(res);
+    return nullptr;
+  }
+  return res;
+}
+
+const P64::Coll::PackedTri* P64::Coll::Mesh::acquireTriCache() const
+{
+  auto it = triCaches.find(this);
+  if(it != triCaches.end()) {
+    ++it->second.refCount;
+    return it->second.data;
+  }
+
+  const int16_t *bvhData = bvh->getData();
+  auto cache = (PackedTri*)malloc(sizeof(PackedTri) * bvh->dataCount);
+  assertf(cache, "Coll: failed to allocate triangle cache (%d entries)", bvh->dataCount);
+
+  for(uint32_t i=0; i<bvh->dataCount; ++i) {
+    auto tri = getTriangle(bvhData[i]);
+    cache[i] = {
+      .v = {tri.v[0], tri.v[1], tri.v[2]},
+      .normal = tri.normal,
+      .planeDist = tri.planeDist,
+    };
+  }
+
+  triCaches[this] = {cache, 1};
+  return cache;
+}
+
+void P64::Coll::Mesh::releaseTriCache() const
+{
+  auto it = triCaches.find(this);
+  if(it == triCaches.end())return;
+  if(--it->second.refCount == 0) {
+    free(it->second.data);
+    triCaches.erase(it);
+  }
+}
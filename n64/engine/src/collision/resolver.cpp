@@ -11,6 +11,9 @@ namespace
 {
   namespace TriType = Coll::TriType;
 
+  // penetration along the warm-start axis may be this much larger than the minimum, before switching
+  constexpr float WARM_AXIS_BIAS = 1.25f;
+
   inline float copySign(float val, float sign) {
     return sign < 0 ? -val : val;
   }
@@ -70,7 +73,7 @@ bool Coll::sphereVsBox(Coll::BCS &sphere, Coll::BCS &box) {
   return separateBCS(sphere, box, dir, dist2, sphere.getRadius());
 }
 
-bool Coll::boxVsBox(Coll::BCS &collA, Coll::BCS &collB) {
+bool Coll::boxVsBox(Coll::BCS &collA, Coll::BCS &collB, uint8_t *warmAxis) {
   //auto ticks = get_ticks();
   auto combExtend = collA.halfExtend + collB.halfExtend;
   auto posDiff = collB.center - collA.center;
@@ -96,22 +99,16 @@ bool Coll::boxVsBox(Coll::BCS &collA, Coll::BCS &collB) {
     fm_vec3_t penDiff = combExtend - posDiffAbs;
     float min = Math::min(penDiff);
 
-    if(min == penDiff.x){
-        float pen = copySign(penDiff.x, posDiff.x);
-        collA.center.x = collA.center.x - pen * (1.0f - interp);
-        collB.center.x = collB.center.x + pen * (interp);
-    }
-    else if(min == penDiff.y){
-        float pen = copySign(penDiff.y, posDiff.y);
-        collA.center.y = collA.center.y - pen * (1.0f - interp);
-        collB.center.y = collB.center.y + pen * (interp);
-    }
-    else if(min == penDiff.z){
-        float pen = copySign(penDiff.z, posDiff.z);
-        collA.center.z = collA.center.z - pen * (1.0f - interp);
-        collB.center.z = collB.center.z + pen * (interp);
+    uint32_t axis = (min == penDiff.x) ? 0 : ((min == penDiff.y) ? 1 : 2);
+    if(warmAxis) {
+      if(*warmAxis < 3 && penDiff.v[*warmAxis] <= min * WARM_AXIS_BIAS)axis = *warmAxis;
+      *warmAxis = axis;
     }
 
+    float pen = copySign(penDiff.v[axis], posDiff.v[axis]);
+    collA.center.v[axis] = collA.center.v[axis] - pen * (1.0f - interp);
+    collB.center.v[axis] = collB.center.v[axis] + pen * (interp);
+
     /*if(min == penDiff.y) {
       collA.hitTriTypes |= TriType::FLOOR;
       collA.velocity.v[1] = 0.0f;
@@ -8,8 +8,11 @@
 #include "collision/bvh.h"
 #include "debug/debugDraw.h"
 #include "collision/resolver.h"
+#include "lib/sort.h"
 #include "lib/logger.h"
 #include "scene/sceneManager.h"
+#include <malloc.h>
+#include <algorithm>
 
 namespace
 {
@@ -25,296 +28,827 @@ namespace
   constexpr bool isFloor(float normY) {
     return normY > FLOOR_ANGLE;
   }
+
+  bool hasCollListener(const P64::Object *obj) {
+    return obj && (obj->flags & P64::ObjectFlags::HAS_COLL);
+  }
+
+  bool needsMeshCollision(const P64::Coll::BCS &bcs) {
+    return bcs.isSolid() && !bcs.isFixed() && bcs.maskRead != 0;
+  }
+
+  bool isSameVec(const fm_vec3_t &a, const fm_vec3_t &b) {
+    return memcmp(&a, &b, sizeof(fm_vec3_t)) == 0;
+  }
+
+  template<typename T>
+  bool isSamePairInput(const T &contact, const P64::Coll::BCS &bcsA, const P64::Coll::BCS &bcsB) {
+    return isSameVec(bcsA.center, contact.centerInA) && isSameVec(bcsB.center, contact.centerInB)
+      && isSameVec(bcsA.halfExtend, contact.halfExtendA) && isSameVec(bcsB.halfExtend, contact.halfExtendB)
+      && bcsA.flags == contact.flagsA && bcsB.flags == contact.flagsB;
+  }
+
+  P64::Coll::BCS toLocalBCS(const P64::Coll::BCS &bcs, const P64::Coll::MeshInstance &meshInst) {
+    auto bcsLocal = bcs;
+    if(!meshInst.isBaked) {
+      bcsLocal.center = meshInst.intoLocalSpace(bcs.center);
+      bcsLocal.halfExtend *= meshInst.invScale;
+    }
+    return bcsLocal;
+  }
+}
+
+P64::Coll::Scene::~Scene()
+{
+  free(rspBlocks);
+  free(rspResults);
 }
 
 P64::Coll::CollInfo P64::Coll::Scene::vsBCS(BCS &bcs, const fm_vec3_t &velocity, float deltaTime) {
-  float len = fm_vec3_len(&velocity) * deltaTime;
+  candidateTris.clear();
+
+  auto ticksBvhStart = get_ticks();
+  collectCandidates(bcs, velocity, deltaTime);
+  auto res = resolveCandidates(bcs, 0, candidateTris.size());
+  ticksBVH += get_ticks() - ticksBvhStart;
 
+  return res;
+}
+
+void P64::Coll::Scene::collectCandidates(BCS &bcs, const fm_vec3_t &velocity, float deltaTime) {
   bool isBox = bcs.flags & BCSFlags::SHAPE_BOX;
 
-  int steps = (int)(len * 1.5f);
-  steps = P64::Math::clamp(steps, 1, 8);
+  auto motion = velocity * deltaTime;
+  auto start = bcs.center;
+
+  // bounds covering the entire motion, triangles are fetched once for it and
+  // then used for both the time-of-impact and the final penetration checks
+  auto sweptMin = Math::min(bcs.getMinAABB(), bcs.getMinAABB() + motion);
+  auto sweptMax = Math::max(bcs.getMaxAABB(), bcs.getMaxAABB() + motion);
+
+  float toi = INFINITY;
+  fm_vec3_t toiNormal{};
+
+  for(auto meshInst : meshes)
+  {
+    if(!(bcs.maskRead & meshInst->maskWrite))continue;
+    if(!meshInst->vsAABB(sweptMin, sweptMax)) {
+      ++meshesSkipped;
+      continue;
+    }
+    auto &mesh = *meshInst->mesh;
+
+    auto bcsLocal = toLocalBCS(bcs, *meshInst);
+    auto motionLocal = meshInst->isBaked ? motion : (Math::quatRotate(meshInst->invRot, motion) * meshInst->invScale);
 
-  auto velocityStep = velocity * (deltaTime / steps);
+    auto sweptLocal = bcsLocal;
+    sweptLocal.center += motionLocal * 0.5f;
+    sweptLocal.halfExtend += Math::abs(motionLocal) * 0.5f;
+
+    auto addTri = [&](const Triangle &tri)
+    {
+      candidateTris.push_back({meshInst, tri, -1});
+      float t = mesh.vsSweep(bcsLocal, motionLocal, tri, isBox);
+      if(t < toi) {
+        toi = t;
+        toiNormal = meshInst->isBaked ? tri.normal : Math::quatRotate(meshInst->object->rot, tri.normal);
+      }
+    };
+
+    if(meshInst->triCache) {
+      auto triCache = meshInst->triCache;
+      mesh.bvh->queryAABBLeaf(sweptLocal.toAABB(), [&](int dataIdx) {
+        const auto &packed = triCache[dataIdx];
+        addTri(Triangle{
+          .normal = packed.normal,
+          .v = {packed.v[0], packed.v[1], packed.v[2]},
+          .planeDist = packed.planeDist
+        });
+      });
+    } else {
+      mesh.bvh->queryAABB(sweptLocal.toAABB(), [&](int16_t t) {
+        addTri(mesh.getTriangle(t));
+      });
+    }
+  }
+
+  bcs.center = start + motion;
+  if(toi <= 1.0f) {
+    // the motion would tunnel through a face, stop at the impact and slide along it
+    auto rest = motion * (1.0f - toi);
+    bcs.center = start + motion * toi + rest - toiNormal * t3d_vec3_dot(rest, toiNormal);
+  }
+}
+
+P64::Coll::CollInfo P64::Coll::Scene::resolveCandidates(BCS &bcs, uint32_t candBegin, uint32_t candEnd) {
+  bool isBox = bcs.flags & BCSFlags::SHAPE_BOX;
 
   P64::Coll::CollInfo res{};
-  P64::Coll::BVHResult bvhRes{};
+  MeshInstance *meshInst = nullptr;
+  BCS bcsLocal{};
+  // RSP results are only valid for the position they were computed at
+  bool moved = false;
 
-  for(int s=0; s<steps; ++s)
+  for(uint32_t c=candBegin; c<candEnd; ++c)
   {
-    bcs.center = bcs.center + velocityStep;
+    auto &candidate = candidateTris[c];
+    if(candidate.meshInst != meshInst) {
+      if(meshInst)bcs.center = meshInst->outOfLocalSpace(bcsLocal.center);
+      meshInst = candidate.meshInst;
+      bcsLocal = toLocalBCS(bcs, *meshInst);
+    }
 
-    for(auto meshInst : meshes)
+    auto &mesh = *meshInst->mesh;
+    CollInfo collInfo{};
+    if(candidate.rspIdx >= 0)
     {
-      auto &mesh = *meshInst->mesh;
+      const auto &rspRes = rspResults[candidate.rspIdx / 8];
+      uint32_t lane = candidate.rspIdx % 8;
+      int16_t flags = rspRes.flags[lane];
+
+      if(moved) {
+        // something closer was already resolved, so re-check anything that could have been pushed into
+        if(!(flags & RSPJobs::SphereTriFlags::NEAR))continue;
+        collInfo = mesh.vsSphere(bcsLocal, candidate.tri);
+      } else {
+        if(!(flags & (RSPJobs::SphereTriFlags::HIT_FACE | RSPJobs::SphereTriFlags::HIT_EDGE)))continue;
+        float scale = bcsLocal.getRadius() / RSPJobs::SPHERE_TRI_RADIUS;
+        collInfo = {
+          .penetration = fm_vec3_t{(float)rspRes.pen[0][lane], (float)rspRes.pen[1][lane], (float)rspRes.pen[2][lane]} * scale,
+          .floorWallAngle = candidate.tri.normal,
+          .collCount = 1
+        };
+      }
+    } else {
+      collInfo = isBox
+        ? mesh.vsBox(bcsLocal, candidate.tri)
+        : mesh.vsSphere(bcsLocal, candidate.tri);
+    }
 
-      auto bcsLocal = bcs;
-      bcsLocal.center = meshInst->intoLocalSpace(bcs.center);
-      bcsLocal.halfExtend *= meshInst->invScale;
+    if(collInfo.collCount)
+    {
+      float penLen2 = t3d_vec3_len2(&collInfo.penetration);
+      if(penLen2 < MIN_PENETRATION)continue;
 
-      auto ticksBvhStart = get_ticks();
-      bvhRes.reset();
-      mesh.bvh->vsBCS(bcsLocal, bvhRes);
+      ++res.collCount;
+      res.penetration = res.penetration + collInfo.penetration;
+      res.meshInstance = meshInst;
 
-      ticksBVH += get_ticks() - ticksBvhStart;
-      if(bvhRes.count >= P64::Coll::MAX_RESULT_COUNT-1) {
-        P64::Log::error("BVH result count exceeded max limit (%d)\n", bvhRes.count);
+      if(!meshInst->isBaked) {
+        collInfo.floorWallAngle = Math::quatRotate(meshInst->object->rot, collInfo.floorWallAngle);
       }
 
-      for(int b=0; b<bvhRes.count; ++b) {
-        uint32_t t = bvhRes.triIndex[b];
-
-        int idxA = mesh.indices[t*3];
-        int idxB = mesh.indices[t*3+1];
-        int idxC = mesh.indices[t*3+2];
-        auto &norm = mesh.normals[t];
-
-        Triangle tri{
-          .normal = {{
-           (float)norm.v[0] * (1.0f / 32767.0f),
-           (float)norm.v[1] * (1.0f / 32767.0f),
-           (float)norm.v[2] * (1.0f / 32767.0f)
-          }},
-          .v = {&mesh.verts[idxA], &mesh.verts[idxB], &mesh.verts[idxC]}
-        };
+      bool hitFloor = isFloor(collInfo.floorWallAngle.y);
+      bcs.hitTriTypes |= hitFloor ? TriType::FLOOR : TriType::WALL;
+      if(hitFloor) {
+        res.floorWallAngle.y = collInfo.floorWallAngle.y;
+      } else {
+        res.floorWallAngle.x = collInfo.floorWallAngle.x;
+        res.floorWallAngle.z = collInfo.floorWallAngle.z;
+      }
 
-        auto collInfo = isBox
-          ? mesh.vsBox(bcsLocal, tri)
-          : mesh.vsSphere(bcsLocal, tri);
+      bcsLocal.center -= collInfo.penetration;
+      moved = true;
+    }
+  }
 
-        if(collInfo.collCount)
-        {
-          float penLen2 = t3d_vec3_len2(&collInfo.penetration);
-          if(penLen2 < MIN_PENETRATION)continue;
-
-          ++res.collCount;
-          res.penetration = res.penetration + collInfo.penetration;
-          res.meshInstance = meshInst;
-
-          collInfo.floorWallAngle = meshInst->object->rot * collInfo.floorWallAngle;
-
-          bool hitFloor = isFloor(collInfo.floorWallAngle.y);
-          bcs.hitTriTypes |= hitFloor ? TriType::FLOOR : TriType::WALL;
-          if(hitFloor) {
-            res.floorWallAngle.y = collInfo.floorWallAngle.y;
-          } else {
-            res.floorWallAngle.x = collInfo.floorWallAngle.x;
-            res.floorWallAngle.z = collInfo.floorWallAngle.z;
-          }
+  if(meshInst)bcs.center = meshInst->outOfLocalSpace(bcsLocal.center);
+  return res;
+}
 
-          bcsLocal.center -= collInfo.penetration;
+void P64::Coll::Scene::packSphereTris()
+{
+  uint32_t blockCount = (candidateTris.size() + 7) / 8;
+  if(blockCount > rspBlockCapacity) {
+    free(rspBlocks);
+    free(rspResults);
+    rspBlockCapacity = std::max(blockCount, rspBlockCapacity * 2);
+    rspBlocks = (RSPJobs::SphereTriBlock*)memalign(CACHE_LINE_SIZE, sizeof(RSPJobs::SphereTriBlock) * rspBlockCapacity);
+    rspResults = (RSPJobs::SphereTriRes*)memalign(CACHE_LINE_SIZE, sizeof(RSPJobs::SphereTriRes) * rspBlockCapacity);
+  }
+
+  rspTriCount = 0;
+  for(auto &pending : pendingBCS)
+  {
+    auto &bcs = *pending.bcs;
+    if(bcs.flags & BCSFlags::SHAPE_BOX)continue;
+
+    MeshInstance *meshInst = nullptr;
+    BCS bcsLocal{};
+    float scale = 0.0f;
+
+    for(uint32_t c=pending.candBegin; c<pending.candEnd; ++c)
+    {
+      auto &candidate = candidateTris[c];
+      if(candidate.meshInst != meshInst) {
+        meshInst = candidate.meshInst;
+        bcsLocal = toLocalBCS(bcs, *meshInst);
+        scale = bcsLocal.getRadius() > 0.0f ? (RSPJobs::SPHERE_TRI_RADIUS / bcsLocal.getRadius()) : 0.0f;
+      }
+      if(scale == 0.0f)continue;
+
+      // huge triangles (compared to the sphere) don't fit into the fixed-point range, those stay on the CPU
+      fm_vec3_t rel[3];
+      bool inRange = true;
+      for(uint32_t v=0; v<3; ++v) {
+        rel[v] = (bcsLocal.center - candidate.tri.v[v]) * scale;
+        for(float axis : rel[v].v) {
+          if(fabsf(axis) > RSPJobs::SPHERE_TRI_MAX_COORD)inRange = false;
         }
-      } // BVH res
+      }
+      if(!inRange)continue;
+
+      candidate.rspIdx = rspTriCount++;
+      auto &block = rspBlocks[candidate.rspIdx / 8];
+      uint32_t lane = candidate.rspIdx % 8;
+      for(uint32_t v=0; v<3; ++v) {
+        for(uint32_t a=0; a<3; ++a)block.pos[v][a][lane] = (int16_t)rel[v].v[a];
+      }
+      for(uint32_t a=0; a<3; ++a) {
+        block.normal[a][lane] = (int16_t)(candidate.tri.normal.v[a] * 32767.0f);
+      }
+    }
+  }
 
-      bcs.center = meshInst->outOfLocalSpace(bcsLocal.center);
-    } // meshes
-  } // steps
+  // unused lanes of the last block are still processed, their results are ignored
+  if(rspTriCount % 8) {
+    auto &block = rspBlocks[rspTriCount / 8];
+    for(uint32_t lane=rspTriCount % 8; lane<8; ++lane) {
+      for(auto &vert : block.pos)for(auto &axis : vert)axis[lane] = 0;
+      for(auto &axis : block.normal)axis[lane] = 0;
+    }
+  }
 
-  return res;
+  RSPJobs::sphereVsTri(rspBlocks, rspResults, (rspTriCount + 7) / 8);
 }
 
 fm_vec3_t P64::Coll::MeshInstance::intoLocalSpace(const fm_vec3_t &p) const {
-  auto res = (p - object->pos);
-  return invRot * res * invScale;
+  if(isBaked)return p;
+  return Math::quatRotate(invRot, p - object->pos) * invScale;
 }
 fm_vec3_t P64::Coll::MeshInstance::outOfLocalSpace(const fm_vec3_t &p) const {
   /*if(inst.object->rot.w == 1.0f) {
     return (p * inst.object->scale) + inst.object->pos;
   }*/
-  return object->rot * (p * object->scale) + object->pos;
+  if(isBaked)return p;
+  return Math::quatRotate(object->rot, p * object->scale) + object->pos;
 }
 
-void P64::Coll::MeshInstance::update()
+bool P64::Coll::MeshInstance::update()
 {
+  if(isBaked)return false;
+  const auto &pos = object->pos;
+  const auto &scale = object->scale;
+  const auto &rot = object->rot;
+  if(memcmp(&pos, &lastPos, sizeof(pos)) == 0
+    && memcmp(&scale, &lastScale, sizeof(scale)) == 0
+    && memcmp(&rot, &lastRot, sizeof(rot)) == 0
+  )return false;
+
+  lastPos = pos;
+  lastScale = scale;
+  lastRot = rot;
+
   invScale = fm_vec3_t{
-    1.0f / object->scale.x,
-    1.0f / object->scale.y,
-    1.0f / object->scale.z,
+    1.0f / scale.x,
+    1.0f / scale.y,
+    1.0f / scale.z,
+  };
+  invRot = Math::quatInvUnit(rot);
+
+  // world-space AABB from the local one (BVH root) by transforming center + extend,
+  // the extend uses the absolute rotation matrix to get a box fully containing the rotated one
+  const auto &rootAABB = mesh->bvh->nodes[0].aabb;
+  fm_vec3_t localMin{(float)rootAABB.min.v[0], (float)rootAABB.min.v[1], (float)rootAABB.min.v[2]};
+  fm_vec3_t localMax{(float)rootAABB.max.v[0], (float)rootAABB.max.v[1], (float)rootAABB.max.v[2]};
+
+  auto center = outOfLocalSpace((localMin + localMax) * 0.5f);
+  auto extend = (localMax - localMin) * 0.5f * Math::abs(scale);
+
+  float xx = rot.x * rot.x, yy = rot.y * rot.y, zz = rot.z * rot.z;
+  float xy = rot.x * rot.y, xz = rot.x * rot.z, yz = rot.y * rot.z;
+  float wx = rot.w * rot.x, wy = rot.w * rot.y, wz = rot.w * rot.z;
+
+  float m[3][3] = {
+    {1.0f - 2.0f*(yy + zz), 2.0f*(xy - wz), 2.0f*(xz + wy)},
+    {2.0f*(xy + wz), 1.0f - 2.0f*(xx + zz), 2.0f*(yz - wx)},
+    {2.0f*(xz - wy), 2.0f*(yz + wx), 1.0f - 2.0f*(xx + yy)},
   };
-  fm_quat_inverse(&invRot, &object->rot);
+
+  fm_vec3_t extendWorld;
+  for(int i=0; i<3; ++i) {
+    extendWorld.v[i] = fabsf(m[i][0]) * extend.x + fabsf(m[i][1]) * extend.y + fabsf(m[i][2]) * extend.z;
+  }
+
+  aabbMin = center - extendWorld;
+  aabbMax = center + extendWorld;
+  return true;
 }
 
-void P64::Coll::Scene::update(float deltaTime)
+void P64::Coll::MeshInstance::bake()
 {
-  uint64_t ticksStart = get_ticks();
-  auto &gameScene = P64::SceneManager::getCurrent();
+  isStatic = true;
+  if(isBaked)return;
+  update();
+
+  auto baked = mesh->cloneTransformed(object->pos, object->scale, object->rot);
+  if(!baked) {
+    Log::warn("Coll: mesh of object %d exceeds the BVH range, keeping it in local-space\n", object->id);
+    return;
+  }
+
+  mesh = baked;
+  isBaked = true;
+  invScale = {1.0f, 1.0f, 1.0f};
+  invRot = {0.0f, 0.0f, 0.0f, 1.0f};
+
+  const auto &rootAABB = mesh->bvh->nodes[0].aabb;
+  aabbMin = {(float)rootAABB.min.v[0], (float)rootAABB.min.v[1], (float)rootAABB.min.v[2]};
+  aabbMax = {(float)rootAABB.max.v[0], (float)rootAABB.max.v[1], (float)rootAABB.max.v[2]};
+}
+
+void P64::Coll::MeshInstance::freeBaked()
+{
+  if(!isBaked)return;
+  free(mesh);
+  mesh = nullptr;
+  isBaked = false;
+}
+
+void P64::Coll::Scene::updateMeshCollision(BCS &bcs, float deltaTime)
+{
+  // Static/Triangle mesh collision
+  if(!needsMeshCollision(bcs))return;
+  if(reuseMeshContact(bcs))return;
+
+  auto centerIn = bcs.center;
+  auto velocityIn = bcs.velocity;
+  auto res = vsBCS(bcs, bcs.velocity, deltaTime);
+  storeMeshContact(bcs, centerIn, velocityIn, res);
+  applyMeshCollision(bcs, res);
+}
+
+bool P64::Coll::Scene::reuseMeshContact(BCS &bcs)
+{
+  if(meshesChanged)return false;
+  auto it = meshContacts.find(&bcs);
+  if(it == meshContacts.end())return false;
+
+  auto &contact = it->second;
+  if(contact.frame + 1 != frameIdx || !isSameVec(bcs.center, contact.centerIn)
+    || !isSameVec(bcs.velocity, contact.velocityIn) || !isSameVec(bcs.halfExtend, contact.halfExtend)
+    || bcs.flags != contact.flags || bcs.maskRead != contact.maskRead
+  )return false;
+
+  bcs.center = contact.centerOut;
+  bcs.hitTriTypes |= contact.hitTriTypes;
+  contact.frame = frameIdx;
+  ++contactsReused;
+  applyMeshCollision(bcs, contact.res);
+  return true;
+}
+
+void P64::Coll::Scene::storeMeshContact(const BCS &bcs, const fm_vec3_t &centerIn, const fm_vec3_t &velocityIn, const CollInfo &res)
+{
+  // only resting contacts are worth keeping, anything in the air moves every frame
+  if(!res.collCount)return;
+  meshContacts[&bcs] = {
+    .centerIn = centerIn,
+    .velocityIn = velocityIn,
+    .halfExtend = bcs.halfExtend,
+    .centerOut = bcs.center,
+    .res = res,
+    .hitTriTypes = bcs.hitTriTypes,
+    .flags = bcs.flags,
+    .maskRead = bcs.maskRead,
+    .frame = frameIdx,
+  };
+}
+
+void P64::Coll::Scene::forgetContacts(const BCS *bcs)
+{
+  meshContacts.erase(bcs);
+  std::erase_if(pairContacts, [bcs](const auto &entry) {
+    return (entry.first >> 32) == (uintptr_t)bcs || (entry.first & 0xFFFF'FFFF) == (uintptr_t)bcs;
+  });
+}
+
+void P64::Coll::Scene::updateMeshCollisionRSP(float deltaTime)
+{
+  candidateTris.clear();
+  pendingBCS.clear();
+
+  auto ticksBvhStart = get_ticks();
+  for(auto bcs : collBCS) {
+    if(bcs->isSleeping() || !needsMeshCollision(*bcs))continue;
+    if(reuseMeshContact(*bcs))continue;
+    uint32_t candBegin = candidateTris.size();
+    pendingBCS.push_back({bcs, candBegin, candBegin, bcs->center, bcs->velocity});
+    collectCandidates(*bcs, bcs->velocity, deltaTime);
+    pendingBCS.back().candEnd = candidateTris.size();
+  }
 
-  for(auto &inst : meshes) {
-    inst->update();
+  packSphereTris();
+  RSPJobs::sync();
+
+  for(auto &pending : pendingBCS) {
+    auto res = resolveCandidates(*pending.bcs, pending.candBegin, pending.candEnd);
+    storeMeshContact(*pending.bcs, pending.centerIn, pending.velocityIn, res);
+    applyMeshCollision(*pending.bcs, res);
   }
+  ticksBVH += get_ticks() - ticksBvhStart;
+}
 
-  for(auto sp : collBCS) {
-    sp->hitTriTypes = 0;
+void P64::Coll::Scene::applyMeshCollision(BCS &bcs, const CollInfo &res)
+{
+  if(res.collCount)
+  {
+    bool hitFloor = bcs.hitTriTypes & TriType::FLOOR;
+    if(bcs.flags & BCSFlags::BOUNCY) {
+      //fm_vec3_t norm;
+      //t3d_vec3_norm(res.floorWallAngle);
+      bcs.velocity = bcs.velocity - res.floorWallAngle * 2.0f * t3d_vec3_dot(bcs.velocity, res.floorWallAngle);
+      bcs.velocity *= 0.8f;
+    } else if(hitFloor) {
+      if(bcs.velocity.y < 0) {
+        bcs.velocity.v[1] = 0.0f;
+      } else {
+        bcs.hitTriTypes &= ~TriType::FLOOR;
+      }
+    }
+
+    if(hasCollListener(bcs.obj) || hasCollListener(res.meshInstance->object)) {
+      P64::SceneManager::getCurrent().onObjectCollision({&bcs, nullptr, nullptr, res.meshInstance});
+    }
   }
+}
 
-  for(uint32_t s=0; s < collBCS.size(); ++s) {
-    auto &bcsA = collBCS[s];
+void P64::Coll::Scene::moveRiders(const MeshInstance &meshInst,
+  const fm_vec3_t &lastPos, const fm_vec3_t &lastScale, const fm_quat_t &lastRot)
+{
+  auto range = std::equal_range(riders.begin(), riders.end(), Rider{nullptr, &meshInst}, [](const Rider &a, const Rider &b) {
+    return a.meshInst < b.meshInst;
+  });
+  if(range.first == range.second)return;
+
+  // from world-space at the last transform to world-space at the new one, as a 3x3 matrix and offset.
+  // that is built once from the quaternions, so each rider only needs a matrix multiplication
+  auto invRot = Math::quatInvUnit(lastRot);
+  auto scaleRatio = meshInst.object->scale * fm_vec3_t{1.0f / lastScale.x, 1.0f / lastScale.y, 1.0f / lastScale.z};
+  auto delta = [&](const fm_vec3_t &p) {
+    return Math::quatRotate(meshInst.object->rot, Math::quatRotate(invRot, p) * scaleRatio);
+  };
 
-    // Static/Triangle mesh collision
-    bool checkColl = bcsA->isSolid() && !bcsA->isFixed();
+  auto offset = meshInst.object->pos - delta(lastPos);
+  auto axisX = delta({1.0f, 0.0f, 0.0f});
+  auto axisY = delta({0.0f, 1.0f, 0.0f});
+  auto axisZ = delta({0.0f, 0.0f, 1.0f});
 
-    // @TODO: use r/w mask
-    //bcsA->maskRead & Mask::TRI_MESH;
+  for(auto it = range.first; it != range.second; ++it) {
+    auto &center = it->bcs->center;
+    center = axisX * center.x + axisY * center.y + axisZ * center.z + offset;
+  }
+}
 
-    if(checkColl) {
-      auto res = vsBCS(*bcsA, bcsA->velocity, deltaTime);
-      if(res.collCount)
-      {
-        bool hitFloor = bcsA->hitTriTypes & TriType::FLOOR;
-        if(bcsA->flags & BCSFlags::BOUNCY) {
-          //fm_vec3_t norm;
-          //t3d_vec3_norm(res.floorWallAngle);
-          bcsA->velocity = bcsA->velocity - res.floorWallAngle * 2.0f * t3d_vec3_dot(bcsA->velocity, res.floorWallAngle);
-          bcsA->velocity *= 0.8f;
-        } else if(hitFloor) {
-          if(bcsA->velocity.y < 0) {
-            bcsA->velocity.v[1] = 0.0f;
-          } else {
-            bcsA->hitTriTypes &= ~TriType::FLOOR;
-          }
-        }
+void P64::Coll::Scene::updateSleepState(BCS &bcs, bool beforeUpdate)
+{
+  float vel2 = t3d_vec3_len2(&bcs.velocity);
+  bool isStill = vel2 < (sleepVelocity * sleepVelocity);
+
+  if(beforeUpdate) {
+    if(!bcs.isSleeping())return;
+    if(isStill && memcmp(&bcs.center, &bcs.sleepCenter, sizeof(bcs.center)) == 0) {
+      bcs.velocity = {};
+    } else {
+      bcs.wake();
+    }
+    return;
+  }
 
-        // @TODO: don't do if object has no callback
-        gameScene.onObjectCollision({bcsA, nullptr, nullptr, res.meshInstance});
-      }
+  if(bcs.isSleeping())return;
+  if(!isStill) {
+    bcs.sleepFrames = 0;
+    return;
+  }
+
+  if(++bcs.sleepFrames == BCS::SLEEP_FRAME_COUNT) {
+    bcs.sleepCenter = bcs.center;
+    bcs.velocity = {};
+  }
+}
+
+void P64::Coll::Scene::testPair(BCS &bcsA, BCS &bcsB)
+{
+  // two sleeping bodies can't have started to touch since they fell asleep
+  if(bcsA.isSleeping() && bcsB.isSleeping())return;
+
+  bool maskMatchA = bcsA.maskRead & bcsB.maskWrite;
+  bool maskMatchB = bcsB.maskRead & bcsA.maskWrite;
+  if(!maskMatchA && !maskMatchB)return;
+  ++pairCountBroad;
+
+  // pairs are always in registration order, so the key is unique
+  uint64_t key = ((uint64_t)(uintptr_t)&bcsA << 32) | (uintptr_t)&bcsB;
+  auto cached = pairContacts.find(key);
+  bool isCached = cached != pairContacts.end() && cached->second.frame + 1 == frameIdx;
+
+  bool isColl = false;
+  if(isCached && isSamePairInput(cached->second, bcsA, bcsB))
+  {
+    // resting contact, same as last frame
+    auto &contact = cached->second;
+    bcsA.center = contact.centerOutA;
+    bcsB.center = contact.centerOutB;
+    bcsA.hitTriTypes |= contact.hitTriTypesA;
+    bcsB.hitTriTypes |= contact.hitTriTypesB;
+    if(contact.hitTriTypesA & TriType::FLOOR)bcsA.velocity.v[1] = 0.0f;
+    contact.frame = frameIdx;
+    ++contactsReused;
+    isColl = true;
+  } else {
+    bool isBoxA = bcsA.flags & BCSFlags::SHAPE_BOX;
+    bool isBoxB = bcsB.flags & BCSFlags::SHAPE_BOX;
+
+    PairContact contact{
+      .centerInA = bcsA.center,
+      .centerInB = bcsB.center,
+      .halfExtendA = bcsA.halfExtend,
+      .halfExtendB = bcsB.halfExtend,
+      .boxAxis = isCached ? cached->second.boxAxis : (uint8_t)0xFF,
+      .flagsA = bcsA.flags,
+      .flagsB = bcsB.flags,
+    };
+
+    // types are collected separately, to know which ones this pair sets
+    uint8_t hitTriTypesA = bcsA.hitTriTypes;
+    uint8_t hitTriTypesB = bcsB.hitTriTypes;
+    bcsA.hitTriTypes = 0;
+    bcsB.hitTriTypes = 0;
+
+    if(!isBoxA && !isBoxB) {
+      isColl = sphereVsSphere(bcsA, bcsB);
+    } else if(isBoxA && !isBoxB) {
+      isColl = sphereVsBox(bcsB, bcsA);
+    } else if(!isBoxA && isBoxB) {
+      isColl = sphereVsBox(bcsA, bcsB);
+    } else {
+      isColl = boxVsBox(bcsA, bcsB, &contact.boxAxis);
+    }
+
+    contact.hitTriTypesA = bcsA.hitTriTypes;
+    contact.hitTriTypesB = bcsB.hitTriTypes;
+    bcsA.hitTriTypes |= hitTriTypesA;
+    bcsB.hitTriTypes |= hitTriTypesB;
+
+    if(isColl) {
+      contact.centerOutA = bcsA.center;
+      contact.centerOutB = bcsB.center;
+      contact.frame = frameIdx;
+      pairContacts[key] = contact;
     }
+  }
 
-    // Dynamic Colliders
-    for(uint32_t s2=s+1; s2 < collBCS.size(); ++s2)
+  if(isColl) {
+    bcsA.wake();
+    bcsB.wake();
+    if(hasCollListener(bcsA.obj) || hasCollListener(bcsB.obj)) {
+      P64::SceneManager::getCurrent().onObjectCollision({&bcsA, &bcsB});
+    }
+  }
+}
+
+void P64::Coll::Scene::updateBroadphase()
+{
+  uint32_t count = collBCS.size();
+  pairCount = count > 1 ? (count * (count-1) / 2) : 0;
+  pairCountBroad = 0;
+
+  // re-use last frames order if nothing was added/removed, since objects barely move
+  // between frames, the insertion sort below will then be close to linear
+  if(sweepDirty) {
+    sweepList.resize(count);
+    for(uint32_t i=0; i<count; ++i)sweepList[i].index = i;
+    sweepDirty = false;
+  }
+
+  for(auto &entry : sweepList) {
+    auto &bcs = *collBCS[entry.index];
+    float extend = (bcs.flags & BCSFlags::SHAPE_BOX) ? bcs.halfExtend.x : fmaxf(bcs.halfExtend.x, bcs.halfExtend.y);
+    entry.min = bcs.center.x - extend;
+    entry.max = bcs.center.x + extend;
+  }
+
+  Lib::insertionSort(sweepList.data(), count, [](const SweepEntry &a, const SweepEntry &b) {
+    return a.min < b.min;
+  });
+
+  for(uint32_t i=0; i<count; ++i)
+  {
+    auto &entryA = sweepList[i];
+    for(uint32_t j=i+1; j<count && sweepList[j].min <= entryA.max; ++j)
     {
-      bool maskMatchA = bcsA->maskRead & collBCS[s2]->maskWrite;
-      bool maskMatchB = collBCS[s2]->maskRead & bcsA->maskWrite;
-      if(!maskMatchA && !maskMatchB)continue;
+      // keep registration order for the pair, resolving is not symmetric
+      uint32_t idxA = entryA.index;
+      uint32_t idxB = sweepList[j].index;
+      if(idxA > idxB)std::swap(idxA, idxB);
+      testPair(*collBCS[idxA], *collBCS[idxB]);
+    }
+  }
+}
 
-      auto bcsB = collBCS[s2];
+void P64::Coll::Scene::update(float deltaTime)
+{
+  uint64_t ticksStart = get_ticks();
 
-      bool isBoxA = bcsA->flags & BCSFlags::SHAPE_BOX;
-      bool isBoxB = bcsB->flags & BCSFlags::SHAPE_BOX;
+  ++frameIdx;
+  contactsReused = 0;
+
+  // riders are grouped by mesh, each moving mesh then moves all of its riders once its transform is updated
+  std::sort(riders.begin(), riders.end(), [](const Rider &a, const Rider &b) {
+    return a.meshInst < b.meshInst;
+  });
+
+  // collision layers can be changed at any time, so they are part of the mesh state too
+  uint32_t maskHash = meshes.size();
+  for(auto inst : meshes) {
+    maskHash = maskHash * 31 + inst->maskWrite;
+    if(inst->isStatic)continue;
+
+    auto lastPos = inst->lastPos;
+    auto lastScale = inst->lastScale;
+    auto lastRot = inst->lastRot;
+    if(inst->update()) {
+      meshesChanged = true;
+      moveRiders(*inst, lastPos, lastScale, lastRot);
+    }
+  }
+  riders.clear();
+  if(maskHash != meshMaskHash) {
+    meshMaskHash = maskHash;
+    meshesChanged = true;
+  }
 
-      bool isColl = false;
+  bcsActive = 0;
+  bcsSleeping = 0;
 
-      if(!isBoxA && !isBoxB) {
-        isColl = sphereVsSphere(*bcsA, *bcsB);
-      } else if(isBoxA && !isBoxB) {
-        isColl = sphereVsBox(*bcsB, *bcsA);
-      } else if(!isBoxA && isBoxB) {
-        isColl = sphereVsBox(*bcsA, *bcsB);
-      } else {
-        isColl = boxVsBox(*bcsA, *bcsB);
-      }
+  for(auto bcs : collBCS) {
+    if(!bcs->isSolid() || bcs->isFixed())continue;
+    updateSleepState(*bcs, true);
+  }
 
-      if(isColl) {
-        // @TODO: don't do if object has no callback
-        gameScene.onObjectCollision({bcsA, bcsB});
-      }
+  // sleeping bodies keep the triangle types of the last check, so they still report being on a floor
+  for(auto sp : collBCS) {
+    if(!sp->isSleeping())sp->hitTriTypes = 0;
+  }
+
+  for(auto bcs : collBCS) {
+    if(bcs->isSleeping()) {
+      ++bcsSleeping;
+      continue;
     }
+    if(!rspNarrowphase)updateMeshCollision(*bcs, deltaTime);
+  }
+  if(rspNarrowphase) {
+    updateMeshCollisionRSP(deltaTime);
+  } else {
+    rspTriCount = 0;
+  }
 
-    if(bcsA->isSolid()) {
-      bcsA->obj->pos = bcsA->center - bcsA->parentOffset;
+  // Dynamic Colliders
+  updateBroadphase();
+
+  for(auto bcs : collBCS) {
+    if(bcs->isSolid() && !bcs->isSleeping()) {
+      bcs->obj->pos = bcs->center - bcs->parentOffset;
+      if(!bcs->isFixed()) {
+        ++bcsActive;
+        updateSleepState(*bcs, false);
+      }
     }
   }
+
+  // anything not touched this frame can't be re-used in the next one
+  if(meshesChanged) {
+    meshContacts.clear();
+    meshesChanged = false;
+  } else {
+    std::erase_if(meshContacts, [this](const auto &entry) { return entry.second.frame != frameIdx; });
+  }
+  std::erase_if(pairContacts, [this](const auto &entry) { return entry.second.frame != frameIdx; });
+
   ticks += get_ticks() - ticksStart;
 }
 
 P64::Coll::RaycastRes P64::Coll::Scene::raycast(const fm_vec3_t &pos, const fm_vec3_t &dir) {
-  ++raycastCount;
-  P64::Coll::RaycastRes res{};
+  Ray ray{pos, dir};
+  RaycastRes res{};
+  raycast(&ray, &res, 1);
+  return res;
+}
+
+void P64::Coll::Scene::raycast(const Ray *rays, RaycastRes *results, uint32_t count)
+{
+  raycastCount += count;
+  for(uint32_t i=0; i<count; i += BVH::RAY_PACKET_SIZE) {
+    raycastPacket(rays + i, results + i, Math::min(count - i, (uint32_t)BVH::RAY_PACKET_SIZE));
+  }
+}
+
+void P64::Coll::Scene::raycastPacket(const Ray *rays, RaycastRes *results, uint32_t count)
+{
+  Ray raysLocal[BVH::RAY_PACKET_SIZE];
+  float highestFloor[BVH::RAY_PACKET_SIZE];
+
+  for(uint32_t i=0; i<count; ++i) {
+    results[i] = {};
+    highestFloor[i] = -99999.0f;
+  }
 
-  float highestFloor = -99999.0f;
   for(auto meshInst : meshes)
   {
     auto &mesh = *meshInst->mesh;
-    auto posLocal = meshInst->intoLocalSpace(pos);
-    auto dirLocal = meshInst->invRot * dir;
-
-    P64::Coll::IVec3 posInt = {
-      .v = {
-        (int16_t)(posLocal.v[0]),
-        (int16_t)(posLocal.v[1]),
-        (int16_t)(posLocal.v[2])
-      }
-    };
-
-    P64::Coll::BVHResult bvhRes{};
+    for(uint32_t i=0; i<count; ++i) {
+      raysLocal[i] = {
+        meshInst->intoLocalSpace(rays[i].pos),
+        meshInst->isBaked ? rays[i].dir : Math::quatRotate(meshInst->invRot, rays[i].dir)
+      };
+    }
 
     //Debug::drawLine(meshInst->outOfLocalSpace(posLocal), meshInst->outOfLocalSpace(posLocal + dirLocal * 100.0f), color_t{0xFF,0x00,0xFF,0xFF});
 
-    mesh.bvh->raycast(posLocal, dirLocal, bvhRes);
-
-    for(int b=0; b<bvhRes.count; ++b) {
-      uint32_t t = bvhRes.triIndex[b];
-    //for(uint32_t b=0; b<mesh.triCount; ++b) {
-      //uint32_t t = b;
-
-      int idxA = mesh.indices[t*3];
-      int idxB = mesh.indices[t*3+1];
-      int idxC = mesh.indices[t*3+2];
-      auto &norm = mesh.normals[t];
-
-      Triangle tri{
-        .normal = {{
-         (float)norm.v[0] * (1.0f/32767.0f),
-         (float)norm.v[1] * (1.0f/32767.0f),
-         (float)norm.v[2] * (1.0f/32767.0f)
-        }},
-        .v = {&mesh.verts[idxA], &mesh.verts[idxB], &mesh.verts[idxC]}
-      };
-
-      auto collInfo = mesh.vsRay(posLocal, dirLocal, tri);
-      if(collInfo.hasResult())
+    // triangles are decoded once and then tested against all rays of the packet that reached them
+    mesh.bvh->queryRays(raysLocal, count, [&](int16_t t, uint32_t rayMask)
+    {
+      auto tri = mesh.getTriangle(t);
+      while(rayMask)
       {
-        res.flags |= collInfo.flags;
-        res.hitPos = meshInst->outOfLocalSpace(collInfo.hitPos);
-        //if(res.hitPos.v[1] > highestFloor)
+        uint32_t i = __builtin_ctz(rayMask);
+        rayMask &= rayMask - 1;
+
+        auto collInfo = mesh.vsRay(raysLocal[i].pos, raysLocal[i].dir, tri);
+        if(collInfo.hasResult())
         {
-          res.normal = meshInst->object->rot * collInfo.normal;
-          highestFloor = res.hitPos.v[1];
+          auto &res = results[i];
+          res.flags |= collInfo.flags;
+          res.hitPos = meshInst->outOfLocalSpace(collInfo.hitPos);
+          //if(res.hitPos.v[1] > highestFloor)
+          {
+            res.normal = meshInst->isBaked ? collInfo.normal : Math::quatRotate(meshInst->object->rot, collInfo.normal);
+            highestFloor[i] = res.hitPos.v[1];
+          }
         }
       }
-    }
+    });
   }
 
   // check dynamic colliders (boxes only)
   for(auto sphere : collBCS) {
-    if(sphere->flags & BCSFlags::SHAPE_BOX) {
+    if(!(sphere->flags & BCSFlags::SHAPE_BOX))continue;
+
+    auto aabbMin = sphere->getMinAABB();
+    auto aabbMax = sphere->getMaxAABB();
+    float localHeight = sphere->center.v[1] + sphere->halfExtend.v[1];
+
+    for(uint32_t i=0; i<count; ++i) {
+      const auto &pos = rays[i].pos;
       // inside 2D rect (top-down)
-      if(pos.v[0] >= sphere->getMinAABB().v[0] && pos.v[0] <= sphere->getMaxAABB().v[0] &&
-         pos.v[2] >= sphere->getMinAABB().v[2] && pos.v[2] <= sphere->getMaxAABB().v[2])
+      if(pos.v[0] >= aabbMin.v[0] && pos.v[0] <= aabbMax.v[0] &&
+         pos.v[2] >= aabbMin.v[2] && pos.v[2] <= aabbMax.v[2])
       {
-        float localHeight = sphere->center.v[1] + sphere->halfExtend.v[1];
-        if(localHeight > highestFloor && pos.y > localHeight) {
-          highestFloor = localHeight;
-          res.hitPos = {pos.v[0], localHeight, pos.v[2]};
-          res.normal = {0.0f, 1.0f, 0.0f};
+        if(localHeight > highestFloor[i] && pos.y > localHeight) {
+          highestFloor[i] = localHeight;
+          results[i].hitPos = {pos.v[0], localHeight, pos.v[2]};
+          results[i].normal = {0.0f, 1.0f, 0.0f};
         }
       }
     }
   }
-
-  return res;
 }
 
 void P64::Coll::Scene::debugDraw(bool showMesh, bool showSpheres)
 {
+  showMesh = showMesh && Debug::isCategoryEnabled(Debug::Category::COLL_MESH);
+  showSpheres = showSpheres && Debug::isCategoryEnabled(Debug::Category::COLL_BCS);
+
   if(showMesh) {
     for(const auto &meshInst : meshes) {
       auto &mesh = *meshInst->mesh;
       for(uint32_t t=0; t<mesh.triCount; ++t) {
-        int idxA = mesh.indices[t*3];
-        int idxB = mesh.indices[t*3+1];
-        int idxC = mesh.indices[t*3+2];
-        auto v0 = (mesh.verts[idxA] * meshInst->object->scale + meshInst->object->pos);
-        auto v1 = (mesh.verts[idxB] * meshInst->object->scale + meshInst->object->pos);
-        auto v2 = (mesh.verts[idxC] * meshInst->object->scale + meshInst->object->pos);
-
         if(mesh.normals[t].v[2] < 0)continue;
+
+        fm_vec3_t v[3] {
+          mesh.getVert(mesh.indices[t*3]),
+          mesh.getVert(mesh.indices[t*3+1]),
+          mesh.getVert(mesh.indices[t*3+2]),
+        };
+        if(!meshInst->isBaked) {
+          Math::outOfLocalSpace(meshInst->object->rot, meshInst->object->scale, meshInst->object->pos, v, v, 3);
+        }
         auto color = isFloor(mesh.normals[t])
           ? color_t{0x00, 0xAA, 0xEE, 0xFF}
           : color_t{0x00, 0xEE, 0x42, 0xFF};
 
-        Debug::drawLine(v0, v1, color);
-        Debug::drawLine(v1, v2, color);
-        Debug::drawLine(v2, v0, color);
+        Debug::drawTriangle(v[0], v[1], v[2], color, Debug::Category::COLL_MESH);
       }
     }
   }
@@ -333,9 +867,9 @@ void P64::Coll::Scene::debugDraw(bool showMesh, bool showSpheres)
       }
 
       if(sphere->flags & BCSFlags::SHAPE_BOX) {
-        Debug::drawAABB(sphere->center, sphere->halfExtend, col);
+        Debug::drawAABB(sphere->center, sphere->halfExtend, col, Debug::Category::COLL_BCS);
       } else {
-        Debug::drawSphere(sphere->center, sphere->halfExtend.y, col);
+        Debug::drawSphere(sphere->center, sphere->halfExtend.y, col, Debug::Category::COLL_BCS);
       }
     }
   }
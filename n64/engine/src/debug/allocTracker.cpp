@@ -0,0 +1,152 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "debug/allocTracker.h"
+
+#if P64_ALLOC_TRACK
+#include <malloc.h>
+#include <algorithm>
+
+extern "C" {
+  void* __real_malloc(size_t size);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void* ptr, size_t size);
+  void* __real_memalign(size_t align, size_t size);
+  void __real_free(void* ptr);
+}
+
+namespace
+{
+  using namespace Debug::AllocTracker;
+  constexpr uint32_t ZONE_COUNT = (uint32_t)Zone::COUNT;
+
+  constinit Stats frameStats[ZONE_COUNT]{};
+  constinit Stats lastStats[ZONE_COUNT]{};
+  constinit Zone zoneStack[MAX_ZONE_DEPTH]{};
+  constinit uint32_t zoneDepth{0};
+  constinit uint32_t ignoreDepth{0};
+  constinit uint32_t graceFrames{0};
+  constinit bool strictRequested{false};
+  constinit bool strict{false};
+
+  Stats& getCurrent() {
+    uint32_t idx = zoneDepth == 0 ? 0 : (uint32_t)zoneStack[std::min(zoneDepth, MAX_ZONE_DEPTH) - 1];
+    return frameStats[idx];
+  }
+
+  void onAlloc(void* ptr, uint32_t size, void* caller)
+  {
+    if(!ptr)return;
+    auto &stats = getCurrent();
+    ++stats.allocs;
+    stats.bytes += size;
+
+    if(strict && ignoreDepth == 0) {
+      strict = false; // the assert itself may allocate
+      uint32_t idx = (uint32_t)(&stats - frameStats);
+      assertf(false, "Heap allocation during gameplay (FLAG_NO_ALLOC)\n%lu bytes in zone '%s', called from %p",
+        size, Debug::Trace::ZONE_NAMES[idx], caller);
+    }
+  }
+
+  void onFree(void* ptr) {
+    if(ptr)++getCurrent().frees;
+  }
+}
+
+extern "C"
+{
+  void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    onAlloc(ptr, size, __builtin_return_address(0));
+    return ptr;
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    void* ptr = __real_calloc(count, size);
+    onAlloc(ptr, count * size, __builtin_return_address(0));
+    return ptr;
+  }
+
+  // growing in-place still counts, since there is no way to tell from the outside
+  void* __wrap_realloc(void* ptr, size_t size) {
+    if(!ptr) {
+      ptr = __real_realloc(ptr, size);
+      onAlloc(ptr, size, __builtin_return_address(0));
+      return ptr;
+    }
+    void* newPtr = __real_realloc(ptr, size);
+    if(size == 0) {
+      onFree(ptr);
+    } else {
+      onAlloc(newPtr, size, __builtin_return_address(0));
+      if(newPtr)onFree(ptr);
+    }
+    return newPtr;
+  }
+
+  void* __wrap_memalign(size_t align, size_t size) {
+    void* ptr = __real_memalign(align, size);
+    onAlloc(ptr, size, __builtin_return_address(0));
+    return ptr;
+  }
+
+  void __wrap_free(void* ptr) {
+    onFree(ptr);
+    __real_free(ptr);
+  }
+}
+
+void Debug::AllocTracker::begin(Zone zone)
+{
+  if(zoneDepth < MAX_ZONE_DEPTH)zoneStack[zoneDepth] = zone;
+  ++zoneDepth;
+}
+
+void Debug::AllocTracker::end()
+{
+  if(zoneDepth)--zoneDepth;
+}
+
+void Debug::AllocTracker::frame()
+{
+  for(uint32_t i=0; i<ZONE_COUNT; ++i) {
+    lastStats[i] = frameStats[i];
+    frameStats[i] = {};
+  }
+
+  if(graceFrames) {
+    --graceFrames;
+  } else {
+    strict = strictRequested;
+  }
+}
+
+void Debug::AllocTracker::setStrict(bool enable)
+{
+  strictRequested = enable;
+  strict = false;
+  graceFrames = STRICT_GRACE_FRAMES;
+}
+
+const Debug::AllocTracker::Stats& Debug::AllocTracker::getFrameStats(Zone zone)
+{
+  return lastStats[(uint32_t)zone];
+}
+
+Debug::AllocTracker::Stats Debug::AllocTracker::getFrameTotal()
+{
+  Stats res{};
+  for(auto &stats : lastStats) {
+    res.allocs += stats.allocs;
+    res.frees += stats.frees;
+    res.bytes += stats.bytes;
+  }
+  return res;
+}
+
+Debug::AllocTracker::ScopedIgnore::ScopedIgnore() { ++ignoreDepth; }
+Debug::AllocTracker::ScopedIgnore::~ScopedIgnore() { --ignoreDepth; }
+
+#endif
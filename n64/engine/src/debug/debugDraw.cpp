@@ -4,144 +4,191 @@
 */
 #include "debug/debugDraw.h"
 #include <t3d/t3d.h>
-#include <vector>
+#include <malloc.h>
 
 namespace
 {
-  constexpr uint32_t MAX_LINE_COUNT = 2048;
+  constexpr uint32_t MAX_VERT_COUNT = 4096;
+  constexpr uint32_t MAX_LINE_COUNT = 4096;
+
+  // all primitives of a frame share one vertex buffer, so corners are only projected once
+  struct Vertex {
+    fm_vec3_t pos{};
+    color_t color{};
+  };
   struct Line {
-    fm_vec3_t a{};
-    fm_vec3_t b{};
-    uint16_t color;
-    uint16_t _padding;
+    uint16_t a;
+    uint16_t b;
   };
 
-  std::vector<Line> lines{};
+  constinit Vertex *verts{nullptr};
+  constinit Line *lines{nullptr};
+  constinit uint32_t vertCount{0};
+  constinit uint32_t lineCount{0};
+  constinit uint32_t lineBudget{MAX_LINE_COUNT};
+  constinit uint32_t categoryMask{Debug::Category::ALL};
+
+  constinit uint32_t linesDropped{0};
+  // stats of the last draw
+  constinit uint32_t lastDrawn{0};
+  constinit uint32_t lastDropped{0};
 
   sprite_t *font{};
 
-  void debugDrawLine(surface_t *fb, int px0, int py0, int px1, int py1, uint16_t color)
+  /**
+   * Reserves vertices and lines for a primitive, returns the index of the first vertex.
+   * Returns -1 (and counts it as dropped) if either buffer or the budget is exceeded.
+   */
+  int32_t reserve(uint32_t category, uint32_t numVerts, uint32_t numLines)
   {
-    int width = fb->width;
-    int height = fb->height;
-    if((px0 > width + 200) || (px1 > width + 200) ||
-       (py0 > height + 200) || (py1 > height + 200)) {
-      return;
+    if(!(categoryMask & category))return -1;
+    if(!verts || vertCount + numVerts > MAX_VERT_COUNT || lineCount + numLines > lineBudget) {
+      linesDropped += numLines;
+      return -1;
     }
+    int32_t idx = vertCount;
+    vertCount += numVerts;
+    return idx;
+  }
 
-    float pos[2]{(float)px0, (float)py0};
-    int dx = px1 - px0;
-    int dy = py1 - py0;
-    int steps = abs(dx) > abs(dy) ? abs(dx) : abs(dy);
-    if(steps <= 0 || steps > 1000)return;
-    float xInc = dx / (float)steps;
-    float yInc = dy / (float)steps;
+  inline void addLine(uint32_t a, uint32_t b) {
+    lines[lineCount++] = {(uint16_t)a, (uint16_t)b};
+  }
 
-    if(surface_get_format(fb) == FMT_RGBA16)
-    {
-      uint16_t *buff = (uint16_t*)fb->buffer;
-      for(int i=0; i<steps; ++i)
-      {
-        if((i%3 != 0) && pos[1] >= 0 && pos[1] < height && pos[0] >= 0 && pos[0] < width) {
-          buff[(int)pos[1] * width + (int)pos[0]] = color;
-        }
-        pos[0] += xInc;
-        pos[1] += yInc;
-      }
-    } else
-    {
-      uint32_t col32 = color_to_packed32(color_from_packed16(color));
-      uint32_t *buff = (uint32_t*)fb->buffer;
-      for(int i=0; i<steps; ++i)
-      {
-        if((i%3 != 0) && pos[1] >= 0 && pos[1] < height && pos[0] >= 0 && pos[0] < width) {
-          buff[(int)pos[1] * width + (int)pos[0]] = col32;
-        }
-        pos[0] += xInc;
-        pos[1] += yInc;
-      }
-    }
+  inline void setShade(float* v, color_t color) {
+    v[2] = color.r * (1.0f / 255.0f);
+    v[3] = color.g * (1.0f / 255.0f);
+    v[4] = color.b * (1.0f / 255.0f);
+    v[5] = 1.0f;
   }
 }
 
 void Debug::init() {
   font = sprite_load("rom:/p64/font.ia4.sprite");
-  lines = {};
+  verts = (Vertex*)malloc(sizeof(Vertex) * MAX_VERT_COUNT);
+  lines = (Line*)malloc(sizeof(Line) * MAX_LINE_COUNT);
+  vertCount = 0;
+  lineCount = 0;
 }
 
 void Debug::destroy() {
-  lines = {};
+  free(verts);
+  free(lines);
+  verts = nullptr;
+  lines = nullptr;
+  vertCount = 0;
+  lineCount = 0;
   sprite_free(font);
 }
 
-void Debug::drawLine(const fm_vec3_t &a, const fm_vec3_t &b, color_t color) {
-  if(lines.size() > MAX_LINE_COUNT)return;
-  lines.push_back({a, b, color_to_packed16(color), 0});
+void Debug::setCategoryMask(uint32_t mask) { categoryMask = mask; }
+uint32_t Debug::getCategoryMask() { return categoryMask; }
+
+void Debug::setLineBudget(uint32_t maxLines) {
+  lineBudget = maxLines < MAX_LINE_COUNT ? maxLines : MAX_LINE_COUNT;
 }
 
-void Debug::drawSphere(const fm_vec3_t &center, float radius, color_t color) {
+uint32_t Debug::getLineCount() { return lastDrawn; }
+uint32_t Debug::getDroppedCount() { return lastDropped; }
 
-  int steps = 12;
-  float step = 2.0f * (float)M_PI / steps;
-  fm_vec3_t last = center + fm_vec3_t{radius, 0, 0};
-  for(int i=1; i<=steps; ++i) {
-    float angle = i * step;
-    fm_vec3_t next = center + fm_vec3_t{radius * fm_cosf(angle), 0, radius * fm_sinf(angle)};
-    drawLine(last, next, color);
-    last = next;
-  }
-  last = center + fm_vec3_t{0, radius, 0};
-  for(int i=1; i<=steps; ++i) {
-    float angle = i * step;
-    fm_vec3_t next = center + fm_vec3_t{0, radius * fm_cosf(angle), radius * fm_sinf(angle)};
-    drawLine(last, next, color);
-    last = next;
+void Debug::drawLine(const fm_vec3_t &a, const fm_vec3_t &b, color_t color, uint32_t category) {
+  int32_t idx = reserve(category, 2, 1);
+  if(idx < 0)return;
+  verts[idx] = {a, color};
+  verts[idx+1] = {b, color};
+  addLine(idx, idx+1);
+}
+
+void Debug::drawTriangle(const fm_vec3_t &a, const fm_vec3_t &b, const fm_vec3_t &c, color_t color, uint32_t category) {
+  int32_t idx = reserve(category, 3, 3);
+  if(idx < 0)return;
+  verts[idx] = {a, color};
+  verts[idx+1] = {b, color};
+  verts[idx+2] = {c, color};
+  addLine(idx, idx+1);
+  addLine(idx+1, idx+2);
+  addLine(idx+2, idx);
+}
+
+void Debug::drawSphere(const fm_vec3_t &center, float radius, color_t color, uint32_t category) {
+  constexpr int STEPS = 12;
+  int32_t idx = reserve(category, STEPS * 3, STEPS * 3);
+  if(idx < 0)return;
+
+  float step = 2.0f * (float)M_PI / STEPS;
+  for(int i=0; i<STEPS; ++i) {
+    float s = radius * fm_sinf(i * step);
+    float c = radius * fm_cosf(i * step);
+    // one circle per plane (XZ, YZ, XY)
+    verts[idx + i]           = {center + fm_vec3_t{c, 0, s}, color};
+    verts[idx + STEPS + i]   = {center + fm_vec3_t{0, c, s}, color};
+    verts[idx + STEPS*2 + i] = {center + fm_vec3_t{s, c, 0}, color};
   }
-  last = center + fm_vec3_t{0, 0, radius};
-  for(int i=1; i<=steps; ++i) {
-    float angle = i * step;
-    fm_vec3_t next = center + fm_vec3_t{radius * fm_cosf(angle), radius * fm_sinf(angle), 0};
-    drawLine(last, next, color);
-    last = next;
+  for(int r=0; r<3; ++r) {
+    uint32_t base = idx + r * STEPS;
+    for(int i=0; i<STEPS; ++i)addLine(base + i, base + ((i+1) % STEPS));
   }
 }
 
-void Debug::draw(surface_t *fb) {
-  if(lines.empty())return;
-
-  debugf("Drawing %u lines\n", lines.size());
-  rspq_wait();
+void Debug::draw() {
+  lastDrawn = 0;
+  lastDropped = linesDropped;
+  linesDropped = 0;
+  if(lineCount == 0) {
+    vertCount = 0;
+    return;
+  }
 
   auto vp = t3d_viewport_get();
   float maxX = vp->size[0];
   float maxY = vp->size[1];
-  for(auto &line : lines) {
-    t3d_viewport_calc_viewspace_pos(nullptr, &line.a, &line.a);
-    t3d_viewport_calc_viewspace_pos(nullptr, &line.b, &line.b);
-
-    if(line.a.z > 1)continue;
-    if(line.b.z > 1)continue;
-
-    if(line.a.x < 0 && line.b.x < 0)continue;
-    if(line.a.y < 0 && line.b.y < 0)continue;
-    if(line.a.x > maxX && line.b.x > maxX)continue;
-    if(line.a.y > maxY && line.b.y > maxY)continue;
-    debugDrawLine(fb, line.a.x, line.a.y, line.b.x, line.b.y, line.color);
+
+  for(uint32_t i=0; i<vertCount; ++i) {
+    t3d_viewport_calc_viewspace_pos(nullptr, &verts[i].pos, &verts[i].pos);
+  }
+
+  rdpq_sync_pipe();
+  rdpq_set_mode_standard();
+  rdpq_mode_combiner(RDPQ_COMBINER_SHADE);
+
+  for(uint32_t i=0; i<lineCount; ++i) {
+    auto &va = verts[lines[i].a];
+    auto &vb = verts[lines[i].b];
+    auto &a = va.pos;
+    auto &b = vb.pos;
+
+    if(a.z > 1 || b.z > 1)continue;
+    if(a.x < 0 && b.x < 0)continue;
+    if(a.y < 0 && b.y < 0)continue;
+    if(a.x > maxX && b.x > maxX)continue;
+    if(a.y > maxY && b.y > maxY)continue;
+
+    float dx = b.x - a.x;
+    float dy = b.y - a.y;
+    float len2 = dx*dx + dy*dy;
+    if(len2 < 0.01f)continue;
+
+    // one pixel wide quad along the line
+    float scale = 0.5f / sqrtf(len2);
+    float nx = -dy * scale;
+    float ny = dx * scale;
+
+    float v0[6]{a.x + nx, a.y + ny};
+    float v1[6]{a.x - nx, a.y - ny};
+    float v2[6]{b.x + nx, b.y + ny};
+    float v3[6]{b.x - nx, b.y - ny};
+    setShade(v0, va.color);
+    setShade(v1, va.color);
+    setShade(v2, vb.color);
+    setShade(v3, vb.color);
+
+    rdpq_triangle(&TRIFMT_SHADE, v0, v1, v2);
+    rdpq_triangle(&TRIFMT_SHADE, v1, v3, v2);
+    ++lastDrawn;
   }
 
-  /*for(auto &rect : rects) {
-    if(rect.min[0] < 0 || rect.min[1] < 0)continue;
-    if(rect.max[0] > maxX || rect.max[1] > maxY)continue;
-    debugDrawLine(fb, rect.min[0], rect.min[1], rect.max[0], rect.min[1], 0xF000);
-    debugDrawLine(fb, rect.min[0], rect.min[1], rect.min[0], rect.max[1], 0xF000);
-    debugDrawLine(fb, rect.max[0], rect.min[1], rect.max[0], rect.max[1], 0xF000);
-    debugDrawLine(fb, rect.min[0], rect.max[1], rect.max[0], rect.max[1], 0xF000);
-  }*/
-
-  lines.clear();
-  lines.shrink_to_fit();
-  //rects.clear();
-  //rects.shrink_to_fit();
+  vertCount = 0;
+  lineCount = 0;
 }
 
 void Debug::printStart() {
@@ -187,20 +234,20 @@ float Debug::printf(float x, float y, const char *fmt, ...) {
   return Debug::print(x, y, buffer);
 }
 
-void Debug::drawAABB(const fm_vec3_t &p, const fm_vec3_t &halfExtend, color_t color) {
+void Debug::drawAABB(const fm_vec3_t &p, const fm_vec3_t &halfExtend, color_t color, uint32_t category) {
+  int32_t idx = reserve(category, 8, 12);
+  if(idx < 0)return;
+
   fm_vec3_t a = p - halfExtend;
   fm_vec3_t b = p + halfExtend;
-  // draw all 12 edges
-  drawLine(a, fm_vec3_t{b.x, a.y, a.z}, color);
-  drawLine(a, fm_vec3_t{a.x, b.y, a.z}, color);
-  drawLine(a, fm_vec3_t{a.x, a.y, b.z}, color);
-  drawLine(fm_vec3_t{b.x, a.y, a.z}, fm_vec3_t{b.x, b.y, a.z}, color);
-  drawLine(fm_vec3_t{b.x, a.y, a.z}, fm_vec3_t{b.x, a.y, b.z}, color);
-  drawLine(fm_vec3_t{a.x, b.y, a.z}, fm_vec3_t{b.x, b.y, a.z}, color);
-  drawLine(fm_vec3_t{a.x, b.y, a.z}, fm_vec3_t{a.x, b.y, b.z}, color);
-  drawLine(fm_vec3_t{a.x, a.y, b.z}, fm_vec3_t{b.x, a.y, b.z}, color);
-  drawLine(fm_vec3_t{a.x, a.y, b.z}, fm_vec3_t{a.x, b.y, b.z}, color);
-  drawLine(fm_vec3_t{b.x, b.y, a.z}, fm_vec3_t{b.x, b.y, b.z}, color);
-  drawLine(fm_vec3_t{b.x, b.y, a.z}, fm_vec3_t{a.x, b.y, a.z}, color);
-  drawLine(fm_vec3_t{b.x, b.y, b.z}, fm_vec3_t{a.x, b.y, b.z}, color);
+  // corners, bit 0/1/2 picks the max. on X/Y/Z
+  for(uint32_t i=0; i<8; ++i) {
+    verts[idx + i] = {{(i & 1) ? b.x : a.x, (i & 2) ? b.y : a.y, (i & 4) ? b.z : a.z}, color};
+  }
+  // all 12 edges, connecting corners that differ in one axis
+  for(uint32_t i=0; i<8; ++i) {
+    for(uint32_t axis=1; axis<8; axis <<= 1) {
+      if(!(i & axis))addLine(idx + i, idx + (i | axis));
+    }
+  }
 }
@@ -0,0 +1,190 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "debug/hotReload.h"
+
+#if P64_HOT_RELOAD
+#include <usb.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "assets/assetManager.h"
+#include "lib/logger.h"
+
+namespace
+{
+  constexpr const char* ROM_PREFIX = "rom:/";
+  constexpr const char* HOT_PREFIX = "hot:/";
+  constexpr uint32_t HEADER_SIZE = 8;
+  constexpr uint32_t FILE_HEADER_SIZE = 8;
+
+  struct File
+  {
+    uint8_t* data{};
+    uint32_t size{};
+    std::string hotPath{}; // returned by 'resolvePath', stable since map entries never move
+  };
+
+  struct Handle
+  {
+    const File* file;
+    uint32_t pos;
+  };
+
+  // key is the path without the 'rom:/' prefix, same as 'hot:/' is opened with
+  std::unordered_map<std::string, File> files{};
+  std::vector<uint32_t> changedAssets{};
+  constinit bool isInit{false};
+
+  uint32_t alignUp4(uint32_t v) { return (v + 3) & ~3u; }
+
+  uint32_t readU32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+  }
+
+  uint16_t readU16(const uint8_t* p) {
+    return ((uint16_t)p[0] << 8) | p[1];
+  }
+
+  void* fsOpen(char *name, int flags)
+  {
+    if((flags & O_ACCMODE) != O_RDONLY)return nullptr;
+    auto it = files.find(name);
+    if(it == files.end())return nullptr;
+    return new Handle{&it->second, 0};
+  }
+
+  int fsFstat(void *file, struct stat *st)
+  {
+    auto h = (Handle*)file;
+    memset(st, 0, sizeof(*st));
+    st->st_mode = S_IFREG;
+    st->st_size = h->file->size;
+    return 0;
+  }
+
+  int fsLseek(void *file, int offset, int whence)
+  {
+    auto h = (Handle*)file;
+    int pos = offset;
+    if(whence == SEEK_CUR)pos += h->pos;
+    if(whence == SEEK_END)pos += h->file->size;
+    if(pos < 0 || (uint32_t)pos > h->file->size)return -1;
+    h->pos = pos;
+    return pos;
+  }
+
+  int fsRead(void *file, uint8_t *ptr, int len)
+  {
+    auto h = (Handle*)file;
+    uint32_t count = std::min((uint32_t)len, h->file->size - h->pos);
+    memcpy(ptr, h->file->data + h->pos, count);
+    h->pos += count;
+    return count;
+  }
+
+  int fsClose(void *file)
+  {
+    delete (Handle*)file;
+    return 0;
+  }
+
+  constinit filesystem_t hotFs{
+    .open = fsOpen,
+    .fstat = fsFstat,
+    .lseek = fsLseek,
+    .read = fsRead,
+    .close = fsClose,
+  };
+
+  bool applyPacket(const uint8_t* data, uint32_t size)
+  {
+    if(size < HEADER_SIZE || readU32(data) != Debug::HotReload::PACKET_MAGIC) {
+      P64::Log::warn("Hot-Reload: invalid packet\n");
+      return false;
+    }
+    if(readU16(data + 4) != Debug::HotReload::PACKET_VERSION) {
+      P64::Log::warn("Hot-Reload: version mismatch, update the editor or rebuild the ROM\n");
+      return false;
+    }
+
+    uint32_t fileCount = readU16(data + 6);
+    uint32_t pos = HEADER_SIZE;
+    for(uint32_t i=0; i<fileCount; ++i)
+    {
+      if(pos + FILE_HEADER_SIZE > size)return i != 0;
+      uint32_t pathLen = readU16(data + pos);
+      uint32_t fileSize = readU32(data + pos + 4);
+      pos += FILE_HEADER_SIZE;
+      if(pos + alignUp4(pathLen) + fileSize > size)return i != 0;
+
+      std::string path{(const char*)data + pos, pathLen};
+      pos += alignUp4(pathLen);
+
+      auto &file = files[path];
+      ::free(file.data);
+      file.data = (uint8_t*)malloc(fileSize);
+      file.size = fileSize;
+      file.hotPath = std::string{HOT_PREFIX} + path;
+      memcpy(file.data, data + pos, fileSize);
+      pos += alignUp4(fileSize);
+
+      uint32_t assetIdx = P64::AssetManager::getIndexByPath(path.c_str());
+      if(assetIdx != P64::AssetManager::INVALID_INDEX)changedAssets.push_back(assetIdx);
+      P64::Log::info("Hot-Reload: %s (%lu bytes)\n", path.c_str(), fileSize);
+    }
+    return fileCount != 0;
+  }
+}
+
+void Debug::HotReload::init()
+{
+  if(isInit)return;
+  isInit = true;
+  attach_filesystem(HOT_PREFIX, &hotFs);
+}
+
+bool Debug::HotReload::poll()
+{
+  if(!isInit)return false;
+  uint32_t header = usb_poll();
+  if(header == 0)return false;
+
+  uint32_t size = USBHEADER_GETSIZE(header);
+  if(USBHEADER_GETTYPE(header) != DATATYPE_RAWBINARY || size == 0) {
+    usb_purge();
+    return false;
+  }
+
+  auto packet = (uint8_t*)malloc(size);
+  usb_read(packet, size);
+  bool changed = applyPacket(packet, size);
+  ::free(packet);
+  return changed;
+}
+
+void Debug::HotReload::freeChangedAssets()
+{
+  for(auto idx : changedAssets)P64::AssetManager::free(idx);
+  changedAssets.clear();
+}
+
+bool Debug::HotReload::hasChangedAssets()
+{
+  return !changedAssets.empty();
+}
+
+const char* Debug::HotReload::resolvePath(const char* path)
+{
+  if(files.empty() || strncmp(path, ROM_PREFIX, 5) != 0)return path;
+  auto it = files.find(path + 5);
+  return it == files.end() ? path : it->second.hotPath.c_str();
+}
+
+#endif
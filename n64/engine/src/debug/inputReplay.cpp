@@ -0,0 +1,286 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "debug/inputReplay.h"
+
+#if P64_INPUT_REPLAY
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "scene/scene.h"
+#include "scene/sceneManager.h"
+#include "vi/swapChain.h"
+#include "lib/logger.h"
+
+extern "C" {
+  void __real_joypad_poll(void);
+  bool __real_joypad_is_connected(joypad_port_t port);
+  joypad_inputs_t __real_joypad_get_inputs(joypad_port_t port);
+  joypad_buttons_t __real_joypad_get_buttons(joypad_port_t port);
+  joypad_buttons_t __real_joypad_get_buttons_pressed(joypad_port_t port);
+  joypad_buttons_t __real_joypad_get_buttons_released(joypad_port_t port);
+  joypad_buttons_t __real_joypad_get_buttons_held(joypad_port_t port);
+  joypad_8way_t __real_joypad_get_direction(joypad_port_t port, joypad_2d_t axes);
+}
+
+namespace
+{
+  using namespace Debug::InputReplay;
+
+  enum class Mode : uint8_t { OFF, PENDING_RECORD, RECORDING, PENDING_REPLAY, REPLAYING };
+
+  // the stick has to be pushed at least this far for 'joypad_get_direction'
+  constexpr int32_t STICK_DIR_THRESHOLD = 42;
+  constexpr uint32_t DUMP_BYTES_PER_LINE = 64;
+
+  std::vector<Frame> frames{};
+  constinit Header header{};
+  constinit Frame curr{};
+  constinit Frame prev{};
+  constinit uint32_t replayIdx{0};
+  constinit Mode mode{Mode::OFF};
+
+  bool isActive() {
+    return mode == Mode::RECORDING || mode == Mode::REPLAYING;
+  }
+
+  void setFrame(const Frame &frame) {
+    prev = curr;
+    curr = frame;
+  }
+
+  Frame readJoypads()
+  {
+    Frame frame{};
+    for(uint32_t p=0; p<JOYPAD_PORT_COUNT; ++p) {
+      auto port = (joypad_port_t)p;
+      if(!__real_joypad_is_connected(port))continue;
+      frame.connected |= 1 << p;
+      frame.inputs[p] = __real_joypad_get_inputs(port);
+    }
+    return frame;
+  }
+
+  int32_t sign(int32_t v) { return (v > 0) - (v < 0); }
+
+  joypad_8way_t getDirection(const joypad_inputs_t &in, joypad_2d_t axes)
+  {
+    int32_t x = 0;
+    int32_t y = 0;
+    if(axes & JOYPAD_2D_DPAD) {
+      x += in.btn.d_right - in.btn.d_left;
+      y += in.btn.d_up - in.btn.d_down;
+    }
+    if(axes & JOYPAD_2D_C) {
+      x += in.btn.c_right - in.btn.c_left;
+      y += in.btn.c_up - in.btn.c_down;
+    }
+    if(x == 0 && y == 0 && (axes & JOYPAD_2D_STICK))
+    {
+      int32_t sx = in.stick_x;
+      int32_t sy = in.stick_y;
+      if(sx*sx + sy*sy >= STICK_DIR_THRESHOLD*STICK_DIR_THRESHOLD) {
+        // diagonal once the smaller axis is at least ~tan(22.5) of the bigger one
+        x = (abs(sx) * 5 >= abs(sy) * 2) ? sign(sx) : 0;
+        y = (abs(sy) * 5 >= abs(sx) * 2) ? sign(sy) : 0;
+      }
+    }
+
+    constexpr joypad_8way_t DIRS[3][3] = {
+      {JOYPAD_8WAY_DOWN_LEFT, JOYPAD_8WAY_DOWN, JOYPAD_8WAY_DOWN_RIGHT},
+      {JOYPAD_8WAY_LEFT, JOYPAD_8WAY_NONE, JOYPAD_8WAY_RIGHT},
+      {JOYPAD_8WAY_UP_LEFT, JOYPAD_8WAY_UP, JOYPAD_8WAY_UP_RIGHT},
+    };
+    return DIRS[sign(y) + 1][sign(x) + 1];
+  }
+
+  uint16_t getButtons(const Frame &frame, joypad_port_t port) {
+    return frame.inputs[port].btn.raw;
+  }
+
+  joypad_buttons_t toButtons(uint16_t raw) {
+    joypad_buttons_t res{};
+    res.raw = raw;
+    return res;
+  }
+}
+
+extern "C"
+{
+  // polled once per tick by the engine instead, see 'Debug::InputReplay::poll'
+  void __wrap_joypad_poll(void) {
+    if(!isActive())__real_joypad_poll();
+  }
+
+  bool __wrap_joypad_is_connected(joypad_port_t port) {
+    if(!isActive())return __real_joypad_is_connected(port);
+    return curr.connected & (1 << port);
+  }
+
+  joypad_inputs_t __wrap_joypad_get_inputs(joypad_port_t port) {
+    if(!isActive())return __real_joypad_get_inputs(port);
+    return curr.inputs[port];
+  }
+
+  joypad_buttons_t __wrap_joypad_get_buttons(joypad_port_t port) {
+    if(!isActive())return __real_joypad_get_buttons(port);
+    return toButtons(getButtons(curr, port));
+  }
+
+  joypad_buttons_t __wrap_joypad_get_buttons_pressed(joypad_port_t port) {
+    if(!isActive())return __real_joypad_get_buttons_pressed(port);
+    return toButtons(getButtons(curr, port) & ~getButtons(prev, port));
+  }
+
+  joypad_buttons_t __wrap_joypad_get_buttons_released(joypad_port_t port) {
+    if(!isActive())return __real_joypad_get_buttons_released(port);
+    return toButtons(~getButtons(curr, port) & getButtons(prev, port));
+  }
+
+  joypad_buttons_t __wrap_joypad_get_buttons_held(joypad_port_t port) {
+    if(!isActive())return __real_joypad_get_buttons_held(port);
+    return toButtons(getButtons(curr, port) & getButtons(prev, port));
+  }
+
+  joypad_8way_t __wrap_joypad_get_direction(joypad_port_t port, joypad_2d_t axes) {
+    if(!isActive())return __real_joypad_get_direction(port, axes);
+    return getDirection(curr.inputs[port], axes);
+  }
+}
+
+uint16_t Debug::InputReplay::init(uint16_t sceneId)
+{
+  FILE* file = fopen(REPLAY_PATH, "rb");
+  if(!file)return sceneId;
+  fclose(file);
+
+  int size = 0;
+  auto data = (uint8_t*)asset_load(REPLAY_PATH, &size);
+  Header fileHeader{};
+  if((uint32_t)size >= sizeof(Header))memcpy(&fileHeader, data, sizeof(Header));
+
+  bool valid = fileHeader.magic == MAGIC && fileHeader.version == VERSION
+    && (uint32_t)size >= sizeof(Header) + fileHeader.frameCount * sizeof(Frame);
+  if(!valid) {
+    P64::Log::warn("Input-Replay: invalid file, record it again");
+    free(data);
+    return sceneId;
+  }
+
+  header = fileHeader;
+  auto framesStart = (const Frame*)(data + sizeof(Header));
+  frames.assign(framesStart, framesStart + header.frameCount);
+  free(data);
+
+  mode = Mode::PENDING_REPLAY;
+  P64::Log::info("Input-Replay: %lu frames, starting in scene %d", header.frameCount, header.sceneId);
+  return header.sceneId;
+}
+
+void Debug::InputReplay::startRecording()
+{
+  mode = Mode::PENDING_RECORD;
+  P64::SceneManager::load(P64::SceneManager::getCurrent().getId());
+}
+
+void Debug::InputReplay::stopRecording()
+{
+  if(mode == Mode::PENDING_RECORD)mode = Mode::OFF;
+  if(mode != Mode::RECORDING)return;
+  mode = Mode::OFF;
+  header.frameCount = frames.size();
+  P64::Log::info("Input-Replay: recorded %lu frames", header.frameCount);
+}
+
+bool Debug::InputReplay::isRecording() {
+  return mode == Mode::RECORDING || mode == Mode::PENDING_RECORD;
+}
+
+bool Debug::InputReplay::isReplaying() {
+  return mode == Mode::REPLAYING || mode == Mode::PENDING_REPLAY;
+}
+
+void Debug::InputReplay::dump()
+{
+  stopRecording();
+  if(frames.empty()) {
+    P64::Log::warn("Input-Replay: nothing recorded");
+    return;
+  }
+
+  auto writeHex = [](const uint8_t* data, uint32_t size) {
+    char line[DUMP_BYTES_PER_LINE*2 + 1];
+    for(uint32_t pos=0; pos<size; pos += DUMP_BYTES_PER_LINE) {
+      uint32_t count = std::min(size - pos, DUMP_BYTES_PER_LINE);
+      for(uint32_t i=0; i<count; ++i)sprintf(line + i*2, "%02X", data[pos + i]);
+      debugf("%s\n", line);
+    }
+  };
+
+  debugf("%s\n", MARKER_BEGIN);
+  writeHex((const uint8_t*)&header, sizeof(Header));
+  writeHex((const uint8_t*)frames.data(), frames.size() * sizeof(Frame));
+  debugf("%s\n", MARKER_END);
+}
+
+void Debug::InputReplay::onSceneLoaded(uint16_t sceneId)
+{
+  if(mode == Mode::PENDING_RECORD)
+  {
+    header = {
+      .magic = MAGIC, .version = VERSION, .sceneId = sceneId,
+      .seed = (uint32_t)get_ticks(), .deltaTime = P64::VI::SwapChain::getFrameBudget(),
+      .frameCount = 0,
+    };
+    frames.clear();
+    frames.reserve(60 * 60);
+    srand(header.seed);
+    curr = prev = {};
+    mode = Mode::RECORDING;
+    P64::Log::info("Input-Replay: recording in scene %d", sceneId);
+  }
+  else if(mode == Mode::PENDING_REPLAY && sceneId == header.sceneId)
+  {
+    srand(header.seed);
+    curr = prev = {};
+    replayIdx = 0;
+    mode = Mode::REPLAYING;
+  }
+}
+
+void Debug::InputReplay::poll()
+{
+  if(mode == Mode::RECORDING)
+  {
+    __real_joypad_poll();
+    auto frame = readJoypads();
+    frames.push_back(frame);
+    setFrame(frame);
+    if(frames.size() >= MAX_FRAMES) {
+      P64::Log::warn("Input-Replay: reached %lu frames, recording stopped", MAX_FRAMES);
+      stopRecording();
+    }
+    return;
+  }
+
+  if(mode == Mode::REPLAYING)
+  {
+    if(replayIdx < frames.size()) {
+      setFrame(frames[replayIdx++]);
+      return;
+    }
+    mode = Mode::OFF;
+    debugf("%s %lu\n", MARKER_DONE, replayIdx);
+  }
+  __real_joypad_poll();
+}
+
+float Debug::InputReplay::getDeltaTime(float deltaTime)
+{
+  return isActive() ? header.deltaTime : deltaTime;
+}
+
+#endif
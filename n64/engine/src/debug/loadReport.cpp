@@ -0,0 +1,253 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "debug/loadReport.h"
+
+#if P64_LOAD_REPORT
+#include <algorithm>
+#include <iterator>
+
+#include "assets/assetManager.h"
+#include "scene/componentTable.h"
+#include "lib/logger.h"
+
+extern "C" {
+  void __real_dma_read(void* ramAddress, unsigned long piAddress, unsigned long len);
+  void __real_dma_read_async(void* ramAddress, unsigned long piAddress, unsigned long len);
+  void __real_dma_wait(void);
+}
+
+namespace
+{
+  using namespace Debug::LoadReport;
+  constexpr uint32_t PHASE_COUNT = (uint32_t)Phase::COUNT;
+  constexpr uint8_t NO_PHASE = 0xFF;
+
+  struct Stats
+  {
+    uint32_t count;
+    uint32_t ticks;
+    uint32_t romBytes;
+    uint32_t romTicks;
+
+    void add(const Mark &start, const Mark &now) {
+      ++count;
+      ticks += now.ticks - start.ticks;
+      romBytes += now.romBytes - start.romBytes;
+      romTicks += now.romTicks - start.romTicks;
+    }
+  };
+
+  struct AssetEntry
+  {
+    uint16_t idx;
+    uint8_t phase;
+    uint32_t heapBytes;
+    Stats stats;
+  };
+
+  struct ObjectEntry
+  {
+    uint16_t id;
+    uint32_t ticks;
+  };
+
+  // updated by the DMA hooks, these run outside of reports too
+  constinit uint32_t romBytes{0};
+  constinit uint32_t romTicks{0};
+
+  constinit Stats total{};
+  constinit Mark startMark{};
+  constinit Stats phases[PHASE_COUNT]{};
+  constinit Mark phaseStart[PHASE_COUNT]{};
+  constinit Stats comps[P64::COMP_TABLE_SIZE]{};
+  constinit Stats objects{};
+  constinit ObjectEntry slowObjects[MAX_SLOW_OBJECTS]{};
+  constinit AssetEntry assets[MAX_ASSETS]{};
+  constinit uint32_t assetCount{0};
+  constinit uint32_t assetsDropped{0};
+  constinit uint16_t sceneId{0};
+  constinit uint8_t currPhase{NO_PHASE};
+  constinit bool active{false};
+
+  uint32_t toUs(uint32_t ticks) {
+    return TICKS_TO_US((uint64_t)ticks);
+  }
+
+  const char* getPhaseName(uint8_t phase) {
+    return phase < PHASE_COUNT ? PHASE_NAMES[phase] : "Other";
+  }
+
+  void logSummary()
+  {
+    P64::Log::info("Load-Report: scene %d, %lums, %lu KB from ROM in %lums",
+      sceneId, toUs(total.ticks) / 1000, total.romBytes / 1024, toUs(total.romTicks) / 1000);
+
+    uint32_t otherTicks = total.ticks;
+    for(uint32_t p=0; p<PHASE_COUNT; ++p) {
+      otherTicks -= std::min(otherTicks, phases[p].ticks);
+      P64::Log::info("  %-10s %7luus %6lu KB", PHASE_NAMES[p], toUs(phases[p].ticks), phases[p].romBytes / 1024);
+    }
+    P64::Log::info("  %-10s %7luus", "Other", toUs(otherTicks));
+
+    uint8_t compOrder[P64::COMP_TABLE_SIZE];
+    for(uint32_t c=0; c<P64::COMP_TABLE_SIZE; ++c)compOrder[c] = c;
+    std::sort(compOrder, compOrder + P64::COMP_TABLE_SIZE, [](uint8_t a, uint8_t b) {
+      return comps[a].ticks > comps[b].ticks;
+    });
+    P64::Log::info(" Objects: %lu, %luus (slowest components)", objects.count, toUs(objects.ticks));
+    for(uint32_t i=0; i<LOG_TOP_COUNT; ++i) {
+      auto &comp = comps[compOrder[i]];
+      if(comp.count == 0)break;
+      P64::Log::info("  comp %2d: %4lux %7luus", compOrder[i], comp.count, toUs(comp.ticks));
+    }
+
+    AssetEntry* assetOrder[MAX_ASSETS];
+    for(uint32_t i=0; i<assetCount; ++i)assetOrder[i] = &assets[i];
+    std::sort(assetOrder, assetOrder + assetCount, [](const AssetEntry* a, const AssetEntry* b) {
+      return a->stats.ticks > b->stats.ticks;
+    });
+    P64::Log::info(" Assets: %lu (slowest, ROM-read / decode)", assetCount);
+    for(uint32_t i=0; i<std::min(assetCount, LOG_TOP_COUNT); ++i) {
+      auto &stats = assetOrder[i]->stats;
+      P64::Log::info("  %6lu KB %6luus / %6luus %s", stats.romBytes / 1024, toUs(stats.romTicks),
+        toUs(stats.ticks - stats.romTicks), P64::AssetManager::getPath(assetOrder[i]->idx));
+    }
+    if(assetsDropped)P64::Log::warn("Load-Report: %lu assets not recorded, raise MAX_ASSETS", assetsDropped);
+  }
+
+  void dump()
+  {
+    debugf("%s\n", MARKER_BEGIN);
+    debugf("{\"type\":\"scene\",\"id\":%d,\"us\":%lu,\"romBytes\":%lu,\"romUs\":%lu}\n",
+      sceneId, toUs(total.ticks), total.romBytes, toUs(total.romTicks));
+
+    for(uint32_t p=0; p<PHASE_COUNT; ++p) {
+      debugf("{\"type\":\"phase\",\"name\":\"%s\",\"us\":%lu,\"romBytes\":%lu,\"romUs\":%lu}\n",
+        PHASE_NAMES[p], toUs(phases[p].ticks), phases[p].romBytes, toUs(phases[p].romTicks));
+    }
+    for(uint32_t c=0; c<P64::COMP_TABLE_SIZE; ++c) {
+      if(comps[c].count == 0)continue;
+      debugf("{\"type\":\"comp\",\"id\":%lu,\"count\":%lu,\"us\":%lu,\"romBytes\":%lu,\"romUs\":%lu}\n",
+        c, comps[c].count, toUs(comps[c].ticks), comps[c].romBytes, toUs(comps[c].romTicks));
+    }
+
+    debugf("{\"type\":\"objects\",\"count\":%lu,\"us\":%lu}\n", objects.count, toUs(objects.ticks));
+    for(auto &obj : slowObjects) {
+      if(obj.ticks == 0)break;
+      debugf("{\"type\":\"object\",\"id\":%d,\"us\":%lu}\n", obj.id, toUs(obj.ticks));
+    }
+
+    for(uint32_t i=0; i<assetCount; ++i) {
+      auto &asset = assets[i];
+      debugf("{\"type\":\"asset\",\"path\":\"%s\",\"phase\":\"%s\",\"us\":%lu,\"romBytes\":%lu,\"romUs\":%lu,\"heap\":%lu}\n",
+        P64::AssetManager::getPath(asset.idx), getPhaseName(asset.phase),
+        toUs(asset.stats.ticks), asset.stats.romBytes, toUs(asset.stats.romTicks), asset.heapBytes
+      );
+    }
+    debugf("%s\n", MARKER_END);
+  }
+}
+
+extern "C"
+{
+  void __wrap_dma_read(void* ramAddress, unsigned long piAddress, unsigned long len) {
+    uint32_t t = get_ticks();
+    __real_dma_read(ramAddress, piAddress, len);
+    romTicks += get_ticks() - t;
+    romBytes += len;
+  }
+
+  void __wrap_dma_read_async(void* ramAddress, unsigned long piAddress, unsigned long len) {
+    uint32_t t = get_ticks();
+    __real_dma_read_async(ramAddress, piAddress, len);
+    romTicks += get_ticks() - t;
+    romBytes += len;
+  }
+
+  void __wrap_dma_wait(void) {
+    uint32_t t = get_ticks();
+    __real_dma_wait();
+    romTicks += get_ticks() - t;
+  }
+}
+
+void Debug::LoadReport::begin(uint16_t id)
+{
+  total = {};
+  std::fill(std::begin(phases), std::end(phases), Stats{});
+  std::fill(std::begin(comps), std::end(comps), Stats{});
+  std::fill(std::begin(slowObjects), std::end(slowObjects), ObjectEntry{});
+  objects = {};
+  assetCount = 0;
+  assetsDropped = 0;
+  sceneId = id;
+  currPhase = NO_PHASE;
+  active = true;
+  startMark = mark();
+}
+
+void Debug::LoadReport::end()
+{
+  if(!active)return;
+  active = false;
+  total.add(startMark, mark());
+  logSummary();
+  dump();
+}
+
+void Debug::LoadReport::beginPhase(Phase phase)
+{
+  if(!active)return;
+  currPhase = (uint8_t)phase;
+  phaseStart[currPhase] = mark();
+}
+
+void Debug::LoadReport::endPhase(Phase phase)
+{
+  if(!active)return;
+  phases[(uint32_t)phase].add(phaseStart[(uint32_t)phase], mark());
+  currPhase = NO_PHASE;
+}
+
+Debug::LoadReport::Mark Debug::LoadReport::mark()
+{
+  return {.ticks = (uint32_t)get_ticks(), .romBytes = romBytes, .romTicks = romTicks};
+}
+
+void Debug::LoadReport::onComponent(uint8_t compId, const Mark &start)
+{
+  if(!active || compId >= P64::COMP_TABLE_SIZE)return;
+  comps[compId].add(start, mark());
+}
+
+void Debug::LoadReport::onObject(uint16_t objId, const Mark &start)
+{
+  if(!active)return;
+  uint32_t ticks = mark().ticks - start.ticks;
+  objects.count++;
+  objects.ticks += ticks;
+
+  // sorted, slowest first
+  auto it = std::find_if(std::begin(slowObjects), std::end(slowObjects), [ticks](const ObjectEntry &e) {
+    return ticks > e.ticks;
+  });
+  if(it == std::end(slowObjects))return;
+  std::move_backward(it, std::end(slowObjects) - 1, std::end(slowObjects));
+  *it = {.id = objId, .ticks = ticks};
+}
+
+void Debug::LoadReport::onAsset(uint32_t idx, const Mark &start, uint32_t heapBytes)
+{
+  if(!active)return;
+  if(assetCount >= MAX_ASSETS) {
+    ++assetsDropped;
+    return;
+  }
+  auto &asset = assets[assetCount++];
+  asset = {.idx = (uint16_t)idx, .phase = currPhase, .heapBytes = heapBytes, .stats = {}};
+  asset.stats.add(start, mark());
+}
+
+#endif
@@ -5,12 +5,24 @@
 #include "overlay.h"
 
 #include "debug/debugDraw.h"
+#include "debug/trace.h"
+#include "debug/inputReplay.h"
 #include "scene/scene.h"
 #include "vi/swapChain.h"
 #include "audio/audioManager.h"
 #include "lib/matrixManager.h"
+#include "renderer/matrixBatch.h"
+#include "renderer/batch2D.h"
+#include "renderer/drawLayer.h"
 #include "lib/memory.h"
-
+#include "assets/assetManager.h"
+#include "scene/components/animModel.h"
+#include "scene/components/constraint.h"
+#include "renderer/hdr/postProcess.h"
+#include "renderer/pipelineBigTex.h"
+#include "script/globalScript.h"
+
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <filesystem>
@@ -36,6 +48,18 @@ namespace {
   constexpr color_t COLOR_GLOBAL_DRAW{0x33,0x33,0x33, 0xFF};
   constexpr color_t COLOR_AUDIO{0x43, 0x52, 0xFF, 0xFF};
 
+  // short names for the per-type timings, indexed by component ID
+  constexpr const char* COMP_NAMES[P64::COMP_TABLE_SIZE] {
+    "Code", "Model", "Light", "Cam", "CMesh", "CBody", "Audio",
+    "Const", "Cull", "Graph", "Anim", "?", "Aud3D", "Ptx", "?", "?"
+  };
+
+  // indexed by 'GlobalScript::HookType'
+  constexpr const char* HOOK_NAMES[(uint32_t)P64::GlobalScript::HookType::_size_] {
+    "Init", "PreLoad", "PostLoad", "PreUnld", "PostUnld",
+    "Update", "PreDraw", "Pre3D", "Post3D", "Draw2D"
+  };
+
   enum class MenuItemType : uint8_t {
     BOOL,
     INT,
@@ -79,6 +103,12 @@ namespace {
       value = item.value;
     }});
   }
+  void addIntItem(Menu &m, const char* name, int &value, int count) {
+    m.items.push_back({name, value, MenuItemType::INT, [&value, count](auto &item) {
+      item.value = (item.value + count) % count;
+      value = item.value;
+    }});
+  }
   void addActionItem(Menu &m, const char* name, std::function<void(MenuItem&)> action) {
     m.items.push_back({name, 0, MenuItemType::ACTION, action});
   }
@@ -88,9 +118,39 @@ namespace {
   bool matrixDebug = false;
   bool showMenuScene = false;
   bool showFrameTime = false;
+  // 0 = hidden, 1 = in dispatch order, 2 = sorted by total time (update + draw)
+  int compTimeMode = 0;
+  bool showMemBudget = false;
+  bool showBloomTime = false;
+  bool showHookTime = false;
 
   bool isVisible = false;
   bool didInit = false;
+
+  // fill cost per layer while the overdraw heatmap is on, shown even with the overlay hidden
+  void drawFillStats()
+  {
+    float posX = SCREEN_WIDTH - 96;
+    float posY = 16;
+    Debug::printStart();
+    Debug::printf(posX, posY, "Fill  kCycles");
+    posY += 8;
+
+    uint32_t total = 0;
+    uint32_t layerCount = P64::DrawLayer::getBufferedCount() + 1;
+    for(uint32_t l=0; l<layerCount; ++l) {
+      uint32_t cycles = P64::DrawLayer::getFillCycles(l);
+      total += cycles;
+      Debug::printf(posX, posY, "L%-2lu %8.1f", l, (double)cycles / 1000.0);
+      posY += 8;
+    }
+    uint32_t cyclesPost = P64::DrawLayer::getFillCycles(P64::DrawLayer::FILL_IDX_POST);
+    total += cyclesPost;
+    Debug::printf(posX, posY, "Post %7.1f", (double)cyclesPost / 1000.0);
+    posY += 8;
+    // 62.5MHz, so the budget of a 30FPS frame is ~2083k
+    Debug::printf(posX, posY, "Sum  %7.1f", (double)total / 1000.0);
+  }
 }
 
 void Debug::Overlay::toggle()
@@ -120,6 +180,10 @@ void Debug::Overlay::init()
 
 void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
 {
+  // menus and metrics are allocated on first use, not part of what 'FLAG_NO_ALLOC' is meant to catch
+  AllocTracker::ScopedIgnore allocIgnore{};
+  if(P64::DrawLayer::isHeatmapEnabled())drawFillStats();
+
   if(!isVisible)
   {
     //Debug::printStart();
@@ -140,7 +204,7 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
   uint64_t newTicksSelf = get_user_ticks();
   MEMORY_BARRIER();
 
-  Debug::draw(surf);
+  Debug::draw();
 
   auto btn = joypad_get_buttons_pressed(JOYPAD_PORT_1);
 
@@ -151,6 +215,34 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
     addBoolItem(menu, "Coll-Tri", showCollMesh);
     addBoolItem(menu, "Memory", matrixDebug);
     addBoolItem(menu, "Frames", showFrameTime);
+  #if P64_COMP_PROFILE
+    addIntItem(menu, "Comp-Time", compTimeMode, 3);
+  #endif
+    addBoolItem(menu, "Mem-Budget", showMemBudget);
+    addBoolItem(menu, "Bloom-Time", showBloomTime);
+    addBoolItem(menu, "Hook-Time", showHookTime);
+    addActionItem(menu, "Mem-Log", []([[maybe_unused]] auto &item) {
+      P64::Mem::logTracked();
+      P64::AssetManager::logStats();
+    });
+  #if P64_TRACE
+    addActionItem(menu, "Trace-Dump", []([[maybe_unused]] auto &item) {
+      Debug::Trace::dump();
+    });
+  #endif
+  #if P64_INPUT_REPLAY
+    // restarts the scene, stopping it again keeps the recording in memory until dumped
+    addActionItem(menu, "Input-Rec", []([[maybe_unused]] auto &item) {
+      if(Debug::InputReplay::isRecording()) {
+        Debug::InputReplay::stopRecording();
+      } else {
+        Debug::InputReplay::startRecording();
+      }
+    });
+    addActionItem(menu, "Input-Dump", []([[maybe_unused]] auto &item) {
+      Debug::InputReplay::dump();
+    });
+  #endif
 
     addActionItem(menuScenes, "< Back >", []([[maybe_unused]] auto &item) {
       showMenuScene = false;
@@ -187,29 +279,57 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
   if(showFrameTime) {
     rdpq_sync_pipe();
 
-    constexpr uint32_t fbCount = 3;
-    float viBarWidth = 300;
-
-    color_t fbStateCol[6];
-    fbStateCol[0] = {0x00, 0x00, 0x00, 0xFF};
-    fbStateCol[1] = {0x33, 0xFF, 0x33, 0xFF};
-    fbStateCol[2] = {0x22, 0x77, 0x77, 0xFF};
-    fbStateCol[3] = {0x22, 0xAA, 0xAA, 0xFF};
-    fbStateCol[4] = {0xAA, 0xAA, 0xAA, 0xFF};
-    fbStateCol[5] = {0xAA, 0x22, 0xAA, 0xFF};
-
+    // frame pacing, one column per frame (oldest first). Each has the RDP busy time on the left and
+    // the CPU waiting for a free buffer on the right, the line marks the frame budget.
+    // High RDP time means RDP-bound, waiting with an idle RDP means the VI (or frame-limit) is the limit.
+    const auto &stats = P64::VI::SwapChain::getFrameStats();
+    constexpr float colWidth = 4;
+    constexpr float graphHeight = 64;
+    float graphWidth = stats.size() * colWidth;
+    float budgetUs = P64::VI::SwapChain::getFrameBudget() * 1e6f;
+    float usToHeight = (graphHeight * 0.5f) / budgetUs; // budget at half the height
+    posY = SCREEN_HEIGHT - 32;
+
+    uint32_t sumRdp = 0, sumWait = 0, sumMissed = 0;
     rdpq_mode_push();
     rdpq_set_mode_fill({0,0,0, 0xFF});
-    rdpq_fill_rectangle(posX, posY-2, posX + viBarWidth, posY + 7 * fbCount+1);
-    rdpq_fill_rectangle(posX, posY-10, posX + viBarWidth, posY - 6);
+    rdpq_fill_rectangle(posX, posY - graphHeight, posX + graphWidth, posY);
 
+    for(uint32_t i=0; i<stats.size(); ++i)
+    {
+      auto &frame = stats[i];
+      sumRdp += frame.rdpBusyUs;
+      sumWait += frame.cpuWaitUs;
+      sumMissed += frame.missedVBlanks;
+
+      float x = posX + i * colWidth;
+      float hRdp = fminf(frame.rdpBusyUs * usToHeight, graphHeight);
+      float hWait = fminf(frame.cpuWaitUs * usToHeight, graphHeight);
+      rdpq_set_fill_color(COLOR_SCENE_DRAW);
+      rdpq_fill_rectangle(x, posY - hRdp, x + 2, posY);
+      rdpq_set_fill_color(COLOR_AUDIO);
+      rdpq_fill_rectangle(x + 2, posY - hWait, x + 4, posY);
+      if(frame.missedVBlanks) {
+        rdpq_set_fill_color({0xFF,0x22,0x22, 0xFF});
+        rdpq_fill_rectangle(x, posY - graphHeight, x + colWidth, posY - graphHeight + fminf(2.0f * frame.missedVBlanks, graphHeight));
+      }
+    }
+
+    rdpq_set_fill_color({0x77,0x77,0x77, 0xFF});
+    rdpq_fill_rectangle(posX, posY - graphHeight * 0.5f, posX + graphWidth, posY - graphHeight * 0.5f + 1);
     rdpq_mode_pop();
 
     Debug::printStart();
-
-    posY = 64;
-    Debug::printf(posX + 200, posY-8, "FPS: %.2f", (double)P64::VI::SwapChain::getFPS());
-
+    Debug::printf(posX, posY - graphHeight - 10, "FPS: %.2f FB:%lu", (double)P64::VI::SwapChain::getFPS(),
+      P64::VI::SwapChain::getFrameBufferCount()
+    );
+    rdpq_set_prim_color(COLOR_SCENE_DRAW);
+    posX = Debug::printf(posX, posY + 2, "RDP:%.2f", (double)sumRdp / stats.size() / 1000.0) + 8;
+    rdpq_set_prim_color(COLOR_AUDIO);
+    posX = Debug::printf(posX, posY + 2, "Wait:%.2f", (double)sumWait / stats.size() / 1000.0) + 8;
+    rdpq_set_prim_color({0xFF,0x22,0x22, 0xFF});
+    Debug::printf(posX, posY + 2, "Miss:%lu", sumMissed);
+    rdpq_set_prim_color({0xFF,0xFF,0xFF, 0xFF});
     return;
   }
   Debug::printStart();
@@ -224,6 +344,10 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
   rdpq_set_prim_color(COLOR_COLL);
   posX = Debug::printf(posX, posY, "%.2f", (double)TICKS_TO_US(collScene.ticks - collScene.ticksBVH) / 1000.0) + 8;
   //posX = Debug::printf(posX, posY, "Ray:%d", collScene.raycastCount) + 8;
+  Debug::printf(16, posY + 8, "P:%lu/%lu S:%lu B:%lu/%lu C:%lu",
+    collScene.pairCountBroad, collScene.pairCount, collScene.meshesSkipped,
+    collScene.bcsActive, collScene.bcsSleeping, collScene.contactsReused
+  );
   rdpq_set_prim_color(COLOR_ACTOR_UPDATE);
   Debug::printf(posX, posY, "%.2f", (double)TICKS_TO_US(scene.ticksActorUpdate) / 1000.0);
     rdpq_set_prim_color(COLOR_GLOBAL_UPDATE);
@@ -242,6 +366,22 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
   // posX = Debug::printf(posX, posY, "T:%d", triCount) + 8;
   Debug::printf(posX-32, posY, "H:%dkb", heap_stats.used);
   Debug::printf(posX, posY+8, "O:%d\n", scene.getObjectCount());
+  Debug::printf(posX-32, posY+16, "D:%lu %.2f", scene.deleteCount, (double)TICKS_TO_US(scene.ticksDelete) / 1000.0);
+  // events: total / grown beyond initial capacity / dropped
+  Debug::printf(posX-32, posY+24, "E:%lu/%lu/%lu", scene.eventCount, scene.eventOverflowCount, scene.eventDroppedCount);
+  // streamed chunks: loaded / total
+  if(scene.getChunkCount()) {
+    Debug::printf(posX-32, posY+32, "C:%lu/%lu", scene.getLoadedChunkCount(), scene.getChunkCount());
+  }
+  // constraints: count / time of the pass
+  if(scene.getComponentCount(P64::Comp::Constraint::ID)) {
+    auto ms = (double)TICKS_TO_US(scene.ticksConstraints) / 1000.0;
+    Debug::printf(posX-32, posY+48, "K:%lu %.2f", scene.getComponentCount(P64::Comp::Constraint::ID), ms);
+  }
+  // debug lines: drawn / dropped over budget
+  if(showCollMesh || showCollBCS) {
+    Debug::printf(posX-32, posY+40, "L:%lu/%lu", Debug::getLineCount(), Debug::getDroppedCount());
+  }
 
   posX = 24;
 
@@ -264,17 +404,126 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
     posY += 8;
   }
 
+#if P64_COMP_PROFILE
+  // per component-type timings (update / draw) and how often each was called
+  if(compTimeMode != 0)
+  {
+    uint8_t order[P64::COMP_TABLE_SIZE];
+    std::copy(std::begin(P64::COMP_DISPATCH_ORDER), std::end(P64::COMP_DISPATCH_ORDER), order);
+    if(compTimeMode == 2) {
+      std::stable_sort(std::begin(order), std::end(order), [&scene](uint8_t a, uint8_t b) {
+        return (scene.ticksCompUpdate[a] + scene.ticksCompDraw[a]) > (scene.ticksCompUpdate[b] + scene.ticksCompDraw[b]);
+      });
+    }
+
+    posX = 100;
+    posY = 50;
+    Debug::printf(posX, posY, "Comp Cnt #Up   Upd #Dr  Draw");
+    posY += 8;
+    for(auto compId : order)
+    {
+      uint32_t count = scene.getComponentCount(compId);
+      if(count == 0)continue;
+      Debug::printf(posX, posY, "%-5s%3lu%4u%6.2f%4u%6.2f", COMP_NAMES[compId], count,
+        (unsigned)scene.callsCompUpdate[compId], (double)TICKS_TO_US(scene.ticksCompUpdate[compId]) / 1000.0,
+        (unsigned)scene.callsCompDraw[compId], (double)TICKS_TO_US(scene.ticksCompDraw[compId]) / 1000.0
+      );
+      posY += 8;
+    }
+  }
+#endif
+
+  // tracked memory per category, in kb
+  if(showMemBudget)
+  {
+    posX = 100;
+    posY = 50;
+    Debug::printf(posX, posY, "Mem     Curr  Peak");
+    posY += 8;
+    for(uint32_t c=0; c<(uint32_t)P64::Mem::Category::COUNT; ++c)
+    {
+      auto cat = (P64::Mem::Category)c;
+      Debug::printf(posX, posY, "%-6s %5lu %5lu", P64::Mem::getCategoryName(cat),
+        P64::Mem::getTracked(cat) / 1024, P64::Mem::getTrackedPeak(cat) / 1024
+      );
+      posY += 8;
+    }
+    Debug::printf(posX, posY, "Heap   %5lu", P64::Mem::getHeapUsed() / 1024);
+    posY += 16;
+
+  #if P64_ALLOC_TRACK
+    // heap allocations of the last frame, per zone they happened in
+    auto allocTotal = AllocTracker::getFrameTotal();
+    Debug::printf(posX, posY, "Alloc %4lu %6lu Free %4lu", allocTotal.allocs, allocTotal.bytes, allocTotal.frees);
+    posY += 8;
+    for(uint32_t z=0; z<(uint32_t)Trace::Zone::COUNT; ++z)
+    {
+      auto &stats = AllocTracker::getFrameStats((Trace::Zone)z);
+      if(stats.allocs == 0 && stats.frees == 0)continue;
+      Debug::printf(posX, posY, " %-12s %3lu %6lu", Trace::ZONE_NAMES[z], stats.allocs, stats.bytes);
+      posY += 8;
+    }
+    posY += 8;
+  #endif
+
+    // command words per draw layer, capacity is 0 if the buffer grows on its own
+    Debug::printf(posX, posY, "Layer  Last   Avg  Peak   Cap");
+    posY += 8;
+    for(uint32_t l=1; l<=P64::DrawLayer::getBufferedCount(); ++l)
+    {
+      auto stats = P64::DrawLayer::getStats(l);
+      Debug::printf(posX, posY, "%-5lu %5lu %5lu %5lu %5lu", l, stats.words, stats.average, stats.peak, stats.capacity);
+      posY += 8;
+    }
+  }
+
+  // global script hooks, only the ones implemented by any script are called at all
+  if(showHookTime)
+  {
+    posX = 100;
+    posY = 50;
+    Debug::printf(posX, posY, "Hook        ms");
+    posY += 8;
+    for(uint32_t h=(uint32_t)P64::GlobalScript::HookType::SCENE_UPDATE; h<(uint32_t)P64::GlobalScript::HookType::_size_; ++h)
+    {
+      if(!(P64::GlobalScript::HOOK_MASK & (1u << h))) {
+        Debug::printf(posX, posY, "%-8s     -", HOOK_NAMES[h]);
+      } else {
+        Debug::printf(posX, posY, "%-8s %5.2f", HOOK_NAMES[h], (double)TICKS_TO_US(P64::GlobalScript::hookTicks[h]) / 1000.0);
+      }
+      posY += 8;
+    }
+  }
+
   // audio channels
   posX = 24;
   posY = SCREEN_HEIGHT - 24;
 
-  posX = Debug::printf(posX, posY, "CH (TODO)");
-  /*uint32_t audioMask = scene.getAudio().getActiveChannelMask();
-  for(int i=0; i<16; ++i) {
-    bool isActive = audioMask & (1 << i);
-    posX = Debug::printf(posX, posY, isActive ? "%d" : "-", i);
+  // mixing cost on the RSP scales with the output rate and the channels playing,
+  // shown as thousands of channel-samples mixed per second to compare scene settings
+  uint32_t audioMask = P64::AudioManager::getActiveChannelMask();
+  uint32_t audioActive = (uint32_t)__builtin_popcount(audioMask);
+  uint32_t audioRate = P64::AudioManager::getSampleRate();
+  posX = Debug::printf(posX, posY, "CH %lu/%lu %luHz Mix:%luk/s", audioActive,
+    P64::AudioManager::getChannelCount(), audioRate, audioActive * audioRate / 1000
+  );
+
+  // post-processing cost, only measured while shown since it stalls the RSP/RDP
+  P64::Renderer::HDR::setMeasurePerf(showBloomTime);
+  if(showBloomTime && scene.getConf().pipeline == P64::SceneConf::Pipeline::HDR_BLOOM) {
+    posX = Debug::printf(posX + 8, posY, "Bloom:%.2fms", (double)P64::Renderer::HDR::getPerfTimeUs() / 1000.0);
+  }
+
+  // texture application split, slices on the RSP and the time the CPU spent on the rest
+  if(auto bigTex = scene.getRenderPipeline<P64::RenderPipelineBigTex>()) {
+    posX = Debug::printf(posX + 8, posY, "Tex RSP:%lu CPU:%.2fms", bigTex->rspSliceCount,
+      (double)TICKS_TO_US(bigTex->ticksTexCPU) / 1000.0
+    );
+    auto &tex = bigTex->textures;
+    if(tex.getTextureCount() > tex.getPageCount()) {
+      posX = Debug::printf(posX + 8, posY, "Pg:%lu/%lu In:%lu", tex.getPageCount(), tex.getTextureCount(), tex.getPageInCount());
+    }
   }
-*/
 
   // Matrix slots
   if(matrixDebug)
@@ -282,21 +531,44 @@ void Debug::Overlay::draw(P64::Scene &scene, surface_t* surf)
     posX = 100;
     posY = 50;
 
-    for(uint32_t f=0; f<3; ++f) {
+    for(uint32_t f=0; f<P64::VI::SwapChain::getFrameBufferCount(); ++f) {
       Debug::printf(posX, posY, "Color[%ld]: %p\n", f, P64::VI::SwapChain::getFrameBuffer(f)->buffer);
       posY += 8;
     }
 
     posY = 90;
-    uint32_t matCount = P64::MatrixManager::getTotalCapacity();
-    for(uint32_t i=0; i<matCount; ++i) {
-      bool isUsed = P64::MatrixManager::isUsed(i);
-      Debug::printf(posX, posY, "%c", isUsed ? '+' : '.');
-      posX += 6;
-      if(i % 32 == 31) {
-        posX = 100;
-        posY += 8;
-      }
+    Debug::printf(posX, posY, "Mat: %lu/%lu (max: %lu)\n",
+      P64::MatrixManager::getUsedCount(),
+      P64::MatrixManager::getAllocatedCount(),
+      P64::MatrixManager::getTotalCapacity()
+    );
+    posY += 8;
+    Debug::printf(posX, posY, "Peak: %lu\n", P64::MatrixManager::getHighWaterMark());
+    posY += 8;
+    Debug::printf(posX, posY, "Frame: %lu/%lu (peak: %lu)\n",
+      P64::FrameMatrices::getUsedCount(),
+      P64::FrameMatrices::getCapacity(),
+      P64::FrameMatrices::getHighWaterMark()
+    );
+    posY += 8;
+    Debug::printf(posX, posY, "Built: %lu (RSP: %lu)\n",
+      P64::MatrixBatch::getCount(),
+      P64::MatrixBatch::getCountRSP()
+    );
+    posY += 8;
+    Debug::printf(posX, posY, "2D: %lu (loads: %lu, modes: %lu)\n",
+      P64::Batch2D::getDrawCount(),
+      P64::Batch2D::getLoadCount(),
+      P64::Batch2D::getModeCount()
+    );
+
+    static std::vector<P64::Comp::AnimModel::SkeletonStats> skelStats{};
+    P64::Comp::AnimModel::getSkeletonStats(skelStats);
+    for(auto &stats : skelStats) {
+      posY += 8;
+      Debug::printf(posX, posY, "Skel: %lu inst, %lu anims, %lukb\n",
+        stats.instances, stats.animCount, stats.byteSize / 1024
+      );
     }
   }
 
@@ -0,0 +1,152 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "debug/trace.h"
+
+#if P64_TRACE
+#include "vi/swapChain.h"
+#include "lib/memory.h"
+
+namespace
+{
+  using namespace Debug::Trace;
+
+  enum class Type : uint8_t { BEGIN, END, COUNTER };
+
+  struct Event
+  {
+    uint32_t ticks;
+    uint32_t value; // counters only
+    Type type;
+    uint8_t id;     // zone or counter
+    uint8_t arg;
+    uint8_t padding;
+  };
+  static_assert(sizeof(Event) == 12);
+  static_assert((EVENT_COUNT & (EVENT_COUNT-1)) == 0);
+
+  constexpr const char* COUNTER_NAMES[(uint32_t)Counter::COUNT] {
+    "RDP-Busy (us)", "CPU-Wait (us)", "Heap (KB)", "Objects"
+  };
+
+  constinit Event events[EVENT_COUNT]{};
+  constinit uint32_t writePos{0};
+  constinit uint32_t eventCount{0};
+  constinit bool recording{true};
+  constinit bool frameOpen{false};
+
+  void push(Type type, uint8_t id, uint8_t arg, uint32_t value)
+  {
+    if(!recording)return;
+    events[writePos] = {get_ticks(), value, type, id, arg, 0};
+    writePos = (writePos + 1) & (EVENT_COUNT-1);
+    if(eventCount < EVENT_COUNT)++eventCount;
+  }
+}
+
+namespace Debug::Trace
+{
+  void begin(Zone zone, uint8_t arg) {
+    push(Type::BEGIN, (uint8_t)zone, arg, 0);
+  }
+
+  void end(Zone zone) {
+    push(Type::END, (uint8_t)zone, NO_ARG, 0);
+  }
+
+  void counter(Counter cnt, uint32_t value) {
+    push(Type::COUNTER, (uint8_t)cnt, NO_ARG, value);
+  }
+
+  void frame()
+  {
+    if(frameOpen)end(Zone::FRAME);
+    begin(Zone::FRAME);
+    frameOpen = recording;
+
+    const auto &stats = P64::VI::SwapChain::getFrameStats();
+    const auto &last = stats[stats.size()-1];
+    counter(Counter::RDP_BUSY_US, last.rdpBusyUs);
+    counter(Counter::CPU_WAIT_US, last.cpuWaitUs);
+    counter(Counter::HEAP_KB, P64::Mem::getHeapUsed() / 1024);
+  }
+
+  void start() {
+    writePos = 0;
+    eventCount = 0;
+    frameOpen = false;
+    recording = true;
+  }
+
+  void stop() {
+    recording = false;
+    frameOpen = false;
+  }
+
+  bool isRecording() {
+    return recording;
+  }
+
+  void dump()
+  {
+    bool wasRecording = recording;
+    recording = false;
+
+    uint32_t startIdx = (writePos - eventCount) & (EVENT_COUNT-1);
+    auto getEvent = [&](uint32_t i) -> const Event& {
+      return events[(startIdx + i) & (EVENT_COUNT-1)];
+    };
+
+    // older events got overwritten, start at the first complete frame to keep all zones balanced
+    uint32_t i = 0;
+    while(i < eventCount && !(getEvent(i).type == Type::BEGIN && getEvent(i).id == (uint8_t)Zone::FRAME))++i;
+
+    debugf("%s\n", TRACE_MARKER_BEGIN);
+    debugf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+    // ticks wrap around every ~90 seconds, so only the deltas are accumulated
+    uint64_t timeTicks = 0;
+    uint32_t lastTicks = i < eventCount ? getEvent(i).ticks : 0;
+    const char* sep = "";
+
+    for(; i<eventCount; ++i)
+    {
+      const auto &ev = getEvent(i);
+      timeTicks += ev.ticks - lastTicks;
+      lastTicks = ev.ticks;
+      double ts = (double)timeTicks * 1'000'000.0 / (double)TICKS_PER_SECOND;
+
+      switch(ev.type)
+      {
+        case Type::BEGIN:
+          if(ev.arg == NO_ARG) {
+            debugf("%s{\"ph\":\"B\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":0}\n",
+              sep, ZONE_NAMES[ev.id], ts);
+          } else {
+            debugf("%s{\"ph\":\"B\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":0,\"args\":{\"id\":%d}}\n",
+              sep, ZONE_NAMES[ev.id], ts, ev.arg);
+          }
+        break;
+        case Type::END:
+          debugf("%s{\"ph\":\"E\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":0,\"tid\":0}\n",
+            sep, ZONE_NAMES[ev.id], ts);
+        break;
+        case Type::COUNTER:
+          debugf("%s{\"ph\":\"C\",\"name\":\"%s\",\"ts\":%.3f,\"pid\":0,\"args\":{\"value\":%lu}}\n",
+            sep, COUNTER_NAMES[ev.id], ts, ev.value);
+        break;
+      }
+      sep = ",";
+    }
+
+    debugf("]}\n");
+    debugf("%s\n", TRACE_MARKER_END);
+
+    writePos = 0;
+    eventCount = 0;
+    frameOpen = false;
+    recording = wasRecording;
+  }
+}
+#endif
@@ -0,0 +1,142 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "lib/arena.h"
+#include "lib/math.h"
+#include <malloc.h>
+
+namespace
+{
+  // allocations in the pool are prefixed by a header storing the size-class,
+  // this keeps the data itself 8-byte aligned
+  constexpr uint32_t POOL_HEADER_SIZE = 8;
+}
+
+void P64::Mem::Arena::init(uint32_t size)
+{
+  destroy();
+  size = Math::alignUp(size, ALIGN);
+  if(size == 0)return;
+
+  base = (uint8_t*)memalign(ALIGN, size);
+  assertf(base, "Arena: failed to allocate %lu bytes", size);
+  capacity = size;
+  used = 0;
+}
+
+void P64::Mem::Arena::adopt(void* block, uint32_t size)
+{
+  destroy();
+  assertf(((uint32_t)block % ALIGN) == 0, "Arena: block %p not aligned", block);
+  base = (uint8_t*)block;
+  capacity = size;
+  used = 0;
+}
+
+void P64::Mem::Arena::trim()
+{
+  if(!base)return;
+  [[maybe_unused]] void* res = realloc(base, capacity);
+  assertf(res == base, "Arena: block moved while shrinking");
+}
+
+void P64::Mem::Arena::destroy()
+{
+  if(base)::free(base);
+  base = nullptr;
+  capacity = 0;
+  used = 0;
+}
+
+void* P64::Mem::Arena::alloc(uint32_t size)
+{
+  size = Math::alignUp(size, ALIGN);
+  if(used + size > capacity)return nullptr;
+
+  void* res = base + used;
+  used += size;
+  return res;
+}
+
+void P64::Mem::Pool::init(uint32_t size)
+{
+  destroy();
+  poolSize = size;
+}
+
+void P64::Mem::Pool::destroy()
+{
+  arena.destroy();
+  for(auto &list : freeList)list = nullptr;
+}
+
+void* P64::Mem::Pool::alloc(uint32_t size)
+{
+  size += POOL_HEADER_SIZE;
+
+  uint8_t sizeClass = 0;
+  uint32_t classSize = CLASS_MIN_SIZE;
+  while(classSize < size && sizeClass < CLASS_COUNT) {
+    classSize <<= 1;
+    ++sizeClass;
+  }
+
+  uint8_t *mem = nullptr;
+  if(sizeClass < CLASS_COUNT)
+  {
+    if(freeList[sizeClass]) {
+      mem = (uint8_t*)freeList[sizeClass];
+      freeList[sizeClass] = freeList[sizeClass]->next;
+    } else {
+      if(arena.getCapacity() == 0 && poolSize != 0)arena.init(poolSize);
+      mem = (uint8_t*)arena.alloc(classSize);
+    }
+  }
+
+  if(!mem) {
+    mem = (uint8_t*)memalign(Arena::ALIGN, size);
+    assertf(mem, "Pool: failed to allocate %lu bytes", size);
+    sizeClass = CLASS_HEAP;
+  }
+
+  mem[0] = sizeClass;
+  return mem + POOL_HEADER_SIZE;
+}
+
+void P64::Mem::Pool::free(void* ptr)
+{
+  if(!ptr)return;
+  uint8_t *mem = (uint8_t*)ptr - POOL_HEADER_SIZE;
+  uint8_t sizeClass = mem[0];
+
+  if(sizeClass == CLASS_HEAP) {
+    ::free(mem);
+    return;
+  }
+
+  auto block = (FreeBlock*)mem;
+  block->next = freeList[sizeClass];
+  freeList[sizeClass] = block;
+}
+
+void P64::Mem::Pool::recycle(void* mem, uint32_t size)
+{
+  auto ptr = (uint8_t*)mem;
+  while(size >= CLASS_MIN_SIZE)
+  {
+    uint8_t sizeClass = CLASS_COUNT-1;
+    uint32_t classSize = CLASS_MIN_SIZE << sizeClass;
+    while(classSize > size) {
+      classSize >>= 1;
+      --sizeClass;
+    }
+
+    auto block = (FreeBlock*)ptr;
+    block->next = freeList[sizeClass];
+    freeList[sizeClass] = block;
+
+    ptr += classSize;
+    size -= classSize;
+  }
+}
@@ -0,0 +1,105 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "lib/logger.h"
+
+namespace
+{
+  constexpr uint32_t BUFFER_SIZE = 4096;
+  constexpr uint32_t RECORD_ALIGN = alignof(P64::Log::Record);
+
+  constexpr const char* const PREFIXES[] = {"", PREFIX_ERROR, PREFIX_WARN, PREFIX_INFO};
+
+  // records are never split, if one doesn't fit at the end, the rest is skipped and it starts again at 0.
+  // 'wrapPos' marks where that happened, so reading knows where to jump back
+  alignas(RECORD_ALIGN) constinit uint8_t buffer[BUFFER_SIZE]{};
+  constinit uint32_t readPos{0};
+  constinit uint32_t writePos{0};
+  constinit uint32_t wrapPos{BUFFER_SIZE};
+  constinit uint32_t usedSize{0}; // incl. the skipped end before a wrap
+  constinit uint32_t droppedCount{0};
+
+  constexpr uint32_t getRecordSize(uint32_t argSize) {
+    return (sizeof(P64::Log::Record) + argSize + RECORD_ALIGN - 1) & ~(RECORD_ALIGN - 1);
+  }
+}
+
+void P64::Log::printHeader(Level level, const char* file, uint32_t line)
+{
+  debugf("%s [%s:%lu] ", PREFIXES[(uint32_t)level], file, line);
+}
+
+void P64::Log::printFooter()
+{
+  debugf(RESET_SUFFIX);
+}
+
+uint8_t* P64::Log::pushRecord(const Record &rec)
+{
+  uint32_t size = getRecordSize(rec.argSize);
+
+  disable_interrupts();
+  uint32_t pos = writePos;
+  uint32_t skipped = 0;
+  if(pos + size > BUFFER_SIZE) { // wrap around
+    skipped = BUFFER_SIZE - pos;
+    pos = 0;
+  }
+  if(usedSize + skipped + size > BUFFER_SIZE) {
+    ++droppedCount;
+    enable_interrupts();
+    return nullptr;
+  }
+
+  if(skipped)wrapPos = writePos;
+  writePos = pos + size;
+  usedSize += skipped + size;
+  enable_interrupts();
+
+  memcpy(buffer + pos, &rec, sizeof(Record));
+  return buffer + pos + sizeof(Record);
+}
+
+void P64::Log::flush()
+{
+  // only the main-loop reads, so the records can be printed without holding up 'pushRecord'
+  while(usedSize)
+  {
+    uint32_t pos = readPos;
+    if(pos >= wrapPos) {
+      disable_interrupts();
+        usedSize -= BUFFER_SIZE - pos;
+        wrapPos = BUFFER_SIZE;
+      enable_interrupts();
+      readPos = pos = 0;
+      if(!usedSize)break;
+    }
+
+    auto rec = (const Record*)(buffer + pos);
+    rec->format(*rec, buffer + pos + sizeof(Record));
+
+    uint32_t size = getRecordSize(rec->argSize);
+    readPos = pos + size;
+    disable_interrupts();
+      usedSize -= size;
+    enable_interrupts();
+  }
+
+  disable_interrupts();
+    if(!usedSize) { // start at 0 again, to not wrap more often than needed
+      readPos = writePos = 0;
+      wrapPos = BUFFER_SIZE;
+    }
+  enable_interrupts();
+
+  if(droppedCount) {
+    debugf(PREFIX_WARN " %lu log messages dropped, buffer full" RESET_SUFFIX, droppedCount);
+    droppedCount = 0;
+  }
+}
+
+uint32_t P64::Log::getDroppedCount()
+{
+  return droppedCount;
+}
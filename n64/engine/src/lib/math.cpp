@@ -31,3 +31,76 @@ fm_quat_t P64::Math::unpackQuat(uint32_t quatPacked)
 
   return q;
 }
+
+void P64::Math::quatRotate(const fm_quat_t &q, const fm_vec3_t *in, fm_vec3_t *out, uint32_t count)
+{
+  // quaternion is loaded once, 2x unrolled to hide the FPU latency of the dependent sums
+  const float qx = q.x, qy = q.y, qz = q.z, qw = q.w;
+  uint32_t i = 0;
+  for(; i+1 < count; i += 2)
+  {
+    fm_vec3_t a = in[i];
+    fm_vec3_t b = in[i+1];
+
+    float tax = 2.0f * (qy * a.z - qz * a.y);
+    float tay = 2.0f * (qz * a.x - qx * a.z);
+    float taz = 2.0f * (qx * a.y - qy * a.x);
+    float tbx = 2.0f * (qy * b.z - qz * b.y);
+    float tby = 2.0f * (qz * b.x - qx * b.z);
+    float tbz = 2.0f * (qx * b.y - qy * b.x);
+
+    out[i] = fm_vec3_t{{
+      a.x + qw * tax + (qy * taz - qz * tay),
+      a.y + qw * tay + (qz * tax - qx * taz),
+      a.z + qw * taz + (qx * tay - qy * tax)
+    }};
+    out[i+1] = fm_vec3_t{{
+      b.x + qw * tbx + (qy * tbz - qz * tby),
+      b.y + qw * tby + (qz * tbx - qx * tbz),
+      b.z + qw * tbz + (qx * tby - qy * tbx)
+    }};
+  }
+  if(i < count)out[i] = quatRotate(q, in[i]);
+}
+
+void P64::Math::intoLocalSpace(const fm_quat_t &invRot, const fm_vec3_t &invScale, const fm_vec3_t &pos,
+  const fm_vec3_t *in, fm_vec3_t *out, uint32_t count)
+{
+  for(uint32_t i=0; i<count; ++i) {
+    out[i] = quatRotate(invRot, in[i] - pos) * invScale;
+  }
+}
+
+void P64::Math::outOfLocalSpace(const fm_quat_t &rot, const fm_vec3_t &scale, const fm_vec3_t &pos,
+  const fm_vec3_t *in, fm_vec3_t *out, uint32_t count)
+{
+  for(uint32_t i=0; i<count; ++i) {
+    out[i] = quatRotate(rot, in[i] * scale) + pos;
+  }
+}
+
+uint32_t P64::Math::aabbOverlapMask(const fm_vec3_t &min, const fm_vec3_t &max,
+  const fm_vec3_t *mins, const fm_vec3_t *maxs, uint32_t count)
+{
+  assert(count <= 32);
+  uint32_t mask = 0;
+  for(uint32_t i=0; i<count; ++i) {
+    mask |= (uint32_t)aabbOverlap(min, max, mins[i], maxs[i]) << i;
+  }
+  return mask;
+}
+
+uint32_t P64::Math::sphereVsAABBMask(const fm_vec3_t &center, float radius,
+  const fm_vec3_t *mins, const fm_vec3_t *maxs, uint32_t count)
+{
+  assert(count <= 32);
+  float radius2 = radius * radius;
+  uint32_t mask = 0;
+  for(uint32_t i=0; i<count; ++i) {
+    float dx = center.x - clamp(center.x, mins[i].x, maxs[i].x);
+    float dy = center.y - clamp(center.y, mins[i].y, maxs[i].y);
+    float dz = center.z - clamp(center.z, mins[i].z, maxs[i].z);
+    mask |= (uint32_t)((dx*dx + dy*dy + dz*dz) <= radius2) << i;
+  }
+  return mask;
+}
@@ -4,59 +4,201 @@
 */
 #include "lib/matrixManager.h"
 #include "lib/logger.h"
+#include "lib/memory.h"
 #include "lib/types.h"
+#include <vector>
 
 namespace {
-  constexpr uint32_t MATRIX_COUNT = 128 * 3;
-  static_assert(MATRIX_COUNT % 32 == 0);
+  // matrices are allocated in pages on demand, up to the capacity set by the scene
+  constexpr uint32_t PAGE_SIZE = 96;
+  constexpr uint32_t DEFAULT_CAPACITY = 128 * 3 * 4;
 
-  uint32_t usedFlags[MATRIX_COUNT / 32]{};
-  uint32_t laseIndex = 0;
-  T3DMat4FP *bufferPtr{nullptr};
+  // blocks are rounded up to a power of two (1, 2, 4 ... 32 matrices)
+  constexpr uint32_t CLASS_COUNT = 6;
+  constexpr uint32_t MAX_BLOCK_SIZE = 1 << (CLASS_COUNT-1);
+  static_assert(PAGE_SIZE >= MAX_BLOCK_SIZE);
 
-  T3DMat4FP buffer[MATRIX_COUNT]{}; // mask of used matrices, each bit represents one matrix
+  std::vector<T3DMat4FP*> pages{};
+  // free blocks per size-class, kept outside the matrices since the RSP may still read them
+  std::vector<T3DMat4FP*> freeList[CLASS_COUNT]{};
+
+  T3DMat4FP *pageCurr{nullptr};
+  uint32_t pageUsed{PAGE_SIZE};
+
+  uint32_t capacity{DEFAULT_CAPACITY};
+  uint32_t usedCount{0};
+  uint32_t highWaterMark{0};
+
+  constexpr uint32_t FRAME_DEFAULT_CAPACITY = 64;
+
+  T3DMat4FP *frameMem{nullptr};
+  uint32_t frameCapacity{FRAME_DEFAULT_CAPACITY};
+  uint32_t frameUsed{0};
+  uint32_t frameHighWaterMark{0};
+  uint8_t frameIdx{0};
+
+  uint32_t getSizeClass(uint32_t count) {
+    uint32_t sizeClass = 0;
+    while((1u << sizeClass) < count)++sizeClass;
+    return sizeClass;
+  }
+
+  // hands the unused end of the current page over to the free-lists
+  void recycleRestOfPage()
+  {
+    while(pageUsed < PAGE_SIZE) {
+      uint32_t sizeClass = CLASS_COUNT-1;
+      while((1u << sizeClass) > (PAGE_SIZE - pageUsed))--sizeClass;
+      freeList[sizeClass].push_back(pageCurr + pageUsed);
+      pageUsed += 1 << sizeClass;
+    }
+  }
+
+  // splits a free block of a larger class, returns nullptr if there is none
+  T3DMat4FP* splitLargerBlock(uint32_t sizeClass)
+  {
+    for(uint32_t c = sizeClass+1; c < CLASS_COUNT; ++c)
+    {
+      if(freeList[c].empty())continue;
+      auto block = freeList[c].back();
+      freeList[c].pop_back();
+
+      // upper halves go back into the lists, the lowest part is returned
+      while(c > sizeClass) {
+        --c;
+        freeList[c].push_back(block + (1 << c));
+      }
+      return block;
+    }
+    return nullptr;
+  }
 }
 
 void P64::MatrixManager::reset() {
-  data_cache_hit_writeback(buffer, sizeof(buffer));
-  bufferPtr = unached(buffer);
-  laseIndex = 0;
-  memset(usedFlags, 0, sizeof(usedFlags));
+  for(auto page : pages)free_uncached(page);
+  Mem::track(Mem::Category::MATRICES, -(int32_t)(pages.size() * PAGE_SIZE * sizeof(T3DMat4FP)));
+  pages.clear();
+  for(auto &list : freeList)list.clear();
+
+  pageCurr = nullptr;
+  pageUsed = PAGE_SIZE;
+  usedCount = 0;
+  highWaterMark = 0;
+}
+
+void P64::MatrixManager::setCapacity(uint32_t count) {
+  capacity = count ? count : DEFAULT_CAPACITY;
 }
 
 T3DMat4FP *P64::MatrixManager::alloc(uint32_t count) {
-  uint32_t countMask = (1 << count) - 1;
-  for(uint32_t i=0; i<MATRIX_COUNT/32; ++i) {
-    uint32_t idx = (laseIndex + i) % (MATRIX_COUNT / 32);
+  assertf(count != 0 && count <= MAX_BLOCK_SIZE, "MatrixManager: invalid block size %lu", count);
 
-    // we only consider contiguous blocks of free matrices
-    for(uint32_t b=0; b<32-count; ++b)
+  uint32_t sizeClass = getSizeClass(count);
+  uint32_t blockSize = 1 << sizeClass;
+  T3DMat4FP *res{nullptr};
+
+  auto &list = freeList[sizeClass];
+  if(!list.empty()) {
+    res = list.back();
+    list.pop_back();
+  } else {
+    if(pageUsed + blockSize > PAGE_SIZE)
     {
-      uint32_t mask = countMask << b;
-      if((usedFlags[idx] & mask) == 0) {
-        usedFlags[idx] |= mask;
-        laseIndex = idx;
-        return bufferPtr + (idx * 32 + b);
+      res = splitLargerBlock(sizeClass);
+      if(!res) {
+        if((pages.size() + 1) * PAGE_SIZE > capacity) {
+          Log::error("MatrixManager: Out of matrices! (capacity: %lu)", capacity);
+          return nullptr;
+        }
+        recycleRestOfPage();
+        pageCurr = (T3DMat4FP*)malloc_uncached(PAGE_SIZE * sizeof(T3DMat4FP));
+        assertf(pageCurr, "MatrixManager: failed to allocate page");
+        pages.push_back(pageCurr);
+        Mem::track(Mem::Category::MATRICES, PAGE_SIZE * sizeof(T3DMat4FP));
+        pageUsed = 0;
       }
     }
+
+    if(!res) {
+      res = pageCurr + pageUsed;
+      pageUsed += blockSize;
+    }
   }
 
-  Log::error("MatrixManager: Out of matrices!");
-  return nullptr;
+  usedCount += blockSize;
+  if(usedCount > highWaterMark)highWaterMark = usedCount;
+  return res;
 }
 
 void P64::MatrixManager::free(T3DMat4FP *mat, uint32_t count) {
-  uint32_t idx = (mat - bufferPtr) / 32;
-  uint32_t countMask = (1 << count) - 1;
-  uint32_t b = (mat - bufferPtr) % 32;
-  usedFlags[idx] &= ~(countMask << b);
+  if(!mat)return;
+  uint32_t sizeClass = getSizeClass(count);
+  freeList[sizeClass].push_back(mat);
+  usedCount -= 1 << sizeClass;
 }
 
-bool P64::MatrixManager::isUsed(uint32_t index) {
-  return usedFlags[index / 32] & (1 << (index % 32));
+uint32_t P64::MatrixManager::getTotalCapacity() {
+  return capacity;
 }
 
-uint32_t P64::MatrixManager::getTotalCapacity() {
-  return MATRIX_COUNT;
+uint32_t P64::MatrixManager::getAllocatedCount() {
+  return pages.size() * PAGE_SIZE;
 }
 
+uint32_t P64::MatrixManager::getUsedCount() {
+  return usedCount;
+}
+
+uint32_t P64::MatrixManager::getHighWaterMark() {
+  return highWaterMark;
+}
+
+void P64::FrameMatrices::init(uint32_t count) {
+  destroy();
+  frameCapacity = count ? count : FRAME_DEFAULT_CAPACITY;
+}
+
+void P64::FrameMatrices::destroy() {
+  if(frameMem) {
+    free_uncached(frameMem);
+    Mem::track(Mem::Category::MATRICES, -(int32_t)(frameCapacity * BUFFER_COUNT * sizeof(T3DMat4FP)));
+  }
+  frameMem = nullptr;
+  frameUsed = 0;
+  frameHighWaterMark = 0;
+}
+
+void P64::FrameMatrices::nextFrame() {
+  frameIdx = (frameIdx + 1) % BUFFER_COUNT;
+  frameUsed = 0;
+}
+
+T3DMat4FP *P64::FrameMatrices::alloc(uint32_t count) {
+  if(frameUsed + count > frameCapacity) {
+    Log::error("FrameMatrices: Out of matrices! (%lu per frame)", frameCapacity);
+    return nullptr;
+  }
+
+  if(!frameMem) {
+    frameMem = (T3DMat4FP*)malloc_uncached(frameCapacity * BUFFER_COUNT * sizeof(T3DMat4FP));
+    assertf(frameMem, "FrameMatrices: failed to allocate %lu matrices", frameCapacity * BUFFER_COUNT);
+    Mem::track(Mem::Category::MATRICES, frameCapacity * BUFFER_COUNT * sizeof(T3DMat4FP));
+  }
+
+  auto res = frameMem + (frameIdx * frameCapacity) + frameUsed;
+  frameUsed += count;
+  if(frameUsed > frameHighWaterMark)frameHighWaterMark = frameUsed;
+  return res;
+}
+
+uint32_t P64::FrameMatrices::getUsedCount() {
+  return frameUsed;
+}
+
+uint32_t P64::FrameMatrices::getHighWaterMark() {
+  return frameHighWaterMark;
+}
+
+uint32_t P64::FrameMatrices::getCapacity() {
+  return frameCapacity;
+}
@@ -3,49 +3,96 @@
 * @license MIT
 */
 #include "lib/memory.h"
+#include "lib/logger.h"
 
 extern "C" {
   void* sbrk_top(int incr);
 }
 
 namespace {
-  surface_t surfDepth{};
+  void* topBlock{nullptr};
+  uint32_t topSize{0};
   bool usedAlloc{false};
 
   heap_stats_t heapStats{};
+
+  constexpr uint32_t CATEGORY_COUNT = (uint32_t)P64::Mem::Category::COUNT;
+
+  constexpr const char* CATEGORY_NAMES[CATEGORY_COUNT] {
+    "Image", "Audio", "Font", "Model", "Asset", "Matrix", "Layer", "Ptx", "Object", "Render"
+  };
+
+  constinit uint32_t trackedSize[CATEGORY_COUNT]{};
+  constinit uint32_t trackedPeak[CATEGORY_COUNT]{};
 }
 
 namespace P64::Mem
 {
-  surface_t& allocDepthBuffer(uint32_t width, uint32_t height)
+  void* allocTop(uint32_t size)
   {
-    if(!surfDepth.buffer || surfDepth.width != width || surfDepth.height != height)
-    {
-      freeDepthBuffer();
-      void *buf = sbrk_top(width * height * 2);
-      if((int)buf == -1) {
-        surfDepth = surface_alloc(FMT_RGBA16, width, height);
-        usedAlloc = true;
-      } else {
-        data_cache_hit_invalidate(buf, width * height * 2);
-        surfDepth = surface_make(UncachedAddr(buf), FMT_RGBA16, width, height, width*2);
-        usedAlloc = false;
-      }
+    assertf(!topBlock, "Mem: top block already allocated");
+    size = (size + 63) & ~63;
+    void *buf = sbrk_top(size);
+    if((int)buf == -1) {
+      topBlock = malloc_uncached_aligned(64, size);
+      assertf(topBlock, "Mem: failed to allocate %lu bytes", size);
+      usedAlloc = true;
+    } else {
+      data_cache_hit_invalidate(buf, size);
+      topBlock = UncachedAddr(buf);
+      usedAlloc = false;
     }
-
-    return surfDepth;
+    topSize = size;
+    return topBlock;
   }
 
-  void freeDepthBuffer()
+  void freeTop()
   {
-    if(surfDepth.buffer) {
+    if(topBlock) {
       if(usedAlloc) {
-        surface_free(&surfDepth);
+        free_uncached(topBlock);
       } else {
-        sbrk_top(-(surfDepth.width * surfDepth.height * 2));
+        sbrk_top(-(int)topSize);
       }
     }
-    surfDepth.buffer = nullptr;
+    topBlock = nullptr;
+    topSize = 0;
+  }
+
+  void track(Category cat, int32_t bytes)
+  {
+    auto &size = trackedSize[(uint32_t)cat];
+    size = (bytes < 0 && (uint32_t)-bytes > size) ? 0 : (size + bytes);
+    if(size > trackedPeak[(uint32_t)cat])trackedPeak[(uint32_t)cat] = size;
+  }
+
+  uint32_t getTracked(Category cat) {
+    return trackedSize[(uint32_t)cat];
+  }
+
+  uint32_t getTrackedPeak(Category cat) {
+    return trackedPeak[(uint32_t)cat];
+  }
+
+  const char* getCategoryName(Category cat) {
+    return CATEGORY_NAMES[(uint32_t)cat];
+  }
+
+  void logTracked()
+  {
+    heap_stats_t stats;
+    sys_get_heap_stats(&stats);
+    Log::info("Memory: heap %d / %d bytes", stats.used, stats.total);
+    for(uint32_t c=0; c<CATEGORY_COUNT; ++c) {
+      Log::info("  %-6s: %8lu (peak: %8lu)", CATEGORY_NAMES[c], trackedSize[c], trackedPeak[c]);
+    }
+  }
+
+  uint32_t getHeapUsed()
+  {
+    heap_stats_t stats;
+    sys_get_heap_stats(&stats);
+    return stats.used;
   }
 
   int32_t getHeapDiff()
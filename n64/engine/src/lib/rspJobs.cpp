@@ -0,0 +1,110 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "lib/rspJobs.h"
+#include <libdragon.h>
+
+extern "C" {
+  DEFINE_RSP_UCODE(rsp_jobs);
+
+  // Some libdragon issues with C++ and namespaces
+  inline void rspq_write_3(uint32_t rspID, uint32_t cmd, uint32_t a, uint32_t b, uint32_t c) {
+    rspq_write(rspID, cmd, a, b, c);
+  }
+  inline void rspq_write_4(uint32_t rspID, uint32_t cmd, uint32_t a, uint32_t b, uint32_t c, uint32_t d) {
+    rspq_write(rspID, cmd, a, b, c, d);
+  }
+}
+
+namespace {
+  constexpr uint32_t CMD_TRANSFORM = 0x00;
+  constexpr uint32_t CMD_SPHERE_TRI = 0x01;
+
+  constinit uint32_t rspIdJobs{0};
+  constinit bool pending{false};
+
+  constinit uint32_t jobCountFrame{0};
+  constinit uint64_t waitTicksFrame{0};
+  constinit uint32_t jobCountLast{0};
+  constinit uint64_t waitTicksLast{0};
+
+  template<typename F>
+  void queueJob(F &&fnWrite)
+  {
+    if(!rspIdJobs)rspIdJobs = rspq_overlay_register(&rsp_jobs);
+    rspq_highpri_begin();
+    fnWrite();
+    rspq_highpri_end();
+    pending = true;
+    ++jobCountFrame;
+  }
+}
+
+void P64::RSPJobs::transform(const T3DMat4FP *mat, const Point *in, Point *out, uint32_t count)
+{
+  if(count == 0)return;
+  assert(((uint32_t)in & 7) == 0 && ((uint32_t)out & 7) == 0 && ((uint32_t)mat & 7) == 0);
+
+  data_cache_hit_writeback(mat, sizeof(T3DMat4FP));
+  if(out != in)data_cache_hit_writeback(in, sizeof(Point) * count);
+  // dirty lines could otherwise be written back over the results
+  data_cache_hit_writeback_invalidate(out, sizeof(Point) * count);
+
+  queueJob([&]() {
+    rspq_write_4(rspIdJobs, CMD_TRANSFORM,
+      PhysicalAddr(in), PhysicalAddr(out), count, PhysicalAddr(mat)
+    );
+  });
+}
+
+void P64::RSPJobs::sphereVsTri(const SphereTriBlock *in, SphereTriRes *out, uint32_t blockCount)
+{
+  if(blockCount == 0)return;
+
+  data_cache_hit_writeback(in, sizeof(SphereTriBlock) * blockCount);
+  data_cache_hit_writeback_invalidate(out, sizeof(SphereTriRes) * blockCount);
+
+  queueJob([&]() {
+    rspq_write_3(rspIdJobs, CMD_SPHERE_TRI, PhysicalAddr(in), PhysicalAddr(out), blockCount);
+  });
+}
+
+void P64::RSPJobs::sync()
+{
+  if(!pending)return;
+  uint64_t ticks = get_ticks();
+  rspq_flush();
+  rspq_highpri_sync();
+  waitTicksFrame += get_ticks() - ticks;
+  pending = false;
+}
+
+bool P64::RSPJobs::isPending() {
+  return pending;
+}
+
+void P64::RSPJobs::destroy()
+{
+  sync();
+  if(rspIdJobs) {
+    rspq_overlay_unregister(rspIdJobs);
+    rspIdJobs = 0;
+  }
+}
+
+uint32_t P64::RSPJobs::getJobCount() {
+  return jobCountLast;
+}
+
+uint32_t P64::RSPJobs::getWaitTimeUs() {
+  return TICKS_TO_US(waitTicksLast);
+}
+
+void P64::RSPJobs::nextFrame()
+{
+  jobCountLast = jobCountFrame;
+  waitTicksLast = waitTicksFrame;
+  jobCountFrame = 0;
+  waitTicksFrame = 0;
+}
@@ -12,11 +12,14 @@
 #include "scene/scene.h"
 #include "scene/sceneManager.h"
 #include "scene/globalState.h"
+#include "scene/quality.h"
 #include "./audio/audioManagerPrivate.h"
 #include "assets/assetManager.h"
 #include "libdragon/utils.h"
 #include "renderer/drawLayer.h"
 #include "script/globalScript.h"
+#include "debug/hotReload.h"
+#include "debug/inputReplay.h"
 
 P64::GlobalState P64::state{};
 
@@ -61,6 +64,7 @@ int main()
 
   P64::AssetManager::init();
   P64::AudioManager::init();
+  Debug::HotReload::init();
 
 	P64::Log::info("Starting Game");
 
@@ -90,15 +94,17 @@ int main()
   P64::DrawLayer::reset();
   P64::MatrixManager::reset();
   P64::VI::SwapChain::init();
+  P64::Quality::init();
 
   P64::GlobalScript::callHooks(P64::GlobalScript::HookType::GAME_INIT);
 
   P64::Log::info("Reset: %d\n", sys_reset_type());
-  P64::SceneManager::load(
+  // a recorded replay (if any) starts in the scene it was recorded in
+  P64::SceneManager::load(Debug::InputReplay::init(
     sys_reset_type() == RESET_COLD
       ? projectConf.sceneIdOnBoot
       : projectConf.sceneIdOnReset
-  );
+  ));
 
   for(;;)
   {
@@ -108,9 +114,10 @@ int main()
     }
 
     P64::SceneManager::run();
+    P64::Log::flush();
 
 	  P64::VI::SwapChain::drain();
 	  P64::SceneManager::unload();
-	  P64::Mem::freeDepthBuffer();
+	  P64::Mem::freeTop();
   }
 }
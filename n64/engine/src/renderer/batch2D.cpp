@@ -0,0 +1,194 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/batch2D.h"
+#include "renderer/drawLayer.h"
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+  enum class Mode : uint8_t
+  {
+    SPRITE_NONE,
+    SPRITE_MULTIPLY,
+    RECT_NONE,
+    RECT_MULTIPLY,
+    UNSET,
+  };
+
+  struct Entry
+  {
+    // sort key: layer, order, mode and then the texture
+    uint64_t key;
+    sprite_t *sprite;
+    float x0, y0, x1, y1;
+    uint16_t s, t, width, height;
+    color_t color;
+  };
+
+  constinit std::vector<Entry> *entries{nullptr};
+
+  constinit uint32_t countDraw{0};
+  constinit uint32_t countLoad{0};
+  constinit uint32_t countMode{0};
+
+  uint64_t makeKey(uint8_t layer, uint8_t order, Mode mode, sprite_t *sprite)
+  {
+    return ((uint64_t)layer << 56) | ((uint64_t)order << 48) | ((uint64_t)mode << 40)
+      | (uint64_t)(uintptr_t)sprite;
+  }
+
+  Entry& push()
+  {
+    if(!entries) {
+      entries = new std::vector<Entry>();
+      entries->reserve(64);
+    }
+    return entries->emplace_back();
+  }
+
+  bool fitsTMEM(sprite_t *sprite)
+  {
+    auto fmt = sprite_get_format(sprite);
+    bool halfTMEM = fmt == FMT_RGBA32 || fmt == FMT_CI4 || fmt == FMT_CI8;
+    uint32_t stride = (TEX_FORMAT_PIX2BYTES(fmt, sprite->width) + 7) & ~7;
+    return stride * sprite->height <= (halfTMEM ? 2048u : 4096u);
+  }
+
+  void setMode(Mode mode)
+  {
+    ++countMode;
+    bool isRect = mode == Mode::RECT_NONE || mode == Mode::RECT_MULTIPLY;
+    bool isBlend = mode == Mode::SPRITE_MULTIPLY || mode == Mode::RECT_MULTIPLY;
+
+    rdpq_mode_begin();
+      rdpq_mode_blender(isBlend ? RDPQ_BLENDER_MULTIPLY : 0);
+      rdpq_mode_alphacompare(isBlend ? 0 : 1);
+      if(isRect) {
+        rdpq_mode_combiner(RDPQ_COMBINER_FLAT);
+      } else {
+        rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,0,PRIM,0), (TEX0,0,PRIM,0)));
+      }
+    rdpq_mode_end();
+  }
+}
+
+void P64::Batch2D::sprite(sprite_t *sprite, float x, float y, const SpriteParams &params)
+{
+  auto mode = params.blend == Blend::NONE ? Mode::SPRITE_NONE : Mode::SPRITE_MULTIPLY;
+  uint16_t width = params.width ? params.width : sprite->width;
+  uint16_t height = params.height ? params.height : sprite->height;
+
+  auto &e = push();
+  e.key = makeKey(params.layer, params.order, mode, sprite);
+  e.sprite = sprite;
+  e.x0 = x;
+  e.y0 = y;
+  e.x1 = x + width * params.scaleX;
+  e.y1 = y + height * params.scaleY;
+  e.s = params.s;
+  e.t = params.t;
+  e.width = width;
+  e.height = height;
+  e.color = params.color;
+}
+
+void P64::Batch2D::rect(float x0, float y0, float x1, float y1, const RectParams &params)
+{
+  auto mode = params.blend == Blend::NONE ? Mode::RECT_NONE : Mode::RECT_MULTIPLY;
+  auto &e = push();
+  e = {};
+  e.key = makeKey(params.layer, params.order, mode, nullptr);
+  e.x0 = x0;
+  e.y0 = y0;
+  e.x1 = x1;
+  e.y1 = y1;
+  e.color = params.color;
+}
+
+void P64::Batch2D::flush()
+{
+  countDraw = 0;
+  countLoad = 0;
+  countMode = 0;
+  if(!entries || entries->empty())return;
+
+  // stable, so draws with the same key (e.g. text made of sprites) stay in order
+  std::stable_sort(entries->begin(), entries->end(), [](const Entry &a, const Entry &b) {
+    return a.key < b.key;
+  });
+
+  uint32_t lastLayer = 0xFFFF'FFFF;
+  Mode lastMode = Mode::UNSET;
+  sprite_t *lastSprite = nullptr;
+  color_t lastColor{};
+
+  for(auto &e : *entries)
+  {
+    uint32_t layer = e.key >> 56;
+    auto mode = (Mode)((e.key >> 40) & 0xFF);
+
+    if(layer != lastLayer) {
+      DrawLayer::use2D(layer);
+      rdpq_set_mode_standard();
+      lastLayer = layer;
+      lastMode = Mode::UNSET;
+      lastSprite = nullptr;
+    }
+
+    if(mode != lastMode) {
+      setMode(mode);
+      lastMode = mode;
+      rdpq_set_prim_color(e.color);
+      lastColor = e.color;
+    } else if(color_to_packed32(e.color) != color_to_packed32(lastColor)) {
+      rdpq_set_prim_color(e.color);
+      lastColor = e.color;
+    }
+
+    ++countDraw;
+    if(!e.sprite) {
+      rdpq_fill_rectangle(e.x0, e.y0, e.x1, e.y1);
+      continue;
+    }
+
+    // sprites too large for TMEM need to be split into multiple loads, let libdragon handle that
+    if(!fitsTMEM(e.sprite)) {
+      rdpq_blitparms_t p{};
+      p.s0 = e.s;
+      p.t0 = e.t;
+      p.width = e.width;
+      p.height = e.height;
+      p.scale_x = (e.x1 - e.x0) / e.width;
+      p.scale_y = (e.y1 - e.y0) / e.height;
+      rdpq_sprite_blit(e.sprite, e.x0, e.y0, &p);
+      lastSprite = nullptr;
+      ++countLoad;
+      continue;
+    }
+
+    if(e.sprite != lastSprite) {
+      rdpq_sprite_upload(TILE0, e.sprite, nullptr);
+      lastSprite = e.sprite;
+      ++countLoad;
+    }
+    rdpq_texture_rectangle_scaled(TILE0, e.x0, e.y0, e.x1, e.y1,
+      e.s, e.t, e.s + e.width, e.t + e.height
+    );
+  }
+
+  DrawLayer::useDefault();
+  entries->clear();
+}
+
+void P64::Batch2D::destroy()
+{
+  delete entries;
+  entries = nullptr;
+}
+
+uint32_t P64::Batch2D::getDrawCount() { return countDraw; }
+uint32_t P64::Batch2D::getLoadCount() { return countLoad; }
+uint32_t P64::Batch2D::getModeCount() { return countMode; }
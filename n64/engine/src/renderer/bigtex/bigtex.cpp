@@ -5,15 +5,30 @@
 #include <string>
 
 #include "bigtex.h"
+#include <unordered_map>
 #include <vector>
 
 #include "renderer/pipelineBigTex.h"
 #include "scene/scene.h"
 #include "scene/sceneManager.h"
 
+namespace
+{
+  struct PatchedObject {
+    rspq_block_t *material{};
+    rspq_block_t *geometry{};
+    const T3DMaterial *mat{};
+    uint8_t texId{P64::Renderer::BigTex::Textures::NO_PAGE};
+  };
+
+  // the texture of an object may move to another page at any time, so the address (prim-color)
+  // is set in between the recorded material and geometry when drawing
+  std::unordered_map<const T3DModel*, std::vector<PatchedObject>> patchedModels{};
+}
+
 void P64::Renderer::BigTex::patchT3DM(T3DModel &model)
 {
-  if(model.userBlock)return; // already processed
+  if(patchedModels.contains(&model))return; // already processed
   auto pipeline = SceneManager::getCurrent().getRenderPipeline<RenderPipelineBigTex>();
   assert(pipeline);
 
@@ -27,8 +42,10 @@ void P64::Renderer::BigTex::patchT3DM(T3DModel &model)
   }
 
   uint8_t baseAddrMat = (TEX_BASE_ADDR >> 16) & 0xFF;
+  auto &patched = patchedModels[&model];
   for(auto &obj : objects)
   {
+    auto &res = patched.emplace_back(PatchedObject{.mat = obj->material});
     auto *mat = obj->material;
     if(mat->textureA.texReference == 0xFF)continue;
     if(mat->textureA.texWidth != 256)continue;
@@ -61,23 +78,23 @@ void P64::Renderer::BigTex::patchT3DM(T3DModel &model)
     mat->textureA.texReference = 0xFF;
     mat->textureB.texReference = 0xFF;
 
-    mat->primColor = {(uint8_t)(baseAddrMat + matIdx),0,0,0xFF};
+    res.texId = matIdx;
+    mat->primColor = {baseAddrMat,0,0,0xFF}; // replaced when drawing
     mat->colorCombiner = RDPQ_COMBINER2(
       (1, 0, TEX0, TEX1),     (0,0,0,1),
       (1, 0, PRIM, COMBINED), (0,0,0,1)
     );
-
-    ++matIdx;
   }
 
-  rspq_block_begin();
-    auto t3dState = t3d_model_state_create();
-    for(auto obj : objects) {
-      t3d_model_draw_material(obj->material, &t3dState);
-      t3d_model_draw_object(obj, nullptr);
-    }
-    t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0,0);
-  model.userBlock = rspq_block_end();
+  for(uint32_t i=0; i<objects.size(); ++i) {
+    rspq_block_begin();
+      t3d_model_draw_material(objects[i]->material, nullptr);
+    patched[i].material = rspq_block_end();
+
+    rspq_block_begin();
+      t3d_model_draw_object(objects[i], nullptr);
+    patched[i].geometry = rspq_block_end();
+  }
 /*
   rspq_block_begin();
     rdpq_sync_pipe();
@@ -96,3 +113,34 @@ void P64::Renderer::BigTex::patchT3DM(T3DModel &model)
   dplDrawShade = rspq_block_end();
   */
 }
+
+void P64::Renderer::BigTex::drawT3DM(const T3DModel &model)
+{
+  auto it = patchedModels.find(&model);
+  if(it == patchedModels.end())return;
+  auto &textures = SceneManager::getCurrent().getRenderPipeline<RenderPipelineBigTex>()->textures;
+
+  const T3DMaterial *lastMat = nullptr;
+  for(auto &obj : it->second) {
+    if(obj.mat != lastMat) {
+      rspq_block_run(obj.material);
+      lastMat = obj.mat;
+    }
+    if(obj.texId != Textures::NO_PAGE) {
+      rdpq_set_prim_color({textures.use(obj.texId), 0, 0, 0xFF});
+    }
+    rspq_block_run(obj.geometry);
+  }
+  t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0,0);
+}
+
+void P64::Renderer::BigTex::freeModels()
+{
+  for(auto &[model, objects] : patchedModels) {
+    for(auto &obj : objects) {
+      rspq_block_free(obj.material);
+      rspq_block_free(obj.geometry);
+    }
+  }
+  patchedModels.clear();
+}
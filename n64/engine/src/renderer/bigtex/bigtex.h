@@ -11,6 +11,9 @@ namespace P64::Renderer::BigTex {
   static_assert((TEX_BASE_ADDR & 0x000F'FFFF) == 0, "Low 20bits must be zero");
 
   void patchT3DM(T3DModel &model);
+  // draws a model patched by 'patchT3DM', marks its textures as used
+  void drawT3DM(const T3DModel &model);
+  void freeModels();
 
   void applyTexturesUV(uint64_t *fbTexIn, uint16_t *buffOut, uint32_t buffSize);
   void applyTexturesMat(uint64_t *fbTexIn, uint16_t *buffOut, uint32_t buffSize);
@@ -20,38 +20,34 @@ namespace P64::Renderer::BigTex
 
   void freeBuffers(FrameBuffers &fbs)
   {
-    surface_free(&zBuffer);
     zBuffer = {};
-    for(auto &fb : fbs.uv) {
-      surface_free(&fb);
-      fb = {};
-    }
+    for(auto &fb : fbs.uv)fb = {};
 
     LD::sbrkSetTop(oldSbrkTop);
   }
 
-  FrameBuffers allocBuffers() {
+  FrameBuffers allocBuffers(uint32_t width, uint32_t height) {
     if(is_memory_expanded()) { // With 8MB, we reserve the upper 4MB (excl. the stack) for the frame-buffers
+      uint32_t fbByteSize = width * height * 2;
+      assertf(fbByteSize <= FB_MAX_BYTE_SIZE, "BigTex: resolution %lux%lu too large", width, height);
+      assertf((width * height) % 8 == 0, "BigTex: pixel count must be a multiple of 8 (%lux%lu)", width, height);
+
       // first limit the upper heap to match against the start of our first buffer
-      oldSbrkTop = LD::sbrkSetTop((void*)FB_BANK_ADDR[0]);
+      oldSbrkTop = LD::sbrkSetTop((void*)FB_BANK_BASE[0]);
       //debugf("sbrk_top: %p -> %p\n", oldSbrkTop, oldSbrkTop);
 
-      zBuffer = surface_make(UncachedAddr(FB_BANK_ADDR[4]), FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH*2);
+      uint32_t stride = width * 2;
+      zBuffer = surface_make(UncachedAddr(FB_BANK_BASE[2]), FMT_RGBA16, width, height, stride);
       return {
         .color = {
-          surface_make(UncachedAddr(FB_BANK_ADDR[1]), FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH*2),
-          surface_make(UncachedAddr(FB_BANK_ADDR[2]), FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH*2),
-          surface_make(UncachedAddr(FB_BANK_ADDR[3]), FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT, SCREEN_WIDTH*2),
-        },
-        .uv = {
-          surface_alloc(FMT_RGBA32, SCREEN_WIDTH, SCREEN_HEIGHT),
-          surface_alloc(FMT_RGBA32, SCREEN_WIDTH, SCREEN_HEIGHT),
-          surface_alloc(FMT_RGBA32, SCREEN_WIDTH, SCREEN_HEIGHT),
+          surface_make(UncachedAddr(FB_BANK_BASE[1] - fbByteSize), FMT_RGBA16, width, height, stride),
+          surface_make(UncachedAddr(FB_BANK_BASE[1]), FMT_RGBA16, width, height, stride),
+          surface_make(UncachedAddr(FB_BANK_BASE[2] - fbByteSize), FMT_RGBA16, width, height, stride),
         },
         /*.shade = {
-          surface_alloc(FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT),
-          surface_alloc(FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT),
-          surface_alloc(FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT),
+          surface_alloc(FMT_RGBA16, width, height),
+          surface_alloc(FMT_RGBA16, width, height),
+          surface_alloc(FMT_RGBA16, width, height),
         },*/
         .depth = &zBuffer
       };
@@ -7,16 +7,11 @@
 
 namespace P64::Renderer::BigTex
 {
-  constexpr uint32_t SCREEN_WIDTH = 320;
-  constexpr uint32_t SCREEN_HEIGHT = 240;
-
-  constexpr uint32_t FB_BYTE_SIZE = SCREEN_WIDTH * SCREEN_HEIGHT * 2;
-  constexpr uint32_t FB_BANK_ADDR[5] = {
-    //0x80500000 - FB_BYTE_SIZE,
-    0x80500000,
-    0x80600000 - FB_BYTE_SIZE, 0x80600000,
-    0x80700000 - FB_BYTE_SIZE, 0x80700000,
-  };
+  // color buffers are placed at the start/end of the upper RDRAM banks,
+  // two of them share a 1MB bank which limits the resolution
+  constexpr uint32_t BANK_SIZE = 0x10'0000;
+  constexpr uint32_t FB_BANK_BASE[3] = {0x80500000, 0x80600000, 0x80700000};
+  constexpr uint32_t FB_MAX_BYTE_SIZE = BANK_SIZE / 2;
 
   struct FrameBuffers {
     surface_t color[3]{};
@@ -26,6 +21,12 @@ namespace P64::Renderer::BigTex
   };
 
   surface_t* getZBuffer();
-  FrameBuffers allocBuffers();
+
+  /**
+   * Places the color and depth buffers for the given resolution (RGBA16 output), requires the expansion-pak.
+   * The pixel count must be a multiple of 8 and fit two buffers into a single bank.
+   * The UV buffers are left to the render-graph of the pipeline, allocated on the (now limited) heap.
+   */
+  FrameBuffers allocBuffers(uint32_t width, uint32_t height);
   void freeBuffers(FrameBuffers &fbs);
 }
\ No newline at end of file
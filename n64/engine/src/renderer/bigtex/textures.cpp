@@ -21,57 +21,189 @@ namespace {
     return path.substr(pos);
   }
 
+  // pages drawn within this many frames are never evicted, the UV buffer is only resolved a frame later
+  // and frames are queued up with the RSP/RDP. Also how long a missing texture stays requested.
+  constexpr uint32_t FRAMES_IN_FLIGHT = 3;
+
   void loadIntoBuffer(const char* path, uint8_t *buffer)
   {
     auto *fp = asset_fopen(path, nullptr);
     fread(buffer, 1, TEX_SIZE_BYTES, fp);
     fclose(fp);
+    data_cache_hit_writeback(buffer, TEX_SIZE_BYTES);
+  }
+
+  // '.bci' files are raw and uncompressed, so ROM files can be copied over without going through the filesystem
+  uint32_t getRomAddr(const std::string &path)
+  {
+    if(!path.starts_with("rom:/"))return 0;
+    return dfs_rom_addr(path.c_str() + 4);
   }
 }
 
 namespace P64::Renderer::BigTex
 {
   Textures::Textures(uint32_t maxSize_)
-    : maxSize{maxSize_}, idx{0}
+    : maxSize{maxSize_}
   {
     uint32_t allocSize = TEX_SIZE_BYTES * maxSize;
     debugf("Reserve %.2fKB (%.2fMB) for %lu textures\n", (double)allocSize/1024.0, (double)allocSize/1024.0/1024.0, maxSize);
     debugf("  Address-end: 0x%08lX\n", TEX_BASE_ADDR + allocSize);
     buffer = (uint8_t*)TEX_BASE_ADDR;
     sys_hw_memset(buffer, 0, allocSize);
+    pages.resize(maxSize);
   }
 
   Textures::~Textures() {
-    //free_uncached(buffer);
+    // the next scene may use this memory for something else
+    if(pendingPage != NO_PAGE)dma_wait();
+    if(fallback)free_uncached(fallback);
+  }
+
+  uint8_t Textures::findFreePage(bool allowEvict)
+  {
+    for(uint32_t p=0; p<maxSize; ++p) {
+      if(pages[p].texId == NO_PAGE)return p;
+    }
+    if(!allowEvict)return NO_PAGE;
+
+    uint8_t res = NO_PAGE;
+    uint32_t oldest = frame;
+    for(uint32_t p=0; p<maxSize; ++p) {
+      auto &page = pages[p];
+      if(p == pendingPage || entries[page.texId].pinned)continue;
+      if(page.lastUsed + FRAMES_IN_FLIGHT >= frame)continue;
+      if(page.lastUsed < oldest) {
+        oldest = page.lastUsed;
+        res = p;
+      }
+    }
+
+    if(res != NO_PAGE) {
+      entries[pages[res].texId].page = NO_PAGE;
+      pages[res].texId = NO_PAGE;
+    }
+    return res;
+  }
+
+  void Textures::loadPage(uint8_t texId, uint8_t page, bool async)
+  {
+    auto &entry = entries[texId];
+    auto ptrOut = buffer + TEX_SIZE_BYTES * page;
+    // counts as used, otherwise it could get evicted again before it was ever drawn
+    pages[page] = {.lastUsed = frame, .texId = texId};
+
+    if(async) {
+      data_cache_hit_writeback_invalidate(ptrOut, TEX_SIZE_BYTES);
+      dma_read_async(ptrOut, entry.romAddr, TEX_SIZE_BYTES);
+      pendingPage = page;
+      pendingTex = texId;
+    } else {
+      loadIntoBuffer(entry.path.c_str(), ptrOut);
+      entry.page = page;
+    }
+  }
+
+  uint8_t Textures::getFallbackAddr()
+  {
+    // only needed once there are more textures than pages, can be anywhere as long as it's 64KB aligned
+    if(!fallback) {
+      fallback = (uint8_t*)malloc_uncached_aligned(TEX_SIZE_BYTES, TEX_SIZE_BYTES);
+      assertf(fallback, "No memory for the fallback texture");
+      memset(fallback, 0, TEX_SIZE_BYTES);
+    }
+    return ((uint32_t)fallback >> 16) & 0xFF;
   }
 
   uint8_t Textures::addTexture(const std::string &path)
   {
     auto name = getName(path);
     auto it = texMap.find(name);
-    if(it == texMap.end()) {
-      auto ptrOut = buffer + TEX_SIZE_BYTES * idx;
-      loadIntoBuffer(path.c_str(), ptrOut);
-
-      auto newIdx = idx++;
-      texMap[name] = newIdx;
-      debugf("Tex[%lu/%lu]: %s\n", newIdx, maxSize, path.c_str());
-      assertf(idx <= maxSize, "Texture buffer full: %lu/%lu", idx, maxSize);
-      return newIdx;
+    if(it != texMap.end())return it->second;
+
+    assertf(entries.size() < NO_PAGE, "Too many textures: %d", (int)entries.size());
+    uint8_t texId = entries.size();
+    entries.push_back({.path = path, .romAddr = getRomAddr(path)});
+    texMap[name] = texId;
+
+    // as long as there is space, it's loaded right away to not pop in later
+    auto page = findFreePage(false);
+    if(page != NO_PAGE) {
+      loadPage(texId, page, false);
+      debugf("Tex[%d/%lu]: %s\n", page, maxSize, path.c_str());
+    } else {
+      debugf("Tex[-/%lu]: %s (streamed)\n", maxSize, path.c_str());
     }
-    return it->second;
+    return texId;
   }
 
   uint8_t Textures::reserveTexture() {
-    auto newIdx = idx++;
-    assertf(idx < maxSize, "Texture buffer full: %lu/%lu", idx, maxSize);
-    return newIdx;
+    auto page = findFreePage(false);
+    assertf(page != NO_PAGE, "Texture buffer full: %d/%lu", (int)entries.size(), maxSize);
+    assertf(entries.size() < NO_PAGE, "Too many textures: %d", (int)entries.size());
+
+    uint8_t texId = entries.size();
+    entries.push_back({.page = page, .pinned = true});
+    pages[page] = {.lastUsed = frame, .texId = texId};
+    return texId;
   }
 
   uint8_t Textures::setTexture(uint8_t texIdx, const std::string &pathNew)
   {
-    auto ptrOut = buffer + TEX_SIZE_BYTES * texIdx;
-    loadIntoBuffer(pathNew.c_str(), ptrOut);
+    auto &entry = entries[texIdx];
+    if(pendingTex == texIdx) { // would be overwritten by the transfer otherwise
+      dma_wait();
+      entry.page = pendingPage;
+      pendingPage = pendingTex = NO_PAGE;
+    }
+
+    entry.path = pathNew;
+    entry.romAddr = getRomAddr(pathNew);
+    if(entry.page != NO_PAGE) {
+      loadPage(texIdx, entry.page, false);
+    }
     return texIdx;
   }
-}
\ No newline at end of file
+
+  uint8_t Textures::use(uint8_t texId)
+  {
+    auto &entry = entries[texId];
+    entry.lastUsed = frame;
+    if(entry.page == NO_PAGE)return getFallbackAddr();
+
+    pages[entry.page].lastUsed = frame;
+    return ((TEX_BASE_ADDR >> 16) & 0xFF) + entry.page;
+  }
+
+  void Textures::update()
+  {
+    if(pendingPage != NO_PAGE) {
+      dma_wait(); // long done by now, it had a whole frame
+      entries[pendingTex].page = pendingPage;
+      pendingPage = pendingTex = NO_PAGE;
+    }
+
+    // one per frame, the most recently drawn one first.
+    // a 64KB transfer keeps the PI busy for a few ms, other reads from ROM wait on it
+    uint8_t texId = NO_PAGE;
+    uint32_t newest = 0;
+    for(uint32_t i=0; i<entries.size(); ++i) {
+      auto &entry = entries[i];
+      if(entry.page != NO_PAGE || entry.pinned || entry.lastUsed == 0)continue;
+      if(entry.lastUsed + FRAMES_IN_FLIGHT < frame)continue;
+      if(entry.lastUsed > newest) {
+        newest = entry.lastUsed;
+        texId = i;
+      }
+    }
+
+    if(texId != NO_PAGE) {
+      auto page = findFreePage(true);
+      if(page != NO_PAGE) {
+        loadPage(texId, page, entries[texId].romAddr != 0);
+        ++pageInCount;
+      }
+    }
+    ++frame;
+  }
+}
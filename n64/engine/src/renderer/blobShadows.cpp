@@ -0,0 +1,340 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/blobShadows.h"
+
+#include <t3d/t3d.h>
+#include <t3d/t3dmath.h>
+
+#include "collision/scene.h"
+#include "lib/math.h"
+#include "renderer/drawLayer.h"
+#include "scene/object.h"
+
+namespace
+{
+  using namespace P64::BlobShadows;
+
+  constexpr uint32_t BUFFERS = 3;
+  constexpr uint32_t MAX_SHADOW_VERTICES = MAX_SHADOWS * 4;
+  constexpr uint32_t MAX_VERTICES = T3D_VERTEX_CACHE_SIZE & ~0b11; // must be multiple of 4
+
+  // texture is a quarter of the blob, mirrored in both directions
+  constexpr uint32_t TEX_SIZE = 32;
+  constexpr uint8_t SHADOW_ALPHA = 0x70;
+  // lifts the quad off the ground to avoid z-fighting, in addition to the depth offset
+  constexpr float SURFACE_OFFSET = 2.0f;
+  constexpr int16_t DEPTH_OFFSET = -40;
+
+  struct Caster
+  {
+    P64::Object *obj;
+    float size;
+    float strength;
+    float fadeHeight;
+  };
+
+  // ground hit of a caster, kept across ticks to skip raycasts when it didn't move
+  struct CasterHit
+  {
+    fm_vec3_t castPos;
+    P64::Coll::RaycastRes hit;
+    float size;
+    float strength;
+    float fadeHeight;
+    uint16_t objId;
+  };
+
+  struct Shadow
+  {
+    fm_vec3_t pos;
+    fm_vec3_t normal;
+    float size;
+    float strength;
+  };
+
+  constinit Caster casters[MAX_SHADOWS]{};
+  constinit uint32_t casterCount{0};
+
+  constinit CasterHit hits[2][MAX_SHADOWS]{};
+  constinit uint32_t hitCount[2]{};
+  constinit uint32_t hitBuff{0};
+  constinit uint32_t raycastCount{0};
+
+  constinit Shadow shadows[MAX_SHADOWS]{};
+  constinit uint32_t shadowListCount{0};
+
+  constinit T3DVertPacked *vertices{nullptr};
+  constinit T3DVertPacked *currVertBuff{nullptr};
+  constinit uint32_t quadCount{0};
+  constinit uint32_t frameIdx{0};
+
+  constinit T3DMat4FP *matIdentity{nullptr};
+  constinit surface_t shadowTex{};
+  constinit rspq_block_t *setupDPL{nullptr};
+  constinit uint8_t layerIdx{0};
+
+  const CasterHit* findHit(const CasterHit *list, uint32_t count, uint16_t objId, uint32_t hintIdx)
+  {
+    // casters usually register in the same order every tick
+    if(hintIdx < count && list[hintIdx].objId == objId)return &list[hintIdx];
+    for(uint32_t i=0; i<count; ++i) {
+      if(list[i].objId == objId)return &list[i];
+    }
+    return nullptr;
+  }
+
+  void writeQuad(const fm_vec3_t &groundPos, const fm_vec3_t &normal, float size, float strength)
+  {
+    if(quadCount >= MAX_SHADOWS)return;
+    uint32_t vertOffset = quadCount * 4;
+
+    auto pos = groundPos + normal * SURFACE_OFFSET;
+    auto posA = t3d_vertbuffer_get_pos(currVertBuff, vertOffset+2);
+    auto posB = t3d_vertbuffer_get_pos(currVertBuff, vertOffset+3);
+    auto posC = t3d_vertbuffer_get_pos(currVertBuff, vertOffset+1);
+    auto posD = t3d_vertbuffer_get_pos(currVertBuff, vertOffset+0);
+
+    // flat floors are very likely, so we can optimize this case
+    if(normal.y > 0.99f) {
+      posA[0] = pos.x - size; posA[1] = pos.y; posA[2] = pos.z - size;
+      posB[0] = pos.x + size; posB[1] = pos.y; posB[2] = pos.z - size;
+      posC[0] = pos.x + size; posC[1] = pos.y; posC[2] = pos.z + size;
+      posD[0] = pos.x - size; posD[1] = pos.y; posD[2] = pos.z + size;
+    } else {
+      // ...otherwise we need to calculate the vectors to make a shadow plane
+      fm_vec3_t right, up;
+      t3d_vec3_cross(right, normal, {0,1,0});
+      t3d_vec3_cross(up, right, normal);
+      t3d_vec3_norm(&right);
+      t3d_vec3_norm(&up);
+
+      auto vecA = (right - up) * size;
+      auto vecB = (right + up) * size;
+      auto p0 = pos + vecA;
+      auto p1 = pos + vecB;
+      auto p2 = pos - vecA;
+      auto p3 = pos - vecB;
+      for(int i=0; i<3; ++i) {
+        posA[i] = p0.v[i];
+        posB[i] = p1.v[i];
+        posC[i] = p2.v[i];
+        posD[i] = p3.v[i];
+      }
+    }
+
+    uint32_t color = 0xFFFFFF00 | (uint8_t)(P64::Math::clamp(strength, 0.0f, 1.0f) * SHADOW_ALPHA);
+    for(uint32_t v=0; v<4; ++v) {
+      *t3d_vertbuffer_get_color(currVertBuff, vertOffset+v) = color;
+    }
+    ++quadCount;
+  }
+}
+
+namespace P64::BlobShadows
+{
+  void init()
+  {
+    casterCount = 0;
+    shadowListCount = 0;
+    hitCount[0] = hitCount[1] = 0;
+    quadCount = 0;
+    frameIdx = 0;
+    layerIdx = 0;
+
+    vertices = static_cast<T3DVertPacked*>(malloc_uncached(
+      sizeof(T3DVertPacked) * MAX_SHADOW_VERTICES / 2 * BUFFERS
+    ));
+    currVertBuff = vertices;
+
+    // prefill static data (UVs)
+    constexpr int16_t UV_END = (TEX_SIZE * 2) << 5;
+    for(uint32_t i = 0; i < MAX_SHADOWS * BUFFERS; i++) {
+      auto *uvA = t3d_vertbuffer_get_uv(vertices, i * 4 + 2);
+      auto *uvB = t3d_vertbuffer_get_uv(vertices, i * 4 + 3);
+      auto *uvC = t3d_vertbuffer_get_uv(vertices, i * 4 + 1);
+      auto *uvD = t3d_vertbuffer_get_uv(vertices, i * 4 + 0);
+      uvA[0] = 0;      uvA[1] = 0;
+      uvB[0] = UV_END; uvB[1] = 0;
+      uvC[0] = UV_END; uvC[1] = UV_END;
+      uvD[0] = 0;      uvD[1] = UV_END;
+    }
+
+    matIdentity = static_cast<T3DMat4FP*>(malloc_uncached(sizeof(T3DMat4FP)));
+    t3d_mat4fp_identity(matIdentity);
+
+    // soft circle with the center in the bottom-right corner, generated to not depend on any asset
+    shadowTex = surface_alloc(FMT_I8, TEX_SIZE, TEX_SIZE);
+    auto texels = static_cast<uint8_t*>(shadowTex.buffer);
+    for(uint32_t y=0; y<TEX_SIZE; ++y) {
+      for(uint32_t x=0; x<TEX_SIZE; ++x) {
+        float dx = (float)(TEX_SIZE - x) - 0.5f;
+        float dy = (float)(TEX_SIZE - y) - 0.5f;
+        float dist = sqrtf(dx*dx + dy*dy) / TEX_SIZE;
+        texels[y * shadowTex.stride + x] = (uint8_t)(Math::clamp(1.0f - dist, 0.0f, 1.0f) * 255.0f);
+      }
+    }
+    data_cache_hit_writeback(texels, shadowTex.stride * TEX_SIZE);
+
+    rspq_block_begin();
+      rdpq_sync_pipe();
+      rdpq_mode_push();
+
+      rdpq_mode_begin();
+        rdpq_mode_zbuf(DrawLayer::hasDepth(), false);
+        rdpq_mode_combiner(RDPQ_COMBINER1((0,0,0,PRIM), (TEX0,0,SHADE,0)));
+        rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
+        rdpq_mode_alphacompare(8);
+        rdpq_mode_fog(0);
+      rdpq_mode_end();
+
+      rdpq_set_prim_color({0, 0, 0, 0xFF});
+      rdpq_sync_tile();
+      rdpq_sync_load();
+
+      rdpq_texparms_t tp{};
+      tp.t.mirror = tp.s.mirror = true;
+      tp.t.repeats = tp.s.repeats = 2.0f;
+      rdpq_tex_upload(TILE0, &shadowTex, &tp);
+
+      t3d_fog_set_enabled(false);
+      t3d_state_set_drawflags((T3DDrawFlags)(
+        T3D_FLAG_DEPTH | T3D_FLAG_TEXTURED | T3D_FLAG_SHADED | T3D_FLAG_NO_LIGHT | T3D_FLAG_CULL_BACK
+      ));
+      t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0, 0);
+    setupDPL = rspq_block_end();
+  }
+
+  void destroy()
+  {
+    if(!vertices)return;
+    free_uncached(vertices);
+    free_uncached(matIdentity);
+    surface_free(&shadowTex);
+    rspq_block_free(setupDPL);
+    vertices = nullptr;
+    matIdentity = nullptr;
+    setupDPL = nullptr;
+  }
+
+  void addCaster(Object &obj, float size, float strength, float fadeHeight)
+  {
+    if(casterCount >= MAX_SHADOWS)return;
+    casters[casterCount++] = {&obj, size, strength, fadeHeight};
+  }
+
+  void addShadow(const fm_vec3_t &pos, const fm_vec3_t &normal, float size, float strength)
+  {
+    if(shadowListCount >= MAX_SHADOWS)return;
+    shadows[shadowListCount++] = {pos, normal, size, strength};
+  }
+
+  void setLayer(uint8_t layerIdx3D) {
+    layerIdx = layerIdx3D;
+  }
+
+  uint32_t getShadowCount() { return quadCount; }
+  uint32_t getCasterCount() { return hitCount[hitBuff]; }
+  uint32_t getRaycastCount() { return raycastCount; }
+
+  void reset()
+  {
+    casterCount = 0;
+    shadowListCount = 0;
+  }
+
+  void resolve(Coll::Scene &collScene)
+  {
+    const CasterHit *prev = hits[hitBuff];
+    uint32_t prevCount = hitCount[hitBuff];
+    hitBuff ^= 1;
+    CasterHit *curr = hits[hitBuff];
+    hitCount[hitBuff] = casterCount;
+
+    Coll::Ray rays[MAX_SHADOWS];
+    Coll::RaycastRes results[MAX_SHADOWS];
+    uint8_t rayTarget[MAX_SHADOWS];
+    raycastCount = 0;
+
+    for(uint32_t i=0; i<casterCount; ++i)
+    {
+      const auto &caster = casters[i];
+      const auto &pos = caster.obj->pos;
+      auto &hit = curr[i];
+
+      auto cached = findHit(prev, prevCount, caster.obj->id, i);
+      if(cached && cached->castPos.x == pos.x && cached->castPos.y == pos.y && cached->castPos.z == pos.z) {
+        hit.hit = cached->hit;
+      } else {
+        rays[raycastCount] = {pos, {0.0f, -1.0f, 0.0f}};
+        rayTarget[raycastCount++] = i;
+      }
+
+      hit.castPos = pos;
+      hit.objId = caster.obj->id;
+      hit.size = caster.size;
+      hit.strength = caster.strength;
+      hit.fadeHeight = caster.fadeHeight;
+    }
+
+    if(raycastCount == 0)return;
+    collScene.raycast(rays, results, raycastCount);
+    for(uint32_t r=0; r<raycastCount; ++r) {
+      curr[rayTarget[r]].hit = results[r];
+    }
+  }
+
+  void prepare()
+  {
+    frameIdx = (frameIdx + 1) % BUFFERS;
+    currVertBuff = &vertices[(MAX_SHADOW_VERTICES / 2) * frameIdx];
+    quadCount = 0;
+
+    const CasterHit *curr = hits[hitBuff];
+    for(uint32_t i=0; i<hitCount[hitBuff]; ++i)
+    {
+      const auto &hit = curr[i];
+      if(!hit.hit.hasResult())continue;
+
+      float height = hit.castPos.y - hit.hit.hitPos.y;
+      float fade = 1.0f - Math::clamp(height / hit.fadeHeight, 0.0f, 1.0f);
+      if(fade <= 0.0f)continue;
+      writeQuad(hit.hit.hitPos, hit.hit.normal, hit.size * fade, hit.strength * fade);
+    }
+
+    for(uint32_t i=0; i<shadowListCount; ++i) {
+      const auto &shadow = shadows[i];
+      writeQuad(shadow.pos, shadow.normal, shadow.size, shadow.strength);
+    }
+  }
+
+  void draw()
+  {
+    if(quadCount == 0)return;
+
+    DrawLayer::use3D(layerIdx);
+      rspq_block_run(setupDPL);
+      t3d_matrix_set(matIdentity, true); // vertices are in world-space
+
+      uint32_t count = quadCount * 4;
+      auto vert = currVertBuff;
+
+      t3d_state_set_depth_offset(DEPTH_OFFSET);
+      while(count)
+      {
+        uint32_t localCount = count;
+        if(localCount > MAX_VERTICES)localCount = MAX_VERTICES;
+
+        t3d_vert_load(vert, 0, localCount);
+        t3d_quad_draw_unindexed(0, localCount / 4);
+        vert += localCount / 2;
+        count -= localCount;
+      }
+      t3d_state_set_depth_offset(0);
+
+      rdpq_sync_pipe();
+      rdpq_mode_pop();
+    DrawLayer::useDefault();
+  }
+}
@@ -9,7 +9,13 @@
 #include <t3d/t3d.h>
 #include <t3d/tpx.h>
 
+#include "debug/trace.h"
 #include "lib/logger.h"
+#include "lib/memory.h"
+#include "lib/matrixManager.h"
+#include "lib/math.h"
+#include "lib/ringBuffer.h"
+#include "renderer/matrixBatch.h"
 #include "scene/scene.h"
 
 #define LIBDRAGON_LAYERS 1
@@ -28,8 +34,25 @@ namespace
   };
 
   constexpr uint32_t LAYER_BUFFER_COUNT = 3;
+  static_assert(LAYER_BUFFER_COUNT == P64::FrameMatrices::BUFFER_COUNT);
   std::vector<std::array<Layer, LAYER_BUFFER_COUNT>> layers{};
 
+  struct LayerStats
+  {
+    uint32_t words{0};
+    uint32_t peak{0};
+    uint32_t capacity{0};
+    P64::RingBuffer<uint32_t, 32> history{};
+  };
+  std::vector<LayerStats> layerStats{};
+
+  #ifdef LIBDRAGON_LAYERS
+    // queues are not exposed, so usage is measured by the write pointer while a layer is active.
+    // if a queue switches to a new internal buffer in between, that part is not counted
+    constexpr uint32_t MAX_SPAN_WORDS = 0x10000;
+    constinit volatile uint32_t *layerStart{nullptr};
+  #endif
+
   constinit P64::DrawLayer::Setup *layerSetup{};
 
   #ifndef LIBDRAGON_LAYERS
@@ -38,20 +61,51 @@ namespace
     constinit volatile uint32_t* layerMem{nullptr};
   #endif
 
+  constinit bool depthEnabled{true};
   constinit uint8_t frameIdx{0};
   constinit uint8_t currLayerIdx{0};
+  constinit uint32_t layerMemSize{0}; // heap used by all layers, for the memory tracking
+
+  // heatmap: added per pixel, red saturates after ~6 draws, green after ~16 and blue after ~32
+  constexpr color_t HEATMAP_STEP{0x28, 0x10, 0x08, 0xFF};
+  constexpr uint32_t FILL_IDX_END = P64::DrawLayer::FILL_IDX_POST + 1;
+
+  // RDP pipe-busy counter, reset by the swap-chain at the start of each pass
+  constexpr uintptr_t DPC_PIPEBUSY_ADDR = 0xA4100018;
+
+  constinit bool heatmap{false};
+  constinit volatile uint32_t fillCycles[FILL_IDX_END]{};
+  constinit volatile uint32_t fillLastIdx{0};
+  constinit volatile uint32_t fillLastValue{0};
+
+  // called by the RDP once all previous draws are done (interrupt), closes the last section
+  void onFillMark(void* userData)
+  {
+    auto idx = (uint32_t)userData;
+    uint32_t value = *(volatile uint32_t*)DPC_PIPEBUSY_ADDR & 0xFF'FFFF;
+    // the first layer is only a start, anything before it is the clear of the last pass
+    if(idx != 0 && value >= fillLastValue) {
+      fillCycles[fillLastIdx] = value - fillLastValue;
+    }
+    fillLastIdx = idx;
+    fillLastValue = value;
+  }
 }
 
-void P64::DrawLayer::init(Setup &setup)
+void P64::DrawLayer::init(Setup &setup, bool useDepth)
 {
   reset();
   layerSetup = &setup;
+  depthEnabled = useDepth;
   uint32_t layerCount = setup.layerCount3D + setup.layerCountPtx + setup.layerCount2D;
   assert(layerCount > 0);
 
   currLayerIdx = 0;
   layers = {};
+  uint32_t heapStart = Mem::getHeapUsed();
   layers.resize(layerCount-1);
+  layerStats = {};
+  layerStats.resize(layerCount-1);
 
   #ifdef LIBDRAGON_LAYERS
     Log::info("DrawLayer count: %d", layers.size());
@@ -63,8 +117,13 @@ void P64::DrawLayer::init(Setup &setup)
     }
   #else
     uint32_t countAlloc3D = setup.layerCount3D-1 + setup.layerCountPtx;
-    size_t allocSize = countAlloc3D * LAYER_BUFFER_WORDS;
-    allocSize += setup.layerCount2D * LAYER_BUFFER_WORDS_2D;
+    size_t allocSize = 0;
+    for(uint32_t i=0; i<layers.size(); ++i) {
+      uint32_t words = setup.layerConf[i+1].bufferWords;
+      if(words == 0)words = (i >= countAlloc3D) ? LAYER_BUFFER_WORDS_2D : LAYER_BUFFER_WORDS;
+      layerStats[i].capacity = words;
+      allocSize += words;
+    }
     allocSize *= (LAYER_BUFFER_COUNT * sizeof(uint32_t));
 
     Log::info("DrawLayer mem-size: %d bytes", allocSize);
@@ -74,18 +133,21 @@ void P64::DrawLayer::init(Setup &setup)
     uint32_t layerIdx = 0;
     for(auto &layer : layers)
     {
-      bool is2D = layerIdx >= countAlloc3D;
       layer.fill({});
       for(uint32_t i = 0; i < LAYER_BUFFER_COUNT; i++)
       {
         layer[i].pointer = mem;
         layer[i].current = mem;
-        mem += is2D ? LAYER_BUFFER_WORDS_2D : LAYER_BUFFER_WORDS;
+        mem += layerStats[layerIdx].capacity;
         layer[i].sentinel = mem;
       }
       ++layerIdx;
     }
   #endif
+
+  uint32_t heapEnd = Mem::getHeapUsed();
+  layerMemSize = heapEnd > heapStart ? (heapEnd - heapStart) : 0;
+  Mem::track(Mem::Category::DRAW_LAYERS, layerMemSize);
 }
 
 void P64::DrawLayer::use(uint32_t idx)
@@ -93,7 +155,14 @@ void P64::DrawLayer::use(uint32_t idx)
   if(idx == currLayerIdx)return;
 
   #ifdef LIBDRAGON_LAYERS
+    if(currLayerIdx != 0) {
+      uint32_t span = rspq_cur_pointer - layerStart;
+      if(rspq_cur_pointer >= layerStart && span < MAX_SPAN_WORDS) {
+        layerStats[currLayerIdx-1].words += span;
+      }
+    }
     rspq_queue_switch(idx == 0 ? nullptr : layers[idx-1][frameIdx].queue);
+    layerStart = rspq_cur_pointer;
   #else
     if(idx == 0)
     {
@@ -109,6 +178,26 @@ void P64::DrawLayer::use(uint32_t idx)
   currLayerIdx = idx;
 }
 
+uint32_t P64::DrawLayer::getCurrent()
+{
+  return currLayerIdx;
+}
+
+bool P64::DrawLayer::isTranslucent(uint32_t idx)
+{
+  return layerSetup && layerSetup->layerConf[idx].blender != 0;
+}
+
+bool P64::DrawLayer::isBackToFront(uint32_t idx)
+{
+  return !depthEnabled || isTranslucent(idx);
+}
+
+bool P64::DrawLayer::hasDepth()
+{
+  return depthEnabled;
+}
+
 void P64::DrawLayer::usePtx(uint32_t idx)
 {
   use(idx + layerSetup->layerCount3D);
@@ -121,23 +210,42 @@ void P64::DrawLayer::use2D(uint32_t idx)
 
 void P64::DrawLayer::draw(uint32_t layerIdx)
 {
+  P64_TRACE_SCOPE(LAYER, layerIdx);
   auto &setup = layerSetup->layerConf[layerIdx];
-  rdpq_mode_begin();
-    rdpq_mode_zbuf(
-      setup.flags & Conf::FLAG_Z_COMPARE,
-      setup.flags & Conf::FLAG_Z_WRITE
-    );
-    rdpq_mode_blender(setup.blender);
-    rdpq_mode_fog((setup.fogMode != Conf::FogMode::NONE) ? RDPQ_FOG_STANDARD : 0);
-  rdpq_mode_end();
+  auto &scene = SceneManager::getCurrent();
+
+  // the first BigTex layer draws UVs, which are texture addresses and can't be touched
+  bool useHeatmap = heatmap && (layerIdx != 0 || scene.getConf().pipeline != SceneConf::Pipeline::BIG_TEX_256);
+  if(heatmap)rdpq_sync_full(onFillMark, (void*)layerIdx);
+
+  if(useHeatmap)
+  {
+    rdpq_mode_begin();
+      rdpq_mode_zbuf(false, false);
+      rdpq_mode_blender(RDPQ_BLENDER((BLEND_RGB, FOG_ALPHA, MEMORY_RGB, ONE)));
+      rdpq_mode_fog(0);
+    rdpq_mode_end();
+    rdpq_set_blend_color(HEATMAP_STEP);
+    rdpq_set_fog_color({0, 0, 0, 0xFF}); // alpha of it is the factor in the blender
+  } else {
+    rdpq_mode_begin();
+      rdpq_mode_zbuf(
+        depthEnabled && (setup.flags & Conf::FLAG_Z_COMPARE),
+        depthEnabled && (setup.flags & Conf::FLAG_Z_WRITE)
+      );
+      rdpq_mode_blender(setup.blender);
+      rdpq_mode_fog((setup.fogMode != Conf::FogMode::NONE) ? RDPQ_FOG_STANDARD : 0);
+    rdpq_mode_end();
+  }
 
-  if(setup.fogMode != Conf::FogMode::NONE)
+  // fog would need the blender, which is taken by the heatmap
+  if(!useHeatmap && setup.fogMode != Conf::FogMode::NONE)
   {
     t3d_fog_set_enabled(true);
     t3d_fog_set_range(setup.fogMin, setup.fogMax);
 
     if(setup.fogMode == Conf::FogMode::CLEAR_COLOR) {
-      rdpq_set_fog_color(SceneManager::getCurrent().getConf().clearColor);
+      rdpq_set_fog_color(scene.getConf().clearColor);
     } else if(setup.fogMode == Conf::FogMode::CUSTOM_COLOR) {
       rdpq_set_fog_color(setup.fogColor);
     }
@@ -179,8 +287,8 @@ void P64::DrawLayer::drawPtx()
   rdpq_set_mode_standard();
 
   rdpq_mode_begin();
-    rdpq_mode_zbuf(true, true);
-    rdpq_mode_zoverride(true, 0, 0);
+    rdpq_mode_zbuf(depthEnabled, depthEnabled);
+    rdpq_mode_zoverride(depthEnabled, 0, 0);
     rdpq_mode_combiner(RDPQ_COMBINER1((PRIM,0,ENV,0), (PRIM,0,ENV,0)));
     rdpq_mode_blender(0);
   rdpq_mode_end();
@@ -194,6 +302,7 @@ void P64::DrawLayer::drawPtx()
   for(int i=0; i<layerSetup->layerCountPtx; ++i) {
     draw(idxStart + i);
   }
+  if(heatmap)rdpq_sync_full(onFillMark, (void*)FILL_IDX_POST);
 }
 
 void P64::DrawLayer::draw2D()
@@ -211,8 +320,25 @@ void P64::DrawLayer::draw2D()
 
 void P64::DrawLayer::nextFrame()
 {
+  if(heatmap)rdpq_sync_full(onFillMark, (void*)FILL_IDX_END);
+
+  for(uint32_t i=0; i<layerStats.size(); ++i) {
+    auto &stats = layerStats[i];
+    #ifndef LIBDRAGON_LAYERS
+      stats.words = layers[i][frameIdx].current - layers[i][frameIdx].pointer;
+    #endif
+    stats.peak = Math::max(stats.peak, stats.words);
+    stats.history.push(stats.words);
+    #ifdef LIBDRAGON_LAYERS
+      stats.words = 0;
+    #endif
+  }
+
   frameIdx = (frameIdx + 1) % LAYER_BUFFER_COUNT;
   currLayerIdx = 0;
+  // transient matrices follow the same buffering as the layers themselves
+  FrameMatrices::nextFrame();
+  MatrixBatch::nextFrame();
 
   #ifdef LIBDRAGON_LAYERS
     for(auto &layer : layers) {
@@ -240,6 +366,41 @@ void P64::DrawLayer::reset()
     layerMem = nullptr;
   #endif
 
+  Mem::track(Mem::Category::DRAW_LAYERS, -(int32_t)layerMemSize);
+  layerMemSize = 0;
+
   layerSetup = nullptr;
   currLayerIdx = 0;
 }
+
+uint32_t P64::DrawLayer::getBufferedCount()
+{
+  return layerStats.size();
+}
+
+P64::DrawLayer::Stats P64::DrawLayer::getStats(uint32_t idx)
+{
+  auto &stats = layerStats[idx-1];
+  return {
+    .words = stats.history[stats.history.size()-1],
+    .peak = stats.peak,
+    .average = stats.history.average(),
+    .capacity = stats.capacity,
+  };
+}
+
+void P64::DrawLayer::setHeatmap(bool enabled)
+{
+  heatmap = enabled;
+  for(auto &c : fillCycles)c = 0;
+}
+
+bool P64::DrawLayer::isHeatmapEnabled()
+{
+  return heatmap;
+}
+
+uint32_t P64::DrawLayer::getFillCycles(uint32_t idx)
+{
+  return idx < FILL_IDX_END ? fillCycles[idx] : 0;
+}
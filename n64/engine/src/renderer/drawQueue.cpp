@@ -0,0 +1,191 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/drawQueue.h"
+#include "renderer/drawLayer.h"
+#include "renderer/material.h"
+#include "scene/scene.h"
+#include "scene/sceneManager.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+  struct Entry
+  {
+    uint64_t key;
+    P64::Object *obj;
+    void *data;
+    P64::DrawQueue::FuncDraw funcDraw;
+    P64::DrawQueue::FuncDrawBatch funcBatch;
+    const P64::Renderer::Material *material;
+    uint32_t batchKey;
+    uint8_t layerIdx;
+  };
+
+  std::vector<Entry> entries{};
+  std::vector<P64::DrawQueue::Instance> batchInstances{};
+
+  constinit uint32_t drawCount{0};
+  constinit uint32_t materialSwitches{0};
+  constinit uint32_t layerSwitches{0};
+  constinit uint32_t batchCount{0};
+  constinit uint32_t skippedMaterials{0};
+  constinit const void* lastMaterialKey{nullptr};
+
+  uint32_t hashMaterial(const P64::Renderer::Material &mat)
+  {
+    static_assert(sizeof(P64::Renderer::Material) % sizeof(uint32_t) == 0);
+    const uint32_t *words = (const uint32_t*)&mat;
+    uint32_t hash = 0;
+    for(uint32_t i=0; i<sizeof(P64::Renderer::Material) / sizeof(uint32_t); ++i) {
+      hash = (hash ^ words[i]) * 16777619u;
+    }
+    return hash ^ (hash >> 16);
+  }
+
+  bool isSameMaterial(const P64::Renderer::Material *a, const P64::Renderer::Material *b)
+  {
+    return a == b || memcmp(a, b, sizeof(P64::Renderer::Material)) == 0;
+  }
+}
+
+void P64::DrawQueue::submit(Object &obj, void* data, FuncDraw funcDraw,
+  const Renderer::Material &material, uint32_t batchKey, uint8_t layerIdx,
+  FuncDrawBatch funcBatch, uint16_t textureGroup)
+{
+  auto &cam = obj.getScene().getActiveCamera();
+  if(!cam.drawsLayer(layerIdx))return;
+
+  auto diff = obj.pos - cam.getPos();
+  float dist2 = t3d_vec3_len2(&diff);
+
+  // positive floats sort the same way as their bit-pattern does
+  uint32_t depthBits;
+  memcpy(&depthBits, &dist2, sizeof(depthBits));
+
+  uint32_t sortBatch = batchKey ^ (batchKey >> 8) ^ (batchKey >> 16);
+  uint32_t sortMat = ((hashMaterial(material) & 0xFF) << 16) | ((textureGroup & 0xFF) << 8) | (sortBatch & 0xFF);
+
+  uint64_t key = (uint64_t)layerIdx << 56;
+  if(DrawLayer::isBackToFront(layerIdx)) {
+    key |= ((uint64_t)(~depthBits) << 24) | sortMat;
+  } else {
+    key |= ((uint64_t)sortMat << 32) | depthBits;
+  }
+
+  entries.push_back({key, &obj, data, funcDraw, funcBatch, &material, batchKey, layerIdx});
+}
+
+void P64::DrawQueue::flush()
+{
+  drawCount = entries.size();
+  materialSwitches = 0;
+  layerSwitches = 0;
+  batchCount = 0;
+  skippedMaterials = 0;
+  lastMaterialKey = nullptr;
+  if(entries.empty())return;
+
+  std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) {
+    return a.key < b.key;
+  });
+
+  const Renderer::Material *currMat = nullptr;
+  uint8_t currLayer = 0;
+  FuncDraw lastDraw = nullptr;
+  FuncDrawBatch lastBatch = nullptr;
+
+  uint32_t entryCount = entries.size();
+  for(uint32_t i=0; i<entryCount;)
+  {
+    auto &entry = entries[i];
+    if(entry.layerIdx != currLayer) {
+      if(currMat)currMat->end();
+      Renderer::Material::restore();
+      currMat = nullptr;
+      DrawLayer::use3D(entry.layerIdx);
+      currLayer = entry.layerIdx;
+      lastMaterialKey = nullptr;
+      ++layerSwitches;
+    }
+
+    if(!currMat || !isSameMaterial(currMat, entry.material)) {
+      if(currMat)currMat->end();
+      currMat = entry.material;
+      // the object is only used for effects tied to the camera, so any of the group works
+      currMat->begin(*entry.obj);
+      lastMaterialKey = nullptr;
+      ++materialSwitches;
+    }
+
+    // only draws of the same kind know what the last one left behind
+    if(entry.funcDraw != lastDraw || entry.funcBatch != lastBatch) {
+      lastDraw = entry.funcDraw;
+      lastBatch = entry.funcBatch;
+      lastMaterialKey = nullptr;
+    }
+
+    if(entry.funcBatch)
+    {
+      uint32_t end = i + 1;
+      while(end < entryCount
+        && entries[end].funcBatch == entry.funcBatch
+        && entries[end].batchKey == entry.batchKey
+        && entries[end].layerIdx == entry.layerIdx
+        && isSameMaterial(entries[end].material, entry.material)
+      )++end;
+
+      batchInstances.clear();
+      for(uint32_t b=i; b<end; ++b) {
+        batchInstances.push_back({entries[b].obj, entries[b].data});
+      }
+      entry.funcBatch(batchInstances.data(), batchInstances.size());
+      ++batchCount;
+      i = end;
+      continue;
+    }
+
+    entry.funcDraw(*entry.obj, entry.data);
+    ++i;
+  }
+
+  if(currMat)currMat->end();
+  Renderer::Material::restore();
+  if(currLayer != 0)DrawLayer::useDefault();
+
+  lastMaterialKey = nullptr;
+  entries.clear();
+}
+
+bool P64::DrawQueue::useMaterialBlock(const void* key)
+{
+  if(key == lastMaterialKey) {
+    ++skippedMaterials;
+    return false;
+  }
+  lastMaterialKey = key;
+  return true;
+}
+
+void P64::DrawQueue::resetMaterialBlock()
+{
+  lastMaterialKey = nullptr;
+}
+
+void P64::DrawQueue::reset()
+{
+  entries.clear();
+  entries.shrink_to_fit();
+  batchInstances.clear();
+  batchInstances.shrink_to_fit();
+}
+
+uint32_t P64::DrawQueue::getDrawCount() { return drawCount; }
+uint32_t P64::DrawQueue::getMaterialSwitches() { return materialSwitches; }
+uint32_t P64::DrawQueue::getLayerSwitches() { return layerSwitches; }
+uint32_t P64::DrawQueue::getBatchCount() { return batchCount; }
+uint32_t P64::DrawQueue::getSkippedMaterials() { return skippedMaterials; }
@@ -2,52 +2,105 @@
 #include "rspHDR.h"
 #include <utility>
 
+#include "lib/math.h"
 #include "lib/memory.h"
 
 namespace {
-  constexpr bool MEASURE_PERF = false;
+  constinit bool measurePerf{false};
+  constinit uint32_t perfTimeUs{0};
 
-  constexpr int SCREEN_WIDTH = 320;
-  constexpr int SCREEN_HEIGHT = 240;
-  constexpr int SCALE_FACTOR = 4;
+  // fixed layout the ucode was written for
+  constexpr uint32_t UCODE_WIDTH = 320;
+  constexpr uint32_t UCODE_HEIGHT = 240;
+  constexpr uint32_t UCODE_SCALE_FACTOR = 4;
 
   uint64_t t{};
+
+  color_t toGray(float factor, uint8_t alpha = 0xFF) {
+    auto val = (uint8_t)P64::Math::clamp(factor * 255.0f, 0.0f, 255.0f);
+    return {val, val, val, alpha};
+  }
+}
+
+void P64::Renderer::HDR::applyQuality(Config &conf, Quality quality)
+{
+  switch(quality)
+  {
+    case Quality::HIGH:   conf.blurSteps = 4; conf.updateMode = BloomUpdate::FULL; break;
+    case Quality::MEDIUM: conf.blurSteps = 4; conf.updateMode = BloomUpdate::SPLIT; break;
+    case Quality::LOW:    conf.blurSteps = 2; conf.updateMode = BloomUpdate::HALF_RATE; break;
+  }
 }
 
-P64::Renderer::HDR::PostProcess::PostProcess()
+void P64::Renderer::HDR::setMeasurePerf(bool enabled)
 {
-  int sizeLowX = SCREEN_WIDTH / SCALE_FACTOR;
-  int sizeLowY = SCREEN_HEIGHT / SCALE_FACTOR;
+  measurePerf = enabled;
+  if(!enabled)perfTimeUs = 0;
+}
+
+uint32_t P64::Renderer::HDR::getPerfTimeUs()
+{
+  return perfTimeUs;
+}
 
-  surfHDR = surface_alloc(FMT_RGBA32, SCREEN_WIDTH, SCREEN_HEIGHT + 4);
-  surfBlurA = surface_alloc(FMT_RGBA32, sizeLowX, sizeLowY + 4);
-  surfBlurB = surface_alloc(FMT_RGBA32, sizeLowX, sizeLowY + 4);
+void P64::Renderer::HDR::PostProcess::declare(
+  RenderGraph &graph, RenderGraph::PassId passDraw, RenderGraph::PassId passPost,
+  uint32_t width, uint32_t height, uint32_t scale, bool outIs32Bit
+) {
+  assertf(scale == 2 || scale == 4 || scale == 8, "Invalid bloom scale factor: %lu", scale);
+  scaleFactor = scale;
+  sizeY = height;
+  useUcode = width == UCODE_WIDTH && height == UCODE_HEIGHT
+    && scaleFactor == UCODE_SCALE_FACTOR && !outIs32Bit;
+
+  auto sizeLowX = (uint16_t)(width / scaleFactor);
+  sizeLowY = height / scaleFactor;
+
+  // few extra lines to allow OOB access in the ucode
+  resHDR = graph.addResource({.name = "HDR", .format = FMT_RGBA32,
+    .width = (uint16_t)width, .height = (uint16_t)(height + 4), .persistent = true});
+  resBlurA = graph.addResource({.name = "Blur-A", .format = FMT_RGBA32,
+    .width = sizeLowX, .height = (uint16_t)(sizeLowY + 4), .persistent = true});
+  resBlurB = graph.addResource({.name = "Blur-B", .format = FMT_RGBA32,
+    .width = sizeLowX, .height = (uint16_t)(sizeLowY + 4), .persistent = true});
+
+  graph.use(passDraw, resHDR);
+  graph.use(passDraw, resBlurA);
+  graph.use(passPost, resHDR);
+  graph.use(passPost, resBlurA);
+  graph.use(passPost, resBlurB);
+}
+
+void P64::Renderer::HDR::PostProcess::init(RenderGraph &graph)
+{
+  auto &surfHDR = graph.get(resHDR);
+  auto &surfBlurA = graph.get(resBlurA);
+  auto &surfBlurB = graph.get(resBlurB);
 
   Mem::clearSurface(surfHDR);
   Mem::clearSurface(surfBlurA);
   Mem::clearSurface(surfBlurB);
 
-  surfHDRSafe = surface_make_sub(&surfHDR, 0, 2, surfHDR.width, SCREEN_HEIGHT);
+  surfHDRSafe = surface_make_sub(&surfHDR, 0, 2, surfHDR.width, sizeY);
   surfBlurASafe = surface_make_sub(&surfBlurA, 0, 2, surfBlurA.width, sizeLowY);
   surfBlurBSafe = surface_make_sub(&surfBlurB, 0, 2, surfBlurB.width, sizeLowY);
 }
 
 P64::Renderer::HDR::PostProcess::~PostProcess()
 {
-  surface_free(&surfBlurB);
-  surface_free(&surfBlurA);
-  surface_free(&surfHDR);
   if(blockRDPScale)rspq_block_free(blockRDPScale);
 }
 
-void P64::Renderer::HDR::PostProcess::beginFrame()
+void P64::Renderer::HDR::PostProcess::beginFrame(bool newBloom)
 {
+  updateBloom = newBloom;
   rdpq_set_color_image(&surfHDRSafe);
 }
 
 void P64::Renderer::HDR::PostProcess::endFrame()
 {
-  if(!conf.scalingUseRDP)return;
+  if(!updateBloom)return;
+  if(useUcode && !conf.scalingUseRDP)return;
 
   if(!blockRDPScale)
   {
@@ -68,19 +121,20 @@ void P64::Renderer::HDR::PostProcess::endFrame()
       ));
     rdpq_mode_end();
 
+    // two horizontal taps, each in the middle of one half of the source block
     rdpq_texparms_t texParam0{};
-    texParam0.s.scale_log = -2;
-    texParam0.s.translate = 1.5f;
+    texParam0.s.scale_log = -__builtin_ctz(scaleFactor);
+    texParam0.s.translate = (float)scaleFactor * 0.5f - 0.5f;
     texParam0.t.translate = 0.5f;
     auto texParam1 = texParam0;
-    texParam1.s.translate += 2.0f;
+    texParam1.s.translate += (float)scaleFactor * 0.5f;
 
     rdpq_set_prim_color({0,0,0, 0x100/2});
     rdpq_set_color_image(&surfBlurASafe);
     for(int y=0; y<surfBlurASafe.height; ++y)
     {
-      auto surfSub = surface_make_sub(&surfHDRSafe, 0, y*4, surfHDRSafe.width, 2);
-      surfSub.stride *= 2; // load every other line
+      auto surfSub = surface_make_sub(&surfHDRSafe, 0, y*scaleFactor, surfHDRSafe.width, 2);
+      surfSub.stride *= scaleFactor / 2; // load two lines, evenly spaced in the source block
 
       rdpq_tex_multi_begin();
         rdpq_tex_upload(TILE0, &surfSub, &texParam0);
@@ -95,55 +149,184 @@ void P64::Renderer::HDR::PostProcess::endFrame()
   rspq_block_run(blockRDPScale);
 }
 
-surface_t& P64::Renderer::HDR::PostProcess::applyEffects(surface_t &dst)
+void P64::Renderer::HDR::PostProcess::blurRDP(surface_t &input, surface_t &output, float threshold)
 {
-  if constexpr (MEASURE_PERF) {
-    rspq_wait();
-    rspq_highpri_begin();
-    t = get_ticks();
+  rdpq_sync_pipe();
+  rdpq_sync_load();
+  rdpq_set_mode_standard();
+
+  rdpq_mode_begin();
+    rdpq_mode_filter(FILTER_BILINEAR);
+    rdpq_mode_antialias(AA_NONE);
+    rdpq_mode_dithering(DITHER_NONE_NONE);
+    rdpq_mode_blender(0);
+    // (soft) threshold by subtracting it, the combiner clamps at zero
+    rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,PRIM,ENV,0), (0,0,0,1)));
+  rdpq_mode_end();
+
+  rdpq_set_prim_color(toGray(threshold));
+  rdpq_set_env_color(toGray(1.0f));
+  rdpq_set_color_image(&output);
+
+  // sampling in between 2x2 texels with bilinear filtering results in a box-blur
+  int height = input.height;
+  for(int y=0; y<height; ++y)
+  {
+    int srcY = Math::min(y, height-2);
+    auto surfSub = surface_make_sub(&input, 0, srcY, input.width, 2);
+
+    rdpq_texparms_t texParam{};
+    texParam.s.translate = 0.5f;
+    texParam.t.translate = 0.5f + (float)(y - srcY);
+    rdpq_tex_upload(TILE0, &surfSub, &texParam);
+    rdpq_texture_rectangle(TILE0, 0, y, output.width, y+1, 0, 0);
   }
+}
 
-  surface_t *input = &surfBlurBSafe;
-  surface_t *output = &surfBlurASafe;
+void P64::Renderer::HDR::PostProcess::compositeRDP(const surface_t &bloom, surface_t &dst, float bloomFactor)
+{
+  rdpq_sync_pipe();
+  rdpq_sync_load();
+  rdpq_set_color_image(&dst);
+  rdpq_set_mode_standard();
 
-  float bloomFactor = conf.hdrFactor * 0.5f * conf.blurBrightness;
+  // exposure, values above 1 add a scaled copy of the color on top
+  rdpq_mode_begin();
+    rdpq_mode_filter(FILTER_POINT);
+    rdpq_mode_antialias(AA_NONE);
+    rdpq_mode_blender(0);
+    if(conf.hdrFactor > 1.0f) {
+      rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,0,PRIM,TEX0), (0,0,0,1)));
+    } else {
+      rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,0,PRIM,0), (0,0,0,1)));
+    }
+  rdpq_mode_end();
+  rdpq_set_prim_color(toGray(conf.hdrFactor > 1.0f ? (conf.hdrFactor - 1.0f) : conf.hdrFactor));
+  rdpq_tex_blit(&surfHDRSafe, 0, 0, nullptr);
+
+  // bloom gets upscaled and added on top
+  rdpq_sync_pipe();
+  rdpq_mode_begin();
+    rdpq_mode_filter(FILTER_BILINEAR);
+    rdpq_mode_combiner(RDPQ_COMBINER1((TEX0,0,PRIM,0), (0,0,0,1)));
+    rdpq_mode_blender(RDPQ_BLENDER_ADDITIVE);
+  rdpq_mode_end();
+  rdpq_set_prim_color(toGray(bloomFactor));
 
+  rdpq_blitparms_t param{};
+  param.scale_x = (float)scaleFactor;
+  param.scale_y = (float)scaleFactor;
+  rdpq_tex_blit(&bloom, 0, 0, &param);
+
+  rdpq_sync_pipe();
+  rdpq_set_mode_standard();
+}
+
+void P64::Renderer::HDR::PostProcess::downscale()
+{
+  // First Pass, downscale image 4:1 with interpolation (RDP variant already ran in 'endFrame()')
+  if(useUcode && !conf.scalingUseRDP) {
+    RspHDR::downscale(surfHDRSafe.buffer, surfBlurASafe.buffer);
+  }
+  blurOut = &surfBlurASafe;
+}
+
+void P64::Renderer::HDR::PostProcess::blur(int stepStart, int stepEnd, float bloomFactor)
+{
   int blurSteps = conf.blurSteps;
   if(blurSteps > 0 && bloomFactor <= 0.0f) {
     blurSteps = 1;
   }
+  stepEnd = Math::min(stepEnd, blurSteps);
+
+  // Now blur the smaller image N amount of times by ping-ponging the buffers
+  for(int i=stepStart; i<stepEnd; ++i) {
+    surface_t *input = blurOut;
+    surface_t *output = (input == &surfBlurASafe) ? &surfBlurBSafe : &surfBlurASafe;
+    float threshold = (i == 0) ? conf.bloomThreshold : 0.0f;
+    if(useUcode) {
+      RspHDR::blur(input->buffer, output->buffer, (i == blurSteps-1) ? bloomFactor : 1.0f, threshold);
+    } else {
+      blurRDP(*input, *output, threshold);
+    }
+    blurOut = output;
+  }
+}
 
-  // First Pass, downscale image 4:1 with interpolation
-  if(!conf.scalingUseRDP) {
-    RspHDR::downscale(surfHDRSafe.buffer, output->buffer);
+surface_t& P64::Renderer::HDR::PostProcess::applyEffects(surface_t &dst, surface_t* lastBloom, PostProcess* prev)
+{
+  uint64_t ticks{};
+  if(measurePerf) {
+    rspq_wait();
+    rspq_highpri_begin();
+    ticks = get_ticks();
   }
 
-  // Now blur the smaller image N amount of times by ping-ponging the buffers
-  for(int i=0; i<blurSteps; ++i) {
-    std::swap(input, output);
-    RspHDR::blur(
-      input->buffer, output->buffer,
-      (i == blurSteps-1) ? bloomFactor : 1.0f,
-      (i == 0) ? conf.bloomThreshold : 0.0f
-    );
+  float bloomFactor = conf.hdrFactor * 0.5f * conf.blurBrightness;
+  int stepsSplit = (conf.blurSteps + 1) / 2;
+  surface_t *bloom = lastBloom;
+
+  switch(conf.updateMode)
+  {
+    case BloomUpdate::FULL:
+      downscale();
+      blur(0, conf.blurSteps, bloomFactor);
+      bloom = blurOut;
+    break;
+
+    case BloomUpdate::HALF_RATE:
+      if(updateBloom || !bloom) {
+        downscale();
+        blur(0, conf.blurSteps, bloomFactor);
+        bloom = blurOut;
+      }
+    break;
+
+    case BloomUpdate::SPLIT:
+      if(updateBloom) {
+        // start a new one, shown once the next frame finished it
+        downscale();
+        blur(0, stepsSplit, bloomFactor);
+        blurPending = true;
+        if(!bloom) {
+          blur(stepsSplit, conf.blurSteps, bloomFactor);
+          blurPending = false;
+          bloom = blurOut;
+        }
+      } else if(prev && prev->blurPending) {
+        // buffers of the last frame stay untouched until it gets re-used again, so continue there
+        prev->blur(stepsSplit, conf.blurSteps, bloomFactor);
+        prev->blurPending = false;
+        bloom = prev->blurOut;
+      } else if(!bloom) {
+        downscale();
+        blur(0, conf.blurSteps, bloomFactor);
+        bloom = blurOut;
+      }
+    break;
   }
 
-  // Combine original image and blurred image in a combined HDR+Bloom pass
-  RspHDR::hdrBlit(surfHDRSafe.buffer, dst.buffer, output->buffer, conf.hdrFactor);
+  if(useUcode)
+  {
+    // Combine original image and blurred image in a combined HDR+Bloom pass
+    RspHDR::hdrBlit(surfHDRSafe.buffer, dst.buffer, bloom->buffer, conf.hdrFactor);
 
-  // Read back image brightness, this is not synced here since we can live with a delay
-  uint32_t *imgBrightness = (uint32_t*)(((char*)surfHDRSafe.buffer) + surfHDRSafe.stride * (surfHDRSafe.height));
-  //debugf("imgBrightness: %08lX\n", *imgBrightness);
-  relBrightness = (float)(*imgBrightness >> 8) / (float)0x94BA;
+    // Read back image brightness, this is not synced here since we can live with a delay
+    uint32_t *imgBrightness = (uint32_t*)(((char*)surfHDRSafe.buffer) + surfHDRSafe.stride * (surfHDRSafe.height));
+    //debugf("imgBrightness: %08lX\n", *imgBrightness);
+    relBrightness = (float)(*imgBrightness >> 8) / (float)0x94BA;
+  } else {
+    // no brightness readback here, only the ucode computes it
+    compositeRDP(*bloom, dst, bloomFactor);
+  }
 
-  if constexpr (MEASURE_PERF) {
+  if(measurePerf) {
     rspq_highpri_end();
     rspq_flush();
     rspq_highpri_sync();
-    t = get_ticks() - t;
-    double ticksMS = (double)t / (double)TICKS_PER_SECOND * 1000.0f;
-    debugf("RSP-FX: %.4fms (%.4f)\n", ticksMS, ticksMS - 8.748);
+    if(!useUcode)rspq_wait(); // RDP work is not covered by the high-prio sync
+    perfTimeUs = TICKS_TO_US(get_ticks() - ticks);
   }
 
-  return *output;
+  return *bloom;
 }
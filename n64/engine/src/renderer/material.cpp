@@ -4,21 +4,59 @@
 */
 #include <renderer/material.h>
 
-void P64::Renderer::Material::begin(Object &obj)
+namespace
 {
-  if(!doesAnything())return;
+  // state left behind by the overrides of the last material, see 'begin'
+  constinit bool depthPushed{false};
+  constinit uint8_t depthFlags{0};
+  constinit bool primKnown{false};
+  constinit bool envKnown{false};
+  constinit color_t prim{};
+  constinit color_t env{};
 
+  bool isSameColor(color_t a, color_t b) {
+    return color_to_packed32(a) == color_to_packed32(b);
+  }
+}
+
+void P64::Renderer::Material::begin(Object &obj) const
+{
   if(setMask & MASK_DEPTH) {
+    bool depth = obj.getScene().getConf().hasDepth();
+    uint8_t flags = (depth && getDepthRead() ? 0b01 : 0) | (depth && getDepthWrite() ? 0b10 : 0);
+    if(!depthPushed || flags != depthFlags) {
+      rdpq_sync_pipe();
+      if(!depthPushed)rdpq_mode_push();
+      rdpq_mode_zbuf(flags & 0b01, flags & 0b10);
+      depthPushed = true;
+      depthFlags = flags;
+    }
+  } else if(depthPushed) {
     rdpq_sync_pipe();
-    rdpq_mode_push();
-    rdpq_mode_zbuf(getDepthRead(), getDepthWrite());
+    rdpq_mode_pop();
+    depthPushed = false;
   }
+
+  // without an override, the draw may set its own color
   if(setMask & MASK_PRIM) {
-    rdpq_set_prim_color(colorPrim);
+    if(!primKnown || !isSameColor(prim, colorPrim)) {
+      rdpq_set_prim_color(colorPrim);
+      prim = colorPrim;
+      primKnown = true;
+    }
+  } else {
+    primKnown = false;
   }
+
   if(setMask & MASK_ENV) {
-    rdpq_sync_pipe();
-    rdpq_set_env_color(colorEnv);
+    if(!envKnown || !isSameColor(env, colorEnv)) {
+      rdpq_sync_pipe();
+      rdpq_set_env_color(colorEnv);
+      env = colorEnv;
+      envKnown = true;
+    }
+  } else {
+    envKnown = false;
   }
   if(fresnel != 0)
   {
@@ -39,16 +77,23 @@ void P64::Renderer::Material::begin(Object &obj)
   }
 }
 
-void P64::Renderer::Material::end()
+void P64::Renderer::Material::end() const
 {
   if(fresnel != 0)
   {
     SceneManager::getCurrent().endLightingOverride();
   }
-  if(setMask & MASK_DEPTH)
+}
+
+void P64::Renderer::Material::restore()
+{
+  if(depthPushed)
   {
     rdpq_sync_pipe();
     rdpq_mode_pop();
+    depthPushed = false;
   }
+  primKnown = false;
+  envKnown = false;
 }
 
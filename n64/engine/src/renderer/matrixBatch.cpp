@@ -0,0 +1,172 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/matrixBatch.h"
+#include "renderer/drawLayer.h"
+#include "lib/math.h"
+#include "lib/memory.h"
+
+extern "C" {
+  DEFINE_RSP_UCODE(rsp_srt);
+
+  // Some libdragon issues with C++ and namespaces
+  inline void rspq_write_2(uint32_t rspID, uint32_t cmd, uint32_t a, uint32_t b) {
+    rspq_write(rspID, cmd, a, b);
+  }
+}
+
+namespace {
+  constexpr uint32_t CMD_BUILD = 0x00;
+
+  // entries per frame, anything beyond that is built on the CPU
+  constexpr uint32_t CAPACITY = 128;
+  // below this, the overlay switch costs more than building on the CPU
+  constexpr uint32_t MIN_RSP_COUNT = 8;
+  constexpr uint32_t BUFFER_COUNT = P64::FrameMatrices::BUFFER_COUNT;
+
+  /**
+   * Input of the ucode, must match 'ENTRY_SIZE' and the offsets in 'rsp_srt.S'.
+   * Values are 16.16 fixed-point split into integer and fraction, the rotation is s.15
+   */
+  struct Entry
+  {
+    uint32_t dst; // physical address of the output matrix
+    uint32_t padding;
+    int16_t rot[4];
+    int16_t scaleInt[4];
+    uint16_t scaleFrac[4];
+    int16_t posInt[4];
+    uint16_t posFrac[4];
+  };
+  static_assert(sizeof(Entry) == 48);
+
+  struct Pending
+  {
+    T3DMat4FP *mat;
+    const fm_vec3_t *scale;
+    const fm_quat_t *rot;
+    const fm_vec3_t *pos;
+  };
+
+  constinit Entry* entries{nullptr};
+  constinit uint32_t rspIdSrt{0};
+  constinit uint32_t frameIdx{0};
+  constinit uint32_t frameUsed{0};
+
+  constinit Pending pending[CAPACITY]{};
+  constinit uint32_t pendingCount{0};
+
+  constinit uint32_t countFrame{0};
+  constinit uint32_t countFrameRSP{0};
+  constinit uint32_t countLast{0};
+  constinit uint32_t countLastRSP{0};
+
+  void setFixed(int16_t &outInt, uint16_t &outFrac, float val) {
+    auto fixed = (int32_t)(val * 65536.0f);
+    outInt = (int16_t)(fixed >> 16);
+    outFrac = (uint16_t)(fixed & 0xFFFF);
+  }
+
+  void buildCPU(const Pending &p) {
+    t3d_mat4fp_from_srt(p.mat, *p.scale, *p.rot, *p.pos);
+  }
+}
+
+void P64::MatrixBatch::prepare(CachedMat4FP &cache, const fm_vec3_t &scale, const fm_quat_t &rot, const fm_vec3_t &pos)
+{
+  if(!cache.update(scale, rot, pos))return;
+
+  // the transform is stored in the cache itself, which stays valid until the flush
+  auto mat = cache.ring.getNext();
+  if(pendingCount == CAPACITY) {
+    t3d_mat4fp_from_srt(mat, cache.lastScale, cache.lastRot, cache.lastPos);
+    ++countFrame;
+    return;
+  }
+  pending[pendingCount++] = {mat, &cache.lastScale, &cache.lastRot, &cache.lastPos};
+}
+
+void P64::MatrixBatch::flush()
+{
+  if(pendingCount == 0)return;
+  countFrame += pendingCount;
+
+  uint32_t freeCount = CAPACITY - frameUsed;
+  if(pendingCount < MIN_RSP_COUNT || freeCount < pendingCount)
+  {
+    for(uint32_t i=0; i<pendingCount; ++i)buildCPU(pending[i]);
+    pendingCount = 0;
+    return;
+  }
+
+  if(!entries) {
+    entries = (Entry*)malloc(sizeof(Entry) * CAPACITY * BUFFER_COUNT);
+    Mem::track(Mem::Category::MATRICES, sizeof(Entry) * CAPACITY * BUFFER_COUNT);
+  }
+  if(!rspIdSrt)rspIdSrt = rspq_overlay_register(&rsp_srt);
+
+  auto batch = entries + (frameIdx * CAPACITY) + frameUsed;
+  for(uint32_t i=0; i<pendingCount; ++i)
+  {
+    auto &p = pending[i];
+    auto &e = batch[i];
+    e.dst = PhysicalAddr(p.mat);
+
+    for(uint32_t c=0; c<3; ++c) {
+      setFixed(e.scaleInt[c], e.scaleFrac[c], p.scale->v[c]);
+      setFixed(e.posInt[c], e.posFrac[c], p.pos->v[c]);
+    }
+    e.scaleInt[3] = 1; e.scaleFrac[3] = 0;
+    e.posInt[3] = 1; e.posFrac[3] = 0;
+
+    for(uint32_t c=0; c<4; ++c) {
+      e.rot[c] = (int16_t)(Math::clamp(p.rot->v[c], -1.0f, 1.0f) * 32767.0f);
+    }
+  }
+  data_cache_hit_writeback(batch, sizeof(Entry) * pendingCount);
+
+  // the ucode has to run before the draws referencing the matrices, which are all recorded after this.
+  // 3D layers are executed later than the main queue, so writing into it is always early enough
+  DrawLayer::useDefault();
+  rspq_write_2(rspIdSrt, CMD_BUILD, PhysicalAddr(batch), pendingCount);
+
+  frameUsed += pendingCount;
+  countFrameRSP += pendingCount;
+  pendingCount = 0;
+}
+
+void P64::MatrixBatch::nextFrame()
+{
+  assert(pendingCount == 0);
+  frameIdx = (frameIdx + 1) % BUFFER_COUNT;
+  frameUsed = 0;
+
+  countLast = countFrame;
+  countLastRSP = countFrameRSP;
+  countFrame = 0;
+  countFrameRSP = 0;
+}
+
+void P64::MatrixBatch::destroy()
+{
+  pendingCount = 0;
+  frameUsed = 0;
+  if(entries) {
+    free(entries);
+    Mem::track(Mem::Category::MATRICES, -(int32_t)(sizeof(Entry) * CAPACITY * BUFFER_COUNT));
+    entries = nullptr;
+  }
+  if(rspIdSrt) {
+    rspq_overlay_unregister(rspIdSrt);
+    rspIdSrt = 0;
+  }
+}
+
+uint32_t P64::MatrixBatch::getCount() {
+  return countLast;
+}
+
+uint32_t P64::MatrixBatch::getCountRSP() {
+  return countLastRSP;
+}
@@ -100,6 +100,60 @@ void outline_free_hull(T3DModel *hull) {
   }
 }
 
+// ─── Hull sharing ────────────────────────────────────────────────────────────
+
+// different (model, thickness) pairs that can be alive at the same time
+#define OUTLINE_HULL_CACHE_SIZE 16
+
+typedef struct {
+  const T3DModel *src;
+  T3DModel *hull;
+  float thickness;
+  uint32_t refCount;
+} HullCacheEntry;
+
+static HullCacheEntry hullCache[OUTLINE_HULL_CACHE_SIZE];
+
+T3DModel* outline_acquire_hull(const T3DModel *src, float thickness) {
+  HullCacheEntry *freeEntry = NULL;
+  for (uint32_t i = 0; i < OUTLINE_HULL_CACHE_SIZE; i++) {
+    HullCacheEntry *entry = &hullCache[i];
+    if (entry->refCount == 0) {
+      if (!freeEntry) freeEntry = entry;
+      continue;
+    }
+    if (entry->src == src && entry->thickness == thickness) {
+      entry->refCount++;
+      return entry->hull;
+    }
+  }
+
+  assertf(freeEntry != NULL, "outline_acquire_hull: more than %d different hulls", OUTLINE_HULL_CACHE_SIZE);
+  freeEntry->src = src;
+  freeEntry->thickness = thickness;
+  freeEntry->hull = outline_bake_hull(src, thickness);
+  freeEntry->refCount = 1;
+  return freeEntry->hull;
+}
+
+void outline_release_hull(T3DModel *hull) {
+  if (!hull) return;
+  for (uint32_t i = 0; i < OUTLINE_HULL_CACHE_SIZE; i++) {
+    HullCacheEntry *entry = &hullCache[i];
+    if (entry->refCount == 0 || entry->hull != hull) continue;
+
+    if (--entry->refCount == 0) {
+      outline_free_hull(entry->hull);
+      entry->hull = NULL;
+      entry->src = NULL;
+    }
+    return;
+  }
+
+  // not shared, e.g. baked directly via outline_bake_hull()
+  outline_free_hull(hull);
+}
+
 // ─── Runtime drawing ─────────────────────────────────────────────────────────
 
 void outline_draw_hull(const OutlineConf *conf, const T3DMat4FP *modelMat) {
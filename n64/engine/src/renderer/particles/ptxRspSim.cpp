@@ -0,0 +1,95 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/particles/ptxRspSim.h"
+#include "lib/memory.h"
+#include "lib/math.h"
+
+extern "C" {
+  DEFINE_RSP_UCODE(rsp_ptx);
+
+  // Some libdragon issues with C++ and namespaces
+  inline void rspq_write_5(uint32_t rspID, uint32_t cmd, uint32_t a, uint32_t b, uint32_t c, uint32_t d, uint32_t e) {
+    rspq_write(rspID, cmd, a, b, c, d, e);
+  }
+}
+
+namespace {
+  constexpr uint32_t CMD_SIMULATE = 0x00;
+
+  // must match 'PTX_MAX_STRIDE' in the ucode
+  constexpr uint32_t MAX_STRIDE = 64;
+  static_assert(sizeof(TPXParticleS16) % 8 == 0 && sizeof(TPXParticleS16) <= MAX_STRIDE);
+  static_assert(sizeof(P64::PTX::RspSim::State) == 16);
+
+  // longer steps would overflow the 16-bit time-step, and make particles tunnel anyway
+  constexpr float MAX_DELTA_TIME = 0.25f;
+
+  constinit uint32_t rspIdPtx{0};
+  constinit uint32_t refCount{0};
+  constinit uint32_t tpxOffsets{0};
+
+  uint32_t getOffset(const void* base, const void* ptr) {
+    return (uint32_t)((const uint8_t*)ptr - (const uint8_t*)base);
+  }
+}
+
+void P64::PTX::RspSim::init()
+{
+  if(refCount++ != 0)return;
+  rspIdPtx = rspq_overlay_register(&rsp_ptx);
+
+  // let the compiler figure out the layout of a pair, so the ucode doesn't rely on it
+  TPXParticleS16 pair{};
+  uint32_t offPosA = getOffset(&pair, tpx_buffer_s16_get_pos(&pair, 0));
+  uint32_t offPosB = getOffset(&pair, tpx_buffer_s16_get_pos(&pair, 1));
+  uint32_t offColA = getOffset(&pair, tpx_buffer_s16_get_rgba(&pair, 0));
+  uint32_t offColB = getOffset(&pair, tpx_buffer_s16_get_rgba(&pair, 1));
+  tpxOffsets = (offPosA << 24) | (offPosB << 16) | (offColA << 8) | offColB;
+}
+
+void P64::PTX::RspSim::destroy()
+{
+  assert(refCount != 0);
+  if(--refCount != 0)return;
+  rspq_overlay_unregister(rspIdPtx);
+  rspIdPtx = 0;
+}
+
+void P64::PTX::RspSim::simulate(const System &system, State* state, float deltaTime, int16_t gravity)
+{
+  assert(system.type == System::COLOR_A_S16 || system.type == System::TEX_A_S16);
+  assert(rspIdPtx != 0);
+
+  uint32_t pairCount = (system.count + 1) / 2;
+  if(pairCount == 0)return;
+
+  auto timeStep = (uint32_t)(Math::min(deltaTime, MAX_DELTA_TIME) * 4096.0f);
+  auto gravityStep = (int16_t)((gravity * (int32_t)timeStep) >> 12);
+
+  rspq_write_5(rspIdPtx, CMD_SIMULATE,
+    (uint32_t)system.particles & 0xFFFFFF,
+    ((uint32_t)state & 0xFFFFFF) | (sizeof(TPXParticleS16) << 24),
+    (pairCount << 16) | (uint16_t)gravityStep,
+    timeStep << 16,
+    tpxOffsets
+  );
+}
+
+P64::PTX::RspSim::State* P64::PTX::RspSim::allocState(const System &system)
+{
+  // always cover the last pair, the RSP processes particles two at a time
+  uint32_t allocSize = Math::alignUp(system.countMax, 2) * sizeof(State);
+  auto state = (State*)malloc_uncached(allocSize);
+  sys_hw_memset(state, 0, allocSize);
+  Mem::track(Mem::Category::PARTICLES, allocSize);
+  return state;
+}
+
+void P64::PTX::RspSim::freeState(const System &system, State* state)
+{
+  if(!state)return;
+  free_uncached(state);
+  Mem::track(Mem::Category::PARTICLES, -(int32_t)(Math::alignUp(system.countMax, 2) * sizeof(State)));
+}
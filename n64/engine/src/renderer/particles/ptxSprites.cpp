@@ -5,6 +5,7 @@
 #include "renderer/particles/ptxSprites.h"
 #include "debug/debugDraw.h"
 #include "lib/logger.h"
+#include "renderer/drawLayer.h"
 
 namespace
 {
@@ -26,7 +27,7 @@ namespace
 }
 
 P64::PTX::Sprites::Sprites(const char* spritePath, const Conf &conf_)
-  : system{System::TEX_A_S16, conf_.maxSize}, conf{conf_}
+  : system{System::TEX_A_S16, conf_.maxSize, conf_.cached != 0}, conf{conf_}
 {
   sprite = sprite_load(spritePath);
   system.count = 0;
@@ -39,7 +40,7 @@ P64::PTX::Sprites::Sprites(const char* spritePath, const Conf &conf_)
         rdpq_mode_filter(FILTER_BILINEAR);
         rdpq_mode_alphacompare(64);
         rdpq_mode_blender(RDPQ_BLENDER_MULTIPLY);
-        rdpq_mode_zbuf(true, false);
+        rdpq_mode_zbuf(DrawLayer::hasDepth(), false);
       } else {
         rdpq_mode_filter(FILTER_POINT);
         rdpq_mode_alphacompare(10);
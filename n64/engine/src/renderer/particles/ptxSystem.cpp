@@ -4,21 +4,41 @@
 */
 #include "renderer/particles/ptxSystem.h"
 #include "lib/matrixManager.h"
+#include "lib/memory.h"
+#include "lib/math.h"
+#include <malloc.h>
 
-P64::PTX::System::System(Type ptxType, uint32_t maxSize)
-  : countMax{maxSize}, count{0}, type{ptxType}
+namespace
+{
+  // full cache-lines, so a writeback never touches memory of other allocations
+  constexpr uint32_t CACHE_LINE_SIZE = 16;
+}
+
+P64::PTX::System::System(Type ptxType, uint32_t maxSize, bool cached)
+  : countMax{maxSize}, count{0}, type{ptxType}, isCached{cached}
 {
   assert(sizeof(countMax) % 2 == 0);
   if(countMax > 0) {
     std::size_t allocSize = countMax * sizeof(TPXParticle) / 2;
-    particles = malloc_uncached(allocSize);
-    sys_hw_memset(particles, 0, allocSize);
+    if(isCached) {
+      particles = memalign(CACHE_LINE_SIZE, Math::alignUp(allocSize, CACHE_LINE_SIZE));
+      memset(particles, 0, allocSize);
+    } else {
+      particles = malloc_uncached(allocSize);
+      sys_hw_memset(particles, 0, allocSize);
+    }
+    Mem::track(Mem::Category::PARTICLES, allocSize);
   }
 }
 
 P64::PTX::System::~System() {
   if(particles) {
-    free_uncached(particles);
+    if(isCached) {
+      free(particles);
+    } else {
+      free_uncached(particles);
+    }
+    Mem::track(Mem::Category::PARTICLES, -(int32_t)(countMax * sizeof(TPXParticle) / 2));
   }
 }
 
@@ -35,6 +55,11 @@ void P64::PTX::System::draw() const {
     ++safeCount;
   }
 
+  // single writeback of everything the CPU wrote since the last frame
+  if(isCached) {
+    data_cache_hit_writeback(particles, Math::alignUp(safeCount * sizeof(TPXParticle) / 2, CACHE_LINE_SIZE));
+  }
+
   switch(type)
   {
     case COLOR_RGBA_S8: tpx_particle_draw_s8((TPXParticleS8*)particles, safeCount); break;
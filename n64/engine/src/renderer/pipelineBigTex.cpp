@@ -11,6 +11,8 @@
 #include "scene/scene.h"
 #include "vi/swapChain.h"
 
+#include <algorithm>
+
 namespace BigTex = P64::Renderer::BigTex;
 
 extern "C" {
@@ -20,9 +22,12 @@ extern "C" {
 
 namespace
 {
-  constexpr int SCREEN_WIDTH = 320;
-  constexpr int SCREEN_HEIGHT = 240;
-  constexpr int SHADE_BLEND_SLICES = 16;
+  constexpr uint32_t SHADE_BLEND_SLICES = 16;
+  // the ucode works on chunks of 320 UV pixels (RGBA32) regardless of the resolution,
+  // so its slices have to start and end on those. The CPU works on 8 pixels at a time.
+  constexpr uint32_t RSP_CHUNK_SIZE_IN = 320 * 4;
+  // consecutive frames one side has to be the bottleneck before a slice is moved over
+  constexpr uint8_t BALANCE_FRAMES = 4;
 
   constinit BigTex::FrameBuffers fbs{};
   constinit uint32_t frameIdx{0};
@@ -30,12 +35,26 @@ namespace
 
 void P64::RenderPipelineBigTex::init()
 {
-  assertf(scene.getConf().screenWidth == SCREEN_WIDTH, "Ucode can only handle 320x240 resolution");
-  assertf(scene.getConf().screenHeight == SCREEN_HEIGHT, "Ucode can only handle 320x240 resolution");
   assertf(!(scene.getConf().flags & SceneConf::FLAG_SCR_32BIT), "Ucode can only handle RGBA16 output");
+  assertf(scene.getConf().hasDepth(), "BigTex pipeline needs a depth-buffer");
 
   BigTex::ucodeInit();
-  fbs = BigTex::allocBuffers();
+  uint16_t width = scene.getConf().screenWidth;
+  uint16_t height = scene.getConf().screenHeight;
+  // color and depth have fixed places in the upper banks, so only the UV buffers go through the graph.
+  // Those are read by the CPU and RSP one frame later, nothing can share memory with them
+  fbs = BigTex::allocBuffers(width, height);
+
+  auto passScene = graph.addPass("Scene", {});
+  auto passTex = graph.addPass("Texture", {});
+  RenderGraph::ResId resUV[3]{};
+  for(uint32_t i=0; i<3; ++i) {
+    resUV[i] = graph.addResource({.name = "UV", .format = FMT_RGBA32, .width = width, .height = height, .persistent = true});
+    graph.use(passScene, resUV[i]);
+    graph.use(passTex, resUV[i]);
+  }
+  graph.compile();
+  for(uint32_t i=0; i<3; ++i)fbs.uv[i] = graph.get(resUV[i]);
 
   // clear buffers to avoid garbage on the first 2 frames (since it's out of phase)
   for(auto &fb : fbs.color) {
@@ -64,6 +83,8 @@ void P64::RenderPipelineBigTex::init()
 
 P64::RenderPipelineBigTex::~RenderPipelineBigTex()
 {
+  BigTex::freeModels();
+  graph.reset(); // UV buffers live on the limited heap, free them before restoring its top
   BigTex::freeBuffers(fbs);
   BigTex::ucodeDestroy();
 }
@@ -76,15 +97,19 @@ void P64::RenderPipelineBigTex::preDraw()
     assertf(false, "Clearing screen not supported in BigTex pipeline");
   }
 
-  if(scene.getConf().flags & SceneConf::FLAG_CLR_DEPTH) {
+  bool clearDepth = nextDepthSlice();
+  ++frameCount;
+
+  if(clearDepth && (scene.getConf().flags & SceneConf::FLAG_CLR_DEPTH)) {
     rdpq_set_color_image(surfDepth);
     rdpq_mode_push();
       rdpq_set_mode_fill(color_from_packed16(0xFFFE));
-      rdpq_fill_rectangle(0,0, SCREEN_WIDTH, SCREEN_HEIGHT);
+      rdpq_fill_rectangle(0,0, surfDepth->width, surfDepth->height);
     rdpq_mode_pop();
   }
 
   uvTex.use();
+  textures.update();
 
   rdpq_set_color_image(&fbs.uv[frameIdx]);
   rdpq_set_z_image(surfDepth);
@@ -109,37 +134,75 @@ void P64::RenderPipelineBigTex::draw()
   rspq_flush();
 
   uint64_t ticks = get_ticks();
-  uint32_t FB_SIZE_IN = SCREEN_WIDTH * SCREEN_HEIGHT * 4;
+  uint32_t FB_SIZE_IN = surfColor->width * surfColor->height * 4;
   auto *texIn = (uint64_t*)CachedAddr(fbs.uv[frameIdxLast].buffer);
 
   switch(drawMode)
   {
     case DRAW_MODE_DEF: default:
     {
-      uint32_t quarterSlice = FB_SIZE_IN / SHADE_BLEND_SLICES / 3;
-      uint32_t stepSizeTexIn = quarterSlice * 2;
-      uint32_t stepSizeTexInRSP = quarterSlice * 1;
-
       uint32_t ptrInPos = (uint32_t)(texIn);
       uint32_t ptrOutPos = (uint32_t) CachedAddr(surfColor->buffer);
 
-      // version without shading, this is the same as above without the RDP tasks inbetween
-      stepSizeTexIn =  FB_SIZE_IN / SHADE_BLEND_SLICES;
-      for(int p=0; p<SHADE_BLEND_SLICES; ++p)
+      // RSP slices are spread out evenly, so the CPU can work on its own ones in the meantime.
+      // Slices end on RSP chunks, only the last one (always done by the CPU) may take a remainder
+      bool lastOnCPU = (FB_SIZE_IN % RSP_CHUNK_SIZE_IN) != 0;
+      auto isRspSlice = [&](uint32_t p) {
+        if(lastOnCPU && p == SHADE_BLEND_SLICES-1)return false;
+        return ((p * rspSliceCount) % SHADE_BLEND_SLICES) < rspSliceCount;
+      };
+      uint32_t lastRspSlice = 0;
+      for(uint32_t p=0; p<SHADE_BLEND_SLICES; ++p) {
+        if(isRspSlice(p))lastRspSlice = p;
+      }
+
+      rspq_syncpoint_t syncRsp{};
+      uint64_t ticksCpu = 0;
+      uint32_t sliceStart = 0;
+      for(uint32_t p=0; p<SHADE_BLEND_SLICES; ++p)
       {
-        if(p % 4 == 0) {
+        uint32_t sliceEnd = (p == SHADE_BLEND_SLICES-1) ? FB_SIZE_IN
+          : (FB_SIZE_IN * (p+1) / SHADE_BLEND_SLICES) / RSP_CHUNK_SIZE_IN * RSP_CHUNK_SIZE_IN;
+        uint32_t stepSizeTexIn = sliceEnd - sliceStart;
+        sliceStart = sliceEnd;
+        if(stepSizeTexIn == 0)continue;
+
+        if(isRspSlice(p)) {
           BigTex::ucodeFillTextures(
             ptrInPos, ptrInPos + stepSizeTexIn, ptrOutPos
           );
+          if(p == lastRspSlice)syncRsp = rspq_syncpoint_new();
           rspq_flush();
         } else {
+          uint64_t t = get_ticks();
           BigTex_applyTexture(ptrInPos, ptrInPos + stepSizeTexIn, ptrOutPos);
-          data_cache_hit_writeback_invalidate((char*)CachedAddr(ptrOutPos + stepSizeTexIn/2) - 0x1000, 0x1000);
+          uint32_t flushSize = std::min<uint32_t>(stepSizeTexIn/2, 0x1000);
+          data_cache_hit_writeback_invalidate((char*)CachedAddr(ptrOutPos + stepSizeTexIn/2) - flushSize, flushSize);
+          ticksCpu += get_ticks() - t;
         }
 
         ptrOutPos += stepSizeTexIn / 2;
         ptrInPos += stepSizeTexIn;
       }
+      ticksTexCPU = ticksCpu;
+
+      // if the RSP is still busy once the CPU is done with its share, it is the bottleneck (and vice versa).
+      // this is only checked, never waited on, the RSP just continues with the rest of the frame
+      if(balanceSlices) {
+        bool rspBehind = !rspq_syncpoint_check(syncRsp);
+        if(rspBehind) {
+          balanceCounter = balanceCounter < 0 ? balanceCounter - 1 : -1;
+        } else {
+          balanceCounter = balanceCounter > 0 ? balanceCounter + 1 : 1;
+        }
+        if(balanceCounter <= -BALANCE_FRAMES && rspSliceCount > 1) {
+          --rspSliceCount;
+          balanceCounter = 0;
+        } else if(balanceCounter >= BALANCE_FRAMES && rspSliceCount < SHADE_BLEND_SLICES-1) {
+          ++rspSliceCount;
+          balanceCounter = 0;
+        }
+      }
     }
     break;
     case DRAW_MODE_UV: BigTex::applyTexturesUV(texIn, (uint16_t*)surfColor->buffer, FB_SIZE_IN); break;
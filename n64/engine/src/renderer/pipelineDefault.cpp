@@ -5,18 +5,48 @@
 #include "../debug/overlay.h"
 #include "renderer/pipeline.h"
 #include "debug/debugDraw.h"
-#include "lib/memory.h"
+#include "lib/math.h"
 #include "renderer/drawLayer.h"
 #include "scene/globalState.h"
 #include "scene/scene.h"
 #include "vi/swapChain.h"
 
+namespace
+{
+  // render width per dynamic-resolution step, in 1/10th of the full width (e.g. 320 -> 288 -> 256)
+  constexpr uint8_t DYN_RES_STEPS[] = {10, 9, 8};
+  constexpr uint32_t DYN_RES_STEP_COUNT = sizeof(DYN_RES_STEPS) / sizeof(DYN_RES_STEPS[0]);
+
+  // fraction of the frame budget to step down above, or to step up below (estimated for the larger size)
+  constexpr float DYN_RES_BUDGET_HIGH = 0.95f;
+  constexpr float DYN_RES_BUDGET_LOW = 0.80f;
+  // consecutive frames needed to change a step, going up is slower to avoid flickering between sizes
+  constexpr int8_t DYN_RES_FRAMES_DOWN = 2;
+  constexpr int8_t DYN_RES_FRAMES_UP = 30;
+
+  // each slice only gets 1/n-th of the depth precision, two already skip every second clear
+  constexpr uint8_t DEPTH_SLICE_COUNT = 2;
+  // one per swap-chain buffer, the backdrop covers everything after that
+  constexpr uint32_t BACKDROP_CLEAR_FRAMES = 3;
+
+  // RDP completion per buffer, written in the detach callback (interrupt)
+  constinit volatile uint32_t ticksPassEnd[3]{};
+  constinit P64::VI::SwapChain::RenderPassCB passDoneCB{nullptr};
+
+  void onPassDone(void* userData)
+  {
+    auto fbIndex = (uint32_t)userData;
+    ticksPassEnd[fbIndex] = TICKS_READ();
+    passDoneCB(fbIndex);
+  }
+}
+
 void P64::RenderPipeline::setupLayer()
 {
   rdpq_mode_begin();
     rdpq_set_mode_standard();
     rdpq_mode_antialias(AA_NONE);
-    rdpq_mode_zbuf(true, true);
+    rdpq_mode_zbuf(DrawLayer::hasDepth(), DrawLayer::hasDepth());
     rdpq_mode_persp(true);
     rdpq_mode_filter(FILTER_BILINEAR);
     rdpq_mode_dithering(DITHER_NONE_NONE);
@@ -25,45 +55,144 @@ void P64::RenderPipeline::setupLayer()
   rdpq_mode_end();
 }
 
+bool P64::RenderPipeline::nextDepthSlice()
+{
+  bool useSlices = (scene.getConf().flags & SceneConf::FLAG_DEPTH_SLICES)
+    && (scene.getConf().flags & SceneConf::FLAG_CLR_DEPTH);
+
+  state.depthSliceCount = useSlices ? DEPTH_SLICE_COUNT : 1;
+  state.depthSlice = frameCount % state.depthSliceCount;
+  return state.depthSlice == 0;
+}
+
+bool P64::RenderPipeline::isDepthPersistent() const
+{
+  auto flags = scene.getConf().flags;
+  return (flags & SceneConf::FLAG_DEPTH_SLICES) || !(flags & SceneConf::FLAG_CLR_DEPTH);
+}
+
+void P64::RenderPipeline::clearBuffers()
+{
+  auto flags = scene.getConf().flags;
+  if(nextDepthSlice() && (flags & SceneConf::FLAG_CLR_DEPTH) && DrawLayer::hasDepth()) {
+    t3d_screen_clear_depth();
+  }
+
+  // even with a backdrop, each buffer needs one clear to not show what was there before the scene
+  bool clearColor = !(flags & SceneConf::FLAG_BACKDROP) || frameCount < BACKDROP_CLEAR_FRAMES;
+  if(DrawLayer::isHeatmapEnabled()) {
+    t3d_screen_clear_color({0, 0, 0, 0xFF}); // counts start at zero
+  } else if(clearColor && (flags & SceneConf::FLAG_CLR_COLOR)) {
+    t3d_screen_clear_color(scene.getConf().clearColor);
+  }
+  ++frameCount;
+}
+
 void P64::RenderPipelineDefault::init()
 {
   tex_format_t fmt = (scene.getConf().flags & SceneConf::FLAG_SCR_32BIT) ? FMT_RGBA32 : FMT_RGBA16;
-  for(auto &fb : surfFbColor) {
-    fb = surface_alloc(fmt, state.screenSize[0], state.screenSize[1]);
+  uint32_t fbCount = scene.getConf().getFrameBufferCount();
+  bool hasDepth = scene.getConf().hasDepth();
+  uint16_t width = state.screenSize[0];
+  uint16_t height = state.screenSize[1];
+
+  auto passScene = graph.addPass("Scene", {});
+  for(uint32_t i=0; i<fbCount; ++i) {
+    resFb[i] = graph.addResource({.name = "Color", .format = fmt, .width = width, .height = height, .persistent = true});
+    graph.use(passScene, resFb[i]);
+  }
+  if(hasDepth) {
+    resDepth = graph.addResource({
+      .name = "Depth", .format = FMT_RGBA16, .width = width, .height = height,
+      .heap = RenderGraph::Heap::TOP, .persistent = isDepthPersistent()
+    });
+    graph.use(passScene, resDepth);
   }
+  graph.compile();
 
-  VI::SwapChain::setFrameBuffers(surfFbColor);
+  for(uint32_t i=0; i<fbCount; ++i) {
+    surfFbColor[i] = surface_make_sub(&graph.get(resFb[i]), 0, 0, width, height);
+  }
+
+  dynResEnabled = scene.getConf().flags & SceneConf::FLAG_DYN_RES;
+  dynResStep = 0;
+  dynResCounter = 0;
+  for(uint32_t i=0; i<3; ++i) {
+    ticksPassStart[i] = 0;
+    ticksPassEnd[i] = 0;
+  }
+
+  VI::SwapChain::setFrameBuffers(surfFbColor, fbCount);
 
   VI::SwapChain::setDrawPass([this](surface_t *surf, uint32_t fbIndex, auto done) {
+    if(dynResEnabled) {
+      updateDynRes(fbIndex);
+      // buffers keep the full size, the VI scales up whatever width was drawn into it
+      *surf = surface_make_sub(&graph.get(resFb[fbIndex]), 0, 0, state.renderSize[0], state.renderSize[1]);
+    }
+
     surfColor = surf;
-    surfDepth = &Mem::allocDepthBuffer(state.screenSize[0], state.screenSize[1]);
+    surfDepth = nullptr;
+    if(scene.getConf().hasDepth()) {
+      surfDepthView = surface_make_sub(&graph.get(resDepth), 0, 0, state.renderSize[0], state.renderSize[1]);
+      surfDepth = &surfDepthView;
+    }
+
+    passDoneCB = done;
+    ticksPassStart[fbIndex] = TICKS_READ();
 
     rdpq_attach(surf, surfDepth);
     scene.draw(VI::SwapChain::getDeltaTime());
 
     Debug::Overlay::draw(scene, surf);
-    rdpq_detach_cb((void(*)(void*))((void*)done), (void*)fbIndex);
+    rdpq_detach_cb(onPassDone, (void*)fbIndex);
   });
 }
 
 P64::RenderPipelineDefault::~RenderPipelineDefault()
 {
-  for(auto &fb : surfFbColor) {
-    if(fb.buffer)surface_free(&fb);
-  }
-  Mem::freeDepthBuffer();
+  state.renderSize[0] = state.screenSize[0];
+  state.renderSize[1] = state.screenSize[1];
 }
 
-void P64::RenderPipelineDefault::preDraw()
+void P64::RenderPipelineDefault::updateDynRes(uint32_t fbIndex)
 {
-  setupLayer();
+  // the buffer we are about to draw into is free, so its last pass must be done.
+  // This sample is a few frames old, which is fine given the hysteresis below.
+  if(ticksPassStart[fbIndex] == 0)return;
+  float passTime = (float)TICKS_TO_US(TICKS_DISTANCE(ticksPassStart[fbIndex], ticksPassEnd[fbIndex])) * (1.0f / 1e6f);
+  float budget = VI::SwapChain::getFrameBudget();
 
-  if(scene.getConf().flags & SceneConf::FLAG_CLR_DEPTH) {
-    t3d_screen_clear_depth();
+  if(passTime > budget * DYN_RES_BUDGET_HIGH) {
+    bool canStepDown = dynResStep < DYN_RES_STEP_COUNT-1;
+    dynResCounter = (!canStepDown || dynResCounter < 0) ? canStepDown : dynResCounter + 1;
+  } else if(dynResStep > 0) {
+    // cost is mostly fill-rate bound, so estimate the time at the next larger width
+    float passTimeUp = passTime * DYN_RES_STEPS[dynResStep-1] / DYN_RES_STEPS[dynResStep];
+    if(passTimeUp < budget * DYN_RES_BUDGET_LOW) {
+      dynResCounter = dynResCounter > 0 ? -1 : dynResCounter - 1;
+    } else {
+      dynResCounter = 0;
+    }
+  } else {
+    dynResCounter = 0;
   }
-  if(scene.getConf().flags & SceneConf::FLAG_CLR_COLOR) {
-    t3d_screen_clear_color(scene.getConf().clearColor);
+
+  if(dynResCounter >= DYN_RES_FRAMES_DOWN && dynResStep < DYN_RES_STEP_COUNT-1) {
+    ++dynResStep;
+    dynResCounter = 0;
+  } else if(dynResCounter <= -DYN_RES_FRAMES_UP) {
+    --dynResStep;
+    dynResCounter = 0;
   }
+
+  state.renderSize[0] = Math::alignDown(state.screenSize[0] * DYN_RES_STEPS[dynResStep] / 10, 8);
+}
+
+void P64::RenderPipelineDefault::preDraw()
+{
+  setupLayer();
+  clearBuffers();
 }
 
 void P64::RenderPipelineDefault::draw()
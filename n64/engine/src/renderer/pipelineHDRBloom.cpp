@@ -12,9 +12,6 @@
 #include "vi/swapChain.h"
 
 namespace {
-  constexpr int SCREEN_WIDTH = 320;
-  constexpr int SCREEN_HEIGHT = 240;
-
   constexpr bool DEBUG_BLOOM = false;
 
   P64::Renderer::HDR::Config config{
@@ -30,23 +27,53 @@ namespace {
 
 void P64::RenderPipelineHDRBloom::init()
 {
-  // should be prevented in the editor already:
-  assertf(scene.getConf().screenWidth == SCREEN_WIDTH, "Ucode can only handle 320x240 resolution");
-  assertf(scene.getConf().screenHeight == SCREEN_HEIGHT, "Ucode can only handle 320x240 resolution");
-  assertf(!(scene.getConf().flags & SceneConf::FLAG_SCR_32BIT), "Ucode can only handle RGBA16 output");
-
-  for(auto &fb : surfFbColor) {
-    fb = surface_alloc(FMT_RGBA16, SCREEN_WIDTH, SCREEN_HEIGHT);
-    Mem::clearSurface(fb);
+  const auto &sceneConf = scene.getConf();
+  bool is32Bit = sceneConf.flags & SceneConf::FLAG_SCR_32BIT;
+  auto quality = (Renderer::HDR::Quality)sceneConf.bloomQuality;
+  Renderer::HDR::applyQuality(config, quality);
+
+  uint32_t fbCount = sceneConf.getFrameBufferCount();
+  auto passScene = graph.addPass("Scene", {});
+  auto passPost = graph.addPass("Bloom", {});
+  auto pass2D = graph.addPass("2D", {});
+
+  RenderGraph::ResId resFb[BUFF_COUNT]{};
+  for(uint32_t i=0; i<fbCount; ++i) {
+    resFb[i] = graph.addResource({
+      .name = "Color", .format = is32Bit ? FMT_RGBA32 : FMT_RGBA16,
+      .width = sceneConf.screenWidth, .height = sceneConf.screenHeight, .persistent = true
+    });
+    graph.use(passPost, resFb[i]);
+    graph.use(pass2D, resFb[i]);
+  }
+  if(sceneConf.hasDepth()) {
+    resDepth = graph.addResource({
+      .name = "Depth", .format = FMT_RGBA16, .width = (uint16_t)state.screenSize[0], .height = (uint16_t)state.screenSize[1],
+      .heap = RenderGraph::Heap::TOP, .persistent = isDepthPersistent()
+    });
+    graph.use(passScene, resDepth);
+  }
+
+  // buffers depend on the resolution, the ucode is only used for 320x240 (RGBA16) and falls back to the RDP otherwise
+  for(auto &pp : postProc) {
+    pp.declare(graph, passScene, passPost, sceneConf.screenWidth, sceneConf.screenHeight,
+      Renderer::HDR::getScaleFactor(quality), is32Bit);
+  }
+  graph.compile();
+
+  for(uint32_t i=0; i<fbCount; ++i) {
+    surfFbColor[i] = graph.get(resFb[i]);
+    Mem::clearSurface(surfFbColor[i]);
   }
+  for(auto &pp : postProc)pp.init(graph);
 
   RspHDR::init();
 
-  VI::SwapChain::setFrameBuffers(surfFbColor);
+  VI::SwapChain::setFrameBuffers(surfFbColor, fbCount);
 
   VI::SwapChain::setDrawPass([this](surface_t *surf, uint32_t fbIndex, auto done) {
     surfColor = surf;
-    surfDepth = &Mem::allocDepthBuffer(state.screenSize[0], state.screenSize[1]);
+    surfDepth = scene.getConf().hasDepth() ? &graph.get(resDepth) : nullptr;
 
     rdpq_attach(surf, surfDepth);
     fb = surf;
@@ -58,12 +85,7 @@ void P64::RenderPipelineHDRBloom::init()
 
 P64::RenderPipelineHDRBloom::~RenderPipelineHDRBloom()
 {
-  for(auto &fb : surfFbColor) {
-    if(fb.buffer)surface_free(&fb);
-  }
-
   RspHDR::destroy();
-  Mem::freeDepthBuffer();
 }
 
 void P64::RenderPipelineHDRBloom::preDraw()
@@ -71,27 +93,26 @@ void P64::RenderPipelineHDRBloom::preDraw()
   //rdpq_set_color_image(&surfHDRSafe);
   setupLayer();
 
+  // with half-rate/split bloom, only every second frame starts a new one
+  bool newBloom = config.updateMode == Renderer::HDR::BloomUpdate::FULL || (bloomFrame++ & 1) == 0;
   postProc[frameIdx].setConf(config);
-  postProc[frameIdx].beginFrame();
+  postProc[frameIdx].beginFrame(newBloom);
 
-  if(scene.getConf().flags & SceneConf::FLAG_CLR_DEPTH) {
-    t3d_screen_clear_depth();
-  }
-  if(scene.getConf().flags & SceneConf::FLAG_CLR_COLOR) {
-    t3d_screen_clear_color(scene.getConf().clearColor);
-  }
+  clearBuffers();
 }
 
 void P64::RenderPipelineHDRBloom::draw()
 {
   uint32_t frameIdxLast = (frameIdx+BUFF_COUNT-1) % BUFF_COUNT;
+  uint32_t frameIdxPrev = (frameIdx+BUFF_COUNT-2) % BUFF_COUNT;
 
   DrawLayer::draw3D();
   DrawLayer::drawPtx();
 
   postProc[frameIdx].endFrame();
   assert(fb != nullptr);
-  auto surfBlur = postProc[frameIdxLast].applyEffects(*fb);
+  auto &surfBlur = postProc[frameIdxLast].applyEffects(*fb, lastBloom, &postProc[frameIdxPrev]);
+  lastBloom = &surfBlur;
 
   rdpq_sync_pipe();
   rdpq_set_color_image(fb);
@@ -108,8 +129,8 @@ void P64::RenderPipelineHDRBloom::draw()
     rdpq_mode_filter(FILTER_POINT);
 
     rdpq_blitparms_t param{};
-    param.scale_x = 4.0f;
-    param.scale_y = 4.0f;
+    param.scale_x = (float)fb->width / surfBlur.width;
+    param.scale_y = (float)fb->height / surfBlur.height;
     rdpq_tex_blit(&surfBlur, 0, 0, &param);
   }
 
@@ -0,0 +1,156 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/renderGraph.h"
+#include "lib/logger.h"
+#include "lib/math.h"
+#include "lib/memory.h"
+
+#include <algorithm>
+
+namespace
+{
+  constexpr const char* HEAP_NAMES[] = {"Main", "Top"};
+}
+
+bool P64::RenderGraph::isAliasable(const Resource &a, const Resource &b) const
+{
+  if(a.desc.heap != b.desc.heap)return false;
+  if(a.desc.persistent || b.desc.persistent)return false;
+  return a.lastPass < b.firstPass || b.lastPass < a.firstPass;
+}
+
+P64::RenderGraph::ResId P64::RenderGraph::addResource(const ResourceDesc &desc)
+{
+  assertf(!compiled, "RenderGraph: can't add '%s' after compiling", desc.name);
+  assertf(resCount < MAX_RESOURCES, "RenderGraph: too many resources");
+  auto &res = resources[resCount];
+  res = {};
+  res.desc = desc;
+  res.size = Math::alignUp(TEX_FORMAT_PIX2BYTES(desc.format, desc.width) * desc.height, ALIGNMENT);
+  return resCount++;
+}
+
+P64::RenderGraph::PassId P64::RenderGraph::addPass(const char* name, std::initializer_list<ResId> usedRes)
+{
+  assertf(!compiled, "RenderGraph: can't add '%s' after compiling", name);
+  assertf(passCount < MAX_PASSES, "RenderGraph: too many passes");
+  passes[passCount] = {name};
+  PassId pass = passCount++;
+  for(auto res : usedRes)use(pass, res);
+  return pass;
+}
+
+void P64::RenderGraph::use(PassId pass, ResId resId)
+{
+  assertf(resId < resCount && pass < passCount, "RenderGraph: invalid pass/resource");
+  auto &res = resources[resId];
+  if(res.firstPass < 0 || pass < res.firstPass)res.firstPass = pass;
+  if(pass > res.lastPass)res.lastPass = pass;
+}
+
+void P64::RenderGraph::compile()
+{
+  assertf(!compiled, "RenderGraph: already compiled");
+
+  // biggest first, smaller ones then fill the gaps next to them
+  ResId order[MAX_RESOURCES];
+  for(ResId i=0; i<resCount; ++i) {
+    assertf(resources[i].firstPass >= 0, "RenderGraph: '%s' is not used by any pass", resources[i].desc.name);
+    order[i] = i;
+  }
+  std::sort(order, order + resCount, [this](ResId a, ResId b) {
+    return resources[a].size > resources[b].size;
+  });
+
+  // first-fit: move past every placed target it can't alias with, until nothing overlaps anymore
+  for(uint32_t i=0; i<resCount; ++i)
+  {
+    auto &res = resources[order[i]];
+    res.offset = 0;
+    for(bool moved = true; moved;)
+    {
+      moved = false;
+      for(uint32_t j=0; j<i; ++j)
+      {
+        auto &other = resources[order[j]];
+        if(other.desc.heap != res.desc.heap || isAliasable(res, other))continue;
+        bool overlaps = res.offset < other.offset + other.size && other.offset < res.offset + res.size;
+        if(overlaps) {
+          res.offset = other.offset + other.size;
+          moved = true;
+        }
+      }
+    }
+    auto &size = heapSize[(uint32_t)res.desc.heap];
+    size = std::max(size, res.offset + res.size);
+  }
+
+  for(uint32_t h=0; h<(uint32_t)Heap::COUNT; ++h) {
+    if(heapSize[h] == 0)continue;
+    if((Heap)h == Heap::TOP) {
+      heapData[h] = Mem::allocTop(heapSize[h]);
+    } else {
+      heapData[h] = malloc_uncached_aligned(ALIGNMENT, heapSize[h]);
+      assertf(heapData[h], "RenderGraph: failed to allocate %lu bytes", heapSize[h]);
+    }
+    Mem::track(Mem::Category::RENDER_TARGETS, heapSize[h]);
+  }
+
+  for(ResId i=0; i<resCount; ++i) {
+    auto &res = resources[i];
+    auto data = (uint8_t*)heapData[(uint32_t)res.desc.heap] + res.offset;
+    res.surf = surface_make(data, res.desc.format, res.desc.width, res.desc.height,
+      TEX_FORMAT_PIX2BYTES(res.desc.format, res.desc.width));
+  }
+
+  compiled = true;
+  Log::info("RenderGraph: %lu KB, %lu KB without aliasing", getAllocSize() / 1024, getRequestedSize() / 1024);
+}
+
+void P64::RenderGraph::reset()
+{
+  for(uint32_t h=0; h<(uint32_t)Heap::COUNT; ++h) {
+    if(!heapData[h])continue;
+    if((Heap)h == Heap::TOP) {
+      Mem::freeTop();
+    } else {
+      free_uncached(heapData[h]);
+    }
+    Mem::track(Mem::Category::RENDER_TARGETS, -(int32_t)heapSize[h]);
+    heapData[h] = nullptr;
+    heapSize[h] = 0;
+  }
+  resCount = 0;
+  passCount = 0;
+  compiled = false;
+}
+
+uint32_t P64::RenderGraph::getAllocSize() const
+{
+  uint32_t size = 0;
+  for(auto s : heapSize)size += s;
+  return size;
+}
+
+uint32_t P64::RenderGraph::getRequestedSize() const
+{
+  uint32_t size = 0;
+  for(ResId i=0; i<resCount; ++i)size += resources[i].size;
+  return size;
+}
+
+void P64::RenderGraph::log() const
+{
+  for(PassId p=0; p<passCount; ++p) {
+    Log::info("  Pass %d: %s", p, passes[p].name);
+  }
+  for(ResId i=0; i<resCount; ++i) {
+    auto &res = resources[i];
+    Log::info("  %-10s %3dx%3d %4s %6lu KB @%6lu, pass %d-%d%s",
+      res.desc.name, res.desc.width, res.desc.height, HEAP_NAMES[(uint32_t)res.desc.heap],
+      res.size / 1024, res.offset, res.firstPass, res.lastPass, res.desc.persistent ? " (persistent)" : ""
+    );
+  }
+}
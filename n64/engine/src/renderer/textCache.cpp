@@ -0,0 +1,36 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "renderer/textCache.h"
+#include <cstring>
+#include <malloc.h>
+
+void P64::TextCache::print(const rdpq_textparms_t *parms, uint8_t font, float x, float y, const char *newText)
+{
+  rdpq_textparms_t newParams = parms ? *parms : rdpq_textparms_t{};
+
+  bool changed = !paragraph || font != fontId || strcmp(newText, text) != 0
+    || memcmp(&newParams, &params, sizeof(params)) != 0;
+
+  if(changed) {
+    clear();
+    int bytes = strlen(newText);
+    text = (char*)malloc(bytes + 1);
+    memcpy(text, newText, bytes + 1);
+    paragraph = rdpq_paragraph_build(&newParams, font, text, &bytes);
+    params = newParams;
+    fontId = font;
+  }
+
+  // glyphs are placed relative to the origin, this only records the draws
+  rdpq_paragraph_render(paragraph, x, y);
+}
+
+void P64::TextCache::clear()
+{
+  if(paragraph)rdpq_paragraph_free(paragraph);
+  paragraph = nullptr;
+  free(text);
+  text = nullptr;
+}
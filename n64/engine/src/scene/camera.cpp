@@ -24,13 +24,41 @@ void P64::Camera::update([[maybe_unused]] float deltaTime)
 {
   t3d_viewport_set_perspective(&viewports, fov, aspectRatio, near, far);
   t3d_viewport_set_view_matrix(&viewports, &viewMatrix);
+
+  // lets culling test against all cameras up front, without attaching each one first
+  T3DMat4 camProj;
+  t3d_mat4_mul(&camProj, &viewports.matProj, &viewMatrix);
+  t3d_mat4_to_frustum(&frustum, &camProj);
 }
 
-void P64::Camera::attach() {
+void P64::Camera::attach()
+{
+  if(areaRenderWidth != state.renderSize[0]) {
+    areaRenderWidth = state.renderSize[0];
+    uint32_t fullWidth = state.screenSize[0] ? state.screenSize[0] : areaRenderWidth;
+    t3d_viewport_set_area(viewports,
+      screenArea[0] * areaRenderWidth / fullWidth, screenArea[1],
+      screenArea[2] * areaRenderWidth / fullWidth, screenArea[3]
+    );
+  }
+
+  // squeeze the depth into this frames slice (see 'RenderPipeline::nextDepthSlice'), only touches clip-space Z.
+  // culling still uses the full range, the frustum got computed in 'update' already
+  if(state.depthSliceCount > 1) {
+    t3d_viewport_set_perspective(&viewports, fov, aspectRatio, near, far);
+    float scale = 1.0f / (float)state.depthSliceCount;
+    float offset = 1.0f - (2.0f * (float)state.depthSlice + 1.0f) * scale;
+    for(auto &col : viewports.matProj.m) {
+      col[2] = col[2] * scale + col[3] * offset;
+    }
+  }
   t3d_viewport_attach(viewports);
 }
 
 void P64::Camera::setScreenArea(int x, int y, int width, int height) {
+  screenArea[0] = x; screenArea[1] = y;
+  screenArea[2] = width; screenArea[3] = height;
+  areaRenderWidth = 0;
   t3d_viewport_set_area(viewports, x,y, width, height);
 }
 
@@ -13,6 +13,8 @@
 #include "scene/components/collMesh.h"
 #include "scene/components/collBody.h"
 #include "scene/components/audio2d.h"
+#include "scene/components/audio3d.h"
+#include "scene/components/particleEmitter.h"
 #include "scene/components/constraint.h"
 #include "scene/components/culling.h"
 #include "scene/components/nodeGraph.h"
@@ -63,5 +65,24 @@ namespace P64
     SET_COMP(Culling),
     SET_COMP(NodeGraph),
     SET_COMP(AnimModel),
+    SET_COMP(Audio3D),
+    SET_COMP(ParticleEmitter),
+  };
+
+  const uint8_t COMP_DISPATCH_ORDER[COMP_TABLE_SIZE] {
+    Comp::Constraint::ID,
+    Comp::Culling::ID,
+    Comp::Code::ID,
+    Comp::Model::ID,
+    Comp::Light::ID,
+    Comp::Camera::ID,
+    Comp::CollMesh::ID,
+    Comp::CollBody::ID,
+    Comp::Audio2D::ID,
+    Comp::NodeGraph::ID,
+    Comp::AnimModel::ID,
+    Comp::Audio3D::ID,
+    Comp::ParticleEmitter::ID,
+    11, 14, 15 // unused
   };
 }
@@ -7,9 +7,12 @@
 #include "scene/components/animModel.h"
 #include "assets/assetManager.h"
 #include <t3d/t3dmodel.h>
+#include <unordered_map>
 
 #include "../../renderer/bigtex/bigtex.h"
 #include "renderer/material.h"
+#include "renderer/drawQueue.h"
+#include "renderer/matrixBatch.h"
 #include "scene/scene.h"
 #include "scene/sceneManager.h"
 
@@ -21,20 +24,125 @@ namespace
     uint8_t layer;
     uint8_t flags;
     P64::Renderer::Material material;
+    float lodDist;
+    uint8_t lodRate; // updates per second when far away
   };
+
+  /**
+   * Blend skeletons are only needed while updating an instance, so one per animation
+   * and model is shared by all instances, using the same anim always writes the same bones.
+   */
+  struct SharedSkeletons
+  {
+    std::vector<T3DSkeleton*> blend{}; // per animation, created on the first blend
+    uint32_t refCount{0};
+    uint32_t animCount{0};
+  };
+
+  std::unordered_map<const T3DModel*, SharedSkeletons> sharedSkeletons{};
+
+  uint32_t getBoneCount(const T3DModel *model) {
+    return t3d_model_get_skeleton(model)->boneCount;
+  }
 }
 
 namespace P64::Comp
 {
+  T3DAnim* AnimModel::getAnim(int16_t idx)
+  {
+    assertf(idx >= 0 && idx < animCount, "AnimModel: invalid animation index %d", idx);
+    if(anims[idx])return anims[idx];
+
+    auto it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_ANIM);
+    int16_t i = 0;
+    while(t3d_model_iter_next(&it)) {
+      if(i++ != idx)continue;
+      anims[idx] = (T3DAnim*)malloc(sizeof(T3DAnim));
+      *anims[idx] = t3d_anim_create(model, it.anim->name); // @TOOD: add  create by-index to t3d API
+      t3d_anim_attach(anims[idx], &skelMain);
+      ++sharedSkeletons[model].animCount;
+      break;
+    }
+    return anims[idx];
+  }
+
   void AnimModel::setMainAnim(int16_t idx) {
+    if (animIdxMain != idx && idx >= 0) {
+      t3d_anim_attach(getAnim(idx), &skelMain);
+    }
     animIdxMain = idx;
   }
 
-  void AnimModel::setBlendAnim(int16_t idx) {
-    if (animIdxBlend != idx) {
-      t3d_anim_attach(&anims[idx], &skelAnim[idx]);
+  void AnimModel::setLayerAnim(uint32_t layer, int16_t idx) {
+    assertf(layer < MAX_LAYERS, "AnimModel: invalid layer %lu", layer);
+    if (layers[layer].animIdx != idx && idx >= 0) {
+      auto &shared = sharedSkeletons[model];
+      if(!shared.blend[idx]) {
+        shared.blend[idx] = (T3DSkeleton*)malloc(sizeof(T3DSkeleton));
+        *shared.blend[idx] = t3d_skeleton_clone(&skelMain, false);
+      }
+      t3d_anim_attach(getAnim(idx), shared.blend[idx]);
+    }
+    layers[layer].animIdx = idx;
+
+    layerCount = 0;
+    for(uint32_t l=0; l<MAX_LAYERS; ++l) {
+      if(layers[l].animIdx >= 0)layerCount = l + 1;
+    }
+  }
+
+  uint8_t* AnimModel::getLayerMask(uint32_t layer) {
+    assertf(layer < MAX_LAYERS, "AnimModel: invalid layer %lu", layer);
+    auto &mask = layers[layer].boneMask;
+    if(!mask) {
+      uint32_t boneCount = skelMain.skeletonRef->boneCount;
+      mask = (uint8_t*)malloc(boneCount);
+      memset(mask, 0xFF, boneCount);
+    }
+    return mask;
+  }
+
+  bool AnimModel::setLayerMask(uint32_t layer, const char* boneName, float weight) {
+    assertf(layer < MAX_LAYERS, "AnimModel: invalid layer %lu", layer);
+    if(!boneName) {
+      free(layers[layer].boneMask);
+      layers[layer].boneMask = nullptr;
+      return true;
+    }
+
+    int rootIdx = t3d_skeleton_find_bone(&skelMain, boneName);
+    if(rootIdx < 0)return false;
+
+    auto skel = skelMain.skeletonRef;
+    auto mask = getLayerMask(layer);
+    auto maskVal = (uint8_t)(fminf(fmaxf(weight, 0.0f), 1.0f) * 255.0f);
+
+    for(uint32_t b=0; b<skel->boneCount; ++b) {
+      // walk up the hierarchy to check if the root bone is a parent
+      uint32_t idx = b;
+      while(idx != (uint32_t)rootIdx && skel->bones[idx].parentIdx != 0xFFFF) {
+        idx = skel->bones[idx].parentIdx;
+      }
+      mask[b] = (idx == (uint32_t)rootIdx) ? maskVal : 0;
+    }
+    return true;
+  }
+
+  void AnimModel::getSkeletonStats(std::vector<SkeletonStats> &out)
+  {
+    out.clear();
+    for(auto &[model, shared] : sharedSkeletons)
+    {
+      uint32_t boneCount = getBoneCount(model);
+      uint32_t sizeMain = boneCount * (sizeof(T3DBone) + sizeof(T3DMat4FP) * 3);
+      uint32_t sizeBlend = boneCount * sizeof(T3DBone);
+
+      SkeletonStats stats{shared.refCount, shared.animCount, sizeMain * shared.refCount};
+      for(auto skel : shared.blend) {
+        if(skel)stats.byteSize += sizeBlend;
+      }
+      out.push_back(stats);
     }
-    animIdxBlend = idx;
   }
 
 
@@ -43,22 +151,30 @@ namespace P64::Comp
     return sizeof(AnimModel);
   }
 
-  void AnimModel::initDelete([[maybe_unused]] Object& obj, AnimModel* data, void* initData_)
+  void AnimModel::initDelete(Object& obj, AnimModel* data, void* initData_)
   {
     auto *initData = (InitData*)initData_;
     if (initData == nullptr) {
-
-      auto it = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_ANIM);
-      uint32_t i=0;
-      while(t3d_model_iter_next(&it)) {
-        t3d_anim_destroy(&data->anims[i]);
-        t3d_skeleton_destroy(&data->skelAnim[i]);
-        ++i;
+      auto &shared = sharedSkeletons[data->model];
+      for(uint32_t i=0; i<data->animCount; ++i) {
+        if(!data->anims[i])continue;
+        t3d_anim_destroy(data->anims[i]);
+        free(data->anims[i]);
+        --shared.animCount;
       }
+      for(auto &layer : data->layers)free(layer.boneMask);
       t3d_skeleton_destroy(&data->skelMain);
-      free(data->skelAnim);
       free(data->anims);
 
+      if(--shared.refCount == 0) {
+        for(auto skel : shared.blend) {
+          if(!skel)continue;
+          t3d_skeleton_destroy(skel);
+          free(skel);
+        }
+        sharedSkeletons.erase(data->model);
+      }
+
       data->~AnimModel();
       return;
     }
@@ -70,6 +186,12 @@ namespace P64::Comp
     data->layerIdx = initData->layer;
     data->flags = initData->flags;
     data->material = initData->material;
+    data->lodDist2 = initData->lodDist * initData->lodDist;
+    if(initData->lodRate != 0) {
+      data->lodInterval = 1.0f / initData->lodRate;
+      // spread out updates of objects using the same rate, avoids spikes with many of them
+      data->animTime = (obj.id % 4) * data->lodInterval * 0.25f;
+    }
 
     /*bool isBigTex = SceneManager::getCurrent().getConf().pipeline == SceneConf::Pipeline::BIG_TEX_256;
 
@@ -78,31 +200,17 @@ namespace P64::Comp
       return;
     }*/
 
-    // @TODO: all of this is rather hacky and unoptimized
-    // @TODO: refactor and rethink animations here
-
-    auto animCount = t3d_model_get_animation_count(data->model);
+    // @TODO: handles names vs indices in the public API
+    data->animCount = t3d_model_get_animation_count(data->model);
 
-    // one main skeleton for drawing, others for potential blending
+    // one main skeleton for drawing, animations and blend skeletons are created on first use
     data->skelMain = t3d_skeleton_create_buffered(data->model, 3); // @TODO: take from scene settings once added
-    data->skelAnim = static_cast<T3DSkeleton*>(malloc(sizeof(T3DSkeleton) * animCount));
-    data->anims = static_cast<T3DAnim*>(malloc(sizeof(T3DAnim) * animCount));
-
-    t3d_skeleton_update(&data->skelMain);
+    data->anims = static_cast<T3DAnim**>(calloc(data->animCount, sizeof(T3DAnim*)));
 
-    auto it = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_ANIM);
-    uint32_t i = 0;
+    auto &shared = sharedSkeletons[data->model];
+    if(shared.refCount++ == 0)shared.blend.resize(data->animCount, nullptr);
 
-    // @TODO: handles names vs indices in the public API
-
-    //debugf("AnimModel: count=%lu\n", animCount);
-    while(t3d_model_iter_next(&it)) {
-      data->skelAnim[i] = t3d_skeleton_clone(&data->skelMain, false);
-      data->anims[i] = t3d_anim_create(data->model, it.anim->name); // @TOOD: add  create by-index to t3d API
-      t3d_anim_attach(&data->anims[i], &data->skelMain); // by default assuming anything is attached to the main skeleton
-      //debugf(" - %s: %lu\n", it.anim->name, i);
-      ++i;
-    }
+    t3d_skeleton_update(&data->skelMain);
 
     T3DModelState state = t3d_model_state_create();
     state.drawConf = nullptr;
@@ -112,10 +220,12 @@ namespace P64::Comp
     rspq_block_begin();
 
     auto boneSeg = (const T3DMat4FP*)t3d_segment_placeholder(T3D_SEGMENT_SKELETON);
-    it = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_OBJECT);
+    auto it = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_OBJECT);
     while(t3d_model_iter_next(&it))
     {
       it.object->material->blendMode = 0;
+      // no depth to write to, the RSP can skip calculating it
+      if(!DrawLayer::hasDepth())it.object->material->renderFlags &= ~T3D_FLAG_DEPTH;
       t3d_model_draw_material(it.object->material, &state);
       t3d_model_draw_object(it.object, boneSeg);
     }
@@ -125,18 +235,57 @@ namespace P64::Comp
   }
 
   void AnimModel::update(Object&obj, AnimModel* data, float deltaTime) {
+    // visibility is only known from draws of the last frame, this may cause one outdated pose when appearing
+    bool wasDrawn = data->state & STATE_DRAWN;
+    bool wasFar = data->state & STATE_FAR;
+    data->state = data->lodDist2 > 0.0f ? STATE_FAR : 0;
+
+    data->animTime += deltaTime;
+    if(!wasDrawn && (data->flags & FLAG_SKIP_CULLED))return;
+    if(wasFar && data->animTime < data->lodInterval)return;
+
+    float animDelta = data->animTime;
+    data->animTime = 0.0f;
+
     if (data->animIdxMain >= 0) {
-      t3d_anim_update(&data->anims[data->animIdxMain], deltaTime);
+      t3d_anim_update(data->anims[data->animIdxMain], animDelta);
+    }
+    if (data->layerCount == 0) {
+      t3d_skeleton_update(&data->skelMain);
+      return;
     }
-    if (data->animIdxBlend >= 0) {
-      t3d_anim_update(&data->anims[data->animIdxBlend], deltaTime);
 
-      t3d_skeleton_blend(
-        &data->skelMain,
-        &data->skelMain,
-        &data->skelAnim[data->animIdxBlend],
-        data->blendFactor
-      );
+    // blend skeletons are shared, they have to be consumed right after the update
+    auto &shared = sharedSkeletons[data->model];
+    const T3DSkeleton* layerSkel[MAX_LAYERS]{};
+    for(uint32_t l=0; l<data->layerCount; ++l) {
+      auto &layer = data->layers[l];
+      if(layer.animIdx < 0 || layer.weight <= 0.0f)continue;
+      t3d_anim_update(data->anims[layer.animIdx], animDelta);
+      layerSkel[l] = shared.blend[layer.animIdx];
+    }
+
+    // apply all layers per bone in one pass, this also handles the per-bone masks
+    uint32_t boneCount = data->skelMain.skeletonRef->boneCount;
+    for(uint32_t b=0; b<boneCount; ++b)
+    {
+      T3DBone &bone = data->skelMain.bones[b];
+      for(uint32_t l=0; l<data->layerCount; ++l)
+      {
+        if(!layerSkel[l])continue;
+        auto &layer = data->layers[l];
+        float weight = layer.weight;
+        if(layer.boneMask) {
+          if(layer.boneMask[b] == 0)continue;
+          weight *= layer.boneMask[b] * (1.0f / 255.0f);
+        }
+
+        const T3DBone &boneLayer = layerSkel[l]->bones[b];
+        t3d_vec3_lerp(&bone.position, &bone.position, &boneLayer.position, weight);
+        t3d_vec3_lerp(&bone.scale, &bone.scale, &boneLayer.scale, weight);
+        t3d_quat_nlerp(&bone.rotation, &bone.rotation, &boneLayer.rotation, weight);
+        bone.hasChanged = true;
+      }
     }
 
     t3d_skeleton_update(&data->skelMain);
@@ -144,18 +293,25 @@ namespace P64::Comp
 
   void AnimModel::draw(Object &obj, AnimModel* data, float deltaTime)
   {
-    auto mat = data->matFP.getNext();
-    t3d_mat4fp_from_srt(mat, obj.scale, obj.rot, obj.pos);
+    // with multiple cameras, being close to any of them counts
+    data->state |= STATE_DRAWN;
+    if(data->state & STATE_FAR) {
+      auto diff = obj.pos - obj.getScene().getActiveCamera().getPos();
+      if(t3d_vec3_len2(&diff) < data->lodDist2)data->state &= ~STATE_FAR;
+    }
 
-    if(data->layerIdx)DrawLayer::use3D(data->layerIdx);
+    MatrixBatch::prepare(data->matFP, obj.scale, obj.rot, obj.pos);
+    DrawQueue::submit(obj, data, drawQueued, data->material, (uint32_t)data->model, data->layerIdx);
+  }
 
-    data->material.begin(obj);
+  void AnimModel::drawQueued(Object &obj, void* data_)
+  {
+    auto data = (AnimModel*)data_;
+    auto mat = data->matFP.get(obj.scale, obj.rot, obj.pos);
 
     t3d_skeleton_use(&data->skelMain);
     t3d_matrix_set(mat, true);
+    obj.getScene().applyObjectLights(data->lightSel, obj.pos);
     rspq_block_run(data->model->userBlock);
-
-    data->material.end();
-    if(data->layerIdx)DrawLayer::useDefault();
   }
 }
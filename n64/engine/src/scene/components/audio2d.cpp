@@ -15,6 +15,8 @@ namespace
     uint16_t assetIdx;
     uint16_t volume;
     uint8_t flags;
+    uint8_t priority;
+    uint8_t maxInstances;
     uint8_t padding;
   };
 }
@@ -36,10 +38,12 @@ namespace P64::Comp
 
     data->volume = (float)initData->volume * (1.0f / 0xFFFF);
     data->flags = initData->flags;
+    data->priority = initData->priority;
+    data->maxInstances = initData->maxInstances;
     wav64_set_loop(data->audio, (data->flags & FLAG_LOOP) != 0);
 
     if(data->flags & FLAG_AUTO_PLAY) {
-      data->handle = AudioManager::play2D(data->audio);
+      data->handle = AudioManager::play2D(data->audio, data->priority, data->maxInstances);
       data->handle.setVolume(data->volume);
     }
   }
@@ -0,0 +1,131 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "scene/object.h"
+#include "scene/components/audio3d.h"
+
+#include "audio/audioManager.h"
+#include "assets/assetManager.h"
+
+namespace
+{
+  struct InitData
+  {
+    uint16_t assetIdx;
+    uint16_t volume;
+    float distMin;
+    float distMax;
+    uint8_t flags;
+    uint8_t priority;
+    uint8_t maxInstances;
+    uint8_t padding;
+  };
+
+  // how far sounds get panned to one side, full separation sounds odd on speakers
+  constexpr float PAN_AMOUNT = 0.8f;
+}
+
+namespace P64::Comp
+{
+  void Audio3D::initDelete(Object &obj, Audio3D* data, uint16_t* initData_)
+  {
+    auto initData = (InitData*)initData_;
+    if (initData == nullptr) {
+      data->handle.stop();
+      data->~Audio3D();
+      return;
+    }
+
+    new(data) Audio3D();
+
+    data->audio = (wav64_t*)AssetManager::getByIndex(initData->assetIdx);
+    assert(data->audio);
+
+    data->volume = (float)initData->volume * (1.0f / 0xFFFF);
+    data->distMin = initData->distMin;
+    data->distMax = fmaxf(initData->distMax, initData->distMin + 0.001f);
+    data->flags = initData->flags;
+    data->priority = initData->priority;
+    data->maxInstances = initData->maxInstances;
+    wav64_set_loop(data->audio, (data->flags & FLAG_LOOP) != 0);
+
+    if(data->flags & FLAG_AUTO_PLAY)play(data);
+  }
+
+  void Audio3D::play(Audio3D* data)
+  {
+    data->handle.stop();
+    data->virtualPos = 0.0f;
+    data->state = STATE_PLAYING | STATE_VIRTUAL;
+  }
+
+  void Audio3D::stop(Audio3D* data)
+  {
+    data->handle.stop();
+    data->state = 0;
+  }
+
+  Audio3D::Listener Audio3D::getListener(const Camera &cam)
+  {
+    Listener listener{.pos = cam.getPos()};
+    fm_vec3_t dir = cam.getViewDir();
+    fm_vec3_t up{0, 1, 0};
+    fm_vec3_cross(&listener.right, &dir, &up);
+    fm_vec3_norm(&listener.right, &listener.right);
+    return listener;
+  }
+
+  void Audio3D::updateSpatial(const Object &obj, Audio3D* data, const Listener &listener, float deltaTime)
+  {
+    if(!(data->state & STATE_PLAYING))return;
+
+    fm_vec3_t diff;
+    fm_vec3_sub(&diff, &obj.pos, &listener.pos);
+    float dist2 = fm_vec3_len2(&diff);
+
+    if(dist2 > data->distMax * data->distMax)
+    {
+      if(!(data->state & STATE_VIRTUAL)) {
+        data->virtualPos = data->handle.getPosition();
+        data->handle.stop();
+        data->state |= STATE_VIRTUAL;
+      }
+
+      // keep the playback position moving, so it can resume where it would be by now
+      auto &wave = data->audio->wave;
+      data->virtualPos += deltaTime * wave.frequency;
+      if(data->virtualPos >= wave.len) {
+        if(wave.loop_len == 0) {
+          data->state = 0;
+          return;
+        }
+        data->virtualPos = fmodf(data->virtualPos - (wave.len - wave.loop_len), wave.loop_len) + (wave.len - wave.loop_len);
+      }
+      return;
+    }
+
+    if(data->state & STATE_VIRTUAL) {
+      data->handle = AudioManager::play2D(data->audio, data->priority, data->maxInstances);
+      if(data->handle.isDone())return; // no channel free, try again next frame
+      if(data->virtualPos > 0.0f)data->handle.setPosition(data->virtualPos);
+      data->state &= ~STATE_VIRTUAL;
+    } else if(data->handle.isDone()) {
+      data->state = 0; // finished or stolen by a more important sound
+      return;
+    }
+
+    float dist = sqrtf(dist2);
+    float att = 1.0f;
+    if(dist > data->distMin) {
+      att = (data->distMax - dist) / (data->distMax - data->distMin);
+      att *= att;
+    }
+
+    float pan = 0.5f;
+    if(dist > 0.0001f) {
+      pan += t3d_vec3_dot(&diff, &listener.right) / dist * (0.5f * PAN_AMOUNT);
+    }
+    data->handle.setVolume(data->volume * att, pan);
+  }
+}
@@ -23,6 +23,7 @@ void P64::Comp::Camera::initDelete(Object &obj, Camera* data, InitData* initData
   cam.fov  = initData->fov;
   cam.near = initData->near;
   cam.far  = initData->far;
+  cam.layerMask = initData->layerMask;
 
   cam.aspectRatio = initData->aspectRatio;
   if(cam.aspectRatio <= 0) {
@@ -31,3 +32,14 @@ void P64::Comp::Camera::initDelete(Object &obj, Camera* data, InitData* initData
 
   cam.setPosRot(obj.pos, obj.rot);
 }
+
+void P64::Comp::Camera::onEvent(Object &obj, Camera* data, const ObjectEvent &event)
+{
+  // cameras belong to the scene, persistent objects move theirs along
+  if(event.type == EVENT_TYPE_SCENE_LEAVE) {
+    SceneManager::getCurrent().removeCamera(&data->camera);
+  }
+  if(event.type == EVENT_TYPE_SCENE_ENTER) {
+    SceneManager::getCurrent().addCamera(&data->camera);
+  }
+}
@@ -51,10 +51,13 @@ namespace P64::Comp
 
   void CollBody::onEvent(Object &obj, CollBody* data, const ObjectEvent &event)
   {
-    if(event.type == EVENT_TYPE_DISABLE) {
+    // disabled objects are not registered, moving to another scene keeps that state
+    bool leave = event.type == EVENT_TYPE_DISABLE || (event.type == EVENT_TYPE_SCENE_LEAVE && obj.isEnabled());
+    bool enter = event.type == EVENT_TYPE_ENABLE || (event.type == EVENT_TYPE_SCENE_ENTER && obj.isEnabled());
+    if(leave) {
       return obj.getScene().getCollision().unregisterBCS(&data->bcs);
     }
-    if(event.type == EVENT_TYPE_ENABLE) {
+    if(enter) {
       return obj.getScene().getCollision().registerBCS(&data->bcs);
     }
   }
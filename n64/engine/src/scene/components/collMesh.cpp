@@ -17,10 +17,12 @@ namespace
   {
     uint16_t assetIdx;
     uint8_t flags;
-    uint8_t _padding;
+    uint8_t maskWrite;
   };
 
   constexpr uint8_t FLAG_EXTERNAL = 1 << 0;
+  constexpr uint8_t FLAG_STATIC   = 1 << 1;
+  constexpr uint8_t FLAG_TRI_CACHE = 1 << 2;
 }
 
 namespace P64::Comp
@@ -38,6 +40,10 @@ namespace P64::Comp
         obj.getScene().getCollision().unregisterMesh(&data->meshInstance);
       }
 
+      if(data->meshInstance.triCache) {
+        data->meshInstance.mesh->releaseTriCache();
+      }
+      data->meshInstance.freeBaked();
       data->~CollMesh();
       return;
     }
@@ -57,16 +63,26 @@ namespace P64::Comp
     }
 
     data->meshInstance.object = &obj;
+    data->meshInstance.maskWrite = initData->maskWrite;
     data->meshInstance.mesh = Coll::Mesh::load(rawData);
+    if(data->flags & FLAG_STATIC) {
+      data->meshInstance.bake();
+    }
+    if(data->flags & FLAG_TRI_CACHE) {
+      data->meshInstance.triCache = data->meshInstance.mesh->acquireTriCache();
+    }
     obj.getScene().getCollision().registerMesh(&data->meshInstance);
   }
 
   void CollMesh::onEvent(Object &obj, CollMesh* data, const ObjectEvent &event)
   {
-    if(event.type == EVENT_TYPE_DISABLE) {
+    // same as for bodies, see 'CollBody::onEvent'
+    bool leave = event.type == EVENT_TYPE_DISABLE || (event.type == EVENT_TYPE_SCENE_LEAVE && obj.isEnabled());
+    bool enter = event.type == EVENT_TYPE_ENABLE || (event.type == EVENT_TYPE_SCENE_ENTER && obj.isEnabled());
+    if(leave) {
       return obj.getScene().getCollision().unregisterMesh(&data->meshInstance);
     }
-    if(event.type == EVENT_TYPE_ENABLE) {
+    if(enter) {
       obj.getScene().getCollision().registerMesh(&data->meshInstance);
     }
   }
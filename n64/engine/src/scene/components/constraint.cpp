@@ -49,29 +49,18 @@ namespace P64::Comp
     }
   }
 
-  void Constraint::update(Object &obj, Constraint* data, float deltaTime)
+  void Constraint::apply(Object &obj, const Constraint* data, const Object &refObj)
   {
-    if(data->type == TYPE_COPY_CAM)return;
-
-    auto &sc = obj.getScene();
-    auto refObj = sc.getObjectById(data->refObjId);
-    if(!refObj)return;
-
-    /*debugf("Constraint update: obj %d, refObj %d | pos: (%f, %f, %f)\n",
-      obj.id, refObj->id,
-      (double)refObj->pos.x, (double)refObj->pos.y, (double)refObj->pos.z
-    );*/
-
     if(data->type == TYPE_COPY_OBJ)
     {
-      if(data->flags & FLAG_USE_POS)obj.pos = refObj->pos;
-      if(data->flags & FLAG_USE_SCALE)obj.scale = refObj->scale;
-      if(data->flags & FLAG_USE_ROT)obj.rot = refObj->rot;
+      if(data->flags & FLAG_USE_POS)obj.pos = refObj.pos;
+      if(data->flags & FLAG_USE_SCALE)obj.scale = refObj.scale;
+      if(data->flags & FLAG_USE_ROT)obj.rot = refObj.rot;
     }
 
     if(data->type == TYPE_REL_OFFSET)
     {
-      auto refPosWorld = refObj->outOfLocalSpace(data->localRefPos);
+      auto refPosWorld = refObj.outOfLocalSpace(data->localRefPos);
       obj.pos = refPosWorld;
       //if(data->flags & FLAG_USE_POS)obj.pos = refPosWorld;
     }
@@ -15,7 +15,17 @@ namespace
     fm_vec3_t halfExtend{};
     fm_vec3_t offset{};
     uint8_t type{};
+    uint8_t flags{};
+    uint8_t cell{};
+    uint8_t _padding{};
+    uint32_t visibleCells{};
   };
+
+  void setCulled(P64::Object &obj, const P64::Comp::Culling* data)
+  {
+    obj.setFlag(P64::ObjectFlags::IS_CULLED, true);
+    if(data->flags & P64::Comp::Culling::FLAG_GROUP)obj.getScene().setChildrenCulled(obj);
+  }
 }
 
 void P64::Comp::Culling::initDelete(Object &obj, Culling* data, void* initData)
@@ -26,21 +36,56 @@ void P64::Comp::Culling::initDelete(Object &obj, Culling* data, void* initData)
 
 void P64::Comp::Culling::draw(Object &obj, Culling* data, float deltaTime)
 {
-  auto vp = t3d_viewport_get();
-  auto pos = (data->offset * obj.scale) + obj.pos;
+  auto &scene = obj.getScene();
+  uint32_t camIdx = scene.getActiveCameraIndex();
+
+  bool visible = camIdx < MAX_CACHED_CAMERAS
+    ? (data->camVisible & (1 << camIdx))
+    : isVisible(obj, data, t3d_viewport_get()->viewFrustum, scene.getVisibleCells());
 
+  if(!visible)setCulled(obj, data);
+}
+
+bool P64::Comp::Culling::isVisible(const Object &obj, const Culling* data, const T3DFrustum &frustum, uint32_t visibleCells)
+{
+  if(data->cell != CELL_NONE && !(visibleCells & (1u << data->cell)))return false;
+
+  auto pos = (data->offset * obj.scale) + obj.pos;
   if(data->type == 0)
   {
     auto scaledSize = data->halfExtend * obj.scale;
     auto min = pos - scaledSize;
     auto max = pos + scaledSize;
-    if(!t3d_frustum_vs_aabb(&vp->viewFrustum, &min, &max)) {
-      obj.setFlag(ObjectFlags::IS_CULLED, true);
+    return t3d_frustum_vs_aabb(&frustum, &min, &max);
+  }
+
+  float maxSize = fmaxf(fmaxf(obj.scale.x, obj.scale.y), obj.scale.z);
+  return t3d_frustum_vs_sphere(&frustum, &pos, data->halfExtend.x * maxSize);
+}
+
+void P64::Comp::Culling::updateVisibility(const Object &obj, Culling* data,
+  P64::Camera* const* cameras, const uint32_t* cameraCells, uint32_t camCount)
+{
+  data->camVisible = 0;
+  for(uint32_t c=0; c<camCount; ++c) {
+    if(isVisible(obj, data, cameras[c]->getFrustum(), cameraCells[c])) {
+      data->camVisible |= 1 << c;
     }
+  }
+}
+
+uint32_t P64::Comp::Culling::getCellVisibility(const Object &obj, const Culling* data, const fm_vec3_t &pos)
+{
+  if(data->cell == CELL_NONE)return 0;
+  auto center = (data->offset * obj.scale) + obj.pos;
+  auto diff = pos - center;
+
+  if(data->type == 0) {
+    auto scaledSize = data->halfExtend * obj.scale;
+    if(fabsf(diff.x) > scaledSize.x || fabsf(diff.y) > scaledSize.y || fabsf(diff.z) > scaledSize.z)return 0;
   } else {
-    float maxSize = fmaxf(fmaxf(obj.scale.x, obj.scale.y), obj.scale.z);
-    if(!t3d_frustum_vs_sphere(&vp->viewFrustum, &pos, data->halfExtend.x * maxSize)) {
-      obj.setFlag(ObjectFlags::IS_CULLED, true);
-    }
+    float radius = data->halfExtend.x * fmaxf(fmaxf(obj.scale.x, obj.scale.y), obj.scale.z);
+    if(t3d_vec3_len2(&diff) > (radius * radius))return 0;
   }
+  return data->visibleCells | (1u << data->cell);
 }
@@ -7,11 +7,16 @@
 #include "scene/components/model.h"
 #include "assets/assetManager.h"
 #include <t3d/t3dmodel.h>
+#include <unordered_map>
+#include <vector>
 
 #include "../../renderer/bigtex/bigtex.h"
 #include "renderer/material.h"
+#include "renderer/drawQueue.h"
+#include "renderer/matrixBatch.h"
 #include "scene/scene.h"
 #include "scene/sceneManager.h"
+#include "scene/quality.h"
 
 namespace
 {
@@ -21,10 +26,110 @@ namespace
     uint8_t layer;
     uint8_t flags;
     P64::Renderer::Material material;
-    uint8_t meshIdxCount;
+    uint16_t textureGroup;
+    uint16_t _padding;
+    float drawDistance;
+    float lodDist[P64::Comp::Model::LOD_COUNT-1];
+    uint8_t lodIdxCount[P64::Comp::Model::LOD_COUNT];
     uint8_t meshIndices[];
   };
 
+  uint32_t getTotalMeshCount(const uint8_t* lodIdxCount)
+  {
+    uint32_t count = 0;
+    for(uint32_t l=0; l<P64::Comp::Model::LOD_COUNT; ++l)count += lodIdxCount[l];
+    return count;
+  }
+
+  void updateLod(P64::Comp::Model* data, float dist2)
+  {
+    uint8_t level = 0;
+    float lodScale = P64::Quality::getLodScale();
+    for(uint8_t l=1; l<P64::Comp::Model::LOD_COUNT; ++l)
+    {
+      float dist = data->lodDist[l-1] * lodScale;
+      if(dist <= 0.0f)break;
+      // levels at or below the current one need to be left by a margin, avoids flickering at the border
+      if(l <= data->lodLevel)dist *= (1.0f - P64::Comp::Model::LOD_HYSTERESIS);
+      if(dist2 < (dist * dist))break;
+      level = l;
+    }
+
+    if(level == data->lodLevel)return;
+    data->lodLevel = level;
+    data->meshIdxOffset = 0;
+    for(uint8_t l=0; l<level; ++l)data->meshIdxOffset += data->lodIdxCount[l];
+    data->meshIdxCount = data->lodIdxCount[level];
+  }
+
+  // Material and geometry are recorded into separate blocks per object,
+  // so instances only need to set up the material once.
+  struct InstanceBlocks
+  {
+    std::vector<rspq_block_t*> material{};
+    std::vector<rspq_block_t*> geometry{};
+    uint32_t refCount{0};
+  };
+
+  std::unordered_map<const T3DModel*, InstanceBlocks> instanceBlocks{};
+
+  void acquireInstanceBlocks(T3DModel *model)
+  {
+    auto &blocks = instanceBlocks[model];
+    if(blocks.refCount++ != 0)return;
+
+    auto it = t3d_model_iter_create(model, T3D_CHUNK_TYPE_OBJECT);
+    while(t3d_model_iter_next(&it))
+    {
+      rspq_block_begin();
+        t3d_model_draw_material(it.object->material, nullptr);
+      blocks.material.push_back(rspq_block_end());
+
+      rspq_block_begin();
+        t3d_model_draw_object(it.object, nullptr);
+      blocks.geometry.push_back(rspq_block_end());
+    }
+  }
+
+  void releaseInstanceBlocks(const T3DModel *model)
+  {
+    auto it = instanceBlocks.find(model);
+    if(it == instanceBlocks.end())return;
+    if(--it->second.refCount != 0)return;
+
+    for(auto block : it->second.material)rspq_block_free(block);
+    for(auto block : it->second.geometry)rspq_block_free(block);
+    instanceBlocks.erase(it);
+  }
+
+  bool usesMesh(const P64::Comp::Model* data, uint32_t objIdx)
+  {
+    if(data->meshIdxCount == 0)return true;
+    auto indices = data->getMeshIndices();
+    for(uint8_t i = 0; i < data->meshIdxCount; ++i) {
+      if(indices[i] == objIdx)return true;
+    }
+    return false;
+  }
+
+  /**
+   * Moves frustum planes from world- into model-space (inverse of scale, rotation and translation).
+   * Planes are transformed by the transposed model matrix, their normals are not re-normalized
+   * which is fine for the AABB tests of the BVH as they only care about the sign.
+   */
+  void frustumToLocal(T3DFrustum &frustum, const P64::Object &obj)
+  {
+    fm_quat_t invRot;
+    fm_quat_inverse(&invRot, &obj.rot);
+
+    for(auto &plane : frustum.planes) {
+      fm_vec3_t normal{plane.x, plane.y, plane.z};
+      float dist = plane.w + t3d_vec3_dot(&normal, &obj.pos);
+      auto localNorm = (invRot * normal) * obj.scale;
+      plane = {localNorm.x, localNorm.y, localNorm.z, dist};
+    }
+  }
+
   void recordWholeModel(T3DModel *model)
   {
     rspq_block_begin();
@@ -47,16 +152,18 @@ namespace
 
   void drawNoCullFilter(P64::Comp::Model* data)
   {
+    auto indices = data->getMeshIndices();
     for(uint8_t i = 0; i < data->meshIdxCount; ++i) {
-      auto mesh = t3d_model_get_object_by_index(data->model, data->meshIndices[i]);
+      auto mesh = t3d_model_get_object_by_index(data->model, indices[i]);
       rspq_block_run(mesh->userBlock);
     }
   }
 
   void drawCullFilter(P64::Comp::Model* data)
   {
+    auto indices = data->getMeshIndices();
     for(uint8_t i = 0; i < data->meshIdxCount; ++i) {
-      auto mesh = t3d_model_get_object_by_index(data->model, data->meshIndices[i]);
+      auto mesh = t3d_model_get_object_by_index(data->model, indices[i]);
       if(mesh->isVisible) {
         rspq_block_run(mesh->userBlock);
         mesh->isVisible = false;
@@ -80,13 +187,14 @@ namespace P64::Comp
 {
   uint32_t Model::getAllocSize(uint16_t* initData)
   {
-    return sizeof(Model) + (sizeof(uint8_t) * ((InitData*)initData)->meshIdxCount);
+    return sizeof(Model) + (sizeof(uint8_t) * getTotalMeshCount(((InitData*)initData)->lodIdxCount));
   }
 
   void Model::initDelete([[maybe_unused]] Object& obj, Model* data, void* initData_)
   {
     auto *initData = (InitData*)initData_;
     if (initData == nullptr) {
+      if(data->flags & FLAG_INSTANCED)releaseInstanceBlocks(data->model);
       data->~Model();
       return;
     }
@@ -98,20 +206,41 @@ namespace P64::Comp
     data->layerIdx = initData->layer;
     data->flags = initData->flags;
     data->material = initData->material;
+    data->textureGroup = initData->textureGroup;
+    data->drawDistance = initData->drawDistance;
 
-    data->meshIdxCount = initData->meshIdxCount;
-    for(uint8_t i = 0; i < initData->meshIdxCount; ++i) {
+    for(uint8_t l = 0; l < LOD_COUNT; ++l) {
+      data->lodIdxCount[l] = initData->lodIdxCount[l];
+      if(l != 0)data->lodDist[l-1] = initData->lodDist[l-1];
+    }
+    data->meshIdxCount = data->lodIdxCount[0];
+
+    uint32_t totalMeshCount = getTotalMeshCount(initData->lodIdxCount);
+    for(uint32_t i = 0; i < totalMeshCount; ++i) {
       data->meshIndices[i] = initData->meshIndices[i];
     }
 
+    if(!DrawLayer::hasDepth()) {
+      // no depth to write to, the RSP can skip calculating it
+      auto itMat = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_OBJECT);
+      while(t3d_model_iter_next(&itMat))itMat.object->material->renderFlags &= ~T3D_FLAG_DEPTH;
+    }
+
     bool isBigTex = SceneManager::getCurrent().getConf().pipeline == SceneConf::Pipeline::BIG_TEX_256;
-    bool separate = (data->flags & FLAG_CULLING) || (data->meshIdxCount != 0);
+    bool separate = (data->flags & FLAG_CULLING) || (totalMeshCount != 0);
 
     if(isBigTex && data->layerIdx == 0) {
+      data->flags &= ~FLAG_INSTANCED;
+      data->flags |= FLAG_BIGTEX;
       Renderer::BigTex::patchT3DM(*data->model);
       return;
     }
 
+    if(data->flags & FLAG_INSTANCED) {
+      acquireInstanceBlocks(data->model);
+      return;
+    }
+
     if(separate)
     {
       auto it = t3d_model_iter_create(data->model, T3D_CHUNK_TYPE_OBJECT);
@@ -135,20 +264,77 @@ namespace P64::Comp
 
   void Model::draw(Object &obj, Model* data, float deltaTime)
   {
-    auto mat = data->matFP.getNext();
-    t3d_mat4fp_from_srt(mat, obj.scale, obj.rot, obj.pos);
+    if(data->drawDistance > 0.0f || data->lodDist[0] > 0.0f) {
+      auto diff = obj.pos - obj.getScene().getActiveCamera().getPos();
+      float dist2 = t3d_vec3_len2(&diff);
+      if(data->drawDistance > 0.0f && dist2 > (data->drawDistance * data->drawDistance))return;
+      updateLod(data, dist2);
+    }
+
+    MatrixBatch::prepare(data->matFP, obj.scale, obj.rot, obj.pos);
+    DrawQueue::submit(obj, data, drawQueued, data->material, (uint32_t)data->model, data->layerIdx,
+      (data->flags & FLAG_INSTANCED) ? drawInstanced : nullptr, data->textureGroup
+    );
+  }
+
+  void Model::drawInstanced(const DrawQueue::Instance* instances, uint32_t count)
+  {
+    // all instances share the same asset, see the batch-key in 'draw()'
+    auto first = (Model*)instances[0].data;
+    auto blocks = instanceBlocks.find(first->model);
+    assert(blocks != instanceBlocks.end());
+
+    uint32_t objIdx = 0;
+    auto it = t3d_model_iter_create(first->model, T3D_CHUNK_TYPE_OBJECT);
+    while(t3d_model_iter_next(&it))
+    {
+      bool materialSet = false;
+      for(uint32_t i = 0; i < count; ++i)
+      {
+        auto data = (Model*)instances[i].data;
+        if(!usesMesh(data, objIdx))continue;
 
-    if(data->layerIdx)DrawLayer::use3D(data->layerIdx);
+        if(!materialSet) {
+          // meshes often share a material, no need to load the same texture again
+          if(DrawQueue::useMaterialBlock(it.object->material)) {
+            rspq_block_run(blocks->second.material[objIdx]);
+          }
+          materialSet = true;
+        }
 
-    data->material.begin(obj);
+        auto &obj = *instances[i].obj;
+        obj.getScene().applyObjectLights(data->lightSel, obj.pos);
+        t3d_matrix_set(data->matFP.get(obj.scale, obj.rot, obj.pos), true);
+        rspq_block_run(blocks->second.geometry[objIdx]);
+      }
 
+      if(materialSet && it.object->material->vertexFxFunc) { // @TODO: fix this in t3d
+        t3d_state_set_vertex_fx(T3D_VERTEX_FX_NONE, 0,0);
+        DrawQueue::resetMaterialBlock();
+      }
+      ++objIdx;
+    }
+  }
+
+  void Model::drawQueued(Object &obj, void* data_)
+  {
+    auto data = (Model*)data_;
+    // recorded blocks always contain their materials
+    DrawQueue::resetMaterialBlock();
+    auto mat = data->matFP.get(obj.scale, obj.rot, obj.pos);
     t3d_matrix_set(mat, true);
+    obj.getScene().applyObjectLights(data->lightSel, obj.pos);
 
     //debugf("[%d] data->meshIdxCount: %u separate: %d\n", obj.id, data->meshIdxCount, separate);
 
+    if(data->flags & FLAG_BIGTEX) {
+      Renderer::BigTex::drawT3DM(*data->model);
+      return;
+    }
+
     if (data->flags & FLAG_CULLING) {
       auto frustum = t3d_viewport_get()->viewFrustum;
-      t3d_frustum_scale(&frustum, obj.scale.x); // @TODO: handle non-uniform scale
+      frustumToLocal(frustum, obj);
 
       const T3DBvh *bvh = t3d_model_bvh_get(data->model); assert(bvh);
       t3d_model_bvh_query_frustum(bvh, &frustum);
@@ -165,8 +351,5 @@ namespace P64::Comp
         drawNoCullFilter(data);
       }
     }
-
-    data->material.end();
-    if(data->layerIdx)DrawLayer::useDefault();
   }
 }
@@ -0,0 +1,249 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "scene/object.h"
+#include "scene/components/particleEmitter.h"
+
+#include "scene/scene.h"
+#include "renderer/drawLayer.h"
+#include "lib/math.h"
+#include "lib/memory.h"
+#include "scene/quality.h"
+
+namespace
+{
+  struct InitData
+  {
+    uint16_t maxCount;
+    uint16_t burstCount;
+    float emitRate;
+    float speed;
+    float spread;
+    float life;
+    float lifeVar;
+    float gravity;
+    color_t colorStart;
+    color_t colorEnd;
+    uint8_t sizeStart;
+    uint8_t sizeEnd;
+    uint8_t layer;
+    uint8_t flags;
+  };
+
+  constexpr float POS_SCALE = 256.0f; // 24.8
+  constexpr float VEL_SCALE = 16.0f; // 12.4
+  constexpr float TIME_SCALE = 1024.0f;
+
+  inline int16_t toFixedVel(float v) {
+    return (int16_t)P64::Math::clamp(v * VEL_SCALE, -32767.0f, 32767.0f);
+  }
+
+  constexpr uint8_t lerpU8(uint8_t a, uint8_t b, int32_t t) { // t: 0-256
+    return (uint8_t)(a + (((int32_t)b - (int32_t)a) * t >> 8));
+  }
+
+  // the RSP may still work on the buffers from the last frame
+  void waitForRsp(P64::Comp::ParticleEmitter* data) {
+    if(data->rspSync) {
+      rspq_syncpoint_wait(data->rspSync);
+      data->rspSync = 0;
+    }
+  }
+
+  // faded out particles (alpha of zero) are dead in RSP mode
+  void compactRsp(P64::Comp::ParticleEmitter* data)
+  {
+    auto &system = data->system;
+    if(++data->compactTimer < P64::Comp::ParticleEmitter::RSP_COMPACT_INTERVAL && !system.isFull())return;
+    data->compactTimer = 0;
+
+    auto buff = system.getBufferS16();
+    auto state = data->rspState;
+    system.compact(
+      [buff](uint32_t idx) { return ((color_t*)tpx_buffer_s16_get_rgba(buff, idx))->a == 0; },
+      [state](uint32_t dst, uint32_t src) { state[dst] = state[src]; }
+    );
+  }
+}
+
+namespace P64::Comp
+{
+  void ParticleEmitter::initDelete(Object &obj, ParticleEmitter* data, uint16_t* initData_)
+  {
+    auto initData = (InitData*)initData_;
+    if (initData == nullptr) {
+      if(data->particles) {
+        Mem::track(Mem::Category::PARTICLES, -(int32_t)(data->system.countMax * sizeof(Particle)));
+        free(data->particles);
+      }
+      if(data->rspState) {
+        waitForRsp(data);
+        PTX::RspSim::freeState(data->system, data->rspState);
+        PTX::RspSim::destroy();
+      }
+      data->~ParticleEmitter();
+      return;
+    }
+
+    uint32_t maxCount = Math::alignUp(Math::max<uint32_t>(initData->maxCount, 2), 2);
+    new(data) ParticleEmitter(maxCount, initData->flags & FLAG_RSP_SIM);
+
+    if(initData->flags & FLAG_RSP_SIM) {
+      PTX::RspSim::init();
+      data->rspState = PTX::RspSim::allocState(data->system);
+    } else {
+      data->particles = (Particle*)malloc(maxCount * sizeof(Particle));
+      Mem::track(Mem::Category::PARTICLES, maxCount * sizeof(Particle));
+    }
+
+    data->emitRate = initData->emitRate;
+    data->speed = initData->speed;
+    data->spread = initData->spread;
+    data->life = initData->life;
+    data->lifeVar = initData->lifeVar;
+    data->gravity = toFixedVel(initData->gravity);
+    data->burstCount = initData->burstCount;
+    data->colorStart = initData->colorStart;
+    data->colorEnd = initData->colorEnd;
+    data->sizeStart = initData->sizeStart;
+    data->sizeEnd = initData->sizeEnd;
+    data->layer = initData->layer;
+    data->flags = initData->flags;
+
+    if(data->burstCount)burst(obj, data, data->burstCount);
+  }
+
+  void ParticleEmitter::burst(Object &obj, ParticleEmitter* data, uint32_t count)
+  {
+    auto &system = data->system;
+    // the buffer keeps its size, a lower quality tier only caps how much of it is used
+    auto countMax = Math::max<uint32_t>((uint32_t)(system.countMax * Quality::getParticleScale()), 2);
+    count = system.count < countMax ? Math::min(count, countMax - system.count) : 0;
+    if(count == 0)return;
+    waitForRsp(data);
+
+    // emission direction is the local +Y axis of the object
+    fm_vec3_t dir = obj.outOfLocalSpace({0,1,0}) - obj.pos;
+    fm_vec3_norm(&dir, &dir);
+
+    auto buff = system.getBufferS16();
+    for(uint32_t i=0; i<count; ++i)
+    {
+      uint32_t idx = system.count++;
+      fm_vec3_t vel = dir * data->speed + Math::randDir3D() * (data->spread * Math::rand01());
+      float life = Math::max(data->life + data->lifeVar * Math::rand01(), 1.0f / TIME_SCALE);
+      auto pos = tpx_buffer_s16_get_pos(buff, idx);
+
+      if(data->rspState)
+      {
+        auto &s = data->rspState[idx];
+        for(uint32_t c=0; c<3; ++c) {
+          auto fixedPos = (int32_t)(obj.pos.v[c] * POS_SCALE);
+          pos[c] = (int16_t)(fixedPos >> 8);
+          s.frac[c] = (uint16_t)((fixedPos & 0xFF) << 8);
+          s.vel[c] = toFixedVel(vel.v[c]);
+        }
+        // fade out linearly, the particle is dead once it reaches zero
+        s.vel[3] = (int16_t)-Math::clamp(data->colorStart.a * PTX::RspSim::VEL_SCALE / life, 1.0f, 32767.0f);
+        s.frac[3] = 0;
+      } else {
+        auto &p = data->particles[idx];
+        for(uint32_t c=0; c<3; ++c) {
+          p.pos[c] = (int32_t)(obj.pos.v[c] * POS_SCALE);
+          p.vel[c] = toFixedVel(vel.v[c]);
+          pos[c] = (int16_t)obj.pos.v[c];
+        }
+        p.age = 0;
+        p.life = (uint16_t)Math::clamp(life * TIME_SCALE, 1.0f, 65535.0f);
+      }
+
+      *tpx_buffer_s16_get_size(buff, idx) = (int8_t)data->sizeStart;
+      *(color_t*)tpx_buffer_s16_get_rgba(buff, idx) = data->colorStart;
+    }
+  }
+
+  void ParticleEmitter::update(Object &obj, ParticleEmitter* data, float deltaTime)
+  {
+    if(data->rspState) {
+      waitForRsp(data);
+      compactRsp(data);
+    }
+
+    if(data->flags & FLAG_EMITTING) {
+      data->emitAccum += data->emitRate * deltaTime;
+      auto spawnCount = (uint32_t)data->emitAccum;
+      if(spawnCount) {
+        data->emitAccum -= (float)spawnCount;
+        burst(obj, data, spawnCount);
+      }
+    }
+
+    auto &system = data->system;
+    if(system.count == 0 || data->rspState)return; // RSP simulates in 'draw()'
+
+    // everything below is integer only, time-step in 1/1024th seconds
+    auto dt = (int32_t)(deltaTime * TIME_SCALE);
+    int32_t gravityStep = (data->gravity * dt) >> 10;
+    // velocity (12.4) * dt (ms 22.10) -> pos (24.8): shift by 4+10-8
+    constexpr int32_t VEL_SHIFT = 6;
+
+    auto buff = system.getBufferS16();
+    Particle* particles = data->particles;
+    uint32_t deadCount = 0;
+
+    for(uint32_t i=0; i<system.count; ++i)
+    {
+      auto &p = particles[i];
+      uint32_t age = p.age + dt;
+      if(age >= p.life) {
+        p.age = p.life;
+        ++deadCount;
+        continue;
+      }
+      p.age = age;
+
+      p.vel[1] += gravityStep;
+      p.pos[0] += (p.vel[0] * dt) >> VEL_SHIFT;
+      p.pos[1] += (p.vel[1] * dt) >> VEL_SHIFT;
+      p.pos[2] += (p.vel[2] * dt) >> VEL_SHIFT;
+
+      auto pos = tpx_buffer_s16_get_pos(buff, i);
+      pos[0] = (int16_t)(p.pos[0] >> 8);
+      pos[1] = (int16_t)(p.pos[1] >> 8);
+      pos[2] = (int16_t)(p.pos[2] >> 8);
+
+      int32_t t = (int32_t)((age << 8) / p.life);
+      *tpx_buffer_s16_get_size(buff, i) = (int8_t)lerpU8(data->sizeStart, data->sizeEnd, t);
+      auto col = (color_t*)tpx_buffer_s16_get_rgba(buff, i);
+      col->r = lerpU8(data->colorStart.r, data->colorEnd.r, t);
+      col->g = lerpU8(data->colorStart.g, data->colorEnd.g, t);
+      col->b = lerpU8(data->colorStart.b, data->colorEnd.b, t);
+      col->a = lerpU8(data->colorStart.a, data->colorEnd.a, t);
+    }
+
+    if(deadCount) {
+      system.compact(
+        [particles](uint32_t idx) { return particles[idx].age >= particles[idx].life; },
+        [particles](uint32_t dst, uint32_t src) { particles[dst] = particles[src]; }
+      );
+    }
+  }
+
+  void ParticleEmitter::draw(Object &obj, ParticleEmitter* data, float deltaTime)
+  {
+    if(data->system.count == 0)return;
+    // the particle layers are drawn once after all cameras, so only record them once
+    if(obj.getScene().getActiveCameraIndex() != 0)return;
+
+    if(data->rspState) {
+      // queued outside the layer, so it runs before the layer itself gets drawn
+      PTX::RspSim::simulate(data->system, data->rspState, deltaTime, data->gravity);
+      data->rspSync = rspq_syncpoint_new();
+    }
+
+    DrawLayer::usePtx(data->layer);
+      data->system.draw();
+    DrawLayer::useDefault();
+  }
+}
@@ -5,9 +5,81 @@
 #include "scene/lighting.h"
 
 #include <t3d/t3d.h>
+#include <t3d/t3dmath.h>
+#include <cstring>
+
+#include "renderer/drawLayer.h"
+
+namespace
+{
+  // same as the layers in 'DrawLayer::Setup'
+  constexpr uint32_t MAX_LAYERS = 16;
+
+  enum class SlotType : uint8_t
+  {
+    UNKNOWN = 0,
+    DIR,
+    POINT,
+  };
+
+  struct Slot
+  {
+    P64::Light light;
+    SlotType type;
+  };
+
+  /**
+   * Lights last set in a layer. Layers are separate command buffers and only run later,
+   * so what one of them leaves behind says nothing about the others.
+   * Zero-initialized means nothing is known.
+   */
+  struct AppliedState
+  {
+    Slot slots[P64::MAX_LIGHTS];
+    color_t ambient;
+    uint8_t count;
+    bool ambientKnown;
+    bool countKnown;
+  };
+
+  constinit AppliedState appliedStates[MAX_LAYERS]{};
+
+  AppliedState& getState() {
+    uint32_t idx = P64::DrawLayer::getCurrent();
+    return appliedStates[idx < MAX_LAYERS ? idx : 0];
+  }
+
+  bool needsUpdate(Slot &slot, SlotType type, const P64::Light &l)
+  {
+    if(slot.type == type && memcmp(&slot.light, &l, sizeof(P64::Light)) == 0)return false;
+    slot.light = l;
+    slot.type = type;
+    return true;
+  }
+
+  void setDirectional(AppliedState &state, uint32_t idx, const P64::Light &l) {
+    if(needsUpdate(state.slots[idx], SlotType::DIR, l)) {
+      t3d_light_set_directional(idx, l.color, l.dirOrPos);
+    }
+  }
+
+  void setPoint(AppliedState &state, uint32_t idx, const P64::Light &l) {
+    if(needsUpdate(state.slots[idx], SlotType::POINT, l)) {
+      t3d_light_set_point(idx, l.color, l.dirOrPos, l.strength);
+    }
+  }
+
+  void setCount(AppliedState &state, uint32_t count) {
+    if(state.countKnown && state.count == count)return;
+    t3d_light_set_count(count);
+    state.count = count;
+    state.countKnown = true;
+  }
+}
 
 void P64::Lighting::apply() const
 {
+  auto &state = getState();
   int lightIdx = 0;
   color_t ambient{};
   for(uint32_t i=0; i<lightCount; ++i)
@@ -19,21 +91,92 @@ void P64::Lighting::apply() const
       ambient.g += l.color.g;
       ambient.b += l.color.b;
       ambient.a += l.color.a;
-    }else if(l.strength == 0)
-    {
-      t3d_light_set_directional(lightIdx, l.color, l.dirOrPos);
-      ++lightIdx;
     } else {
-      t3d_light_set_point(lightIdx,
-        l.color,
-        l.dirOrPos,
-        l.strength
-        // @TODO: ignore normals setting
-      );
+      setDirectional(state, lightIdx, l);
       ++lightIdx;
     }
   }
 
-  t3d_light_set_ambient(ambient);
-  t3d_light_set_count(lightIdx);
+  // with too many point lights, this is only the default for draws not picking their own
+  // @TODO: ignore normals setting
+  for(uint32_t i=0; i<pointCount && lightIdx < (int)MAX_LIGHTS; ++i) {
+    setPoint(state, lightIdx, pointLights[i]);
+    ++lightIdx;
+  }
+
+  if(!state.ambientKnown || color_to_packed32(state.ambient) != color_to_packed32(ambient)) {
+    t3d_light_set_ambient(ambient);
+    state.ambient = ambient;
+    state.ambientKnown = true;
+  }
+  setCount(state, lightIdx);
+}
+
+void P64::Lighting::invalidate()
+{
+  memset(appliedStates, 0, sizeof(appliedStates));
+}
+
+void P64::Lighting::select(Selection &sel, const fm_vec3_t &pos) const
+{
+  // rough intensity at the object, the strength acts like the radius of the light
+  float scores[MAX_LIGHTS];
+  uint32_t slots = MAX_LIGHTS - dirCount;
+  sel.count = 0;
+
+  for(uint32_t i=0; i<pointCount; ++i)
+  {
+    const auto &l = pointLights[i];
+    auto diff = l.dirOrPos - pos;
+    float brightness = (float)(l.color.r + l.color.g + l.color.b);
+    float score = (l.strength * l.strength * brightness) / (t3d_vec3_len2(&diff) + 1.0f);
+
+    // insertion into the (short) sorted list, dropping the weakest one if full
+    uint32_t s = sel.count;
+    if(s == slots) {
+      if(score <= scores[s-1])continue;
+      --s;
+    } else {
+      ++sel.count;
+    }
+    for(; s > 0 && scores[s-1] < score; --s) {
+      scores[s] = scores[s-1];
+      sel.idx[s] = sel.idx[s-1];
+    }
+    scores[s] = score;
+    sel.idx[s] = i;
+  }
+}
+
+void P64::Lighting::applyForObject(Selection &sel, const fm_vec3_t &pos) const
+{
+  if(!needsSelection())return;
+
+  if(sel.version != version || sel.pos.x != pos.x || sel.pos.y != pos.y || sel.pos.z != pos.z) {
+    select(sel, pos);
+    sel.version = version;
+    sel.pos = pos;
+  }
+
+  // neighboring draws often end up with the same lights, those are skipped per slot
+  auto &state = getState();
+  for(uint32_t i=0; i<sel.count; ++i) {
+    setPoint(state, dirCount + i, pointLights[sel.idx[i]]);
+  }
+  setCount(state, dirCount + sel.count);
+}
+
+void P64::Lighting::updateVersion()
+{
+  uint32_t hash = pointCount;
+  static_assert(sizeof(Light) % sizeof(uint32_t) == 0);
+  const uint32_t *words = (const uint32_t*)pointLights;
+  for(uint32_t i=0; i<pointCount * sizeof(Light) / sizeof(uint32_t); ++i) {
+    hash = (hash ^ words[i]) * 16777619u;
+  }
+
+  if(hash != pointHash) {
+    pointHash = hash;
+    if(++version == 0)version = 1;
+  }
 }
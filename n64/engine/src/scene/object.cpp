@@ -7,6 +7,7 @@
 #include "scene/componentTable.h"
 #include "scene/scene.h"
 #include "scene/sceneManager.h"
+#include "lib/math.h"
 
 P64::Object::~Object()
 {
@@ -18,6 +19,31 @@ P64::Object::~Object()
   }
 }
 
+void P64::Object::buildTypeTable()
+{
+  auto compRefs = getCompRefs();
+  compMask = 0;
+  flags &= ~(ObjectFlags::HAS_EVENTS | ObjectFlags::HAS_COLL);
+  for (uint32_t i=0; i<compCount; ++i) {
+    compMask |= 1 << compRefs[i].type;
+    if(COMP_TABLE[compRefs[i].type].onEvent)flags |= ObjectFlags::HAS_EVENTS;
+    if(COMP_TABLE[compRefs[i].type].onColl)flags |= ObjectFlags::HAS_COLL;
+  }
+
+  auto typeOffsets = getTypeOffsets();
+  uint32_t idx = 0;
+  for(uint32_t type=0; type<16; ++type)
+  {
+    if(!(compMask & (1 << type)))continue;
+    for (uint32_t i=0; i<compCount; ++i) {
+      if(compRefs[i].type == type) {
+        typeOffsets[idx++] = compRefs[i].offset;
+        break;
+      }
+    }
+  }
+}
+
 void P64::Object::setEnabled(bool isEnabled)
 {
   auto oldFlags = flags;
@@ -28,6 +54,8 @@ void P64::Object::setEnabled(bool isEnabled)
   }
 
   if(oldFlags == flags)return;
+  getScene().markActiveDirty();
+  if(!(flags & ObjectFlags::HAS_EVENTS))return;
 
   auto compRefs = getCompRefs();
   for (uint32_t i=0; i<compCount; ++i) {
@@ -46,27 +74,23 @@ void P64::Object::setEnabled(bool isEnabled)
 
 void P64::Object::remove()
 {
-  if(flags & ObjectFlags::PENDING_REMOVE)return;
-  flags |= ObjectFlags::PENDING_REMOVE;
-  flags &= ~ObjectFlags::ACTIVE;
   SceneManager::getCurrent().removeObject(*this);
 }
 
 fm_vec3_t P64::Object::intoLocalSpace(const fm_vec3_t &p) const
 {
-  fm_quat_t invRot;
-  fm_quat_inverse(&invRot, &rot);
-
-  auto res = (p  - pos);
-  return invRot * res / scale;
+  return Math::quatRotateInv(rot, p - pos) / scale;
 }
 
 fm_vec3_t P64::Object::outOfLocalSpace(const fm_vec3_t &p) const
 {
-  return rot * (p * scale) + pos;
+  return Math::quatRotate(rot, p * scale) + pos;
 }
 
 P64::Object* P64::ObjectRef::get() const
 {
-  return SceneManager::getCurrent().getObjectById((uint16_t)id);
+  auto obj = SceneManager::getCurrent().getObjectById((uint16_t)id);
+  uint16_t gen = id >> 16;
+  if(obj && gen != 0 && obj->generation != gen)return nullptr;
+  return obj;
 }
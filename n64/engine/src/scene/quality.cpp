@@ -0,0 +1,101 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "scene/quality.h"
+#include "scene/scene.h"
+#include "lib/logger.h"
+
+namespace
+{
+  // a frame counts as too slow above this part of the budget
+  constexpr float OVER_BUDGET_FACTOR = 1.1f;
+  // slow frames add one, others remove one, so only a lasting slow-down steps down (~2s at 60Hz)
+  constexpr uint32_t STEP_DOWN_COUNT = 120;
+
+  constinit P64::Quality::Tier tier{P64::Quality::Tier::LOW};
+  constinit bool expansionPak{false};
+
+  constinit P64::SceneConf::TierConf lowTierConf{};
+  constinit bool autoStepDown{false};
+  constinit uint32_t overBudgetCount{0};
+  constinit float lodScale{1.0f};
+  constinit float particleScale{1.0f};
+
+  void applyRuntimeSettings()
+  {
+    bool low = tier == P64::Quality::Tier::LOW;
+    lodScale = low ? (float)lowTierConf.lodScale / P64::SceneConf::TIER_SCALE_ONE : 1.0f;
+    particleScale = low ? (float)lowTierConf.particleScale / P64::SceneConf::TIER_SCALE_ONE : 1.0f;
+  }
+}
+
+void P64::Quality::init()
+{
+  expansionPak = is_memory_expanded();
+  tier = expansionPak ? Tier::HIGH : Tier::LOW;
+  Log::info("Quality: %s tier (%d MB)", tier == Tier::HIGH ? "high" : "low", (int)(get_memory_size() / (1024 * 1024)));
+}
+
+P64::Quality::Tier P64::Quality::getTier()
+{
+  return tier;
+}
+
+bool P64::Quality::hasExpansionPak()
+{
+  return expansionPak;
+}
+
+void P64::Quality::applyToScene(SceneConf &conf)
+{
+  bool hasLowTier = conf.flags & SceneConf::FLAG_LOW_TIER;
+  lowTierConf = hasLowTier ? conf.lowTier : SceneConf::TierConf{};
+  if(!hasLowTier) {
+    lowTierConf.lodScale = SceneConf::TIER_SCALE_ONE;
+    lowTierConf.particleScale = SceneConf::TIER_SCALE_ONE;
+  }
+  autoStepDown = hasLowTier && (conf.flags & SceneConf::FLAG_QUALITY_AUTO);
+  overBudgetCount = 0;
+  applyRuntimeSettings();
+
+  if(tier != Tier::LOW || !hasLowTier)return;
+
+  // BigTex keeps its buffers in the expansion pak, there is nothing to fall back to
+  if(conf.pipeline == SceneConf::Pipeline::BIG_TEX_256) {
+    Log::error("Quality: BigTex scenes need the expansion pak");
+  }
+
+  if(conf.lowTier.screenWidth && conf.lowTier.screenHeight) {
+    conf.screenWidth = conf.lowTier.screenWidth;
+    conf.screenHeight = conf.lowTier.screenHeight;
+  }
+  conf.bloomQuality = conf.lowTier.bloomQuality;
+  if(conf.lowTier.audioChannelCount)conf.audioChannelCount = conf.lowTier.audioChannelCount;
+}
+
+void P64::Quality::update(float frameTime, float frameBudget)
+{
+  if(!autoStepDown || tier == Tier::LOW)return;
+
+  if(frameTime > frameBudget * OVER_BUDGET_FACTOR) {
+    if(++overBudgetCount < STEP_DOWN_COUNT)return;
+  } else {
+    if(overBudgetCount)--overBudgetCount;
+    return;
+  }
+
+  Log::warn("Quality: over budget for too long, switching to the low tier");
+  tier = Tier::LOW;
+  applyRuntimeSettings();
+}
+
+float P64::Quality::getLodScale()
+{
+  return lodScale;
+}
+
+float P64::Quality::getParticleScale()
+{
+  return particleScale;
+}
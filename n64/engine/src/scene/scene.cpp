@@ -7,13 +7,16 @@
 #include <libdragon.h>
 #include <rspq_profile.h>
 #include <t3d/t3d.h>
+#include <algorithm>
 
 #include "scene/scene.h"
 #include "scene/globalState.h"
+#include "scene/quality.h"
 #include "vi/swapChain.h"
 #include "lib/memory.h"
 #include "lib/logger.h"
 #include "lib/matrixManager.h"
+#include "lib/rspJobs.h"
 #include "assets/assetManager.h"
 #include "audio/audioManager.h"
 #include "../audio/audioManagerPrivate.h"
@@ -24,40 +27,83 @@
 #include "renderer/pipelineBigTex.h"
 
 #include "debug/debugDraw.h"
+#include "debug/trace.h"
+#include "debug/inputReplay.h"
+#include "debug/loadReport.h"
+#include "renderer/blobShadows.h"
 #include "renderer/drawLayer.h"
+#include "renderer/drawQueue.h"
+#include "renderer/matrixBatch.h"
+#include "renderer/batch2D.h"
 #include "scene/componentTable.h"
+#include "scene/components/audio3d.h"
+#include "scene/components/culling.h"
+#include "scene/components/constraint.h"
 #include "script/globalScript.h"
 
 namespace
 {
+  // memory reserved for objects spawned at runtime (pooled), exceeding it falls back to the heap
+  constexpr uint32_t SPAWN_POOL_SIZE = 16 * 1024;
+  // time per frame for loading prefetched assets, at least one asset is always loaded
+  constexpr uint32_t ASSET_QUEUE_BUDGET_US = 2000;
+  // with a fixed tick-rate, anything beyond this is dropped (slowing down instead of piling up more ticks)
+  constexpr uint32_t MAX_TICKS_PER_FRAME = 4;
+
   uint16_t nextId = 0xFF;
+
+#if P64_COMP_PROFILE
+  #define COMP_PROFILE_START() uint32_t ticksCompStart = get_ticks()
+  #define COMP_PROFILE_END(TICKS, ID) TICKS[ID] += get_ticks() - ticksCompStart
+  #define COMP_PROFILE_CALL(CALLS, ID) ++CALLS[ID]
+#else
+  #define COMP_PROFILE_START()
+  #define COMP_PROFILE_END(TICKS, ID)
+  #define COMP_PROFILE_CALL(CALLS, ID)
+#endif
 #if RSPQ_PROFILE
   uint32_t frameCount = 0;
 #endif
 }
 
-P64::Scene::Scene(uint16_t sceneId, Scene** ref)
+P64::Scene::Scene(uint16_t sceneId, Scene** ref, const std::vector<Object*> *persistentObjects)
   : id{sceneId}
 {
   if(ref)*ref = this;
+  Debug::LoadReport::begin(sceneId);
   Debug::init();
 
-  loadSceneConfig();
-
-  DrawLayer::init(conf.layerSetup);
+  {
+    Debug::LoadReport::ScopedPhase phase{Debug::LoadReport::Phase::CONFIG};
+    loadSceneConfig();
+    Quality::applyToScene(conf);
+    MatrixManager::setCapacity(conf.matrixCapacity);
+    AudioManager::configure(conf.audioSampleRate, conf.audioBufferCount, conf.audioChannelCount);
+  }
 
-  switch(conf.pipeline)
   {
-    case SceneConf::Pipeline::DEFAULT    : renderPipeline = new RenderPipelineDefault(*this);  break;
-    case SceneConf::Pipeline::HDR_BLOOM  : renderPipeline = new RenderPipelineHDRBloom(*this); break;
-    case SceneConf::Pipeline::BIG_TEX_256: renderPipeline = new RenderPipelineBigTex(*this);   break;
-    default: assertf(false, "Unknown render pipeline %d", (int)conf.pipeline);
+    Debug::LoadReport::ScopedPhase phase{Debug::LoadReport::Phase::DRAW_LAYER};
+    DrawLayer::init(conf.layerSetup, conf.hasDepth());
+    BlobShadows::init();
   }
 
-  state.screenSize[0] = conf.screenWidth;
-  state.screenSize[1] = conf.screenHeight;
+  {
+    Debug::LoadReport::ScopedPhase phase{Debug::LoadReport::Phase::PIPELINE};
+    switch(conf.pipeline)
+    {
+      case SceneConf::Pipeline::DEFAULT    : renderPipeline = new RenderPipelineDefault(*this);  break;
+      case SceneConf::Pipeline::HDR_BLOOM  : renderPipeline = new RenderPipelineHDRBloom(*this); break;
+      case SceneConf::Pipeline::BIG_TEX_256: renderPipeline = new RenderPipelineBigTex(*this);   break;
+      default: assertf(false, "Unknown render pipeline %d", (int)conf.pipeline);
+    }
 
-  renderPipeline->init();
+    state.screenSize[0] = conf.screenWidth;
+    state.screenSize[1] = conf.screenHeight;
+    state.renderSize[0] = conf.screenWidth;
+    state.renderSize[1] = conf.screenHeight;
+
+    renderPipeline->init();
+  }
 
   switch(conf.filter)
   {
@@ -84,25 +130,51 @@ P64::Scene::Scene(uint16_t sceneId, Scene** ref)
   }
 
   VI::SwapChain::setFrameSkip(conf.frameSkip);
+  VI::SwapChain::setLowLatency(conf.flags & SceneConf::FLAG_LOW_LATENCY);
   VI::SwapChain::start();
 
+  objPool.init(SPAWN_POOL_SIZE);
+  // taken over before loading, so the scene file can skip or avoid their IDs
+  if(persistentObjects)adoptObjects(*persistentObjects);
   loadScene();
 
+  if(persistentObjects) {
+    for(auto obj : *persistentObjects) {
+      dispatchEvent(*obj, {.senderId = 0, .type = EVENT_TYPE_SCENE_ENTER, .value = 0});
+    }
+  }
+
+  // checked once past the first frames, see 'AllocTracker::STRICT_GRACE_FRAMES'
+  Debug::AllocTracker::setStrict(conf.flags & SceneConf::FLAG_NO_ALLOC);
+  Debug::InputReplay::onSceneLoaded(getId());
+  Debug::LoadReport::end();
   Log::info("Scene %d Loaded", getId());
 }
 
 P64::Scene::~Scene()
 {
+  Debug::AllocTracker::setStrict(false);
   rspq_wait();
 
   for(auto obj : objects) {
-    obj->~Object();
-    free(obj);
+    freeObject(obj);
   }
+  objects.clear();
+  objGrid.clear();
+  freeChunks();
+  objArena.destroy();
+  objPool.destroy();
+  prefabTemplates.clear();
+  DrawQueue::reset();
+  BlobShadows::destroy();
+  NodeGraph::freePool();
 
   AudioManager::stopAll();
-  MatrixManager::reset();
-  AssetManager::freeAll();
+  if(!keepMatrices)MatrixManager::reset();
+  FrameMatrices::destroy();
+  MatrixBatch::destroy();
+  RSPJobs::destroy();
+  Batch2D::destroy();
   Debug::destroy();
 
   delete renderPipeline;
@@ -110,117 +182,350 @@ P64::Scene::~Scene()
 
 void P64::Scene::update(float deltaTime)
 {
-  joypad_poll();
-  auto pressed = joypad_get_buttons_pressed(JOYPAD_PORT_1);
-  auto held = joypad_get_buttons_held(JOYPAD_PORT_1);
-  if(held.l && pressed.d_up) {
-    Debug::Overlay::toggle();
-  }
-
   // reset metrics
   ticksActorUpdate = 0;
-  ticksDraw = 0;
-  ticksGlobalDraw = 0;
+  ticksConstraints = 0;
+  ticksGlobalUpdate = 0;
   collScene.ticks = 0;
   collScene.ticksBVH = 0;
+  collScene.meshesSkipped = 0;
   collScene.raycastCount = 0;
   AudioManager::ticksUpdate = 0;
+  GlobalScript::resetHookTicks();
+#if P64_COMP_PROFILE
+  for(auto &t : ticksCompUpdate)t = 0;
+  for(auto &c : callsCompUpdate)c = 0;
+#endif
+  tickCount = 0;
+
+  if(conf.flags & SceneConf::FLAG_QUALITY_AUTO) {
+    Quality::update(VI::SwapChain::getFrameTime(), VI::SwapChain::getFrameBudget());
+  }
+
+  Debug::AllocTracker::frame();
+  P64_TRACE_FRAME();
+  P64_TRACE_COUNTER(OBJECTS, objects.size());
+  P64_TRACE_BEGIN(SCENE_UPDATE);
 
   AudioManager::update();
 
+  // waiting here instead of in 'nextFrame' means input and logic are as fresh as possible once drawn
+  if(conf.flags & SceneConf::FLAG_LOW_LATENCY) {
+    VI::SwapChain::waitForFrame();
+  }
+
+  if(conf.tickRate == 0) {
+    tick(deltaTime);
+    ++tickCount;
+  } else {
+    // the smoothed delta-time would drift, so accumulate the actual time of the last frame
+    float tickTime = 1.0f / conf.tickRate;
+    tickTimeAccum += Debug::InputReplay::getDeltaTime(VI::SwapChain::getFrameTime());
+    while(tickTimeAccum >= tickTime && tickCount < MAX_TICKS_PER_FRAME) {
+      storeInterpState();
+      tick(tickTime);
+      tickTimeAccum -= tickTime;
+      ++tickCount;
+    }
+    tickTimeAccum = fminf(tickTimeAccum, tickTime);
+    tickAlpha = tickTimeAccum / tickTime;
+  }
+
+  AudioManager::update();
+  P64_TRACE_BEGIN(ASSETS);
+    updateChunks();
+    AssetManager::processQueue(ASSET_QUEUE_BUDGET_US);
+  P64_TRACE_END(ASSETS);
+  P64_TRACE_END(SCENE_UPDATE);
+
+  VI::SwapChain::nextFrame();
+}
+
+void P64::Scene::tick(float deltaTime)
+{
+  P64_TRACE_SCOPE(TICK);
+  Debug::InputReplay::poll();
+  auto pressed = joypad_get_buttons_pressed(JOYPAD_PORT_1);
+  auto held = joypad_get_buttons_held(JOYPAD_PORT_1);
+  if(held.l && pressed.d_up) {
+    Debug::Overlay::toggle();
+  }
+  if(held.l && pressed.d_down) {
+    DrawLayer::setHeatmap(!DrawLayer::isHeatmapEnabled());
+  }
+
   lighting.reset();
+  BlobShadows::reset();
+  RSPJobs::nextFrame();
 
   camMain = cameras.empty() ? nullptr : cameras[0];
   //debugf("cam %p: %d | %f\n", camMain, cameras.size(), (double)camMain->pos.z);
 
-  for(auto data : objectsToAdd) {
-    loadObject((uint8_t*&)data.prefabData, [&](Object &obj)
-    {
-      obj.id = data.objectId;
-      obj.pos = data.pos;
-      obj.scale = data.scale;
-      obj.rot = data.rot;
-      obj.flags = ObjectFlags::ACTIVE;
-    });
+  for(auto &params : objectsToAdd) {
+    spawnObject(params);
   }
   objectsToAdd.clear();
 
-  ticksGlobalUpdate = get_user_ticks();
-  GlobalScript::callHooks(GlobalScript::HookType::SCENE_UPDATE);
-  ticksGlobalUpdate = get_user_ticks() - ticksGlobalUpdate;
+  uint64_t ticksStart = get_user_ticks();
+  P64_TRACE_BEGIN(GLOBAL_SCRIPT);
+    GlobalScript::callHooks(GlobalScript::HookType::SCENE_UPDATE);
+  P64_TRACE_END(GLOBAL_SCRIPT);
+  ticksGlobalUpdate += get_user_ticks() - ticksStart;
+
+  // objects of tier n update every 2^n-th tick, offset by their phase.
+  // since that is a fixed interval, the time since their last update is just the sum of the last ticks
+  constexpr uint32_t TICK_HISTORY = sizeof(tickDeltas) / sizeof(tickDeltas[0]);
+  tickDeltas[tickIndex % TICK_HISTORY] = deltaTime;
+  for(uint32_t t=0; t<UPDATE_TIER_COUNT; ++t) {
+    float sum = 0.0f;
+    for(uint32_t i=0; i<(1u << t); ++i)sum += tickDeltas[(tickIndex - i) % TICK_HISTORY];
+    tierDeltas[t] = sum;
+  }
 
-  ticksActorUpdate = get_ticks();
-  for(auto obj : objects)
+  ticksStart = get_ticks();
+  for(auto compId : COMP_DISPATCH_ORDER)
   {
-    if(!obj->isEnabled())continue;
-
-    auto compRefs = obj->getCompRefs();
-
-    for (uint32_t i=0; i<obj->compCount; ++i) {
-      const auto &compDef = COMP_TABLE[compRefs[i].type];
-      char* dataPtr = (char*)obj + compRefs[i].offset;
-      compDef.update(*obj, dataPtr, deltaTime);
+    auto funcUpdate = COMP_TABLE[compId].update;
+    if(!funcUpdate)continue;
+    // objects enabled by an update are picked up with the next component type, disabled ones are still skipped right away
+    auto &list = getActiveList(compId);
+    if(list.empty())continue;
+
+    P64_TRACE_SCOPE(COMP_UPDATE, compId);
+    COMP_PROFILE_START();
+    for(auto &comp : list) {
+      auto obj = comp.obj;
+      if(!obj->isEnabled())continue;
+      if(obj->updateTier == 0) {
+        funcUpdate(*obj, comp.data, deltaTime);
+      } else {
+        uint32_t mask = (1 << obj->updateTier) - 1;
+        if(((tickIndex + obj->updatePhase) & mask) != 0)continue;
+        funcUpdate(*obj, comp.data, tierDeltas[obj->updateTier]);
+      }
+      COMP_PROFILE_CALL(callsCompUpdate, compId);
     }
+    COMP_PROFILE_END(ticksCompUpdate, compId);
   }
+  ++tickIndex;
+
+  // after all updates, so references moved this tick are already at their new place
+  updateConstraints();
 
   for(auto &cam : cameras) {
     cam->update(deltaTime);
   }
 
-  ticksActorUpdate = get_ticks() - ticksActorUpdate;
+  // positional audio needs the final camera, so it's done in one pass afterward
+  auto &audioList = getActiveList(Comp::Audio3D::ID);
+  if(camMain && !audioList.empty()) {
+    P64_TRACE_SCOPE(COMP_UPDATE, Comp::Audio3D::ID);
+    COMP_PROFILE_START();
+    auto listener = Comp::Audio3D::getListener(*camMain);
+    for(auto &comp : audioList) {
+      if(!comp.obj->isEnabled())continue;
+      Comp::Audio3D::updateSpatial(*comp.obj, (Comp::Audio3D*)comp.data, listener, deltaTime);
+      COMP_PROFILE_CALL(callsCompUpdate, Comp::Audio3D::ID);
+    }
+    COMP_PROFILE_END(ticksCompUpdate, Comp::Audio3D::ID);
+  }
+
+  ticksActorUpdate += get_ticks() - ticksStart;
 
-  collScene.update(deltaTime);
+  // jobs queued during the update ran alongside the cameras and audio, objects may get deleted below
+  RSPJobs::sync();
 
-  for(auto &obj : pendingObjDelete)
+  P64_TRACE_BEGIN(COLLISION);
+    collScene.update(deltaTime);
+  P64_TRACE_END(COLLISION);
+  // casters may get deleted below, so their positions are read right away
+  BlobShadows::resolve(collScene);
+  objGrid.update();
+
+  deleteCount = pendingObjDelete.size();
+  if(deleteCount != 0)
   {
-    idLookup[obj->id] = nullptr;
-    std::erase(objects, obj);
-    obj->~Object();
-    free(obj);
+    ticksDelete = get_ticks();
+    for(auto obj : pendingObjDelete) {
+      if(idLookup.get(obj->id) == obj)idLookup.remove(obj->id);
+      unlinkFromParent(obj);
+    }
+    constraintsDirty = true;
+    activeDirty = true;
+
+    // compact all lists in a single pass, this keeps the order of the remaining objects
+    auto isPending = [](const Object* obj) { return obj->flags & ObjectFlags::PENDING_REMOVE; };
+    std::erase_if(objects, isPending);
+    objGrid.removeIf(isPending);
+    for(auto &list : compLists) {
+      if(list.empty())continue;
+      std::erase_if(list, [&](const CompInstance &c) { return isPending(c.obj); });
+    }
+    std::erase_if(interpStates, [&](const InterpState &st) { return isPending(st.obj); });
+
+    for(auto obj : pendingObjDelete) {
+      freeObject(obj);
+    }
+    pendingObjDelete.clear();
+    ticksDelete = get_ticks() - ticksDelete;
+  } else {
+    ticksDelete = 0;
   }
-  pendingObjDelete.clear();
 
+  P64_TRACE_SCOPE(EVENTS);
   // events, switch now to prevent infinite loops for objects that push events in response to events
   auto &evQueue = eventQueue[eventQueueIdx];
   eventQueueIdx = (eventQueueIdx + 1) % 2;
-  for(uint32_t e=0; e<evQueue.eventCount; ++e)
+  eventCount = evQueue.events.size();
+  eventOverflowCount = evQueue.overflowCount;
+  eventDroppedCount = evQueue.droppedCount;
+  evQueue.overflowCount = 0;
+  evQueue.droppedCount = 0;
+
+  // group by target (keeping the order per target), so each object is only looked up once.
+  // group and broadcast events come after all direct ones
+  std::stable_sort(evQueue.events.begin(), evQueue.events.end(), [](const ObjectEventWrapper &a, const ObjectEventWrapper &b) {
+    if(a.scope != b.scope)return a.scope < b.scope;
+    return a.targetId < b.targetId;
+  });
+
+  for(uint32_t e=0; e<eventCount;)
   {
     auto &entry = evQueue.events[e];
-    auto obj = getObjectById(entry.targetId);
-    if(obj)
+    if(entry.scope != EventScope::OBJECT)
     {
-      auto compRefs = obj->getCompRefs();
-      for (uint32_t i=0; i<obj->compCount; ++i) {
-        const auto &compDef = COMP_TABLE[compRefs[i].type];
-        if(compDef.onEvent)
-        {
-          char* dataPtr = (char*)obj + compRefs[i].offset;
-          compDef.onEvent(*obj, dataPtr, entry.event);
-        }
+      auto sendFiltered = [&](Object* obj) {
+        if(entry.compMask && !(obj->compMask & entry.compMask))return;
+        dispatchEvent(*obj, entry.event);
+      };
+
+      if(entry.scope == EventScope::CHILDREN) {
+        iterObjectChildren(entry.targetId, sendFiltered);
+      } else {
+        for(auto obj : objects)sendFiltered(obj);
       }
+      ++e;
+      continue;
     }
+
+    uint16_t targetId = entry.targetId;
+    uint32_t eEnd = e + 1;
+    while(eEnd < eventCount && evQueue.events[eEnd].scope == EventScope::OBJECT
+      && evQueue.events[eEnd].targetId == targetId)++eEnd;
+
+    auto obj = getObjectById(targetId);
+    if(obj) {
+      for(; e<eEnd; ++e)dispatchEvent(*obj, evQueue.events[e].event);
+    }
+    e = eEnd;
   }
   evQueue.clear();
 
-  AudioManager::update();
+  // nothing may still run when drawing starts
+  RSPJobs::sync();
+}
 
-  VI::SwapChain::nextFrame();
+void P64::Scene::storeInterpState()
+{
+  interpStates.resize(objects.size());
+  for(uint32_t i=0; i<objects.size(); ++i) {
+    auto obj = objects[i];
+    interpStates[i] = {obj, obj->rot, obj->pos, obj->scale, {}, {}, {}};
+  }
+
+  interpCams.resize(cameras.size());
+  for(uint32_t i=0; i<cameras.size(); ++i) {
+    auto cam = cameras[i];
+    interpCams[i] = {cam, cam->getPos(), cam->getTarget(), cam->getUp(), {}, {}, {}};
+  }
+}
+
+void P64::Scene::applyInterpState(bool interpolate)
+{
+  if(interpolate) {
+    for(auto &st : interpStates) {
+      auto obj = st.obj;
+      st.currRot = obj->rot;
+      st.currPos = obj->pos;
+      st.currScale = obj->scale;
+      t3d_quat_nlerp(&obj->rot, &st.prevRot, &st.currRot, tickAlpha);
+      t3d_vec3_lerp(&obj->pos, &st.prevPos, &st.currPos, tickAlpha);
+      t3d_vec3_lerp(&obj->scale, &st.prevScale, &st.currScale, tickAlpha);
+    }
+  } else {
+    for(auto &st : interpStates) {
+      st.obj->rot = st.currRot;
+      st.obj->pos = st.currPos;
+      st.obj->scale = st.currScale;
+    }
+  }
+
+  for(auto &st : interpCams)
+  {
+    // cameras may get removed in a tick, only touch the ones still active
+    if(std::find(cameras.begin(), cameras.end(), st.cam) == cameras.end())continue;
+    if(interpolate) {
+      st.currPos = st.cam->getPos();
+      st.currTarget = st.cam->getTarget();
+      st.currUp = st.cam->getUp();
+
+      fm_vec3_t pos, target, up;
+      t3d_vec3_lerp(&pos, &st.prevPos, &st.currPos, tickAlpha);
+      t3d_vec3_lerp(&target, &st.prevTarget, &st.currTarget, tickAlpha);
+      t3d_vec3_lerp(&up, &st.prevUp, &st.currUp, tickAlpha);
+      st.cam->setLookAt(pos, target, up);
+    } else {
+      st.cam->setLookAt(st.currPos, st.currTarget, st.currUp);
+    }
+    st.cam->update(0.0f);
+  }
 }
 
 void P64::Scene::draw([[maybe_unused]] float deltaTime)
 {
-  ticksDraw = get_ticks();
+  P64_TRACE_SCOPE(DRAW);
+  // draw metrics are only written at the end, so hooks see the values of the last full frame
+  uint64_t ticksDrawStart = get_ticks();
+  uint64_t ticksGlobal = 0;
+#if P64_COMP_PROFILE
+  for(auto &t : ticksCompDraw)t = 0;
+  for(auto &c : callsCompDraw)c = 0;
+#endif
+
+  bool interpolate = conf.tickRate != 0;
+  if(interpolate)applyInterpState(true);
 
   GlobalScript::callHooks(GlobalScript::HookType::SCENE_PRE_DRAW);
   renderPipeline->preDraw();
   DrawLayer::draw(0);
 
 
+  // culling volumes are tested against all cameras in one pass,
+  // the per-camera draw then only checks a bit (for the first few cameras)
+  uint32_t cameraCells[Comp::Culling::MAX_CACHED_CAMERAS];
+  uint32_t camCachedCount = std::min<uint32_t>(cameras.size(), Comp::Culling::MAX_CACHED_CAMERAS);
+  for(uint32_t c=0; c<camCachedCount; ++c) {
+    cameraCells[c] = getCellsVisibleFrom(cameras[c]->getPos());
+  }
+  for(auto &comp : getActiveList(Comp::Culling::ID)) {
+    if(!comp.obj->isEnabled())continue;
+    Comp::Culling::updateVisibility(*comp.obj, (Comp::Culling*)comp.data, cameras.data(), cameraCells, camCachedCount);
+  }
+
+  // point lights are re-added each tick, only invalidate per-object selections if they changed
+  lighting.updateVersion();
+  // t3d keeps its state between frames, but anything outside the scene may have set lights too
+  Lighting::invalidate();
+  BlobShadows::prepare();
+
   // 3D Pass, for every active camera
+  camIndex = 0;
   for(auto &cam : cameras)
   {
+    P64_TRACE_SCOPE(CAMERA, camIndex);
     camMain = cam;
     cam->attach();
+    visibleCells = camIndex < camCachedCount ? cameraCells[camIndex] : getCellsVisibleFrom(cam->getPos());
 
     lighting.apply();
     t3d_matrix_push_pos(1);
@@ -233,32 +538,42 @@ void P64::Scene::draw([[maybe_unused]] float deltaTime)
 
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_PRE_DRAW_3D);
 
-    //debugf("Drawing objects:\n");
-    for(auto obj : objects)
+    for(auto compId : COMP_DISPATCH_ORDER)
     {
-      //debugf(" - %d\n", obj->id);
-      if(!obj->isEnabled())continue;
-      auto compRefs = obj->getCompRefs();
-
-      for (uint32_t i=0; i<obj->compCount; ++i)
-      {
-        if(obj->flags & ObjectFlags::IS_CULLED)break;
-        const auto &compDef = COMP_TABLE[compRefs[i].type];
-        if(compDef.draw)
-        {
-          char* dataPtr = (char*)obj + compRefs[i].offset;
-          compDef.draw(*obj, dataPtr, deltaTime);
-        }
+      auto funcDraw = COMP_TABLE[compId].draw;
+      if(!funcDraw)continue;
+      auto &list = getActiveList(compId);
+      if(list.empty())continue;
+
+      P64_TRACE_SCOPE(COMP_DRAW, compId);
+      COMP_PROFILE_START();
+      for(auto &comp : list) {
+        if(!comp.obj->isEnabled() || (comp.obj->flags & ObjectFlags::IS_CULLED))continue;
+        funcDraw(*comp.obj, comp.data, deltaTime);
+        COMP_PROFILE_CALL(callsCompDraw, compId);
       }
+      COMP_PROFILE_END(ticksCompDraw, compId);
+    }
 
-      // culling resets directly after a draw, otherwise objects can get stuck culled.
-      // this is also needed to handle multiple cameras correctly.
+    // models only queue up their draws above, emit them sorted by layer/material/depth.
+    // Matrices of moved objects are built first, in one batch
+    MatrixBatch::flush();
+    P64_TRACE_BEGIN(DRAW_QUEUE);
+      DrawQueue::flush();
+    P64_TRACE_END(DRAW_QUEUE);
+    BlobShadows::draw();
+    // draws may have picked their own point lights, restore for anything drawn after
+    if(lighting.needsSelection())lighting.apply();
+
+    // culling resets directly after a draw, otherwise objects can get stuck culled.
+    // this is also needed to handle multiple cameras correctly.
+    for(auto obj : objects) {
       obj->setFlag(ObjectFlags::IS_CULLED, false);
     }
 
     auto t = get_user_ticks();
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_POST_DRAW_3D);
-    ticksGlobalDraw += get_user_ticks() - t;
+    ticksGlobal += get_user_ticks() - t;
 
     t3d_matrix_pop(1);
     for(int i=1; i<conf.layerSetup.layerCount3D; ++i) {
@@ -266,16 +581,22 @@ void P64::Scene::draw([[maybe_unused]] float deltaTime)
         t3d_matrix_pop(1);
       DrawLayer::useDefault();
     }
+    ++camIndex;
   }
 
   auto t = get_user_ticks();
   DrawLayer::use2D();
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_DRAW_2D);
   DrawLayer::useDefault();
-  ticksGlobalDraw += get_user_ticks() - t;
+  Batch2D::flush();
+  ticksGlobal += get_user_ticks() - t;
 
-  renderPipeline->draw();
-  ticksDraw = get_ticks() - ticksDraw;
+  P64_TRACE_BEGIN(PIPELINE);
+    renderPipeline->draw();
+  P64_TRACE_END(PIPELINE);
+  if(interpolate)applyInterpState(false);
+  ticksGlobalDraw = ticksGlobal;
+  ticksDraw = get_ticks() - ticksDrawStart;
 
 #if RSPQ_PROFILE
   rspq_profile_next_frame();
@@ -287,6 +608,138 @@ void P64::Scene::draw([[maybe_unused]] float deltaTime)
 #endif
 }
 
+void P64::Scene::freeObject(Object* obj)
+{
+  uint32_t allocSize = obj->allocSize;
+  bool isPersistent = obj->flags & ObjectFlags::PERSISTENT;
+  obj->~Object();
+  Mem::track(Mem::Category::OBJECTS, -(int32_t)allocSize);
+
+  // outlives the memory of any scene, see 'loadObject'
+  if(isPersistent) {
+    ::free(obj);
+    return;
+  }
+  // arena memory is only released as a whole on unload,
+  // until then it can be re-used for spawned objects
+  if(objArena.contains(obj)) {
+    objPool.recycle(obj, allocSize);
+    return;
+  }
+
+  // same for chunks, their arena is freed once the chunk is unloaded
+  for(uint32_t c=0; c<chunkCount; ++c) {
+    if(chunks[c].arena.contains(obj))return;
+  }
+
+  for(auto &[idx, tpl] : prefabTemplates) {
+    if(tpl.instances.contains(obj)) {
+      tpl.freeInstances.push_back(obj);
+      return;
+    }
+  }
+  objPool.free(obj);
+}
+
+void P64::Scene::registerComponents(Object* obj)
+{
+  auto compRefs = obj->getCompRefs();
+  for (uint32_t i=0; i<obj->compCount; ++i)
+  {
+    const auto &compDef = COMP_TABLE[compRefs[i].type];
+    if(!compDef.update && !compDef.draw)continue;
+
+    // keep memory order, multiple components of the same type stay in declaration order
+    auto &list = compLists[compRefs[i].type];
+    auto it = std::upper_bound(list.begin(), list.end(), obj, [](Object* o, const CompInstance &c) {
+      return o < c.obj;
+    });
+    list.insert(it, {obj, (char*)obj + compRefs[i].offset});
+  }
+  activeDirty = true;
+}
+
+void P64::Scene::updateActiveLists() const
+{
+  activeDirty = false;
+  for(uint32_t i=0; i<COMP_TABLE_SIZE; ++i) {
+    auto &active = activeLists[i];
+    active.clear();
+    for(auto &comp : compLists[i]) {
+      if(comp.obj->isEnabled())active.push_back(comp);
+    }
+  }
+}
+
+void P64::Scene::sortConstraints()
+{
+  constraintsDirty = false;
+  constraintOrder.clear();
+  for(auto &comp : compLists[Comp::Constraint::ID]) {
+    auto data = (Comp::Constraint*)comp.data;
+    if(data->type == Comp::Constraint::TYPE_COPY_CAM)continue; // done in 'draw'
+    auto refObj = getObjectById(data->refObjId);
+    if(refObj)constraintOrder.push_back({comp.obj, data, refObj, 0});
+  }
+
+  // the depth of a constraint is one more than the deepest one on its reference.
+  // the list is still in object order, so those are found with a binary search.
+  // each pass settles at least one more level, cycles stop after as many passes as there are slots
+  auto byObj = [](const ConstraintSlot &a, const ConstraintSlot &b) { return a.obj < b.obj; };
+  bool changed = true;
+  for(uint32_t pass=0; changed && pass<constraintOrder.size(); ++pass) {
+    changed = false;
+    for(auto &slot : constraintOrder) {
+      auto range = std::equal_range(constraintOrder.begin(), constraintOrder.end(),
+        ConstraintSlot{slot.refObj, nullptr, nullptr, 0}, byObj
+      );
+      for(auto it = range.first; it != range.second; ++it) {
+        if(it->depth + 1 <= slot.depth)continue;
+        slot.depth = it->depth + 1;
+        changed = true;
+      }
+    }
+  }
+
+  std::stable_sort(constraintOrder.begin(), constraintOrder.end(), [](const ConstraintSlot &a, const ConstraintSlot &b) {
+    return a.depth < b.depth;
+  });
+}
+
+void P64::Scene::updateConstraints()
+{
+  if(constraintsDirty)sortConstraints();
+  if(constraintOrder.empty())return;
+
+  P64_TRACE_SCOPE(COMP_UPDATE, Comp::Constraint::ID);
+  uint32_t ticksStart = get_ticks();
+  for(auto &slot : constraintOrder) {
+    if(!slot.obj->isEnabled())continue;
+    Comp::Constraint::apply(*slot.obj, slot.data, *slot.refObj);
+    COMP_PROFILE_CALL(callsCompUpdate, Comp::Constraint::ID);
+  }
+  uint32_t ticks = get_ticks() - ticksStart;
+  ticksConstraints += ticks;
+#if P64_COMP_PROFILE
+  ticksCompUpdate[Comp::Constraint::ID] += ticks;
+#endif
+}
+
+void P64::Scene::dispatchEvent(Object &obj, const ObjectEvent &event)
+{
+  if(!(obj.flags & ObjectFlags::HAS_EVENTS))return;
+
+  auto compRefs = obj.getCompRefs();
+  for (uint32_t i=0; i<obj.compCount; ++i) {
+    const auto &compDef = COMP_TABLE[compRefs[i].type];
+    if(compDef.onEvent)
+    {
+      char* dataPtr = (char*)&obj + compRefs[i].offset;
+      compDef.onEvent(obj, dataPtr, event);
+    }
+  }
+}
+
 void P64::Scene::onObjectCollision(const Coll::CollEvent &event)
 {
   auto objA = event.selfBCS ? event.selfBCS->obj : event.selfMesh->object;
@@ -294,7 +747,8 @@ void P64::Scene::onObjectCollision(const Coll::CollEvent &event)
   if(!objA || !objB)return;
 
   auto compRefsA = objA->getCompRefs();
-  for (uint32_t i=0; i<objA->compCount; ++i)
+  uint32_t compCountA = (objA->flags & ObjectFlags::HAS_COLL) ? objA->compCount : 0;
+  for (uint32_t i=0; i<compCountA; ++i)
   {
     const auto &compDef = COMP_TABLE[compRefsA[i].type];
     if(compDef.onColl) {
@@ -304,6 +758,7 @@ void P64::Scene::onObjectCollision(const Coll::CollEvent &event)
   }
 
   //if(!event.otherBCS)return;
+  if(!(objB->flags & ObjectFlags::HAS_COLL))return;
 
   Coll::CollEvent eventOther{
     .selfBCS = event.otherBCS,
@@ -329,9 +784,8 @@ uint16_t P64::Scene::addObject(
   const fm_vec3_t &scale,
   const fm_quat_t &rot
 ) {
-  auto *prefabData = AssetManager::getByIndex(prefabIdx);
   objectsToAdd.push_back({
-    .prefabData = prefabData,
+    .prefabIdx = prefabIdx,
     .pos = pos,
     .scale = scale,
     .rot = rot,
@@ -342,49 +796,150 @@ uint16_t P64::Scene::addObject(
 
 void P64::Scene::removeObject(Object &obj)
 {
+  if(obj.flags & ObjectFlags::PENDING_REMOVE)return;
+  obj.flags |= ObjectFlags::PENDING_REMOVE;
+  obj.flags &= ~ObjectFlags::ACTIVE;
   pendingObjDelete.push_back(&obj);
 }
 
 P64::Object* P64::Scene::getObjectById(uint16_t objId) const
 {
-  // the first IDs get a direct lookup, under the assumption most
-  // scenes keep object count in a reasonable amount
-  if(objId < idLookup.size()) {
-    return idLookup[objId];
-  }
+  return idLookup.get(objId);
+}
+
+void P64::Scene::releasePersistentObjects(std::vector<Object*> &out)
+{
+  // anything already removed is deleted with the scene as usual
+  auto isPersistent = [](const Object* obj) {
+    return (obj->flags & (ObjectFlags::PERSISTENT | ObjectFlags::PENDING_REMOVE)) == ObjectFlags::PERSISTENT;
+  };
 
-  // otherwise fallback to a linear scan
   for(auto obj : objects) {
-    if (objId == obj->id) {
-      return obj;
-    }
+    if(isPersistent(obj))out.push_back(obj);
+  }
+  if(out.empty())return;
+
+  for(auto obj : out) {
+    dispatchEvent(*obj, {.senderId = 0, .type = EVENT_TYPE_SCENE_LEAVE, .value = 0});
+    idLookup.remove(obj->id);
+  }
+
+  std::erase_if(objects, isPersistent);
+  objGrid.removeIf(isPersistent);
+  for(auto &list : compLists) {
+    if(list.empty())continue;
+    std::erase_if(list, [&](const CompInstance &c) { return isPersistent(c.obj); });
+  }
+  std::erase_if(interpStates, [&](const InterpState &st) { return isPersistent(st.obj); });
+  constraintsDirty = true;
+  activeDirty = true;
+  keepMatrices = true;
+}
+
+void P64::Scene::adoptObjects(const std::vector<Object*> &objs)
+{
+  // children are linked again once all of them can be found by ID
+  for(auto obj : objs) {
+    obj->firstChild = nullptr;
+    obj->nextSibling = nullptr;
+    idLookup.set(obj->id, obj);
+  }
+  for(auto obj : objs)addToScene(obj);
+}
+
+void P64::Scene::changeObjectId(Object &obj)
+{
+  uint16_t newId = ++nextId;
+  Log::warn("Object %d: ID is used by the new scene, changed to %d", obj.id, newId);
+
+  idLookup.remove(obj.id);
+  obj.id = newId;
+  idLookup.set(newId, &obj);
+  for(auto child = obj.firstChild; child; child = child->nextSibling) {
+    child->group = newId;
   }
-  return nullptr;
 }
 
 void P64::Scene::setGroupEnabled(uint16_t groupId, bool enabled) const
 {
   if(groupId == 0)return;
 
-  for(auto obj : objects)
-  {
-    if (groupId == obj->id) {
-      obj->setFlag(ObjectFlags::SELF_ACTIVE, enabled);
-    }
-    if (groupId == obj->group) {
-      //debugf("-> obj %d active = %d\n", obj->id, enabled);
-      obj->setFlag(ObjectFlags::PARENTS_ACTIVE, enabled);
+  auto group = getObjectById(groupId);
+  if(!group)return;
+
+  group->setFlag(ObjectFlags::SELF_ACTIVE, enabled);
+  activeDirty = true;
+  for(auto child = group->firstChild; child; child = child->nextSibling) {
+    //debugf("-> obj %d active = %d\n", child->id, enabled);
+    child->setFlag(ObjectFlags::PARENTS_ACTIVE, enabled);
+  }
+}
+
+uint32_t P64::Scene::getCellsVisibleFrom(const fm_vec3_t &pos) const
+{
+  uint32_t cells = 0;
+  for(auto &comp : getActiveList(Comp::Culling::ID)) {
+    if(!comp.obj->isEnabled())continue;
+    cells |= Comp::Culling::getCellVisibility(*comp.obj, (Comp::Culling*)comp.data, pos);
+  }
+  // outside any cell, e.g. outdoors, everything can be seen
+  return cells == 0 ? 0xFFFF'FFFF : cells;
+}
+
+void P64::Scene::setChildrenCulled(Object &obj) const
+{
+  for(auto child = obj.firstChild; child; child = child->nextSibling) {
+    child->setFlag(ObjectFlags::IS_CULLED, true);
+    if(child->firstChild)setChildrenCulled(*child);
+  }
+}
+
+void P64::Scene::linkToParent(Object* obj)
+{
+  // new objects start without links, taken over ones are reset beforehand (see 'adoptObjects')
+  if(obj->group == 0)return;
+
+  auto parent = getObjectById(obj->group);
+  if(!parent)return;
+
+  // insert sorted by address, so children are iterated in memory order
+  auto *link = &parent->firstChild;
+  while(*link && *link < obj)link = &(*link)->nextSibling;
+  obj->nextSibling = *link;
+  *link = obj;
+}
+
+void P64::Scene::unlinkFromParent(Object* obj)
+{
+  // orphaned children stay in the scene, but are no longer reachable from the removed parent
+  for(auto child = obj->firstChild; child;) {
+    auto next = child->nextSibling;
+    child->nextSibling = nullptr;
+    child = next;
+  }
+  obj->firstChild = nullptr;
+
+  auto parent = obj->group ? getObjectById(obj->group) : nullptr;
+  if(!parent)return;
+
+  for(auto *link = &parent->firstChild; *link; link = &(*link)->nextSibling) {
+    if(*link == obj) {
+      *link = obj->nextSibling;
+      break;
     }
   }
+  obj->nextSibling = nullptr;
 }
 
 P64::Lighting & P64::Scene::startLightingOverride(bool copyExisting)
 {
   lightingTemp = copyExisting ? lighting : Lighting{};
+  lightingOverride = true;
   return lightingTemp;
 }
 
 void P64::Scene::endLightingOverride()
 {
+  lightingOverride = false;
   lighting.apply();
 }
\ No newline at end of file
@@ -5,9 +5,17 @@
 #include <libdragon.h>
 #include <cstdint>
 #include <malloc.h>
+#include <vector>
 #include "scene/scene.h"
 #include "lib/math.h"
+#include "lib/matrixManager.h"
+#include "lib/memory.h"
+#include "lib/logger.h"
 #include "scene/componentTable.h"
+#include "assets/assetManager.h"
+#include "scene/sceneManager.h"
+#include "debug/hotReload.h"
+#include "debug/loadReport.h"
 
 namespace {
   constexpr uint32_t DATA_ALIGN = 8;
@@ -16,13 +24,20 @@ namespace {
     uint16_t flags;
     uint16_t id;
     uint16_t group;
-    uint16_t _padding;
+    uint8_t updateTier;
+    uint8_t _padding;
     fm_vec3_t pos;
     fm_vec3_t scale;
     uint32_t packedRot;
     // data follows
   };
 
+  // prefab files start with this, followed by the object itself
+  struct PrefabHeader {
+    uint16_t poolSize; // amount of instances to reserve memory for
+    uint16_t _padding;
+  };
+
   struct __attribute__((packed)) ObjectEntryCamera : public ObjectEntry {
     uint16_t _padding;
     fm_vec3_t pos{};
@@ -45,67 +60,169 @@ namespace {
     scenePath[sizeof(scenePath)-3] = '0' + (id % 10);
   }
 
-  inline void* loadSubFile(char type) {
+  inline void* loadSubFile(char type, int *size = nullptr) {
     scenePath[sizeof(scenePath)-2] = type;
     scenePath[sizeof(scenePath)-1] = '\0';
-    return asset_load(scenePath, nullptr);
+    return asset_load(Debug::HotReload::resolvePath(scenePath), size);
   }
 }
 
-void P64::Scene::loadSceneConfig()
+namespace P64
 {
-  updateScenePath(id);
-  scenePath[sizeof(scenePath)-2] = '\0';
+  struct ObjectLayout {
+    uint32_t allocSize;
+    uint32_t compCount;
+    uint32_t offsetData;
+    uint8_t* next; // start of the next object in the file
+    // data offset per component (relative to the first one), see 'Scene::loadObjects'
+    const uint16_t* compOffsets;
+  };
+}
 
+namespace
+{
+  using P64::ObjectLayout;
+
+  /**
+   * Scans the component list of an object in the file to get the
+   * total allocation size, this does not modify or create anything.
+   * Optionally collects the data offset of each component, which can be re-used when creating it.
+   */
+  ObjectLayout scanObject(uint8_t* objFile, std::vector<uint16_t>* compOffsets = nullptr)
   {
-    auto *tmp = (SceneConf*)asset_load(scenePath, nullptr);
-    conf = *tmp;
-    free(tmp);
+    using namespace P64;
+
+    // pre-scan components to get total allocation size
+    uint32_t allocSize = sizeof(Object);
+
+    // some alignment logic below relies on an at a minimum 4-byte size
+    static_assert(sizeof(Object) % 4 == 0);
+    static_assert(sizeof(Object::CompRef) % 4 == 0);
+
+    auto ptrIn = objFile + sizeof(ObjectEntry);
+    uint32_t compCount = 0;
+    uint32_t compDataSize = 0;
+    uint32_t compMask = 0;
+    while(ptrIn[1] != 0) {
+      auto compId = ptrIn[0];
+      auto argSize = ptrIn[1] * 4;
+
+      assertf(compId < COMP_TABLE_SIZE, "Invalid component ID %d!", compId);
+      const auto &compDef = COMP_TABLE[compId];
+      assertf(compDef.getAllocSize != nullptr, "Component %d unknown!", compId);
+      if(compOffsets)compOffsets->push_back(compDataSize);
+      compDataSize += Math::alignUp(compDef.getAllocSize(ptrIn + 4), DATA_ALIGN);
+      allocSize += sizeof(Object::CompRef);
+      compMask |= 1 << compId;
+
+      ptrIn += argSize;
+      ++compCount;
+    }
+
+    // component data must be 8-byte aligned, GCC tries to be smart
+    // and some structs cuse 64-bit writes to members.
+    // if it is misaligned, add spacing after the comp table
+    uint32_t offsetData = (sizeof(Object::CompRef) * compCount);
+
+    // followed by offsets of the first component per type (see Object::getComponent)
+    uint32_t typeTableSize = Math::alignUp(__builtin_popcount(compMask) * sizeof(uint16_t), 4);
+    allocSize += typeTableSize;
+    offsetData += typeTableSize;
+
+    if(allocSize % 8 != 0) {
+      compDataSize += 4;
+      offsetData += 4;
+    }
+
+    return {
+      .allocSize = allocSize + compDataSize,
+      .compCount = compCount,
+      .offsetData = offsetData,
+      .next = ptrIn + 4,
+      .compOffsets = nullptr,
+    };
   }
-}
 
-P64::Object* P64::Scene::loadObject(uint8_t* &objFile, std::function<void(Object&)> callback)
-{
-  ObjectEntry* objEntry = (ObjectEntry*)objFile;
+  // chunk streaming, see 'Scene::updateChunks'
+  struct ChunkTable {
+    float size;
+    float loadDist;
+    uint16_t count;
+    uint16_t _padding;
+    struct { int16_t x, z; } cells[];
+  };
 
-  // pre-scan components to get total allocation size
-  uint32_t allocSize = sizeof(Object);
+  // start of each chunk file, followed by the asset indices and then the objects (4-byte aligned)
+  struct ChunkHeader {
+    uint16_t assetCount;
+    uint16_t objectCount;
+  };
 
-  // some alignment logic below relies on an at a minimum 4-byte size
-  static_assert(sizeof(Object) % 4 == 0);
-  static_assert(sizeof(Object::CompRef) % 4 == 0);
+  // same as for the scene, the path is changed in place to avoid allocations
+  char chunkPath[] = "rom:/p64/s0000k000";
 
-  auto ptrIn = objFile + sizeof(ObjectEntry);
-  uint32_t compCount = 0;
-  uint32_t compDataSize = 0;
-  while(ptrIn[1] != 0) {
-    auto compId = ptrIn[0];
-    auto argSize = ptrIn[1] * 4;
+  void* loadChunkFile(uint16_t sceneId, uint32_t idx, int *size)
+  {
+    chunkPath[sizeof(chunkPath)-8] = '0' + ((sceneId/100) % 10);
+    chunkPath[sizeof(chunkPath)-7] = '0' + ((sceneId/10) % 10);
+    chunkPath[sizeof(chunkPath)-6] = '0' + (sceneId % 10);
+    chunkPath[sizeof(chunkPath)-4] = '0' + ((idx/100) % 10);
+    chunkPath[sizeof(chunkPath)-3] = '0' + ((idx/10) % 10);
+    chunkPath[sizeof(chunkPath)-2] = '0' + (idx % 10);
+    return asset_load(Debug::HotReload::resolvePath(chunkPath), size);
+  }
 
-    assertf(compId < COMP_TABLE_SIZE, "Invalid component ID %d!", compId);
-    const auto &compDef = COMP_TABLE[compId];
-    assertf(compDef.getAllocSize != nullptr, "Component %d unknown!", compId);
-    compDataSize += Math::alignUp(compDef.getAllocSize(ptrIn + 4), DATA_ALIGN);
-    allocSize += sizeof(Object::CompRef);
+  uint8_t* skipObject(uint8_t* objFile) {
+    auto ptrIn = objFile + sizeof(ObjectEntry);
+    while(ptrIn[1] != 0)ptrIn += ptrIn[1] * 4;
+    return ptrIn + 4;
+  }
 
-    ptrIn += argSize;
-    ++compCount;
+  uint8_t* getObjectData(uint8_t* file) {
+    auto header = (ChunkHeader*)file;
+    return file + Math::alignUp(sizeof(ChunkHeader) + header->assetCount * sizeof(uint16_t), 4);
   }
+}
+
+uint16_t* P64::Scene::loadAssetList(uint16_t sceneId, bool persistent)
+{
+  updateScenePath(sceneId);
+  return (uint16_t*)loadSubFile(persistent ? 'p' : 'a');
+}
+
+void P64::Scene::loadSceneConfig()
+{
+  updateScenePath(id);
+  scenePath[sizeof(scenePath)-2] = '\0';
 
-  // component data must be 8-byte aligned, GCC tries to be smart
-  // and some structs cuse 64-bit writes to members.
-  // if it is misaligned, add spacing after the comp table
-  uint32_t offsetData = (sizeof(Object::CompRef) * compCount);
-  if(allocSize % 8 != 0) {
-    compDataSize += 4;
-    offsetData += 4;
+  {
+    auto *tmp = (SceneConf*)asset_load(Debug::HotReload::resolvePath(scenePath), nullptr);
+    conf = *tmp;
+    free(tmp);
   }
+}
 
-  allocSize += compDataSize;
+P64::Object* P64::Scene::loadObject(uint8_t* &objFile, Mem::Arena &arena, const ObjectLayout &layout)
+{
+  auto reportStart = Debug::LoadReport::mark();
+  ObjectEntry* objEntry = (ObjectEntry*)objFile;
+  uint32_t allocSize = layout.allocSize;
+  uint32_t compCount = layout.compCount;
+  assertf(allocSize <= 0xFFFF, "Object %d too large (%lu bytes)", objEntry->id, allocSize);
 
   //debugf("Allocating object %d | comps: %d | size: %lu bytes\n", objEntry->id, compCount, allocSize);
 
-  void* objMem = memalign(DATA_ALIGN, allocSize); // @TODO: custom allocator
+  // objects from the scene (or chunk) file are placed into the pre-sized arena,
+  // persistent ones may outlive it and get their own allocation
+  void* objMem = nullptr;
+  if(objEntry->flags & ObjectFlags::PERSISTENT) {
+    objMem = memalign(Mem::Arena::ALIGN, allocSize);
+  } else {
+    objMem = arena.alloc(allocSize);
+    if(!objMem)objMem = objPool.alloc(allocSize);
+  }
+  Mem::track(Mem::Category::OBJECTS, allocSize);
+
   if(allocSize < 16) {
     memset(objMem, 0, allocSize);
   } else {
@@ -113,36 +230,43 @@ P64::Object* P64::Scene::loadObject(uint8_t* &objFile, std::function<void(Object
   }
 
   auto objCompTablePtr = (Object::CompRef*)((char*)objMem + sizeof(Object));
-  auto objCompDataPtr = (char*)(objCompTablePtr) + offsetData;
+  auto objCompDataPtr = (char*)(objCompTablePtr) + layout.offsetData;
 
   Object* obj = new(objMem) Object();
   obj->id = objEntry->id;
   obj->group = objEntry->group;
   obj->flags = objEntry->flags;
+  obj->updateTier = objEntry->updateTier;
+  obj->updatePhase = (uint8_t)obj->id;
   obj->compCount = compCount;
+  obj->allocSize = allocSize;
+  obj->generation = nextGeneration;
+  if(++nextGeneration == 0)nextGeneration = 1;
   obj->pos = objEntry->pos;
   obj->scale = objEntry->scale;
   obj->rot = Math::unpackQuat(objEntry->packedRot);
 
-  if(callback)callback(*obj);
+  // set up the component table first, so components can already find each other during init.
+  // offsets come from the scan, which already had to ask each component for its size
+  auto ptrIn = objFile + sizeof(ObjectEntry);
+  uint16_t offsetData = objCompDataPtr - (char*)obj;
+  for(uint32_t i=0; i<compCount; ++i)
+  {
+    objCompTablePtr[i].type = ptrIn[0];
+    objCompTablePtr[i].flags = 0;
+    objCompTablePtr[i].offset = offsetData + layout.compOffsets[i];
+    ptrIn += ptrIn[1] * 4;
+  }
+  obj->buildTypeTable();
 
+  auto compRefs = obj->getCompRefs();
   ptrIn = objFile + sizeof(ObjectEntry);
-  while(ptrIn[1] != 0)
+  for(uint32_t i=0; i<compCount; ++i)
   {
-    uint8_t compId = ptrIn[0];
-    uint8_t argSize = ptrIn[1] * 4;
-
-    const auto &compDef = COMP_TABLE[compId];
-    // debugf("Alloc: comp %d (arg: %d)\n", compId, argSize);
-
-    objCompTablePtr->type = compId;
-    objCompTablePtr->flags = 0;
-    objCompTablePtr->offset = objCompDataPtr - (char*)obj;
-    ++objCompTablePtr;
-
-    compDef.initDel(*obj, objCompDataPtr, ptrIn + 4);
-    objCompDataPtr += Math::alignUp(compDef.getAllocSize(ptrIn + 4), 8);
-    ptrIn += argSize;
+    auto reportComp = Debug::LoadReport::mark();
+    COMP_TABLE[compRefs[i].type].initDel(*obj, (char*)obj + compRefs[i].offset, ptrIn + 4);
+    Debug::LoadReport::onComponent(compRefs[i].type, reportComp);
+    ptrIn += ptrIn[1] * 4;
   }
 
   /*debugf("Object: id=%d | group=%d | flags=0x%04X | pos=(%f,%f,%f) | comp: %d\n",
@@ -152,41 +276,379 @@ P64::Object* P64::Scene::loadObject(uint8_t* &objFile, std::function<void(Object
   );*/
 
   objFile = ptrIn + 4;
+  addToScene(obj);
+  Debug::LoadReport::onObject(obj->id, reportStart);
+  return obj;
+}
 
-  objects.push_back(obj);
-  idLookup[obj->id] = obj;
+P64::Scene::PrefabTemplate& P64::Scene::getPrefabTemplate(uint32_t prefabIdx)
+{
+  auto [it, isNew] = prefabTemplates.try_emplace(prefabIdx);
+  auto &tpl = it->second;
+  if(!isNew)return tpl;
+
+  auto header = (PrefabHeader*)AssetManager::getByIndex(prefabIdx);
+  auto objFile = (uint8_t*)header + sizeof(PrefabHeader);
+  auto objEntry = (ObjectEntry*)objFile;
+  auto layout = scanObject(objFile);
+  assertf(layout.allocSize <= 0xFFFF, "Prefab %lu too large (%lu bytes)", prefabIdx, layout.allocSize);
+
+  tpl.allocSize = layout.allocSize;
+  tpl.group = objEntry->group;
+  tpl.updateTier = objEntry->updateTier;
+  tpl.compCount = layout.compCount;
+  tpl.compRefs.resize(layout.compCount);
+  tpl.compInitData.resize(layout.compCount);
+
+  // resolve component offsets and init-data once, spawning then just copies this
+  uint32_t offset = sizeof(Object) + layout.offsetData;
+  auto ptrIn = objFile + sizeof(ObjectEntry);
+  for(uint32_t i=0; i<layout.compCount; ++i)
+  {
+    uint8_t compId = ptrIn[0];
+    tpl.compRefs[i] = {.type = compId, .flags = 0, .offset = (uint16_t)offset};
+    tpl.compInitData[i] = ptrIn + 4;
+    offset += Math::alignUp(COMP_TABLE[compId].getAllocSize(ptrIn + 4), DATA_ALIGN);
+    ptrIn += ptrIn[1] * 4;
+  }
+
+  if(header->poolSize) {
+    tpl.instances.init(Math::alignUp(tpl.allocSize, Mem::Arena::ALIGN) * header->poolSize);
+    tpl.freeInstances.reserve(header->poolSize);
+  }
+  return tpl;
+}
+
+P64::Object* P64::Scene::spawnObject(const PrefabParams &params)
+{
+  auto &tpl = getPrefabTemplate(params.prefabIdx);
+
+  void* objMem = nullptr;
+  if(!tpl.freeInstances.empty()) {
+    objMem = tpl.freeInstances.back();
+    tpl.freeInstances.pop_back();
+  } else {
+    objMem = tpl.instances.alloc(tpl.allocSize);
+  }
+  if(!objMem)objMem = objPool.alloc(tpl.allocSize);
+  Mem::track(Mem::Category::OBJECTS, tpl.allocSize);
 
+  sys_hw_memset(objMem, 0, tpl.allocSize);
+
+  Object* obj = new(objMem) Object();
+  obj->id = params.objectId;
+  obj->group = tpl.group;
+  obj->flags = ObjectFlags::ACTIVE;
+  obj->updateTier = tpl.updateTier;
+  obj->updatePhase = (uint8_t)obj->id;
+  obj->compCount = tpl.compCount;
+  obj->allocSize = tpl.allocSize;
+  obj->generation = nextGeneration;
+  if(++nextGeneration == 0)nextGeneration = 1;
+  obj->pos = params.pos;
+  obj->scale = params.scale;
+  obj->rot = params.rot;
+
+  auto compRefs = obj->getCompRefs();
+  memcpy(compRefs, tpl.compRefs.data(), sizeof(Object::CompRef) * tpl.compCount);
+  obj->buildTypeTable();
+  for(uint32_t i=0; i<tpl.compCount; ++i) {
+    COMP_TABLE[compRefs[i].type].initDel(*obj, (char*)obj + compRefs[i].offset, tpl.compInitData[i]);
+  }
+
+  addToScene(obj);
   return obj;
 }
 
+void P64::Scene::addToScene(Object* obj)
+{
+  // keep iteration in memory order, scene objects are always appended here.
+  // spawned ones may re-use freed pool memory so they need to be inserted
+  objects.insert(std::upper_bound(objects.begin(), objects.end(), obj), obj);
+  idLookup.set(obj->id, obj);
+  objGrid.insert(obj);
+  linkToParent(obj);
+  registerComponents(obj);
+  constraintsDirty = true;
+}
+
 void P64::Scene::loadScene() {
   updateScenePath(id);
   scenePath[sizeof(scenePath)-2] = '\0';
 
   cameras.clear();
 
+  // everything the scene and its prefabs reference, loading it now avoids hitches later on
+  {
+    Debug::LoadReport::ScopedPhase phase{Debug::LoadReport::Phase::PRELOAD};
+    auto *assetList = loadAssetList(id);
+    AssetManager::preload(assetList + 1, assetList[0], SceneManager::getLoadScreen());
+    free(assetList);
+  }
+
   //debugf("Objects: %lu\n", conf.objectCount);
   if(conf.objectCount)
   {
-    auto *objFileStart = (uint8_t*)(loadSubFile('o'));
+    Debug::LoadReport::ScopedPhase phase{Debug::LoadReport::Phase::OBJECTS};
+    int fileSize = 0;
+    auto *objFile = (uint8_t*)(loadSubFile('o', &fileSize));
+    objects.reserve(conf.objectCount);
+    loadObjects(objFile, fileSize, 0, conf.objectCount, objArena, nullptr);
+  }
+
+  updateGroups(objects.data(), objects.size());
+
+  if(conf.flags & SceneConf::FLAG_CHUNKS) {
+    loadChunkTable();
+  }
+}
+
+/**
+ * Creates all objects of a scene or chunk file, the file buffer itself becomes the arena of the objects.
+ * After a single scan (sizes, component offsets), the file is moved behind the space needed for
+ * the objects within the same block. Objects are then created front to back, so they never reach
+ * data that wasn't read yet, and the block is cut down to just the objects at the end.
+ * This avoids a second allocation and leaves no hole in the heap where the file was.
+ *
+ * @param file loaded file (heap), owned by the arena afterward
+ * @param fileSize size of the file in bytes
+ * @param offsetObjects start of the first object in the file
+ * @param count number of objects
+ * @param arena arena to create the objects in
+ * @param outObjects optional output, one entry per object
+ */
+void P64::Scene::loadObjects(uint8_t* file, uint32_t fileSize, uint32_t offsetObjects, uint32_t count, Mem::Arena &arena, Object** outObjects)
+{
+  std::vector<ObjectLayout> layouts{};
+  std::vector<uint16_t> compOffsets{};
+  layouts.resize(count);
+  compOffsets.reserve(count * 2);
+
+  uint32_t arenaSize = 0;
+  auto objFile = file + offsetObjects;
+  for(uint32_t i=0; i<count; ++i) {
+    layouts[i] = scanObject(objFile, &compOffsets);
+    if(!(((ObjectEntry*)objFile)->flags & ObjectFlags::PERSISTENT)) {
+      arenaSize += Math::alignUp(layouts[i].allocSize, Mem::Arena::ALIGN);
+    }
+    objFile = layouts[i].next;
+  }
+
+  uint32_t compIdx = 0;
+  for(auto &layout : layouts) {
+    layout.compOffsets = compOffsets.data() + compIdx;
+    compIdx += layout.compCount;
+  }
 
-    // now process all other objects
-    auto objFile = objFileStart;
-    for(uint32_t i=0; i<conf.objectCount; ++i) {
-      loadObject(objFile);
+  arenaSize = Math::alignUp(arenaSize, Mem::Arena::ALIGN);
+  auto block = (uint8_t*)realloc(file, arenaSize + fileSize);
+  assertf(block, "Failed to allocate %lu bytes for objects", arenaSize + fileSize);
+  memmove(block + arenaSize, block, fileSize);
+  arena.adopt(block, arenaSize);
+
+  objFile = block + arenaSize + offsetObjects;
+  for(uint32_t i=0; i<count; ++i)
+  {
+    // IDs are unique within a file, so only objects taken over from the last scene can clash.
+    // the same persistent object placed in both scenes keeps the existing one
+    auto entry = (ObjectEntry*)objFile;
+    if(auto other = getObjectById(entry->id)) {
+      if(entry->flags & ObjectFlags::PERSISTENT) {
+        objFile = skipObject(objFile);
+        if(outObjects)outObjects[i] = nullptr;
+        continue;
+      }
+      changeObjectId(*other);
     }
 
-    free(objFileStart);
+    auto obj = loadObject(objFile, arena, layouts[i]);
+    if(outObjects)outObjects[i] = obj;
   }
+  arena.trim();
+}
 
-  // update groups
-  for(auto obj : objects)
+void P64::Scene::updateGroups(Object* const* objList, uint32_t count)
+{
+  for(uint32_t i=0; i<count; ++i)
   {
+    auto obj = objList[i];
     if(obj->hasChildren())
     {
       bool groupActive = obj->isSelfEnabled();
-      debugf("Updating group %d | a:%d\n", obj->id, groupActive);
+      Log::info("Updating group %d | a:%d", obj->id, groupActive);
       setGroupEnabled(obj->id, groupActive);
     }
   }
 }
+
+/**
+ * Chunk streaming, objects marked as streamed in the editor are grouped into cells on the XZ-plane.
+ * Each cell is a separate file ('s####k###') with its own asset list, followed by its objects.
+ * Loading is split up to avoid hitches:
+ *   - in prefetch range, the file is loaded and its assets are queued (see 'AssetManager::processQueue')
+ *   - in load range, the objects are created, at most one chunk per frame
+ *   - out of range (with some hysteresis), the objects are deleted and memory/assets freed a few frames later
+ */
+void P64::Scene::loadChunkTable()
+{
+  updateScenePath(id);
+  auto table = (ChunkTable*)loadSubFile('c');
+  chunkSize = table->size;
+  chunkLoadDist = table->loadDist;
+  chunkCount = table->count;
+  chunks = new Chunk[chunkCount];
+  for(uint32_t i=0; i<chunkCount; ++i) {
+    chunks[i].cellX = table->cells[i].x;
+    chunks[i].cellZ = table->cells[i].z;
+  }
+  free(table);
+}
+
+void P64::Scene::updateChunks()
+{
+  if(!chunkCount || !camMain)return;
+
+  const auto &camPos = camMain->getPos();
+  float distLoad2 = chunkLoadDist * chunkLoadDist;
+  float distPrefetch = chunkLoadDist + chunkSize * 0.5f;
+  float distPrefetch2 = distPrefetch * distPrefetch;
+  // unloading further out than loading, so moving along a border doesn't load/unload each frame
+  float distUnload = chunkLoadDist + chunkSize;
+  float distUnload2 = distUnload * distUnload;
+
+  bool instantiated = false;
+  for(uint32_t i=0; i<chunkCount; ++i)
+  {
+    auto &chunk = chunks[i];
+
+    // distance to the cell on the XZ-plane, zero if the camera is inside
+    float minX = chunk.cellX * chunkSize;
+    float minZ = chunk.cellZ * chunkSize;
+    float dx = Math::max(Math::max(minX - camPos.x, camPos.x - (minX + chunkSize)), 0.0f);
+    float dz = Math::max(Math::max(minZ - camPos.z, camPos.z - (minZ + chunkSize)), 0.0f);
+    float dist2 = dx*dx + dz*dz;
+
+    switch(chunk.state)
+    {
+      case Chunk::State::UNLOADED:
+        if(dist2 < distPrefetch2)prefetchChunk(chunk);
+      break;
+
+      case Chunk::State::PREFETCH:
+        if(dist2 > distUnload2) {
+          releaseChunk(chunk);
+        } else if(dist2 < distLoad2 && !instantiated) {
+          instantiateChunk(chunk);
+          instantiated = true;
+        }
+      break;
+
+      case Chunk::State::LOADED:
+        if(dist2 > distUnload2) {
+          for(auto objId : chunk.objectIds) {
+            auto obj = getObjectById(objId);
+            if(obj && chunk.arena.contains(obj))removeObject(*obj);
+          }
+          chunk.state = Chunk::State::UNLOADING;
+          chunk.framesLeft = FrameMatrices::BUFFER_COUNT;
+        }
+      break;
+
+      case Chunk::State::UNLOADING:
+      {
+        // deletion happens during a tick, which may not run every frame with a fixed tick-rate
+        bool deleted = true;
+        for(auto objId : chunk.objectIds) {
+          auto obj = getObjectById(objId);
+          if(obj && chunk.arena.contains(obj)) {
+            deleted = false;
+            break;
+          }
+        }
+        if(!deleted || --chunk.framesLeft != 0)break;
+
+        chunk.arena.destroy();
+        chunk.objectIds.clear();
+        releaseChunk(chunk);
+      }
+      break;
+    }
+  }
+}
+
+void P64::Scene::prefetchChunk(Chunk &chunk)
+{
+  int fileSize = 0;
+  chunk.file = (uint8_t*)loadChunkFile(id, &chunk - chunks, &fileSize);
+  chunk.fileSize = fileSize;
+  auto header = (ChunkHeader*)chunk.file;
+  auto assets = (uint16_t*)(chunk.file + sizeof(ChunkHeader));
+
+  chunk.assets.assign(assets, assets + header->assetCount);
+  for(auto idx : chunk.assets) {
+    ++chunkAssetRefs[idx];
+    AssetManager::prefetch(idx);
+  }
+  chunk.state = Chunk::State::PREFETCH;
+}
+
+void P64::Scene::instantiateChunk(Chunk &chunk)
+{
+  // anything not loaded by the queue yet is loaded now, the objects expect their assets to be there
+  AssetManager::preload(chunk.assets.data(), chunk.assets.size());
+
+  auto header = (ChunkHeader*)chunk.file;
+  uint32_t objCount = header->objectCount;
+  uint32_t offsetObjects = getObjectData(chunk.file) - chunk.file;
+
+  std::vector<Object*> chunkObjects{};
+  chunkObjects.resize(objCount);
+
+  // the file becomes the arena, 'header' is invalid after this
+  loadObjects(chunk.file, chunk.fileSize, offsetObjects, objCount, chunk.arena, chunkObjects.data());
+  chunk.file = nullptr;
+
+  chunk.objectIds.reserve(objCount);
+  for(auto obj : chunkObjects)chunk.objectIds.push_back(obj->id);
+  updateGroups(chunkObjects.data(), chunkObjects.size());
+
+  chunk.state = Chunk::State::LOADED;
+}
+
+void P64::Scene::releaseChunk(Chunk &chunk)
+{
+  for(auto idx : chunk.assets) {
+    auto it = chunkAssetRefs.find(idx);
+    if(it == chunkAssetRefs.end() || --it->second != 0)continue;
+    chunkAssetRefs.erase(it);
+    AssetManager::free(idx);
+  }
+  chunk.assets.clear();
+
+  if(chunk.file) {
+    free(chunk.file);
+    chunk.file = nullptr;
+  }
+  chunk.state = Chunk::State::UNLOADED;
+}
+
+void P64::Scene::freeChunks()
+{
+  // assets are freed together with the rest of the scene, objects must already be deleted
+  for(uint32_t i=0; i<chunkCount; ++i) {
+    if(chunks[i].file)free(chunks[i].file);
+  }
+  delete[] chunks;
+  chunks = nullptr;
+  chunkCount = 0;
+  chunkAssetRefs.clear();
+}
+
+uint32_t P64::Scene::getLoadedChunkCount() const
+{
+  uint32_t count = 0;
+  for(uint32_t i=0; i<chunkCount; ++i) {
+    if(chunks[i].state == Chunk::State::LOADED)++count;
+  }
+  return count;
+}
@@ -3,23 +3,87 @@
 * @license MIT
 */
 #include <libdragon.h>
+#include <algorithm>
+#include <vector>
 
 #include "scene/sceneManager.h"
 
 #include "scene/scene.h"
+#include "lib/types.h"
 #include "script/globalScript.h"
+#include "script/scriptTable.h"
 #include "vi/swapChain.h"
+#include "lib/logger.h"
+#include "debug/hotReload.h"
+#include "debug/inputReplay.h"
+
+namespace P64::SceneManager
+{
+  // generated by the editor, see 'sceneTable.cpp' in the project
+  extern const char* SCENE_NAMES[];
+  extern const uint16_t SCENE_IDS[];
+  extern const uint32_t SCENE_HASH_MASK;
+  extern const uint16_t SCENE_HASH_SLOTS[];
+}
 
 namespace {
   constinit P64::Scene* currScene{nullptr};
   constinit uint32_t sceneId{0};
   constinit uint32_t nextSceneId{0};
+  constinit P64::AssetManager::ProgressFunc fnLoadScreen{nullptr};
+
+  // persistent objects between two scenes, and the assets of all of them loaded so far
+  std::vector<P64::Object*> persistentObjects{};
+  std::vector<uint16_t> persistentAssets{};
+
+  void addPersistentAssets(uint16_t id)
+  {
+    auto *list = P64::Scene::loadAssetList(id, true);
+    persistentAssets.insert(persistentAssets.end(), list + 1, list + 1 + list[0]);
+    free(list);
+    std::sort(persistentAssets.begin(), persistentAssets.end());
+    persistentAssets.erase(std::unique(persistentAssets.begin(), persistentAssets.end()), persistentAssets.end());
+  }
 }
 
 void P64::SceneManager::load(uint16_t newSceneId) {
   nextSceneId = newSceneId;
 }
 
+void P64::SceneManager::preload(uint16_t preloadSceneId, uint32_t memBudget) {
+  if(memBudget != 0) {
+    heap_stats_t heapStats;
+    sys_get_heap_stats(&heapStats);
+    AssetManager::setQueueHeapLimit(heapStats.used + memBudget);
+  }
+
+  auto *assetList = Scene::loadAssetList(preloadSceneId);
+  for(uint32_t i=0; i<assetList[0]; ++i) {
+    AssetManager::prefetch(assetList[i+1]);
+  }
+  free(assetList);
+}
+
+void P64::SceneManager::setLoadScreen(AssetManager::ProgressFunc fn) {
+  fnLoadScreen = fn;
+}
+
+P64::AssetManager::ProgressFunc P64::SceneManager::getLoadScreen() {
+  return fnLoadScreen;
+}
+
+uint16_t P64::SceneManager::getSceneId(const char* name)
+{
+  // open-addressing table, slots store the index into 'SCENE_NAMES' + 1
+  uint32_t slot = crc32(name, strlen(name)) & SCENE_HASH_MASK;
+  while(SCENE_HASH_SLOTS[slot] != 0) {
+    uint32_t idx = SCENE_HASH_SLOTS[slot] - 1;
+    if(strcmp(SCENE_NAMES[idx], name) == 0)return SCENE_IDS[idx];
+    slot = (slot + 1) & SCENE_HASH_MASK;
+  }
+  return 0;
+}
+
 P64::Scene& P64::SceneManager::getCurrent() {
   return *currScene;
 }
@@ -32,19 +96,50 @@ namespace P64::SceneManager
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_PRE_LOAD);
 
     sceneId = nextSceneId;
-    currScene = new P64::Scene(sceneId, &currScene);
+    Script::loadSceneOverlay(sceneId);
+    currScene = new P64::Scene(sceneId, &currScene, &persistentObjects);
+    persistentObjects.clear();
+    if(currScene->getConf().flags & SceneConf::FLAG_PERSISTENT)addPersistentAssets(sceneId);
 
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_POST_LOAD);
 
     while(sceneId == nextSceneId) {
-      currScene->update(VI::SwapChain::getDeltaTime());
+      currScene->update(Debug::InputReplay::getDeltaTime(VI::SwapChain::getDeltaTime()));
+      Log::flush();
+      // same scene ID, so main runs it again and only the changed assets get loaded anew
+      if(Debug::HotReload::poll())break;
     }
   }
 
   void unload()
   {
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_PRE_UNLOAD);
+    // big-tex patches models in place, those can't be handed over to other pipelines
+    bool retainAssets = currScene->getConf().pipeline != SceneConf::Pipeline::BIG_TEX_256;
+    // persistent objects move into the next scene, unless their assets may get freed below
+    if(retainAssets && !Debug::HotReload::hasChangedAssets()) {
+      currScene->releasePersistentObjects(persistentObjects);
+    }
+    if(persistentObjects.empty())persistentAssets.clear();
+
     delete currScene;
+    Script::unloadSceneOverlay();
+    Debug::HotReload::freeChangedAssets();
+
+    // assets used by the next scene stay loaded, so only the difference has to be loaded again
+    if(retainAssets) {
+      auto *keepList = Scene::loadAssetList(nextSceneId);
+      if(persistentAssets.empty()) {
+        AssetManager::freeAll(keepList + 1, keepList[0]);
+      } else {
+        std::vector<uint16_t> keep{keepList + 1, keepList + 1 + keepList[0]};
+        keep.insert(keep.end(), persistentAssets.begin(), persistentAssets.end());
+        AssetManager::freeAll(keep.data(), keep.size());
+      }
+      free(keepList);
+    } else {
+      AssetManager::freeAll();
+    }
     GlobalScript::callHooks(GlobalScript::HookType::SCENE_POST_UNLOAD);
     currScene = nullptr;
   }
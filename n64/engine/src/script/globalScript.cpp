@@ -0,0 +1,24 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "script/globalScript.h"
+
+#include <libdragon.h>
+
+namespace P64::GlobalScript
+{
+  uint32_t hookTicks[(uint32_t)HookType::_size_]{};
+
+  void dispatchHooksTimed(HookType type)
+  {
+    uint32_t t = TICKS_READ();
+    dispatchHooks(type);
+    hookTicks[(uint32_t)type] += TICKS_DISTANCE(t, TICKS_READ());
+  }
+
+  void resetHookTicks()
+  {
+    for(auto &t : hookTicks)t = 0;
+  }
+}
@@ -4,16 +4,12 @@
 */
 #include "script/nodeGraph.h"
 
-#include <unordered_set>
+#include <vector>
 
 #include "scene/object.h"
 #include "scene/scene.h"
 #include "script/scriptTable.h"
-
-namespace
-{
-  std::unordered_map<uint32_t, P64::NodeGraph::UserFunc> userFunctionMap{};
-}
+#include "lib/logger.h"
 
 namespace P64::NodeGraph
 {
@@ -24,6 +20,19 @@ namespace P64::NodeGraph
     uint16_t stackSize;
   };
 
+  /**
+   * Coroutine running graphs in a loop, so it can be reused once a graph returns.
+   * Only idle workers (parked in the loop) are reused, a graph stopped mid-way takes its coroutine with it.
+   */
+  struct Worker
+  {
+    coroutine_t *corot{};
+    GraphFunc func{};
+    Instance *inst{};
+    uint8_t sizeClass{};
+    bool running{};
+  };
+
   void* load(const char* path)
   {
     auto data = asset_load(path, nullptr);
@@ -34,52 +43,152 @@ namespace P64::NodeGraph
   }
 }
 
+namespace
+{
+  using P64::NodeGraph::Worker;
+
+  // stack sizes (bytes) coroutines are rounded up to, larger stacks are allocated exactly and never pooled
+  constexpr uint32_t STACK_CLASSES[] {1024, 2048, 4096, 8192};
+  constexpr uint32_t STACK_CLASS_COUNT = sizeof(STACK_CLASSES) / sizeof(STACK_CLASSES[0]);
+  // idle workers kept per class, anything beyond that is freed
+  constexpr uint32_t MAX_POOLED = 8;
+
+  std::vector<Worker*> workerPool[STACK_CLASS_COUNT]{};
+
+  void workerMain(void* arg)
+  {
+    auto worker = (Worker*)arg;
+    for(;;) {
+      worker->func(worker->inst);
+      worker->running = false;
+      coro_yield();
+    }
+  }
+
+  void destroyWorker(Worker *worker)
+  {
+    coro_destroy(worker->corot);
+    delete worker;
+  }
+
+  Worker* acquireWorker(uint32_t stackSize)
+  {
+    uint32_t sizeClass = 0;
+    while(sizeClass < STACK_CLASS_COUNT && STACK_CLASSES[sizeClass] < stackSize)++sizeClass;
+
+    if(sizeClass < STACK_CLASS_COUNT) {
+      auto &pool = workerPool[sizeClass];
+      if(!pool.empty()) {
+        auto worker = pool.back();
+        pool.pop_back();
+        return worker;
+      }
+      stackSize = STACK_CLASSES[sizeClass];
+    }
+
+    auto worker = new Worker();
+    worker->sizeClass = sizeClass;
+    worker->corot = coro_create(workerMain, worker, stackSize);
+    return worker;
+  }
+
+  void releaseWorker(Worker *worker)
+  {
+    if(worker->running || worker->sizeClass >= STACK_CLASS_COUNT
+      || workerPool[worker->sizeClass].size() >= MAX_POOLED)
+    {
+      destroyWorker(worker);
+      return;
+    }
+    worker->inst = nullptr;
+    workerPool[worker->sizeClass].push_back(worker);
+  }
+}
+
 void P64::NodeGraph::Instance::load(uint16_t assetIdx)
 {
   asset = assetIdx;
   graphDef = (GraphDef*)AssetManager::getByIndex(asset);
-  debugf("Stack-size: %d %d\n", asset, graphDef->stackSize);
-  corot = coro_create(graphDef->func, this, graphDef->stackSize*2);
+  Log::info("Stack-size: %d %d", asset, graphDef->stackSize);
+
+  if(worker) {
+    releaseWorker(worker);
+    worker = nullptr;
+  }
+  if(state) {
+    free(state);
+    state = nullptr;
+  }
+
+  // state machine, runs directly in 'update'
+  if(graphDef->stackSize == 0)return;
+
+  worker = acquireWorker(graphDef->stackSize*2);
+  worker->func = graphDef->func;
+  worker->inst = this;
+  worker->running = true;
 }
 
 P64::NodeGraph::Instance::~Instance()
 {
-  if(corot) {
-    coro_destroy(corot);
-    corot = nullptr;
+  if(worker) {
+    releaseWorker(worker);
+    worker = nullptr;
   }
+  free(state);
 }
 
 bool P64::NodeGraph::Instance::update(float deltaTime) {
-  //debugf("Instance::update: %p\n", corot);
-  if(!corot)return false;
-
-  //auto t = get_ticks();
-  //disable_interrupts();
-  coro_resume(corot);
-  //enable_interrupts();
-  //t = get_ticks() - t;
+  if(!graphDef)return false;
 
-  if(coro_finished(corot))
+  if(graphDef->stackSize == 0)
   {
-    coro_destroy(corot);
-    corot = nullptr;
-    if(repeatable)load(asset);
+    graphDef->func(this);
+    auto base = (StateBase*)state;
+    if(base->step != StateBase::STEP_DONE)return true;
+
+    if(repeatable) {
+      base->step = 0;
+    } else {
+      free(state);
+      state = nullptr;
+      graphDef = nullptr;
+    }
     return false;
   }
-  return true;
+
+  if(!worker)return false;
+
+  coro_resume(worker->corot);
+  if(worker->running)return true;
+
+  // the worker is parked in its loop now, repeating only needs to arm it again
+  if(repeatable) {
+    worker->running = true;
+  } else {
+    releaseWorker(worker);
+    worker = nullptr;
+  }
+  return false;
 }
 
 void P64::NodeGraph::registerFunction(uint32_t strCRC32, UserFunc fn)
 {
-  userFunctionMap[strCRC32] = fn;
+  // functions not called by any graph have no slot, and can't be called anyway
+  auto slot = Script::getUserFuncSlot(strCRC32);
+  if(slot)*slot = fn;
 }
 
 P64::NodeGraph::UserFunc P64::NodeGraph::getFunction(uint64_t uuid)
 {
-  auto it = userFunctionMap.find((uint32_t)uuid);
-  if(it != userFunctionMap.end()) {
-    return it->second;
+  auto slot = Script::getUserFuncSlot((uint32_t)uuid);
+  return slot ? *slot : nullptr;
+}
+
+void P64::NodeGraph::freePool()
+{
+  for(auto &pool : workerPool) {
+    for(auto worker : pool)destroyWorker(worker);
+    pool.clear();
   }
-  return nullptr;
 }
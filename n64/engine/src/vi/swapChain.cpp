@@ -4,17 +4,22 @@
 */
 #include "vi/swapChain.h"
 
+#include <algorithm>
+
 #include "vi.h"
 #include "lib/fifo.h"
 #include "lib/logger.h"
 #include "lib/ringBuffer.h"
 
 namespace {
-  constexpr uint32_t FB_COUNT = 3;
+  constexpr uint32_t FB_COUNT_MAX = P64::VI::SwapChain::MAX_FB_COUNT;
+  // upper limit for 'getFrameTime', e.g. after a long blocking load
+  constexpr float MAX_FRAME_TIME = 0.25f;
   volatile uint8_t fbIdxVI = 0;
+  constinit uint32_t fbCount = FB_COUNT_MAX;
 
-  std::array<uint8_t, FB_COUNT> fbState{}; // current render-pass index
-  P64::Lib::FIFO<uint8_t, 0xFF, FB_COUNT> fbIdxForVI{};
+  std::array<uint8_t, FB_COUNT_MAX> fbState{}; // current render-pass index
+  P64::Lib::FIFO<uint8_t, 0xFF, FB_COUNT_MAX> fbIdxForVI{};
   volatile uint32_t fbFreeCount = 0; // amount of 'fbState' at zero, used for a faster loop
 
   // prevent a new frame from being started, this is done to avoid multiple passes in parallel.
@@ -26,14 +31,34 @@ namespace {
   constinit uint64_t lastTicks{};
   constinit P64::RingBuffer<float, 6> lastDeltaTimes{};
   constinit float avgDeltaTime{};
+  constinit float lastFrameTime{};
   constinit float avgFps{};
   constinit float refreshRate{};
   constinit float refreshRateRound{};
   constinit bool vblankEnabled{false};
 
+  // RDP performance counters (24-bit, counting at the RCP clock of 62.5MHz)
+  constexpr uintptr_t DPC_STATUS_ADDR = 0xA410000C;
+  constexpr uintptr_t DPC_PIPEBUSY_ADDR = 0xA4100018;
+  constexpr uint32_t DPC_WSTATUS_CLR_PIPE_CTR = 1 << 7;
+  constexpr uint32_t DPC_WSTATUS_CLR_CLOCK_CTR = 1 << 9;
+
+  constinit P64::VI::SwapChain::FrameStatsBuffer frameStats{};
+  constinit volatile uint32_t missedVBlanks{0};
+  constinit volatile uint32_t lastRdpBusyUs{0};
+
   P64::VI::SwapChain::RenderPassDrawTask drawTask{nullptr};
   uint32_t frameSkip = 0;
   uint32_t frameIdx = 0;
+  constinit bool lowLatency{false};
+  constinit uint32_t ticksWaited{0}; // since the last 'nextFrame', incl. an early 'waitForFrame'
+
+  bool canStartFrame()
+  {
+    if(!fbFreeCount || blockNewFrame)return false;
+    // in low-latency mode the new frame must be the only one the VI hasn't taken yet
+    return !lowLatency || fbIdxForVI.count == 0;
+  }
 
   void onVIFrameReady([[maybe_unused]] void *userData)
   {
@@ -41,7 +66,9 @@ namespace {
     disable_interrupts();
     auto nextFbIdx = fbIdxForVI.pop();
 
-    if(nextFbIdx != 0xFF) {
+    if(nextFbIdx == 0xFF) {
+      ++missedVBlanks;
+    } else {
       vi_write_begin();
         vi_show(&frameBuffers[nextFbIdx]);
       vi_write_end();
@@ -62,30 +89,44 @@ namespace {
    */
   void renderPassDone(uint32_t fbIndex)
   {
+    lastRdpBusyUs = (*(volatile uint32_t*)DPC_PIPEBUSY_ADDR & 0xFF'FFFF) * 2 / 125;
+
     disable_interrupts();
     ++fbState[fbIndex];
     fbIdxForVI.push(fbIndex);
     blockNewFrame = false;
     enable_interrupts();
   }
+
+  void resetState()
+  {
+    disable_interrupts();
+    blockNewFrame = false;
+
+    // same state as after a 'drain()': the VI shows the last buffer, all others are free.
+    // unused slots (double-buffering) stay blocked
+    fbState.fill({0xFF-1});
+    for(uint32_t i=0; i<fbCount-1; ++i)fbState[i] = 0;
+    fbFreeCount = fbCount - 1;
+    fbIdxVI = fbCount-1;
+    fbIdxForVI = {};
+    fbIdxForVI.fill(0xFF);
+
+    missedVBlanks = 0;
+    enable_interrupts();
+  }
 }
 
 void P64::VI::SwapChain::init()
 {
   frameBuffers = nullptr;
-  blockNewFrame = false;
-
-  fbState.fill({0xFF-1}); // block all buffers...
-  fbState[1] = 0; // ...except second, picked up by first render-pass
-  fbFreeCount = 1;
-  // to get started, pretend the VI already has 1 frame rendering
-  // this will start the logic of VI chasing finished buffers + freeing drawn ones
-  fbIdxVI = FB_COUNT-1;
-  fbIdxForVI.fill(0xFF); // clear FIFO...
-  fbIdxForVI.push(0); // ...and make VI render the first buffer
+  fbCount = FB_COUNT_MAX;
+  resetState();
+  frameStats.fill({});
 
   lastTicks = get_ticks() - TICKS_FROM_MS(16);
   avgDeltaTime = 1.0f / 60.0f;
+  lastFrameTime = avgDeltaTime;
   lastDeltaTimes.fill(avgDeltaTime);
 
   refreshRate = calcRefreshRate();
@@ -111,22 +152,44 @@ float P64::VI::SwapChain::getDeltaTime()
   return avgDeltaTime;
 }
 
+float P64::VI::SwapChain::getFrameTime()
+{
+  return lastFrameTime;
+}
+
 float P64::VI::SwapChain::getFPS()
 {
   return avgFps;
 }
 
-void P64::VI::SwapChain::nextFrame() {
+float P64::VI::SwapChain::getFrameBudget()
+{
+  return (float)(frameSkip + 1) / refreshRate;
+}
+
+void P64::VI::SwapChain::waitForFrame() {
+  uint32_t ticksStart = TICKS_READ();
   for (uint32_t __t = TICKS_READ() + TICKS_FROM_MS(200);; __rsp_check_assert(__FILE__, __LINE__, __func__))
   {
-    if(fbFreeCount && !blockNewFrame)break;
+    if(canStartFrame())break;
     if(!TICKS_BEFORE(TICKS_READ(), __t)) {
       //rsp_crashf("wait loop timed out (%d ms)", 200);
-      Log::error("RSP time-out, force new buffer");
+      Log::error("No free buffer after 200ms (free: %lu, pass running: %d), forcing a new one",
+        fbFreeCount, blockNewFrame
+      );
       fbFreeCount = 1;
       blockNewFrame = false;
+      break;
     }
   }
+  ticksWaited += TICKS_DISTANCE(ticksStart, TICKS_READ());
+}
+
+void P64::VI::SwapChain::nextFrame() {
+  // NOP if already waited for before the update, nothing can block a new frame in between
+  waitForFrame();
+  uint32_t ticksWait = ticksWaited;
+  ticksWaited = 0;
 
   uint32_t freeIdx = 0;
   while(fbState[freeIdx])++freeIdx;
@@ -135,6 +198,7 @@ void P64::VI::SwapChain::nextFrame() {
   uint64_t ticksDiff = newTicks - lastTicks;
 
   float newDelta = (float)((double)TICKS_TO_US(ticksDiff) * (1.0/1e6));
+  lastFrameTime = fminf(newDelta, MAX_FRAME_TIME);
   if(newDelta > (1.0f / 20.0f)) { // @TODO: somtimes this gets huge values in the thousands
     //debugf("DELTA-TIME: %.4f (%lld - %lld)\n", newDelta, lastTicks, newTicks);
     Log::warn("invalid delta time!");
@@ -149,18 +213,29 @@ void P64::VI::SwapChain::nextFrame() {
   avgFps = fminf(avgFps, refreshRateRound);
 
   disable_interrupts();
+  frameStats.push({
+    .cpuWaitUs = (uint16_t)std::min<uint32_t>(TICKS_TO_US(ticksWait), 0xFFFF),
+    .rdpBusyUs = (uint16_t)std::min<uint32_t>(lastRdpBusyUs, 0xFFFF),
+    .missedVBlanks = (uint8_t)std::min<uint32_t>(missedVBlanks, 0xFF),
+  });
+  missedVBlanks = 0;
+
   fbFreeCount -= 1;
   blockNewFrame = true;
   enable_interrupts();
 
+  // no other pass can run now, so the counter only covers the one started below
+  *(volatile uint32_t*)DPC_STATUS_ADDR = DPC_WSTATUS_CLR_PIPE_CTR | DPC_WSTATUS_CLR_CLOCK_CTR;
+
   drawTask(&frameBuffers[freeIdx], freeIdx, renderPassDone);
+  if(lowLatency)rspq_flush();
 }
 
 void P64::VI::SwapChain::drain() {
   rspq_wait();
   RSP_WAIT_LOOP(200) {
     // if only one buffer is not free (must be VI), we are done
-    if(fbFreeCount == (FB_COUNT - 1))break;
+    if(fbFreeCount == (fbCount - 1))break;
   }
   blockNewFrame = false;
 }
@@ -169,6 +244,10 @@ void P64::VI::SwapChain::setFrameSkip(uint32_t skip) {
   frameSkip = skip;
 }
 
+void P64::VI::SwapChain::setLowLatency(bool enabled) {
+  lowLatency = enabled;
+}
+
 void P64::VI::SwapChain::setDrawPass(SwapChain::RenderPassDrawTask task) {
   drawTask = task;
 }
@@ -184,8 +263,19 @@ void P64::VI::SwapChain::start() {
   vi_write_end();
 }
 
-void P64::VI::SwapChain::setFrameBuffers(surface_t buffers[3]) {
+void P64::VI::SwapChain::setFrameBuffers(surface_t *buffers, uint32_t count) {
+  assertf(count >= 2 && count <= FB_COUNT_MAX, "Invalid frame-buffer count: %lu", count);
   frameBuffers = buffers;
+  fbCount = count;
+  resetState();
+}
+
+uint32_t P64::VI::SwapChain::getFrameBufferCount() {
+  return fbCount;
+}
+
+const P64::VI::SwapChain::FrameStatsBuffer &P64::VI::SwapChain::getFrameStats() {
+  return frameStats;
 }
 
 surface_t *P64::VI::SwapChain::getFrameBuffer(uint32_t idx) {
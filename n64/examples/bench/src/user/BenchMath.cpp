@@ -0,0 +1,113 @@
+#include "script/userScript.h"
+#include "lib/math.h"
+#include "benchMetrics.h"
+
+namespace
+{
+  constexpr uint32_t POINT_COUNT = 32;
+
+  // keeps the compiler from dropping the loops
+  volatile float sink;
+
+  double ticksToMs(uint64_t ticks) {
+    return (double)TICKS_TO_US(ticks) / 1000.0;
+  }
+}
+
+/**
+ * Micro-benchmark of the math kernels in 'lib/math.h' against the generic 'fm_' routines.
+ * Each frame transforms points into / out of a local space and tests boxes against them,
+ * the same work as the collision does per mesh and sub-step.
+ */
+namespace P64::Script::CBE7C40000000004
+{
+  P64_DATA(
+    [[P64::Name("Iterations")]]
+    uint32_t iterations;
+
+    fm_vec3_t points[POINT_COUNT];
+    fm_vec3_t boxMin[POINT_COUNT];
+    fm_vec3_t boxMax[POINT_COUNT];
+    fm_vec3_t res[POINT_COUNT];
+    float angle;
+  );
+
+  void initDelete(Object&, Data *data, bool isDelete)
+  {
+    if(isDelete)return;
+    for(uint32_t i=0; i<POINT_COUNT; ++i) {
+      data->points[i] = Math::randDir3D() * (Math::rand01() * 200.0f);
+      auto extend = fm_vec3_t{10.0f, 10.0f, 10.0f} + Math::randDir3D() * 5.0f;
+      data->boxMin[i] = data->points[i] - extend;
+      data->boxMax[i] = data->points[i] + extend;
+    }
+  }
+
+  void update(Object&, Data *data, float deltaTime)
+  {
+    // new rotation each frame, so neither path can cache anything
+    data->angle += deltaTime;
+    fm_quat_t rot;
+    fm_vec3_t axis{0.3f, 0.9f, 0.1f};
+    fm_vec3_norm(&axis, &axis);
+    fm_quat_from_axis_angle(&rot, &axis, data->angle);
+
+    const fm_vec3_t pos{12.0f, -4.0f, 30.0f};
+    const fm_vec3_t scale{1.5f, 1.0f, 0.5f};
+    const fm_vec3_t invScale{1.0f / scale.x, 1.0f / scale.y, 1.0f / scale.z};
+    float acc = 0.0f;
+
+    // generic: fm_quat_inverse + quaternion operator per point
+    uint64_t ticks = get_ticks();
+    for(uint32_t it=0; it<data->iterations; ++it) {
+      fm_quat_t invRot;
+      fm_quat_inverse(&invRot, &rot);
+      for(uint32_t i=0; i<POINT_COUNT; ++i) {
+        auto local = invRot * (data->points[i] - pos) * invScale;
+        data->res[i] = rot * (local * scale) + pos;
+      }
+      acc += data->res[it % POINT_COUNT].x;
+    }
+    uint64_t ticksGeneric = get_ticks() - ticks;
+
+    ticks = get_ticks();
+    for(uint32_t it=0; it<data->iterations; ++it) {
+      auto invRot = Math::quatInvUnit(rot);
+      Math::intoLocalSpace(invRot, invScale, pos, data->points, data->res, POINT_COUNT);
+      Math::outOfLocalSpace(rot, scale, pos, data->res, data->res, POINT_COUNT);
+      acc += data->res[it % POINT_COUNT].x;
+    }
+    uint64_t ticksKernel = get_ticks() - ticks;
+
+    ticks = get_ticks();
+    for(uint32_t it=0; it<data->iterations; ++it) {
+      const auto &p = data->points[it % POINT_COUNT];
+      for(uint32_t i=0; i<POINT_COUNT; ++i) {
+        const auto &bMin = data->boxMin[i];
+        const auto &bMax = data->boxMax[i];
+        acc += (p.x >= bMin.x && p.x <= bMax.x && p.y >= bMin.y && p.y <= bMax.y && p.z >= bMin.z && p.z <= bMax.z) ? 1.0f : 0.0f;
+        fm_vec3_t closest{
+          fmaxf(bMin.x, fminf(p.x, bMax.x)),
+          fmaxf(bMin.y, fminf(p.y, bMax.y)),
+          fmaxf(bMin.z, fminf(p.z, bMax.z))
+        };
+        acc += fm_vec3_distance2(&closest, &p) <= 100.0f ? 1.0f : 0.0f;
+      }
+    }
+    uint64_t ticksTestGeneric = get_ticks() - ticks;
+
+    ticks = get_ticks();
+    for(uint32_t it=0; it<data->iterations; ++it) {
+      const auto &p = data->points[it % POINT_COUNT];
+      acc += (float)__builtin_popcount(Math::aabbOverlapMask(p, p, data->boxMin, data->boxMax, POINT_COUNT));
+      acc += (float)__builtin_popcount(Math::sphereVsAABBMask(p, 10.0f, data->boxMin, data->boxMax, POINT_COUNT));
+    }
+    uint64_t ticksTestKernel = get_ticks() - ticks;
+
+    sink = acc;
+    Bench::setMetric(0, "xformGeneric", ticksToMs(ticksGeneric));
+    Bench::setMetric(1, "xformKernel", ticksToMs(ticksKernel));
+    Bench::setMetric(2, "testGeneric", ticksToMs(ticksTestGeneric));
+    Bench::setMetric(3, "testKernel", ticksToMs(ticksTestKernel));
+  }
+}
@@ -0,0 +1,36 @@
+#include "script/userScript.h"
+
+namespace P64::Script::CBE7C40000000003
+{
+  P64_DATA(
+    [[P64::Name("Radius")]]
+    float radius;
+    [[P64::Name("Speed")]]
+    float speed;
+
+    fm_vec3_t center;
+    float angle;
+  );
+
+  void initDelete(Object& obj, Data *data, bool isDelete)
+  {
+    if(isDelete)return;
+    data->center = obj.pos;
+    // different phase per object, so neighbors keep running into each other
+    data->angle = (float)obj.id * 0.7f;
+  }
+
+  // circles around the spawn point, collisions push the objects apart
+  void update(Object& obj, Data *data, float deltaTime)
+  {
+    data->angle += data->speed * deltaTime;
+    if(data->angle > T3D_PI * 2.0f)data->angle -= T3D_PI * 2.0f;
+
+    fm_vec3_t target = data->center + fm_vec3_t{
+      fm_cosf(data->angle) * data->radius,
+      0.0f,
+      fm_sinf(data->angle) * data->radius
+    };
+    obj.pos = obj.pos + (target - obj.pos) * fminf(deltaTime * 4.0f, 1.0f);
+  }
+}
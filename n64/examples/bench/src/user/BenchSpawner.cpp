@@ -0,0 +1,46 @@
+#include "script/userScript.h"
+#include "../p64/assetTable.h"
+
+namespace
+{
+  // indexed by 'type'
+  constexpr uint32_t PREFAB_COUNT = 3;
+}
+
+namespace P64::Script::CBE7C40000000002
+{
+  P64_DATA(
+    // 0: static model, 1: animated model, 2: moving collider
+    [[P64::Name("Type")]]
+    uint32_t type;
+    [[P64::Name("Count")]]
+    uint32_t count;
+    [[P64::Name("Spacing")]]
+    float spacing;
+  );
+
+  void initDelete(Object& obj, Data *data, bool isDelete)
+  {
+    if(isDelete)return;
+
+    const uint32_t prefabs[PREFAB_COUNT] {
+      "BenchStatic.pf"_asset,
+      "BenchAnim.pf"_asset,
+      "BenchBody.pf"_asset,
+    };
+    uint32_t prefab = prefabs[data->type % PREFAB_COUNT];
+
+    // square grid centered on the spawner
+    uint32_t side = (uint32_t)ceilf(sqrtf((float)data->count));
+    float offset = (float)(side - 1) * data->spacing * 0.5f;
+    for(uint32_t i=0; i<data->count; ++i)
+    {
+      fm_vec3_t pos = obj.pos + fm_vec3_t{
+        (float)(i % side) * data->spacing - offset,
+        0.0f,
+        (float)(i / side) * data->spacing - offset
+      };
+      obj.getScene().addObject(prefab, pos);
+    }
+  }
+}
@@ -0,0 +1,30 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+
+/**
+ * Optional metrics set by scripts of the current scene,
+ * appended to the per-frame output of 'benchRunner.cpp' and cleared on every scene load.
+ */
+namespace Bench
+{
+  constexpr uint32_t MAX_METRICS = 8;
+
+  struct Metric
+  {
+    const char* name;
+    double value;
+  };
+
+  inline Metric metrics[MAX_METRICS]{};
+  inline uint32_t metricCount{0};
+
+  inline void setMetric(uint32_t idx, const char* name, double value) {
+    if(idx >= MAX_METRICS)return;
+    metrics[idx] = {name, value};
+    if(idx >= metricCount)metricCount = idx + 1;
+  }
+}
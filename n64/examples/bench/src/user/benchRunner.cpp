@@ -0,0 +1,92 @@
+#include "script/globalScript.h"
+#include "script/userScript.h"
+#include "scene/sceneManager.h"
+#include "audio/audioManager.h"
+#include "lib/memory.h"
+#include "renderer/drawLayer.h"
+#include "benchMetrics.h"
+
+#include <libdragon.h>
+#include <vi/swapChain.h>
+
+#ifndef BENCH_FRAMES
+  #define BENCH_FRAMES 300
+#endif
+
+/**
+ * Runs all benchmark scenes one after another and prints the metrics of each frame to the debug log.
+ * The format is read by 'pyrite64 --cli --cmd bench' (see 'src/build/benchmark.cpp'):
+ *   [P64-BENCH] {"scene":1,"update":1.234,...}  one per recorded frame, times in ms
+ *   [P64-BENCH-END]                             after the last scene
+ */
+namespace
+{
+  // skipped after a scene load, so spawning and loading don't end up in the numbers
+  constexpr uint32_t WARMUP_FRAMES = 30;
+  // run in this order, the first one must be the boot scene
+  constexpr uint16_t SCENES[] {1, 2, 3, 4, 5, 6};
+  constexpr uint32_t SCENE_COUNT = sizeof(SCENES) / sizeof(SCENES[0]);
+
+  uint32_t sceneIdx = 0;
+  uint32_t frame = 0;
+
+  double ticksToMs(uint64_t ticks) {
+    return (double)TICKS_TO_US(ticks) / 1000.0;
+  }
+}
+
+namespace P64::GlobalScript::CBE7C40000000001
+{
+  void onScenePostLoad()
+  {
+    frame = 0;
+    Bench::metricCount = 0;
+  }
+
+  void onSceneUpdate()
+  {
+    if(sceneIdx >= SCENE_COUNT)return;
+    if(++frame <= WARMUP_FRAMES + BENCH_FRAMES)return;
+
+    if(++sceneIdx < SCENE_COUNT) {
+      SceneManager::load(SCENES[sceneIdx]);
+    } else {
+      debugf("[P64-BENCH-END]\n");
+    }
+  }
+
+  void onScenePreDraw()
+  {
+    if(sceneIdx >= SCENE_COUNT || frame <= WARMUP_FRAMES || frame > WARMUP_FRAMES + BENCH_FRAMES)return;
+
+    // update metrics are from this frame, draw metrics (incl. post-processing) from the last one
+    auto &scene = SceneManager::getCurrent();
+    auto &coll = scene.getCollision();
+    const auto &stats = VI::SwapChain::getFrameStats();
+    const auto &lastStats = stats[stats.size()-1];
+
+    debugf("[P64-BENCH] {\"scene\":%d,\"fps\":%.2f,\"update\":%.3f,\"global\":%.3f,\"coll\":%.3f,\"audio\":%.3f,"
+      "\"draw\":%.3f,\"drawGlobal\":%.3f,\"rdpBusy\":%.3f,\"cpuWait\":%.3f,\"heapKB\":%lu,\"objects\":%lu",
+      scene.getId(),
+      (double)VI::SwapChain::getFPS(),
+      ticksToMs(scene.ticksActorUpdate),
+      ticksToMs(scene.ticksGlobalUpdate),
+      ticksToMs(coll.ticks),
+      ticksToMs(AudioManager::ticksUpdate),
+      ticksToMs(scene.ticksDraw),
+      ticksToMs(scene.ticksGlobalDraw),
+      (double)lastStats.rdpBusyUs / 1000.0,
+      (double)lastStats.cpuWaitUs / 1000.0,
+      Mem::getHeapUsed() / 1024,
+      scene.getObjectCount()
+    );
+    // command words per draw layer, the build sizes layer buffers from the peaks (see 'layerPeaks.json')
+    for(uint32_t l=1; l<=DrawLayer::getBufferedCount(); ++l) {
+      debugf(",\"layerWords%lu\":%lu", l, DrawLayer::getStats(l).words);
+    }
+    for(uint32_t i=0; i<Bench::metricCount; ++i) {
+      debugf(",\"%s\":%.3f", Bench::metrics[i].name, Bench::metrics[i].value);
+    }
+    debugf("}\n");
+  }
+}
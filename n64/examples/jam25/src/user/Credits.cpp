@@ -3,6 +3,7 @@
 #include "../p64/assetTable.h"
 #include "systems/fonts.h"
 #include "systems/screenFade.h"
+#include "renderer/textCache.h"
 
 namespace
 {
@@ -36,6 +37,17 @@ namespace
   constexpr color_t COL_DEF = {0xFF, 0xFF, 0xFF, 0xFF};
   constexpr color_t COL_SUB = {0xAA, 0xAA, 0xAA, 0xFF};
 
+  // the text never changes, only the scroll position, so each print keeps its layout.
+  // prints happen in the same order every frame, which maps them to the same cache slot
+  constinit P64::TextCache textCache[24]{};
+  constinit uint32_t textCacheIdx{0};
+
+  void print(const rdpq_textparms_t *parms, uint8_t font, float x, float y, const char *txt)
+  {
+    assert(textCacheIdx < sizeof(textCache) / sizeof(textCache[0]));
+    textCache[textCacheIdx++].print(parms, font, x, y, txt);
+  }
+
   inline void setColor(uint8_t font, color_t col)
   {
     const rdpq_fontstyle_t style{.color = col};
@@ -45,16 +57,16 @@ namespace
   void titleBlock(float &posY, const char* txt)
   {
     posY += 12;
-    rdpq_text_print(&TEXT_PARAMS, P64::User::FONT_TITLE, 0, posY, txt);
+    print(&TEXT_PARAMS, P64::User::FONT_TITLE, 0, posY, txt);
     posY += 32;
   }
 
   void splitTextBlock(float &posY, const char* txtLeft, const char* txtRight)
   {
     setColor(P64::User::FONT_SMALL, COL_SUB);
-    rdpq_text_print(&TXTP_DESC, P64::User::FONT_SMALL, -spaceMid, posY, txtLeft);
+    print(&TXTP_DESC, P64::User::FONT_SMALL, -spaceMid, posY, txtLeft);
     setColor(P64::User::FONT_SMALL, COL_DEF);
-    rdpq_text_print(&TXTP_NAME, P64::User::FONT_SMALL, centerX+spaceMid, posY, txtRight);
+    print(&TXTP_NAME, P64::User::FONT_SMALL, centerX+spaceMid, posY, txtRight);
     posY += 36;
   }
 
@@ -64,7 +76,7 @@ namespace
     rdpq_sprite_blit(tex, centerX - (tex->width / 2.0f) + offsetX, posY, nullptr);
 
     posY += tex->height + 8;
-    rdpq_text_print(&TEXT_PARAMS, P64::User::FONT_SMALL, 0, posY, subText);
+    print(&TEXT_PARAMS, P64::User::FONT_SMALL, 0, posY, subText);
     posY += 40;
   }
 
@@ -97,6 +109,7 @@ namespace P64::Script::C10BED11E4F936F7
     {
       rspq_call_deferred((void(*)(void*))rspq_block_free, data->dplBgTex);
       texTitle = nullptr;
+      for(auto &cache : textCache)cache.clear();
       return;
     }
 
@@ -168,6 +181,7 @@ namespace P64::Script::C10BED11E4F936F7
   {
     float baseY = obj.pos.y;
     baseY = roundf(baseY);
+    textCacheIdx = 0;
 
     DrawLayer::use2D();
 
@@ -204,11 +218,11 @@ namespace P64::Script::C10BED11E4F936F7
     //rdpq_font_style(const_cast<rdpq_font_t*>(rdpq_text_get_font(User::FONT_TITLE)), 0, &style);
 
     setColor(User::FONT_SMALL, COL_SUB);
-    rdpq_text_print(&TEXT_PARAMS, User::FONT_SMALL, 0, baseY, "Made for the");
+    print(&TEXT_PARAMS, User::FONT_SMALL, 0, baseY, "Made for the");
     setColor(User::FONT_SMALL, COL_DEF);
 
     baseY += 10;
-    rdpq_text_print(&TEXT_PARAMS, User::FONT_TITLE, 0, baseY, "N64Brew Game Jam 2025");
+    print(&TEXT_PARAMS, User::FONT_TITLE, 0, baseY, "N64Brew Game Jam 2025");
     baseY += 50;
 
     titleBlock(baseY, "- Developer -");
@@ -228,7 +242,7 @@ namespace P64::Script::C10BED11E4F936F7
 
     titleBlock(baseY, "Special Thanks");
 
-    rdpq_text_print(&TEXT_PARAMS, User::FONT_SMALL, 0, baseY,
+    print(&TEXT_PARAMS, User::FONT_SMALL, 0, baseY,
       "To the N64Brew server,\n"
       "blender, and the fast64 project"
     );
@@ -237,7 +251,7 @@ namespace P64::Script::C10BED11E4F936F7
     baseY += 96;
 
     setColor(User::FONT_TITLE, rainbowCol);
-    rdpq_text_print(&TEXT_PARAMS, User::FONT_TITLE, 0, baseY, "Thank you for playing!");
+    print(&TEXT_PARAMS, User::FONT_TITLE, 0, baseY, "Thank you for playing!");
     setColor(User::FONT_TITLE, COL_DEF);
 
     if(data->state == 1 && (baseY+10) < centerY)
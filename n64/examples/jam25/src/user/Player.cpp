@@ -9,7 +9,6 @@
 #include "scene/components/animModel.h"
 #include "systems/dropShadows.h"
 #include "systems/sprites.h"
-#include "collision/attach.h"
 #include "systems/dialog.h"
 #include "../p64/assetTable.h"
 
@@ -77,7 +76,6 @@ namespace P64::Script::C17EA8EAB6CF1DEB
     float targetAnimBlend;
 
     Coll::RaycastRes floorCast;
-    Coll::Attach meshAttach;
     Comp::AnimModel *anim;
     uint8_t isJumpEnd;
     uint8_t isMidJump;
@@ -108,6 +106,7 @@ namespace P64::Script::C17EA8EAB6CF1DEB
       data->anim = obj.getComponent<Comp::AnimModel>();
       data->anim->setMainAnim(1);
       data->anim->setBlendAnim(0);
+      data->anim->setLayerWeight(0, 0.5f);
     }
 
     auto &bcs = coll->bcs;
@@ -273,9 +272,6 @@ namespace P64::Script::C17EA8EAB6CF1DEB
     auto &cam = SceneManager::getCurrent().getActiveCamera();
     cam.setLookAt(camPos, data->camTarget);
 
-    // collider attachment
-    bcs.center -= data->meshAttach.update(bcs.center);
-
     // player physics
     bcs.velocity.x *= MOVE_SPEED_SLOWDOWN;
     bcs.velocity.z *= MOVE_SPEED_SLOWDOWN;
@@ -345,7 +341,7 @@ namespace P64::Script::C17EA8EAB6CF1DEB
 
     float blendSpeed = data->targetAnimBlend > 0.5f ? 0.3f : 0.09f;
     blendSpeed *= deltaTime * 60.0f;
-    data->anim->blendFactor = t3d_lerp(data->anim->blendFactor, data->targetAnimBlend, blendSpeed);
+    data->anim->setLayerWeight(0, t3d_lerp(data->anim->getLayerWeight(0), data->targetAnimBlend, blendSpeed));
 
     // kick back from hurting
     bcs.velocity += data->hurtVelocity;
@@ -430,7 +426,8 @@ namespace P64::Script::C17EA8EAB6CF1DEB
   {
     if(event.otherMesh)
     {
-      data->meshAttach.setReference(event.otherMesh);
+      // moves the player along with the mesh in the next collision update
+      obj.getScene().getCollision().attachToMesh(*event.selfBCS, event.otherMesh);
       return;
     }
 
@@ -5,6 +5,7 @@
 #include "dialog.h"
 #include <assets/assetManager.h>
 #include <vi/swapChain.h>
+#include <renderer/textCache.h>
 
 #include "../../p64/assetTable.h"
 #include "../globals.h"
@@ -30,6 +31,11 @@ namespace
   constinit float blinkTimer = 0;
   constinit bool slowMode = false;
 
+  // text only changes when the next character gets revealed
+  constinit P64::TextCache textMsg{};
+  constinit P64::TextCache textYes{};
+  constinit P64::TextCache textNo{};
+
   struct DialogMsg
   {
     std::string text{};
@@ -99,6 +105,9 @@ namespace P64::User::Dialog
   void destroy()
   {
     rspq_block_free(dplBox);
+    textMsg.clear();
+    textYes.clear();
+    textNo.clear();
     dplBox = nullptr;
     texBox = nullptr;
   }
@@ -203,7 +212,7 @@ namespace P64::User::Dialog
 
     rdpq_fontstyle_t style{.color =  {0xFF, 0xFF, 0xFF, 0xFF}};
     rdpq_font_style(const_cast<rdpq_font_t*>(rdpq_text_get_font(FONT_TEXT)), 0, &style);
-    rdpq_text_printf(&TEXT_CENTER, FONT_TEXT, textPosX, posY+18, currMsg.text.data());
+    textMsg.print(&TEXT_CENTER, FONT_TEXT, textPosX, posY+18, currMsg.text.data());
 
     if(currMsg.isModal && currMsg.isReady())
     {
@@ -215,9 +224,9 @@ namespace P64::User::Dialog
       rdpq_fontstyle_t optStyleNormal{.color =  {0x80, 0x80, 0x80, 0xFF}};
       rdpq_fontstyle_t optStyleSelected{.color =  {0xCC, 0xCC, 0xFF, alpha}};
       rdpq_font_style(const_cast<rdpq_font_t*>(rdpq_text_get_font(FONT_TEXT)), 0, selOption == 0 ? &optStyleSelected : &optStyleNormal);
-      rdpq_text_printf(&TEXT_CENTER, FONT_TEXT, textPosX + 50, posY + bxHeight - 8, currMsg.optionYes.c_str());
+      textYes.print(&TEXT_CENTER, FONT_TEXT, textPosX + 50, posY + bxHeight - 8, currMsg.optionYes.c_str());
       rdpq_font_style(const_cast<rdpq_font_t*>(rdpq_text_get_font(FONT_TEXT)), 0, selOption == 1 ? &optStyleSelected : &optStyleNormal);
-      rdpq_text_printf(&TEXT_CENTER, FONT_TEXT, textPosX + 90, posY + bxHeight - 8, currMsg.optionNo.c_str());
+      textNo.print(&TEXT_CENTER, FONT_TEXT, textPosX + 90, posY + bxHeight - 8, currMsg.optionNo.c_str());
     } else {
       blinkTimer = 0;
     }
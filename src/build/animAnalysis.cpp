@@ -0,0 +1,188 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "tiny3d/tools/gltf_importer/src/lib/cgltf.h"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace
+{
+  // rates tried from the highest, the first one is the reference the others are compared against
+  constexpr uint32_t SAMPLE_RATES[] = {60, 30, 20, 15, 12, 10};
+
+  // translations are stored as 16-bit units, anything below that is lost anyway
+  constexpr float MAX_ERR_POS = 0.5f;
+  constexpr float MAX_ERR_SCALE = 0.005f;
+
+  // rough size of one sample in the keyframe stream (time + channel header + value)
+  constexpr uint32_t KEY_BYTES_ROT = 8;
+  constexpr uint32_t KEY_BYTES_VEC3 = 3 * 6;
+
+  struct Channel
+  {
+    std::vector<float> times{};
+    std::vector<glm::vec4> values{};
+    bool isRot{false};
+    bool isScale{false};
+    bool step{false};
+
+    [[nodiscard]] glm::vec4 eval(float t) const
+    {
+      if(t <= times.front())return values.front();
+      if(t >= times.back())return values.back();
+
+      auto it = std::upper_bound(times.begin(), times.end(), t);
+      auto idx = (uint32_t)(it - times.begin());
+      const auto &a = values[idx - 1];
+      if(step)return a;
+
+      // cubic-splines are approximated as linear, the tangents rarely matter at these rates
+      float f = (t - times[idx - 1]) / (times[idx] - times[idx - 1]);
+      return lerp(a, values[idx], f);
+    }
+
+    [[nodiscard]] glm::vec4 lerp(const glm::vec4 &a, glm::vec4 b, float f) const
+    {
+      if(!isRot)return a + (b - a) * f;
+      if(glm::dot(a, b) < 0.0f)b = -b;
+      return glm::normalize(a + (b - a) * f);
+    }
+  };
+
+  struct ChannelError
+  {
+    float rot{};
+    float pos{};
+    float scale{};
+  };
+
+  /**
+   * Resamples a channel at 'rate' and compares the in-between frames of the reference rate against it.
+   * This is what playback does, it only ever interpolates linearly between two samples.
+   */
+  ChannelError measureError(const Channel &ch, float duration, uint32_t rate, float baseScale)
+  {
+    ChannelError err{};
+    uint32_t refFrames = (uint32_t)std::ceil(duration * SAMPLE_RATES[0]);
+    for(uint32_t f=0; f<=refFrames; ++f)
+    {
+      float t = std::min((float)f / SAMPLE_RATES[0], duration);
+      float pos = t * rate;
+      float tA = std::floor(pos) / rate;
+      float tB = std::min(tA + 1.0f / rate, duration);
+
+      auto ref = ch.eval(t);
+      auto res = tB > tA ? ch.lerp(ch.eval(tA), ch.eval(tB), (t - tA) / (tB - tA)) : ch.eval(tA);
+
+      if(ch.isRot) {
+        float d = std::min(1.0f, std::abs(glm::dot(glm::normalize(ref), glm::normalize(res))));
+        err.rot = std::max(err.rot, glm::degrees(2.0f * std::acos(d)));
+      } else if(ch.isScale) {
+        auto d = glm::abs(glm::vec3{ref - res});
+        err.scale = std::max(err.scale, std::max(d.x, std::max(d.y, d.z)));
+      } else {
+        err.pos = std::max(err.pos, glm::length(glm::vec3{ref - res}) * baseScale);
+      }
+    }
+    return err;
+  }
+
+  uint32_t estimateBytes(const Channel &ch, float duration, uint32_t rate)
+  {
+    uint32_t samples = (uint32_t)std::ceil(duration * rate) + 1;
+    return samples * (ch.isRot ? KEY_BYTES_ROT : KEY_BYTES_VEC3);
+  }
+
+  bool readChannel(const cgltf_animation_channel &src, Channel &ch)
+  {
+    auto type = src.target_path;
+    if(type != cgltf_animation_path_type_rotation
+      && type != cgltf_animation_path_type_translation
+      && type != cgltf_animation_path_type_scale
+    )return false;
+
+    const auto* sampler = src.sampler;
+    if(!sampler || !sampler->input || !sampler->output || sampler->input->count == 0)return false;
+
+    ch.isRot = type == cgltf_animation_path_type_rotation;
+    ch.isScale = type == cgltf_animation_path_type_scale;
+    ch.step = sampler->interpolation == cgltf_interpolation_type_step;
+    bool cubic = sampler->interpolation == cgltf_interpolation_type_cubic_spline;
+
+    uint32_t count = sampler->input->count;
+    uint32_t comps = ch.isRot ? 4 : 3;
+    ch.times.resize(count);
+    ch.values.resize(count);
+    for(uint32_t i=0; i<count; ++i) {
+      cgltf_accessor_read_float(sampler->input, i, &ch.times[i], 1);
+      // splines store (in-tangent, value, out-tangent) per key
+      cgltf_accessor_read_float(sampler->output, cubic ? (i*3 + 1) : i, &ch.values[i].x, comps);
+    }
+    return true;
+  }
+}
+
+Build::AnimStats Build::analyzeAnimations(const std::string &gltfPath, float baseScale, float maxErrDeg)
+{
+  AnimStats stats{};
+  stats.sampleRate = SAMPLE_RATES[0];
+
+  cgltf_options options{};
+  cgltf_data* data = nullptr;
+  if(cgltf_parse_file(&options, gltfPath.c_str(), &data) != cgltf_result_success)return stats;
+  if(cgltf_validate(data) != cgltf_result_success
+    || cgltf_load_buffers(&options, data, gltfPath.c_str()) != cgltf_result_success
+  ) {
+    cgltf_free(data);
+    return stats;
+  }
+
+  // all animations share the rate, so the worst one decides
+  constexpr uint32_t RATE_COUNT = std::size(SAMPLE_RATES);
+  std::array<ChannelError, RATE_COUNT> errors{};
+  std::array<uint32_t, RATE_COUNT> bytes{};
+
+  for(cgltf_size a=0; a<data->animations_count; ++a)
+  {
+    const auto &anim = data->animations[a];
+    std::vector<Channel> channels{};
+    float duration = 0.0f;
+    for(cgltf_size c=0; c<anim.channels_count; ++c) {
+      Channel ch{};
+      if(!readChannel(anim.channels[c], ch))continue;
+      duration = std::max(duration, ch.times.back());
+      channels.push_back(std::move(ch));
+    }
+
+    for(const auto &ch : channels) {
+      for(uint32_t r=0; r<RATE_COUNT; ++r) {
+        bytes[r] += estimateBytes(ch, duration, SAMPLE_RATES[r]);
+        if(r == 0)continue;
+        auto err = measureError(ch, duration, SAMPLE_RATES[r], baseScale);
+        errors[r].rot = std::max(errors[r].rot, err.rot);
+        errors[r].pos = std::max(errors[r].pos, err.pos);
+        errors[r].scale = std::max(errors[r].scale, err.scale);
+      }
+    }
+  }
+  cgltf_free(data);
+
+  uint32_t picked = 0;
+  for(uint32_t r=1; r<RATE_COUNT; ++r) {
+    const auto &err = errors[r];
+    if(err.rot > maxErrDeg || err.pos > MAX_ERR_POS || err.scale > MAX_ERR_SCALE)break;
+    picked = r;
+  }
+
+  stats.sampleRate = SAMPLE_RATES[picked];
+  stats.bytesDefault = bytes[0];
+  stats.bytesPicked = bytes[picked];
+  stats.maxErrRot = errors[picked].rot;
+  stats.maxErrPos = errors[picked].pos;
+  return stats;
+}
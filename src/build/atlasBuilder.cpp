@@ -0,0 +1,235 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "../utils/string.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <map>
+
+#include "../utils/textureFormats.h"
+#include "../utils/fs.h"
+#include "../utils/hash.h"
+#include "../utils/logger.h"
+#include "lodepng.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // only small images are worth sharing a sprite, larger ones need multiple TMEM loads on their own
+  constexpr uint32_t MAX_IMAGE_SIZE = 128;
+  constexpr uint32_t MAX_ATLAS_SIZE = 1024;
+  // border around each image, filled with its edge pixels so filtering doesn't pick up the neighbors
+  constexpr uint32_t PADDING = 1;
+
+  struct Image
+  {
+    const Project::AssetManagerEntry *asset{};
+    uint32_t width{};
+    uint32_t height{};
+  };
+
+  std::string getAtlasName(const std::string &group)
+  {
+    std::string res = "atlas_";
+    for(char c : group)res += std::isalnum((unsigned char)c) ? c : '_';
+    return res;
+  }
+
+  fs::path getAtlasPNGPath(const Project::Project &project, const Build::Atlas &atlas) {
+    return fs::path{project.getPath()} / "build" / "atlas" / (atlas.name + ".png");
+  }
+
+  /**
+   * Places images on rows (shelves) sorted by height, the width is the smallest power of two
+   * that fits all of them into a roughly square atlas.
+   * @return false if they don't fit into 'MAX_ATLAS_SIZE'
+   */
+  bool packImages(std::vector<Image> &images, Build::Atlas &atlas)
+  {
+    std::stable_sort(images.begin(), images.end(), [](const Image &a, const Image &b) {
+      return a.height != b.height ? a.height > b.height : a.width > b.width;
+    });
+
+    uint32_t area = 0;
+    uint32_t maxWidth = 0;
+    for(auto &img : images) {
+      area += (img.width + PADDING*2) * (img.height + PADDING*2);
+      maxWidth = std::max(maxWidth, img.width + PADDING*2);
+    }
+
+    uint32_t width = 8;
+    while(width < maxWidth || width * width < area)width *= 2;
+
+    uint32_t x = 0, y = 0, rowHeight = 0;
+    atlas.regions.clear();
+    for(auto &img : images)
+    {
+      uint32_t w = img.width + PADDING*2;
+      uint32_t h = img.height + PADDING*2;
+      if(x + w > width) {
+        x = 0;
+        y += rowHeight;
+        rowHeight = 0;
+      }
+      atlas.regions.push_back({
+        .uuid = img.asset->getUUID(),
+        .path = img.asset->path,
+        .romPath = img.asset->romPath,
+        .x = (uint16_t)(x + PADDING),
+        .y = (uint16_t)(y + PADDING),
+        .width = (uint16_t)img.width,
+        .height = (uint16_t)img.height,
+      });
+      x += w;
+      rowHeight = std::max(rowHeight, h);
+    }
+
+    atlas.width = width;
+    atlas.height = y + rowHeight;
+    return atlas.width <= MAX_ATLAS_SIZE && atlas.height <= MAX_ATLAS_SIZE;
+  }
+
+  // copies an image into the atlas, repeating its edges into the padding
+  void blitImage(std::vector<uint8_t> &dst, uint32_t dstWidth, const std::vector<uint8_t> &src, const Build::AtlasRegion &region)
+  {
+    int pad = PADDING;
+    for(int y=-pad; y<region.height+pad; ++y) {
+      for(int x=-pad; x<region.width+pad; ++x)
+      {
+        int srcX = std::clamp(x, 0, region.width-1);
+        int srcY = std::clamp(y, 0, region.height-1);
+        auto srcIdx = (srcY * region.width + srcX) * 4;
+        auto dstIdx = ((region.y + y) * dstWidth + (region.x + x)) * 4;
+        for(int c=0; c<4; ++c)dst[dstIdx + c] = src[srcIdx + c];
+      }
+    }
+  }
+}
+
+void Build::assignAtlases(Project::Project &project, SceneCtx &sceneCtx)
+{
+  // models reference their textures by path and may wrap them, those keep their own sprite
+  std::unordered_set<uint64_t> modelTextures{};
+  for(auto &model : project.getAssets().getTypeEntries(Project::FileType::MODEL_3D)) {
+    for(auto &mesh : model.t3dmData.models) {
+      for(auto texPath : {&mesh.material.texA.texPath, &mesh.material.texB.texPath}) {
+        auto tex = texPath->empty() ? nullptr : project.getAssets().getByPath(*texPath);
+        if(tex)modelTextures.insert(tex->getUUID());
+      }
+    }
+  }
+
+  std::map<std::string, std::vector<Image>> groups{};
+  for(auto &image : project.getAssets().getTypeEntries(Project::FileType::IMAGE))
+  {
+    auto &group = image.conf.atlasGroup.value;
+    if(group.empty() || image.conf.exclude || image.conf.format == (int)Utils::TexFormat::BCI_256)continue;
+
+    if(modelTextures.contains(image.getUUID())) {
+      Utils::Logger::log("Atlas: " + image.name + " is used by a model, not added to '" + group + "'", Utils::Logger::LEVEL_WARN);
+      continue;
+    }
+
+    // only the size is needed here, the pixels are read again when the atlas is built
+    std::vector<uint8_t> pixels{};
+    Image img{&image};
+    if(lodepng::decode(pixels, img.width, img.height, image.path) != 0)continue;
+    if(img.width > MAX_IMAGE_SIZE || img.height > MAX_IMAGE_SIZE) {
+      Utils::Logger::log("Atlas: " + image.name + " is too large for '" + group + "'", Utils::Logger::LEVEL_WARN);
+      continue;
+    }
+
+    auto &images = groups[group];
+    if(!images.empty() && images[0].asset->conf.format != image.conf.format) {
+      Utils::Logger::log("Atlas: " + image.name + " has a different format than the rest of '" + group + "'", Utils::Logger::LEVEL_WARN);
+      continue;
+    }
+    images.push_back(img);
+  }
+
+  for(auto &[group, images] : groups)
+  {
+    if(images.size() < 2)continue;
+
+    Atlas atlas{};
+    atlas.name = getAtlasName(group);
+    atlas.uuid = Utils::Hash::crc64("atlas:" + group);
+    atlas.format = images[0].asset->conf.format;
+    atlas.compression = (int)images[0].asset->conf.compression;
+    atlas.outPath = "filesystem/p64/" + atlas.name + ".sprite";
+    atlas.romPath = "rom:/p64/" + atlas.name + ".sprite";
+
+    if(!packImages(images, atlas)) {
+      Utils::Logger::log("Atlas: '" + group + "' does not fit into "
+        + std::to_string(MAX_ATLAS_SIZE) + "px, images are kept separate", Utils::Logger::LEVEL_WARN);
+      continue;
+    }
+
+    for(auto &region : atlas.regions) {
+      sceneCtx.atlasOfImage[region.uuid] = sceneCtx.atlases.size();
+    }
+    sceneCtx.atlases.push_back(atlas);
+  }
+}
+
+bool Build::buildAtlasAssets(Project::Project &project, SceneCtx &sceneCtx)
+{
+  fs::path mkSprite = fs::path{project.conf.pathN64Inst} / "bin" / "mksprite";
+  auto projectPath = fs::path{project.getPath()};
+
+  for(auto &atlas : sceneCtx.atlases)
+  {
+    std::vector<uint8_t> pixels(atlas.width * atlas.height * 4, 0);
+    for(auto &region : atlas.regions)
+    {
+      std::vector<uint8_t> src{};
+      uint32_t width{}, height{};
+      if(lodepng::decode(src, width, height, region.path) != 0 || width != region.width || height != region.height) {
+        Utils::Logger::log("Atlas: failed to read " + region.path, Utils::Logger::LEVEL_ERROR);
+        return false;
+      }
+      blitImage(pixels, atlas.width, src, region);
+    }
+
+    // the atlas is only an intermediate file, the cache below compares its content
+    auto pngPath = getAtlasPNGPath(project, atlas);
+    fs::create_directories(pngPath.parent_path());
+    std::vector<uint8_t> png{};
+    lodepng::encode(png, pixels, atlas.width, atlas.height);
+    Utils::FS::saveTextFile(pngPath, std::string{png.begin(), png.end()});
+
+    sceneCtx.files.push_back(atlas.outPath);
+    auto assetPath = projectPath / atlas.outPath;
+    fs::create_directories(assetPath.parent_path());
+
+    Project::AssetManagerEntry entry{
+      .name = atlas.name,
+      .path = pngPath.string(),
+      .outPath = atlas.outPath,
+      .romPath = atlas.romPath,
+      .type = Project::FileType::IMAGE,
+    };
+    entry.conf.format = atlas.format;
+    entry.conf.compression = (Project::ComprTypes)atlas.compression;
+    if(sceneCtx.cache.isCached(entry, assetPath, mkSprite))continue;
+
+    int compr = atlas.compression - 1;
+    if(compr < 0)compr = 1; // @TODO: pull default compression level
+
+    std::vector<std::string> args{mkSprite.string(), "-c", std::to_string(compr)};
+    if(atlas.format != 0) {
+      args.insert(args.end(), {"-f", Utils::TEX_TYPES[atlas.format]});
+    }
+    args.insert(args.end(), {"-o", assetPath.parent_path().string(), pngPath.string()});
+
+    sceneCtx.jobs.add(pngPath.string(), [&toolchain = sceneCtx.toolchain, args](std::string &log) {
+      return toolchain.runToolSync(args, log);
+    });
+  }
+  return true;
+}
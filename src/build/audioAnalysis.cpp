@@ -0,0 +1,61 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "../utils/wav.h"
+
+namespace
+{
+  constexpr float FRAME_TIME_SEC = 1.0f / 60.0f;
+
+  struct CodecCost
+  {
+    float decodeUsPerSample; // per sample and channel, CPU + RSP
+    float bytesPerSample; // per sample and channel, in ROM
+  };
+
+  // rough estimates of the libdragon decoders, only meant to compare codecs and sounds against each other.
+  // raw samples are only streamed, VADPCM is decoded on the RSP (9 bytes per 16 samples), Opus mostly on the CPU
+  constexpr CodecCost CODEC_COSTS[Build::AudioCostStats::CODEC_COUNT] {
+    {0.0f, 2.0f},
+    {0.15f, 9.0f / 16.0f},
+    {2.0f, 0.15f},
+  };
+
+  // below this, sounds stay uncompressed as long as they are small (mostly short SFX played often)
+  constexpr float SHORT_SOUND_SEC = 1.5f;
+  constexpr uint32_t SHORT_SOUND_MAX_BYTES = 64 * 1024;
+  // above this, the ROM savings of Opus are worth its decode time (music, ambience)
+  constexpr float LONG_SOUND_SEC = 20.0f;
+}
+
+float Build::AudioCostStats::estimateDecodeUs(uint32_t codec) const
+{
+  return CODEC_COSTS[codec].decodeUsPerSample * sampleRate * channels * FRAME_TIME_SEC;
+}
+
+uint32_t Build::AudioCostStats::estimateSize(uint32_t codec) const
+{
+  return (uint32_t)(CODEC_COSTS[codec].bytesPerSample * sampleRate * channels * durationSec);
+}
+
+uint32_t Build::AudioCostStats::getRecommended() const
+{
+  if(durationSec < SHORT_SOUND_SEC && estimateSize(0) <= SHORT_SOUND_MAX_BYTES)return 0;
+  if(durationSec >= LONG_SOUND_SEC)return 2;
+  return 1;
+}
+
+bool Build::analyzeAudioCost(const Project::AssetManagerEntry &asset, AudioCostStats &stats)
+{
+  if(asset.type != Project::FileType::AUDIO)return false;
+
+  Utils::Wav::Info info{};
+  if(!Utils::Wav::readInfo(asset.path, info))return false;
+
+  stats.sampleRate = asset.conf.wavResampleRate.value ? asset.conf.wavResampleRate.value : info.sampleRate;
+  stats.channels = asset.conf.wavForceMono.value ? 1 : info.channels;
+  stats.durationSec = (float)info.frameCount / (float)info.sampleRate;
+  return true;
+}
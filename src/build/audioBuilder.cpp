@@ -5,12 +5,62 @@
 #include "projectBuilder.h"
 #include "../utils/string.h"
 #include "../utils/fs.h"
+#include "../utils/hash.h"
 #include "../utils/logger.h"
 #include "../utils/proc.h"
+#include "../utils/wav.h"
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
+namespace
+{
+  // resampled and/or downmixed sources, one per asset, so changing only the compression doesn't resample again
+  constexpr const char* PCM_CACHE_DIR = "build/audio";
+  // bump if the resampling changes, invalidates all files
+  constexpr const char* PCM_CACHE_VERSION = "p64-pcm-1";
+
+  /**
+   * Returns the source with resampling and downmixing already applied, creating it if needed.
+   * Only works for uncompressed WAV files, anything else is left to 'audioconv64'.
+   * The file has the same name as the source, since that decides the name of the output.
+   * @param sampleRate new rate, 0 to keep it
+   * @return path of the preprocessed file, empty if it can't be done for this asset
+   */
+  fs::path getPreprocessedWav(const fs::path &projectPath, const fs::path &srcPath, uint64_t uuid,
+    uint32_t sampleRate, bool forceMono, std::string &log)
+  {
+    if(srcPath.extension() != ".wav")return {};
+
+    Utils::Hash::XXH64 hash{};
+    hash.update(PCM_CACHE_VERSION);
+    if(!hash.updateFile(srcPath))return {};
+    hash.update(&sampleRate, sizeof(sampleRate));
+    hash.update(&forceMono, sizeof(forceMono));
+
+    auto assetDir = projectPath / PCM_CACHE_DIR / Utils::toHex64(uuid);
+    auto pcmPath = assetDir / Utils::toHex64(hash.digest()) / srcPath.filename();
+    if(fs::exists(pcmPath))return pcmPath;
+
+    Utils::Wav::PCM pcm{};
+    if(!Utils::Wav::load(srcPath, pcm))return {};
+    if(forceMono)Utils::Wav::toMono(pcm);
+    Utils::Wav::resample(pcm, sampleRate);
+
+    // only the latest version is kept
+    std::error_code err{};
+    fs::remove_all(assetDir, err);
+    fs::create_directories(pcmPath.parent_path(), err);
+    if(!Utils::Wav::save(pcmPath, pcm)) {
+      fs::remove(pcmPath, err);
+      return {};
+    }
+    log += "Resampled " + srcPath.string() + " (" + std::to_string(pcm.sampleRate) + "Hz, "
+      + std::to_string(pcm.channels) + "ch)\n";
+    return pcmPath;
+  }
+}
+
 bool Build::buildAudioAssets(Project::Project &project, SceneCtx &sceneCtx)
 {
   fs::path mkAudio = fs::path{project.conf.pathN64Inst} / "bin" / "audioconv64";
@@ -26,23 +76,39 @@ bool Build::buildAudioAssets(Project::Project &project, SceneCtx &sceneCtx)
 
     sceneCtx.files.push_back(Utils::FS::toUnixPath(asset.outPath));
 
-    if(!assetBuildNeeded(asset, outPath))continue;
+    if(sceneCtx.cache.isCached(asset, outPath, mkAudio))continue;
 
-    std::string cmd = mkAudio.string();
-    if(asset.conf.wavForceMono.value) {
-      cmd += " --wav-mono";
-    }
-    if(asset.conf.wavResampleRate.value != 0) {
-      cmd += " --wav-resample " + std::to_string(asset.conf.wavResampleRate.value);
+    // the rest of the command depends on whether the resampling is done here, see 'getPreprocessedWav'
+    std::vector<std::string> argsEnd{"--wav-compress", std::to_string(asset.conf.wavCompression.value)};
+    if(asset.conf.wavLoop.value) {
+      argsEnd.insert(argsEnd.end(), {"--wav-loop", "true"});
+      argsEnd.insert(argsEnd.end(), {"--wav-loop-offset", std::to_string(asset.conf.wavLoopOffset.value)});
     }
+    argsEnd.insert(argsEnd.end(), {"-o", outDir.string()});
 
-    cmd += " --wav-compress " + std::to_string(asset.conf.wavCompression.value);
-    cmd += " -o \"" + outDir.string() + "\"";
-    cmd += " \"" + asset.path + "\"";
+    sceneCtx.jobs.add(asset.path, [&toolchain = sceneCtx.toolchain, projectPath, mkAudio, argsEnd,
+      path = asset.path, uuid = asset.getUUID(),
+      sampleRate = asset.conf.wavResampleRate.value, forceMono = asset.conf.wavForceMono.value](std::string &log)
+    {
+      std::vector<std::string> args{mkAudio.string()};
+      bool preprocess = forceMono || sampleRate != 0;
+      auto pcmPath = preprocess ? getPreprocessedWav(projectPath, path, uuid, sampleRate, forceMono, log) : fs::path{};
+      if(!pcmPath.empty()) {
+        args.insert(args.end(), argsEnd.begin(), argsEnd.end());
+        args.push_back(pcmPath.string());
+        return toolchain.runToolSync(args, log);
+      }
 
-    if(!sceneCtx.toolchain.runCmdSyncLogged(cmd)) {
-      return false;
-    }
+      if(forceMono) {
+        args.push_back("--wav-mono");
+      }
+      if(sampleRate != 0) {
+        args.insert(args.end(), {"--wav-resample", std::to_string(sampleRate)});
+      }
+      args.insert(args.end(), argsEnd.begin(), argsEnd.end());
+      args.push_back(path);
+      return toolchain.runToolSync(args, log);
+    });
   }
   return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,155 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include <algorithm>
+#include <filesystem>
+#include <map>
+
+#include "json.hpp"
+#include "../utils/fs.h"
+#include "../utils/logger.h"
+#include "../utils/proc.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // written by the ROM (see 'benchRunner.cpp' in the benchmark project), one line per frame
+  constexpr std::string_view MARKER_FRAME = "[P64-BENCH]";
+  constexpr std::string_view MARKER_END = "[P64-BENCH-END]";
+  // per-layer command words, the max. per scene is stored for the scene build to size the buffers
+  constexpr std::string_view METRIC_LAYER_WORDS = "layerWords";
+  constexpr const char* LAYER_PEAKS_FILE = "layerPeaks.json";
+
+  struct SceneSamples
+  {
+    std::map<std::string, std::vector<double>> metrics{};
+    uint32_t frames{0};
+  };
+
+  nlohmann::json summarize(std::vector<double> &values)
+  {
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for(double v : values)sum += v;
+
+    auto percentile = [&](double p) {
+      auto idx = (size_t)(p * (double)(values.size() - 1) + 0.5);
+      return values[std::min(idx, values.size() - 1)];
+    };
+
+    return {
+      {"avg", sum / (double)values.size()},
+      {"min", values.front()},
+      {"max", values.back()},
+      {"p50", percentile(0.5)},
+      {"p95", percentile(0.95)},
+    };
+  }
+
+  void setEnv(const char* name, const std::string &value)
+  {
+  #if defined(_WIN32)
+    _putenv_s(name, value.c_str());
+  #else
+    setenv(name, value.c_str(), 1);
+  #endif
+  }
+}
+
+bool Build::runBenchmark(const std::string &configPath, const BenchmarkOptions &options)
+{
+  // picked up by the project makefile, the ROM switches scenes after that many frames
+  setEnv("BENCH_FRAMES", std::to_string(options.frames));
+  if(!buildProject(configPath))return false;
+
+  Project::Project project{configPath};
+  auto romPath = fs::absolute(fs::path{project.getPath()} / (project.conf.romName + ".z64"));
+  auto emuCmd = options.emuCmd.empty() ? project.conf.pathEmu : options.emuCmd;
+  if(emuCmd.empty()) {
+    Utils::Logger::log("Benchmark: no emulator set", Utils::Logger::LEVEL_ERROR);
+    return false;
+  }
+
+  std::map<uint32_t, SceneSamples> scenes{};
+  bool finished = false;
+
+  Utils::Logger::log("Running benchmark: " + romPath.string());
+  bool started = Utils::Proc::runSyncLines(emuCmd + " \"" + romPath.string() + "\"", [&](const std::string &line)
+  {
+    if(line.find(MARKER_END) != std::string::npos) {
+      finished = true;
+      return false;
+    }
+
+    auto pos = line.find(MARKER_FRAME);
+    if(pos == std::string::npos)return true;
+
+    auto doc = nlohmann::json::parse(line.substr(pos + MARKER_FRAME.size()), nullptr, false);
+    if(doc.is_discarded() || !doc.is_object())return true;
+
+    auto &samples = scenes[doc.value("scene", 0u)];
+    ++samples.frames;
+    for(auto &[key, val] : doc.items()) {
+      if(key == "scene" || !val.is_number())continue;
+      samples.metrics[key].push_back(val.get<double>());
+    }
+    return true;
+  });
+
+  if(!started) {
+    Utils::Logger::log("Benchmark: failed to start emulator: " + emuCmd, Utils::Logger::LEVEL_ERROR);
+    return false;
+  }
+  if(!finished) {
+    Utils::Logger::log("Benchmark: emulator exited before the end marker, report is incomplete", Utils::Logger::LEVEL_WARN);
+  }
+
+  nlohmann::json report{};
+  report["project"] = project.conf.name;
+  report["framesPerScene"] = options.frames;
+  report["complete"] = finished;
+  report["scenes"] = nlohmann::json::array();
+  nlohmann::json layerPeaks = nlohmann::json::object();
+
+  for(auto &[sceneId, samples] : scenes)
+  {
+    std::string name{};
+    for(auto &entry : project.getScenes().getEntries()) {
+      if(entry.id == (int)sceneId)name = entry.name;
+    }
+
+    nlohmann::json metrics{};
+    std::vector<uint32_t> peaks{};
+    for(auto &[key, values] : samples.metrics) {
+      metrics[key] = summarize(values);
+
+      if(key.starts_with(METRIC_LAYER_WORDS)) {
+        auto layerIdx = (uint32_t)std::stoul(key.substr(METRIC_LAYER_WORDS.size()));
+        if(peaks.size() <= layerIdx)peaks.resize(layerIdx+1, 0);
+        peaks[layerIdx] = (uint32_t)values.back(); // sorted by 'summarize()'
+      }
+    }
+    if(!peaks.empty())layerPeaks[std::to_string(sceneId)] = peaks;
+
+    report["scenes"].push_back({
+      {"id", sceneId},
+      {"name", name},
+      {"frames", samples.frames},
+      {"metrics", metrics},
+    });
+
+    Utils::Logger::log("Scene " + std::to_string(sceneId) + " (" + name + "): "
+      + std::to_string(samples.frames) + " frames");
+  }
+
+  Utils::FS::saveTextFile(options.reportPath, report.dump(2));
+  if(finished && !layerPeaks.empty()) {
+    Utils::FS::saveTextFile(fs::path{project.getPath()} / LAYER_PEAKS_FILE, layerPeaks.dump(2));
+    Utils::Logger::log("Layer buffer peaks saved, used by the next build");
+  }
+  Utils::Logger::log("Benchmark report: " + options.reportPath);
+  return finished && !scenes.empty();
+}
@@ -0,0 +1,133 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "buildCache.h"
+
+#include <cstdlib>
+#include <vector>
+
+#include "../project/project.h"
+#include "../utils/fs.h"
+#include "../utils/hash.h"
+#include "../utils/logger.h"
+#include "../utils/string.h"
+
+namespace
+{
+  // bump if the way keys are built changes, invalidates all entries
+  constexpr const char* CACHE_VERSION = "p64-cache-2";
+  constexpr const char* INDEX_FILE = "p64cache.json";
+
+  // streaming data of models, written next to the '.t3dm' (see 'buildT3DMAssets')
+  constexpr const char* EXT_STREAM_DATA = ".sdata";
+
+  // the output itself plus anything written next to it by the same conversion
+  std::vector<fs::path> getOutputs(const fs::path &outPath)
+  {
+    std::vector<fs::path> res{outPath};
+    auto prefix = outPath.stem().string();
+    for(const auto &entry : fs::directory_iterator{outPath.parent_path()}) {
+      if(!entry.is_regular_file() || entry.path().extension() != EXT_STREAM_DATA)continue;
+      if(entry.path().filename().string().starts_with(prefix))res.push_back(entry.path());
+    }
+    return res;
+  }
+
+  // tools are only compared by size and date, hashing them for each asset would take longer than most conversions
+  std::string getToolVersion(const fs::path &toolPath)
+  {
+    std::error_code err{};
+    auto size = fs::file_size(toolPath, err);
+    if(err)return toolPath.string();
+    return toolPath.string() + ":" + std::to_string(size) + ":" + std::to_string(Utils::FS::getFileAge(toolPath));
+  }
+}
+
+void Build::BuildCache::load(const Project::Project &project)
+{
+  auto buildDir = fs::path{project.getPath()} / "build";
+  const char* sharedDir = getenv("P64_BUILD_CACHE");
+  cacheDir = (sharedDir && sharedDir[0]) ? fs::path{sharedDir} : (buildDir / "p64cache");
+  indexPath = buildDir / INDEX_FILE;
+  pending.clear();
+
+  index = nlohmann::json::parse(Utils::FS::loadTextFile(indexPath), nullptr, false);
+  if(index.is_discarded() || !index.is_object())index = nlohmann::json::object();
+}
+
+bool Build::BuildCache::isCached(const Project::AssetManagerEntry &asset, const fs::path &outPath,
+  const fs::path &toolPath, const std::string &extraKey)
+{
+  // the UUID only identifies the asset in the project, identical files can share an entry
+  auto conf = nlohmann::json::parse(asset.conf.serialize(), nullptr, false);
+  if(conf.is_object())conf.erase("uuid");
+
+  // sources are streamed into the hash, large models don't need to be loaded for this
+  Utils::Hash::XXH64 hash{};
+  hash.update(CACHE_VERSION);
+  hash.update("", 1);
+  hash.updateFile(asset.path);
+  // text glTFs keep their geometry in a separate buffer
+  auto pathBin = fs::path{asset.path}.replace_extension(".bin");
+  if(fs::path{asset.path}.extension() == ".gltf" && fs::exists(pathBin)) {
+    hash.update("", 1);
+    hash.updateFile(pathBin);
+  }
+  for(const auto &part : {conf.dump(), getToolVersion(toolPath), extraKey}) {
+    hash.update("", 1);
+    hash.update(part);
+  }
+
+  auto key = Utils::toHex64(hash.digest());
+  auto outKey = Utils::FS::toUnixPath(outPath);
+
+  if(index.value(outKey, "") == key && fs::exists(outPath))return true;
+
+  auto entryDir = cacheDir / key;
+  if(fs::exists(entryDir / outPath.filename()))
+  {
+    std::error_code err{};
+    fs::create_directories(outPath.parent_path(), err);
+    for(const auto &entry : fs::directory_iterator{entryDir}) {
+      fs::copy_file(entry.path(), outPath.parent_path() / entry.path().filename(), fs::copy_options::overwrite_existing, err);
+      if(err)break;
+    }
+    if(!err) {
+      Utils::Logger::log("Restored Asset from cache: " + asset.path);
+      index[outKey] = key;
+      return true;
+    }
+  }
+
+  Utils::Logger::log("Building Asset: " + asset.path);
+  pending[outKey] = key;
+  return false;
+}
+
+void Build::BuildCache::storePending()
+{
+  for(auto &[outKey, key] : pending)
+  {
+    fs::path outPath{outKey};
+    if(!fs::exists(outPath))continue;
+
+    std::error_code err{};
+    auto entryDir = cacheDir / key;
+    fs::create_directories(entryDir, err);
+    for(auto &file : getOutputs(outPath)) {
+      fs::copy_file(file, entryDir / file.filename(), fs::copy_options::overwrite_existing, err);
+      if(err)break;
+    }
+    if(err) {
+      Utils::Logger::log("Build cache: failed to store " + outKey + ": " + err.message(), Utils::Logger::LEVEL_WARN);
+      continue;
+    }
+    index[outKey] = key;
+  }
+  pending.clear();
+
+  std::error_code err{};
+  fs::create_directories(indexPath.parent_path(), err);
+  Utils::FS::saveTextFile(indexPath, index.dump(2));
+}
@@ -0,0 +1,51 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+
+#include "json.hpp"
+
+namespace fs = std::filesystem;
+namespace Project { class Project; struct AssetManagerEntry; }
+
+namespace Build
+{
+  /**
+   * Skips asset conversions whose inputs didn't change, based on their content instead of file dates.
+   * The key of an asset is a hash of its source file, settings and the tool doing the conversion.
+   * Outputs are kept per key in '<project>/build/p64cache', or in 'P64_BUILD_CACHE' if set (e.g. shared on CI),
+   * so switching back to an older state restores them instead of converting again.
+   */
+  class BuildCache
+  {
+    private:
+      fs::path cacheDir{};
+      fs::path indexPath{};
+      nlohmann::json index{}; // output path -> key it was last built from
+      std::unordered_map<std::string, std::string> pending{}; // output path -> key, built in this run
+
+    public:
+      void load(const Project::Project &project);
+
+      /**
+       * Checks if an asset needs to be converted, restoring the outputs from the cache if possible.
+       * Returns false for now-missing entries, those get stored once built (see 'storePending').
+       * @param outPath main output file, others next to it starting with the same name are included
+       * @param toolPath converter used, changes to it (e.g. SDK updates) invalidate the entry
+       * @param extraKey anything else the output depends on
+       * @return true if it is up-to-date now, false if it has to be built
+       */
+      bool isCached(const Project::AssetManagerEntry &asset, const fs::path &outPath,
+        const fs::path &toolPath, const std::string &extraKey = ""
+      );
+
+      /**
+       * Copies everything built since 'load' into the cache, call once the conversions are done.
+       */
+      void storePending();
+  };
+}
@@ -0,0 +1,93 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "buildReport.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "json.hpp"
+#include "../utils/fs.h"
+#include "../utils/logger.h"
+
+namespace
+{
+  constexpr uint32_t SUMMARY_ASSET_COUNT = 10;
+  constexpr uint32_t NAME_WIDTH = 48;
+
+  std::vector<Build::BuildReport::Entry> sortByTime(std::vector<Build::BuildReport::Entry> entries)
+  {
+    std::stable_sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+      return a.timeMs > b.timeMs;
+    });
+    return entries;
+  }
+
+  std::string formatRow(const std::string &name, double timeMs, double totalMs)
+  {
+    // asset names are paths, the end is what tells them apart
+    auto shortName = name.size() <= NAME_WIDTH ? name : ("..." + name.substr(name.size() - NAME_WIDTH + 3));
+
+    char buff[256];
+    double percent = totalMs > 0 ? (timeMs / totalMs * 100.0) : 0.0;
+    snprintf(buff, sizeof(buff), "  %-*s %10.1fms %6.1f%%\n", (int)NAME_WIDTH, shortName.c_str(), timeMs, percent);
+    return buff;
+  }
+}
+
+void Build::BuildReport::Timer::stop()
+{
+  if(!target)return;
+  double timeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  target->push_back({std::move(name), timeMs});
+  target = nullptr;
+}
+
+void Build::BuildReport::save(const fs::path &path) const
+{
+  double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  auto toJSON = [](const std::vector<Entry> &entries) {
+    auto res = nlohmann::json::array();
+    for(const auto &entry : entries) {
+      res.push_back({{"name", entry.name}, {"timeMs", entry.timeMs}});
+    }
+    return res;
+  };
+
+  nlohmann::json doc{};
+  doc["totalMs"] = totalMs;
+  doc["phases"] = toJSON(phases);
+  doc["assets"] = toJSON(sortByTime(assets));
+
+  std::error_code err{};
+  fs::create_directories(path.parent_path(), err);
+  Utils::FS::saveTextFile(path, doc.dump(2));
+}
+
+void Build::BuildReport::logSummary() const
+{
+  double totalMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  std::string msg = "Build times:\n";
+  for(const auto &phase : phases) {
+    msg += formatRow(phase.name, phase.timeMs, totalMs);
+  }
+  msg += formatRow("Total", totalMs, totalMs);
+
+  if(!assets.empty())
+  {
+    // assets run in parallel, so their times only compare to each other
+    double assetsMs = 0;
+    for(const auto &asset : assets)assetsMs += asset.timeMs;
+
+    msg += "Slowest assets:\n";
+    auto sorted = sortByTime(assets);
+    if(sorted.size() > SUMMARY_ASSET_COUNT)sorted.resize(SUMMARY_ASSET_COUNT);
+    for(const auto &asset : sorted) {
+      msg += formatRow(asset.name, asset.timeMs, assetsMs);
+    }
+  }
+  Utils::Logger::logRaw(msg);
+}
@@ -0,0 +1,73 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Build
+{
+  /**
+   * Collects how long each part of a build took.
+   * Phases are the big steps in 'buildProject', assets the individual conversions within them.
+   */
+  class BuildReport
+  {
+    public:
+      using Clock = std::chrono::steady_clock;
+
+      struct Entry
+      {
+        std::string name{};
+        double timeMs{};
+      };
+
+      /**
+       * Measures from construction until 'stop()' or destruction, whatever comes first.
+       * Early returns (e.g. a failed step) still end up in the report this way.
+       */
+      class Timer
+      {
+        private:
+          std::vector<Entry> *target;
+          std::string name;
+          Clock::time_point start;
+
+        public:
+          Timer(std::vector<Entry> &target, std::string name)
+            : target{&target}, name{std::move(name)}, start{Clock::now()} {}
+
+          ~Timer() { stop(); }
+          Timer(const Timer&) = delete;
+          Timer& operator=(const Timer&) = delete;
+
+          void stop();
+      };
+
+    private:
+      Clock::time_point start{Clock::now()};
+      std::vector<Entry> phases{};
+      std::vector<Entry> assets{};
+
+    public:
+      [[nodiscard]] Timer phase(const std::string &name) { return {phases, name}; }
+      [[nodiscard]] Timer asset(const std::string &name) { return {assets, name}; }
+
+      void addAsset(const std::string &name, double timeMs) { assets.push_back({name, timeMs}); }
+
+      /**
+       * Writes the report as JSON, with assets sorted by time (slowest first).
+       */
+      void save(const fs::path &path) const;
+
+      /**
+       * Logs a table of all phases and the slowest assets.
+       */
+      void logSummary() const;
+  };
+}
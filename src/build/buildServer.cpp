@@ -0,0 +1,123 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "buildServer.h"
+#include "projectBuilder.h"
+#include "../utils/fs.h"
+#include "../utils/hash.h"
+#include "../utils/logger.h"
+
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // everything a loaded project reads from, changes anywhere else are picked up by the build itself
+  constexpr const char* PROJECT_DIRS[] = {"assets", "data", "src/user"};
+
+  uint64_t getFingerprint(const std::string &configPath)
+  {
+    std::string state = configPath + ":" + std::to_string(Utils::FS::getFileAge(configPath)) + "\n";
+    auto projectPath = fs::path{configPath}.parent_path();
+    for(auto dir : PROJECT_DIRS) {
+      std::error_code err{};
+      for(const auto &entry : fs::recursive_directory_iterator{projectPath / dir, err}) {
+        if(!entry.is_regular_file())continue;
+        state += entry.path().string() + ":" + std::to_string(Utils::FS::getFileAge(entry.path())) + "\n";
+      }
+    }
+    return Utils::Hash::crc64(state);
+  }
+
+  void reply(bool success) {
+    printf("%s %s\n", Build::Server::SERVER_MARKER, success ? "ok" : "fail");
+    fflush(stdout);
+  }
+}
+
+Build::Server::Server() {
+  Project::AssetManager::setParseCacheEnabled(true);
+}
+
+Build::Server::~Server() {
+  sessions.clear();
+  Project::AssetManager::setParseCacheEnabled(false);
+}
+
+bool Build::Server::build(const std::string &configPath)
+{
+  std::lock_guard lock{mtx};
+
+  // cheap, but only needed again if something was missing (e.g. installed in the meantime)
+  auto &tc = toolchain.getState();
+  if(!hasScanned || !tc.hasToolchain || !tc.hasLibdragon || !tc.hasTiny3d) {
+    toolchain.scan();
+    hasScanned = true;
+  }
+
+  auto key = fs::absolute(configPath).lexically_normal().string();
+  auto &session = sessions[key];
+  auto fingerprint = getFingerprint(configPath);
+  if(!session.project || session.fingerprint != fingerprint)
+  {
+    session.project.reset();
+    try {
+      session.project = std::make_unique<Project::Project>(configPath);
+    } catch(const std::exception &e) {
+      Utils::Logger::log(std::string("Failed to load project: ") + e.what(), Utils::Logger::LEVEL_ERROR);
+      sessions.erase(key);
+      return false;
+    }
+    session.fingerprint = fingerprint;
+  } else {
+    Utils::Logger::log("Project unchanged, reusing the loaded one");
+  }
+
+  bool res = buildProject(*session.project, toolchain);
+  // after the first build, which sets up the environment the shell is started in
+  toolchain.cacheShellEnv();
+  return res;
+}
+
+void Build::Server::forget(const std::string &configPath)
+{
+  std::lock_guard lock{mtx};
+  sessions.erase(fs::absolute(configPath).lexically_normal().string());
+}
+
+bool Build::Server::serve()
+{
+  printf("%s ready\n", SERVER_MARKER);
+  fflush(stdout);
+
+  std::string line{};
+  while(std::getline(std::cin, line))
+  {
+    if(!line.empty() && line.back() == '\r')line.pop_back();
+    if(line.empty())continue;
+
+    auto sep = line.find(' ');
+    auto cmd = line.substr(0, sep);
+    auto arg = sep == std::string::npos ? std::string{} : line.substr(sep + 1);
+
+    if(cmd == "quit")break;
+    if(cmd == "build" && !arg.empty()) {
+      reply(build(arg));
+    } else if(cmd == "forget" && !arg.empty()) {
+      forget(arg);
+      reply(true);
+    } else {
+      Utils::Logger::log("Unknown request: " + line, Utils::Logger::LEVEL_ERROR);
+      reply(false);
+    }
+  }
+  return true;
+}
+
+Build::Server& Build::getServer()
+{
+  static Server server{};
+  return server;
+}
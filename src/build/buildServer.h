@@ -0,0 +1,59 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "../project/project.h"
+#include "../utils/toolchain.h"
+
+namespace Build
+{
+  /**
+   * Keeps projects and the toolchain loaded between builds, instead of starting from scratch each time.
+   * A project is only loaded again if any of its files changed, its models then come from the shared
+   * parse cache (see 'Project::AssetManager::setParseCacheEnabled') unless they changed too.
+   * The editor runs all builds through one, the CLI can keep one running with '--cmd serve'.
+   */
+  class Server
+  {
+    private:
+      struct Session
+      {
+        std::unique_ptr<Project::Project> project{};
+        uint64_t fingerprint{};
+      };
+
+      std::mutex mtx{};
+      std::unordered_map<std::string, Session> sessions{};
+      Utils::Toolchain toolchain{};
+      bool hasScanned{false};
+
+    public:
+      Server();
+      ~Server();
+
+      bool build(const std::string &configPath);
+
+      // drops a loaded project, the next build loads it again
+      void forget(const std::string &configPath);
+
+      /**
+       * Reads requests from stdin, one per line, until 'quit' or the end of input:
+       *   'build <project>', 'forget <project>', 'quit'
+       * Each is answered with a line starting with 'SERVER_MARKER', followed by 'ok' or 'fail'.
+       * Anything else printed in between is the log of the request.
+       */
+      bool serve();
+
+      constexpr static const char* SERVER_MARKER = "[P64-SERVER]";
+  };
+
+  // shared by all builds of the editor
+  Server& getServer();
+}
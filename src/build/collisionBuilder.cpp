@@ -5,14 +5,30 @@
 #include "projectBuilder.h"
 #include "../utils/binaryFile.h"
 #include "../utils/fs.h"
+#include "../utils/logger.h"
 #include "../project/assets/collision.h"
 #include "tiny3d/tools/gltf_importer/src/cgltfHelper.h"
 #include "tiny3d/tools/gltf_importer/src/parser.h"
 #include "tiny3d/tools/gltf_importer/src/lib/cgltf.h"
 #include "tiny3d/tools/gltf_importer/src/optimizer/optimizer.h"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
 
 namespace
 {
+  // triangles smaller than this (in units squared) can't be told apart by the quantized BVH anyway
+  constexpr float MIN_TRI_AREA = 1.0f;
+  // normals closer than this (cosine of the angle) count as coplanar
+  constexpr float COPLANAR_DOT = 0.9995f;
+  // leaf sizes are stored in 4 bits at runtime, see 'BVHNode'
+  constexpr uint32_t MAX_LEAF_SIZE = 15;
+  constexpr uint32_t DEFAULT_LEAF_SIZE = 8;
+  // must match 'Coll::Mesh::FLAG_QUANTIZED'
+  constexpr uint16_t MESH_FLAG_QUANTIZED = 1 << 0;
+
   struct CollisionMesh
   {
     std::vector<glm::vec3> verticesFloat{};
@@ -55,11 +71,163 @@ namespace
     }
   }
 
+  glm::vec3 toGLM(const Vec3 &v) {
+    return {v[0], v[1], v[2]};
+  }
+
+  /**
+   * Welds vertices at the same position, render meshes split them at UV and normal seams.
+   * @return index of the first unique vertex for each vertex
+   */
+  std::vector<uint16_t> weldVertices(const std::vector<Vec3> &verticesFloat)
+  {
+    std::map<std::array<float, 3>, uint16_t> posMap{};
+    std::vector<uint16_t> res(verticesFloat.size());
+    for(size_t i=0; i<verticesFloat.size(); ++i) {
+      auto &v = verticesFloat[i];
+      res[i] = posMap.try_emplace({v[0], v[1], v[2]}, (uint16_t)i).first->second;
+    }
+    return res;
+  }
+
+  glm::vec3 getTriNormal(const std::vector<glm::vec3> &pos, uint16_t a, uint16_t b, uint16_t c, float &area)
+  {
+    auto n = glm::cross(pos[b] - pos[a], pos[c] - pos[a]);
+    float len = glm::length(n);
+    area = len * 0.5f;
+    return len > 0.0f ? (n / len) : glm::vec3{0.0f};
+  }
+
+  /**
+   * Removes vertices in the middle of flat areas by collapsing them into a neighbor,
+   * which merges the coplanar triangles around them. Only collapses that keep the surface
+   * (no flipped or tiny triangles) are done, boundary vertices and edges are never moved.
+   */
+  void mergeCoplanar(const std::vector<glm::vec3> &pos, std::vector<std::array<uint16_t, 3>> &tris)
+  {
+    std::vector<std::vector<uint32_t>> trisOfVert(pos.size());
+    for(uint32_t t=0; t<tris.size(); ++t) {
+      for(auto v : tris[t])trisOfVert[v].push_back(t);
+    }
+    std::vector<bool> triRemoved(tris.size(), false);
+
+    auto tryCollapse = [&](uint16_t v) -> bool
+    {
+      auto &vertTris = trisOfVert[v];
+      if(vertTris.size() < 3)return false;
+
+      // all triangles around it have to lie in one plane
+      float area{};
+      auto &t0 = tris[vertTris[0]];
+      auto normal = getTriNormal(pos, t0[0], t0[1], t0[2], area);
+      std::map<uint16_t, uint32_t> edgeCount{};
+      for(auto t : vertTris) {
+        auto n = getTriNormal(pos, tris[t][0], tris[t][1], tris[t][2], area);
+        if(glm::dot(n, normal) < COPLANAR_DOT)return false;
+        for(auto u : tris[t])if(u != v)++edgeCount[u];
+      }
+
+      // and fully surround it, otherwise it sits on an edge of the mesh
+      for(auto &[u, count] : edgeCount) {
+        if(count != 2)return false;
+      }
+
+      for(auto &[target, count] : edgeCount)
+      {
+        bool valid = true;
+        for(auto t : vertTris)
+        {
+          auto tri = tris[t];
+          if(tri[0] == target || tri[1] == target || tri[2] == target)continue; // collapses away
+          for(auto &i : tri)if(i == v)i = target;
+          auto n = getTriNormal(pos, tri[0], tri[1], tri[2], area);
+          if(area < MIN_TRI_AREA || glm::dot(n, normal) < COPLANAR_DOT) {
+            valid = false;
+            break;
+          }
+        }
+        if(!valid)continue;
+
+        for(auto t : vertTris)
+        {
+          auto &tri = tris[t];
+          if(tri[0] == target || tri[1] == target || tri[2] == target) {
+            triRemoved[t] = true;
+            for(auto u : tri) {
+              if(u == v)continue;
+              std::erase(trisOfVert[u], t);
+            }
+            continue;
+          }
+          for(auto &i : tri)if(i == v)i = target;
+          trisOfVert[target].push_back(t);
+        }
+        vertTris.clear();
+        return true;
+      }
+      return false;
+    };
+
+    for(bool changed=true; changed;) {
+      changed = false;
+      for(uint16_t v=0; v<pos.size(); ++v) {
+        if(tryCollapse(v))changed = true;
+      }
+    }
+
+    std::vector<std::array<uint16_t, 3>> res{};
+    for(uint32_t t=0; t<tris.size(); ++t) {
+      if(!triRemoved[t])res.push_back(tris[t]);
+    }
+    tris = std::move(res);
+  }
+
+  /**
+   * Reduces the triangles to what gameplay needs: welds vertices, merges coplanar triangles and drops tiny ones.
+   * Unused vertices are removed afterward, indices are updated to match.
+   */
+  void simplifyMesh(std::vector<Vec3> &verticesFloat, std::vector<glm::i16vec3> &vertices, std::vector<uint16_t> &indices)
+  {
+    auto weldMap = weldVertices(verticesFloat);
+    std::vector<glm::vec3> pos{};
+    for(auto &v : verticesFloat)pos.push_back(toGLM(v));
+
+    std::vector<std::array<uint16_t, 3>> tris{};
+    for(size_t i=0; i<indices.size(); i+=3)
+    {
+      std::array<uint16_t, 3> tri{weldMap[indices[i]], weldMap[indices[i+1]], weldMap[indices[i+2]]};
+      float area{};
+      getTriNormal(pos, tri[0], tri[1], tri[2], area);
+      if(area >= MIN_TRI_AREA)tris.push_back(tri);
+    }
+
+    mergeCoplanar(pos, tris);
+
+    std::vector<int> newIndex(verticesFloat.size(), -1);
+    std::vector<Vec3> newVerticesFloat{};
+    std::vector<glm::i16vec3> newVertices{};
+    indices.clear();
+    for(auto &tri : tris) {
+      for(auto v : tri) {
+        if(newIndex[v] < 0) {
+          newIndex[v] = newVertices.size();
+          newVerticesFloat.push_back(verticesFloat[v]);
+          newVertices.push_back(vertices[v]);
+        }
+        indices.push_back(newIndex[v]);
+      }
+    }
+    verticesFloat = std::move(newVerticesFloat);
+    vertices = std::move(newVertices);
+  }
+
   void convert(
-    const char* gltfPath, Utils::BinaryFile &file, float baseScale,
+    const char* gltfPath, Utils::BinaryFile &file, const Project::AssetConf &conf,
     const std::unordered_set<std::string> &meshes
   )
   {
+    float baseScale = (float)conf.baseScale;
+
     cgltf_options options{};
     cgltf_data* data = nullptr;
     cgltf_result result = cgltf_parse_file(&options, gltfPath, &data);
@@ -145,6 +313,14 @@ namespace
       } // primitives
     } // nodes
 
+    if(conf.gltfCollSimplify.value)
+    {
+      auto triCount = indices.size() / 3;
+      simplifyMesh(verticesFloat, vertices, indices);
+      Utils::Logger::log("Collision: " + std::to_string(triCount) + " -> "
+        + std::to_string(indices.size() / 3) + " triangles: " + gltfPath);
+    }
+
     // generate normals
     for(int v=0; v<indices.size(); v+=3) {
       Vec3 edge1 = verticesFloat[indices[v+1]] - verticesFloat[indices[v]];
@@ -174,11 +350,25 @@ namespace
 
     // printf("Vert/Index count: %lu %lu\n", vertices.size(), indices.size());
 
-    auto bvh = Project::Assets::Collision::createBVH(vertices, indices);
+    uint32_t leafSize = conf.gltfCollLeafSize.value ? conf.gltfCollLeafSize.value : DEFAULT_LEAF_SIZE;
+    auto bvh = Project::Assets::Collision::createBVH(vertices, indices, std::min(leafSize, MAX_LEAF_SIZE));
+
+    // quantized vertices use the full int16 range for the largest coordinate, 'collScale' converts them back
+    uint16_t flags = 0;
+    float collScale = 1.0f;
+    if(conf.gltfCollQuantize.value) {
+      float maxCoord = 1.0f;
+      for(auto &v : verticesFloat) {
+        for(int i=0; i<3; ++i)maxCoord = std::max(maxCoord, fabsf(v[i]));
+      }
+      flags |= MESH_FLAG_QUANTIZED;
+      collScale = maxCoord / 32767.0f;
+    }
 
     file.write<uint32_t>(indices.size() / 3);
-    file.write<uint32_t>(vertices.size());
-    file.write<float>(1.0f);// / baseScale);
+    file.write<uint16_t>(flags);
+    file.write<uint16_t>(vertices.size());
+    file.write<float>(collScale);
     file.write<uint32_t>(0); // vertex pointer
     file.write<uint32_t>(0); // normals pointer
     file.write<uint32_t>(0); // BVH pointer
@@ -193,8 +383,14 @@ namespace
     }
     file.align(4);
 
-    for(auto& v : verticesFloat) {
-      file.writeArray(v.data, 3);
+    if(flags & MESH_FLAG_QUANTIZED) {
+      for(auto& v : verticesFloat) {
+        for(int i=0; i<3; ++i)file.write<int16_t>((int16_t)roundf(v[i] / collScale));
+      }
+    } else {
+      for(auto& v : verticesFloat) {
+        file.writeArray(v.data, 3);
+      }
     }
     file.align(4);
 
@@ -207,13 +403,12 @@ namespace
 namespace Build
 {
   Utils::BinaryFile buildCollision(
-    const std::string &gltfPath,
-    float baseScale,
+    const Project::AssetManagerEntry &model,
     const std::unordered_set<std::string> &meshes
   )
   {
     Utils::BinaryFile f{};
-    convert(gltfPath.c_str(), f, baseScale, meshes);
+    convert(model.path.c_str(), f, model.conf, meshes);
     return f;
   }
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+/**
+* @copyright 2025 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include <filesystem>
+
+#include "../utils/logger.h"
+#include "../utils/string.h"
+#include "../utils/textureFormats.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // rough throughput in bytes per microsecond, only used to compare levels against each other
+  constexpr float ROM_READ_SPEED = 5.0f;
+  constexpr std::array<float, Build::CompressionStats::LEVEL_COUNT> DECOMPRESS_SPEED{
+    0.0f, // none
+    16.0f, // LZ4
+    6.0f, // aPLib
+    2.0f, // Shrinker
+  };
+
+  // smaller levels are preferred as long as they don't load slower than this (relative to the fastest)
+  constexpr float MAX_LOAD_TIME_FACTOR = 1.25f;
+}
+
+float Build::CompressionStats::estimateLoadTimeUs(uint32_t level) const
+{
+  float timeUs = sizes[level] / ROM_READ_SPEED;
+  if(level != 0)timeUs += sizes[0] / DECOMPRESS_SPEED[level];
+  return timeUs;
+}
+
+Project::ComprTypes Build::CompressionStats::getRecommended() const
+{
+  uint32_t fastestLevel = 0;
+  for(uint32_t l=1; l<LEVEL_COUNT; ++l) {
+    if(estimateLoadTimeUs(l) < estimateLoadTimeUs(fastestLevel))fastestLevel = l;
+  }
+
+  float maxTime = estimateLoadTimeUs(fastestLevel) * MAX_LOAD_TIME_FACTOR;
+  uint32_t bestLevel = fastestLevel;
+  for(uint32_t l=0; l<LEVEL_COUNT; ++l) {
+    if(estimateLoadTimeUs(l) <= maxTime && sizes[l] < sizes[bestLevel])bestLevel = l;
+  }
+  return (Project::ComprTypes)((int)Project::ComprTypes::LEVEL_0 + bestLevel);
+}
+
+bool Build::analyzeCompression(
+  Project::Project &project, Utils::Toolchain &toolchain,
+  const Project::AssetManagerEntry &asset, CompressionStats &stats
+)
+{
+  bool supported = asset.type == Project::FileType::MODEL_3D
+    || asset.type == Project::FileType::FONT
+    || (asset.type == Project::FileType::IMAGE && asset.conf.format != (int)Utils::TexFormat::BCI_256);
+  if(!supported)return false;
+
+  auto projectPath = fs::path{project.getPath()};
+  auto assetPath = projectPath / asset.outPath;
+  if(!fs::exists(assetPath)) {
+    Utils::Logger::log("Compression: asset not built yet: " + asset.name, Utils::Logger::LEVEL_WARN);
+    return false;
+  }
+
+  // mkasset also accepts already compressed files, so the existing build output is used as the input
+  fs::path mkAsset = fs::path{project.conf.pathN64Inst} / "bin" / "mkasset";
+  for(uint32_t l=0; l<CompressionStats::LEVEL_COUNT; ++l)
+  {
+    auto outDir = projectPath / "build" / "compr" / std::to_string(l);
+    fs::create_directories(outDir);
+
+    std::string log{};
+    bool res = toolchain.runToolSync({mkAsset.string(), "-c", std::to_string(l), "-o", outDir.string(), assetPath.string()}, log);
+    if(!log.empty())Utils::Logger::logRaw(log);
+    if(!res)return false;
+
+    auto outPath = outDir / assetPath.filename();
+    stats.sizes[l] = fs::exists(outPath) ? fs::file_size(outPath) : 0;
+    fs::remove(outPath);
+  }
+  return true;
+}
+
+bool Build::analyzeProjectCompression(const std::string &configPath, bool apply)
+{
+  Project::Project project{configPath};
+  Utils::Toolchain toolchain{};
+  toolchain.scan();
+
+  Utils::Logger::log("Analyzing compression levels...");
+  for(auto &typed : project.getAssets().getEntries())
+  {
+    for(const auto &entry : typed)
+    {
+      if(entry.conf.exclude)continue;
+      CompressionStats stats{};
+      if(!analyzeCompression(project, toolchain, entry, stats))continue;
+
+      auto recommended = stats.getRecommended();
+      std::string line = entry.name + ":";
+      for(uint32_t l=0; l<CompressionStats::LEVEL_COUNT; ++l) {
+        line += " L" + std::to_string(l) + "=" + std::to_string(stats.sizes[l] / 1024) + "kb";
+      }
+      line += " -> L" + std::to_string((int)recommended - (int)Project::ComprTypes::LEVEL_0);
+      Utils::Logger::log(line);
+
+      if(apply) {
+        auto entryMut = project.getAssets().getEntryByUUID(entry.getUUID());
+        if(entryMut)entryMut->conf.compression = recommended;
+      }
+    }
+  }
+
+  if(apply)project.getAssets().save();
+  return true;
+}
@@ -0,0 +1,90 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "../project/component/components.h"
+
+namespace
+{
+  using Comps = std::vector<Project::Component::Entry*>;
+
+  // components of an object, a prefab instance uses the ones of the prefab
+  Comps getComponents(Project::Project &project, Project::Object &obj)
+  {
+    Comps res{};
+    if(obj.isPrefabInstance()) {
+      auto prefab = project.getAssets().getPrefabByUUID(obj.uuidPrefab.value);
+      if(prefab) {
+        for(auto &comp : prefab->obj.components)res.push_back(&comp);
+      }
+    }
+    for(auto &comp : obj.components)res.push_back(&comp);
+    return res;
+  }
+
+  template<typename F>
+  void forEachEnabled(Project::Project &project, Project::Object &obj, F &&func)
+  {
+    for(const auto &child : obj.children) {
+      if(!child->enabled)continue;
+      for(auto comp : getComponents(project, *child))func(*child, *comp);
+      forEachEnabled(project, *child, func);
+    }
+  }
+}
+
+void Build::DrawCost::addMeshes(const T3DM::T3DMData &t3dm, const std::vector<uint32_t> &meshes)
+{
+  // the last material stays set for the next object, same as with textures
+  const std::string* lastMaterial = nullptr;
+  auto addMesh = [&](const T3DM::Model &model) {
+    triangles += model.triangles.size();
+    vertexLoads += countVertexLoads(model);
+
+    if(!lastMaterial || *lastMaterial != model.material.name)++materials;
+    lastMaterial = &model.material.name;
+
+    const auto &tex = model.material.texA.texPath;
+    if(!tex.empty() && tex != lastTexture) {
+      ++textureLoads;
+      lastTexture = tex;
+    }
+  };
+
+  if(meshes.empty()) {
+    for(auto &model : t3dm.models)addMesh(model);
+  } else {
+    for(auto idx : meshes) {
+      if(idx < t3dm.models.size())addMesh(t3dm.models[idx]);
+    }
+  }
+}
+
+Build::DrawCost Build::estimateDrawCost(Project::Project &project, Project::Object &root, const Utils::Frustum* view)
+{
+  namespace Comp = Project::Component;
+  DrawCost cost{};
+  forEachEnabled(project, root, [&](Project::Object &obj, Comp::Entry &comp) {
+    auto funcBuild = Comp::TABLE[comp.id].funcBuild;
+    if(funcBuild == Comp::Model::build) {
+      Comp::Model::addDrawCost(obj, comp, view, cost);
+    } else if(funcBuild == Comp::AnimModel::build) {
+      Comp::AnimModel::addDrawCost(obj, comp, view, cost);
+    }
+  });
+  return cost;
+}
+
+std::vector<Build::CameraView> Build::getCameraViews(Project::Project &project, Project::Object &root, float defAspect)
+{
+  namespace Comp = Project::Component;
+  std::vector<CameraView> res{};
+  forEachEnabled(project, root, [&](Project::Object &obj, Comp::Entry &comp) {
+    if(Comp::TABLE[comp.id].funcBuild != Comp::Camera::build)return;
+    auto &view = res.emplace_back();
+    view.name = obj.name + (comp.name.empty() ? "" : (" / " + comp.name));
+    Comp::Camera::getFrustum(obj, comp, defAspect, view.frustum);
+  });
+  return res;
+}
@@ -7,14 +7,160 @@
 #include "../utils/fs.h"
 #include "../utils/logger.h"
 #include "../utils/proc.h"
+#include <algorithm>
 #include <filesystem>
+#include <set>
+
+#include "json.hpp"
 
 namespace fs = std::filesystem;
 
+namespace
+{
+  // text generated at runtime (scores, timers, ...) can't be found, so these are always kept if in the charset
+  constexpr const char* ALWAYS_USED_GLYPHS = " 0123456789.,:;-+%/!?";
+
+  // appends all decodable code-points, invalid sequences are skipped
+  void addUTF8(std::set<char32_t> &glyphs, std::string_view str)
+  {
+    for(size_t i=0; i<str.size();)
+    {
+      auto c = (uint8_t)str[i];
+      uint32_t len = c < 0x80 ? 1 : (c >> 5) == 0x06 ? 2 : (c >> 4) == 0x0E ? 3 : (c >> 3) == 0x1E ? 4 : 0;
+      if(len == 0 || i + len > str.size()) {
+        ++i;
+        continue;
+      }
+
+      char32_t cp = len == 1 ? c : (c & (0x7F >> len));
+      bool valid = true;
+      for(uint32_t b=1; b<len; ++b) {
+        auto cont = (uint8_t)str[i+b];
+        if((cont & 0xC0) != 0x80)valid = false;
+        cp = (cp << 6) | (cont & 0x3F);
+      }
+      i += valid ? len : 1;
+      if(valid && cp >= 0x20 && cp != 0x7F)glyphs.insert(cp);
+    }
+  }
+
+  std::string toUTF8(char32_t cp)
+  {
+    std::string res{};
+    if(cp < 0x80) {
+      res.push_back((char)cp);
+    } else if(cp < 0x800) {
+      res.push_back((char)(0xC0 | (cp >> 6)));
+      res.push_back((char)(0x80 | (cp & 0x3F)));
+    } else if(cp < 0x10000) {
+      res.push_back((char)(0xE0 | (cp >> 12)));
+      res.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+      res.push_back((char)(0x80 | (cp & 0x3F)));
+    } else {
+      res.push_back((char)(0xF0 | (cp >> 18)));
+      res.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+      res.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+      res.push_back((char)(0x80 | (cp & 0x3F)));
+    }
+    return res;
+  }
+
+  // string literals of C/C++ code, comments and char literals are skipped
+  void addCodeStrings(std::set<char32_t> &glyphs, const std::string &code)
+  {
+    std::string literal{};
+    for(size_t i=0; i<code.size(); ++i)
+    {
+      char c = code[i];
+      if(c == '/' && i+1 < code.size() && code[i+1] == '/') {
+        i = code.find('\n', i);
+        if(i == std::string::npos)break;
+      } else if(c == '/' && i+1 < code.size() && code[i+1] == '*') {
+        i = code.find("*/", i+2);
+        if(i == std::string::npos)break;
+        ++i;
+      } else if(c == '"' || c == '\'') {
+        literal.clear();
+        for(++i; i < code.size() && code[i] != c && code[i] != '\n'; ++i) {
+          if(code[i] == '\\') {
+            if(++i >= code.size())break;
+            // escapes are format or control characters, except for the quoted ones
+            if(code[i] == '\\' || code[i] == '"' || code[i] == '\'')literal.push_back(code[i]);
+            continue;
+          }
+          literal.push_back(code[i]);
+        }
+        if(c == '"')addUTF8(glyphs, literal);
+      }
+    }
+  }
+
+  void addJSONStrings(std::set<char32_t> &glyphs, const nlohmann::json &doc)
+  {
+    if(doc.is_string()) {
+      addUTF8(glyphs, doc.get_ref<const std::string&>());
+    } else if(doc.is_structured()) {
+      for(const auto &child : doc)addJSONStrings(glyphs, child);
+    }
+  }
+
+  /**
+   * Collects all characters that may end up being drawn with a font:
+   * string literals in user code and any text stored in scenes, prefabs and node graphs.
+   * This also picks up names and other text that is never drawn, which only costs a few glyphs.
+   */
+  std::set<char32_t> collectUsedGlyphs(Project::Project &project)
+  {
+    std::set<char32_t> glyphs{};
+    addUTF8(glyphs, ALWAYS_USED_GLYPHS);
+
+    auto projectPath = fs::path{project.getPath()};
+    std::error_code err{};
+    for(const auto &entry : fs::recursive_directory_iterator{projectPath / "src" / "user", err}) {
+      auto ext = entry.path().extension();
+      if(!entry.is_regular_file() || (ext != ".cpp" && ext != ".h" && ext != ".hpp"))continue;
+      addCodeStrings(glyphs, Utils::FS::loadTextFile(entry.path()));
+    }
+
+    std::vector<fs::path> jsonFiles{};
+    for(const auto &entry : fs::recursive_directory_iterator{projectPath / "data" / "scenes", err}) {
+      if(entry.is_regular_file() && entry.path().extension() == ".json")jsonFiles.push_back(entry.path());
+    }
+    for(auto type : {Project::FileType::PREFAB, Project::FileType::NODE_GRAPH}) {
+      for(const auto &asset : project.getAssets().getTypeEntries(type)) {
+        if(!asset.conf.exclude)jsonFiles.push_back(asset.path);
+      }
+    }
+    for(const auto &path : jsonFiles) {
+      auto doc = nlohmann::json::parse(Utils::FS::loadTextFile(path), nullptr, false);
+      if(!doc.is_discarded())addJSONStrings(glyphs, doc);
+    }
+    return glyphs;
+  }
+
+  // glyphs of the charset that are also used, sorted by code-point
+  std::string getSubset(const std::string &charset, const std::set<char32_t> &usedGlyphs)
+  {
+    std::set<char32_t> charsetGlyphs{};
+    addUTF8(charsetGlyphs, charset);
+
+    std::string res{};
+    for(auto cp : charsetGlyphs) {
+      if(usedGlyphs.contains(cp))res += toUTF8(cp);
+    }
+    return res;
+  }
+}
+
 bool Build::buildFontAssets(Project::Project &project, SceneCtx &sceneCtx)
 {
   fs::path mkFont = fs::path{project.conf.pathN64Inst} / "bin" / "mkfont";
   auto &fonts = sceneCtx.project->getAssets().getTypeEntries(Project::FileType::FONT);
+
+  // only scanned if any font needs it, shared by all of them
+  std::set<char32_t> usedGlyphs{};
+  bool glyphsScanned = false;
+
   for (auto &font : fonts)
   {
     auto projectPath = fs::path{project.getPath()};
@@ -29,26 +175,47 @@ bool Build::buildFontAssets(Project::Project &project, SceneCtx &sceneCtx)
       sceneCtx.autoLoadFontUUIDs[fontId] = font.getUUID();
     }
 
-    if(!assetBuildNeeded(font, outPath))continue;
+    auto charset = font.conf.fontCharset.value;
+    if(font.conf.fontCharsetAuto.value && !charset.empty())
+    {
+      if(!glyphsScanned) {
+        usedGlyphs = collectUsedGlyphs(project);
+        glyphsScanned = true;
+      }
+      charset = getSubset(charset, usedGlyphs);
+      // an empty charset means all glyphs of the font, at least keep the space
+      if(charset.empty())charset = " ";
+    }
+
+    // the subset doesn't show up in the settings, so it's part of the key instead
+    if(sceneCtx.cache.isCached(font, outPath, mkFont, charset))continue;
 
     int compr = (int)font.conf.compression - 1;
     if(compr < 0)compr = 1; // @TODO: pull default compression level
 
+    // only exists while the job runs
     fs::path charsetFile{};
-    if(!font.conf.fontCharset.value.empty()) {
+    if(!charset.empty()) {
       charsetFile = outDir / (font.name + "_charset.txt");
-      Utils::FS::saveTextFile(charsetFile, font.conf.fontCharset.value);
     }
 
-    std::string cmd = mkFont.string() + " -c " + std::to_string(compr);
-    cmd += " -o \"" + outDir.string() + "\"";
-    cmd += " -s " + std::to_string(font.conf.baseScale);
-    if(!charsetFile.empty())cmd += " --charset \"" + charsetFile.string() + "\"";
-    cmd += " \"" + font.path + "\"";
+    std::vector<std::string> args{mkFont.string(), "-c", std::to_string(compr)};
+    args.insert(args.end(), {"-o", outDir.string()});
+    args.insert(args.end(), {"-s", std::to_string(font.conf.baseScale)});
+    if(!charsetFile.empty())args.insert(args.end(), {"--charset", charsetFile.string()});
+    args.push_back(font.path);
+
+    if(font.conf.fontCharsetAuto.value) {
+      auto glyphCount = std::count_if(charset.begin(), charset.end(), [](char c) { return (c & 0xC0) != 0x80; });
+      Utils::Logger::log("Font " + font.name + ": " + std::to_string(glyphCount) + " glyphs used");
+    }
 
-    bool res = sceneCtx.toolchain.runCmdSyncLogged(cmd);
-    fs::remove(charsetFile);
-    if(!res)return false;
+    sceneCtx.jobs.add(font.path, [&toolchain = sceneCtx.toolchain, args, charsetFile, charset](std::string &log) {
+      if(!charsetFile.empty())Utils::FS::saveTextFile(charsetFile, charset);
+      bool res = toolchain.runToolSync(args, log);
+      if(!charsetFile.empty())fs::remove(charsetFile);
+      return res;
+    });
   }
   return true;
 }
@@ -0,0 +1,93 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "../utils/fs.h"
+#include "../utils/logger.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // see 'debug/hotReload.h' in the engine
+  constexpr uint32_t PACKET_MAGIC = 0x50363452; // "P64R"
+  constexpr uint16_t PACKET_VERSION = 1;
+  constexpr uint32_t MAX_FILES = 0xFFFF;
+
+  // the whole packet is buffered on the console, anything bigger should be flashed as a ROM instead
+  constexpr uint32_t MAX_PACKET_SIZE = 2 * 1024 * 1024;
+
+  fs::path getStampPath(const fs::path &projectPath) {
+    return projectPath / "build" / "hotReload.stamp";
+  }
+
+  void writeU16(std::string &data, uint16_t value) {
+    data.push_back((char)(value >> 8));
+    data.push_back((char)value);
+  }
+
+  void writeU32(std::string &data, uint32_t value) {
+    for(uint32_t i=0; i<4; ++i)data.push_back((char)(value >> (24 - i*8)));
+  }
+
+  void align4(std::string &data) {
+    data.resize((data.size() + 3) & ~3ull, '\0');
+  }
+}
+
+uint32_t Build::writeHotReloadPacket(const fs::path &projectPath, const fs::path &outPath)
+{
+  // without a known state of the device, everything has to be sent
+  auto stampPath = getStampPath(projectPath);
+  bool hasStamp = fs::exists(stampPath);
+  auto stampTime = hasStamp ? fs::last_write_time(stampPath) : fs::file_time_type{};
+
+  std::string packet{};
+  writeU32(packet, PACKET_MAGIC);
+  writeU16(packet, PACKET_VERSION);
+  writeU16(packet, 0); // file count, set at the end
+
+  uint32_t fileCount = 0;
+  std::error_code err{};
+  auto fsDir = projectPath / "filesystem";
+  for(const auto &entry : fs::recursive_directory_iterator{fsDir, err})
+  {
+    if(!entry.is_regular_file() || (hasStamp && entry.last_write_time() <= stampTime))continue;
+    if(fileCount == MAX_FILES) {
+      Utils::Logger::log("Hot-Reload: too many changed files, upload the ROM instead", Utils::Logger::LEVEL_ERROR);
+      return 0;
+    }
+
+    auto relPath = Utils::FS::toUnixPath(fs::relative(entry.path(), fsDir));
+    auto data = Utils::FS::loadTextFile(entry.path());
+    writeU16(packet, (uint16_t)relPath.size());
+    writeU16(packet, 0);
+    writeU32(packet, (uint32_t)data.size());
+    packet += relPath;
+    align4(packet);
+    packet += data;
+    align4(packet);
+    ++fileCount;
+
+    if(packet.size() > MAX_PACKET_SIZE) {
+      Utils::Logger::log("Hot-Reload: changes exceed " + std::to_string(MAX_PACKET_SIZE / 1024) + "KB, upload the ROM instead", Utils::Logger::LEVEL_ERROR);
+      return 0;
+    }
+  }
+  if(fileCount == 0)return 0;
+
+  packet[6] = (char)(fileCount >> 8);
+  packet[7] = (char)fileCount;
+  Utils::FS::saveTextFile(outPath, packet);
+
+  Utils::Logger::log("Hot-Reload: " + std::to_string(fileCount) + " file(s), " + std::to_string(packet.size() / 1024) + "KB");
+  return fileCount;
+}
+
+void Build::setHotReloadBase(const fs::path &projectPath)
+{
+  auto stampPath = getStampPath(projectPath);
+  Utils::FS::saveTextFile(stampPath, "");
+  fs::last_write_time(stampPath, fs::file_time_type::clock::now());
+}
@@ -0,0 +1,137 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "jobQueue.h"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "../utils/logger.h"
+
+namespace
+{
+  enum class State : uint8_t
+  {
+    PENDING,
+    RUNNING,
+    DONE,
+    FAILED,
+    SKIPPED, // a dependency failed, or another job did before this one started
+  };
+
+  bool isFinished(State state) {
+    return state != State::PENDING && state != State::RUNNING;
+  }
+}
+
+Build::JobQueue::JobId Build::JobQueue::add(const std::string &name, JobFunc func, const std::vector<JobId> &deps)
+{
+  // only earlier jobs can be waited on, which also rules out cycles
+  for([[maybe_unused]] auto dep : deps)assert(dep < jobs.size());
+  jobs.push_back({name, std::move(func), deps});
+  return jobs.size() - 1;
+}
+
+bool Build::JobQueue::run(uint32_t threadCount)
+{
+  times.clear();
+  if(jobs.empty())return true;
+  if(threadCount == 0)threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  threadCount = std::min<uint32_t>(threadCount, jobs.size());
+
+  std::vector<State> states(jobs.size(), State::PENDING);
+  std::vector<std::string> logs(jobs.size());
+  std::vector<double> jobTimes(jobs.size(), 0.0);
+  uint32_t nextLog = 0;
+  uint32_t running = 0;
+  bool failed = false;
+
+  std::mutex mtx{};
+  std::condition_variable cond{};
+
+  // logs everything finished in order, a slow job holds back the output of the ones after it
+  auto flushLogs = [&]() {
+    while(nextLog < jobs.size() && isFinished(states[nextLog])) {
+      if(!logs[nextLog].empty())Utils::Logger::logRaw(logs[nextLog]);
+      if(states[nextLog] == State::FAILED) {
+        Utils::Logger::log("Build step failed: " + jobs[nextLog].name, Utils::Logger::LEVEL_ERROR);
+      }
+      logs[nextLog] = {};
+      ++nextLog;
+    }
+  };
+
+  // first pending job that can start, -1 if none
+  auto findNext = [&]() -> int {
+    for(uint32_t i=nextLog; i<jobs.size(); ++i)
+    {
+      if(states[i] != State::PENDING)continue;
+      if(failed) {
+        states[i] = State::SKIPPED;
+        continue;
+      }
+
+      bool ready = true;
+      for(auto dep : jobs[i].deps) {
+        if(states[dep] == State::DONE)continue;
+        if(isFinished(states[dep]))states[i] = State::SKIPPED;
+        ready = false;
+        break;
+      }
+      if(ready)return (int)i;
+    }
+    return -1;
+  };
+
+  auto worker = [&]()
+  {
+    std::unique_lock lock{mtx};
+    for(;;)
+    {
+      int idx = findNext();
+      if(idx < 0) {
+        // nothing can start, but a running job may unblock something
+        if(running == 0)break;
+        cond.wait(lock);
+        continue;
+      }
+
+      states[idx] = State::RUNNING;
+      ++running;
+      lock.unlock();
+
+      std::string log{};
+      auto timeStart = std::chrono::steady_clock::now();
+      bool success = jobs[idx].func(log);
+      auto timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - timeStart).count();
+
+      lock.lock();
+      jobTimes[idx] = timeMs;
+      --running;
+      logs[idx] = std::move(log);
+      states[idx] = success ? State::DONE : State::FAILED;
+      if(!success)failed = true;
+      flushLogs();
+      cond.notify_all();
+    }
+    cond.notify_all();
+  };
+
+  std::vector<std::thread> threads{};
+  for(uint32_t t=1; t<threadCount; ++t)threads.emplace_back(worker);
+  worker();
+  for(auto &t : threads)t.join();
+
+  flushLogs();
+  bool success = std::all_of(states.begin(), states.end(), [](State s) { return s == State::DONE; });
+  for(uint32_t i=0; i<jobs.size(); ++i) {
+    if(states[i] == State::DONE || states[i] == State::FAILED)times.push_back({jobs[i].name, jobTimes[i]});
+  }
+  jobs.clear();
+  return success;
+}
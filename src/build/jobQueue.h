@@ -0,0 +1,63 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Build
+{
+  /**
+   * Runs independent build steps (e.g. asset conversions) on multiple threads.
+   * Jobs start once all their dependencies are done, in the order they were added otherwise.
+   * Output is collected per job and logged in that same order, so it reads like a serial build.
+   */
+  class JobQueue
+  {
+    public:
+      typedef uint32_t JobId;
+      /**
+       * Function doing the actual work, called on a worker thread.
+       * @param log output of the job, logged once it and all jobs added before it are done
+       * @return false if the job failed, no new jobs are started after that
+       */
+      typedef std::function<bool(std::string &log)> JobFunc;
+
+    private:
+      struct Job
+      {
+        std::string name{};
+        JobFunc func{};
+        std::vector<JobId> deps{};
+      };
+
+      std::vector<Job> jobs{};
+      std::vector<std::pair<std::string, double>> times{};
+
+    public:
+      /**
+       * Adds a job, nothing runs until 'run()' is called.
+       * @param name shown in the log
+       * @param deps jobs that have to finish successfully before this one starts
+       * @return id to use as a dependency of later jobs
+       */
+      JobId add(const std::string &name, JobFunc func, const std::vector<JobId> &deps = {});
+
+      /**
+       * Runs all jobs added so far and waits for them, the queue is empty afterward.
+       * @param threadCount worker count, 0 to use all cores
+       * @return false if any job failed (or depended on one that did)
+       */
+      bool run(uint32_t threadCount = 0);
+
+      [[nodiscard]] bool empty() const { return jobs.empty(); }
+
+      /**
+       * Durations (ms) of the jobs of the last 'run()' that finished, in the order they were added.
+       */
+      [[nodiscard]] const std::vector<std::pair<std::string, double>>& getTimes() const { return times; }
+  };
+}
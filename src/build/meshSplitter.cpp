@@ -0,0 +1,117 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "glm/glm.hpp"
+
+#include <algorithm>
+
+namespace
+{
+  // meshes above this get split, parts end up with at most this many triangles
+  constexpr uint32_t SPLIT_MAX_TRIS = 1024;
+
+  // a BVH only pays off if there are enough objects spread out far enough to skip some of them
+  constexpr uint32_t BVH_MIN_OBJECTS = 4;
+  constexpr uint32_t BVH_MIN_TRIS = 1000;
+  constexpr float BVH_MIN_SPREAD = 3.0f; // model extent relative to the average object extent
+
+  using Model = decltype(T3DM::T3DMData::models)::value_type;
+  using Triangle = decltype(Model::triangles)::value_type;
+
+  glm::vec3 getCenter(const Triangle &tri)
+  {
+    glm::vec3 res{};
+    for(auto &vert : tri.vert)res += glm::vec3{vert.pos[0], vert.pos[1], vert.pos[2]};
+    return res / 3.0f;
+  }
+
+  Utils::AABB getBounds(const std::vector<Triangle> &triangles)
+  {
+    Utils::AABB res{};
+    for(auto &tri : triangles) {
+      for(auto &vert : tri.vert)res.addPoint({vert.pos[0], vert.pos[1], vert.pos[2]});
+    }
+    return res;
+  }
+
+  /**
+   * Halves the triangles at the median of their centers along the longest axis, until each part is small enough.
+   * Parts are appended in order, so they stay next to each other and share the material state.
+   */
+  void splitTriangles(std::vector<Triangle> tris, std::vector<std::vector<Triangle>> &parts)
+  {
+    if(tris.size() <= SPLIT_MAX_TRIS) {
+      parts.push_back(std::move(tris));
+      return;
+    }
+
+    Utils::AABB centers{};
+    for(auto &tri : tris)centers.addPoint(getCenter(tri));
+    auto ext = centers.max - centers.min;
+    int axis = (ext.x >= ext.y && ext.x >= ext.z) ? 0 : (ext.y >= ext.z ? 1 : 2);
+
+    auto mid = tris.begin() + (tris.size() / 2);
+    std::nth_element(tris.begin(), mid, tris.end(), [axis](const Triangle &a, const Triangle &b) {
+      return getCenter(a)[axis] < getCenter(b)[axis];
+    });
+
+    std::vector<Triangle> upper(mid, tris.end());
+    tris.erase(mid, tris.end());
+    splitTriangles(std::move(tris), parts);
+    splitTriangles(std::move(upper), parts);
+  }
+}
+
+uint32_t Build::splitLargeMeshes(T3DM::T3DMData &t3dm)
+{
+  // bones can move parts of a mesh anywhere, splitting by position doesn't help culling
+  if(!t3dm.skeletons.empty())return 0;
+
+  uint32_t added = 0;
+  std::vector<Model> res{};
+  res.reserve(t3dm.models.size());
+  for(auto &model : t3dm.models)
+  {
+    if(model.triangles.size() <= SPLIT_MAX_TRIS) {
+      res.push_back(std::move(model));
+      continue;
+    }
+
+    std::vector<std::vector<Triangle>> parts{};
+    splitTriangles(std::move(model.triangles), parts);
+    added += parts.size() - 1;
+
+    // keeps the name, so mesh filters still match all parts
+    for(auto &part : parts) {
+      auto &newModel = res.emplace_back(model);
+      newModel.triangles = std::move(part);
+    }
+  }
+  t3dm.models = std::move(res);
+  return added;
+}
+
+bool Build::needsBVH(const Project::AssetManagerEntry &model)
+{
+  if(model.conf.gltfBVH)return true;
+  const auto &t3dm = model.t3dmData;
+  if(!model.conf.gltfBVHAuto.value || !t3dm.skeletons.empty())return false;
+  if(t3dm.models.size() < BVH_MIN_OBJECTS)return false;
+
+  uint32_t triCount = 0;
+  Utils::AABB bounds{};
+  float objExtent = 0.0f;
+  for(auto &obj : t3dm.models) {
+    triCount += obj.triangles.size();
+    auto objBounds = getBounds(obj.triangles);
+    bounds.addPoint(objBounds.min);
+    bounds.addPoint(objBounds.max);
+    objExtent += glm::length(objBounds.max - objBounds.min);
+  }
+  if(triCount < BVH_MIN_TRIS)return false;
+
+  objExtent /= t3dm.models.size();
+  return glm::length(bounds.max - bounds.min) >= objExtent * BVH_MIN_SPREAD;
+}
@@ -5,8 +5,11 @@
 #include "projectBuilder.h"
 #include "../utils/string.h"
 #include "../utils/fs.h"
+#include "../utils/hash.h"
 #include <filesystem>
 
+#include "json.hpp"
+
 #include "../project/graph/graph.h"
 
 namespace fs = std::filesystem;
@@ -31,9 +34,18 @@ bool Build::buildNodeGraphAssets(Project::Project &project, SceneCtx &sceneCtx)
     sceneCtx.files.push_back(Utils::FS::toUnixPath(asset.outPath));
     sceneCtx.graphFunctions.push_back(asset.getUUID());
 
+    // needed for the function table even if the graph itself is up to date
+    auto json = Utils::FS::loadTextFile(asset.path);
+    auto jsonDoc = nlohmann::json::parse(json, nullptr, false);
+    if(!jsonDoc.is_discarded() && jsonDoc.contains("nodes")) {
+      for(auto &node : jsonDoc["nodes"]) {
+        auto funcName = node.value("funcName", "");
+        if(!funcName.empty())sceneCtx.graphUserFuncs.insert(Utils::Hash::crc32(funcName));
+      }
+    }
+
     if(!assetBuildNeeded(asset, outPath) && fs::exists(sourceOutPath))continue;
 
-    auto json = Utils::FS::loadTextFile(asset.path);
     Project::Graph::Graph graph{};
     graph.deserialize(json);
 
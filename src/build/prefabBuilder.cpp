@@ -25,11 +25,19 @@ bool Build::buildPrefabAssets(Project::Project &project, SceneCtx &sceneCtx)
     fs::create_directories(outPath.parent_path());
 
     sceneCtx.files.push_back(Utils::FS::toUnixPath(asset.outPath));
-    if(!assetBuildNeeded(asset, outPath))continue;
+
+    // pool-size is stored in the asset settings, so those can trigger a rebuild too
+    bool confChanged = Utils::FS::getFileAge(asset.path + ".conf") > Utils::FS::getFileAge(outPath);
+    if(!confChanged && !assetBuildNeeded(asset, outPath))continue;
 
     //printf("Prefab: %s -> %s\n", asset.path.c_str(), outPath.string().c_str());
 
     sceneCtx.fileObj = {};
+    // header
+    uint32_t poolSize = asset.conf.prefabPoolSize.value;
+    sceneCtx.fileObj.write<uint16_t>(poolSize > 0xFFFF ? 0xFFFF : poolSize);
+    sceneCtx.fileObj.write<uint16_t>(0); // padding
+
     writeObject(sceneCtx, asset.prefab->obj, true);
     sceneCtx.fileObj.writeToFile(outPath);
     sceneCtx.fileObj = {};
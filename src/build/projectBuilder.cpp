@@ -4,9 +4,13 @@
 */
 #include "projectBuilder.h"
 
+#include <algorithm>
 #include <filesystem>
+#include <set>
 #include <thread>
+#include <unordered_map>
 #include "../utils/fs.h"
+#include "../utils/hash.h"
 #include "../utils/logger.h"
 #include "../utils/proc.h"
 #include "../utils/string.h"
@@ -27,9 +31,126 @@ namespace
     {Build::buildT3DMAssets,    "3D Model"},
     {Build::buildFontAssets,    "Font"},
     {Build::buildTextureAssets, "Texture"},
+    {Build::buildAtlasAssets,   "Atlas"},
     {Build::buildAudioAssets,   "Audio"},
     {Build::buildPrefabAssets,  "Prefab"},
   });
+
+  constexpr const char* MAKEFILE_HEADER = "# AUTOGENERATED, included by 'Makefile'\n";
+  constexpr const char* TIMING_REPORT_FILE = "build/buildTimes.json";
+
+  // reports the timings on any exit of 'buildProject', failed builds are often the interesting ones
+  struct TimingReportWriter
+  {
+    Build::SceneCtx &ctx;
+    fs::path path;
+
+    ~TimingReportWriter() {
+      ctx.report.save(path);
+      ctx.report.logSummary();
+    }
+  };
+
+  // keeps the file date if nothing changed, so make doesn't see it as modified
+  bool saveIfChanged(const fs::path &filePath, const std::string &content)
+  {
+    if(Utils::FS::loadTextFile(filePath) == content)return false;
+    Utils::FS::saveTextFile(filePath, content);
+    return true;
+  }
+
+  /**
+   * Finds asset outputs with identical content (e.g. the same texture imported twice, or equal collision meshes)
+   * and points the asset-table entries of all but the first one at that file.
+   * The files of the others stay where they are for the caches, they are left out of the DFS instead (see 'assets_dedup').
+   * @return removed files, relative to the project
+   */
+  std::set<std::string> dedupAssets(const Project::Project &project, Build::SceneCtx &ctx)
+  {
+    auto projectPath = fs::path{project.getPath()};
+    std::unordered_map<uint64_t, std::string> pathByHash{};
+    std::unordered_map<std::string, std::string> redirects{};
+    std::set<std::string> checked{};
+    std::set<std::string> removed{};
+    uint64_t savedBytes = 0;
+
+    for(auto &asset : ctx.assetList)
+    {
+      if(asset.path.size() <= 5)continue;
+      if(auto it = redirects.find(asset.path); it != redirects.end()) {
+        asset.path = it->second;
+        continue;
+      }
+      if(!checked.insert(asset.path).second)continue;
+
+      auto relPath = "filesystem/" + asset.path.substr(5); // remove "rom:/"
+      auto filePath = projectPath / relPath;
+      std::error_code err{};
+      auto size = fs::file_size(filePath, err);
+      if(err)continue;
+
+      // streaming data is loaded by tiny3d from a path next to the model, so those have to stay separate
+      bool hasStreamData = false;
+      auto prefix = filePath.stem().string();
+      for(const auto &entry : fs::directory_iterator{filePath.parent_path(), err}) {
+        if(entry.path().extension() == ".sdata" && entry.path().filename().string().starts_with(prefix)) {
+          hasStreamData = true;
+          break;
+        }
+      }
+      if(hasStreamData)continue;
+
+      Utils::Hash::XXH64 hash{};
+      hash.update(&asset.type, sizeof(asset.type));
+      hash.updateFile(filePath);
+
+      auto [it, inserted] = pathByHash.try_emplace(hash.digest(), asset.path);
+      if(inserted)continue;
+
+      Utils::Logger::log("Asset has the same content as " + it->second + ", stored once: " + asset.path);
+      redirects[asset.path] = it->second;
+      removed.insert(relPath);
+      savedBytes += size;
+      asset.path = it->second;
+    }
+
+    // identical paths share their string in the table
+    std::unordered_map<std::string, uint32_t> stringOffsets{};
+    ctx.stringOffset = 0;
+    for(auto &asset : ctx.assetList) {
+      auto [it, inserted] = stringOffsets.try_emplace(asset.path, ctx.stringOffset);
+      if(inserted)ctx.stringOffset += asset.path.size() + 1;
+      asset.stringOffset = it->second;
+    }
+
+    if(!removed.empty()) {
+      Utils::Logger::log("Deduplicated " + std::to_string(removed.size()) + " files, saved "
+        + std::to_string(savedBytes / 1024) + " KB");
+    }
+    return removed;
+  }
+
+  /**
+   * Builds an open-addressing hash table (linear probing) for runtime lookups by name.
+   * The table has at least twice as many slots as keys, each slot stores the value + 1,
+   * with 0 marking an empty slot. The engine has to use the same hash (CRC32) and probing.
+   * @param keys pairs of name-hash and value
+   * @return slots, the size is always a power of two
+   */
+  std::vector<uint16_t> buildHashTable(const std::vector<std::pair<uint32_t, uint16_t>> &keys)
+  {
+    uint32_t size = 1;
+    while(size < keys.size()*2)size <<= 1;
+    uint32_t mask = size - 1;
+
+    std::vector<uint16_t> slots(size, 0);
+    for(auto &[hash, value] : keys) {
+      uint32_t idx = hash & mask;
+      while(slots[idx] != 0)idx = (idx + 1) & mask;
+      slots[idx] = value + 1;
+    }
+    return slots;
+  }
 }
 
 void Build::SceneCtx::addAsset(const Project::AssetManagerEntry &entry)
@@ -38,6 +159,7 @@ void Build::SceneCtx::addAsset(const Project::AssetManagerEntry &entry)
   if(entry.romPath.size() > 5) {
     auto outNameNoPrefix = entry.romPath.substr(5); // remove "rom:/"
     assetFileMap += "if(path == \"" + outNameNoPrefix + "\")return " + std::to_string(assetList.size()) + ";\n";
+    assetHashes.push_back({Utils::Hash::crc32(outNameNoPrefix), (uint16_t)assetList.size()});
   }
 
   uint32_t flags = 0;
@@ -45,14 +167,52 @@ void Build::SceneCtx::addAsset(const Project::AssetManagerEntry &entry)
     flags |= 0x01; // KEEP_LOADED
   }
 
-  assetList.push_back({entry.romPath, stringOffset, (uint32_t)entry.type, flags});
+  assetList.push_back({entry.romPath, stringOffset, (uint32_t)entry.type, flags, entry.getUUID()});
   stringOffset += entry.romPath.size() + 1;
 }
 
+void Build::SceneCtx::addAtlas(const Atlas &atlas)
+{
+  Project::AssetManagerEntry entry{
+    .romPath = atlas.romPath,
+    .type = AT::IMAGE,
+  };
+  entry.conf.uuid = atlas.uuid;
+  addAsset(entry);
+
+  auto idx = std::to_string(assetList.size() - 1);
+  for(auto &region : atlas.regions)
+  {
+    assetUUIDToIdx[region.uuid] = assetList.size() - 1;
+    auto outNameNoPrefix = region.romPath.substr(5); // remove "rom:/"
+    assetFileMap += "if(path == \"" + outNameNoPrefix + "\")return " + idx + ";\n";
+    assetHashes.push_back({Utils::Hash::crc32(outNameNoPrefix), (uint16_t)(assetList.size() - 1)});
+    atlasRegionMap += "if(path == \"" + outNameNoPrefix + "\")return {"
+      + std::to_string(region.x) + ", " + std::to_string(region.y) + ", "
+      + std::to_string(region.width) + ", " + std::to_string(region.height) + "};\n";
+  }
+}
+
+std::unordered_map<uint64_t, uint32_t>::iterator Build::SceneCtx::findAsset(uint64_t uuid)
+{
+  sceneDeps.insert(uuid);
+  auto res = assetUUIDToIdx.find(uuid);
+  if(res != assetUUIDToIdx.end())sceneAssets.insert(res->second);
+  return res;
+}
+
 bool Build::buildProject(const std::string &configPath)
 {
   Project::Project project{configPath};
+  Utils::Toolchain toolchain{};
+  toolchain.scan();
+  return buildProject(project, toolchain);
+}
+
+bool Build::buildProject(Project::Project &project, const Utils::Toolchain &toolchain)
+{
   auto path = project.getPath();
+  const auto &configPath = project.getConfigPath();
   Utils::Logger::log("Building project...");
 
   if(project.conf.pathN64Inst.empty())
@@ -92,47 +252,86 @@ bool Build::buildProject(const std::string &configPath)
   }
 
   SceneCtx sceneCtx{};
-  sceneCtx.toolchain.scan();
+  TimingReportWriter reportWriter{sceneCtx, fs::path{path} / TIMING_REPORT_FILE};
+  auto timerSetup = sceneCtx.report.phase("Setup");
+  sceneCtx.toolchain = toolchain;
   sceneCtx.project = &project;
+  sceneCtx.cache.load(project);
 
   // Global project config
   sceneCtx.files.push_back("filesystem/p64/conf");
 
+  // input recording saved from the profiler, replayed at boot by builds with 'P64_INPUT_REPLAY=1'
+  {
+    auto replayPath = fs::path{path} / "data" / "input.replay";
+    auto replayOutPath = fsDataPath / "input.replay";
+    std::error_code err{};
+    if (fs::exists(replayPath)) {
+      fs::copy_file(replayPath, replayOutPath, fs::copy_options::overwrite_existing, err);
+      if (err) {
+        Utils::Logger::log("Failed to copy input replay: " + err.message(), Utils::Logger::LEVEL_ERROR);
+      } else {
+        sceneCtx.files.push_back("filesystem/p64/input.replay");
+      }
+    } else {
+      fs::remove(replayOutPath, err);
+    }
+  }
+
   // Asset-Manager
+  assignAtlases(project, sceneCtx);
   for (auto &typed : project.getAssets().getEntries()) {
     for (auto &entry : typed) {
       if (entry.conf.exclude || entry.type == Project::FileType::UNKNOWN) continue;
+      if (sceneCtx.atlasOfImage.contains(entry.getUUID())) continue;
       sceneCtx.addAsset(entry);
     }
   }
+  for (auto &atlas : sceneCtx.atlases) {
+    sceneCtx.addAtlas(atlas);
+  }
 
   // User scripts
   auto userDirs = Utils::FS::scanDirs(path + "/src/user");
-  std::string userCodeRules = "";
+  std::string userCodeRules = MAKEFILE_HEADER;
   for (const auto &dir : userDirs) {
     userCodeRules += "src += $(wildcard src/user/" + dir + "/*.cpp)\n";
   }
 
+  timerSetup.stop();
+
+  auto timerGraphs = sceneCtx.report.phase("Node Graphs");
   if(!buildNodeGraphAssets(project, sceneCtx)) {
     Utils::Logger::log(std::string("Graph-Asset build failed!", Utils::Logger::LEVEL_ERROR));
     return false;
   }
 
+  timerGraphs.stop();
+
   // Scripts
+  auto timerScripts = sceneCtx.report.phase("Scripts");
   buildGlobalScripts(project, sceneCtx);
-  buildScripts(project, sceneCtx);
+  assignScriptIndices(project, sceneCtx);
+  timerScripts.stop();
 
   // Scenes
+  auto timerScenes = sceneCtx.report.phase("Scenes");
+  assignTextureGroups(project, sceneCtx);
   project.getScenes().reload();
   const auto &scenes = project.getScenes().getEntries();
 
   std::string sceneMapStr{};
   std::string sceneNameStr{};
+  std::string sceneIdStr{};
+  std::vector<std::pair<uint32_t, uint16_t>> sceneHashes{};
   for (const auto &scene : scenes) {
     sceneMapStr += "if(path == \"" + scene.name + "\")return " + std::to_string(scene.id) + ";\n";
+    sceneHashes.push_back({Utils::Hash::crc32(scene.name), (uint16_t)sceneHashes.size()});
     sceneNameStr += "\"" + scene.name + "\",\n";
+    sceneIdStr += std::to_string(scene.id) + ",";
     try
     {
+      auto timerScene = sceneCtx.report.asset("Scene " + std::to_string(scene.id) + ": " + scene.name);
       buildScene(project, scene, sceneCtx);
     } catch(const std::exception &e)
     {
@@ -147,41 +346,89 @@ bool Build::buildProject(const std::string &configPath)
   });
   Utils::FS::saveTextFile(project.getPath() + "/src/p64/sceneTable.h", sceneTableHeader);
 
+  // hash table for lookups by name at runtime, slots point into 'SCENE_NAMES' / 'SCENE_IDS'
+  auto sceneSlots = buildHashTable(sceneHashes);
+  std::string sceneSlotStr{};
+  for(auto slot : sceneSlots)sceneSlotStr += std::to_string(slot) + ",";
+
   Utils::FS::saveTextFile(project.getPath() + "/src/p64/sceneTable.cpp",
     "#include \"sceneTable.h\"\n"
     "\n"
     "namespace P64::SceneManager {\n"
     "  const char* SCENE_NAMES["+std::to_string(scenes.size())+"] = {\n" + sceneNameStr + "};\n"
+    "  const uint16_t SCENE_IDS["+std::to_string(scenes.size())+"] = {" + sceneIdStr + "};\n"
+    "  const uint32_t SCENE_HASH_MASK = " + std::to_string(sceneSlots.size()-1) + ";\n"
+    "  const uint16_t SCENE_HASH_SLOTS["+std::to_string(sceneSlots.size())+"] = {" + sceneSlotStr + "};\n"
     "}\n"
   );
 
 
+  timerScenes.stop();
+
+  auto timerScriptTable = sceneCtx.report.phase("Script Table");
+  userCodeRules += buildScripts(project, sceneCtx);
+  userCodeRules += buildUnitySources(project, sceneCtx);
+  timerScriptTable.stop();
+
   for(auto &builder : assetBuilders)
   {
+    auto timerBuilder = sceneCtx.report.phase(builder.name);
     if(!builder.func(project, sceneCtx)) {
       Utils::Logger::log(std::string(builder.name) + " Asset build failed!", Utils::Logger::LEVEL_ERROR);
       return false;
     }
   }
 
+  // conversions queued by the builders above, independent of each other
+  auto timerJobs = sceneCtx.report.phase("Conversions");
+  bool jobsSuccess = sceneCtx.jobs.run();
+  for(auto &[name, timeMs] : sceneCtx.jobs.getTimes()) {
+    sceneCtx.report.addAsset(name, timeMs);
+  }
+  if(!jobsSuccess) {
+    Utils::Logger::log("Asset build failed!", Utils::Logger::LEVEL_ERROR);
+    return false;
+  }
+  sceneCtx.cache.storePending();
+  timerJobs.stop();
+
+  auto timerDedup = sceneCtx.report.phase("Deduplication");
+  sceneCtx.dedupFiles = dedupAssets(project, sceneCtx);
+  timerDedup.stop();
+
+  auto timerFiles = sceneCtx.report.phase("Project Files");
+
   auto assetTableCode = Utils::replaceAll(
-    Utils::FS::loadTextFile("data/scripts/assetTable.h"),
-    "{{ASSET_MAP}}", sceneCtx.assetFileMap
+    Utils::FS::loadTextFile("data/scripts/assetTable.h"), {
+      {"{{ASSET_MAP}}", sceneCtx.assetFileMap},
+      {"{{ATLAS_MAP}}", sceneCtx.atlasRegionMap},
+    }
   );
   Utils::FS::saveTextFile(project.getPath() + "/src/p64/assetTable.h", assetTableCode);
 
-  // Asset table
+  // Asset table: header, entries, path hash-table, strings
+  auto assetSlots = buildHashTable(sceneCtx.assetHashes);
+  uint32_t slotsSize = (assetSlots.size() * sizeof(uint16_t) + 3) & ~3u;
+
   Utils::BinaryFile fileList{};
   fileList.write<uint32_t>(sceneCtx.assetList.size());
-  uint32_t baseOffset = (sceneCtx.assetList.size() * sizeof(uint32_t)*2) + sizeof(uint32_t);
+  fileList.write<uint32_t>(assetSlots.size() - 1);
+  uint32_t baseOffset = (sceneCtx.assetList.size() * sizeof(uint32_t)*2) + sizeof(uint32_t)*2 + slotsSize;
   for (auto &entry : sceneCtx.assetList) {
     fileList.write(baseOffset + entry.stringOffset);
     uint32_t ptr = entry.type << (32-4);
     ptr |= entry.flags << (32-8);
     fileList.write(ptr);
   }
+  for (auto slot : assetSlots) {
+    fileList.write<uint16_t>(slot);
+  }
+  fileList.align(4);
+  uint32_t stringPos = 0;
   for (auto &entry : sceneCtx.assetList) {
+    if(entry.stringOffset != stringPos)continue; // shared with an earlier entry
     fileList.writeChars(entry.path.c_str(), entry.path.size()+1);
+    stringPos += entry.path.size()+1;
   }
   fileList.writeToFile(fsDataPath / "a");
 
@@ -196,18 +443,22 @@ bool Build::buildProject(const std::string &configPath)
       {"{{N64_INST}}",          project.conf.pathN64Inst},
       {"{{ROM_NAME}}",          project.conf.romName},
       {"{{PROJECT_NAME}}",      project.conf.name},
-      {"{{ASSET_LIST}}",        Utils::join(filesSorted, " ")},
-      {"{{USER_CODE_DIRS}}",    userCodeRules},
       {"{{P64_SELF_PATH}}",     Utils::Proc::getSelfPath()},
       {"{{PROJECT_SELF_PATH}}", fs::absolute(configPath).string()},
     }
   );
 
-  auto mkPath = fs::absolute(path) / "Makefile";
-  auto oldMakefile = Utils::FS::loadTextFile(mkPath);
-  if (makefile != oldMakefile) {
+  // only the main makefile affects how code is compiled, new code-dirs or assets just add/remove files
+  bool makefilesChanged = saveIfChanged(fs::absolute(path) / "Makefile.code", userCodeRules);
+  std::vector<std::string> dedupFiles{sceneCtx.dedupFiles.begin(), sceneCtx.dedupFiles.end()};
+  makefilesChanged |= saveIfChanged(fs::absolute(path) / "Makefile.assets",
+    MAKEFILE_HEADER + std::string{"assets_conv = "} + Utils::join(filesSorted, " ") + "\n"
+    + "assets_dedup = " + Utils::join(dedupFiles, " ") + "\n"
+  );
+
+  if (saveIfChanged(fs::absolute(path) / "Makefile", makefile)) {
+    makefilesChanged = true;
     Utils::Logger::log("Makefile changed, clean build");
-    Utils::FS::saveTextFile(mkPath, makefile);
     sceneCtx.toolchain.runCmdSyncLogged("make -C \"" + path + "\" cleanCode");
   }
 
@@ -222,10 +473,25 @@ bool Build::buildProject(const std::string &configPath)
     f.writeToFile(fsDataPath / "conf");
   }
 
+  timerFiles.stop();
+
   // Build
-  bool success = sceneCtx.toolchain.runCmdSyncLogged("make -C \"" + path + "\" -j8");
+  auto timerMake = sceneCtx.report.phase("Make");
+  uint32_t makeJobs = std::max(std::thread::hardware_concurrency(), 1u);
+  std::string makeCmd = "make -C \"" + path + "\" -j" + std::to_string(makeJobs);
+
+  // assets converted by make itself (see 'Makefile.custom') have to be there before patching
+  bool success = project.conf.fastRepack && !makefilesChanged
+    && sceneCtx.toolchain.runCmdSyncLogged(makeCmd + " assets")
+    && patchRom(fs::absolute(path), project.conf.romName, sceneCtx.dedupFiles);
+
+  if(!success)success = sceneCtx.toolchain.runCmdSyncLogged(makeCmd);
+  timerMake.stop();
 
   if(success) {
+    auto timerRomReport = sceneCtx.report.phase("ROM Report");
+    writeRomReport(project, sceneCtx);
+    timerRomReport.stop();
     Utils::Logger::log("Build done!");
   } else {
     Utils::Logger::log("Build failed!", Utils::Logger::LEVEL_ERROR);
@@ -6,6 +6,9 @@
 #include <filesystem>
 #include "sceneContext.h"
 #include "../project/project.h"
+#include "../utils/aabb.h"
+#include "../utils/frustum.h"
+#include "../utils/textureFormats.h"
 
 namespace Build
 {
@@ -16,21 +19,66 @@ namespace Build
 
   // Asset builds
   void buildScene(Project::Project &project, const Project::SceneEntry &scene, SceneCtx &ctx);
-  void buildScripts(Project::Project &project, SceneCtx &sceneCtx);
+  // fills 'codeIdxMapUUID', needed before building any scene
+  void assignScriptIndices(Project::Project &project, SceneCtx &sceneCtx);
+  /**
+   * Generates the script table, and the per-scene overlays if enabled (see 'ProjectConf::scriptOverlays').
+   * Call after all scenes were built, since overlays depend on the scripts each scene uses.
+   * @return Makefile rules of the overlays, empty if there are none
+   */
+  std::string buildScripts(Project::Project &project, SceneCtx &sceneCtx);
+  /**
+   * Groups user scripts and generated node graphs into a few sources including them ('src/p64/unity'),
+   * optionally with a precompiled header of the engine. Scripts in overlays are still compiled on their own.
+   * Call after 'buildScripts' and 'buildNodeGraphAssets'.
+   * @return Makefile rules, empty if turned off (see 'ProjectConf::unityBuild')
+   */
+  std::string buildUnitySources(Project::Project &project, SceneCtx &sceneCtx);
   void buildGlobalScripts(Project::Project &project, SceneCtx &sceneCtx);
 
   bool buildT3DMAssets(Project::Project &project, SceneCtx &sceneCtx);
+  // fills 'SceneCtx::textureGroups', has to run before any scene is built
+  void assignTextureGroups(Project::Project &project, SceneCtx &sceneCtx);
   bool buildFontAssets(Project::Project &project, SceneCtx &sceneCtx);
   bool buildTextureAssets(Project::Project &project, SceneCtx &sceneCtx);
+  // fills 'SceneCtx::atlases' from the atlas-groups of images, has to run before assets are added
+  void assignAtlases(Project::Project &project, SceneCtx &sceneCtx);
+  bool buildAtlasAssets(Project::Project &project, SceneCtx &sceneCtx);
   bool buildAudioAssets(Project::Project &project, SceneCtx &sceneCtx);
   bool buildPrefabAssets(Project::Project &project, SceneCtx &sceneCtx);
   bool buildNodeGraphAssets(Project::Project &project, SceneCtx &sceneCtx);
 
   bool buildProject(const std::string &path);
+  // same as above, with an already loaded project and a scanned toolchain (see 'Build::Server')
+  bool buildProject(Project::Project &project, const Utils::Toolchain &toolchain);
+
+  /**
+   * Writes changed asset files directly into the DFS image and the ROM of the last build, skipping 'mkdfs' and the relink.
+   * Only possible if the code didn't change and each file still fits into the space of its old version.
+   * @param dedupFiles files left out of the DFS, see 'SceneCtx::dedupFiles'
+   * @return false if a full 'make' is needed instead, nothing is modified in that case
+   */
+  bool patchRom(const fs::path &projectPath, const std::string &romName, const std::set<std::string> &dedupFiles);
+
+  /**
+   * Collects all files of the project filesystem changed since the last upload or hot-reload into one packet,
+   * the format is described in 'debug/hotReload.h' of the engine.
+   * @return number of files written into the packet, 0 if nothing changed (no packet is written then)
+   */
+  uint32_t writeHotReloadPacket(const fs::path &projectPath, const fs::path &outPath);
+
+  // marks the current filesystem as the state of the device, called after a ROM or packet got sent
+  void setHotReloadBase(const fs::path &projectPath);
 
   // individual parts
   uint32_t writeObject(SceneCtx &ctx, Project::Object &obj, bool savePrefabItself = false);
 
+  /**
+   * Collects the world-space bounds of all culling volumes in the subtree of an object.
+   * @return false if no child has a culling volume
+   */
+  bool getGroupBounds(SceneCtx &ctx, Project::Object &obj, Utils::AABB &bounds);
+
   bool buildT3DCollision(
     Project::Project &project, SceneCtx &sceneCtx,
     const std::unordered_set<std::string> &meshes,
@@ -38,5 +86,188 @@ namespace Build
     uint64_t newUUID
   );
 
-  Utils::BinaryFile buildCollision(const std::string &gltfPath, float baseScale, const std::unordered_set<std::string> &meshes = {});
+  /**
+   * Result of trying all compression levels of an asset, see 'analyzeCompression()'.
+   */
+  struct CompressionStats
+  {
+    static constexpr uint32_t LEVEL_COUNT = 4;
+    std::array<uint32_t, LEVEL_COUNT> sizes{}; // file size in bytes, per level (0 = uncompressed)
+
+    // estimated time of reading and decompressing the asset
+    [[nodiscard]] float estimateLoadTimeUs(uint32_t level) const;
+
+    // smallest level that doesn't load noticeably slower than the fastest one
+    [[nodiscard]] Project::ComprTypes getRecommended() const;
+  };
+
+  /**
+   * Compresses an already built asset with every level to compare the resulting sizes.
+   * @return false if the asset type doesn't support it or it wasn't built yet
+   */
+  bool analyzeCompression(
+    Project::Project &project, Utils::Toolchain &toolchain,
+    const Project::AssetManagerEntry &asset, CompressionStats &stats
+  );
+
+  /**
+   * Estimated runtime cost of a sound with each codec ('AssetConf::wavCompression'), see 'analyzeAudioCost()'.
+   * Decoding happens while the mixer plays it, on top of the mixing itself which costs the same for all codecs.
+   */
+  struct AudioCostStats
+  {
+    static constexpr uint32_t CODEC_COUNT = 3; // none, VADPCM, Opus
+    uint32_t sampleRate{}; // after resampling
+    uint32_t channels{}; // after downmixing
+    float durationSec{};
+
+    // decode time per frame (at 60 FPS) while it plays
+    [[nodiscard]] float estimateDecodeUs(uint32_t codec) const;
+    [[nodiscard]] uint32_t estimateSize(uint32_t codec) const;
+
+    // short sounds are cheap to keep uncompressed, music is long enough to be worth the heavier codec
+    [[nodiscard]] uint32_t getRecommended() const;
+  };
+
+  /**
+   * Reads the length and format of a sound from its source, with the resampling and downmixing of its settings applied.
+   * @return false if it's not an uncompressed WAV file (e.g. XM/YM modules)
+   */
+  bool analyzeAudioCost(const Project::AssetManagerEntry &asset, AudioCostStats &stats);
+
+  /**
+   * Size and quality of an image in each texture format, see 'analyzeTextureFormat()'.
+   */
+  struct TextureFormatStats
+  {
+    struct Entry
+    {
+      Utils::TexFormat format{};
+      uint32_t size{}; // bytes of texels and palette
+      float psnr{}; // compared to the source, 99 if lossless
+    };
+
+    std::vector<Entry> entries{}; // sorted by size
+    Utils::TexFormat recommended{};
+  };
+
+  /**
+   * Converts an image into all CI, I, IA and RGBA formats to pick the smallest with good enough quality.
+   * Used for images set to 'Auto', any other format set in the asset overrides it.
+   * @return false if the image can't be read
+   */
+  bool analyzeTextureFormat(const std::string &pngPath, TextureFormatStats &stats);
+
+  /**
+   * Runs 'analyzeCompression()' for all assets of a project and logs the results.
+   * @param apply if true, the recommended level is stored in the asset settings
+   */
+  bool analyzeProjectCompression(const std::string &configPath, bool apply);
+
+  struct BenchmarkOptions
+  {
+    uint32_t frames{300}; // recorded frames per scene
+    std::string emuCmd{}; // defaults to the emulator set in the project
+    std::string reportPath{"benchmark.json"};
+  };
+
+  /**
+   * Builds a benchmark project, runs it in an emulator and writes the per-scene metrics as a JSON report.
+   * The ROM has to print the metrics itself, see 'n64/examples/bench'.
+   * Draw layer peaks ('layerWordsN' metrics) are also saved to 'layerPeaks.json' in the project,
+   * which later builds use to size layers that have no explicit buffer size.
+   * @return false if the build failed or the run didn't finish
+   */
+  bool runBenchmark(const std::string &configPath, const BenchmarkOptions &options);
+
+  struct VertexCacheStats
+  {
+    uint32_t loadsBefore{};
+    uint32_t loadsAfter{};
+  };
+
+  /**
+   * Vertices the RSP has to load to draw a model, with triangles filling the vertex cache in order.
+   */
+  uint32_t countVertexLoads(const T3DM::T3DMData &t3dm);
+  uint32_t countVertexLoads(const T3DM::Model &model);
+
+  /**
+   * Reorders the triangles of each mesh so that ones sharing vertices end up in the same vertex-cache sized chunk.
+   * This changes the draw order within a mesh, which can matter for overlapping transparent triangles.
+   */
+  VertexCacheStats optimizeVertexCache(T3DM::T3DMData &t3dm);
+
+  struct AnimStats
+  {
+    uint32_t sampleRate{}; // lowest rate within the error bounds
+    uint32_t bytesDefault{}; // estimated keyframe data at the default rate
+    uint32_t bytesPicked{};
+    float maxErrRot{}; // in degrees, at the picked rate
+    float maxErrPos{}; // in units, after the base-scale
+  };
+
+  /**
+   * Resamples all animations of a glTF file at decreasing rates, comparing each against the default rate.
+   * Used for models with 'Auto' anim-rate, picks the lowest one where no bone rotates further off than 'maxErrDeg'.
+   */
+  AnimStats analyzeAnimations(const std::string &gltfPath, float baseScale, float maxErrDeg);
+
+  /**
+   * Static estimate of what drawing (a part of) a scene costs per frame, see 'estimateDrawCost()'.
+   */
+  struct DrawCost
+  {
+    uint32_t objects{};
+    uint32_t triangles{};
+    uint32_t vertexLoads{};
+    uint32_t materials{}; // material changes
+    uint32_t textureLoads{}; // TMEM uploads, only counted if the texture differs from the last one
+    uint32_t matrices{};
+
+    std::string lastTexture{}; // still in TMEM while adding meshes
+
+    /**
+     * Adds the given meshes of a model in order, all of them if 'meshes' is empty.
+     */
+    void addMeshes(const T3DM::T3DMData &t3dm, const std::vector<uint32_t> &meshes);
+  };
+
+  struct CameraView
+  {
+    std::string name{};
+    Utils::Frustum frustum{};
+  };
+
+  /**
+   * Sums up the draw cost of all enabled (static and animated) models under an object, in scene order.
+   * With a view, only models whose bounds are inside count, per-mesh culling through a BVH is ignored.
+   * This can't know about anything spawned or moved by code, it's meant to spot heavy content early.
+   */
+  DrawCost estimateDrawCost(Project::Project &project, Project::Object &root, const Utils::Frustum* view = nullptr);
+
+  /**
+   * Views of all camera components under an object, as placed in the editor.
+   * @param defAspect used by cameras without an aspect or viewport size (usually the framebuffer's)
+   */
+  std::vector<CameraView> getCameraViews(Project::Project &project, Project::Object &root, float defAspect);
+
+  /**
+   * Splits meshes with many triangles into spatially coherent parts (same name and material), so a BVH can cull them.
+   * Skinned models are left alone, their triangles don't stay where they are.
+   * @return number of objects added
+   */
+  uint32_t splitLargeMeshes(T3DM::T3DMData &t3dm);
+
+  /**
+   * Whether the model gets a BVH for frustum culling. Either set by hand ('gltfBVH'),
+   * or with 'gltfBVHAuto' if it has enough objects spread out far enough for culling to skip some of them.
+   */
+  bool needsBVH(const Project::AssetManagerEntry &model);
+
+  /**
+   * Converts the meshes of a model into a collision mesh, settings (scale, simplification, BVH) come from the asset.
+   * @param meshes names of the meshes to include, all if empty
+   */
+  Utils::BinaryFile buildCollision(const Project::AssetManagerEntry &model, const std::unordered_set<std::string> &meshes = {});
 }
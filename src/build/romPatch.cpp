@@ -0,0 +1,163 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include "../utils/fs.h"
+#include "../utils/logger.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  // see 'dfs_internal.h' in libdragon, all values are big-endian
+  constexpr uint32_t ENTRY_SIZE = 256;
+  constexpr uint32_t ENTRY_PATH_OFFSET = 12;
+  constexpr uint32_t ROOT_FLAGS = 0xFFFFFFFF;
+  constexpr uint32_t ROOT_POINTER = 0xDEADBEEF;
+  constexpr uint32_t FLAGS_DIR = 0x10000000;
+  constexpr uint32_t FLAGS_MASK = 0xF0000000;
+  constexpr uint32_t SIZE_MASK = 0x0FFFFFFF;
+  constexpr uint32_t MAX_DEPTH = 64;
+
+  // covered by the boot checksum in the ROM header, patching it would need a new one
+  constexpr uint32_t ROM_CHECKSUM_END = 0x101000;
+
+  // source files of the ROM code, any change needs the full make
+  constexpr const char* CODE_DIRS[] = {"src", "engine"};
+
+  struct DfsFile
+  {
+    uint32_t entryOffset{};
+    uint32_t dataOffset{};
+    uint32_t capacity{}; // bytes until the next entry or file
+  };
+
+  uint32_t readU32(const std::string &data, uint32_t offset)
+  {
+    auto p = (const uint8_t*)data.data() + offset;
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+  }
+
+  void writeU32(std::string &data, uint32_t offset, uint32_t value)
+  {
+    for(uint32_t i=0; i<4; ++i)data[offset + i] = (char)(value >> (24 - i*8));
+  }
+
+  bool readDir(const std::string &dfs, uint32_t offset, const std::string &prefix, uint32_t depth,
+    std::map<std::string, DfsFile> &files, std::vector<uint32_t> &starts)
+  {
+    if(depth > MAX_DEPTH)return false;
+    while(offset != 0)
+    {
+      if(offset + ENTRY_SIZE > dfs.size())return false;
+      starts.push_back(offset);
+
+      uint32_t next = readU32(dfs, offset);
+      uint32_t ptr = readU32(dfs, offset + 4);
+      uint32_t flags = readU32(dfs, offset + 8);
+      auto namePtr = dfs.data() + offset + ENTRY_PATH_OFFSET;
+      std::string name{namePtr, strnlen(namePtr, ENTRY_SIZE - ENTRY_PATH_OFFSET)};
+
+      if(flags & FLAGS_DIR) {
+        if(!readDir(dfs, ptr, prefix + name + "/", depth + 1, files, starts))return false;
+      } else {
+        if(ptr + (flags & SIZE_MASK) > dfs.size())return false;
+        files[prefix + name] = {offset, ptr};
+        starts.push_back(ptr);
+      }
+      // each entry adds at most two, more means a loop in a broken image
+      if(starts.size() > (dfs.size() / ENTRY_SIZE) * 2 + 1)return false;
+      offset = next;
+    }
+    return true;
+  }
+
+  bool isNewerThan(const fs::path &dir, fs::file_time_type time)
+  {
+    std::error_code err{};
+    for(const auto &entry : fs::recursive_directory_iterator{dir, err}) {
+      if(entry.is_regular_file() && entry.last_write_time() > time)return true;
+    }
+    return false;
+  }
+}
+
+bool Build::patchRom(const fs::path &projectPath, const std::string &romName, const std::set<std::string> &dedupFiles)
+{
+  auto z64Path = projectPath / (romName + ".z64");
+  auto dfsPath = projectPath / "build" / (romName + ".dfs");
+  if(!fs::exists(z64Path) || !fs::exists(dfsPath))return false;
+
+  auto romTime = fs::last_write_time(z64Path);
+  for(auto dir : CODE_DIRS) {
+    if(isNewerThan(projectPath / dir, romTime))return false;
+  }
+
+  auto dfsTime = fs::last_write_time(dfsPath);
+  std::vector<std::string> changed{};
+  std::error_code err{};
+  auto fsDir = projectPath / "filesystem";
+  for(const auto &entry : fs::recursive_directory_iterator{fsDir, err}) {
+    if(!entry.is_regular_file() || entry.last_write_time() <= dfsTime)continue;
+    auto relPath = Utils::FS::toUnixPath(fs::relative(entry.path(), fsDir));
+    if(dedupFiles.contains("filesystem/" + relPath))continue; // not part of the DFS
+    changed.push_back(relPath);
+  }
+  if(changed.empty())return false; // nothing new, make only has to check the code
+
+  auto dfs = Utils::FS::loadTextFile(dfsPath);
+  if(dfs.size() < ENTRY_SIZE || readU32(dfs, 0) != ROOT_POINTER || readU32(dfs, 8) != ROOT_FLAGS)return false;
+
+  std::map<std::string, DfsFile> files{};
+  std::vector<uint32_t> starts{0};
+  if(!readDir(dfs, readU32(dfs, 4), "", 0, files, starts))return false;
+
+  // the space of a file ends where anything else starts, independent of the alignment mkdfs used
+  starts.push_back(dfs.size());
+  std::sort(starts.begin(), starts.end());
+  for(auto &[path, file] : files) {
+    auto it = std::upper_bound(starts.begin(), starts.end(), file.dataOffset);
+    file.capacity = *it - file.dataOffset;
+  }
+
+  // the DFS is appended to the ROM as is, the old image tells where
+  auto rom = Utils::FS::loadTextFile(z64Path);
+  auto romDfsPos = rom.find(dfs);
+  if(romDfsPos == std::string::npos)return false;
+
+  for(const auto &path : changed)
+  {
+    auto it = files.find(path);
+    if(it == files.end())return false; // new file, the directory needs to be rebuilt
+    auto &file = it->second;
+
+    auto data = Utils::FS::loadTextFile(fsDir / path);
+    if(data.size() > file.capacity)return false;
+    if(romDfsPos + file.dataOffset < ROM_CHECKSUM_END)return false;
+
+    uint32_t oldFlags = readU32(dfs, file.entryOffset + 8);
+    uint32_t oldSize = oldFlags & SIZE_MASK;
+    std::string fileData = data;
+    if(fileData.size() < oldSize)fileData.resize(oldSize, '\0');
+
+    dfs.replace(file.dataOffset, fileData.size(), fileData);
+    writeU32(dfs, file.entryOffset + 8, (oldFlags & FLAGS_MASK) | (uint32_t)data.size());
+  }
+
+  // entries before the checksum end would have changed too, only ever the case for tiny ROMs
+  if(romDfsPos < ROM_CHECKSUM_END && rom.compare(romDfsPos, ROM_CHECKSUM_END - romDfsPos, dfs, 0, ROM_CHECKSUM_END - romDfsPos) != 0) {
+    return false;
+  }
+
+  rom.replace(romDfsPos, dfs.size(), dfs);
+  Utils::FS::saveTextFile(dfsPath, dfs);
+  Utils::FS::saveTextFile(z64Path, rom);
+
+  Utils::Logger::log("Patched " + std::to_string(changed.size()) + " file(s) into the ROM");
+  return true;
+}
@@ -0,0 +1,581 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "romReport.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <unordered_map>
+
+#include "projectBuilder.h"
+#include "../utils/fs.h"
+#include "../utils/hash.h"
+#include "../utils/logger.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  constexpr uint32_t NAME_WIDTH = 32;
+  constexpr uint32_t DUPLICATE_MIN_SIZE = 64; // smaller files can't save anything worth reporting
+  constexpr uint32_t DUPLICATE_LOG_COUNT = 10;
+  constexpr uint32_t CODE_LOG_COUNT = 15;
+  // mixer channels if a scene doesn't say (manifests of older builds)
+  constexpr uint32_t AUDIO_DEF_CHANNELS = 32;
+
+  constexpr const char* CODEC_NAMES[Build::AudioCostStats::CODEC_COUNT] = {"None", "VADPCM", "Opus"};
+
+  // indexed by 'Project::FileType'
+  constexpr const char* TYPE_NAMES[] = {
+    "Other", "Image", "Audio", "Font", "Model", "Script", "Global Script", "Prefab", "Node Graph"
+  };
+  static_assert(std::size(TYPE_NAMES) == (size_t)Project::FileType::_SIZE);
+
+  struct FileInfo
+  {
+    uint32_t size{};
+    uint32_t ramSize{}; // once loaded, differs from 'size' if compressed
+    uint32_t level{}; // compression level
+  };
+
+  uint32_t readU32BE(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+  }
+
+  // the header of compressed libdragon assets ('asset_header_t') has the algorithm and original size
+  FileInfo readFileInfo(const fs::path &path)
+  {
+    std::error_code err{};
+    FileInfo info{};
+    info.size = fs::file_size(path, err);
+    if(err)return {};
+    info.ramSize = info.size;
+
+    FILE *file = fopen(path.string().c_str(), "rb");
+    if(!file)return info;
+    uint8_t header[16]{};
+    if(fread(header, 1, sizeof(header), file) == sizeof(header) && memcmp(header, "DCA", 3) == 0) {
+      info.level = ((uint32_t)header[4] << 8) | header[5];
+      info.ramSize = readU32BE(header + 12);
+    }
+    fclose(file);
+    return info;
+  }
+
+  struct CodeSize
+  {
+    std::string kind{};
+    std::string name{};
+    uint64_t text{};
+    uint64_t data{}; // read-only data included, in ROM and RDRAM
+    uint64_t bss{}; // RDRAM only
+  };
+
+  // first names of a mangled nested name, e.g. '_ZN3P644Comp5Model4drawEv' -> P64, Comp, Model
+  std::vector<std::string_view> getNestedNames(std::string_view sym, size_t maxCount)
+  {
+    std::vector<std::string_view> res{};
+    // vtables and type-info ('_ZTV', '_ZTI', '_ZTS') name the class the same way
+    if(sym.starts_with("_ZT") && sym.size() > 4)sym.remove_prefix(4);
+    else if(sym.starts_with("_Z"))sym.remove_prefix(2);
+    else return res;
+    if(!sym.starts_with("N"))return res;
+
+    size_t pos = 1;
+    while(pos < sym.size() && (sym[pos] == 'K' || sym[pos] == 'V' || sym[pos] == 'r'))++pos;
+    while(res.size() < maxCount && pos < sym.size() && isdigit((unsigned char)sym[pos])) {
+      size_t len = 0;
+      while(pos < sym.size() && isdigit((unsigned char)sym[pos]))len = len * 10 + (sym[pos++] - '0');
+      if(pos + len > sym.size())break;
+      res.push_back(sym.substr(pos, len));
+      pos += len;
+    }
+    return res;
+  }
+
+  /**
+   * What an input section of the linker map belongs to.
+   * User code and generated code are known by their object file, the engine is linked as one relocatable
+   * object ('engine.a'), its sections are told apart by the namespace of their symbol (-ffunction-sections).
+   * The same goes for the combined sources of a unity build.
+   */
+  std::pair<std::string, std::string> getCodeOwner(Project::Project &project, const std::string &file, const std::string &section)
+  {
+    auto stem = [](std::string_view path) {
+      auto name = path.substr(path.find_last_of('/') + 1);
+      return std::string{name.substr(0, name.find_last_of('.'))};
+    };
+
+    auto getAsset = [&](std::string_view hex) -> const Project::AssetManagerEntry* {
+      if(hex.size() != 16 || hex.find_first_not_of("0123456789ABCDEF") != std::string::npos)return nullptr;
+      return project.getAssets().getEntryByUUID(std::stoull(std::string{hex}, nullptr, 16));
+    };
+
+    // '.text._ZN...' -> names of the symbol
+    auto getSectionNames = [&]() {
+      auto symStart = section.find('.', 1);
+      return getNestedNames(symStart == std::string::npos ? "" : std::string_view{section}.substr(symStart + 1), 3);
+    };
+
+    // combined sources of a unity build (see 'buildUnitySources'), the namespace tells the script or graph apart
+    if(file.find("src/p64/unity/") != std::string::npos)
+    {
+      auto names = getSectionNames();
+      if(names.size() >= 3 && names[0] == "P64" && names[1] == "Script") {
+        auto asset = getAsset(names[2]);
+        return {"Script", asset ? asset->name : std::string{names[2]}};
+      }
+      if(names.size() >= 3 && names[0] == "P64" && names[1] == "NodeGraph" && names[2].starts_with("G")) {
+        auto asset = getAsset(names[2].substr(1));
+        return {"Node Graph", asset ? asset->name : std::string{names[2]}};
+      }
+      return {"Generated", "Unity " + stem(file)};
+    }
+
+    if(file.find("src/user/") != std::string::npos)return {"Script", stem(file)};
+    if(file.find("src/p64/") != std::string::npos)
+    {
+      // generated from node graphs, named by their UUID (see 'buildNodeGraphAssets')
+      auto name = stem(file);
+      if(auto asset = getAsset(name))return {"Node Graph", asset->name};
+      return {"Generated", name};
+    }
+    if(file.find("engine.a") != std::string::npos)
+    {
+      auto names = getSectionNames();
+      if(names.size() >= 3 && names[0] == "P64" && names[1] == "Comp")return {"Component", std::string{names[2]}};
+      if(names.size() >= 2 && names[0] == "P64")return {"Engine", std::string{names[1]}};
+      return {"Engine", "Other"};
+    }
+
+    // libraries are archives, listed as 'path/libdragon.a(display.o)'
+    auto archiveEnd = file.find(".a(");
+    if(archiveEnd != std::string::npos)return {"Library", stem(file.substr(0, archiveEnd + 2))};
+    return {"Other", stem(file)};
+  }
+
+  /**
+   * Attributes the size of all sections in the ROM to their owner (see 'getCodeOwner'),
+   * from the map written by the linker ('-Map' in libdragon's 'n64.mk').
+   * Script overlays are separate DSOs and not part of it.
+   */
+  std::vector<CodeSize> readCodeSizes(Project::Project &project, const fs::path &mapPath)
+  {
+    std::map<std::pair<std::string, std::string>, CodeSize> sizes{};
+    std::istringstream map{Utils::FS::loadTextFile(mapPath)};
+
+    std::string line{};
+    bool inMemoryMap = false;
+    std::string outSection{};
+    std::string pendingSection{}; // long names are followed by the address on the next line
+    while(std::getline(map, line))
+    {
+      if(!line.empty() && line.back() == '\r')line.pop_back();
+      if(!inMemoryMap) {
+        inMemoryMap = line.starts_with("Linker script and memory map");
+        continue;
+      }
+      if(line.empty())continue;
+
+      std::istringstream tokens{line};
+      std::string first{};
+      tokens >> first;
+      if(line[0] != ' ') {
+        outSection = first;
+        pendingSection.clear();
+        continue;
+      }
+
+      std::string section{};
+      std::string addr{};
+      if(first.starts_with(".") || first == "COMMON") {
+        section = first;
+        if(!(tokens >> addr)) {
+          pendingSection = section;
+          continue;
+        }
+      } else if(!pendingSection.empty() && first.starts_with("0x")) {
+        section = pendingSection;
+        addr = first;
+      }
+      pendingSection.clear();
+      if(section.empty())continue; // symbols, fill and assignments
+
+      std::string sizeStr{};
+      std::string file{};
+      if(!(tokens >> sizeStr) || !sizeStr.starts_with("0x"))continue;
+      std::getline(tokens >> std::ws, file);
+
+      // non-allocated sections (debug info) have no address
+      uint64_t address = std::strtoull(addr.c_str(), nullptr, 16);
+      uint64_t size = std::strtoull(sizeStr.c_str(), nullptr, 16);
+      if(address == 0 || size == 0 || file.empty())continue;
+
+      auto owner = getCodeOwner(project, Utils::FS::toUnixPath(file), section);
+      auto &entry = sizes[owner];
+      entry.kind = owner.first;
+      entry.name = owner.second;
+      if(outSection == ".text")entry.text += size;
+      else if(outSection == ".bss" || outSection == ".sbss")entry.bss += size;
+      else entry.data += size;
+    }
+
+    std::vector<CodeSize> res{};
+    for(auto &[key, entry] : sizes)res.push_back(std::move(entry));
+    std::stable_sort(res.begin(), res.end(), [](const CodeSize &a, const CodeSize &b) {
+      return a.text + a.data > b.text + b.data;
+    });
+    return res;
+  }
+
+  std::string formatKB(uint64_t bytes)
+  {
+    char buff[32];
+    snprintf(buff, sizeof(buff), "%10.1f KB", bytes / 1024.0);
+    return buff;
+  }
+
+  std::string formatRow(const std::string &name, uint64_t bytes, const std::string &extra = "")
+  {
+    auto shortName = name.size() <= NAME_WIDTH ? name : ("..." + name.substr(name.size() - NAME_WIDTH + 3));
+    char buff[256];
+    snprintf(buff, sizeof(buff), "  %-*s %s %s\n", (int)NAME_WIDTH, shortName.c_str(), formatKB(bytes).c_str(), extra.c_str());
+    return buff;
+  }
+}
+
+nlohmann::json Build::SceneMemStats::serialize() const
+{
+  auto jsonChunks = nlohmann::json::array();
+  for(const auto &chunk : chunks) {
+    jsonChunks.push_back({{"assets", chunk.assets}, {"objBytes", chunk.objBytes}});
+  }
+  return {
+    {"id", id},
+    {"name", name},
+    {"budgetKB", budgetKB},
+    {"objCount", objCount},
+    {"objBytes", objBytes},
+    {"matrixBytes", matrixBytes},
+    {"layerBytes", layerBytes},
+    {"fbBytes", fbBytes},
+    {"chunksLoaded", chunksLoaded},
+    {"audioChannels", audioChannels},
+    {"assets", assets},
+    {"chunks", jsonChunks},
+    {"files", files},
+  };
+}
+
+Build::SceneMemStats Build::SceneMemStats::deserialize(const nlohmann::json &doc)
+{
+  SceneMemStats stats{
+    .id = doc.value<uint32_t>("id", 0),
+    .name = doc.value("name", ""),
+    .budgetKB = doc.value<uint32_t>("budgetKB", 0),
+    .objCount = doc.value<uint32_t>("objCount", 0),
+    .objBytes = doc.value<uint32_t>("objBytes", 0),
+    .matrixBytes = doc.value<uint32_t>("matrixBytes", 0),
+    .layerBytes = doc.value<uint32_t>("layerBytes", 0),
+    .fbBytes = doc.value<uint32_t>("fbBytes", 0),
+    .chunksLoaded = doc.value<uint32_t>("chunksLoaded", 0),
+    .audioChannels = doc.value<uint32_t>("audioChannels", 0),
+    .assets = doc.value("assets", std::vector<uint64_t>{}),
+    .files = doc.value("files", std::vector<std::string>{}),
+  };
+  for(const auto &chunk : doc.value("chunks", nlohmann::json::array())) {
+    stats.chunks.push_back({
+      .assets = chunk.value("assets", std::vector<uint64_t>{}),
+      .objBytes = chunk.value<uint32_t>("objBytes", 0),
+    });
+  }
+  return stats;
+}
+
+bool Build::writeRomReport(Project::Project &project, const SceneCtx &ctx)
+{
+  auto projectPath = fs::path{project.getPath()};
+  auto fsPath = projectPath / "filesystem";
+
+  // everything in the DFS, keyed by its path relative to the project (like 'SceneCtx::files')
+  std::map<std::string, FileInfo> files{};
+  uint64_t dfsSize = 0;
+  std::error_code err{};
+  for(const auto &entry : fs::recursive_directory_iterator{fsPath, err}) {
+    if(!entry.is_regular_file())continue;
+    auto relPath = Utils::FS::toUnixPath(fs::relative(entry.path(), projectPath));
+    if(ctx.dedupFiles.contains(relPath))continue; // not part of the DFS
+    auto &info = files[relPath] = readFileInfo(entry.path());
+    dfsSize += info.size;
+  }
+
+  uint64_t romSize = fs::file_size(projectPath / (project.conf.romName + ".z64"), err);
+  if(err)romSize = 0;
+  // the ROM is the code followed by the DFS, the code also ends up in RDRAM
+  uint64_t codeSize = romSize > dfsSize ? (romSize - dfsSize) : 0;
+
+  // assets by type and compression
+  std::unordered_map<uint64_t, const FileInfo*> assetFiles{};
+  std::set<std::string> attributed{};
+  std::array<std::pair<uint64_t, uint32_t>, (size_t)Project::FileType::_SIZE> typeSizes{};
+  std::map<uint32_t, std::pair<uint64_t, uint32_t>> levelSizes{};
+  for(const auto &asset : ctx.assetList)
+  {
+    if(asset.path.size() <= 5)continue;
+    auto relPath = "filesystem/" + asset.path.substr(5); // remove "rom:/"
+    auto it = files.find(relPath);
+    if(it == files.end() || !attributed.insert(relPath).second)continue;
+
+    assetFiles[asset.uuid] = &it->second;
+    auto type = std::min<uint32_t>(asset.type, typeSizes.size() - 1);
+    typeSizes[type].first += it->second.size;
+    typeSizes[type].second += 1;
+    levelSizes[it->second.level].first += it->second.size;
+    levelSizes[it->second.level].second += 1;
+  }
+
+  // images packed into an atlas resolve to the atlas itself
+  auto getAssetFile = [&](uint64_t uuid) -> const FileInfo* {
+    auto idx = ctx.assetUUIDToIdx.find(uuid);
+    if(idx == ctx.assetUUIDToIdx.end())return nullptr;
+    auto it = assetFiles.find(ctx.assetList[idx->second].uuid);
+    return it == assetFiles.end() ? nullptr : it->second;
+  };
+
+  // sounds, decode cost with the codec they use
+  struct AudioEntry
+  {
+    Build::AudioCostStats stats{};
+    uint32_t codec{};
+  };
+  std::unordered_map<uint64_t, AudioEntry> audioEntries{};
+  auto audioDoc = nlohmann::json::array();
+  for(const auto &asset : project.getAssets().getTypeEntries(Project::FileType::AUDIO))
+  {
+    AudioEntry entry{};
+    if(asset.conf.exclude || !Build::analyzeAudioCost(asset, entry.stats))continue;
+    entry.codec = std::min<uint32_t>(asset.conf.wavCompression.value, AudioCostStats::CODEC_COUNT - 1);
+    audioEntries[asset.getUUID()] = entry;
+    audioDoc.push_back({
+      {"name", asset.name},
+      {"codec", CODEC_NAMES[entry.codec]},
+      {"recommended", CODEC_NAMES[entry.stats.getRecommended()]},
+      {"duration", entry.stats.durationSec},
+      {"sampleRate", entry.stats.sampleRate},
+      {"channels", entry.stats.channels},
+      {"decodeUs", entry.stats.estimateDecodeUs(entry.codec)},
+    });
+  }
+  std::stable_sort(audioDoc.begin(), audioDoc.end(), [](const auto &a, const auto &b) {
+    return a["decodeUs"].template get<float>() > b["decodeUs"].template get<float>();
+  });
+
+  // worst case: the most expensive sounds of a scene all playing, as far as the mixer has channels for them
+  auto getAudioDecodeUs = [&](const SceneMemStats &stats) {
+    std::set<uint64_t> uuids{stats.assets.begin(), stats.assets.end()};
+    for(const auto &chunk : stats.chunks)uuids.insert(chunk.assets.begin(), chunk.assets.end());
+
+    std::vector<const AudioEntry*> sounds{};
+    for(auto uuid : uuids) {
+      auto it = audioEntries.find(uuid);
+      if(it != audioEntries.end())sounds.push_back(&it->second);
+    }
+    std::sort(sounds.begin(), sounds.end(), [](const AudioEntry* a, const AudioEntry* b) {
+      return a->stats.estimateDecodeUs(a->codec) > b->stats.estimateDecodeUs(b->codec);
+    });
+
+    float timeUs = 0.0f;
+    uint32_t freeChannels = stats.audioChannels ? stats.audioChannels : AUDIO_DEF_CHANNELS;
+    for(auto sound : sounds) {
+      if(sound->stats.channels > freeChannels)continue;
+      freeChannels -= sound->stats.channels;
+      timeUs += sound->stats.estimateDecodeUs(sound->codec);
+    }
+    return timeUs;
+  };
+
+  nlohmann::json doc{};
+  doc["romSize"] = romSize;
+  doc["dfsSize"] = dfsSize;
+  doc["codeSize"] = codeSize;
+  doc["types"] = nlohmann::json::array();
+  for(uint32_t t=0; t<typeSizes.size(); ++t) {
+    if(typeSizes[t].second == 0)continue;
+    doc["types"].push_back({{"name", TYPE_NAMES[t]}, {"size", typeSizes[t].first}, {"count", typeSizes[t].second}});
+  }
+  doc["compression"] = nlohmann::json::array();
+  for(auto &[level, entry] : levelSizes) {
+    doc["compression"].push_back({{"level", level}, {"size", entry.first}, {"count", entry.second}});
+  }
+
+  // scenes
+  bool withinBudget = true;
+  uint64_t sceneFilesSize = 0;
+  doc["scenes"] = nlohmann::json::array();
+  for(const auto &stats : ctx.sceneStats)
+  {
+    uint64_t sceneRomSize = 0;
+    for(const auto &file : stats.files) {
+      auto it = files.find(file);
+      if(it == files.end() || !attributed.insert(file).second)continue;
+      sceneRomSize += it->second.size;
+    }
+
+    std::set<const FileInfo*> loaded{};
+    uint64_t assetBytes = 0;
+    for(auto uuid : stats.assets) {
+      auto file = getAssetFile(uuid);
+      if(file && loaded.insert(file).second)assetBytes += file->ramSize;
+    }
+
+    // worst case, the biggest chunks are the ones loaded at the same time
+    std::vector<uint64_t> chunkBytes{};
+    for(const auto &chunk : stats.chunks) {
+      uint64_t bytes = chunk.objBytes;
+      std::set<const FileInfo*> chunkLoaded{};
+      for(auto uuid : chunk.assets) {
+        auto file = getAssetFile(uuid);
+        if(file && !loaded.contains(file) && chunkLoaded.insert(file).second)bytes += file->ramSize;
+      }
+      chunkBytes.push_back(bytes);
+    }
+    std::sort(chunkBytes.begin(), chunkBytes.end(), std::greater{});
+    if(chunkBytes.size() > stats.chunksLoaded)chunkBytes.resize(stats.chunksLoaded);
+    uint64_t chunkTotal = 0;
+    for(auto bytes : chunkBytes)chunkTotal += bytes;
+
+    sceneFilesSize += sceneRomSize;
+
+    uint64_t ramTotal = codeSize + assetBytes + chunkTotal + stats.objBytes + stats.matrixBytes + stats.layerBytes + stats.fbBytes;
+    uint64_t budget = (uint64_t)(stats.budgetKB ? stats.budgetKB : project.conf.memBudgetKB) * 1024;
+    bool overBudget = budget != 0 && ramTotal > budget;
+    if(overBudget)withinBudget = false;
+
+    doc["scenes"].push_back({
+      {"id", stats.id},
+      {"name", stats.name},
+      {"romSize", sceneRomSize},
+      {"objCount", stats.objCount},
+      {"ram", {
+        {"code", codeSize},
+        {"assets", assetBytes},
+        {"chunks", chunkTotal},
+        {"objects", stats.objBytes},
+        {"matrices", stats.matrixBytes},
+        {"layers", stats.layerBytes},
+        {"framebuffers", stats.fbBytes},
+      }},
+      {"ramTotal", ramTotal},
+      {"budget", budget},
+      {"overBudget", overBudget},
+      {"audioDecodeUs", getAudioDecodeUs(stats)},
+    });
+  }
+
+  uint64_t otherSize = 0;
+  for(auto &[path, info] : files) {
+    if(!attributed.contains(path))otherSize += info.size;
+  }
+  doc["otherSize"] = otherSize;
+
+  // identical content, e.g. the same texture imported twice
+  std::map<std::pair<uint32_t, uint64_t>, std::vector<std::string>> byContent{};
+  for(auto &[path, info] : files) {
+    if(info.size < DUPLICATE_MIN_SIZE)continue;
+    Utils::Hash::XXH64 hash{};
+    if(hash.updateFile(projectPath / path))byContent[{info.size, hash.digest()}].push_back(path);
+  }
+  uint64_t duplicateSize = 0;
+  doc["duplicates"] = nlohmann::json::array();
+  for(auto &[key, paths] : byContent) {
+    if(paths.size() < 2)continue;
+    duplicateSize += (uint64_t)key.first * (paths.size() - 1);
+    doc["duplicates"].push_back({{"size", key.first}, {"files", paths}});
+  }
+  std::stable_sort(doc["duplicates"].begin(), doc["duplicates"].end(), [](const auto &a, const auto &b) {
+    return a["size"].template get<uint32_t>() * a["files"].size() > b["size"].template get<uint32_t>() * b["files"].size();
+  });
+  doc["duplicateSize"] = duplicateSize;
+
+  doc["code"] = nlohmann::json::array();
+  for(const auto &entry : readCodeSizes(project, projectPath / "build" / (project.conf.romName + ".map"))) {
+    doc["code"].push_back({
+      {"kind", entry.kind}, {"name", entry.name},
+      {"text", entry.text}, {"data", entry.data}, {"bss", entry.bss},
+    });
+  }
+
+  doc["audio"] = audioDoc;
+
+  fs::create_directories((projectPath / ROM_REPORT_FILE).parent_path(), err);
+  Utils::FS::saveTextFile(projectPath / ROM_REPORT_FILE, doc.dump(2));
+
+  // log
+  std::string msg = "ROM size:\n";
+  msg += formatRow("ROM", romSize);
+  msg += formatRow("Code", codeSize);
+  msg += formatRow("DFS", dfsSize);
+  msg += "By asset type:\n";
+  for(const auto &entry : doc["types"]) {
+    msg += formatRow(entry["name"], entry["size"], std::to_string(entry["count"].get<uint32_t>()) + " files");
+  }
+  msg += formatRow("Scene files", sceneFilesSize);
+  msg += formatRow("Other", otherSize);
+  msg += "By compression level:\n";
+  for(const auto &entry : doc["compression"]) {
+    msg += formatRow("Level " + std::to_string(entry["level"].get<uint32_t>()), entry["size"],
+      std::to_string(entry["count"].get<uint32_t>()) + " files");
+  }
+
+  uint32_t dupIdx = 0;
+  if(duplicateSize)msg += "Duplicated content (" + std::to_string(duplicateSize / 1024) + " KB could be saved):\n";
+  for(const auto &entry : doc["duplicates"]) {
+    if(dupIdx++ >= DUPLICATE_LOG_COUNT)break;
+    msg += formatRow(entry["files"][0], entry["size"], "x" + std::to_string(entry["files"].size()));
+  }
+
+  uint32_t codeIdx = 0;
+  if(!doc["code"].empty())msg += "Code by owner (.text / .data / .bss):\n";
+  for(const auto &entry : doc["code"]) {
+    if(codeIdx++ >= CODE_LOG_COUNT)break;
+    auto name = entry["kind"].get<std::string>() + ": " + entry["name"].get<std::string>();
+    msg += formatRow(name, entry["text"], formatKB(entry["data"]) + formatKB(entry["bss"]));
+  }
+
+  std::string audioMsg{};
+  for(const auto &entry : doc["audio"]) {
+    if(entry["codec"] == entry["recommended"])continue;
+    char extra[64];
+    snprintf(extra, sizeof(extra), "%.1fs, %s -> %s", entry["duration"].get<float>(),
+      entry["codec"].get<std::string>().c_str(), entry["recommended"].get<std::string>().c_str());
+    audioMsg += "  " + entry["name"].get<std::string>() + ": " + extra + "\n";
+  }
+  if(!audioMsg.empty())msg += "Sounds with a different codec recommended:\n" + audioMsg;
+
+  msg += "Scenes (ROM / est. peak RDRAM / budget):\n";
+  for(const auto &entry : doc["scenes"]) {
+    auto name = std::to_string(entry["id"].get<uint32_t>()) + ": " + entry["name"].get<std::string>();
+    auto ram = entry["ramTotal"].get<uint64_t>();
+    auto budget = entry["budget"].get<uint64_t>();
+    std::string extra = formatKB(ram) + " /" + formatKB(budget);
+    char audio[32];
+    snprintf(audio, sizeof(audio), "  audio %.2fms", entry["audioDecodeUs"].get<float>() / 1000.0f);
+    extra += audio;
+    if(entry["overBudget"].get<bool>())extra += "  OVER BUDGET";
+    msg += formatRow(name, entry["romSize"], extra);
+  }
+  Utils::Logger::logRaw(msg);
+
+  if(!withinBudget) {
+    Utils::Logger::log("Some scenes are estimated to exceed their memory budget, see the ROM report", Utils::Logger::LEVEL_WARN);
+  }
+  return withinBudget;
+}
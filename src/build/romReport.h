@@ -0,0 +1,63 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+namespace Project { class Project; }
+
+namespace Build
+{
+  struct SceneCtx;
+
+  // written by 'writeRomReport', relative to the project
+  constexpr const char* ROM_REPORT_FILE = "build/romReport.json";
+
+  /**
+   * Runtime memory of a scene that is known while building it (see 'buildScene').
+   * Kept in the scene manifest, so scenes that didn't need a rebuild still show up in the report.
+   * Asset sizes are only known after all conversions ran, so assets are stored by UUID.
+   */
+  struct SceneMemStats
+  {
+    struct Chunk
+    {
+      std::vector<uint64_t> assets{}; // only those not already loaded by the scene
+      uint32_t objBytes{};
+    };
+
+    uint32_t id{};
+    std::string name{};
+    uint32_t budgetKB{}; // 0 = project default
+    uint32_t objCount{};
+    uint32_t objBytes{};
+    uint32_t matrixBytes{};
+    uint32_t layerBytes{};
+    uint32_t fbBytes{};
+    uint32_t chunksLoaded{}; // max. chunks loaded at the same time
+    uint32_t audioChannels{}; // of the mixer, limits how many sounds can be decoded at once
+    std::vector<uint64_t> assets{}; // preloaded with the scene
+    std::vector<Chunk> chunks{};
+    std::vector<std::string> files{}; // output files, relative to the project
+
+    [[nodiscard]] nlohmann::json serialize() const;
+    static SceneMemStats deserialize(const nlohmann::json &doc);
+  };
+
+  /**
+   * Breaks down the ROM and DFS ('filesystem/p64') by asset type, scene and compression level,
+   * lists files with identical content and estimates the peak RDRAM use of each scene against its budget.
+   * Sounds get their estimated decode time and a recommended codec (see 'AudioCostStats'),
+   * the worst case of each scene is the most expensive of its sounds playing at once.
+   * Code and data of the binary are attributed to scripts, node graphs, components and engine modules
+   * using the linker map.
+   * The report is logged and saved to 'ROM_REPORT_FILE' for the editor, call it after the ROM was built.
+   * @return false if any scene is over budget
+   */
+  bool writeRomReport(Project::Project &project, const SceneCtx &ctx);
+}
@@ -4,11 +4,18 @@
 */
 #include "projectBuilder.h"
 #include "../utils/string.h"
+#include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <map>
+#include <set>
 
+#include "json.hpp"
 #include "../utils/binaryFile.h"
 #include "../utils/fs.h"
+#include "../utils/hash.h"
 #include "../utils/logger.h"
+#include "../utils/proc.h"
 
 #include "engine/include/scene/objectFlags.h"
 
@@ -21,9 +28,237 @@ namespace fs = std::filesystem;
 
 namespace
 {
+  // see 'runBenchmark()', peaks get some headroom since a benchmark won't hit every case
+  constexpr const char* LAYER_PEAKS_FILE = "layerPeaks.json";
+  constexpr uint32_t LAYER_PEAK_MARGIN = 4; // +25%
+  constexpr uint32_t LAYER_WORDS_ALIGN = 64;
+  constexpr uint32_t LAYER_WORDS_MIN = 256;
+
   constexpr uint32_t FLAG_CLR_DEPTH = 1 << 0;
   constexpr uint32_t FLAG_CLR_COLOR = 1 << 1;
   constexpr uint32_t FLAG_SCR_32BIT = 1 << 2;
+  constexpr uint32_t FLAG_DYN_RES = 1 << 3;
+  constexpr uint32_t FLAG_FB_DOUBLE = 1 << 4;
+  constexpr uint32_t FLAG_CHUNKS = 1 << 5;
+  constexpr uint32_t FLAG_DEPTH_SLICES = 1 << 6;
+  constexpr uint32_t FLAG_BACKDROP = 1 << 7;
+  constexpr uint32_t FLAG_LOW_LATENCY = 1 << 8;
+  constexpr uint32_t FLAG_LOW_TIER = 1 << 9;
+  constexpr uint32_t FLAG_QUALITY_AUTO = 1 << 10;
+  constexpr uint32_t FLAG_NO_DEPTH = 1 << 11;
+  constexpr uint32_t FLAG_PERSISTENT = 1 << 12;
+  constexpr uint32_t FLAG_NO_ALLOC = 1 << 13;
+  constexpr float TIER_SCALE_ONE = 16.0f;
+
+  // chunk files are numbered with 3 digits, see 'loadChunkFile' in the engine
+  constexpr uint32_t MAX_CHUNKS = 1000;
+
+  // bump if the scene format changes in a way the editor version doesn't cover
+  constexpr const char* SCENE_KEY_VERSION = "p64-scene-3";
+
+  // runtime memory estimates for the ROM report, must roughly match the engine:
+  // 'sizeof(P64::Object)' plus the malloc header, component data is assumed to be as big as in the file
+  constexpr uint32_t OBJECT_BASE_BYTES = 80;
+  // 'T3DMat4FP', each object with a model keeps one per frame in flight ('FrameMatrices::BUFFER_COUNT')
+  constexpr uint32_t MATRIX_BYTES = 64;
+  constexpr uint32_t MATRICES_PER_OBJECT = 3;
+  constexpr uint32_t MATRIX_DEFAULT_CAPACITY = 128 * 3 * 4;
+  // see 'DrawLayer::init', the first 3D layer draws directly into the main queue
+  constexpr uint32_t LAYER_BUFFER_COUNT = 3;
+  constexpr uint32_t LAYER_DEFAULT_WORDS = 1024;
+  constexpr uint32_t LAYER_DEFAULT_WORDS_2D = 1024 * 2;
+  // 'DEF_CHANNEL_COUNT' of the audio manager
+  constexpr uint32_t AUDIO_DEF_CHANNELS = 32;
+
+  struct Chunk
+  {
+    int16_t cellX{};
+    int16_t cellZ{};
+    std::vector<Project::Object*> objects{};
+    std::set<uint32_t> assets{};
+    Utils::BinaryFile file{};
+    uint32_t objCount{0};
+  };
+
+  /**
+   * Orders asset indices by where their files are in the DFS, so a scene (or chunk) loading them
+   * in this order reads the cartridge front to back instead of seeking around.
+   * mkdfs writes the tree depth-first with entries sorted by name, which is the same as comparing the paths by component.
+   * Entries without a file (e.g. code) go last, they are never loaded.
+   */
+  std::vector<uint16_t> sortByRomOrder(const Build::SceneCtx &ctx, const std::vector<uint16_t> &indices)
+  {
+    std::vector<std::pair<fs::path, uint16_t>> sorted{};
+    sorted.reserve(indices.size());
+    for(auto idx : indices) {
+      const auto &path = ctx.assetList[idx].path;
+      sorted.push_back({path.size() > 5 ? fs::path{path.substr(5)} : fs::path{}, idx});
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+      if(a.first.empty() != b.first.empty())return b.first.empty();
+      return a.first < b.first;
+    });
+
+    std::vector<uint16_t> res{};
+    res.reserve(sorted.size());
+    for(auto &[path, idx] : sorted)res.push_back(idx);
+    return res;
+  }
+
+  /**
+   * Everything a scene depends on that is the same for all scenes of a build:
+   * its own file, the asset table, script indices and the editor itself (which contains all component builders).
+   * Anything changing in here invalidates the scene, even when it wouldn't change the output.
+   */
+  std::string getSceneEnvKey(const Project::Project &project, const Project::SceneEntry &scene, const Build::SceneCtx &ctx)
+  {
+    auto projectPath = fs::path{project.getPath()};
+    std::string key = SCENE_KEY_VERSION;
+    key += '\0' + std::to_string(Utils::FS::getFileAge(Utils::Proc::getSelfPath()));
+    key += '\0' + Utils::FS::loadTextFile(projectPath / "data" / "scenes" / std::to_string(scene.id) / "scene.json");
+    key += '\0' + Utils::FS::loadTextFile(projectPath / LAYER_PEAKS_FILE);
+
+    // indices are written into the scene, so any asset moving around counts as a change
+    key += '\0';
+    for(const auto &asset : ctx.assetList) {
+      key += asset.path + ":" + Utils::toHex64(asset.uuid) + ";";
+    }
+
+    std::map<uint64_t, uint32_t> sortedMap{ctx.codeIdxMapUUID.begin(), ctx.codeIdxMapUUID.end()};
+    key += '\0';
+    for(auto &[uuid, idx] : sortedMap)key += Utils::toHex64(uuid) + ":" + std::to_string(idx) + ";";
+
+    sortedMap = std::map<uint64_t, uint32_t>{ctx.textureGroups.begin(), ctx.textureGroups.end()};
+    key += '\0';
+    for(auto &[uuid, group] : sortedMap)key += Utils::toHex64(uuid) + ":" + std::to_string(group) + ";";
+
+    return key;
+  }
+
+  /**
+   * Combines the environment with the state of all assets the scene used when it was last built.
+   * Prefabs and models are compared by date and settings, since their builders don't keep a content hash.
+   */
+  std::string getSceneKey(const Build::SceneCtx &ctx, const std::string &envKey, const std::vector<uint64_t> &deps)
+  {
+    std::string key = envKey;
+    for(auto uuid : deps)
+    {
+      key += '\0' + Utils::toHex64(uuid);
+      auto asset = ctx.project->getAssets().getEntryByUUID(uuid);
+      if(!asset)continue;
+      key += ":" + asset->path + ":" + std::to_string(Utils::FS::getFileAge(asset->path));
+      key += ":" + asset->conf.serialize();
+    }
+    return Utils::toHex64(Utils::Hash::sha256_64bit(key));
+  }
+
+  uint32_t getLayerBytes(const Project::SceneConf &conf, const std::vector<uint16_t> &layerWords)
+  {
+    if(layerWords.empty())return 0;
+    uint32_t countAlloc3D = conf.layers3D.size() + conf.layersPtx.size() - 1;
+    uint32_t words = 0;
+    for(uint32_t i=1; i<layerWords.size(); ++i) {
+      uint32_t w = layerWords[i];
+      if(w == 0)w = (i-1 >= countAlloc3D) ? LAYER_DEFAULT_WORDS_2D : LAYER_DEFAULT_WORDS;
+      words += w;
+    }
+    return words * LAYER_BUFFER_COUNT * sizeof(uint32_t);
+  }
+
+  bool usesDepth(const Project::SceneConf &conf)
+  {
+    return !conf.noDepth.value || conf.renderPipeline.value == 2; // bigtex always needs it
+  }
+
+  // color buffers plus a 16-bit depth buffer, ignores the extra buffers of the HDR/bigtex pipelines
+  uint32_t getFramebufferBytes(const Project::SceneConf &conf)
+  {
+    uint32_t pixels = conf.fbWidth * conf.fbHeight;
+    uint32_t colorBytes = pixels * (conf.fbFormat ? 4 : 2) * std::max(conf.fbCount.value, 1);
+    return colorBytes + (usesDepth(conf) ? pixels * 2 : 0);
+  }
+
+  /**
+   * Adds the files and generated assets of a scene built in an earlier run, as if it was built again.
+   * @return false if the manifest doesn't match the current inputs, or any output is missing
+   */
+  bool restoreScene(Build::SceneCtx &ctx, const nlohmann::json &manifest, const std::string &envKey)
+  {
+    if(!manifest.is_object())return false;
+    auto depsIt = manifest.find("deps");
+    if(depsIt == manifest.end() || !depsIt->is_array())return false;
+
+    auto deps = depsIt->get<std::vector<uint64_t>>();
+    if(manifest.value("key", "") != getSceneKey(ctx, envKey, deps))return false;
+    // manifests from before the ROM report / script overlays don't have it, building once adds them
+    if(!manifest.contains("stats") || !manifest.contains("scripts"))return false;
+
+    auto projectPath = fs::path{ctx.project->getPath()};
+    auto files = manifest.value("files", std::vector<std::string>{});
+    auto assets = manifest.value("assets", nlohmann::json::array());
+    for(const auto &file : files) {
+      if(!fs::exists(projectPath / file))return false;
+    }
+
+    // collision meshes are generated while building a scene, and may be shared with a later one.
+    // only the ROM path and UUID matter for the asset table, the file itself is still there from the last build
+    for(const auto &asset : assets)
+    {
+      auto romPath = asset.value("romPath", "");
+      if(romPath.size() <= 5 || !fs::exists(projectPath / "filesystem" / romPath.substr(5)))return false;
+    }
+    for(const auto &asset : assets)
+    {
+      auto uuid = asset.value<uint64_t>("uuid", 0);
+      if(ctx.assetUUIDToIdx.contains(uuid))continue;
+
+      Project::AssetManagerEntry entry{
+        .romPath = asset.value("romPath", ""),
+        .type = (Project::FileType)asset.value<uint32_t>("type", 0),
+      };
+      entry.conf.uuid = uuid;
+      ctx.addAsset(entry);
+    }
+
+    ctx.files.insert(ctx.files.end(), files.begin(), files.end());
+    ctx.sceneStats.push_back(Build::SceneMemStats::deserialize(manifest["stats"]));
+    auto scripts = manifest["scripts"].get<std::vector<uint64_t>>();
+    ctx.scriptsByScene[ctx.sceneStats.back().id] = {scripts.begin(), scripts.end()};
+    auto persistentScripts = manifest.value("persistentScripts", std::vector<uint64_t>{});
+    ctx.persistentScripts.insert(persistentScripts.begin(), persistentScripts.end());
+    return true;
+  }
+}
+
+bool Build::getGroupBounds(SceneCtx &ctx, Project::Object &obj, Utils::AABB &bounds)
+{
+  bool found = false;
+  for(const auto &child : obj.children)
+  {
+    std::vector<Project::Component::Entry*> compList{};
+    if(child->isPrefabInstance()) {
+      auto prefab = ctx.project->getAssets().getPrefabByUUID(child->uuidPrefab.value);
+      if(prefab) {
+        for(auto &comp : prefab->obj.components)compList.push_back(&comp);
+      }
+    }
+    for(auto &comp : child->components)compList.push_back(&comp);
+
+    for(auto comp : compList) {
+      if(Project::Component::TABLE[comp->id].funcBuild != Project::Component::Culling::build)continue;
+      Utils::AABB compBounds{};
+      if(Project::Component::Culling::getWorldBounds(*child, *comp, compBounds)) {
+        bounds.addPoint(compBounds.min);
+        bounds.addPoint(compBounds.max);
+        found = true;
+      }
+    }
+
+    if(getGroupBounds(ctx, *child, bounds))found = true;
+  }
+  return found;
 }
 
 uint32_t Build::writeObject(Build::SceneCtx &ctx, Project::Object &obj, bool savePrefabItself)
@@ -31,6 +266,7 @@ uint32_t Build::writeObject(Build::SceneCtx &ctx, Project::Object &obj, bool sav
   auto srcObj = &obj;
   if(!savePrefabItself && obj.isPrefabInstance())
   {
+    ctx.sceneDeps.insert(srcObj->uuidPrefab.value);
     auto prefab = ctx.project->getAssets().getPrefabByUUID(srcObj->uuidPrefab.value);
     if(prefab)srcObj = &prefab->obj;
   }
@@ -38,11 +274,16 @@ uint32_t Build::writeObject(Build::SceneCtx &ctx, Project::Object &obj, bool sav
   uint16_t objFlags = 0;
   if(obj.enabled)objFlags |= P64::ObjectFlags::ACTIVE;
   if(!obj.children.empty())objFlags |= P64::ObjectFlags::HAS_CHILDREN;
+  // set on the top-level object, applies to all of its children
+  for(auto o = &obj; o; o = o->parent) {
+    if(o->persistent)objFlags |= P64::ObjectFlags::PERSISTENT;
+  }
 
   ctx.fileObj.write<uint16_t>(objFlags); // @TODO type
   ctx.fileObj.write<uint16_t>(obj.id);
   ctx.fileObj.write<uint16_t>(obj.parent ? obj.parent->id : 0);
-  ctx.fileObj.write<uint16_t>(0); // padding
+  ctx.fileObj.write<uint8_t>(std::clamp(obj.updateTier, 0, 3));
+  ctx.fileObj.write<uint8_t>(0); // padding
   ctx.fileObj.write(srcObj->pos.resolve(obj.propOverrides));
   ctx.fileObj.write(srcObj->scale.resolve(obj.propOverrides));
 
@@ -113,6 +354,24 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
   std::string fileNameScene = "s" + Utils::padLeft(std::to_string(scene.id), '0', 4);
   std::string fileNameObj = fileNameScene + "o";
 
+  // scenes are only built again if anything they were built from changed, see 'getSceneKey'
+  auto manifestPath = fs::path{project.getPath()} / "build" / "scenes" / (fileNameScene + ".json");
+  auto envKey = getSceneEnvKey(project, scene, ctx);
+  auto manifest = nlohmann::json::parse(Utils::FS::loadTextFile(manifestPath), nullptr, false);
+  if(!manifest.is_discarded() && restoreScene(ctx, manifest, envKey)) {
+    Utils::Logger::log("Scene " + std::to_string(scene.id) + " is up-to-date");
+    return;
+  }
+
+  // a failed build must not leave the old state behind
+  std::error_code err{};
+  fs::remove(manifestPath, err);
+
+  auto filesStart = ctx.files.size();
+  auto assetsStart = ctx.assetList.size();
+  ctx.sceneDeps.clear();
+  ctx.sceneScripts.clear();
+
   std::unique_ptr<Project::Scene> sc{new Project::Scene(scene.id, project.getPath())};
   ctx.scene = sc.get();
 
@@ -122,18 +381,203 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
   uint32_t objCountExpected = sc->objectsMap.size();
   uint32_t objCount = 0;
 
-  if (sc->conf.doClearDepth.value)sceneFlags |= FLAG_CLR_DEPTH;
+  bool hasDepth = usesDepth(sc->conf);
+  if (hasDepth && sc->conf.doClearDepth.value)sceneFlags |= FLAG_CLR_DEPTH;
   if (sc->conf.doClearColor.value)sceneFlags |= FLAG_CLR_COLOR;
+  if (hasDepth && sc->conf.doClearDepth.value && sc->conf.depthSlices.value)sceneFlags |= FLAG_DEPTH_SLICES;
+  if (!hasDepth)sceneFlags |= FLAG_NO_DEPTH;
+  if (sc->conf.doClearColor.value && sc->conf.backdrop.value)sceneFlags |= FLAG_BACKDROP;
   if (sc->conf.fbFormat)sceneFlags |= FLAG_SCR_32BIT;
+  if (sc->conf.dynamicRes.value && sc->conf.renderPipeline.value == 0)sceneFlags |= FLAG_DYN_RES;
+  if (sc->conf.fbCount.value == 2 && sc->conf.renderPipeline.value != 2)sceneFlags |= FLAG_FB_DOUBLE;
+  if (sc->conf.lowLatency.value)sceneFlags |= FLAG_LOW_LATENCY;
+  if (sc->conf.noAlloc.value)sceneFlags |= FLAG_NO_ALLOC;
+  if (sc->conf.lowTier.value)sceneFlags |= FLAG_LOW_TIER;
+  if (sc->conf.lowTier.value && sc->conf.lowTierAuto.value)sceneFlags |= FLAG_QUALITY_AUTO;
+
+  // streamed top-level objects are sorted into cells by their position, everything else is part of the scene itself
+  float chunkSize = (float)sc->conf.chunkSize.value;
+  std::map<std::pair<int16_t, int16_t>, Chunk> chunks{};
 
   ctx.fileObj = {};
+  ctx.sceneAssets.clear();
+  // assets and scripts of persistent objects, those have to stay around after the scene is unloaded
+  std::set<uint32_t> persistentAssets{};
+  std::set<uint64_t> persistentScripts{};
+  bool hasPersistent = false;
+
   auto &rootObj = sc->getRootObject();
-  for (const auto &child : rootObj.children) {
+  for (const auto &child : rootObj.children)
+  {
+    if(child->persistent)
+    {
+      auto assetsScene = ctx.sceneAssets;
+      auto scriptsScene = ctx.sceneScripts;
+      ctx.sceneAssets.clear();
+      ctx.sceneScripts.clear();
+      objCount += writeObject(ctx, *child, false);
+
+      persistentAssets.insert(ctx.sceneAssets.begin(), ctx.sceneAssets.end());
+      persistentScripts.insert(ctx.sceneScripts.begin(), ctx.sceneScripts.end());
+      ctx.sceneAssets.insert(assetsScene.begin(), assetsScene.end());
+      ctx.sceneScripts.insert(scriptsScene.begin(), scriptsScene.end());
+      hasPersistent = true;
+      continue;
+    }
+
+    if(chunkSize > 0 && child->streamed)
+    {
+      auto srcObj = child.get();
+      if(child->isPrefabInstance()) {
+        auto prefab = project.getAssets().getPrefabByUUID(child->uuidPrefab.value);
+        if(prefab)srcObj = &prefab->obj;
+      }
+      auto &pos = srcObj->pos.resolve(child->propOverrides);
+      auto cellX = (int16_t)std::floor(pos.x / chunkSize);
+      auto cellZ = (int16_t)std::floor(pos.z / chunkSize);
+      auto &chunk = chunks[{cellX, cellZ}];
+      chunk.cellX = cellX;
+      chunk.cellZ = cellZ;
+      chunk.objects.push_back(child.get());
+      continue;
+    }
     objCount += writeObject(ctx, *child, false);
   }
 
   ctx.fileObj.writeToFile(fsDataPath / fileNameObj);
 
+  SceneMemStats memStats{
+    .id = (uint32_t)scene.id,
+    .name = sc->conf.name.value,
+    .budgetKB = (uint32_t)std::max(sc->conf.memBudgetKB.value, 0),
+    .objCount = objCount,
+    .objBytes = objCount * OBJECT_BASE_BYTES + ctx.fileObj.getSize(),
+  };
+
+  if(chunks.size() > MAX_CHUNKS) {
+    Utils::Logger::log("Scene " + std::to_string(scene.id) + ": too many chunks ("
+      + std::to_string(chunks.size()) + "), increase the chunk size", Utils::Logger::LEVEL_ERROR);
+    chunks.clear();
+  }
+
+  // assets are collected per chunk, prefabs they spawn are always part of the scene
+  // since spawned objects don't belong to any chunk and may outlive it
+  for(auto &[cell, chunk] : chunks)
+  {
+    auto assetsScene = ctx.sceneAssets;
+    ctx.sceneAssets.clear();
+    ctx.fileObj = {};
+    for(auto obj : chunk.objects) {
+      chunk.objCount += writeObject(ctx, *obj, false);
+    }
+    chunk.file = ctx.fileObj;
+    chunk.assets = ctx.sceneAssets;
+
+    ctx.sceneAssets = assetsScene;
+    for(auto idx : chunk.assets) {
+      if(ctx.assetList[idx].type == (uint32_t)Project::FileType::PREFAB)ctx.sceneAssets.insert(idx);
+    }
+  }
+
+  // prefabs spawned at runtime are not part of the object file,
+  // build them without saving to collect their assets too (this also covers nested prefabs)
+  auto addPrefabAssets = [&]()
+  {
+    std::set<uint32_t> prefabsChecked{};
+    for(bool added=true; added;)
+    {
+      added = false;
+      auto assets = ctx.sceneAssets;
+      for(auto idx : assets)
+      {
+        auto &asset = ctx.assetList[idx];
+        if(asset.type != (uint32_t)Project::FileType::PREFAB || !prefabsChecked.insert(idx).second)continue;
+
+        auto prefab = project.getAssets().getPrefabByUUID(asset.uuid);
+        if(!prefab)continue;
+        ctx.fileObj = {};
+        writeObject(ctx, prefab->obj, true);
+        added = true;
+      }
+    }
+    ctx.fileObj = {};
+  };
+  addPrefabAssets();
+
+  // persistent objects may spawn their prefabs in later scenes too
+  if(hasPersistent)
+  {
+    std::swap(ctx.sceneAssets, persistentAssets);
+    auto scriptsScene = ctx.sceneScripts;
+    addPrefabAssets();
+    std::swap(ctx.sceneAssets, persistentAssets);
+    ctx.sceneScripts = scriptsScene;
+    sceneFlags |= FLAG_PERSISTENT;
+  }
+
+  if(!chunks.empty())
+  {
+    sceneFlags |= FLAG_CHUNKS;
+
+    Utils::BinaryFile fileChunks{};
+    fileChunks.write<float>(chunkSize);
+    fileChunks.write<float>((float)sc->conf.chunkLoadDist.value);
+    fileChunks.write<uint16_t>(chunks.size());
+    fileChunks.write<uint16_t>(0); // padding
+
+    uint32_t chunkIdx = 0;
+    for(auto &[cell, chunk] : chunks)
+    {
+      fileChunks.write<int16_t>(chunk.cellX);
+      fileChunks.write<int16_t>(chunk.cellZ);
+
+      // anything the scene itself uses is already loaded, only the rest is streamed in with the chunk
+      std::vector<uint16_t> assets{};
+      for(auto idx : chunk.assets) {
+        if(!ctx.sceneAssets.contains(idx))assets.push_back(idx);
+      }
+      assets = sortByRomOrder(ctx, assets);
+
+      Utils::BinaryFile fileChunk{};
+      fileChunk.write<uint16_t>(assets.size());
+      fileChunk.write<uint16_t>(chunk.objCount);
+      for(auto idx : assets)fileChunk.write<uint16_t>(idx);
+      fileChunk.align(4);
+      fileChunk.writeMemFile(chunk.file);
+
+      auto &memChunk = memStats.chunks.emplace_back();
+      memChunk.objBytes = chunk.objCount * OBJECT_BASE_BYTES + chunk.file.getSize();
+      for(auto idx : assets)memChunk.assets.push_back(ctx.assetList[idx].uuid);
+      memStats.objCount += chunk.objCount;
+
+      auto fileName = fileNameScene + "k" + Utils::padLeft(std::to_string(chunkIdx++), '0', 3);
+      fileChunk.writeToFile(fsDataPath / fileName);
+      ctx.files.push_back("filesystem/p64/" + fileName);
+    }
+
+    fileChunks.writeToFile(fsDataPath / (fileNameScene + "c"));
+    ctx.files.push_back("filesystem/p64/" + fileNameScene + "c");
+  }
+
+  Utils::BinaryFile filePreload{};
+  auto preloadList = sortByRomOrder(ctx, {ctx.sceneAssets.begin(), ctx.sceneAssets.end()});
+  filePreload.write<uint16_t>(preloadList.size());
+  for(auto idx : preloadList) {
+    filePreload.write<uint16_t>(idx);
+  }
+  filePreload.writeToFile(fsDataPath / (fileNameScene + "a"));
+
+  if(hasPersistent)
+  {
+    Utils::BinaryFile filePersistent{};
+    filePersistent.write<uint16_t>(persistentAssets.size());
+    for(auto idx : persistentAssets) {
+      filePersistent.write<uint16_t>(idx);
+    }
+    filePersistent.writeToFile(fsDataPath / (fileNameScene + "p"));
+    ctx.files.push_back("filesystem/p64/" + fileNameScene + "p");
+  }
+
   ctx.fileScene = {};
   ctx.fileScene.write<uint16_t>(sc->conf.fbWidth);
   ctx.fileScene.write<uint16_t>(sc->conf.fbHeight);
@@ -144,7 +588,26 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
   ctx.fileScene.write<uint8_t>(sc->conf.renderPipeline.value);
   ctx.fileScene.write<uint8_t>(sc->conf.frameLimit.value);
   ctx.fileScene.write<uint8_t>(sc->conf.filter.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.bloomQuality.value);
+  ctx.fileScene.write<uint32_t>(std::max(sc->conf.matrixCapacity.value, 0));
+  ctx.fileScene.write<uint16_t>(sc->conf.audioSampleRate.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.audioBufferCount.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.audioChannelCount.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.tickRate.value);
+  ctx.fileScene.write<uint8_t>(0); // padding
   ctx.fileScene.write<uint8_t>(0); // padding
+  ctx.fileScene.write<uint8_t>(0); // padding
+
+  // SceneConf::TierConf
+  auto toTierScale = [&](float scale) {
+    return (uint8_t)std::clamp((int)std::round(scale * TIER_SCALE_ONE), 1, 255);
+  };
+  ctx.fileScene.write<uint16_t>(sc->conf.lowTierWidth.value);
+  ctx.fileScene.write<uint16_t>(sc->conf.lowTierHeight.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.lowTierBloomQuality.value);
+  ctx.fileScene.write<uint8_t>(sc->conf.lowTierAudioChannels.value);
+  ctx.fileScene.write<uint8_t>(toTierScale(sc->conf.lowTierLodScale.value));
+  ctx.fileScene.write<uint8_t>(toTierScale(sc->conf.lowTierParticleScale.value));
 
   // Layer::Setup
   ctx.fileScene.write<uint8_t>(sc->conf.layers3D.size());
@@ -152,7 +615,29 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
   ctx.fileScene.write<uint8_t>(sc->conf.layers2D.size());
   ctx.fileScene.write<uint8_t>(0); // padding
 
-  auto writeLayer = [&ctx](const Project::LayerConf &layer) {
+  // command buffer sizes, either set per layer or from the peaks recorded by the last benchmark
+  nlohmann::json layerPeaks{};
+  auto pathPeaks = fs::path{project.getPath()} / LAYER_PEAKS_FILE;
+  if(fs::exists(pathPeaks)) {
+    layerPeaks = nlohmann::json::parse(Utils::FS::loadTextFile(pathPeaks), nullptr, false);
+    if(layerPeaks.is_discarded() || !layerPeaks.is_object())layerPeaks = {};
+  }
+  auto peaksIt = layerPeaks.find(std::to_string(scene.id));
+  uint32_t layerIdx = 0;
+
+  auto getBufferWords = [&](const Project::LayerConf &layer) -> uint16_t {
+    if(layer.bufferWords.value)return std::min(layer.bufferWords.value, 0xFFFFu);
+    if(peaksIt == layerPeaks.end() || !peaksIt->is_array() || layerIdx >= peaksIt->size())return 0;
+
+    auto peak = (*peaksIt)[layerIdx].get<uint32_t>();
+    if(peak == 0)return 0;
+    uint32_t words = peak + peak / LAYER_PEAK_MARGIN;
+    words = (words + LAYER_WORDS_ALIGN - 1) & ~(LAYER_WORDS_ALIGN - 1);
+    return std::clamp(words, LAYER_WORDS_MIN, 0xFFFFu & ~(LAYER_WORDS_ALIGN - 1));
+  };
+
+  std::vector<uint16_t> layerWords{};
+  auto writeLayer = [&](const Project::LayerConf &layer) {
     uint32_t flags = 0;
     if(layer.depthWrite.value)flags |= (1 << 0);
     if(layer.depthCompare.value)flags |= (1 << 1);
@@ -167,8 +652,9 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
     ctx.fileScene.write<uint8_t>(fogMode);
 
     ctx.fileScene.write<uint8_t>(0); // padding
-    ctx.fileScene.write<uint8_t>(0); // padding
-    ctx.fileScene.write<uint8_t>(0); // padding
+    layerWords.push_back(getBufferWords(layer));
+    ctx.fileScene.write<uint16_t>(layerWords.back());
+    ++layerIdx;
   };
 
   for(const auto &layer : sc->conf.layers3D)writeLayer(layer);
@@ -180,6 +666,40 @@ void Build::buildScene(Project::Project &project, const Project::SceneEntry &sce
 
   ctx.files.push_back("filesystem/p64/" + fileNameScene);
   ctx.files.push_back("filesystem/p64/" + fileNameObj);
+  ctx.files.push_back("filesystem/p64/" + fileNameScene + "a");
 
   ctx.scene = nullptr;
+
+  // cells within the load distance around the camera, in both directions
+  if(!chunks.empty()) {
+    uint32_t cellRange = 2 * (uint32_t)std::ceil(sc->conf.chunkLoadDist.value / chunkSize) + 1;
+    memStats.chunksLoaded = std::min<uint32_t>(cellRange * cellRange, chunks.size());
+  }
+  uint32_t matrixCapacity = sc->conf.matrixCapacity.value > 0 ? sc->conf.matrixCapacity.value : MATRIX_DEFAULT_CAPACITY;
+  memStats.matrixBytes = std::min(matrixCapacity, memStats.objCount * MATRICES_PER_OBJECT) * MATRIX_BYTES;
+  memStats.layerBytes = getLayerBytes(sc->conf, layerWords);
+  memStats.fbBytes = getFramebufferBytes(sc->conf);
+  memStats.audioChannels = sc->conf.audioChannelCount.value > 0 ? sc->conf.audioChannelCount.value : AUDIO_DEF_CHANNELS;
+  for(auto idx : ctx.sceneAssets)memStats.assets.push_back(ctx.assetList[idx].uuid);
+  memStats.files = {ctx.files.begin() + filesStart, ctx.files.end()};
+
+  std::vector<uint64_t> deps{ctx.sceneDeps.begin(), ctx.sceneDeps.end()};
+  manifest = nlohmann::json::object();
+  manifest["key"] = getSceneKey(ctx, envKey, deps);
+  manifest["deps"] = deps;
+  manifest["files"] = memStats.files;
+  manifest["stats"] = memStats.serialize();
+  manifest["scripts"] = std::vector<uint64_t>{ctx.sceneScripts.begin(), ctx.sceneScripts.end()};
+  manifest["persistentScripts"] = std::vector<uint64_t>{persistentScripts.begin(), persistentScripts.end()};
+  manifest["assets"] = nlohmann::json::array();
+  for(auto i=assetsStart; i<ctx.assetList.size(); ++i) {
+    const auto &asset = ctx.assetList[i];
+    manifest["assets"].push_back({{"romPath", asset.path}, {"type", asset.type}, {"uuid", asset.uuid}});
+  }
+
+  fs::create_directories(manifestPath.parent_path(), err);
+  Utils::FS::saveTextFile(manifestPath, manifest.dump(2));
+  ctx.sceneStats.push_back(std::move(memStats));
+  ctx.scriptsByScene[scene.id] = ctx.sceneScripts;
+  ctx.persistentScripts.insert(persistentScripts.begin(), persistentScripts.end());
 }
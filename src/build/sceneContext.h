@@ -3,8 +3,14 @@
 * @license MIT
 */
 #pragma once
+#include <map>
+#include <set>
 #include <vector>
 
+#include "buildCache.h"
+#include "buildReport.h"
+#include "jobQueue.h"
+#include "romReport.h"
 #include "stringTable.h"
 #include "../utils/binaryFile.h"
 #include "../utils/toolchain.h"
@@ -19,11 +25,41 @@ namespace Build
     uint32_t stringOffset{};
     uint32_t type{};
     uint32_t flags{};
+    uint64_t uuid{};
+  };
+
+  struct AtlasRegion
+  {
+    uint64_t uuid{}; // image packed into the atlas
+    std::string path{};
+    std::string romPath{};
+    uint16_t x{};
+    uint16_t y{};
+    uint16_t width{};
+    uint16_t height{};
+  };
+
+  // small images sharing one sprite, see 'assignAtlases'
+  struct Atlas
+  {
+    std::string name{};
+    uint64_t uuid{};
+    int format{};
+    int compression{};
+    std::string outPath{};
+    std::string romPath{};
+    uint16_t width{};
+    uint16_t height{};
+    std::vector<AtlasRegion> regions{};
   };
 
   struct SceneCtx
   {
     Utils::Toolchain toolchain{};
+    // external tools of the asset builders, all run at once after the last builder (see 'buildProject')
+    JobQueue jobs{};
+    BuildCache cache{};
+    BuildReport report{};
     Project::Project *project{};
     Project::Scene *scene{};
     std::vector<std::string> files{};
@@ -33,12 +69,47 @@ namespace Build
     Utils::BinaryFile fileObj{};
     StringTable strTable{};
     std::vector<uint64_t> graphFunctions{};
+    std::set<uint32_t> graphUserFuncs{}; // CRC32 of all user functions called by node graphs
 
     std::vector<AssetEntry> assetList{};
     std::unordered_map<uint64_t, uint32_t> assetUUIDToIdx{};
     std::string assetFileMap{};
+    // outputs with the same content as another asset, left out of the DFS (see 'dedupAssets')
+    std::set<std::string> dedupFiles{};
+    std::vector<std::pair<uint32_t, uint16_t>> assetHashes{}; // path-hash to index, for the runtime lookup
     uint32_t stringOffset{0};
 
+    // models sharing their main texture get the same group (0 = untextured), see 'buildT3DMAssets'.
+    // the runtime sorts draws by it, so consecutive models can keep the texture in TMEM
+    std::unordered_map<uint64_t, uint16_t> textureGroups{};
+
+    std::vector<Atlas> atlases{};
+    std::unordered_map<uint64_t, uint32_t> atlasOfImage{}; // image UUID -> index into 'atlases'
+    std::string atlasRegionMap{};
+
+    // assets referenced by the scene currently being built, becomes its preload list
+    std::set<uint32_t> sceneAssets{};
+    // UUIDs of all project assets the current scene was built from, to detect changes (see 'buildScene')
+    std::set<uint64_t> sceneDeps{};
+    // object scripts used by the current scene, and by all scenes built or restored so far (scene ID -> UUIDs)
+    std::set<uint64_t> sceneScripts{};
+    std::map<uint32_t, std::set<uint64_t>> scriptsByScene{};
+    // scripts of persistent objects in any scene, those can't be part of a scene overlay
+    std::set<uint64_t> persistentScripts{};
+    // one per scene, built or restored, for the ROM report
+    std::vector<SceneMemStats> sceneStats{};
+
     void addAsset(const Project::AssetManagerEntry &entry);
+
+    /**
+     * Adds the sprite of an atlas, images packed into it resolve to the same index (by UUID and path).
+     */
+    void addAtlas(const Atlas &atlas);
+
+    /**
+     * Looks up the index of an asset and marks it as used by the current scene.
+     * @return iterator into 'assetUUIDToIdx', end() if not found
+     */
+    std::unordered_map<uint64_t, uint32_t>::iterator findAsset(uint64_t uuid);
   };
 }
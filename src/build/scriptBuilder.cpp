@@ -4,18 +4,91 @@
 */
 #include "projectBuilder.h"
 #include "../utils/string.h"
+#include <algorithm>
+#include <array>
 #include <filesystem>
 #include <format>
+#include <set>
+#include <unordered_map>
 
 #include "../utils/fs.h"
+#include "../utils/hash.h"
 #include "../utils/logger.h"
 
 #include "../../../n64/engine/include/script/globalScript.h"
 
 namespace fs = std::filesystem;
 
-void Build::buildScripts(Project::Project &project, SceneCtx &sceneCtx)
+namespace
 {
+  // generated per scene with overlay scripts, see 'buildScripts'
+  constexpr const char* OVERLAY_SRC_DIR = "src/p64/overlay";
+
+  // see 'buildUnitySources', sources are spread by a hash of their path,
+  // so adding or removing one only rebuilds the group it is in
+  constexpr const char* UNITY_SRC_DIR = "src/p64/unity";
+  constexpr uint32_t UNITY_GROUPS = 8;
+  // what scripts usually include, compiled once if 'ProjectConf::unityPCH' is set
+  constexpr const char* UNITY_PCH_HEADERS[] = {"script/userScript.h", "scene/sceneManager.h", "scene/object.h"};
+
+  struct ScriptCode
+  {
+    std::string uuidStr{};
+    std::string decl{};
+    std::string entry{}; // initializer of its 'ScriptEntry'
+  };
+
+  ScriptCode getScriptCode(const Project::AssetManagerEntry &script)
+  {
+    auto src = Utils::FS::loadTextFile(script.path);
+    bool hasInit = Utils::CPP::hasFunction(src, "void", "initDelete");
+    bool hasUpdate = Utils::CPP::hasFunction(src, "void", "update");
+    bool hasDraw = Utils::CPP::hasFunction(src, "void", "draw");
+    bool hasEvent = Utils::CPP::hasFunction(src, "void", "onEvent");
+    bool hasColl = Utils::CPP::hasFunction(src, "void", "onCollision");
+
+    ScriptCode res{};
+    res.uuidStr = std::format("{:016X}", script.getUUID());
+    auto &uuidStr = res.uuidStr;
+
+    res.decl += "  namespace " + uuidStr + " {\nstruct Data;\n";
+    res.decl += " extern uint16_t DATA_SIZE;\n";
+    if(hasInit)res.decl += "void initDelete(Object& obj, Data *data, bool isDelete);\n";
+    if(hasUpdate)res.decl += "void update(Object& obj, Data *data, float deltaTime);\n";
+    if(hasDraw)res.decl += "void draw(Object& obj, Data *data, float deltaTime);\n";
+    if(hasEvent)res.decl += "void onEvent(Object& obj, Data *data, const ObjectEvent& event);\n";
+    if(hasColl)res.decl += "void onCollision(Object& obj, Data *data, const P64::Coll::CollEvent& event);\n";
+    res.decl += "}\n";
+
+    res.entry += "{\n";
+    if(hasInit)res.entry += " .initDelete = (FuncObjInit)" + uuidStr + "::initDelete,\n";
+    if(hasUpdate)res.entry += " .update = (FuncObjDataDelta)" + uuidStr + "::update,\n";
+    if(hasDraw)res.entry += " .draw = (FuncObjDataDelta)" + uuidStr + "::draw,\n";
+    if(hasEvent)res.entry += " .onEvent = (FuncObjDataEvent)" + uuidStr + "::onEvent,\n";
+    if(hasColl)res.entry += " .onColl = (FuncObjDataColl)" + uuidStr + "::onCollision,\n";
+    res.entry += "}";
+    return res;
+  }
+
+  // keeps the file date if nothing changed, so make doesn't rebuild it
+  void saveIfChanged(const fs::path &filePath, const std::string &content)
+  {
+    if(Utils::FS::loadTextFile(filePath) != content)Utils::FS::saveTextFile(filePath, content);
+  }
+}
+
+void Build::assignScriptIndices(Project::Project &project, SceneCtx &sceneCtx)
+{
+  auto scripts = project.getAssets().getTypeEntries(Project::FileType::CODE_OBJ);
+  uint32_t idx = 0;
+  for (auto &script : scripts) {
+    sceneCtx.codeIdxMapUUID[script.getUUID()] = idx++;
+  }
+}
+
+std::string Build::buildScripts(Project::Project &project, SceneCtx &sceneCtx)
+{
+  auto projectPath = fs::path{project.getPath()};
   auto pathTable = project.getPath() + "/src/p64/scriptTable.cpp";
 
   std::string srcEntries = "";
@@ -26,41 +99,96 @@ void Build::buildScripts(Project::Project &project, SceneCtx &sceneCtx)
   std::string graphSwitch = "";
 
   auto scripts = project.getAssets().getTypeEntries(Project::FileType::CODE_OBJ);
-  uint32_t idx = 0;
+
+  // scripts used by any scene are only linked into the overlays of those scenes,
+  // a script used by multiple scenes ends up in all of their overlays.
+  // persistent objects outlive the overlay of their scene, so their scripts always stay in the main binary
+  std::set<uint64_t> overlayScripts{};
+  if(project.conf.scriptOverlays) {
+    for(auto &[sceneId, uuids] : sceneCtx.scriptsByScene) {
+      for(auto uuid : uuids) {
+        if(!sceneCtx.persistentScripts.contains(uuid))overlayScripts.insert(uuid);
+      }
+    }
+  }
+
+  std::unordered_map<uint64_t, ScriptCode> codeByUUID{};
+  std::string overlayIndices = "";
+  std::string overlaySources = "";
   for (auto &script : scripts)
   {
-    auto src = Utils::FS::loadTextFile(script.path);
-    bool hasInit = Utils::CPP::hasFunction(src, "void", "initDelete");
-    bool hasUpdate = Utils::CPP::hasFunction(src, "void", "update");
-    bool hasDraw = Utils::CPP::hasFunction(src, "void", "draw");
-    bool hasEvent = Utils::CPP::hasFunction(src, "void", "onEvent");
-    bool hasColl = Utils::CPP::hasFunction(src, "void", "onCollision");
+    auto code = getScriptCode(script);
+    uint32_t idx = sceneCtx.codeIdxMapUUID[script.getUUID()];
 
-    auto uuidStr = std::format("{:016X}", script.getUUID());
+    if(overlayScripts.contains(script.getUUID())) {
+      // filled in by the overlay once loaded
+      srcEntries += "{},\n";
+      srcSizeEntries += "0,\n";
+      overlayIndices += "    " + std::to_string(idx) + ",\n";
+      overlaySources += " " + Utils::FS::toUnixPath(fs::relative(script.path, projectPath));
+      codeByUUID[script.getUUID()] = std::move(code);
+      continue;
+    }
 
-    srcSizeEntries += uuidStr + "::DATA_SIZE,\n";
+    srcSizeEntries += code.uuidStr + "::DATA_SIZE,\n";
+    srcDecl += code.decl;
+    srcEntries += code.entry + ",\n";
+
+    //Utils::Logger::log("Script: " + code.uuidStr + " -> " + std::to_string(idx));
+  }
 
-    srcDecl += "  namespace " + uuidStr + " {\nstruct Data;\n";
-    srcDecl += " extern uint16_t DATA_SIZE;\n";
-    if(hasInit)srcDecl += "void initDelete(Object& obj, Data *data, bool isDelete);\n";
-    if(hasUpdate)srcDecl += "void update(Object& obj, Data *data, float deltaTime);\n";
-    if(hasDraw)srcDecl += "void draw(Object& obj, Data *data, float deltaTime);\n";
-    if(hasEvent)srcDecl += "void onEvent(Object& obj, Data *data, const ObjectEvent& event);\n";
-    if(hasColl)srcDecl += "void onCollision(Object& obj, Data *data, const P64::Coll::CollEvent& event);\n";
-    srcDecl += "}\n";
+  // one overlay per scene, with a generated source registering its scripts
+  auto overlayDir = projectPath / OVERLAY_SRC_DIR;
+  auto fsDataPath = projectPath / "filesystem" / "p64";
+  std::set<fs::path> overlayFiles{};
+  std::string overlayScenes = "";
+  std::string makeRules = "";
+  std::string dsoList = "";
+  auto srcOverlayTemplate = Utils::FS::loadTextFile("data/scripts/scriptOverlay.cpp");
+
+  for(auto &[sceneId, uuids] : sceneCtx.scriptsByScene)
+  {
+    if(!project.conf.scriptOverlays || uuids.empty())continue;
+
+    std::string decl = "";
+    std::string registers = "";
+    std::string objFiles = "";
+    for(auto uuid : uuids) {
+      auto it = codeByUUID.find(uuid);
+      if(it == codeByUUID.end())continue;
+      auto script = project.getAssets().getEntryByUUID(uuid);
+      auto idxStr = std::to_string(sceneCtx.codeIdxMapUUID[uuid]);
+      decl += it->second.decl;
+      registers += "    table[" + idxStr + "] = ScriptEntry" + it->second.entry + ";\n";
+      registers += "    sizeTable[" + idxStr + "] = " + it->second.uuidStr + "::DATA_SIZE;\n";
+      auto relPath = Utils::FS::toUnixPath(fs::relative(script->path, projectPath));
+      objFiles += " $(BUILD_DIR)/" + relPath.substr(0, relPath.size() - 4) + ".o";
+    }
 
-    srcEntries += "{\n";
-    if(hasInit)srcEntries += " .initDelete = (FuncObjInit)" + uuidStr + "::initDelete,\n";
-    if(hasUpdate)srcEntries += " .update = (FuncObjDataDelta)" + uuidStr + "::update,\n";
-    if(hasDraw)srcEntries += " .draw = (FuncObjDataDelta)" + uuidStr + "::draw,\n";
-    if(hasEvent)srcEntries += " .onEvent = (FuncObjDataEvent)" + uuidStr + "::onEvent,\n";
-    if(hasColl)srcEntries += " .onColl = (FuncObjDataColl)" + uuidStr + "::onCollision,\n";
-    srcEntries += "},\n";
+    auto name = "s" + Utils::padLeft(std::to_string(sceneId), '0', 4);
+    auto srcPath = overlayDir / (name + ".cpp");
+    fs::create_directories(overlayDir);
+    saveIfChanged(srcPath, Utils::replaceAll(srcOverlayTemplate, {
+      {"__CODE_DECL__", decl},
+      {"__CODE_REGISTER__", registers},
+    }));
+    overlayFiles.insert(srcPath);
+    overlayFiles.insert(fsDataPath / (name + ".dso"));
 
-    sceneCtx.codeIdxMapUUID[script.getUUID()] = idx;
+    overlayScenes += "    " + std::to_string(sceneId) + ",\n";
+    dsoList += " filesystem/p64/" + name + ".dso";
+    makeRules += "filesystem/p64/" + name + ".dso: $(BUILD_DIR)/" + OVERLAY_SRC_DIR + "/" + name + ".o" + objFiles + "\n";
+  }
 
-    //Utils::Logger::log("Script: " + uuidStr + " -> " + std::to_string(idx));
-    ++idx;
+  // overlays of scenes that no longer have any (or with the option turned off) would still end up in the ROM
+  std::error_code err{};
+  for(const auto &dir : {overlayDir, fsDataPath}) {
+    for(const auto &entry : fs::directory_iterator{dir, err}) {
+      auto ext = entry.path().extension();
+      if((ext == ".dso" || (ext == ".cpp" && dir == overlayDir)) && !overlayFiles.contains(entry.path())) {
+        fs::remove(entry.path(), err);
+      }
+    }
   }
 
   for(auto &graphUUID : sceneCtx.graphFunctions)
@@ -70,15 +198,28 @@ void Build::buildScripts(Project::Project &project, SceneCtx &sceneCtx)
     graphDecl += "  namespace G" + idStr + " { void run(void* arg); }\n";
   }
 
+  // std::set is already sorted, the runtime does a binary search over it
+  std::string userFuncHashes = "";
+  for(auto crc : sceneCtx.graphUserFuncs) {
+    userFuncHashes += std::format("    0x{:08X},\n", crc);
+  }
+
   auto src = Utils::FS::loadTextFile("data/scripts/scriptTable.cpp");
   src = Utils::replaceAll(src, "__CODE_ENTRIES__", srcEntries);
   src = Utils::replaceAll(src, "__CODE_SIZE_ENTRIES__", srcSizeEntries);
   src = Utils::replaceAll(src, "__CODE_DECL__", srcDecl);
   src = Utils::replaceAll(src, "__GRAPH_SWITCH_CASE__", graphSwitch);
   src = Utils::replaceAll(src, "__GRAPH_DEF__", graphDecl);
-
+  src = Utils::replaceAll(src, "__USER_FUNC_HASHES__", userFuncHashes);
+  src = Utils::replaceAll(src, "__OVERLAY_SCENES__", overlayScenes);
+  src = Utils::replaceAll(src, "__OVERLAY_SCRIPTS__", overlayIndices);
 
   Utils::FS::saveTextFile(pathTable, src);
+
+  if(dsoList.empty())return "";
+  return "src_overlay =" + overlaySources + "\n"
+    + "DSO_LIST =" + dsoList + "\n"
+    + makeRules;
 }
 
 void Build::buildGlobalScripts(Project::Project &project, SceneCtx &sceneCtx)
@@ -88,17 +229,18 @@ void Build::buildGlobalScripts(Project::Project &project, SceneCtx &sceneCtx)
 
   std::string srcDecl = "";
 
-  std::unordered_map<std::string, std::string> enumMap{};
-  enumMap["onGameInit"]        = "GAME_INIT";
-  enumMap["onScenePreLoad"]    = "SCENE_PRE_LOAD";
-  enumMap["onScenePostLoad"]   = "SCENE_POST_LOAD";
-  enumMap["onScenePreUnload"]  = "SCENE_PRE_UNLOAD";
-  enumMap["onScenePostUnload"] = "SCENE_POST_UNLOAD";
-  enumMap["onSceneUpdate"]     = "SCENE_UPDATE";
-  enumMap["onScenePreDraw"]    = "SCENE_PRE_DRAW";
-  enumMap["onScenePreDraw3D"]  = "SCENE_PRE_DRAW_3D";
-  enumMap["onScenePostDraw3D"] = "SCENE_POST_DRAW_3D";
-  enumMap["onSceneDraw2D"]     = "SCENE_DRAW_2D";
+  using P64::GlobalScript::HookType;
+  std::unordered_map<std::string, std::pair<std::string, HookType>> enumMap{};
+  enumMap["onGameInit"]        = {"GAME_INIT",          HookType::GAME_INIT};
+  enumMap["onScenePreLoad"]    = {"SCENE_PRE_LOAD",     HookType::SCENE_PRE_LOAD};
+  enumMap["onScenePostLoad"]   = {"SCENE_POST_LOAD",    HookType::SCENE_POST_LOAD};
+  enumMap["onScenePreUnload"]  = {"SCENE_PRE_UNLOAD",   HookType::SCENE_PRE_UNLOAD};
+  enumMap["onScenePostUnload"] = {"SCENE_POST_UNLOAD",  HookType::SCENE_POST_UNLOAD};
+  enumMap["onSceneUpdate"]     = {"SCENE_UPDATE",       HookType::SCENE_UPDATE};
+  enumMap["onScenePreDraw"]    = {"SCENE_PRE_DRAW",     HookType::SCENE_PRE_DRAW};
+  enumMap["onScenePreDraw3D"]  = {"SCENE_PRE_DRAW_3D",  HookType::SCENE_PRE_DRAW_3D};
+  enumMap["onScenePostDraw3D"] = {"SCENE_POST_DRAW_3D", HookType::SCENE_POST_DRAW_3D};
+  enumMap["onSceneDraw2D"]     = {"SCENE_DRAW_2D",      HookType::SCENE_DRAW_2D};
 
   std::unordered_map<std::string, std::string> nameMap{};
   for (auto &e : enumMap) {
@@ -129,18 +271,107 @@ void Build::buildGlobalScripts(Project::Project &project, SceneCtx &sceneCtx)
     }
   }
 
+  // hooks without any implementation get no case, and are skipped by the runtime before even calling into this
   std::string srcHook = "";
+  uint32_t hookMask = 0;
   for (auto &pair : nameMap)
   {
     if (pair.second.empty())continue;
 
-    srcHook += "case HookType::" + enumMap[pair.first] + ":\n";
+    auto &hook = enumMap[pair.first];
+    hookMask |= 1u << (uint32_t)hook.second;
+    srcHook += "case HookType::" + hook.first + ":\n";
     srcHook += pair.second;
     srcHook += " break;\n";
   }
 
   auto src = Utils::FS::loadTextFile("data/scripts/globalScriptTable.cpp");
   src = Utils::replaceAll(src, "__CODE_DECL__", srcDecl);
+  src = Utils::replaceAll(src, "__HOOK_MASK__", std::format("0x{:X}", hookMask));
   src = Utils::replaceAll(src, "__CODE_HOOKS__", srcHook);
   Utils::FS::saveTextFile(pathTable, src);
-}
\ No newline at end of file
+}
+
+std::string Build::buildUnitySources(Project::Project &project, SceneCtx &sceneCtx)
+{
+  auto projectPath = fs::path{project.getPath()};
+  auto unityDir = projectPath / UNITY_SRC_DIR;
+  std::set<fs::path> unityFiles{};
+
+  std::string rules{};
+  if(project.conf.unityBuild)
+  {
+    // linked into overlays as their own objects, see 'buildScripts'
+    std::set<std::string> overlaySources{};
+    if(project.conf.scriptOverlays) {
+      for(auto &[sceneId, uuids] : sceneCtx.scriptsByScene) {
+        for(auto uuid : uuids) {
+          if(sceneCtx.persistentScripts.contains(uuid))continue;
+          auto script = project.getAssets().getEntryByUUID(uuid);
+          if(script)overlaySources.insert(Utils::FS::toUnixPath(fs::relative(script->path, projectPath)));
+        }
+      }
+    }
+
+    // relative to the project
+    std::vector<std::string> parts{};
+    std::error_code err{};
+    for(const auto &entry : fs::recursive_directory_iterator{projectPath / "src" / "user", err}) {
+      if(!entry.is_regular_file() || entry.path().extension() != ".cpp")continue;
+      auto relPath = Utils::FS::toUnixPath(fs::relative(entry.path(), projectPath));
+      if(!overlaySources.contains(relPath))parts.push_back(relPath);
+    }
+    for(auto uuid : sceneCtx.graphFunctions) {
+      parts.push_back("src/p64/" + Utils::toHex64(uuid) + ".cpp");
+    }
+    std::sort(parts.begin(), parts.end());
+
+    std::array<std::string, UNITY_GROUPS> groups{};
+    for(const auto &part : parts) {
+      groups[Utils::Hash::crc32(part) % UNITY_GROUPS] += "#include \"../../../" + part + "\"\n";
+    }
+
+    fs::create_directories(unityDir);
+    std::string header = "// NOTE: Auto-Generated File!\n// Unity build of user scripts and node graphs, see 'Build::buildUnitySources'\n\n";
+    if(project.conf.unityPCH) {
+      std::string pch = "#pragma once\n";
+      for(auto inc : UNITY_PCH_HEADERS)pch += std::string{"#include <"} + inc + ">\n";
+      saveIfChanged(unityDir / "pch.h", header + pch);
+      unityFiles.insert(unityDir / "pch.h");
+      unityFiles.insert(unityDir / "pch.h.gch");
+      // has to come first, otherwise GCC ignores the precompiled version
+      header += "#include \"pch.h\"\n";
+    }
+
+    std::string unitySources{};
+    for(uint32_t i = 0; i < UNITY_GROUPS; ++i) {
+      if(groups[i].empty())continue;
+      auto name = "u" + std::to_string(i) + ".cpp";
+      saveIfChanged(unityDir / name, header + groups[i]);
+      unityFiles.insert(unityDir / name);
+      unitySources += std::string{" "} + UNITY_SRC_DIR + "/" + name;
+    }
+
+    rules += "src_unity_parts = " + Utils::join(parts, " ") + "\n";
+    rules += "src_unity =" + unitySources + "\n";
+    rules += "src += $(src_unity)\n";
+    rules += std::string{"$(BUILD_DIR)/"} + UNITY_SRC_DIR + "/%.o: N64_CXXFLAGS += -Wno-attributes\n";
+    rules += std::string{"-include $(wildcard $(BUILD_DIR)/"} + UNITY_SRC_DIR + "/*.d)\n";
+    if(project.conf.unityPCH) {
+      auto pchPath = std::string{UNITY_SRC_DIR} + "/pch.h";
+      rules += pchPath + ".gch: " + pchPath + " $(ENGINE_DIR)/build/engine.a\n"
+        + "\t@mkdir -p $(BUILD_DIR)/" + UNITY_SRC_DIR + "\n"
+        + "\t@echo \"    [PCH] $@\"\n"
+        + "\t$(N64_CXX) -c $(CXXFLAGS) $(N64_CXXFLAGS) -Wno-attributes -x c++-header -MMD -MP -MT $@ -MF $(BUILD_DIR)/"
+          + UNITY_SRC_DIR + "/pch.d -o $@ $<\n"
+        + "$(src_unity:%.cpp=$(BUILD_DIR)/%.o): " + pchPath + ".gch\n";
+    }
+  }
+
+  // groups that are empty now (or the whole mode turned off) would still be compiled
+  std::error_code err{};
+  for(const auto &entry : fs::directory_iterator{unityDir, err}) {
+    if(!unityFiles.contains(entry.path()))fs::remove(entry.path(), err);
+  }
+  return rules;
+}
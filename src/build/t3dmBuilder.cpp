@@ -5,15 +5,129 @@
 #include "projectBuilder.h"
 #include "../utils/string.h"
 #include <filesystem>
+#include <map>
 
 #include "../utils/binaryFile.h"
 #include "../utils/fs.h"
 #include "../utils/logger.h"
 #include "../utils/proc.h"
+#include "../renderer/scene.h"
+#include "../shader/defines.h"
 #include "tiny3d/tools/gltf_importer/src/parser.h"
+#include "glm/glm.hpp"
 
 namespace fs = std::filesystem;
 
+namespace
+{
+  // lights as the runtime applies them: ambient colors add up, all others act as directional lights
+  struct BakeLights
+  {
+    glm::vec3 ambient{};
+    std::vector<std::pair<glm::vec3, glm::vec3>> dirs{}; // direction, color
+  };
+
+  std::string getBakeScenePath(Project::Project &project, int sceneId) {
+    return project.getPath() + "/data/scenes/" + std::to_string(sceneId) + "/scene.json";
+  }
+
+  void collectLights(Project::Project &project, Project::Object &obj, BakeLights &res)
+  {
+    for(const auto &child : obj.children)
+    {
+      if(!child->enabled)continue;
+
+      std::vector<Project::Component::Entry*> compList{};
+      if(child->isPrefabInstance()) {
+        auto prefab = project.getAssets().getPrefabByUUID(child->uuidPrefab.value);
+        if(prefab) {
+          for(auto &comp : prefab->obj.components)compList.push_back(&comp);
+        }
+      }
+      for(auto &comp : child->components)compList.push_back(&comp);
+
+      for(auto comp : compList) {
+        if(Project::Component::TABLE[comp->id].funcBuild != Project::Component::Light::build)continue;
+        Renderer::Light light{};
+        Project::Component::Light::getLight(*child, *comp, light);
+        if(light.type == 0) {
+          res.ambient += glm::vec3{light.color};
+        } else {
+          res.dirs.push_back({light.dir, glm::vec3{light.color}});
+        }
+      }
+
+      collectLights(project, *child, res);
+    }
+  }
+
+  // 5,6,5 packed normal, see 'unpackNormals' in the n64 shader
+  glm::vec3 unpackNormal(uint16_t packed)
+  {
+    glm::ivec3 comp{(packed >> 11) & 0x1F, (packed >> 5) & 0x3F, packed & 0x1F};
+    if(comp.x & 0x10)comp.x -= 0x20;
+    if(comp.y & 0x20)comp.y -= 0x40;
+    if(comp.z & 0x10)comp.z -= 0x20;
+    auto norm = glm::vec3{comp} / glm::vec3{15.0f, 31.0f, 15.0f};
+    float len = glm::length(norm);
+    return len > 0.0f ? (norm / len) : glm::vec3{0,1,0};
+  }
+
+  /**
+   * Texture covering the most triangles of a model, empty if it has none.
+   * That's the one most likely still loaded if the next model uses it too.
+   */
+  std::string getMainTexture(const T3DM::T3DMData &t3dm)
+  {
+    std::map<std::string, size_t> triCount{};
+    for(auto &model : t3dm.models) {
+      if(!model.material.texA.texPath.empty()) {
+        triCount[model.material.texA.texPath] += model.triangles.size();
+      }
+    }
+
+    std::string res{};
+    size_t maxCount = 0;
+    for(auto &[path, count] : triCount) {
+      if(count > maxCount) {
+        maxCount = count;
+        res = path;
+      }
+    }
+    return res;
+  }
+
+  /**
+   * Multiplies the lights into the vertex colors and marks the materials as unlit.
+   * This assumes the model is placed without rotation, as normals are kept in model-space.
+   */
+  void bakeLighting(T3DM::T3DMData &t3dm, const BakeLights &lights)
+  {
+    for(auto &model : t3dm.models)
+    {
+      auto &mat = model.material;
+      if(!(mat.drawFlags & T3D_FLAG_SHADED) || (mat.drawFlags & T3D_FLAG_NO_LIGHT))continue;
+      mat.drawFlags |= T3D_FLAG_NO_LIGHT;
+
+      for(auto &tri : model.triangles) {
+        for(auto &vert : tri.vert)
+        {
+          auto norm = unpackNormal(vert.norm);
+          glm::vec3 light = lights.ambient;
+          for(auto &[dir, color] : lights.dirs) {
+            light += color * glm::max(glm::dot(norm, dir), 0.0f);
+          }
+          light = glm::clamp(light, 0.0f, 1.0f);
+
+          glm::vec3 col{(vert.rgba >> 24) & 0xFF, (vert.rgba >> 16) & 0xFF, (vert.rgba >> 8) & 0xFF};
+          glm::u8vec3 res{glm::round(col * light)};
+          vert.rgba = ((uint32_t)res.r << 24) | ((uint32_t)res.g << 16) | ((uint32_t)res.b << 8) | (vert.rgba & 0xFF);
+        }
+      }
+    }
+  }
+}
+
 bool Build::buildT3DCollision(
   Project::Project &project, SceneCtx &sceneCtx,
   const std::unordered_set<std::string> &meshes,
@@ -21,6 +135,7 @@ bool Build::buildT3DCollision(
   uint64_t newUUID
 )
 {
+  sceneCtx.sceneDeps.insert(orgUUID);
   auto model = project.getAssets().getEntryByUUID(orgUUID);
   if(!model) {
     Utils::Logger::log("T3DM Collision Build: Model not found!", Utils::Logger::LEVEL_ERROR);
@@ -43,23 +158,40 @@ bool Build::buildT3DCollision(
   printf("Building T3DM Collision: %s\n", outPath.string().c_str());
   //printf(" asset: %d | %d\n", sceneCtx.files.size(), sceneCtx.assetUUIDToIdx.size());
 
-  auto collData = Build::buildCollision(model->path, model->conf.baseScale, meshes);
+  auto collData = Build::buildCollision(*model, meshes);
   collData.writeToFile(outPath.string());
 
   fs::path mkAsset = fs::path{project.conf.pathN64Inst} / "bin" / "mkasset";
-  std::string cmd = mkAsset.string() + " -c 1";;
-  cmd += " -o \"" + outPath.parent_path().string() + "\"";
-  cmd += " \"" + outPath.string() + "\"";
+  std::vector<std::string> args{mkAsset.string(), "-c", "1", "-o", outPath.parent_path().string(), outPath.string()};
 
-  if(!sceneCtx.toolchain.runCmdSyncLogged(cmd)) {
-    return false;
-  }
+  sceneCtx.jobs.add(outPath.string(), [&toolchain = sceneCtx.toolchain, args](std::string &log) {
+    return toolchain.runToolSync(args, log);
+  });
 
   sceneCtx.addAsset(entry);
 
   return true;
 }
 
+void Build::assignTextureGroups(Project::Project &project, SceneCtx &sceneCtx)
+{
+  auto &models = project.getAssets().getTypeEntries(Project::FileType::MODEL_3D);
+
+  // groups are numbered by texture path, so they are stable between builds
+  std::map<std::string, std::vector<uint64_t>> textureUsers{};
+  for (auto &model : models) {
+    auto tex = getMainTexture(model.t3dmData);
+    if(!tex.empty())textureUsers[tex].push_back(model.conf.uuid);
+  }
+
+  sceneCtx.textureGroups.clear();
+  uint16_t groupIdx = 0;
+  for(auto &[tex, users] : textureUsers) {
+    ++groupIdx;
+    for(auto uuid : users)sceneCtx.textureGroups[uuid] = groupIdx;
+  }
+}
+
 bool Build::buildT3DMAssets(Project::Project &project, SceneCtx &sceneCtx)
 {
   fs::path mkAsset = fs::path{project.conf.pathN64Inst} / "bin" / "mkasset";
@@ -73,26 +205,69 @@ bool Build::buildT3DMAssets(Project::Project &project, SceneCtx &sceneCtx)
 
     sceneCtx.files.push_back(Utils::FS::toUnixPath(model.outPath));
 
-    if(assetBuildNeeded(model, t3dmPath)) {
+    // the importer is part of the editor, and baked lights come from a scene
+    bool bakeLight = model.conf.gltfBakeLight.value;
+    std::string extraKey = std::to_string(Utils::FS::getFileAge(Utils::Proc::getSelfPath()));
+    if(bakeLight) {
+      extraKey += Utils::FS::loadTextFile(getBakeScenePath(project, model.conf.gltfBakeScene.value));
+    }
+
+    if(!sceneCtx.cache.isCached(model, t3dmPath, mkAsset, extraKey)) {
       fs::create_directories(t3dmDir);
 
+      uint32_t animRate = model.conf.getAnimSampleRate();
+      if(model.conf.gltfAnimAuto.value) {
+        auto anim = analyzeAnimations(model.path, (float)model.conf.baseScale, model.conf.getAnimMaxError());
+        animRate = anim.sampleRate;
+        if(anim.bytesDefault) {
+          Utils::Logger::log("T3DM: anim-rate " + std::to_string(animRate) + " Hz, "
+            + std::to_string(anim.bytesDefault) + " -> " + std::to_string(anim.bytesPicked) + " bytes: " + model.name);
+        }
+      }
+
+      // the asset-manager already parsed it when loading the project, copied since baking modifies it
+      T3DM::T3DMData t3dm{};
+      bool parseReusable = animRate == model.conf.getAnimSampleRate() && model.t3dmParseKey == model.getT3DMParseKey();
+      if(!model.t3dmData.models.empty() && parseReusable) {
+        t3dm = model.t3dmData;
+      } else {
+        t3dm = Project::AssetManager::parseModel(model, (int)animRate, fs::absolute(project.getPath() + "/assets").string());
+      }
+
+      // set after parsing, which configures the importer on its own
       T3DM::config = {
         .globalScale = (float)model.conf.baseScale,
-        .animSampleRate = 60,
+        .animSampleRate = (int)animRate,
         //.ignoreMaterials = args.checkArg("--ignore-materials"),
         //.ignoreTransforms = args.checkArg("--ignore-transforms"),
-        .createBVH = model.conf.gltfBVH,
+        .createBVH = needsBVH(model),
         .verbose = false,
         .assetPath = "assets/",
         .assetPathFull = fs::absolute(project.getPath() + "/assets").string(),
       };
 
-      auto t3dm = T3DM::parseGLTF(model.path.c_str());
+      if(model.conf.gltfVertexCache.value) {
+        auto stats = optimizeVertexCache(t3dm);
+        Utils::Logger::log("T3DM: vertex loads " + std::to_string(stats.loadsBefore) + " -> "
+          + std::to_string(stats.loadsAfter) + ": " + model.name);
+      }
+
+      if(bakeLight) {
+        int sceneId = model.conf.gltfBakeScene.value;
+        if(fs::exists(getBakeScenePath(project, sceneId))) {
+          Project::Scene scene{sceneId, project.getPath()};
+          BakeLights lights{};
+          collectLights(project, scene.getRootObject(), lights);
+          bakeLighting(t3dm, lights);
+        } else {
+          Utils::Logger::log("T3DM: scene to bake lights from not found: " + model.name, Utils::Logger::LEVEL_WARN);
+        }
+      }
 
       std::vector<T3DM::CustomChunk> customChunks{};
 
       if(model.conf.gltfCollision.value) {
-        customChunks.emplace_back('0', buildCollision(model.path, T3DM::config.globalScale).getData());
+        customChunks.emplace_back('0', buildCollision(model).getData());
       }
 
       T3DM::writeT3DM(t3dm, t3dmPath.string().c_str(), projectPath, customChunks);
@@ -100,13 +275,12 @@ bool Build::buildT3DMAssets(Project::Project &project, SceneCtx &sceneCtx)
       int compr = (int)model.conf.compression - 1;
       if(compr < 0)compr = 1; // @TODO: pull default compression level
 
-      std::string cmd = mkAsset.string() + " -c " + std::to_string(compr);
-      cmd += " -o \"" + t3dmDir.string() + "\"";
-      cmd += " \"" + t3dmPath.string() + "\"";
+      std::vector<std::string> args{mkAsset.string(), "-c", std::to_string(compr), "-o", t3dmDir.string(), t3dmPath.string()};
 
-      if(!sceneCtx.toolchain.runCmdSyncLogged(cmd)) {
-        return false;
-      }
+      // parsing has to stay here, the importer keeps its settings in a global
+      sceneCtx.jobs.add(model.path, [&toolchain = sceneCtx.toolchain, args](std::string &log) {
+        return toolchain.runToolSync(args, log);
+      });
     }
 
     // search for all files containing *.sdata
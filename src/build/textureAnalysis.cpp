@@ -0,0 +1,240 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+#include "../utils/textureFormats.h"
+#include "lodepng.h"
+
+using Utils::TexFormat;
+
+namespace
+{
+  // smallest format reaching this is picked, it's about where banding stops being visible on a CRT
+  constexpr float TARGET_PSNR = 36.0f;
+  constexpr float MAX_PSNR = 99.0f; // lossless
+
+  struct Pixel
+  {
+    uint8_t r, g, b, a;
+  };
+
+  constexpr std::array<TexFormat, 9> CANDIDATES{
+    TexFormat::I4, TexFormat::IA4, TexFormat::CI4,
+    TexFormat::I8, TexFormat::IA8, TexFormat::CI8,
+    TexFormat::IA16, TexFormat::RGBA16, TexFormat::RGBA32,
+  };
+
+  uint32_t getBitsPerPixel(TexFormat fmt)
+  {
+    switch(fmt) {
+      case TexFormat::I4: case TexFormat::IA4: case TexFormat::CI4: return 4;
+      case TexFormat::I8: case TexFormat::IA8: case TexFormat::CI8: return 8;
+      case TexFormat::IA16: case TexFormat::RGBA16: return 16;
+      default: return 32;
+    }
+  }
+
+  uint32_t getPaletteSize(TexFormat fmt) {
+    if(fmt == TexFormat::CI4)return 16 * 2;
+    if(fmt == TexFormat::CI8)return 256 * 2;
+    return 0;
+  }
+
+  // the RDP expands channels by repeating the bits, e.g. 5-bit 'abcde' -> 'abcdeabc'
+  uint8_t expand(uint32_t val, uint32_t bits)
+  {
+    val &= (1 << bits) - 1;
+    uint32_t res = 0;
+    for(int shift = 8 - bits; shift > -(int)bits; shift -= bits) {
+      res |= shift >= 0 ? (val << shift) : (val >> -shift);
+    }
+    return res & 0xFF;
+  }
+
+  uint8_t reduce(uint8_t val, uint32_t bits) {
+    return expand((val * ((1 << bits) - 1) + 127) / 255, bits);
+  }
+
+  uint8_t getIntensity(const Pixel &p) {
+    return (uint8_t)std::lround(p.r * 0.299f + p.g * 0.587f + p.b * 0.114f);
+  }
+
+  Pixel toRGBA16(const Pixel &p) {
+    return {reduce(p.r, 5), reduce(p.g, 5), reduce(p.b, 5), (uint8_t)(p.a >= 128 ? 0xFF : 0)};
+  }
+
+  uint32_t colorDist(const Pixel &a, const Pixel &b) {
+    int dr = a.r - b.r, dg = a.g - b.g, db = a.b - b.b, da = a.a - b.a;
+    return dr*dr + dg*dg + db*db + da*da;
+  }
+
+  /**
+   * Median-cut palette, the box with the widest channel range is split at its median until there are enough colors.
+   * Palette entries are RGBA16, as that's what CI textures use on the N64.
+   */
+  std::vector<Pixel> buildPalette(const std::vector<Pixel> &pixels, uint32_t maxColors)
+  {
+    std::map<uint32_t, uint32_t> counts{};
+    auto pack = [](const Pixel &p) { return ((uint32_t)p.r << 24) | ((uint32_t)p.g << 16) | ((uint32_t)p.b << 8) | p.a; };
+    for(auto &p : pixels)++counts[pack(toRGBA16(p))];
+
+    std::vector<Pixel> colors{};
+    for(auto &[col, count] : counts) {
+      colors.push_back({(uint8_t)(col >> 24), (uint8_t)(col >> 16), (uint8_t)(col >> 8), (uint8_t)col});
+    }
+    if(colors.size() <= maxColors)return colors;
+
+    struct Box { uint32_t start, end; };
+    std::vector<Box> boxes{{0, (uint32_t)colors.size()}};
+
+    auto getRange = [&](const Box &box, int &channel) {
+      std::array<int, 4> minC{255,255,255,255}, maxC{0,0,0,0};
+      for(uint32_t i=box.start; i<box.end; ++i) {
+        const uint8_t* c = &colors[i].r;
+        for(int ch=0; ch<4; ++ch) {
+          minC[ch] = std::min<int>(minC[ch], c[ch]);
+          maxC[ch] = std::max<int>(maxC[ch], c[ch]);
+        }
+      }
+      int best = 0;
+      channel = 0;
+      for(int ch=0; ch<4; ++ch) {
+        if(maxC[ch] - minC[ch] > best) { best = maxC[ch] - minC[ch]; channel = ch; }
+      }
+      return best;
+    };
+
+    while(boxes.size() < maxColors)
+    {
+      int bestBox = -1, bestRange = 0, bestChannel = 0;
+      for(uint32_t b=0; b<boxes.size(); ++b) {
+        int channel;
+        int range = boxes[b].end - boxes[b].start > 1 ? getRange(boxes[b], channel) : 0;
+        if(range > bestRange) { bestRange = range; bestBox = b; bestChannel = channel; }
+      }
+      if(bestBox < 0)break;
+
+      auto box = boxes[bestBox];
+      std::sort(colors.begin() + box.start, colors.begin() + box.end, [&](const Pixel &a, const Pixel &b) {
+        return (&a.r)[bestChannel] < (&b.r)[bestChannel];
+      });
+      uint32_t mid = (box.start + box.end) / 2;
+      boxes[bestBox] = {box.start, mid};
+      boxes.push_back({mid, box.end});
+    }
+
+    // box averages, weighted by how often each color is used
+    std::vector<Pixel> palette{};
+    for(auto &box : boxes)
+    {
+      std::array<uint64_t, 4> sum{};
+      uint64_t total = 0;
+      for(uint32_t i=box.start; i<box.end; ++i) {
+        auto count = counts[pack(colors[i])];
+        const uint8_t* c = &colors[i].r;
+        for(int ch=0; ch<4; ++ch)sum[ch] += (uint64_t)c[ch] * count;
+        total += count;
+      }
+      palette.push_back(toRGBA16({
+        (uint8_t)(sum[0] / total), (uint8_t)(sum[1] / total), (uint8_t)(sum[2] / total), (uint8_t)(sum[3] / total)
+      }));
+    }
+    return palette;
+  }
+
+  std::vector<Pixel> convert(const std::vector<Pixel> &pixels, TexFormat fmt)
+  {
+    std::vector<Pixel> res{};
+    res.reserve(pixels.size());
+
+    if(fmt == TexFormat::CI4 || fmt == TexFormat::CI8)
+    {
+      auto palette = buildPalette(pixels, fmt == TexFormat::CI4 ? 16 : 256);
+      for(auto &p : pixels) {
+        auto best = palette[0];
+        for(auto &col : palette) {
+          if(colorDist(p, col) < colorDist(p, best))best = col;
+        }
+        res.push_back(best);
+      }
+      return res;
+    }
+
+    for(auto &p : pixels)
+    {
+      uint8_t i = getIntensity(p);
+      switch(fmt)
+      {
+        // the alpha of intensity formats is the intensity itself
+        case TexFormat::I4 : i = reduce(i, 4); res.push_back({i, i, i, i}); break;
+        case TexFormat::I8 : res.push_back({i, i, i, i}); break;
+        case TexFormat::IA4: i = reduce(i, 3); res.push_back({i, i, i, (uint8_t)(p.a >= 128 ? 0xFF : 0)}); break;
+        case TexFormat::IA8: i = reduce(i, 4); res.push_back({i, i, i, reduce(p.a, 4)}); break;
+        case TexFormat::IA16: res.push_back({i, i, i, p.a}); break;
+        case TexFormat::RGBA16: res.push_back(toRGBA16(p)); break;
+        default: res.push_back(p); break;
+      }
+    }
+    return res;
+  }
+
+  // alpha of opaque images is not compared, it only matters if something blends with them
+  float getPSNR(const std::vector<Pixel> &a, const std::vector<Pixel> &b, bool withAlpha)
+  {
+    double err = 0;
+    for(size_t i=0; i<a.size(); ++i) {
+      int dr = a[i].r - b[i].r, dg = a[i].g - b[i].g, db = a[i].b - b[i].b, da = a[i].a - b[i].a;
+      err += dr*dr + dg*dg + db*db + (withAlpha ? da*da : 0);
+    }
+    double mse = err / (a.size() * (withAlpha ? 4 : 3));
+    if(mse <= 0.0)return MAX_PSNR;
+    return std::min<float>(10.0 * std::log10(255.0 * 255.0 / mse), MAX_PSNR);
+  }
+}
+
+bool Build::analyzeTextureFormat(const std::string &pngPath, TextureFormatStats &stats)
+{
+  std::vector<uint8_t> data{};
+  uint32_t width{}, height{};
+  if(lodepng::decode(data, width, height, pngPath) != 0 || width == 0 || height == 0)return false;
+
+  std::vector<Pixel> pixels(width * height);
+  bool isOpaque = true;
+  for(size_t i=0; i<pixels.size(); ++i) {
+    pixels[i] = {data[i*4], data[i*4+1], data[i*4+2], data[i*4+3]};
+    if(pixels[i].a != 0xFF)isOpaque = false;
+  }
+
+  stats = {};
+  stats.recommended = TexFormat::RGBA32;
+  float bestPSNR = -1.0f;
+  bool found = false;
+  for(auto fmt : CANDIDATES)
+  {
+    // intensity formats return the intensity as alpha, which only works if there is no separate alpha
+    if(!isOpaque && (fmt == TexFormat::I4 || fmt == TexFormat::I8))continue;
+
+    TextureFormatStats::Entry entry{
+      .format = fmt,
+      .size = width * height * getBitsPerPixel(fmt) / 8 + getPaletteSize(fmt),
+      .psnr = getPSNR(pixels, convert(pixels, fmt), !isOpaque),
+    };
+    stats.entries.push_back(entry);
+
+    // candidates are sorted by size, the first one good enough wins, otherwise the best looking one
+    if(!found && entry.psnr >= TARGET_PSNR) {
+      stats.recommended = fmt;
+      found = true;
+    }
+    if(!found && entry.psnr > bestPSNR) {
+      bestPSNR = entry.psnr;
+      stats.recommended = fmt;
+    }
+  }
+  return true;
+}
@@ -4,6 +4,7 @@
 */
 #include "projectBuilder.h"
 #include "../utils/string.h"
+#include <cmath>
 #include <filesystem>
 
 #include "../utils/textureFormats.h"
@@ -23,6 +24,7 @@ bool Build::buildTextureAssets(Project::Project &project, SceneCtx &sceneCtx)
   for (auto &image : images)
   {
     if (image.conf.exclude)continue;
+    if (sceneCtx.atlasOfImage.contains(image.getUUID()))continue; // see 'buildAtlasAssets'
 
     auto outPath = image.outPath;
     if(image.conf.format == (int)Utils::TexFormat::BCI_256) {
@@ -36,25 +38,50 @@ bool Build::buildTextureAssets(Project::Project &project, SceneCtx &sceneCtx)
     auto assetDir = assetPath.parent_path();
     fs::create_directories(assetDir);
 
-    if(!assetBuildNeeded(image, assetPath.string()))continue;
+    bool isBCI = image.conf.format == (int)Utils::TexFormat::BCI_256;
+    // the format picked for 'Auto' depends on the analysis in the editor
+    bool isAuto = image.conf.format == (int)Utils::TexFormat::AUTO;
+    std::string extraKey = isAuto ? std::to_string(Utils::FS::getFileAge(Utils::Proc::getSelfPath())) : "";
+    if(sceneCtx.cache.isCached(image, assetPath, isBCI ? fs::path{Utils::Proc::getSelfPath()} : mkSprite, extraKey))continue;
 
     int compr = (int)image.conf.compression - 1;
     if(compr < 0)compr = 1; // @TODO: pull default compression level
 
-    if(image.conf.format == (int)Utils::TexFormat::BCI_256)
+    if(isBCI)
     {
-      BCI::convertPNG(image.path, assetPath.string());
-    } else {
-      std::string cmd = mkSprite.string() + " -c " + std::to_string(compr);
-      if (image.conf.format != 0) {
-        cmd += std::string{" -f "} + Utils::TEX_TYPES[image.conf.format];
-      }
-      cmd += " -o \"" + assetDir.string() + "\"";
-      cmd += " \"" + image.path + "\"";
-
-      if(!sceneCtx.toolchain.runCmdSyncLogged(cmd)) {
+      // each texture is its own job, so they convert in parallel with everything else
+      sceneCtx.jobs.add(image.path, [pathIn = image.path, pathOut = assetPath.string()](std::string &log) {
+        if(BCI::convertPNG(pathIn, pathOut))return true;
+        log += "BCI conversion failed: " + pathIn + "\n";
         return false;
-      }
+      });
+    } else {
+      std::vector<std::string> args{mkSprite.string(), "-c", std::to_string(compr)};
+      std::vector<std::string> argsEnd{"-o", assetDir.string(), image.path};
+
+      // 'Auto' is picked by comparing all formats, done in the job as it has to convert the image for each
+      int format = image.conf.format;
+      sceneCtx.jobs.add(image.path, [&toolchain = sceneCtx.toolchain, args, argsEnd, format, path = image.path](std::string &log) {
+        auto texFormat = (Utils::TexFormat)format;
+        if(texFormat == Utils::TexFormat::AUTO) {
+          TextureFormatStats stats{};
+          if(analyzeTextureFormat(path, stats)) {
+            texFormat = stats.recommended;
+            for(auto &entry : stats.entries) {
+              if(entry.format != texFormat)continue;
+              log += "Texture format: " + std::string{Utils::getTexFormatName(texFormat)} + ", "
+                + std::to_string(entry.size) + " bytes, " + std::to_string((int)std::lround(entry.psnr)) + "dB PSNR: " + path + "\n";
+            }
+          }
+        }
+
+        auto fullArgs = args;
+        if(texFormat != Utils::TexFormat::AUTO) {
+          fullArgs.insert(fullArgs.end(), {"-f", Utils::getTexFormatName(texFormat)});
+        }
+        fullArgs.insert(fullArgs.end(), argsEnd.begin(), argsEnd.end());
+        return toolchain.runToolSync(fullArgs, log);
+      });
     }
   }
   return true;
@@ -23,9 +23,6 @@ namespace
     Color operator/(int val) const {
       return {r / val, g / val, b / val};
     }
-    double distance(const Color& other) const {
-      return sqrt(pow(r - other.r, 2) + pow(g - other.g, 2) + pow(b - other.b, 2));
-    }
     bool operator==(const Color&other) const {
       return r == other.r && g == other.g && b == other.b;
     }
@@ -36,31 +33,51 @@ namespace
     }
   };
 
-  using Block = array<Color, 16>;  // 4x4 block of pixels
+  // 4x4 block of pixels, stored per channel so the loops over all pixels get vectorised
+  struct Block {
+    alignas(16) array<int32_t, 16> r{};
+    alignas(16) array<int32_t, 16> g{};
+    alignas(16) array<int32_t, 16> b{};
+
+    Color get(int i) const { return {r[i], g[i], b[i]}; }
+  };
   using Palette = array<Color, 4>; // 4-color palette
-  using Indices = array<int, 16>;  // Indices for each pixel in the block
+  using Indices = array<int32_t, 16>;  // Indices for each pixel in the block
+
+  // xorshift, 'rand()' is shared by all threads and textures are converted in parallel
+  uint32_t nextRandom(uint32_t &state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+  }
 
-  // Initialize K-means with random colors from the block
-  void initialize_palette(const Block& block, Palette& palette) {
+  // Initialize K-means with random colors from the block, seeded by its position so the output is always the same
+  void initialize_palette(const Block& block, Palette& palette, uint32_t seed) {
+    uint32_t state = seed * 2654435761u + 1;
+    if(state == 0)state = 1;
     for (int i = 0; i < 4; ++i) {
-      palette[i] = block[rand() % 16];
+      palette[i] = block.get(nextRandom(state) % 16);
     }
   }
 
-  // Assign each pixel to the nearest palette color
+  // Assign each pixel to the nearest palette color, squared distances pick the same one
   Indices assign_clusters(const Block& block, const Palette& palette) {
-    Indices assignments;
-    for (int i = 0; i < 16; ++i) {
-      double min_dist = numeric_limits<double>::max();
-      int best_cluster = 0;
-      for (int j = 0; j < 4; ++j) {
-        double dist = block[i].distance(palette[j]);
-        if (dist < min_dist) {
-          min_dist = dist;
-          best_cluster = j;
-        }
+    Indices assignments{};
+    array<int32_t, 16> minDist;
+    minDist.fill(numeric_limits<int32_t>::max());
+
+    for (int j = 0; j < 4; ++j) {
+      const auto &col = palette[j];
+      for (int i = 0; i < 16; ++i) {
+        int32_t dr = block.r[i] - col.r;
+        int32_t dg = block.g[i] - col.g;
+        int32_t db = block.b[i] - col.b;
+        int32_t dist = dr*dr + dg*dg + db*db;
+        bool closer = dist < minDist[i];
+        minDist[i] = closer ? dist : minDist[i];
+        assignments[i] = closer ? j : assignments[i];
       }
-      assignments[i] = best_cluster;
     }
     return assignments;
   }
@@ -72,7 +89,7 @@ namespace
 
     for (int i = 0; i < 16; ++i) {
       int cluster = assignments[i];
-      new_colors[cluster] = new_colors[cluster] + block[i];
+      new_colors[cluster] = new_colors[cluster] + block.get(i);
       counts[cluster]++;
     }
 
@@ -84,9 +101,9 @@ namespace
   }
 
   // K-means clustering to generate a 4-color palette and indices
-  pair<Palette, Indices> kmeansPalette(const Block& block, int max_iters = 100) {
+  pair<Palette, Indices> kmeansPalette(const Block& block, uint32_t seed, int max_iters = 100) {
     Palette palette;
-    initialize_palette(block, palette);
+    initialize_palette(block, palette, seed);
     Indices assignments;
 
     for (int iter = 0; iter < max_iters; ++iter) {
@@ -107,64 +124,37 @@ bool Build::BCI::convertPNG(const std::string &pathInPNG, const std::string &pat
   vector<unsigned char> image;
   unsigned width, height;
 
-  auto *pFile = fopen(pathOutBCI.c_str(), "wb");
-
-  auto writeU16 = [pFile](uint16_t val) {
-    uint8_t high = (val >> 8) & 0xFF;
-    uint8_t low = val & 0xFF;
-    fwrite(&high, 1, 1, pFile);
-    fwrite(&low, 1, 1, pFile);
-  };
-  auto writeU8 = [pFile](uint8_t val) {
-    fwrite(&val, 1, 1, pFile);
-  };
-  auto writeU32 = [pFile](uint32_t val) {
-    uint8_t b0 = (val >> 24) & 0xFF;
-    uint8_t b1 = (val >> 16) & 0xFF;
-    uint8_t b2 = (val >> 8) & 0xFF;
-    uint8_t b3 = val & 0xFF;
-    fwrite(&b0, 1, 1, pFile);
-    fwrite(&b1, 1, 1, pFile);
-    fwrite(&b2, 1, 1, pFile);
-    fwrite(&b3, 1, 1, pFile);
-  };
-  auto writeU64 = [pFile](uint64_t val) {
-    uint8_t b0 = (val >> 56) & 0xFF;
-    uint8_t b1 = (val >> 48) & 0xFF;
-    uint8_t b2 = (val >> 40) & 0xFF;
-    uint8_t b3 = (val >> 32) & 0xFF;
-    uint8_t b4 = (val >> 24) & 0xFF;
-    uint8_t b5 = (val >> 16) & 0xFF;
-    uint8_t b6 = (val >> 8) & 0xFF;
-    uint8_t b7 = val & 0xFF;
-    fwrite(&b0, 1, 1, pFile);
-    fwrite(&b1, 1, 1, pFile);
-    fwrite(&b2, 1, 1, pFile);
-    fwrite(&b3, 1, 1, pFile);
-    fwrite(&b4, 1, 1, pFile);
-    fwrite(&b5, 1, 1, pFile);
-    fwrite(&b6, 1, 1, pFile);
-    fwrite(&b7, 1, 1, pFile);
-  };
-
   unsigned error = lodepng::decode(image, width, height, pathInPNG);
   if (error) {
     cerr << "PNG loading error: " << lodepng_error_text(error) << endl;
     return false;
   }
 
+  // 16 bytes per block, written at once
+  vector<uint8_t> data{};
+  data.reserve(((width + 3) / 4) * ((height + 3) / 4) * 16);
+  auto writeU16 = [&data](uint16_t val) {
+    data.push_back((val >> 8) & 0xFF);
+    data.push_back(val & 0xFF);
+  };
+  auto writeU64 = [&data](uint64_t val) {
+    for(int i=7; i>=0; --i)data.push_back((val >> (i*8)) & 0xFF);
+  };
+
   for (unsigned y = 0; y < height; y += 4) {
     for (unsigned x = 0; x < width; x += 4) {
-      Block block;
+      Block block{};
       for (int i = 0; i < 16; ++i) {
         unsigned px = x + (i % 4);
         unsigned py = y + (i / 4);
         if (px >= width || py >= height) continue;
         unsigned index = 4 * (py * width + px);
-        block[i] = {image[index], image[index + 1], image[index + 2]};
+        block.r[i] = image[index];
+        block.g[i] = image[index + 1];
+        block.b[i] = image[index + 2];
       }
 
-      auto [palette, indices] = kmeansPalette(block);
+      auto [palette, indices] = kmeansPalette(block, y * width + x);
 
       // Note: the first index must be 0b00 or 0b01 due to runtime opt.
       // If that is not the case, swap the colors and indices
@@ -195,6 +185,9 @@ bool Build::BCI::convertPNG(const std::string &pathInPNG, const std::string &pat
     }
   }
 
+  auto *pFile = fopen(pathOutBCI.c_str(), "wb");
+  if(!pFile)return false;
+  bool res = fwrite(data.data(), 1, data.size(), pFile) == data.size();
   fclose(pFile);
-  return true;
+  return res;
 }
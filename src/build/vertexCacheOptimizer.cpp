@@ -0,0 +1,213 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "projectBuilder.h"
+#include <map>
+
+namespace
+{
+  // vertices the RSP can hold at once, see 'T3D_VERTEX_CACHE_SIZE' in tiny3d
+  constexpr uint32_t VERTEX_CACHE_SIZE = 70;
+
+  using Model = decltype(T3DM::T3DMData::models)::value_type;
+  using Triangle = decltype(Model::triangles)::value_type;
+
+  /**
+   * Maps each corner of a triangle to an index of unique vertices.
+   * Only what ends up in the vertex buffer counts, equal vertices are loaded once per chunk.
+   */
+  std::vector<std::array<uint32_t, 3>> indexVertices(const std::vector<Triangle> &triangles, uint32_t &vertCount)
+  {
+    std::map<std::pair<uint64_t, uint64_t>, uint32_t> vertMap{};
+    std::vector<std::array<uint32_t, 3>> res(triangles.size());
+
+    for(size_t t=0; t<triangles.size(); ++t)
+    {
+      for(int v=0; v<3; ++v)
+      {
+        auto &vert = triangles[t].vert[v];
+        uint64_t keyA = (uint64_t)(uint16_t)vert.pos[0]
+          | ((uint64_t)(uint16_t)vert.pos[1] << 16)
+          | ((uint64_t)(uint16_t)vert.pos[2] << 32)
+          | ((uint64_t)vert.norm << 48);
+        uint64_t keyB = (uint64_t)vert.rgba
+          | ((uint64_t)(uint16_t)vert.s << 32)
+          | ((uint64_t)(uint16_t)vert.t << 48);
+
+        auto it = vertMap.try_emplace({keyA, keyB}, (uint32_t)vertMap.size()).first;
+        res[t][v] = it->second;
+      }
+    }
+    vertCount = vertMap.size();
+    return res;
+  }
+
+  // vertex loads when filling chunks in the given order, starting a new one once a triangle doesn't fit anymore
+  uint32_t countLoads(const std::vector<std::array<uint32_t, 3>> &tris, uint32_t vertCount)
+  {
+    std::vector<uint32_t> chunkOfVert(vertCount, 0);
+    uint32_t chunk = 1;
+    uint32_t chunkSize = 0;
+    uint32_t loads = 0;
+
+    for(auto &tri : tris)
+    {
+      uint32_t newVerts = 0;
+      for(int v=0; v<3; ++v) {
+        bool isDuplicate = (v > 0 && tri[v] == tri[0]) || (v > 1 && tri[v] == tri[1]);
+        if(chunkOfVert[tri[v]] != chunk && !isDuplicate)++newVerts;
+      }
+
+      if(chunkSize + newVerts > VERTEX_CACHE_SIZE) {
+        ++chunk;
+        chunkSize = 0;
+        newVerts = 0;
+        for(int v=0; v<3; ++v) {
+          if(chunkOfVert[tri[v]] != chunk) {
+            chunkOfVert[tri[v]] = chunk;
+            ++newVerts;
+          }
+        }
+      } else {
+        for(int v=0; v<3; ++v)chunkOfVert[tri[v]] = chunk;
+      }
+      chunkSize += newVerts;
+      loads += newVerts;
+    }
+    return loads;
+  }
+
+  /**
+   * Grows each chunk from a seed triangle, always adding the triangle that needs the fewest new vertices.
+   * Candidates are bucketed by how many of their vertices are already in the chunk,
+   * stale bucket entries are skipped when popped instead of being removed.
+   * @return new order of the triangles
+   */
+  std::vector<uint32_t> buildChunkOrder(const std::vector<std::array<uint32_t, 3>> &tris, uint32_t vertCount)
+  {
+    std::vector<std::vector<uint32_t>> trisOfVert(vertCount);
+    for(uint32_t t=0; t<tris.size(); ++t) {
+      for(auto v : tris[t])trisOfVert[v].push_back(t);
+    }
+
+    std::vector<uint32_t> order{};
+    order.reserve(tris.size());
+    std::vector<bool> triUsed(tris.size(), false);
+    std::vector<uint8_t> triHits(tris.size(), 0); // vertices already in the current chunk
+    std::vector<uint32_t> chunkOfVert(vertCount, 0);
+    std::array<std::vector<uint32_t>, 4> buckets{};
+    std::vector<uint32_t> hitTris{};
+
+    uint32_t nextSeed = 0;
+    uint32_t chunk = 0;
+
+    while(order.size() < tris.size())
+    {
+      ++chunk;
+      uint32_t chunkSize = 0;
+      for(auto &t : hitTris)triHits[t] = 0;
+      hitTris.clear();
+      for(auto &b : buckets)b.clear();
+
+      auto getNewVerts = [&](uint32_t t) {
+        uint32_t res = 0;
+        for(int v=0; v<3; ++v) {
+          bool isDuplicate = (v > 0 && tris[t][v] == tris[t][0]) || (v > 1 && tris[t][v] == tris[t][1]);
+          if(chunkOfVert[tris[t][v]] != chunk && !isDuplicate)++res;
+        }
+        return res;
+      };
+
+      auto addTri = [&](uint32_t t)
+      {
+        triUsed[t] = true;
+        order.push_back(t);
+        for(auto v : tris[t])
+        {
+          if(chunkOfVert[v] == chunk)continue;
+          chunkOfVert[v] = chunk;
+          ++chunkSize;
+          for(auto adj : trisOfVert[v]) {
+            if(triUsed[adj])continue;
+            if(triHits[adj] == 0)hitTris.push_back(adj);
+            buckets[++triHits[adj]].push_back(adj);
+          }
+        }
+      };
+
+      for(;;)
+      {
+        // fully contained triangles first, they are free
+        int bestTri = -1;
+        for(int hits=3; hits>0 && bestTri < 0; --hits)
+        {
+          auto &bucket = buckets[hits];
+          while(!bucket.empty()) {
+            auto t = bucket.back();
+            bucket.pop_back();
+            if(triUsed[t] || triHits[t] != hits)continue;
+            if(chunkSize + getNewVerts(t) > VERTEX_CACHE_SIZE)continue;
+            bestTri = (int)t;
+            break;
+          }
+        }
+
+        // nothing connected left that fits, continue with the next unused triangle in the original order
+        if(bestTri < 0) {
+          while(nextSeed < tris.size() && triUsed[nextSeed])++nextSeed;
+          if(nextSeed >= tris.size())break;
+          if(chunkSize != 0 && chunkSize + getNewVerts(nextSeed) > VERTEX_CACHE_SIZE)break;
+          bestTri = (int)nextSeed;
+        }
+        addTri((uint32_t)bestTri);
+      }
+    }
+    return order;
+  }
+}
+
+uint32_t Build::countVertexLoads(const T3DM::T3DMData &t3dm)
+{
+  uint32_t loads = 0;
+  for(auto &model : t3dm.models)loads += countVertexLoads(model);
+  return loads;
+}
+
+uint32_t Build::countVertexLoads(const T3DM::Model &model)
+{
+  uint32_t vertCount = 0;
+  auto tris = indexVertices(model.triangles, vertCount);
+  return countLoads(tris, vertCount);
+}
+
+Build::VertexCacheStats Build::optimizeVertexCache(T3DM::T3DMData &t3dm)
+{
+  VertexCacheStats stats{};
+  for(auto &model : t3dm.models)
+  {
+    uint32_t vertCount = 0;
+    auto tris = indexVertices(model.triangles, vertCount);
+    auto loadsBefore = countLoads(tris, vertCount);
+    stats.loadsBefore += loadsBefore;
+
+    auto order = buildChunkOrder(tris, vertCount);
+    std::vector<std::array<uint32_t, 3>> trisNew{};
+    trisNew.reserve(order.size());
+    for(auto t : order)trisNew.push_back(tris[t]);
+
+    // the greedy order can lose against an already well sorted mesh, keep whatever is better
+    auto loadsAfter = countLoads(trisNew, vertCount);
+    if(loadsAfter >= loadsBefore) {
+      stats.loadsAfter += loadsBefore;
+      continue;
+    }
+    stats.loadsAfter += loadsAfter;
+
+    std::vector<Triangle> sorted{};
+    sorted.reserve(order.size());
+    for(auto t : order)sorted.push_back(model.triangles[t]);
+    model.triangles = std::move(sorted);
+  }
+  return stats;
+}
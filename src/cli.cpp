@@ -4,9 +4,12 @@
 */
 #include "cli.h"
 #include "argparse/argparse.hpp"
+#include "build/buildServer.h"
 #include "build/projectBuilder.h"
 #include "utils/logger.h"
 
+#include <algorithm>
+
 namespace
 {
   std::string argProgPath{};
@@ -27,7 +30,28 @@ CLI::Result CLI::run(int argc, char** argv)
 
   prog.add_argument("--cmd")
     .help("Command to run")
-    .add_choice("build");
+    .add_choice("build")
+    .add_choice("analyze-compression")
+    .add_choice("bench")
+    .add_choice("serve");
+
+  prog.add_argument("--apply")
+    .help("Store the recommended compression levels (analyze-compression only)")
+    .default_value(false)
+    .implicit_value(true);
+
+  prog.add_argument("--frames")
+    .help("Frames to record per scene (bench only)")
+    .default_value(300)
+    .scan<'i', int>();
+
+  prog.add_argument("--emu")
+    .help("Emulator command, overrides the one set in the project (bench only)")
+    .default_value(std::string{});
+
+  prog.add_argument("--report")
+    .help("Output path of the JSON report (bench only)")
+    .default_value(std::string{"benchmark.json"});
 
   prog.add_argument("project")
     .default_value("")
@@ -61,6 +85,19 @@ CLI::Result CLI::run(int argc, char** argv)
   if (cmd == "build") {
     printf("Building project: %s\n", argProgPath.c_str());
     res = Build::buildProject(argProgPath);
+  } else if (cmd == "analyze-compression") {
+    printf("Analyzing project: %s\n", argProgPath.c_str());
+    res = Build::analyzeProjectCompression(argProgPath, prog["--apply"] == true);
+  } else if (cmd == "bench") {
+    printf("Benchmarking project: %s\n", argProgPath.c_str());
+    res = Build::runBenchmark(argProgPath, {
+      .frames = (uint32_t)std::max(prog.get<int>("--frames"), 1),
+      .emuCmd = prog.get<std::string>("--emu"),
+      .reportPath = prog.get<std::string>("--report"),
+    });
+  } else if (cmd == "serve") {
+    // stays running, builds are requested through stdin (see 'Build::Server::serve')
+    res = Build::getServer().serve();
   }
 
   return res ? Result::SUCCESS : Result::ERROR;
@@ -3,7 +3,9 @@
 * @license MIT
 */
 #pragma once
+#include <algorithm>
 #include <future>
+#include <vector>
 
 #include "project/project.h"
 #include "utils/toolchain.h"
@@ -33,10 +35,41 @@ struct Context
 
   // Editor state
   uint64_t selAssetUUID{0};
-  uint32_t selObjectUUID{0};
+  uint32_t selObjectUUID{0}; // primary selection, shown in the inspector and holding the gizmo
+  std::vector<uint32_t> selObjectUUIDs{}; // all selected objects, including the primary one
+
+  void selectObject(uint32_t uuid) {
+    selObjectUUID = uuid;
+    selObjectUUIDs.clear();
+    if(uuid)selObjectUUIDs.push_back(uuid);
+  }
+
+  // adds or removes an object (ctrl-click), an added one becomes the primary selection
+  void toggleObjectSelection(uint32_t uuid) {
+    if(std::erase(selObjectUUIDs, uuid)) {
+      if(selObjectUUID == uuid)selObjectUUID = selObjectUUIDs.empty() ? 0 : selObjectUUIDs.back();
+      return;
+    }
+    selObjectUUIDs.push_back(uuid);
+    selObjectUUID = uuid;
+  }
+
+  [[nodiscard]] bool isObjectSelected(uint32_t uuid) const {
+    return std::find(selObjectUUIDs.begin(), selObjectUUIDs.end(), uuid) != selObjectUUIDs.end();
+  }
 
   std::future<void> futureBuildRun{};
 
+  // the editor only redraws while this is set or shortly after input, see 'requestRedraw'
+  uint32_t redrawFrames{0};
+
+  /**
+   * Keeps the editor drawing for a few more frames, call every frame while something animates.
+   */
+  void requestRedraw(uint32_t frames = 2) {
+    if(frames > redrawFrames)redrawFrames = frames;
+  }
+
   [[nodiscard]] bool isBuildOrRunning() const
   {
     if (futureBuildRun.valid()) {
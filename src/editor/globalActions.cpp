@@ -7,6 +7,7 @@
 #include "../editor/imgui/notification.h"
 #include "../utils/logger.h"
 #include "../context.h"
+#include "../build/buildServer.h"
 #include "../build/projectBuilder.h"
 #include "../utils/fs.h"
 #include "../utils/json.h"
@@ -89,6 +90,8 @@ namespace Editor::Actions
       // clear some temp files
       fs::remove(newPath / "p64_project.z64");
       fs::remove(newPath / "Makefile");
+      fs::remove(newPath / "Makefile.code");
+      fs::remove(newPath / "Makefile.assets");
       fs::remove_all(newPath / "build");
       fs::remove_all(newPath / "filesystem");
 
@@ -109,17 +112,26 @@ namespace Editor::Actions
       ImGui::SetWindowFocus("Log");
 
       auto z64Path = ctx.project->getPath() + "/" + ctx.project->conf.romName + ".z64";
-      fs::remove(z64Path);
+      // the last ROM is patched by a fast repack, a failed build doesn't run it either way
+      if (!ctx.project->conf.fastRepack)fs::remove(z64Path);
 
       std::string runCmd{};
       if (arg == "run") {
         runCmd = ctx.project->conf.pathEmu + " " + z64Path;
+      } else if (arg == "upload" && !ctx.project->conf.pathLoader.empty()) {
+        runCmd = ctx.project->conf.pathLoader + " " + z64Path;
       }
 
-      ctx.futureBuildRun = std::async(std::launch::async, [] (std::string configPath, std::string runCmd)
+      // the packet excludes everything the device already got, so each ROM upload starts over
+      fs::path projectPath = ctx.project->getPath();
+      bool isUpload = !runCmd.empty() && arg == "upload";
+      std::string hotReloadCmd = arg == "hotreload" ? ctx.project->conf.pathHotReload : "";
+      std::string configPath = ctx.project->getConfigPath();
+
+      ctx.futureBuildRun = std::async(std::launch::async, [=] ()
       {
         auto oldPATH = std::getenv("PATH");
-        bool result = Build::buildProject(configPath);
+        bool result = Build::getServer().build(configPath);
 
         #if defined(_WIN32)
           _putenv_s("PATH", oldPATH);
@@ -132,10 +144,24 @@ namespace Editor::Actions
           return;
         }
 
+        if (!hotReloadCmd.empty()) {
+          auto packetPath = projectPath / "build" / "hotReload.bin";
+          if (Build::writeHotReloadPacket(projectPath, packetPath) == 0) {
+            Editor::Noti::add(Editor::Noti::Type::INFO, "Nothing to hot-reload, see log");
+            return;
+          }
+          if (Utils::Proc::runSyncLogged(hotReloadCmd + " " + packetPath.string())) {
+            Build::setHotReloadBase(projectPath);
+          }
+          return;
+        }
+
         if (!runCmd.empty()) {
-          Utils::Proc::runSyncLogged(runCmd);
+          if (Utils::Proc::runSyncLogged(runCmd) && isUpload) {
+            Build::setHotReloadBase(projectPath);
+          }
         }
-      }, ctx.project->getConfigPath(), runCmd);
+      });
 
       return true;
     });
@@ -155,7 +181,7 @@ namespace Editor::Actions
       auto obj = scene->getObjectByUUID(ctx.selObjectUUID);
       if(!obj)return false;
 
-      ctx.clipboard.data = obj->serialize().dump();
+      ctx.clipboard.data = Utils::JSON::toBinary(obj->serialize());
       ctx.clipboard.refUUID = obj->parent ? obj->parent->uuid : 0;
 
       return true;
@@ -166,9 +192,12 @@ namespace Editor::Actions
       auto scene = ctx.project->getScenes().getLoadedScene();
       if(!scene)return false;
 
+      auto doc = Utils::JSON::fromBinary(ctx.clipboard.data);
+      if(!doc.is_object())return false;
+
       UndoRedo::getHistory().markChanged("Paste Object");
-      auto obj = scene->addObject(ctx.clipboard.data, ctx.clipboard.refUUID);
-      ctx.selObjectUUID = obj->uuid;
+      auto obj = scene->addObject(doc, ctx.clipboard.refUUID);
+      ctx.selectObject(obj->uuid);
       return true;
     });
   }
@@ -222,8 +222,8 @@ namespace ImTable
     return changed;
   }
 
-  template<typename T, typename OnChange>
-  inline int addVecComboBox(const std::string &name, const std::vector<T> &items, auto &id, OnChange onChange)
+  template<typename TItems, typename OnChange>
+  inline int addVecComboBox(const std::string &name, const TItems &items, auto &id, OnChange onChange)
   {
     add(name);
     bool disabled  (isPrefabLocked());
@@ -254,18 +254,18 @@ namespace ImTable
     return idx;
   }
 
-  template<typename T>
-  inline int addVecComboBox(const std::string &name, const std::vector<T> &items, auto &id)
+  template<typename TItems>
+  inline int addVecComboBox(const std::string &name, const TItems &items, auto &id)
   {
     return addVecComboBox(name, items, id, [](auto) {});
   }
 
   // addVecComboBox with drag-drop support and custom validator
   // Validator signature: bool(uint64_t uuid, const char* payloadType)
-  template<typename T, typename TValidator, typename OnChange>
+  template<typename TItems, typename TValidator, typename OnChange>
   inline int addVecComboBoxWithDragDrop(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id,
     TValidator validator,
     OnChange onChange
@@ -287,10 +287,10 @@ namespace ImTable
 
   // Asset-only drag-drop combo box
   // Validator signature: bool(uint64_t assetUUID)
-  template<typename T, typename TAssetValidator, typename OnChange>
+  template<typename TItems, typename TAssetValidator, typename OnChange>
   inline int addAssetVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id,
     TAssetValidator assetValidator,
     OnChange onChange
@@ -306,10 +306,10 @@ namespace ImTable
   }
 
   // overload: accept dropped assets that are present in the combo list.
-  template<typename T, typename OnChange>
+  template<typename TItems, typename OnChange>
   inline int addAssetVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id,
     OnChange onChange
   )
@@ -326,10 +326,10 @@ namespace ImTable
   }
 
   // overload without OnChange callback.
-  template<typename T>
+  template<typename TItems>
   inline int addAssetVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id
   )
   {
@@ -338,10 +338,10 @@ namespace ImTable
 
   // Object-only drag-drop combo box
   // Validator signature: bool(uint32_t objectUUID)
-  template<typename T, typename TObjectValidator, typename OnChange>
+  template<typename TItems, typename TObjectValidator, typename OnChange>
   inline int addObjectVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id,
     TObjectValidator objectValidator,
     OnChange onChange
@@ -357,10 +357,10 @@ namespace ImTable
   }
 
   // overload: accept dropped objects that are present in the combo list.
-  template<typename T, typename OnChange>
+  template<typename TItems, typename OnChange>
   inline int addObjectVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id,
     OnChange onChange
   )
@@ -377,10 +377,10 @@ namespace ImTable
   }
 
   // overload without OnChange callback.
-  template<typename T>
+  template<typename TItems>
   inline int addObjectVecComboBox(
     const std::string& name,
-    const std::vector<T>& items,
+    const TItems& items,
     auto& id
   )
   {
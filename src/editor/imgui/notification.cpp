@@ -4,6 +4,7 @@
 */
 #include "notification.h"
 #include "imgui.h"
+#include "../../context.h"
 #include <vector>
 #include <IconsMaterialDesignIcons.h>
 #include <mutex>
@@ -39,6 +40,7 @@ namespace Editor::Noti
     notiMutex.unlock();
     
     if(notiLocal.empty())return;
+    ctx.requestRedraw();
 
     // bottom right window pos
     auto pos = ImGui::GetIO().DisplaySize;
@@ -106,6 +106,9 @@ void Editor::Scene::draw()
     // Bottom
     ImGui::DockBuilderDockWindow("Files", dockBottomID);
     ImGui::DockBuilderDockWindow("Log", dockBottomID);
+    ImGui::DockBuilderDockWindow("Profiler", dockBottomID);
+    ImGui::DockBuilderDockWindow("Load Report", dockBottomID);
+    ImGui::DockBuilderDockWindow("ROM Report", dockBottomID);
 
     ImGui::DockBuilderFinish(dockSpaceID);
   }
@@ -163,6 +166,18 @@ void Editor::Scene::draw()
     logWindow.draw();
   ImGui::End();
 
+  ImGui::Begin("Profiler");
+    profilerWindow.draw();
+  ImGui::End();
+
+  ImGui::Begin("Load Report");
+    loadReportWindow.draw();
+  ImGui::End();
+
+  ImGui::Begin("ROM Report");
+    romReportWindow.draw();
+  ImGui::End();
+
   if (projectSettingsOpen) {
     constexpr ImVec2 windowSize{500,300};
     auto screenSize = ImGui::GetMainViewport()->WorkSize;
@@ -228,6 +243,14 @@ void Editor::Scene::draw()
       {
         if(ImGui::MenuItem(ICON_MDI_HAMMER " Build"))Actions::call(Actions::Type::PROJECT_BUILD);
         if(ImGui::MenuItem(ICON_MDI_PLAY " Build & Run"))Actions::call(Actions::Type::PROJECT_BUILD, "run");
+        bool hasLoader = ctx.project && !ctx.project->conf.pathLoader.empty();
+        if(ImGui::MenuItem(ICON_MDI_UPLOAD " Build & Upload", nullptr, false, hasLoader)) {
+          Actions::call(Actions::Type::PROJECT_BUILD, "upload");
+        }
+        bool hasHotReload = ctx.project && !ctx.project->conf.pathHotReload.empty();
+        if(ImGui::MenuItem(ICON_MDI_FIRE " Build & Hot-Reload", nullptr, false, hasHotReload)) {
+          Actions::call(Actions::Type::PROJECT_BUILD, "hotreload");
+        }
         if(ImGui::MenuItem("Clean"))Actions::call(Actions::Type::PROJECT_CLEAN);
         ImGui::EndMenu();
       }
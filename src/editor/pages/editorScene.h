@@ -6,9 +6,12 @@
 #include "parts/assetInspector.h"
 #include "parts/assetsBrowser.h"
 #include "parts/layerInspector.h"
+#include "parts/loadReportWindow.h"
 #include "parts/logWindow.h"
 #include "parts/nodeEditor.h"
 #include "parts/objectInspector.h"
+#include "parts/profilerWindow.h"
+#include "parts/romReportWindow.h"
 #include "parts/projectSettings.h"
 #include "parts/sceneGraph.h"
 #include "parts/sceneInspector.h"
@@ -30,6 +33,9 @@ namespace Editor
       LayerInspector layerInspector{};
       ObjectInspector objectInspector{};
       LogWindow logWindow{};
+      ProfilerWindow profilerWindow{};
+      LoadReportWindow loadReportWindow{};
+      RomReportWindow romReportWindow{};
       SceneGraph sceneGraph{};
 
       bool dockSpaceInit{false};
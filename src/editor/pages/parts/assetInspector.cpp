@@ -8,9 +8,59 @@
 #include "../../imgui/helper.h"
 #include "../../../context.h"
 #include "../../../utils/textureFormats.h"
+#include "../../../build/projectBuilder.h"
+
+#include <optional>
 
 using FileType = Project::FileType;
 
+namespace
+{
+  // results of the last compression analysis per asset, not saved
+  std::unordered_map<uint64_t, Build::CompressionStats> comprStats{};
+  std::unordered_map<uint64_t, Build::TextureFormatStats> texFormatStats{};
+
+  // vertex loads before/after optimizing, by asset and the parse they were computed from
+  std::unordered_map<uint64_t, std::pair<std::string, Build::VertexCacheStats>> vertexCacheStats{};
+
+  const Build::VertexCacheStats& getVertexCacheStats(const Project::AssetManagerEntry &asset)
+  {
+    auto &entry = vertexCacheStats[asset.getUUID()];
+    if(entry.first != asset.t3dmParseKey) {
+      auto t3dm = asset.t3dmData;
+      entry = {asset.t3dmParseKey, Build::optimizeVertexCache(t3dm)};
+    }
+    return entry.second;
+  }
+
+  // same for the animation analysis, also depends on the error bound
+  std::unordered_map<uint64_t, std::pair<std::string, Build::AnimStats>> animStats{};
+
+  const Build::AnimStats& getAnimStats(const Project::AssetManagerEntry &asset)
+  {
+    auto &entry = animStats[asset.getUUID()];
+    auto key = asset.t3dmParseKey + ":" + std::to_string(asset.conf.gltfAnimMaxErr.value);
+    if(entry.first != key) {
+      entry = {key, Build::analyzeAnimations(asset.path, (float)asset.conf.baseScale, asset.conf.getAnimMaxError())};
+    }
+    return entry.second;
+  }
+
+  // decode cost of sounds, by the settings that change it (the source is only read again if those change)
+  std::unordered_map<uint64_t, std::pair<std::string, std::optional<Build::AudioCostStats>>> audioStats{};
+
+  const std::optional<Build::AudioCostStats>& getAudioStats(const Project::AssetManagerEntry &asset)
+  {
+    auto &entry = audioStats[asset.getUUID()];
+    auto key = std::to_string(asset.conf.wavResampleRate.value) + ":" + std::to_string(asset.conf.wavForceMono.value);
+    if(entry.first != key) {
+      Build::AudioCostStats stats{};
+      entry = {key, Build::analyzeAudioCost(asset, stats) ? std::optional{stats} : std::nullopt};
+    }
+    return entry.second;
+  }
+}
+
 int Selecteditem  = 0;
 
 Editor::AssetInspector::AssetInspector() {
@@ -30,8 +80,7 @@ void Editor::AssetInspector::draw() {
 
   bool hasAssetConf = true;
   if (asset->type == FileType::CODE_OBJ
-    || asset->type == FileType::CODE_GLOBAL
-    || asset->type == FileType::PREFAB)
+    || asset->type == FileType::CODE_GLOBAL)
   {
     hasAssetConf = false;
   }
@@ -44,19 +93,117 @@ void Editor::AssetInspector::draw() {
     if (asset->type == FileType::IMAGE)
     {
       ImTable::addComboBox("Format", asset->conf.format, Utils::TEX_TYPES, Utils::TEX_TYPE_COUNT);
+      if(asset->conf.format == (int)Utils::TexFormat::AUTO)
+      {
+        // same analysis the build does, to see what 'Auto' picks and how much the other formats lose
+        ImTable::add("Auto-Format");
+        if(ImGui::Button("Compare Formats")) {
+          Build::TextureFormatStats stats{};
+          if(Build::analyzeTextureFormat(asset->path, stats)) {
+            texFormatStats[asset->getUUID()] = stats;
+          }
+        }
+
+        auto stats = texFormatStats.find(asset->getUUID());
+        if(stats != texFormatStats.end()) {
+          for(auto &entry : stats->second.entries) {
+            ImTable::add(Utils::getTexFormatName(entry.format));
+            ImGui::Text("%.1fkb, %.1fdB%s", entry.size / 1024.0f, entry.psnr,
+              entry.format == stats->second.recommended ? " (picked)" : "");
+          }
+        }
+      }
+      // small 2D images of the same group share a sprite, see 'getAtlasRegion' in the generated 'assetTable.h'
+      ImTable::addProp("Atlas-Group", asset->conf.atlasGroup);
     }
     else if (asset->type == FileType::MODEL_3D)
     {
+      auto importTime = ctx.project->getAssets().getImportTime(*asset);
+      if (importTime >= 0) {
+        ImTable::add("Import");
+        ImGui::Text("Parsing... %.1fs", importTime);
+        ImGui::SameLine();
+        if (ImGui::SmallButton("Cancel")) {
+          ctx.project->getAssets().cancelImport(*asset);
+        }
+      }
       if (ImTable::add("Base-Scale", asset->conf.baseScale)) {
         ctx.project->getAssets().reloadAssetByUUID(asset->getUUID());
       }
       ImTable::addCheckBox("Create BVH", asset->conf.gltfBVH);
+      if(!asset->conf.gltfBVH) {
+        ImTable::addProp("BVH Auto", asset->conf.gltfBVHAuto);
+        if(asset->conf.gltfBVHAuto.value && Build::needsBVH(*asset)) {
+          ImGui::SameLine();
+          ImGui::TextDisabled("(enabled)");
+        }
+      }
+      // huge meshes are a single object otherwise, which culling can only skip as a whole
+      if (ImTable::addProp("Split Meshes", asset->conf.gltfSplitMeshes)) {
+        ctx.project->getAssets().reloadAssetByUUID(asset->getUUID());
+      }
+      ImTable::addProp("Vertex-Cache", asset->conf.gltfVertexCache);
+      if(!asset->t3dmData.models.empty()) {
+        auto &stats = getVertexCacheStats(*asset);
+        ImTable::add("Vertex Loads");
+        ImGui::Text("%u -> %u", stats.loadsBefore, stats.loadsAfter);
+      }
       ImTable::addProp("Collision", asset->conf.gltfCollision);
+      // applies to collision of the model itself and to collision-mesh components using it
+      ImTable::addProp("Coll. Simplify", asset->conf.gltfCollSimplify);
+      ImTable::addVecComboBox<ImTable::ComboEntry>("Coll. Leaf-Size", {
+          { 0, "Default (8)" },
+          { 2, "2" },
+          { 4, "4" },
+          { 8, "8" },
+          { 12, "12" },
+          { 15, "15" },
+        }, asset->conf.gltfCollLeafSize.value
+      );
+      // halves the vertex data, precision is the mesh extent divided by 32767
+      ImTable::addProp("Coll. Quantize", asset->conf.gltfCollQuantize);
+
+      // keyframes are streamed from ROM during playback, lower rates reduce size and bandwidth of long clips
+      ImTable::addProp("Anim-Rate Auto", asset->conf.gltfAnimAuto);
+      if(asset->conf.gltfAnimAuto.value) {
+        ImTable::addVecComboBox<ImTable::ComboEntry>("Anim Max-Error", {
+            { 0, "Default (0.5 deg)" },
+            { 2, "0.2 deg" },
+            { 10, "1.0 deg" },
+            { 20, "2.0 deg" },
+            { 50, "5.0 deg" },
+          }, asset->conf.gltfAnimMaxErr.value
+        );
+        if(!asset->t3dmData.animations.empty()) {
+          auto &stats = getAnimStats(*asset);
+          ImTable::add("Anim Keys");
+          ImGui::Text("%u Hz, %.1f -> %.1f KB", stats.sampleRate, stats.bytesDefault / 1024.0f, stats.bytesPicked / 1024.0f);
+          ImTable::add("Anim Error");
+          ImGui::Text("%.2f deg, %.2f units", stats.maxErrRot, stats.maxErrPos);
+        }
+      } else {
+        ImTable::addVecComboBox<ImTable::ComboEntry>("Anim-Rate", {
+            { 0, "Default (60 Hz)" },
+            { 30, "30 Hz" },
+            { 20, "20 Hz" },
+            { 15, "15 Hz" },
+            { 10, "10 Hz" },
+          }, asset->conf.gltfAnimRate.value
+        );
+      }
+
+      // for static geometry, lights of the scene are applied at build time instead of on the RSP
+      ImTable::addProp("Bake Light", asset->conf.gltfBakeLight);
+      if(asset->conf.gltfBakeLight.value) {
+        ImTable::addVecComboBox("Light-Scene", ctx.project->getScenes().getEntries(), asset->conf.gltfBakeScene.value);
+      }
     } else if (asset->type == FileType::FONT)
     {
       ImTable::add("Size", asset->conf.baseScale);
       ImTable::addProp("ID", asset->conf.fontId);
 
+      // scans scenes, prefabs, graphs and user code for text, the charset is still the upper limit
+      ImTable::addProp("Auto-Subset", asset->conf.fontCharsetAuto);
       ImTable::add("Charset");
       ImGui::InputTextMultiline("##", &asset->conf.fontCharset.value);
     }
@@ -78,9 +225,36 @@ void Editor::AssetInspector::draw() {
       ImTable::addComboBox("Compression", asset->conf.wavCompression.value, {
         "None", "VADPCM", "Opus",
       });
+
+      // decode cost of each codec per frame, short SFX are usually better off uncompressed and music with Opus
+      if(auto &audioStats = getAudioStats(*asset))
+      {
+        constexpr const char* CODEC_NAMES[] = {"None", "VADPCM", "Opus"};
+        auto recommended = audioStats->getRecommended();
+        ImTable::add("Length");
+        ImGui::Text("%.2fs, %uHz, %uch", audioStats->durationSec, audioStats->sampleRate, audioStats->channels);
+        for(uint32_t c=0; c<Build::AudioCostStats::CODEC_COUNT; ++c) {
+          ImTable::add(CODEC_NAMES[c]);
+          ImGui::Text("~%.1fkb, ~%.2fms/frame%s", audioStats->estimateSize(c) / 1024.0f,
+            audioStats->estimateDecodeUs(c) / 1000.0f, c == recommended ? " (recommended)" : "");
+        }
+        if(asset->conf.wavCompression.value != (int)recommended) {
+          ImTable::add("");
+          if(ImGui::Button("Apply recommended"))asset->conf.wavCompression.value = (int)recommended;
+        }
+      }
+      ImTable::addProp("Loop", asset->conf.wavLoop);
+      if(asset->conf.wavLoop.value) {
+        ImTable::addProp("Loop-Start", asset->conf.wavLoopOffset);
+      }
+    }
+    else if (asset->type == FileType::PREFAB)
+    {
+      // instances to reserve memory for, spawning beyond that falls back to the shared pool
+      ImTable::addProp("Pool-Size", asset->conf.prefabPoolSize);
     }
 
-    if (asset->type != FileType::AUDIO)
+    if (asset->type != FileType::AUDIO && asset->type != FileType::PREFAB)
     {
       ImTable::addComboBox("Compression", (int&)asset->conf.compression, {
         "Project Default", "None",
@@ -88,6 +262,30 @@ void Editor::AssetInspector::draw() {
         "Level 2 - Good",
         "Level 3 - High",
       });
+
+      ImTable::add("Analyze");
+      if(ImGui::Button("Try all Levels")) {
+        Build::CompressionStats stats{};
+        if(Build::analyzeCompression(*ctx.project, ctx.toolchain, *asset, stats)) {
+          comprStats[asset->getUUID()] = stats;
+        }
+      }
+
+      auto stats = comprStats.find(asset->getUUID());
+      if(stats != comprStats.end())
+      {
+        auto recommended = stats->second.getRecommended();
+        for(uint32_t l=0; l<Build::CompressionStats::LEVEL_COUNT; ++l) {
+          bool isRecommended = (int)recommended == (int)Project::ComprTypes::LEVEL_0 + (int)l;
+          ImTable::add("Level " + std::to_string(l));
+          ImGui::Text("%.1fkb, ~%.1fms%s", stats->second.sizes[l] / 1024.0f,
+            stats->second.estimateLoadTimeUs(l) / 1000.0f, isRecommended ? " (recommended)" : "");
+        }
+        ImTable::add("");
+        if(asset->conf.compression != recommended && ImGui::Button("Apply recommended")) {
+          asset->conf.compression = recommended;
+        }
+      }
     }
 
     ImTable::addCheckBox("Exclude", asset->conf.exclude);
@@ -96,6 +294,9 @@ void Editor::AssetInspector::draw() {
   }
 
   if (ImGui::CollapsingHeader("Preview", ImGuiTreeNodeFlags_DefaultOpen)) {
+    if (asset->type == FileType::IMAGE) {
+      ctx.project->getAssets().requestTexture(*asset);
+    }
     if (asset->type == FileType::IMAGE && asset->texture) {
       ImGui::Image(ImTextureRef(asset->texture->getGPUTex()), asset->texture->getSize(4.0f));
       ImGui::Text("%dx%dpx", asset->texture->getWidth(), asset->texture->getHeight());
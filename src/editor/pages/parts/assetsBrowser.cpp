@@ -51,6 +51,7 @@ namespace
 
 void Editor::AssetsBrowser::draw() {
   auto &scenes = ctx.project->getScenes().getEntries();
+  thumbnails.update();
 
   const std::array<TabDef, 4> TABS{
     TabDef{
@@ -353,8 +354,14 @@ void Editor::AssetsBrowser::draw() {
 
     auto icon = ImTextureRef(nullptr);
     const char* iconTxt = ICON_MDI_FILE_OUTLINE;
-    if (asset.texture) {
-      icon = ImTextureRef(asset.texture->getGPUTex());
+    if (asset.type == FileType::IMAGE) {
+      // thumbnails are only made for what is on screen, the icon shows until then
+      iconTxt = ICON_MDI_IMAGE_OUTLINE;
+      if (ImGui::IsRectVisible({imageSize, imageSize})) {
+        if (auto thumb = thumbnails.get(asset)) {
+          icon = ImTextureRef(thumb->getGPUTex());
+        }
+      }
     } else {
       if (asset.type == FileType::MODEL_3D) {
         iconTxt = ICON_MDI_CUBE_OUTLINE;
@@ -6,6 +6,7 @@
 #include <array>
 #include <string>
 
+#include "../../thumbnailCache.h"
 #include "../../../renderer/texture.h"
 
 namespace Editor
@@ -16,6 +17,7 @@ namespace Editor
       int activeTab{0};
       std::array<std::string, 4> tabDirs{};
       std::string searchFilter{};
+      ThumbnailCache thumbnails{};
 
     public:
       void draw();
@@ -74,6 +74,9 @@ namespace
           ImTable::addProp("Fog Max", layer.fogMax);
         }
 
+        // 0 uses the peak of the last benchmark run (or the default)
+        ImTable::addProp("Buffer Words", layer.bufferWords);
+
         ImTable::end();
         ImGui::Dummy({0, 2});
       }
@@ -0,0 +1,282 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "loadReportWindow.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#include "imgui.h"
+#include "json.hpp"
+#include "IconsMaterialDesignIcons.h"
+#include "../../../utils/fs.h"
+#include "../../../utils/logger.h"
+#include "../../../utils/filePicker.h"
+#include "../../../project/component/components.h"
+#include "../../imgui/notification.h"
+#include "../../imgui/theme.h"
+
+namespace
+{
+  // must match 'n64/engine/include/debug/loadReport.h'
+  constexpr const char* LOAD_MARKER_BEGIN = "[P64-LOAD-BEGIN]";
+  constexpr const char* LOAD_MARKER_END = "[P64-LOAD-END]";
+
+  constexpr ImVec4 COLOR_HOT_SPOT{1.0f, 0.45f, 0.35f, 1.0f};
+  // share of the total load time above which an entry gets highlighted
+  constexpr double HOT_SPOT_FACTOR = 0.2;
+
+  struct Entry
+  {
+    std::string name{};
+    std::string phase{};
+    uint32_t count{0};
+    double timeUs{0};
+    double romUs{0};
+    uint64_t romBytes{0};
+    uint64_t heap{0};
+
+    [[nodiscard]] double getDecodeUs() const { return std::max(timeUs - romUs, 0.0); }
+  };
+
+  enum class AssetSort : int { TIME, ROM_READ, DECODE, ROM_SIZE, ORDER };
+  constexpr const char* ASSET_SORT_NAMES = "Total time\0ROM read\0Decode\0ROM size\0Load order\0";
+
+  Entry scene{};
+  Entry objects{};
+  std::vector<Entry> phases{};
+  std::vector<Entry> comps{};
+  std::vector<Entry> slowObjects{};
+  std::vector<Entry> assets{};
+  bool loaded{false};
+  int assetSort{(int)AssetSort::TIME};
+
+  std::string getCompName(int id)
+  {
+    for(const auto &comp : Project::Component::TABLE) {
+      if(comp.id == id)return comp.name;
+    }
+    return "#" + std::to_string(id);
+  }
+
+  Entry parseEntry(const nlohmann::json &ev, std::string name)
+  {
+    return {
+      .name = std::move(name),
+      .phase = ev.value("phase", ""),
+      .count = ev.value("count", 0u),
+      .timeUs = ev.value("us", 0.0),
+      .romUs = ev.value("romUs", 0.0),
+      .romBytes = ev.value<uint64_t>("romBytes", 0),
+      .heap = ev.value<uint64_t>("heap", 0),
+    };
+  }
+
+  void textMs(double us)
+  {
+    if(scene.timeUs > 0 && us > scene.timeUs * HOT_SPOT_FACTOR) {
+      ImGui::TextColored(COLOR_HOT_SPOT, "%.2f", us / 1000.0);
+    } else {
+      ImGui::Text("%.2f", us / 1000.0);
+    }
+  }
+
+  void drawPhases()
+  {
+    if(!ImGui::BeginTable("##Phases", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn("Phase", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Time (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("ROM (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("ROM", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableHeadersRow();
+
+    double otherUs = scene.timeUs;
+    for(const auto &phase : phases)
+    {
+      otherUs -= phase.timeUs;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(phase.name.c_str());
+      ImGui::TableNextColumn(); textMs(phase.timeUs);
+      ImGui::TableNextColumn(); ImGui::Text("%.2f", phase.romUs / 1000.0);
+      ImGui::TableNextColumn(); ImGui::Text("%.1f KB", phase.romBytes / 1024.0);
+    }
+    ImGui::TableNextRow();
+    ImGui::TableNextColumn(); ImGui::TextDisabled("Other");
+    ImGui::TableNextColumn(); textMs(std::max(otherUs, 0.0));
+    ImGui::EndTable();
+  }
+
+  void drawComponents()
+  {
+    ImGui::Text("%u objects, %.2f ms in 'loadObject'", objects.count, objects.timeUs / 1000.0);
+
+    if(ImGui::BeginTable("##Comps", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+    {
+      ImGui::TableSetupColumn("Component", ImGuiTableColumnFlags_WidthStretch);
+      ImGui::TableSetupColumn("Count", ImGuiTableColumnFlags_WidthFixed, 48.0f);
+      ImGui::TableSetupColumn("Init (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+      ImGui::TableSetupColumn("ROM", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+      ImGui::TableHeadersRow();
+      for(const auto &comp : comps)
+      {
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn(); ImGui::TextUnformatted(comp.name.c_str());
+        ImGui::TableNextColumn(); ImGui::Text("%u", comp.count);
+        ImGui::TableNextColumn(); textMs(comp.timeUs);
+        ImGui::SetItemTooltip("%.3f ms per component", comp.timeUs / 1000.0 / std::max(comp.count, 1u));
+        ImGui::TableNextColumn(); ImGui::Text("%.1f KB", comp.romBytes / 1024.0);
+      }
+      ImGui::EndTable();
+    }
+
+    if(slowObjects.empty())return;
+    ImGui::TextDisabled("Slowest objects:");
+    for(const auto &obj : slowObjects) {
+      ImGui::Text("  %-8s %8.2f ms", obj.name.c_str(), obj.timeUs / 1000.0);
+    }
+  }
+
+  void drawAssets()
+  {
+    ImGui::SetNextItemWidth(120);
+    ImGui::Combo("Sort by", &assetSort, ASSET_SORT_NAMES);
+
+    std::vector<const Entry*> sorted{};
+    for(const auto &asset : assets)sorted.push_back(&asset);
+    auto sortBy = [&](auto getValue) {
+      std::stable_sort(sorted.begin(), sorted.end(), [&](const Entry* a, const Entry* b) {
+        return getValue(*a) > getValue(*b);
+      });
+    };
+    switch((AssetSort)assetSort)
+    {
+      case AssetSort::TIME    : sortBy([](const Entry &e) { return e.timeUs; }); break;
+      case AssetSort::ROM_READ: sortBy([](const Entry &e) { return e.romUs; }); break;
+      case AssetSort::DECODE  : sortBy([](const Entry &e) { return e.getDecodeUs(); }); break;
+      case AssetSort::ROM_SIZE: sortBy([](const Entry &e) { return (double)e.romBytes; }); break;
+      case AssetSort::ORDER   : break;
+    }
+
+    constexpr ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY;
+    if(!ImGui::BeginTable("##Assets", 7, flags))return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Asset", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Phase", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("ROM (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Decode (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("ROM", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Heap", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableHeadersRow();
+
+    for(const auto *asset : sorted)
+    {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(asset->name.c_str());
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(asset->phase.c_str());
+      ImGui::TableNextColumn(); textMs(asset->timeUs);
+      ImGui::TableNextColumn(); ImGui::Text("%.2f", asset->romUs / 1000.0);
+      ImGui::TableNextColumn(); ImGui::Text("%.2f", asset->getDecodeUs() / 1000.0);
+      ImGui::TableNextColumn(); ImGui::Text("%.1f KB", asset->romBytes / 1024.0);
+      ImGui::TableNextColumn(); ImGui::Text("%.1f KB", asset->heap / 1024.0);
+    }
+    ImGui::EndTable();
+  }
+}
+
+bool Editor::LoadReportWindow::load(const std::string &text)
+{
+  // every scene load writes a report, only the last one is used
+  size_t posStart = text.rfind(LOAD_MARKER_BEGIN);
+  if(posStart == std::string::npos)return false;
+  posStart += strlen(LOAD_MARKER_BEGIN);
+  size_t posEnd = text.find(LOAD_MARKER_END, posStart);
+  if(posEnd == std::string::npos)return false;
+
+  Entry newScene{};
+  Entry newObjects{};
+  std::vector<Entry> newPhases{}, newComps{}, newSlowObjects{}, newAssets{};
+
+  // one JSON object per line, anything before it (log prefixes) is skipped
+  size_t lineStart = posStart;
+  while(lineStart < posEnd)
+  {
+    size_t lineEnd = text.find('\n', lineStart);
+    if(lineEnd == std::string::npos || lineEnd > posEnd)lineEnd = posEnd;
+    std::string_view line{text.data() + lineStart, lineEnd - lineStart};
+    lineStart = lineEnd + 1;
+
+    size_t objStart = line.find("{\"type\"");
+    size_t objEnd = line.rfind('}');
+    if(objStart == std::string::npos || objEnd == std::string::npos || objEnd < objStart)continue;
+
+    auto ev = nlohmann::json::parse(line.substr(objStart, objEnd - objStart + 1), nullptr, false);
+    if(ev.is_discarded() || !ev.is_object())continue;
+
+    std::string type = ev.value("type", "");
+    if(type == "scene")newScene = parseEntry(ev, "Scene " + std::to_string(ev.value("id", 0)));
+    else if(type == "phase")newPhases.push_back(parseEntry(ev, ev.value("name", "")));
+    else if(type == "comp")newComps.push_back(parseEntry(ev, getCompName(ev.value("id", -1))));
+    else if(type == "objects")newObjects = parseEntry(ev, "");
+    else if(type == "object")newSlowObjects.push_back(parseEntry(ev, "#" + std::to_string(ev.value("id", 0))));
+    else if(type == "asset")newAssets.push_back(parseEntry(ev, ev.value("path", "")));
+  }
+  if(newScene.name.empty())return false;
+
+  std::stable_sort(newComps.begin(), newComps.end(), [](const Entry &a, const Entry &b) {
+    return a.timeUs > b.timeUs;
+  });
+
+  scene = std::move(newScene);
+  objects = std::move(newObjects);
+  phases = std::move(newPhases);
+  comps = std::move(newComps);
+  slowObjects = std::move(newSlowObjects);
+  assets = std::move(newAssets);
+  loaded = true;
+  return true;
+}
+
+void Editor::LoadReportWindow::draw()
+{
+  if(ImGui::Button(ICON_MDI_TEXT_BOX_SEARCH_OUTLINE " From Log")) {
+    if(!load(Utils::Logger::getLog())) {
+      Editor::Noti::add(Editor::Noti::ERROR, "No load report found in the log!\nBuild with P64_LOAD_REPORT=1, every scene load writes one.");
+    }
+  }
+  ImGui::SameLine();
+  if(ImGui::Button(ICON_MDI_FOLDER_OPEN_OUTLINE " Open File")) {
+    Utils::FilePicker::open([this](const std::string &path) {
+      if(path.empty())return;
+      if(!load(Utils::FS::loadTextFile(path))) {
+        Editor::Noti::add(Editor::Noti::ERROR, "No load report found in file!");
+      }
+    }, {.title="Open Log"});
+  }
+
+  if(!loaded) {
+    ImGui::TextDisabled("No report loaded");
+    return;
+  }
+
+  ImGui::SameLine();
+  ImGui::Text("| %s: %.2f ms, %.1f KB from ROM in %.2f ms", scene.name.c_str(),
+    scene.timeUs / 1000.0, scene.romBytes / 1024.0, scene.romUs / 1000.0);
+
+  ImGui::PushFont(ImGui::getFontMono());
+  if(ImGui::CollapsingHeader("Phases", ImGuiTreeNodeFlags_DefaultOpen)) {
+    drawPhases();
+  }
+  if(ImGui::CollapsingHeader("Components", ImGuiTreeNodeFlags_DefaultOpen)) {
+    drawComponents();
+  }
+  std::string assetLabel = "Assets (" + std::to_string(assets.size()) + ")";
+  if(ImGui::CollapsingHeader(assetLabel.c_str(), ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImGui::TextDisabled("Decode is the load time not spent on ROM reads (decompression and parsing)");
+    drawAssets();
+  }
+  ImGui::PopFont();
+}
@@ -0,0 +1,23 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <string>
+
+namespace Editor
+{
+  /**
+   * Shows the last scene load report of the runtime ('Debug::LoadReport' in the engine),
+   * read from the log of the last run: time per load phase, per component type and per asset,
+   * with the ROM bytes each asset read and the time spent reading vs. decompressing it.
+   */
+  class LoadReportWindow
+  {
+    private:
+      bool load(const std::string &text);
+
+    public:
+      void draw();
+  };
+}
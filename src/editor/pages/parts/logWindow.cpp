@@ -7,39 +7,108 @@
 #include "imgui.h"
 #include "../../../context.h"
 #include "../../../utils/logger.h"
+#include "../../imgui/helper.h"
 #include "../../imgui/theme.h"
-#include "imgui_internal.h"
+#include "IconsMaterialDesignIcons.h"
 
 namespace
 {
-  constinit uint32_t lastLen{0};
+  // same as the logger keeps
+  constexpr size_t MAX_ENTRIES = 1024 * 32;
+
+  uint32_t getLineColor(const Utils::Logger::Line &line)
+  {
+    // raw output of the toolchain is all logged as info, the compiler marks its messages itself
+    int level = line.level;
+    if(level == Utils::Logger::LEVEL_INFO) {
+      if(line.text.contains("error:"))level = Utils::Logger::LEVEL_ERROR;
+      else if(line.text.contains("warning:"))level = Utils::Logger::LEVEL_WARN;
+    }
+
+    switch(level) {
+      case Utils::Logger::LEVEL_WARN:  return ImGui::GetColorU32(ImVec4{1.0f, 0.8f, 0.3f, 1.0f});
+      case Utils::Logger::LEVEL_ERROR: return ImGui::GetColorU32(ImVec4{1.0f, 0.4f, 0.4f, 1.0f});
+      default: return 0;
+    }
+  }
+}
+
+void Editor::LogWindow::addEntry(uint64_t idx, Entry &&entry)
+{
+  // the logger may have dropped lines before they were read, just continue after the gap
+  if(entries.empty() || idx != firstLine + entries.size()) {
+    entries.clear();
+    visible.clear();
+    firstLine = idx;
+  }
+
+  if(filter.empty() || entry.text.contains(filter))visible.push_back(idx);
+  entries.push_back(std::move(entry));
+
+  if(entries.size() > MAX_ENTRIES) {
+    entries.pop_front();
+    ++firstLine;
+    while(!visible.empty() && visible.front() < firstLine)visible.pop_front();
+  }
+}
+
+void Editor::LogWindow::applyFilter()
+{
+  visible.clear();
+  for(size_t i = 0; i < entries.size(); ++i) {
+    if(filter.empty() || entries[i].text.contains(filter))visible.push_back(firstLine + i);
+  }
 }
 
 void Editor::LogWindow::draw()
 {
-  auto log = Utils::Logger::getLog();
+  auto lastLine = nextLine;
+  nextLine = Utils::Logger::readLines(nextLine, [this](uint64_t idx, const Utils::Logger::Line &line) {
+    addEntry(idx, {line.text, getLineColor(line)});
+  });
+  bool hasNewLines = nextLine != lastLine;
 
-  ImGui::PushFont(ImGui::getFontMono());
+  ImGui::SetNextItemWidth(ImGui::GetContentRegionAvail().x - 58);
+  if(ImGui::InputTextWithHint("##filter", "Filter...", &filter)) {
+    applyFilter();
+  }
+  ImGui::SameLine();
+  if(ImGui::Button(ICON_MDI_CONTENT_COPY)) {
+    std::string text{};
+    for(auto idx : visible)text += entries[idx - firstLine].text + "\n";
+    ImGui::SetClipboardText(text.c_str());
+  }
+  ImGui::SetItemTooltip("Copy shown lines");
+  ImGui::SameLine();
+  if(ImGui::Button(ICON_MDI_TRASH_CAN_OUTLINE)) {
+    Utils::Logger::clear();
+    entries.clear();
+    visible.clear();
+  }
+  ImGui::SetItemTooltip("Clear");
 
-  ImGui::PushID("LOG");
-  ImGui::PushStyleColor(ImGuiCol_FrameBg, {0.05f, 0.05f, 0.05f, 1.0f});
-  ImGui::InputTextMultiline("", log.data(), log.size()+1, {
-    ImGui::GetWindowSize().x-18,
-    ImGui::GetWindowSize().y-44
-  }, ImGuiInputTextFlags_ReadOnly);
+  ImGui::PushFont(ImGui::getFontMono());
+  ImGui::PushStyleColor(ImGuiCol_ChildBg, {0.05f, 0.05f, 0.05f, 1.0f});
+  ImGui::BeginChild("LOG", {0, 0}, ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
 
-  if (lastLen != log.length()) {
-    lastLen = log.length();
+  // only follow new lines while already at the bottom, so older ones can be read during a build
+  bool stickToBottom = ImGui::GetScrollY() >= ImGui::GetScrollMaxY();
 
-    // scroll to bottom
-    const char* inputWinName = nullptr;
-    ImFormatStringToTempBuffer(&inputWinName, nullptr, "%s/_%08X", GImGui->CurrentWindow->Name, ImGui::GetID(""));
-    ImGuiWindow* inputWin = ImGui::FindWindowByName(inputWinName);
-    ImGui::SetScrollY(inputWin, inputWin->ScrollMax.y);
+  ImGuiListClipper clipper{};
+  clipper.Begin((int)visible.size(), ImGui::GetTextLineHeightWithSpacing());
+  while(clipper.Step()) {
+    for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+      auto &entry = entries[visible[i] - firstLine];
+      if(entry.color)ImGui::PushStyleColor(ImGuiCol_Text, entry.color);
+      ImGui::TextUnformatted(entry.text.data(), entry.text.data() + entry.text.size());
+      if(entry.color)ImGui::PopStyleColor();
+    }
   }
+  clipper.End();
 
-  ImGui::PopStyleColor();
-  ImGui::PopID();
+  if(hasNewLines && stickToBottom)ImGui::SetScrollHereY(1.0f);
 
+  ImGui::EndChild();
+  ImGui::PopStyleColor();
   ImGui::PopFont();
 }
@@ -3,14 +3,34 @@
 * @license MIT
 */
 #pragma once
+#include <cstdint>
+#include <deque>
+#include <string>
 
 namespace Editor
 {
   class LogWindow
   {
     private:
+      struct Entry
+      {
+        std::string text{};
+        uint32_t color{0}; // 0 keeps the default text color
+      };
+
+      // copy of the last lines of the logger, front is line 'firstLine'
+      std::deque<Entry> entries{};
+      uint64_t firstLine{0};
+      uint64_t nextLine{0};
+
+      // line numbers passing the filter, updated with new lines instead of filtering everything again
+      std::deque<uint64_t> visible{};
+      std::string filter{};
+
+      void addEntry(uint64_t idx, Entry &&entry);
+      void applyFilter();
 
     public:
       void draw();
   };
-}
\ No newline at end of file
+}
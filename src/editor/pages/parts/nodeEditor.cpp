@@ -116,7 +116,9 @@ bool Editor::NodeEditor::draw(ImGuiID defDockId)
 
   bool isOpen = true;
   ImGui::Begin(name.c_str(), &isOpen, ImGuiWindowFlags_NoCollapse);
-  graph.graph.setSize(ImGui::GetContentRegionAvail());
+  auto canvasSize = ImGui::GetContentRegionAvail();
+  graph.graph.setSize(canvasSize);
+  graph.updateCulling(canvasSize);
   graph.graph.update();
   ImGui::End();
 
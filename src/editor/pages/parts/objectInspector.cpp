@@ -10,6 +10,63 @@
 #include "../../../project/component/components.h"
 #include "../../undoRedo.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+  // kept per object, everything else is copied to the rest of the selection
+  constexpr const char* OWN_PROPS[] = {"id", "name", "uuid", "uuidPrefab", "propOverrides", "components"};
+
+  /**
+   * Copies what changed on the primary object to the other selected ones.
+   * Components are matched by type and their order among the ones of that type.
+   */
+  void applyToSelection(Project::Scene &scene, uint32_t primaryUUID, const nlohmann::json &before, const nlohmann::json &after)
+  {
+    std::vector<std::string> changedProps{};
+    for (auto &[key, val] : after.items()) {
+      if (std::find(std::begin(OWN_PROPS), std::end(OWN_PROPS), key) != std::end(OWN_PROPS))continue;
+      if (!before.contains(key) || before[key] != val)changedProps.push_back(key);
+    }
+
+    struct CompChange { int id; uint32_t nth; const nlohmann::json *data; };
+    std::vector<CompChange> changedComps{};
+    auto &compsBefore = before["components"];
+    auto &compsAfter = after["components"];
+    std::unordered_map<int, uint32_t> typeCount{};
+    for (size_t i = 0; i < compsAfter.size(); ++i) {
+      auto &comp = compsAfter[i];
+      int id = comp["id"];
+      uint32_t nth = typeCount[id]++;
+      // added or removed ones only apply to the object itself
+      if (i >= compsBefore.size() || compsBefore[i]["uuid"] != comp["uuid"])continue;
+      if (compsBefore[i]["data"] != comp["data"])changedComps.push_back({id, nth, &comp["data"]});
+    }
+    if (changedProps.empty() && changedComps.empty())return;
+
+    for (auto uuid : ctx.selObjectUUIDs)
+    {
+      auto obj = scene.getObjectByUUID(uuid);
+      if (!obj || uuid == primaryUUID || obj->uuidPrefab.value)continue;
+
+      auto doc = obj->serialize(false);
+      for (auto &key : changedProps)doc[key] = after[key];
+
+      typeCount.clear();
+      for (auto &comp : doc["components"]) {
+        int id = comp["id"];
+        uint32_t nth = typeCount[id]++;
+        for (auto &change : changedComps) {
+          if (change.id == id && change.nth == nth)comp["data"] = *change.data;
+        }
+      }
+      obj->deserializeProps(doc);
+    }
+  }
+}
+
 Editor::ObjectInspector::ObjectInspector() {
 }
 
@@ -26,10 +83,22 @@ void Editor::ObjectInspector::draw() {
 
   auto obj = scene->getObjectByUUID(ctx.selObjectUUID);
   if (!obj) {
-    ctx.selObjectUUID = 0;
+    ctx.selectObject(0);
     return;
   }
 
+  // edits are made on the primary object and then copied to the others, diffed only once something changed
+  auto &history = UndoRedo::getHistory();
+  bool isBatch = ctx.selObjectUUIDs.size() > 1 && !obj->uuidPrefab.value;
+  if (isBatch && (batchUUID != obj->uuid || batchChangeCount != history.getChangeCount())) {
+    batchState = obj->serialize(false);
+    batchUUID = obj->uuid;
+    batchChangeCount = history.getChangeCount();
+  }
+  if (isBatch) {
+    ImGui::TextDisabled("%d objects selected, edits apply to all", (int)ctx.selObjectUUIDs.size());
+  }
+
   Project::Object* srcObj = obj.get();
   std::shared_ptr<Project::Prefab> prefab{};
   if(obj->uuidPrefab.value)
@@ -49,6 +118,18 @@ void Editor::ObjectInspector::draw() {
       ImTable::add("ID", idProxy);
       obj->id = static_cast<uint16_t>(idProxy);
 
+      // for things that don't need to react every frame (ambient props, distant AI, triggers),
+      // updates are spread across frames and get the time passed since their last update
+      constexpr const char* UPDATE_RATES[] = {"Every Tick", "1/2", "1/4", "1/8"};
+      ImTable::addComboBox("Update Rate", obj->updateTier, UPDATE_RATES, 4);
+
+      // children always follow their parent
+      if(obj->parent && !obj->parent->parent) {
+        ImTable::addCheckBox("Streamed", obj->streamed);
+        // same ID in the next scene: that one is skipped, otherwise this one gets a new ID
+        ImTable::addCheckBox("Persistent", obj->persistent);
+      }
+
       //ImTable::add("UUID");
       //ImGui::Text("0x%16lX", obj->uuid);
 
@@ -156,4 +237,11 @@ void Editor::ObjectInspector::draw() {
     }
     ImGui::EndPopup();
   }
+
+  if (isBatch && batchChangeCount != history.getChangeCount()) {
+    auto state = obj->serialize(false);
+    applyToSelection(*scene, obj->uuid, batchState, state);
+    batchState = std::move(state);
+    batchChangeCount = history.getChangeCount();
+  }
 }
@@ -3,12 +3,18 @@
 * @license MIT
 */
 #pragma once
+#include <cstdint>
+#include "json.hpp"
 
 namespace Editor
 {
   class ObjectInspector
   {
     private:
+      // state of the primary object as of the last edit, to find what to copy to the rest of the selection
+      nlohmann::json batchState{};
+      uint32_t batchUUID{0};
+      uint64_t batchChangeCount{0};
 
     public:
       ObjectInspector();
@@ -0,0 +1,446 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "profilerWindow.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "imgui.h"
+#include "json.hpp"
+#include "IconsMaterialDesignIcons.h"
+#include "../../../context.h"
+#include "../../../utils/fs.h"
+#include "../../../utils/logger.h"
+#include "../../../utils/filePicker.h"
+#include "../../../project/component/components.h"
+#include "../../imgui/notification.h"
+#include "../../imgui/theme.h"
+
+namespace
+{
+  // must match 'n64/engine/include/debug/trace.h'
+  constexpr const char* TRACE_MARKER_BEGIN = "[P64-TRACE-BEGIN]";
+  constexpr const char* TRACE_MARKER_END = "[P64-TRACE-END]";
+  // must match 'n64/engine/include/debug/inputReplay.h'
+  constexpr const char* INPUT_MARKER_BEGIN = "[P64-INPUT-BEGIN]";
+  constexpr const char* INPUT_MARKER_END = "[P64-INPUT-END]";
+  constexpr const char* INPUT_REPLAY_FILE = "data/input.replay";
+
+  constexpr float FRAME_BAR_HEIGHT = 64.0f;
+  constexpr float ZONE_ROW_HEIGHT = 18.0f;
+  constexpr float COUNTER_PLOT_HEIGHT = 32.0f;
+
+  struct Zone
+  {
+    std::string name{};
+    int arg{-1};
+    double start{}; // in us
+    double end{};
+    double childTime{};
+    uint32_t depth{};
+
+    [[nodiscard]] double getTime() const { return end - start; }
+  };
+
+  struct Frame
+  {
+    double start{}; // in us
+    double end{};
+    std::vector<Zone> zones{};
+    std::unordered_map<std::string, double> counters{};
+    uint32_t maxDepth{0};
+
+    [[nodiscard]] double getTimeMs() const { return (end - start) / 1000.0; }
+  };
+
+  struct BreakdownEntry
+  {
+    std::string label{};
+    uint32_t calls{0};
+    double time{0};
+    double selfTime{0};
+  };
+
+  std::vector<Frame> frames{};
+  std::vector<std::string> counterNames{};
+  int selFrame{-1};
+  float budgetMs{1000.0f / 30.0f};
+  bool sortByTime{true};
+
+  std::string getZoneLabel(const Zone &zone)
+  {
+    if(zone.arg < 0)return zone.name;
+    if(zone.name == "Comp-Update" || zone.name == "Comp-Draw") {
+      for(const auto &comp : Project::Component::TABLE) {
+        if(comp.id == zone.arg)return zone.name + ": " + comp.name;
+      }
+    }
+    return zone.name + " #" + std::to_string(zone.arg);
+  }
+
+  ImU32 getZoneColor(const std::string &name)
+  {
+    uint32_t hash = 2166136261u;
+    for(char c : name)hash = (hash ^ (uint8_t)c) * 16777619u;
+    float hue = (float)(hash % 360) / 360.0f;
+    float r, g, b;
+    ImGui::ColorConvertHSVtoRGB(hue, 0.55f, 0.75f, r, g, b);
+    return ImGui::GetColorU32({r, g, b, 1.0f});
+  }
+
+  ImU32 getFrameColor(double timeMs)
+  {
+    if(timeMs > budgetMs)return IM_COL32(0xE0, 0x40, 0x30, 0xFF);
+    if(timeMs > budgetMs * 0.8f)return IM_COL32(0xE0, 0xB0, 0x30, 0xFF);
+    return IM_COL32(0x40, 0xB0, 0x50, 0xFF);
+  }
+
+  void drawFrameBars()
+  {
+    auto pos = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 64.0f);
+    ImGui::InvisibleButton("##Frames", {width, FRAME_BAR_HEIGHT});
+    bool hovered = ImGui::IsItemHovered();
+
+    auto drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(pos, {pos.x + width, pos.y + FRAME_BAR_HEIGHT}, IM_COL32(0x10, 0x10, 0x10, 0xFF));
+
+    double maxMs = budgetMs * 1.5;
+    for(const auto &frame : frames)maxMs = std::max(maxMs, frame.getTimeMs());
+
+    float barWidth = std::max(width / (float)frames.size(), 1.0f);
+    auto hoverIdx = (int)((ImGui::GetMousePos().x - pos.x) / barWidth);
+
+    for(uint32_t i=0; i<frames.size(); ++i)
+    {
+      float x = pos.x + (float)i * barWidth;
+      if(x > pos.x + width)break;
+
+      double timeMs = frames[i].getTimeMs();
+      float h = (float)(timeMs / maxMs) * FRAME_BAR_HEIGHT;
+      ImU32 col = getFrameColor(timeMs);
+      if((int)i == selFrame)col = IM_COL32(0xFF, 0xFF, 0xFF, 0xFF);
+      else if(hovered && (int)i == hoverIdx)col = IM_COL32(0xA0, 0xD0, 0xFF, 0xFF);
+
+      drawList->AddRectFilled(
+        {x, pos.y + FRAME_BAR_HEIGHT - h},
+        {x + std::max(barWidth - 1.0f, 1.0f), pos.y + FRAME_BAR_HEIGHT},
+        col
+      );
+    }
+
+    float budgetY = pos.y + FRAME_BAR_HEIGHT - (float)(budgetMs / maxMs) * FRAME_BAR_HEIGHT;
+    drawList->AddLine({pos.x, budgetY}, {pos.x + width, budgetY}, IM_COL32(0xFF, 0xFF, 0xFF, 0x60));
+
+    if(hovered && hoverIdx >= 0 && hoverIdx < (int)frames.size())
+    {
+      ImGui::SetTooltip("Frame %d: %.2fms", hoverIdx, frames[hoverIdx].getTimeMs());
+      if(ImGui::IsMouseClicked(ImGuiMouseButton_Left))selFrame = hoverIdx;
+    }
+  }
+
+  void drawCounters()
+  {
+    for(const auto &name : counterNames)
+    {
+      std::vector<float> values{};
+      values.reserve(frames.size());
+      for(const auto &frame : frames) {
+        auto it = frame.counters.find(name);
+        values.push_back(it == frame.counters.end() ? 0.0f : (float)it->second);
+      }
+
+      std::string overlay = name;
+      if(selFrame >= 0)overlay += ": " + std::to_string((int)values[selFrame]);
+
+      ImGui::PlotLines(("##" + name).c_str(), values.data(), (int)values.size(), 0,
+        overlay.c_str(), 0.0f, FLT_MAX, {ImGui::GetContentRegionAvail().x, COUNTER_PLOT_HEIGHT}
+      );
+    }
+  }
+
+  void drawTimeline(const Frame &frame)
+  {
+    auto pos = ImGui::GetCursorScreenPos();
+    float width = std::max(ImGui::GetContentRegionAvail().x, 64.0f);
+    float height = (float)(frame.maxDepth + 1) * ZONE_ROW_HEIGHT;
+    ImGui::InvisibleButton("##Timeline", {width, height});
+    bool hovered = ImGui::IsItemHovered();
+    auto mousePos = ImGui::GetMousePos();
+
+    auto drawList = ImGui::GetWindowDrawList();
+    drawList->AddRectFilled(pos, {pos.x + width, pos.y + height}, IM_COL32(0x10, 0x10, 0x10, 0xFF));
+
+    double frameTime = std::max(frame.end - frame.start, 1.0);
+    float scale = width / (float)frameTime;
+    const Zone *hoverZone = nullptr;
+
+    for(const auto &zone : frame.zones)
+    {
+      ImVec2 a{pos.x + (float)(zone.start - frame.start) * scale, pos.y + (float)zone.depth * ZONE_ROW_HEIGHT};
+      ImVec2 b{pos.x + (float)(zone.end - frame.start) * scale, a.y + ZONE_ROW_HEIGHT - 1.0f};
+      b.x = std::max(b.x, a.x + 1.0f);
+
+      drawList->AddRectFilled(a, b, getZoneColor(zone.name));
+
+      auto label = getZoneLabel(zone);
+      if(ImGui::CalcTextSize(label.c_str()).x < (b.x - a.x - 4.0f)) {
+        drawList->AddText({a.x + 2.0f, a.y + 1.0f}, IM_COL32(0, 0, 0, 0xFF), label.c_str());
+      }
+
+      if(hovered && mousePos.x >= a.x && mousePos.x < b.x && mousePos.y >= a.y && mousePos.y < b.y) {
+        hoverZone = &zone;
+      }
+    }
+
+    if(hoverZone) {
+      ImGui::SetTooltip("%s\n%.3fms (self: %.3fms)",
+        getZoneLabel(*hoverZone).c_str(),
+        hoverZone->getTime() / 1000.0,
+        (hoverZone->getTime() - hoverZone->childTime) / 1000.0
+      );
+    }
+  }
+
+  void drawBreakdown(const Frame &frame)
+  {
+    std::vector<BreakdownEntry> entries{};
+    std::unordered_map<std::string, uint32_t> entryIdx{};
+
+    for(const auto &zone : frame.zones)
+    {
+      auto label = getZoneLabel(zone);
+      auto it = entryIdx.find(label);
+      if(it == entryIdx.end()) {
+        it = entryIdx.emplace(label, entries.size()).first;
+        entries.push_back({label});
+      }
+      auto &entry = entries[it->second];
+      ++entry.calls;
+      entry.time += zone.getTime();
+      entry.selfTime += zone.getTime() - zone.childTime;
+    }
+
+    if(sortByTime) {
+      std::stable_sort(entries.begin(), entries.end(), [](const BreakdownEntry &a, const BreakdownEntry &b) {
+        return a.selfTime > b.selfTime;
+      });
+    }
+
+    constexpr ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY;
+    if(!ImGui::BeginTable("##Breakdown", 4, flags))return;
+
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Calls", ImGuiTableColumnFlags_WidthFixed, 48.0f);
+    ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Self (ms)", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableHeadersRow();
+
+    const double frameTime = std::max(frame.end - frame.start, 1.0);
+    for(const auto &entry : entries)
+    {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(entry.label.c_str());
+      ImGui::TableNextColumn(); ImGui::Text("%u", entry.calls);
+      ImGui::TableNextColumn(); ImGui::Text("%.3f", entry.time / 1000.0);
+      ImGui::TableNextColumn();
+      if(entry.selfTime > frameTime * 0.25) {
+        ImGui::TextColored({1.0f, 0.45f, 0.35f, 1.0f}, "%.3f", entry.selfTime / 1000.0);
+      } else {
+        ImGui::Text("%.3f", entry.selfTime / 1000.0);
+      }
+    }
+    ImGui::EndTable();
+  }
+}
+
+bool Editor::ProfilerWindow::saveInput(const std::string &text)
+{
+  size_t posStart = text.rfind(INPUT_MARKER_BEGIN);
+  if(posStart == std::string::npos)return false;
+  posStart += strlen(INPUT_MARKER_BEGIN);
+  size_t posEnd = text.find(INPUT_MARKER_END, posStart);
+  if(posEnd == std::string::npos)return false;
+
+  // one line of hex per chunk, anything before it on the line (log prefixes) is skipped
+  std::string data{};
+  size_t lineStart = posStart;
+  while(lineStart < posEnd)
+  {
+    size_t lineEnd = text.find('\n', lineStart);
+    if(lineEnd == std::string::npos || lineEnd > posEnd)lineEnd = posEnd;
+    std::string_view line{text.data() + lineStart, lineEnd - lineStart};
+    lineStart = lineEnd + 1;
+
+    while(!line.empty() && std::isspace((unsigned char)line.back()))line.remove_suffix(1);
+    size_t hexStart = line.size();
+    while(hexStart > 0 && std::isxdigit((unsigned char)line[hexStart-1]))--hexStart;
+    line = line.substr(hexStart);
+    for(size_t i=0; i+1 < line.size(); i += 2) {
+      data.push_back((char)std::stoi(std::string{line.substr(i, 2)}, nullptr, 16));
+    }
+  }
+  if(data.empty())return false;
+
+  auto path = fs::path{ctx.project->getPath()} / INPUT_REPLAY_FILE;
+  fs::create_directories(path.parent_path());
+  Utils::FS::saveTextFile(path, data);
+  return true;
+}
+
+bool Editor::ProfilerWindow::load(const std::string &text)
+{
+  // the log may contain multiple dumps, only the last one is used
+  size_t posStart = text.rfind(TRACE_MARKER_BEGIN);
+  posStart = (posStart == std::string::npos) ? 0 : (posStart + strlen(TRACE_MARKER_BEGIN));
+  size_t posEnd = text.find(TRACE_MARKER_END, posStart);
+  if(posEnd == std::string::npos)posEnd = text.size();
+
+  std::vector<Frame> newFrames{};
+  std::vector<std::string> newCounterNames{};
+  std::vector<uint32_t> stack{};
+  Frame *frame = nullptr;
+
+  // the runtime writes one event per line, so lines with a prefix (from the emulator or log) still work
+  size_t lineStart = posStart;
+  while(lineStart < posEnd)
+  {
+    size_t lineEnd = text.find('\n', lineStart);
+    if(lineEnd == std::string::npos || lineEnd > posEnd)lineEnd = posEnd;
+    std::string_view line{text.data() + lineStart, lineEnd - lineStart};
+    lineStart = lineEnd + 1;
+
+    size_t objStart = line.find("{\"ph\"");
+    size_t objEnd = line.rfind('}');
+    if(objStart == std::string::npos || objEnd == std::string::npos || objEnd < objStart)continue;
+
+    auto ev = nlohmann::json::parse(line.substr(objStart, objEnd - objStart + 1), nullptr, false);
+    if(ev.is_discarded() || !ev.is_object())continue;
+
+    std::string ph = ev.value("ph", "");
+    std::string name = ev.value("name", "");
+    double ts = ev.value("ts", 0.0);
+
+    if(name == "Frame")
+    {
+      if(ph == "B") {
+        frame = &newFrames.emplace_back();
+        frame->start = ts;
+        frame->end = ts;
+        stack.clear();
+      } else if(ph == "E" && frame) {
+        frame->end = ts;
+      }
+      continue;
+    }
+    if(!frame)continue;
+
+    if(ph == "B") {
+      auto &zone = frame->zones.emplace_back();
+      zone.name = name;
+      zone.start = ts;
+      zone.end = ts;
+      zone.depth = stack.size();
+      if(ev.contains("args"))zone.arg = ev["args"].value("id", -1);
+      frame->maxDepth = std::max(frame->maxDepth, zone.depth);
+      stack.push_back(frame->zones.size() - 1);
+    } else if(ph == "E" && !stack.empty()) {
+      auto &zone = frame->zones[stack.back()];
+      zone.end = ts;
+      stack.pop_back();
+      if(!stack.empty())frame->zones[stack.back()].childTime += zone.getTime();
+    } else if(ph == "C" && ev.contains("args")) {
+      if(std::find(newCounterNames.begin(), newCounterNames.end(), name) == newCounterNames.end()) {
+        newCounterNames.push_back(name);
+      }
+      frame->counters[name] = ev["args"].value("value", 0.0);
+    }
+  }
+
+  // the last frame is still running while dumping
+  if(!newFrames.empty() && newFrames.back().end <= newFrames.back().start)newFrames.pop_back();
+  if(newFrames.empty())return false;
+
+  frames = std::move(newFrames);
+  counterNames = std::move(newCounterNames);
+  selFrame = -1;
+  return true;
+}
+
+void Editor::ProfilerWindow::draw()
+{
+  if(ImGui::Button(ICON_MDI_TEXT_BOX_SEARCH_OUTLINE " From Log")) {
+    if(!load(Utils::Logger::getLog())) {
+      Editor::Noti::add(Editor::Noti::ERROR, "No trace found in the log!\nUse 'Trace-Dump' in the debug menu (build with P64_TRACE=1).");
+    }
+  }
+  ImGui::SameLine();
+  if(ImGui::Button(ICON_MDI_FOLDER_OPEN_OUTLINE " Open File")) {
+    Utils::FilePicker::open([this](const std::string &path) {
+      if(path.empty())return;
+      if(!load(Utils::FS::loadTextFile(path))) {
+        Editor::Noti::add(Editor::Noti::ERROR, "No trace found in file!");
+      }
+    }, {.title="Open Trace (log or JSON)"});
+  }
+
+  if(ctx.project)
+  {
+    ImGui::SameLine();
+    if(ImGui::Button(ICON_MDI_CONTROLLER " Save Input")) {
+      if(saveInput(Utils::Logger::getLog())) {
+        Editor::Noti::add(Editor::Noti::SUCCESS, "Input saved, the next build replays it at boot.");
+      } else {
+        Editor::Noti::add(Editor::Noti::ERROR, "No input recording found in the log!\nUse 'Input-Rec' and 'Input-Dump' in the debug menu (build with P64_INPUT_REPLAY=1).");
+      }
+    }
+    if(ImGui::IsItemHovered())ImGui::SetTooltip("Saves the last recording from the log as '%s'", INPUT_REPLAY_FILE);
+
+    auto replayPath = fs::path{ctx.project->getPath()} / INPUT_REPLAY_FILE;
+    if(fs::exists(replayPath)) {
+      ImGui::SameLine();
+      if(ImGui::Button(ICON_MDI_CLOSE " Clear Input")) {
+        std::error_code err{};
+        fs::remove(replayPath, err);
+      }
+    }
+  }
+
+  ImGui::SameLine();
+  ImGui::SetNextItemWidth(100);
+  ImGui::DragFloat("Budget (ms)", &budgetMs, 0.1f, 1.0f, 100.0f, "%.2f");
+
+  if(frames.empty()) {
+    ImGui::TextDisabled("No trace loaded");
+    return;
+  }
+
+  ImGui::SameLine();
+  ImGui::Text("| %d frames, %d over budget", (int)frames.size(),
+    (int)std::count_if(frames.begin(), frames.end(), [](const Frame &f) { return f.getTimeMs() > budgetMs; })
+  );
+
+  drawFrameBars();
+  drawCounters();
+
+  if(selFrame < 0 || selFrame >= (int)frames.size()) {
+    ImGui::TextDisabled("Click a frame to inspect it");
+    return;
+  }
+
+  const auto &frame = frames[selFrame];
+  ImGui::Text("Frame %d: %.2fms", selFrame, frame.getTimeMs());
+  ImGui::SameLine();
+  ImGui::Checkbox("Sort by self-time", &sortByTime);
+
+  ImGui::PushFont(ImGui::getFontMono());
+  drawTimeline(frame);
+  drawBreakdown(frame);
+  ImGui::PopFont();
+}
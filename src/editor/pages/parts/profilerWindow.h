@@ -0,0 +1,25 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <string>
+
+namespace Editor
+{
+  /**
+   * Viewer for traces recorded by the runtime ('Debug::Trace' in the engine).
+   * Traces are read from the log of the last run in an emulator, or from a saved log / JSON file.
+ * Also saves input recordings from the log, so the next build replays them for comparable traces.
+   */
+  class ProfilerWindow
+  {
+    private:
+      bool load(const std::string &text);
+      // extracts the last input recording ('Debug::InputReplay::dump') and saves it to the project
+      bool saveInput(const std::string &text);
+
+    public:
+      void draw();
+  };
+}
@@ -16,11 +16,30 @@ bool Editor::ProjectSettings::draw()
     ImTable::start("General");
     ImTable::add("Name", ctx.project->conf.name);
     ImTable::add("ROM-Name", ctx.project->conf.romName);
+    // checked against the estimated peak of each scene after a build, see the 'ROM' window
+    ImTable::add("RDRAM Budget (KB)", ctx.project->conf.memBudgetKB);
+    // per frame, the scene inspector warns if a scene or camera view goes above them (0 = no limit)
+    ImTable::add("Triangle Budget", ctx.project->conf.budgetTris);
+    ImTable::add("Vertex-Load Budget", ctx.project->conf.budgetVertLoads);
+    ImTable::add("Texture-Load Budget", ctx.project->conf.budgetTexLoads);
+    ImTable::add("Matrix Budget", ctx.project->conf.budgetMatrices);
+    // prefabs only spawned by code (not referenced in the scene) can't be found, keep this off for those
+    ImTable::addCheckBox("Scene Script Overlays", ctx.project->conf.scriptOverlays);
+    // falls back to a full repack on its own if the code changed or files got added or bigger
+    ImTable::addCheckBox("Fast Asset Repack", ctx.project->conf.fastRepack);
+    // scripts then share a translation unit, names in anonymous namespaces or 'static' ones must be unique
+    ImTable::addCheckBox("Unity Build", ctx.project->conf.unityBuild);
+    if(ctx.project->conf.unityBuild) {
+      ImTable::addCheckBox("Precompiled Header", ctx.project->conf.unityPCH);
+    }
     ImTable::end();
   }
   if (ImGui::CollapsingHeader("Environment", ImGuiTreeNodeFlags_DefaultOpen)) {
     ImTable::start("Environment");
     ImTable::addPath("Emulator", ctx.project->conf.pathEmu);
+    ImTable::addPath("Flashcart Loader", ctx.project->conf.pathLoader);
+    // the ROM (engine included) has to be built with '-DP64_HOT_RELOAD=1', only filesystem files can be replaced
+    ImTable::addPath("Hot-Reload Sender", ctx.project->conf.pathHotReload);
     ImTable::addPath("N64_INST", ctx.project->conf.pathN64Inst, true, "$N64_INST");
     ImTable::end();
   }
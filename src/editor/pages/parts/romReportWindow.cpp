@@ -0,0 +1,260 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "romReportWindow.h"
+
+#include <chrono>
+#include <filesystem>
+
+#include "imgui.h"
+#include "json.hpp"
+#include "../../../context.h"
+#include "../../../build/romReport.h"
+#include "../../../utils/fs.h"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+  constexpr auto RELOAD_CHECK_INTERVAL = std::chrono::seconds(1);
+
+  constexpr ImVec4 COLOR_OVER_BUDGET{1.0f, 0.45f, 0.35f, 1.0f};
+  constexpr ImVec4 COLOR_NEAR_BUDGET{1.0f, 0.8f, 0.3f, 1.0f};
+  constexpr float NEAR_BUDGET_FACTOR = 0.9f;
+  constexpr float AUDIO_FRAME_MS = 1000.0f / 60.0f;
+
+  constexpr const char* RAM_PARTS[][2] = {
+    {"code", "Code"},
+    {"assets", "Assets"},
+    {"chunks", "Chunks"},
+    {"objects", "Objects"},
+    {"matrices", "Matrices"},
+    {"layers", "Layer Buffers"},
+    {"framebuffers", "Framebuffers"},
+  };
+
+  nlohmann::json report{};
+  std::string reportPath{};
+  uint64_t reportAge{0};
+  std::chrono::steady_clock::time_point lastCheck{};
+
+  // re-reads the report if a build wrote a new one
+  void checkReload()
+  {
+    auto now = std::chrono::steady_clock::now();
+    auto path = (fs::path{ctx.project->getPath()} / Build::ROM_REPORT_FILE).string();
+    if(path == reportPath && now - lastCheck < RELOAD_CHECK_INTERVAL)return;
+    lastCheck = now;
+
+    auto age = Utils::FS::getFileAge(path);
+    if(path == reportPath && age == reportAge)return;
+    reportPath = path;
+    reportAge = age;
+
+    report = nlohmann::json::parse(Utils::FS::loadTextFile(path), nullptr, false);
+    if(report.is_discarded() || !report.is_object())report = {};
+  }
+
+  void textKB(uint64_t bytes) {
+    ImGui::Text("%.1f KB", bytes / 1024.0);
+  }
+
+  void drawSizeTable(const char* id, const char* label, const nlohmann::json &entries, auto getName)
+  {
+    if(!ImGui::BeginTable(id, 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn(label, ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Files", ImGuiTableColumnFlags_WidthFixed, 48.0f);
+    ImGui::TableSetupColumn("Size", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableHeadersRow();
+    for(const auto &entry : entries) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(getName(entry).c_str());
+      ImGui::TableNextColumn(); ImGui::Text("%u", entry.value("count", 0u));
+      ImGui::TableNextColumn(); textKB(entry.value<uint64_t>("size", 0));
+    }
+    ImGui::EndTable();
+  }
+
+  void drawScenes()
+  {
+    if(!ImGui::BeginTable("##Scenes", 6, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn("Scene", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("ROM", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableSetupColumn("Est. RDRAM", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableSetupColumn("Budget", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableSetupColumn("Usage", ImGuiTableColumnFlags_WidthFixed, 128.0f);
+    ImGui::TableSetupColumn("Audio", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableHeadersRow();
+
+    for(const auto &scene : report.value("scenes", nlohmann::json::array()))
+    {
+      auto ram = scene.value<uint64_t>("ramTotal", 0);
+      auto budget = scene.value<uint64_t>("budget", 0);
+      float usage = budget ? (float)ram / (float)budget : 0.0f;
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%u: %s", scene.value("id", 0u), scene.value("name", "").c_str());
+      ImGui::TableNextColumn(); textKB(scene.value<uint64_t>("romSize", 0));
+      ImGui::TableNextColumn();
+      if(usage > 1.0f) {
+        ImGui::TextColored(COLOR_OVER_BUDGET, "%.1f KB", ram / 1024.0);
+      } else {
+        textKB(ram);
+      }
+      if(ImGui::BeginItemTooltip())
+      {
+        const auto &parts = scene.value("ram", nlohmann::json::object());
+        for(auto &[key, name] : RAM_PARTS) {
+          ImGui::Text("%-14s %10.1f KB", name, parts.value<uint64_t>(key, 0) / 1024.0);
+        }
+        ImGui::Text("%-14s %10u", "Objects", scene.value("objCount", 0u));
+        ImGui::EndTooltip();
+      }
+      ImGui::TableNextColumn(); textKB(budget);
+      ImGui::TableNextColumn();
+
+      bool highlight = usage >= NEAR_BUDGET_FACTOR;
+      if(highlight)ImGui::PushStyleColor(ImGuiCol_PlotHistogram, usage > 1.0f ? COLOR_OVER_BUDGET : COLOR_NEAR_BUDGET);
+      char label[16];
+      snprintf(label, sizeof(label), "%.0f%%", usage * 100.0f);
+      ImGui::ProgressBar(std::min(usage, 1.0f), {-FLT_MIN, 0}, label);
+      if(highlight)ImGui::PopStyleColor();
+
+      auto audioMs = scene.value("audioDecodeUs", 0.0f) / 1000.0f;
+      ImGui::TableNextColumn(); ImGui::Text("%.2f ms", audioMs);
+      ImGui::SetItemTooltip("Decode time per frame if all sounds of the scene play at once\n(as far as the mixer has channels), %.0f%% of a 60 FPS frame",
+        audioMs / AUDIO_FRAME_MS * 100.0f);
+    }
+    ImGui::EndTable();
+  }
+
+  void drawAudio()
+  {
+    const auto &entries = report.value("audio", nlohmann::json::array());
+    if(entries.empty()) {
+      ImGui::TextDisabled("No sounds (only WAV files are analyzed)");
+      return;
+    }
+    ImGui::TextDisabled("Rough estimates, mixing costs the same for all codecs and is not included");
+
+    if(!ImGui::BeginTable("##Audio", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn("Sound", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("Length", ImGuiTableColumnFlags_WidthFixed, 64.0f);
+    ImGui::TableSetupColumn("Codec", ImGuiTableColumnFlags_WidthFixed, 64.0f);
+    ImGui::TableSetupColumn("Decode", ImGuiTableColumnFlags_WidthFixed, 80.0f);
+    ImGui::TableSetupColumn("Recommended", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableHeadersRow();
+
+    for(const auto &entry : entries)
+    {
+      auto codec = entry.value("codec", "");
+      auto recommended = entry.value("recommended", "");
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(entry.value("name", "").c_str());
+      ImGui::TableNextColumn(); ImGui::Text("%.1fs", entry.value("duration", 0.0f));
+      ImGui::TableNextColumn(); ImGui::TextUnformatted(codec.c_str());
+      ImGui::TableNextColumn(); ImGui::Text("%.2f ms", entry.value("decodeUs", 0.0f) / 1000.0f);
+      ImGui::TableNextColumn();
+      if(codec == recommended) {
+        ImGui::TextDisabled("%s", recommended.c_str());
+      } else {
+        ImGui::TextColored(COLOR_NEAR_BUDGET, "%s", recommended.c_str());
+      }
+    }
+    ImGui::EndTable();
+  }
+
+  void drawCode()
+  {
+    const auto &entries = report.value("code", nlohmann::json::array());
+    if(entries.empty()) {
+      ImGui::TextDisabled("No linker map found in the last build");
+      return;
+    }
+    ImGui::TextDisabled("Script overlays are loaded separately and not included");
+
+    if(!ImGui::BeginTable("##Code", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn("Owner", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn(".text", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableSetupColumn(".data", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableSetupColumn(".bss", ImGuiTableColumnFlags_WidthFixed, 96.0f);
+    ImGui::TableHeadersRow();
+
+    ImGuiListClipper clipper{};
+    clipper.Begin((int)entries.size());
+    while(clipper.Step()) {
+      for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+        const auto &entry = entries[i];
+        ImGui::TableNextRow();
+        ImGui::TableNextColumn();
+        ImGui::TextDisabled("%s", entry.value("kind", "").c_str());
+        ImGui::SameLine();
+        ImGui::TextUnformatted(entry.value("name", "").c_str());
+        ImGui::TableNextColumn(); textKB(entry.value<uint64_t>("text", 0));
+        ImGui::TableNextColumn(); textKB(entry.value<uint64_t>("data", 0));
+        ImGui::TableNextColumn(); textKB(entry.value<uint64_t>("bss", 0));
+      }
+    }
+    ImGui::EndTable();
+  }
+}
+
+void Editor::RomReportWindow::draw()
+{
+  if(!ctx.project)return;
+  checkReload();
+
+  if(report.empty()) {
+    ImGui::TextDisabled("No report yet, build the project to create one");
+    return;
+  }
+
+  ImGui::Text("ROM: %.1f KB | Code: %.1f KB | DFS: %.1f KB",
+    report.value<uint64_t>("romSize", 0) / 1024.0,
+    report.value<uint64_t>("codeSize", 0) / 1024.0,
+    report.value<uint64_t>("dfsSize", 0) / 1024.0
+  );
+  ImGui::TextDisabled("RDRAM is a rough estimate of the peak use, worst case for streamed chunks");
+
+  if(ImGui::CollapsingHeader("Scenes", ImGuiTreeNodeFlags_DefaultOpen)) {
+    drawScenes();
+  }
+
+  if(ImGui::CollapsingHeader("Audio")) {
+    drawAudio();
+  }
+
+  if(ImGui::CollapsingHeader("Code")) {
+    drawCode();
+  }
+
+  if(ImGui::CollapsingHeader("Asset Types")) {
+    drawSizeTable("##Types", "Type", report.value("types", nlohmann::json::array()), [](const nlohmann::json &entry) {
+      return entry.value("name", "");
+    });
+  }
+
+  if(ImGui::CollapsingHeader("Compression")) {
+    drawSizeTable("##Compression", "Level", report.value("compression", nlohmann::json::array()), [](const nlohmann::json &entry) {
+      auto level = entry.value("level", 0u);
+      return level == 0 ? std::string{"None"} : ("Level " + std::to_string(level));
+    });
+  }
+
+  auto duplicateSize = report.value<uint64_t>("duplicateSize", 0);
+  auto dupLabel = "Duplicates (" + std::to_string(duplicateSize / 1024) + " KB)###Duplicates";
+  if(ImGui::CollapsingHeader(dupLabel.c_str())) {
+    const auto &duplicates = report.value("duplicates", nlohmann::json::array());
+    if(duplicates.empty())ImGui::TextDisabled("No files with identical content");
+
+    for(const auto &entry : duplicates) {
+      auto files = entry.value("files", std::vector<std::string>{});
+      ImGui::Text("%.1f KB x%d", entry.value<uint64_t>("size", 0) / 1024.0, (int)files.size());
+      ImGui::Indent();
+      for(const auto &file : files)ImGui::TextDisabled("%s", file.c_str());
+      ImGui::Unindent();
+    }
+  }
+}
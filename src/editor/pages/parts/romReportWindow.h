@@ -0,0 +1,20 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+
+namespace Editor
+{
+  /**
+   * Shows the ROM report of the last build ('Build::writeRomReport'):
+   * ROM/DFS size per asset type, scene and compression level, duplicated files,
+   * code size per script, node graph, component and engine module,
+   * and the estimated peak RDRAM of each scene against its budget.
+   */
+  class RomReportWindow
+  {
+    public:
+      void draw();
+  };
+}
@@ -11,6 +11,8 @@
 #include "imgui_internal.h"
 #include "../../undoRedo.h"
 
+#include <cctype>
+
 namespace
 {
   Project::Object* deleteObj{nullptr};
@@ -23,7 +25,7 @@ namespace
 
   DragDropTask dragDropTask{};
 
-  bool DrawDropTarget(uint32_t& dragDropTarget, uint32_t uuid, float thickness = 2.0f, float hitHeight = 8.0f)
+  bool DrawDropTarget(uint32_t& dragDropTarget, float thickness = 2.0f, float hitHeight = 8.0f)
   {
     // Only show when drag-drop is active
     if (!ImGui::IsDragDropActive())
@@ -43,7 +45,6 @@ namespace
 
     // Push a dummy cursor to draw hit zone *without affecting layout*
     ImGui::SetCursorScreenPos(overlayStart);
-    ImGui::PushID(("drop_overlay_" + std::to_string(uuid)).c_str());
     ImGui::InvisibleButton("##dropzone", ImVec2(fullWidth, hitHeight));
     bool hovered = ImGui::IsItemHovered(ImGuiHoveredFlags_AllowWhenBlockedByActiveItem);
 
@@ -69,135 +70,168 @@ namespace
     }
     ImGui::PopStyleColor();
 
-    ImGui::PopID();
-
     ImGui::SetCursorScreenPos(cursorScreen);
     return res;
   }
 
-  void drawObjectNode(
-    Project::Scene &scene, Project::Object &obj, bool keyDelete,
-    bool parentEnabled = true
-  )
-  {
-    ImGuiTreeNodeFlags flag = ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_OpenOnArrow
-      | ImGuiTreeNodeFlags_OpenOnDoubleClick | ImGuiTreeNodeFlags_DrawLinesFull
-      | ImGuiTreeNodeFlags_FramePadding | ImGuiTreeNodeFlags_SpanAllColumns;
+  void toLower(std::string &str) {
+    for(auto &c : str)c = (char)std::tolower((unsigned char)c);
+  }
+}
 
-    if (obj.children.empty()) {
-      flag |= ImGuiTreeNodeFlags_Leaf;
-    }
+void Editor::SceneGraph::updateRows(Project::Scene &scene)
+{
+  auto changeCount = UndoRedo::getHistory().getChangeCount();
+  bool isSameScene = cache.scene == &scene && cache.structureVersion == scene.structureVersion
+    && cache.changeCount == changeCount;
+  if(isSameScene && !cache.dirty)return;
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
-    if (isSelected) {
-      flag |= ImGuiTreeNodeFlags_Selected;
+  // renames only show up as a change, so the index is rebuilt with anything that could have touched an object
+  if(!isSameScene)
+  {
+    cache.names.clear();
+    cache.names.reserve(scene.objectsMap.size());
+    for(auto &[uuid, obj] : scene.objectsMap) {
+      cache.names.push_back({obj->name, obj.get()});
+      toLower(cache.names.back().name);
     }
+    cache.scene = &scene;
+    cache.structureVersion = scene.structureVersion;
+    cache.changeCount = changeCount;
+  }
+  cache.dirty = false;
 
-    if (isSelected && obj.parent && keyDelete) {
-      deleteObj = &obj;
+  searchMatches.clear();
+  if(!searchFilter.empty())
+  {
+    auto filter = searchFilter;
+    toLower(filter);
+    for(auto &entry : cache.names) {
+      if(!entry.name.contains(filter))continue;
+      for(auto obj = entry.obj; obj && searchMatches.insert(obj->uuid).second; obj = obj->parent);
     }
+  }
 
-    ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.f, 3.f));
-    ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0.f, 0.f));
+  cache.rows.clear();
+  appendRows(scene.getRootObject(), 0, true);
+}
 
-    std::string nameID{};
-    if(obj.uuidPrefab.value) {
-      nameID += ICON_MDI_PACKAGE_VARIANT_CLOSED " ";
-    }
-    nameID += obj.name + "##" + std::to_string(obj.uuid);
+void Editor::SceneGraph::appendRows(Project::Object &obj, uint32_t depth, bool parentEnabled)
+{
+  bool hasFilter = !searchFilter.empty();
+  if(hasFilter && obj.parent && !searchMatches.contains(obj.uuid))return;
 
-    bool isOpen = ImGui::TreeNodeEx(nameID.c_str(), flag);
-    ImGui::PopStyleVar(2);
+  // while searching, everything leading to a match is shown regardless of collapsed nodes
+  bool isOpen = hasFilter || !collapsed.contains(obj.uuid);
+  cache.rows.push_back({&obj, depth, parentEnabled, isOpen});
+  if(!isOpen)return;
 
-    bool nodeIsClicked = ImGui::IsItemHovered()
-      && ImGui::IsMouseReleased(ImGuiMouseButton_Left)
-      && !ImGui::IsMouseDragging(ImGuiMouseButton_Left);
-    if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
-      ImGui::OpenPopup("NodePopup");
-    }
+  for(auto &child : obj.children) {
+    appendRows(*child, depth + 1, parentEnabled && obj.enabled);
+  }
+}
 
-    if (obj.parent && ImGui::BeginDragDropSource())
-    {
-      ImGui::SetDragDropPayload("OBJECT", &obj.uuid, sizeof(obj.uuid));
-      ImGui::EndDragDropSource();
-    }
+void Editor::SceneGraph::drawRow(const Row &row)
+{
+  auto &obj = *row.obj;
+  ImGuiTreeNodeFlags flag = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_OpenOnDoubleClick
+    | ImGuiTreeNodeFlags_FramePadding | ImGuiTreeNodeFlags_SpanAllColumns
+    | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 
-    if (obj.parent && ImGui::BeginDragDropTarget()) {
-      if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("OBJECT")) {
-        dragDropTask.sourceUUID = *((uint32_t*)payload->Data);
-        dragDropTask.targetUUID = obj.uuid;
-        dragDropTask.isInsert = true;
-      }
-      ImGui::EndDragDropTarget();
-    }
+  if (obj.children.empty()) {
+    flag |= ImGuiTreeNodeFlags_Leaf;
+  }
 
-    if(obj.parent)
-    {
-      float spacing = ImGui::GetStyle().ItemInnerSpacing.x;
-      constexpr float buttonSize = 12;
-      ImVec2 iconSize{16, 21};
+  bool isSelected = ctx.isObjectSelected(obj.uuid);
+  if (isSelected) {
+    flag |= ImGuiTreeNodeFlags_Selected;
+  }
 
-      auto oldCursorPos = ImGui::GetCursorPos();
-      ImGui::SameLine(ImGui::GetWindowContentRegionMax().x - ImGui::GetStyle().WindowPadding.x - buttonSize * 2 - spacing);
+  // IDs are integers and the label is formatted into ImGui's own buffer, nothing is allocated per row
+  ImGui::PushID((int)obj.uuid);
+  float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+  if(indent > 0)ImGui::Indent(indent);
 
-      if(!parentEnabled)ImGui::BeginDisabled();
+  ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.f, 3.f));
+  ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(0.f, 0.f));
 
-      ImGui::PushID(("vis_" + std::to_string(obj.uuid)).c_str());
+  ImGui::SetNextItemOpen(row.isOpen);
+  bool isOpen = ImGui::TreeNodeEx("##node", flag, "%s%s",
+    obj.uuidPrefab.value ? ICON_MDI_PACKAGE_VARIANT_CLOSED " " : "", obj.name.c_str()
+  );
+  ImGui::PopStyleVar(2);
 
-      int clicked = 0;
-      clicked |= ImGui::IconToggle(obj.selectable, ICON_MDI_CURSOR_DEFAULT, ICON_MDI_CURSOR_DEFAULT_OUTLINE, iconSize);
-      ImGui::SameLine(0, spacing);
-      clicked |= ImGui::IconToggle(obj.enabled, ICON_MDI_CHECKBOX_MARKED, ICON_MDI_CHECKBOX_BLANK_OUTLINE, iconSize);
+  if(isOpen != row.isOpen && !obj.children.empty() && searchFilter.empty()) {
+    if(isOpen)collapsed.erase(obj.uuid);
+    else collapsed.insert(obj.uuid);
+    cache.dirty = true;
+  }
 
-      if(clicked)nodeIsClicked = false;
+  bool nodeIsClicked = ImGui::IsItemHovered()
+    && ImGui::IsMouseReleased(ImGuiMouseButton_Left)
+    && !ImGui::IsMouseDragging(ImGuiMouseButton_Left);
+  if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
+    popupUUID = obj.uuid;
+    openPopup = true;
+  }
 
-      ImGui::PopID();
+  if (obj.parent && ImGui::BeginDragDropSource())
+  {
+    ImGui::SetDragDropPayload("OBJECT", &obj.uuid, sizeof(obj.uuid));
+    ImGui::EndDragDropSource();
+  }
 
-      if(!parentEnabled)ImGui::EndDisabled();
-      ImGui::SetCursorPosY(oldCursorPos.y);
+  if (obj.parent && ImGui::BeginDragDropTarget()) {
+    if (const ImGuiPayload* payload = ImGui::AcceptDragDropPayload("OBJECT")) {
+      dragDropTask.sourceUUID = *((uint32_t*)payload->Data);
+      dragDropTask.targetUUID = obj.uuid;
+      dragDropTask.isInsert = true;
     }
+    ImGui::EndDragDropTarget();
+  }
 
-    if(ImGui::IsDragDropActive()) {
-      if(DrawDropTarget(dragDropTask.sourceUUID, obj.uuid)) {
-        dragDropTask.targetUUID = obj.uuid;
-      }
-    }
+  if(obj.parent)
+  {
+    float spacing = ImGui::GetStyle().ItemInnerSpacing.x;
+    constexpr float buttonSize = 12;
+    ImVec2 iconSize{16, 21};
 
-    if (nodeIsClicked) {
-      ctx.selObjectUUID = obj.uuid;
-      //ImGui::SetWindowFocus("Object");
-      //ImGui::SetWindowFocus("Graph");
-    }
+    auto oldCursorPos = ImGui::GetCursorPos();
+    ImGui::SameLine(ImGui::GetWindowContentRegionMax().x - ImGui::GetStyle().WindowPadding.x - buttonSize * 2 - spacing);
 
-    if(isOpen)
-    {
-      if (ImGui::BeginPopupContextItem("NodePopup"))
-      {
-        if (ImGui::MenuItem(ICON_MDI_CUBE_OUTLINE " Add Object")) {
-          auto added = scene.addObject(obj);
-          if (added) {
-            ctx.selObjectUUID = added->uuid;
-          }
-          Editor::UndoRedo::getHistory().markChanged("Add Object");
-        }
+    if(!row.parentEnabled)ImGui::BeginDisabled();
 
-        if (obj.parent) {
-          if (!obj.isPrefabInstance() && ImGui::MenuItem(ICON_MDI_PACKAGE_VARIANT_CLOSED_PLUS " To Prefab")) {
-            scene.createPrefabFromObject(obj.uuid);
-          }
+    int clicked = 0;
+    clicked |= ImGui::IconToggle(obj.selectable, ICON_MDI_CURSOR_DEFAULT, ICON_MDI_CURSOR_DEFAULT_OUTLINE, iconSize);
+    ImGui::SameLine(0, spacing);
+    clicked |= ImGui::IconToggle(obj.enabled, ICON_MDI_CHECKBOX_MARKED, ICON_MDI_CHECKBOX_BLANK_OUTLINE, iconSize);
 
-          if (ImGui::MenuItem(ICON_MDI_TRASH_CAN " Delete"))deleteObj = &obj;
-        }
-        ImGui::EndPopup();
-      }
+    // children of a toggled object show up (or no longer) as disabled
+    if(clicked) {
+      nodeIsClicked = false;
+      cache.dirty = true;
+    }
 
-      for(auto &child : obj.children) {
-        drawObjectNode(scene, *child, keyDelete, parentEnabled && obj.enabled);
-      }
+    if(!row.parentEnabled)ImGui::EndDisabled();
+    ImGui::SetCursorPosY(oldCursorPos.y);
+  }
+
+  if(ImGui::IsDragDropActive()) {
+    if(DrawDropTarget(dragDropTask.sourceUUID)) {
+      dragDropTask.targetUUID = obj.uuid;
+    }
+  }
 
-      ImGui::TreePop();
+  if (nodeIsClicked) {
+    if (ImGui::GetIO().KeyCtrl) {
+      ctx.toggleObjectSelection(obj.uuid);
+    } else {
+      ctx.selectObject(obj.uuid);
     }
   }
+
+  if(indent > 0)ImGui::Unindent(indent);
+  ImGui::PopID();
 }
 
 void Editor::SceneGraph::draw()
@@ -206,16 +240,78 @@ void Editor::SceneGraph::draw()
   if (!scene)return;
 
   dragDropTask = {};
-  bool isFocus = ImGui::IsWindowFocused();
+  bool isFocus = ImGui::IsWindowFocused(ImGuiFocusedFlags_ChildWindows);
+  bool keyDelete = isFocus && !ImGui::GetIO().WantTextInput
+    && (ImGui::IsKeyPressed(ImGuiKey_Delete) || ImGui::IsKeyPressed(ImGuiKey_Backspace));
+
+  ImGui::SetNextItemWidth(-FLT_MIN);
+  if(ImGui::InputTextWithHint("##search", "Filter...", &searchFilter)) {
+    cache.dirty = true;
+  }
 
+  ImGui::BeginChild("ROWS");
   ImGui::PushStyleVar(ImGuiStyleVar_IndentSpacing, 16.0f);
-  bool keyDelete = isFocus && (ImGui::IsKeyPressed(ImGuiKey_Delete) || ImGui::IsKeyPressed(ImGuiKey_Backspace));
 
-  auto &root = scene->getRootObject();
-  drawObjectNode(*scene, root, keyDelete);
+  updateRows(*scene);
+
+  // rows all have the same height, which the clipper measures from the first one
+  ImGuiListClipper clipper{};
+  clipper.Begin((int)cache.rows.size());
+  while(clipper.Step()) {
+    for(int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+      drawRow(cache.rows[i]);
+    }
+  }
+  clipper.End();
 
   ImGui::PopStyleVar(1);
 
+  // opened outside the rows, which may scroll out of view while it's open
+  if(openPopup) {
+    ImGui::OpenPopup("NodePopup");
+    openPopup = false;
+  }
+
+  if (ImGui::BeginPopup("NodePopup"))
+  {
+    auto &root = scene->getRootObject();
+    auto obj = popupUUID == root.uuid ? &root : scene->getObjectByUUID(popupUUID).get();
+
+    if (!obj) {
+      ImGui::CloseCurrentPopup();
+    } else {
+      if (ImGui::MenuItem(ICON_MDI_CUBE_OUTLINE " Add Object")) {
+        auto added = scene->addObject(*obj);
+        if (added) {
+          ctx.selectObject(added->uuid);
+          collapsed.erase(obj->uuid);
+        }
+        UndoRedo::getHistory().markChanged("Add Object");
+      }
+
+      if (obj->parent) {
+        if (!obj->isPrefabInstance() && ImGui::MenuItem(ICON_MDI_PACKAGE_VARIANT_CLOSED_PLUS " To Prefab")) {
+          scene->createPrefabFromObject(obj->uuid);
+        }
+
+        if (ImGui::MenuItem(ICON_MDI_TRASH_CAN " Delete"))deleteObj = obj;
+      }
+    }
+    ImGui::EndPopup();
+  }
+  ImGui::EndChild();
+
+  if (keyDelete) {
+    // the whole selection at once, as a single edit
+    auto selection = ctx.selObjectUUIDs;
+    for (auto uuid : selection) {
+      auto selObj = scene->getObjectByUUID(uuid);
+      if (!selObj || !selObj->parent)continue;
+      UndoRedo::getHistory().markChanged("Delete Object");
+      scene->removeObject(*selObj);
+    }
+  }
+
   if(dragDropTask.sourceUUID && dragDropTask.targetUUID) {
     //printf("dragDropTarget %08X -> %08X (%d)\n", dragDropTask.sourceUUID, dragDropTask.targetUUID, dragDropTask.isInsert);
     UndoRedo::getHistory().markChanged("Move Object");
@@ -3,12 +3,60 @@
 * @license MIT
 */
 #pragma once
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+namespace Project
+{
+  class Scene;
+  class Object;
+}
 
 namespace Editor
 {
   class SceneGraph
   {
     private:
+      struct Row
+      {
+        Project::Object *obj{};
+        uint32_t depth{0};
+        bool parentEnabled{true};
+        bool isOpen{true};
+      };
+
+      struct NameEntry
+      {
+        std::string name{}; // lower-case
+        Project::Object *obj{};
+      };
+
+      /**
+       * Visible rows of the tree in draw order, so only the ones on screen have to be drawn.
+       * Rebuilt once the scene, the collapsed nodes or the search changes, see 'updateRows'.
+       */
+      struct RowCache
+      {
+        std::vector<Row> rows{};
+        std::vector<NameEntry> names{};
+        Project::Scene *scene{nullptr};
+        uint32_t structureVersion{0};
+        uint64_t changeCount{0};
+        bool dirty{true};
+      };
+      RowCache cache{};
+
+      std::unordered_set<uint32_t> collapsed{};
+      std::unordered_set<uint32_t> searchMatches{}; // matches and all their parents
+      std::string searchFilter{};
+      uint32_t popupUUID{0}; // object the context menu is open for
+      bool openPopup{false};
+
+      void updateRows(Project::Scene &scene);
+      void appendRows(Project::Object &obj, uint32_t depth, bool parentEnabled);
+      void drawRow(const Row &row);
 
     public:
 //      SceneGraph();
@@ -16,4 +64,4 @@ namespace Editor
 
       void draw();
   };
-}
\ No newline at end of file
+}
@@ -7,6 +7,79 @@
 #include "imgui.h"
 #include "misc/cpp/imgui_stdlib.h"
 #include "../../imgui/helper.h"
+#include "../../../build/projectBuilder.h"
+#include <algorithm>
+
+namespace
+{
+  constexpr ImVec4 COLOR_OVER_BUDGET{1.0f, 0.45f, 0.35f, 1.0f};
+
+  struct CostEntry
+  {
+    std::string name{};
+    Build::DrawCost cost{};
+  };
+
+  // only updated on request, counting vertex loads of every mesh is too slow to do per frame
+  std::vector<CostEntry> costEntries{};
+  int costSceneId{-1};
+
+  void estimateCosts(Project::Scene &scene)
+  {
+    auto &root = scene.getRootObject();
+    costEntries.clear();
+    costEntries.push_back({"Whole Scene", Build::estimateDrawCost(*ctx.project, root)});
+
+    float aspect = (float)scene.conf.fbWidth / (float)std::max(scene.conf.fbHeight, 1);
+    for(auto &view : Build::getCameraViews(*ctx.project, root, aspect)) {
+      costEntries.push_back({view.name, Build::estimateDrawCost(*ctx.project, root, &view.frustum)});
+    }
+    costSceneId = scene.getId();
+  }
+
+  bool costColumn(uint32_t value, uint32_t budget)
+  {
+    ImGui::TableNextColumn();
+    bool over = budget != 0 && value > budget;
+    if(over) {
+      ImGui::TextColored(COLOR_OVER_BUDGET, "%u", value);
+    } else {
+      ImGui::Text("%u", value);
+    }
+    return over;
+  }
+
+  void drawCosts()
+  {
+    const auto &conf = ctx.project->conf;
+    if(!ImGui::BeginTable("##DrawCost", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))return;
+    ImGui::TableSetupColumn("View", ImGuiTableColumnFlags_WidthStretch);
+    for(auto name : {"Obj.", "Tris", "Vtx.", "Mat.", "Tex.", "Mtx."}) {
+      ImGui::TableSetupColumn(name, ImGuiTableColumnFlags_WidthFixed, 40.0f);
+    }
+    ImGui::TableHeadersRow();
+
+    uint32_t overCount = 0;
+    for(const auto &entry : costEntries)
+    {
+      const auto &cost = entry.cost;
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%s", entry.name.c_str());
+      costColumn(cost.objects, 0);
+      overCount += costColumn(cost.triangles, conf.budgetTris);
+      overCount += costColumn(cost.vertexLoads, conf.budgetVertLoads);
+      costColumn(cost.materials, 0);
+      overCount += costColumn(cost.textureLoads, conf.budgetTexLoads);
+      overCount += costColumn(cost.matrices, conf.budgetMatrices);
+    }
+    ImGui::EndTable();
+
+    if(overCount) {
+      ImGui::TextColored(COLOR_OVER_BUDGET, "%u value(s) above the budgets of the project", overCount);
+    }
+  }
+}
 
 Editor::SceneInspector::SceneInspector() {
 }
@@ -26,6 +99,12 @@ void Editor::SceneInspector::draw() {
       OPTIONS, 3
     );
 
+    if(scene->conf.renderPipeline.value == 1) {
+      // lower tiers use a smaller bloom buffer, fewer blur steps and only update every second frame
+      constexpr const char* QUALITY[] = {"High", "Medium", "Low"};
+      ImTable::addComboBox("Bloom Quality", scene->conf.bloomQuality.value, QUALITY, 3);
+    }
+
     std::vector<ImTable::ComboEntry> fpsEntries{
       {0, "Unlimited"},
       {1, "30 / 25"},
@@ -34,40 +113,169 @@ void Editor::SceneInspector::draw() {
     };
     ImTable::addVecComboBox("FPS-Limit", fpsEntries, scene->conf.frameLimit.value);
 
+    // fixed rate for scripts/collision, drawing interpolates objects between the last two ticks
+    ImTable::addVecComboBox<ImTable::ComboEntry>("Tick-Rate", {
+        {0, "Per Frame"},
+        {15, "15 Hz"},
+        {20, "20 Hz"},
+        {30, "30 Hz"},
+        {60, "60 Hz"},
+      }, scene->conf.tickRate.value
+    );
+
+    // waits for the VI before the update instead of after, input is read later and only one frame is queued
+    ImTable::addProp("Low Latency", scene->conf.lowLatency);
+
+    // with 'make P64_ALLOC_TRACK=1', any heap allocation once the scene runs asserts with the call stack
+    ImTable::addProp("Assert No Alloc", scene->conf.noAlloc);
+
+    // upper limit, memory is only allocated when needed (0 = default)
+    ImTable::addProp("Max. Matrices", scene->conf.matrixCapacity);
+    // estimated peak RDRAM is checked against it in the ROM report
+    ImTable::addProp("RDRAM Budget KB (0=def.)", scene->conf.memBudgetKB);
+    scene->conf.memBudgetKB.value = std::max(scene->conf.memBudgetKB.value, 0);
+
+    ImTable::end();
+  }
+
+  if (ImGui::CollapsingHeader("Audio", ImGuiTreeNodeFlags_DefaultOpen)) {
+    ImTable::start("Audio");
+
+    // lower rates and fewer channels reduce the RSP time spent on mixing
+    ImTable::addVecComboBox<ImTable::ComboEntry>("Sample-Rate", {
+        {0, "Default (32000 Hz)"},
+        {16000, "16000 Hz"},
+        {22050, "22050 Hz"},
+        {32000, "32000 Hz"},
+        {44100, "44100 Hz"},
+      }, scene->conf.audioSampleRate.value
+    );
+    ImTable::addProp("Buffers (0=def.)", scene->conf.audioBufferCount);
+    // incl. 4 channels reserved for music
+    ImTable::addProp("Channels (0=def.)", scene->conf.audioChannelCount);
+    scene->conf.audioBufferCount.value = std::clamp(scene->conf.audioBufferCount.value, 0, 8);
+    scene->conf.audioChannelCount.value = std::clamp(scene->conf.audioChannelCount.value, 0, 32);
+
+    ImTable::end();
+  }
+
+  // used on 4MB consoles instead of the settings above, optionally also as a fallback when too slow
+  if (ImGui::CollapsingHeader("Low Quality Tier")) {
+    ImTable::start("LowTier");
+
+    ImTable::addProp("Enabled", scene->conf.lowTier);
+    if(!scene->conf.lowTier.value)ImGui::BeginDisabled();
+
+    ImTable::addProp("Use When Slow", scene->conf.lowTierAuto);
+    ImTable::addProp("Width (0=keep)", scene->conf.lowTierWidth);
+    ImTable::addProp("Height (0=keep)", scene->conf.lowTierHeight);
+    constexpr const char* QUALITY[] = {"High", "Medium", "Low"};
+    ImTable::addComboBox("Bloom Quality", scene->conf.lowTierBloomQuality.value, QUALITY, 3);
+    ImTable::addProp("Audio Ch. (0=keep)", scene->conf.lowTierAudioChannels);
+    ImTable::addProp("LOD Dist. Scale", scene->conf.lowTierLodScale);
+    ImTable::addProp("Particle Scale", scene->conf.lowTierParticleScale);
+
+    scene->conf.lowTierWidth.value = std::clamp(scene->conf.lowTierWidth.value, 0, 512);
+    scene->conf.lowTierHeight.value = std::clamp(scene->conf.lowTierHeight.value, 0, 480);
+    scene->conf.lowTierAudioChannels.value = std::clamp(scene->conf.lowTierAudioChannels.value, 0, 32);
+    scene->conf.lowTierLodScale.value = std::clamp(scene->conf.lowTierLodScale.value, 0.0625f, 4.0f);
+    scene->conf.lowTierParticleScale.value = std::clamp(scene->conf.lowTierParticleScale.value, 0.0625f, 1.0f);
+
+    if(!scene->conf.lowTier.value)ImGui::EndDisabled();
+    ImTable::end();
+  }
+
+  // static per-frame estimate of the placed models, budgets are set in the project settings
+  if (ImGui::CollapsingHeader("Draw Cost")) {
+    bool hasCosts = costSceneId == scene->getId();
+    if(ImGui::Button(hasCosts ? "Update" : "Estimate")) {
+      estimateCosts(*scene);
+    }
+    if(hasCosts)drawCosts();
+  }
+
+  if (ImGui::CollapsingHeader("Streaming")) {
+    ImTable::start("Streaming");
+
+    // top-level objects marked as 'Streamed' are grouped into cells of this size (XZ-plane),
+    // each loaded/unloaded with its assets depending on the distance to the camera
+    ImTable::addProp("Chunk Size (0=off)", scene->conf.chunkSize);
+    ImTable::addProp("Load Distance", scene->conf.chunkLoadDist);
+    scene->conf.chunkSize.value = std::max(scene->conf.chunkSize.value, 0);
+    scene->conf.chunkLoadDist.value = std::max(scene->conf.chunkLoadDist.value, 0);
+
     ImTable::end();
   }
 
   bool fbDisabled = false;
+  bool fbFormatDisabled = false;
   if(scene->conf.renderPipeline.value != 0)
   {
     // HDR/Bloom and bigtex both need those specific settings to work:
-    scene->conf.fbWidth = 320;
-    scene->conf.fbHeight = 240;
-    scene->conf.fbFormat = 0;
     scene->conf.doClearColor.value = false;
     fbDisabled = true;
   }
+  if(scene->conf.renderPipeline.value == 2)
+  {
+    // bigtex only outputs RGBA16 with its fixed three buffers.
+    // the size is free, as long as two buffers fit into 1MB (e.g. 256x224 or 424x240)
+    scene->conf.fbFormat = 0;
+    scene->conf.fbCount.value = 3;
+    scene->conf.fbWidth = std::clamp(scene->conf.fbWidth, 8, 512);
+    scene->conf.fbHeight = std::clamp(scene->conf.fbHeight, 8, (1024 * 1024 / 2) / 2 / scene->conf.fbWidth);
+    fbFormatDisabled = true;
+  }
 
   if (ImGui::CollapsingHeader("Framebuffer", ImGuiTreeNodeFlags_DefaultOpen)) {
     ImTable::start("Framebuffer");
 
-    if(fbDisabled)ImGui::BeginDisabled();
     ImTable::add("Width", scene->conf.fbWidth);
     ImTable::add("Height", scene->conf.fbHeight);
 
+    if(fbFormatDisabled)ImGui::BeginDisabled();
+
     constexpr const char* const FORMATS[] = {"RGBA16","RGBA32"};
     ImTable::addComboBox("Format", scene->conf.fbFormat, FORMATS, 2);
 
-    if(fbDisabled)ImGui::EndDisabled();
+    // double-buffering saves a buffer, but stalls the CPU until the VI is done with the other one
+    ImTable::addVecComboBox<ImTable::ComboEntry>("Buffers", {
+        {3, "Triple"},
+        {2, "Double"},
+      }, scene->conf.fbCount.value
+    );
+
+    if(fbFormatDisabled)ImGui::EndDisabled();
       ImTable::addColor("Color", scene->conf.clearColor.value, false);
       scene->conf.clearColor.value.a = 1.0f;
     if(fbDisabled)ImGui::BeginDisabled();
 
     ImTable::addProp("Clear Color", scene->conf.doClearColor);
+    // with a sky or level geometry covering all pixels, the clear only has to happen once per buffer
+    if(scene->conf.doClearColor.value) {
+      ImTable::addProp("Backdrop Covers", scene->conf.backdrop);
+    }
 
     if(fbDisabled)ImGui::EndDisabled();
 
-    ImTable::addProp("Clear Depth", scene->conf.doClearDepth);
+    // painter's algorithm: objects are drawn back-to-front by their origin, for top-down or side-view scenes.
+    // saves the depth-buffer and its RDP bandwidth, bigtex always needs one
+    if(scene->conf.renderPipeline.value == 2)ImGui::BeginDisabled();
+    ImTable::addProp("No Depth-Buffer", scene->conf.noDepth);
+    if(scene->conf.renderPipeline.value == 2)ImGui::EndDisabled();
+
+    bool hasDepth = !scene->conf.noDepth.value || scene->conf.renderPipeline.value == 2;
+    if(hasDepth) {
+      ImTable::addProp("Clear Depth", scene->conf.doClearDepth);
+      // alternates between two halves of the depth range, so only every second frame needs a clear
+      if(scene->conf.doClearDepth.value) {
+        ImTable::addProp("Alternate Depth", scene->conf.depthSlices);
+      }
+    }
+
+    // lowers the width when frames take too long, only the default pipeline draws to a variable size
+    if(scene->conf.renderPipeline.value != 0)ImGui::BeginDisabled();
+    ImTable::addProp("Dynamic Res.", scene->conf.dynamicRes);
+    if(scene->conf.renderPipeline.value != 0)ImGui::EndDisabled();
 
     constexpr std::array<const char*, 5> FILTERS = {
       "None",
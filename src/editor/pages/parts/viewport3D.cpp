@@ -4,6 +4,8 @@
 */
 #include "viewport3D.h"
 
+#include <algorithm>
+
 #include "imgui.h"
 #include "ImGuizmo.h"
 #include "ImViewGuizmo.h"
@@ -29,6 +31,10 @@ namespace
   };
   constinit bool isTransWorld = true;
 
+  // tags of object ID reads
+  constexpr uint32_t READ_PICK = 0;
+  constexpr uint32_t READ_HOVER = 1;
+
   // A toggleable "connected" button (like in toolbars)
 bool ConnectedToggleButton(const char* text, bool active, bool first, bool last, ImVec2 size = ImVec2(20, 20))
 {
@@ -105,10 +111,35 @@ bool ConnectedToggleButton(const char* text, bool active, bool first, bool last,
   std::shared_ptr<Renderer::Texture> sprites{};
   uint32_t spritesRefCount{0};
 
-  void iterateObjects(
-    Project::Object& parent,
-    std::function<void(Project::Object&, Project::Component::Entry*)> callback
-  )
+  // @TODO: use flag in component
+  bool isCompHidden(int compId, bool showCollMesh, bool showCollObj) {
+    return (!showCollMesh && compId == 4) || (!showCollObj && compId == 5);
+  }
+}
+
+void Editor::Viewport3D::updateDrawList(Project::Scene &scene)
+{
+  auto changeCount = UndoRedo::getHistory().getChangeCount();
+  bool isValid = drawList.scene == &scene && drawList.structureVersion == scene.structureVersion
+    && drawList.changeCount == changeCount
+    && drawList.showCollMesh == showCollMesh && drawList.showCollObj == showCollObj;
+
+  // prefabs are replaced when their file changes, only one lookup per distinct prefab
+  for(auto it = drawList.prefabs.begin(); isValid && it != drawList.prefabs.end(); ++it) {
+    isValid = ctx.project->getAssets().getPrefabByUUID(it->first) == it->second;
+  }
+  if(isValid)return;
+
+  drawList.comps.clear();
+  drawList.spriteObjs.clear();
+  drawList.prefabs.clear();
+  drawList.scene = &scene;
+  drawList.structureVersion = scene.structureVersion;
+  drawList.changeCount = changeCount;
+  drawList.showCollMesh = showCollMesh;
+  drawList.showCollObj = showCollObj;
+
+  auto addObjects = [&](Project::Object &parent, auto &addObjectsRef) -> void
   {
     for(auto& child : parent.children)
     {
@@ -117,17 +148,30 @@ bool ConnectedToggleButton(const char* text, bool active, bool first, bool last,
       auto srcObj = child.get();
       if(child->isPrefabInstance()) {
         auto prefab = ctx.project->getAssets().getPrefabByUUID(child->uuidPrefab.value);
-        if(prefab)srcObj = &prefab->obj;
+        if(prefab) {
+          srcObj = &prefab->obj;
+          drawList.prefabs.try_emplace(child->uuidPrefab.value, prefab);
+        }
       }
 
+      bool hasDraw = false;
       for(auto &comp : srcObj->components) {
-        callback(*child, &comp);
+        drawList.comps.push_back({child.get(), &comp});
+        if(Project::Component::TABLE[comp.id].funcDraw3D && !isCompHidden(comp.id, showCollMesh, showCollObj)) {
+          hasDraw = true;
+        }
       }
-      callback(*child, nullptr);
+      if(!hasDraw)drawList.spriteObjs.push_back(child.get());
 
-      iterateObjects(*child, callback);
+      addObjectsRef(*child, addObjectsRef);
     }
-  }
+  };
+  addObjects(scene.getRootObject(), addObjects);
+
+  // same types next to each other, most draw with the same pipeline and state
+  std::stable_sort(drawList.comps.begin(), drawList.comps.end(), [](const DrawEntry &a, const DrawEntry &b) {
+    return a.comp->id < b.comp->id;
+  });
 }
 
 Editor::Viewport3D::Viewport3D()
@@ -197,43 +241,28 @@ void Editor::Viewport3D::onRenderPass(SDL_GPUCommandBuffer* cmdBuff, Renderer::S
 
   camera.apply(uniGlobal);
   uniGlobal.screenSize = glm::vec2{(float)fb.getWidth(), (float)fb.getHeight()};
+  frustum.fromMatrix(uniGlobal.projMat * uniGlobal.cameraMat);
   SDL_PushGPUVertexUniformData(cmdBuff, 0, &uniGlobal, sizeof(uniGlobal));
-  auto &rootObj = scene->getRootObject();
+  // the UI may have changed the scene since 'draw()'
+  updateDrawList(*scene);
 
-  bool hadDraw = false;
-  iterateObjects(rootObj, [&](Project::Object &obj, Project::Component::Entry *comp) {
-    if(!comp)
-    {
-      if(!hadDraw) {
-        Utils::Mesh::addSprite(*getSprites(), obj.pos.resolve(obj.propOverrides), obj.uuid, 2);
-      }
-      hadDraw = false;
-      return;
-    }
-    auto &def = Project::Component::TABLE[comp->id];
-
-    // @TODO: use flag in component
-    if(!showCollMesh && comp->id == 4)return;
-    if(!showCollObj && comp->id == 5)return;
+  for(auto obj : drawList.spriteObjs) {
+    Utils::Mesh::addSprite(*getSprites(), obj->pos.resolve(obj->propOverrides), obj->uuid, 2);
+  }
 
-    if(def.funcDraw3D) {
-      def.funcDraw3D(obj, *comp, *this, cmdBuff, renderPass3D);
-      hadDraw = true;
+  for(auto &entry : drawList.comps) {
+    auto &def = Project::Component::TABLE[entry.comp->id];
+    if(def.funcDraw3D && !isCompHidden(entry.comp->id, showCollMesh, showCollObj)) {
+      def.funcDraw3D(*entry.obj, *entry.comp, *this, cmdBuff, renderPass3D);
     }
-  });
-
-  iterateObjects(rootObj, [&](Project::Object &obj, Project::Component::Entry *comp) {
-    if(!comp)return;
-    auto &def = Project::Component::TABLE[comp->id];
-
-    // @TODO: use flag in component
-    if(!showCollMesh && comp->id == 4)return;
-    if(!showCollObj && comp->id == 5)return;
+  }
 
-    if(def.funcDrawPost3D) {
-      def.funcDrawPost3D(obj, *comp, *this, cmdBuff, renderPass3D);
+  for(auto &entry : drawList.comps) {
+    auto &def = Project::Component::TABLE[entry.comp->id];
+    if(def.funcDrawPost3D && !isCompHidden(entry.comp->id, showCollMesh, showCollObj)) {
+      def.funcDrawPost3D(*entry.obj, *entry.comp, *this, cmdBuff, renderPass3D);
     }
-  });
+  }
 
   meshLines->recreate(renderScene);
   meshSprites->recreate(renderScene);
@@ -252,13 +281,26 @@ void Editor::Viewport3D::onRenderPass(SDL_GPUCommandBuffer* cmdBuff, Renderer::S
   SDL_EndGPURenderPass(renderPass3D);
 }
 
+bool Editor::Viewport3D::isVisible(const Utils::AABB &aabb, const glm::mat4 &modelMat) const
+{
+  glm::mat4 mat = modelMat;
+  mat[0] *= 65536.0f;
+  mat[1] *= 65536.0f;
+  mat[2] *= 65536.0f;
+  return frustum.isVisible(aabb, mat);
+}
+
 void Editor::Viewport3D::onCopyPass(SDL_GPUCommandBuffer* cmdBuff, SDL_GPUCopyPass *copyPass) {
   //vertBuff->upload(*copyPass);
 }
 
 void Editor::Viewport3D::onPostRender(Renderer::Scene &renderScene) {
-  if (pickedObjID.isRequested()) {
-    pickedObjID.setResult(fb.readObjectID(mousePosClick.x, mousePosClick.y));
+  if (pickedObjID.isRequested() && !pickInFlight) {
+    pickInFlight = fb.requestObjectID(mousePosClick.x, mousePosClick.y, READ_PICK);
+  }
+  // only one hover read at a time, the next one starts once it is back
+  if (hoverRequested && !hoverInFlight) {
+    hoverInFlight = fb.requestObjectID(mousePosHover.x, mousePosHover.y, READ_HOVER);
   }
 }
 
@@ -270,16 +312,32 @@ void Editor::Viewport3D::draw()
   if (!scene)return;
 
   ctx.scene->clearLights();
-  auto &rootObj = scene->getRootObject();
+  updateDrawList(*scene);
 
-  iterateObjects(rootObj, [&](Project::Object &obj, Project::Component::Entry *comp) {
-    if(!comp)return;
-    auto &def = Project::Component::TABLE[comp->id];
-    if(def.funcUpdate)def.funcUpdate(obj, *comp);
-  });
+  for(auto &entry : drawList.comps) {
+    auto &def = Project::Component::TABLE[entry.comp->id];
+    if(def.funcUpdate)def.funcUpdate(*entry.obj, *entry.comp);
+  }
 
   fb.setClearColor(scene->conf.clearColor.value);
 
+  uint32_t readObjID, readTag;
+  while(fb.pollObjectID(readObjID, readTag))
+  {
+    if(readTag == READ_PICK) {
+      pickedObjID.setResult(readObjID);
+      pickInFlight = false;
+    } else {
+      hoveredObjUUID = hoverRequested ? readObjID : 0;
+      hoverInFlight = false;
+    }
+  }
+
+  // results of reads, and the camera coming to a stop
+  if(pickInFlight || hoverInFlight || glm::length(camera.velocity) > 0.01f) {
+    ctx.requestRedraw();
+  }
+
   if(pickedObjID.hasResult())
   {
     uint32_t newUUID = pickedObjID.consume();
@@ -288,7 +346,11 @@ void Editor::Viewport3D::draw()
       newUUID = ctx.selObjectUUID;
     }
 
-    ctx.selObjectUUID = newUUID;
+    if(!pickToggle) {
+      ctx.selectObject(newUUID);
+    } else if(newUUID) {
+      ctx.toggleObjectSelection(newUUID);
+    }
   }
   auto obj = scene->getObjectByUUID(ctx.selObjectUUID);
 
@@ -326,9 +388,14 @@ void Editor::Viewport3D::draw()
 
   if (!overGizmo && isMouseHover && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
     pickedObjID.request();
+    pickToggle = ImGui::GetIO().KeyCtrl;
     mousePosClick = mousePos;
   }
 
+  hoverRequested = isMouseHover && !newMouseDown && !gizmoTransformActive;
+  mousePosHover = mousePos;
+  if(!hoverRequested)hoveredObjUUID = 0;
+
   if(isMouseHover)
   {
     ImGui::SetMouseCursor(
@@ -346,8 +413,12 @@ void Editor::Viewport3D::draw()
     // Handle object deletion when Delete is pressed while the viewport is focused and an object is selected
     if (ImGui::IsWindowFocused() && obj && ImGui::IsKeyPressed(ImGuiKey_Delete)) {
       UndoRedo::getHistory().markChanged("Delete Object");
-      scene->removeObject(*obj);
-      ctx.selObjectUUID = 0;
+      auto selection = ctx.selObjectUUIDs;
+      for (auto uuid : selection) {
+        auto selObj = scene->getObjectByUUID(uuid);
+        if (selObj && selObj->parent)scene->removeObject(*selObj);
+      }
+      ctx.selectObject(0);
       obj = nullptr;
     }
 
@@ -466,7 +537,7 @@ void Editor::Viewport3D::draw()
         UndoRedo::getHistory().markChanged("Add Prefab");
         auto added = scene->addPrefabInstance(prefabUUID);
         if (added) {
-          ctx.selObjectUUID = added->uuid;
+          ctx.selectObject(added->uuid);
         }
       }
     }
@@ -522,14 +593,14 @@ void Editor::Viewport3D::draw()
       if(!obj->uuidPrefab.value || isOverride)
       {
         std::unordered_map<uint64_t, glm::vec3> relPosMap{};
+        auto oldGizmoMat = glm::recompose(
+          obj->scale.resolve(obj->propOverrides),
+          obj->rot.resolve(obj->propOverrides),
+          obj->pos.resolve(obj->propOverrides),
+          skew, persp);
+
         if(!isOnlySelf)
         {
-          auto oldGizmoMat = glm::recompose(
-            obj->scale.resolve(obj->propOverrides),
-            obj->rot.resolve(obj->propOverrides),
-            obj->pos.resolve(obj->propOverrides),
-            skew, persp);
-
           for(auto& child : obj->children)
           {
             relPosMap[child->uuid] = glm::inverse(oldGizmoMat) * glm::vec4(
@@ -555,6 +626,28 @@ void Editor::Viewport3D::draw()
             child->pos.resolve(child->propOverrides) = gizmoMat * glm::vec4(it->second, 1.0f);
           }
         }
+
+        // the rest of the selection follows as a group, only diffed once the drag ends (see 'UndoRedo::History::end')
+        auto delta = gizmoMat * glm::inverse(oldGizmoMat);
+        for(auto uuid : ctx.selObjectUUIDs)
+        {
+          auto other = scene->getObjectByUUID(uuid);
+          if(!other || other == obj)continue;
+          if(!isOnlySelf && other->parent == obj.get())continue;
+
+          auto otherMat = delta * glm::recompose(
+            other->scale.resolve(other->propOverrides),
+            other->rot.resolve(other->propOverrides),
+            other->pos.resolve(other->propOverrides),
+            skew, persp);
+          glm::decompose(
+            otherMat,
+            other->scale.resolve(other->propOverrides),
+            other->rot.resolve(other->propOverrides),
+            other->pos.resolve(other->propOverrides),
+            skew, persp
+          );
+        }
       }
     }
   }
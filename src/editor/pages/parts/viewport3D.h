@@ -4,6 +4,8 @@
 */
 #pragma once
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "../../../renderer/camera.h"
 #include "../../../renderer/vertBuffer.h"
@@ -11,6 +13,15 @@
 #include "../../../renderer/mesh.h"
 #include "../../../renderer/object.h"
 #include "../../../utils/container.h"
+#include "../../../utils/frustum.h"
+
+namespace Project
+{
+  class Object;
+  class Prefab;
+  class Scene;
+  namespace Component { struct Entry; }
+}
 
 namespace Editor
 {
@@ -20,16 +31,25 @@ namespace Editor
       Renderer::UniformGlobal uniGlobal{};
       Renderer::Framebuffer fb{};
       Renderer::Camera camera{};
+      Utils::Frustum frustum{};
       uint32_t passId{};
 
       bool isMouseHover{false};
       bool isMouseDown{false};
       Utils::RequestVal<uint32_t> pickedObjID{};
+      bool pickToggle{false}; // ctrl-click, adds to the selection instead of replacing it
+      bool pickInFlight{false};
+
+      // object under the mouse, read back the same way as clicks but never waited on
+      uint32_t hoveredObjUUID{0};
+      bool hoverRequested{false};
+      bool hoverInFlight{false};
 
       float vpOffsetY{};
       glm::vec2 mousePos{};
       glm::vec2 mousePosStart{};
       glm::vec2 mousePosClick{};
+      glm::vec2 mousePosHover{};
 
       std::shared_ptr<Renderer::Mesh> meshGrid{};
       Renderer::Object objGrid{};
@@ -47,6 +67,31 @@ namespace Editor
       int gizmoOp{0};
       bool gizmoTransformActive{false};
 
+      struct DrawEntry
+      {
+        Project::Object *obj{};
+        Project::Component::Entry *comp{}; // of the object, or its prefab
+      };
+
+      /**
+       * Flattened scene graph, so drawing doesn't have to walk the tree and resolve prefabs each frame.
+       * Rebuilt once the scene changes, see 'updateDrawList'.
+       */
+      struct DrawList
+      {
+        std::vector<DrawEntry> comps{}; // of enabled objects, sorted by component type
+        std::vector<Project::Object*> spriteObjs{}; // nothing drawn for them, shown as an icon instead
+        std::unordered_map<uint64_t, std::shared_ptr<Project::Prefab>> prefabs{}; // resolved ones, kept alive
+        Project::Scene *scene{nullptr};
+        uint32_t structureVersion{0};
+        uint64_t changeCount{0};
+        bool showCollMesh{true};
+        bool showCollObj{true};
+      };
+      DrawList drawList{};
+
+      void updateDrawList(Project::Scene &scene);
+
       void onRenderPass(SDL_GPUCommandBuffer* cmdBuff, Renderer::Scene& renderScene);
       void onCopyPass(SDL_GPUCommandBuffer* cmdBuff, SDL_GPUCopyPass *copyPass);
       void onPostRender(Renderer::Scene& renderScene);
@@ -63,6 +108,14 @@ namespace Editor
         return meshSprites;
       }
 
+      [[nodiscard]] uint32_t getHoveredObjectUUID() const { return hoveredObjUUID; }
+
+      /**
+       * Checks if a mesh would be on screen, only valid while drawing.
+       * @param aabb as returned by 'N64Mesh::getAABB' (1/65536 of the vertex positions)
+       */
+      [[nodiscard]] bool isVisible(const Utils::AABB &aabb, const glm::mat4 &modelMat) const;
+
       void draw();
   };
 }
@@ -0,0 +1,156 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "thumbnailCache.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "SDL3_image/SDL_image.h"
+#include "../context.h"
+#include "../renderer/scene.h"
+#include "../project/assetManager.h"
+#include "../utils/fs.h"
+#include "../utils/hash.h"
+#include "../utils/string.h"
+
+namespace
+{
+  constexpr int THUMB_SIZE = 64;
+  constexpr uint64_t FRAMES_UNUSED_MAX = 600; // ~10s, the GPU texture is freed after that
+  constexpr uint64_t FRAMES_CHECK_FILE = 60; // how often the source is checked for changes
+
+  // bump if the way thumbnails are made changes, invalidates all of them
+  constexpr const char* THUMB_VERSION = "p64-thumb-2";
+
+  SDL_Surface* createThumbnail(const std::string &path, const fs::path &thumbDir)
+  {
+    Utils::Hash::XXH64 hash{};
+    hash.update(THUMB_VERSION);
+    if(!hash.updateFile(path))return nullptr;
+
+    auto thumbPath = thumbDir / (Utils::toHex64(hash.digest()) + ".png");
+    if(fs::exists(thumbPath)) {
+      if(auto img = Renderer::Texture::decode(thumbPath.string()))return img;
+    }
+
+    auto img = Renderer::Texture::decode(path);
+    if(!img)return nullptr;
+
+    // halving each step, a single linear scale skips most pixels of large images
+    while(std::max(img->w, img->h) > THUMB_SIZE)
+    {
+      float scale = std::max(0.5f, (float)THUMB_SIZE / (float)std::max(img->w, img->h));
+      int w = std::max(1, (int)std::round(img->w * scale));
+      int h = std::max(1, (int)std::round(img->h * scale));
+      auto scaled = SDL_ScaleSurface(img, w, h, SDL_SCALEMODE_LINEAR);
+      SDL_DestroySurface(img);
+      if(!scaled)return nullptr;
+      img = scaled;
+    }
+
+    std::error_code err{};
+    fs::create_directories(thumbDir, err);
+    IMG_SavePNG(img, thumbPath.string().c_str());
+    return img;
+  }
+}
+
+Editor::ThumbnailCache::~ThumbnailCache()
+{
+  if(worker.joinable()) {
+    {
+      std::lock_guard lock{mtx};
+      stopWorker = true;
+    }
+    cond.notify_all();
+    worker.join();
+  }
+  for(auto &res : results) {
+    if(res.img)SDL_DestroySurface(res.img);
+  }
+}
+
+void Editor::ThumbnailCache::runWorker()
+{
+  std::unique_lock lock{mtx};
+  for(;;)
+  {
+    cond.wait(lock, [this]{ return stopWorker || !requests.empty(); });
+    if(stopWorker)return;
+
+    // newest first, those are most likely still visible
+    auto req = std::move(requests.back());
+    requests.pop_back();
+
+    lock.unlock();
+    auto img = createThumbnail(req.path, req.thumbDir);
+    lock.lock();
+
+    results.push_back({req.path, req.fileAge, img});
+  }
+}
+
+Renderer::Texture* Editor::ThumbnailCache::get(const Project::AssetManagerEntry &asset)
+{
+  auto [it, isNew] = thumbs.try_emplace(asset.path);
+  auto &thumb = it->second;
+  thumb.lastUsedFrame = frame;
+  if(thumb.pending)return thumb.texture.get();
+  if(!isNew && (frame - thumb.lastCheckFrame) < FRAMES_CHECK_FILE)return thumb.texture.get();
+
+  thumb.lastCheckFrame = frame;
+  auto fileAge = Utils::FS::getFileAge(asset.path);
+  if(!isNew && thumb.fileAge == fileAge)return thumb.texture.get();
+
+  thumb.fileAge = fileAge;
+  thumb.pending = true;
+  {
+    std::lock_guard lock{mtx};
+    requests.push_back({asset.path, fileAge, fs::path{ctx.project->getPath()} / "build" / "thumbs"});
+  }
+  if(!worker.joinable())worker = std::thread{&ThumbnailCache::runWorker, this};
+  cond.notify_one();
+
+  // the old one stays visible until the new one is done
+  return thumb.texture.get();
+}
+
+void Editor::ThumbnailCache::update()
+{
+  ++frame;
+
+  std::vector<Result> done{};
+  {
+    std::lock_guard lock{mtx};
+    done.swap(results);
+  }
+
+  for(auto &res : done)
+  {
+    auto it = thumbs.find(res.path);
+    if(it != thumbs.end() && it->second.fileAge == res.fileAge)
+    {
+      auto &thumb = it->second;
+      thumb.pending = false;
+      thumb.texture.reset();
+      if(res.img && ctx.scene) {
+        auto texture = std::make_shared<Renderer::Texture>(ctx.gpu, res.img);
+        ctx.scene->addOneTimeCopyPass([texture](SDL_GPUCommandBuffer*, SDL_GPUCopyPass *copyPass) {
+          texture->upload(*copyPass);
+        });
+        thumb.texture = texture;
+      }
+    }
+    if(res.img)SDL_DestroySurface(res.img);
+  }
+
+  // textures of thumbnails scrolled out of view are freed, they load quickly from disk again
+  bool anyPending = false;
+  std::erase_if(thumbs, [this, &anyPending](const auto &pair) {
+    anyPending |= pair.second.pending;
+    return !pair.second.pending && (frame - pair.second.lastUsedFrame) > FRAMES_UNUSED_MAX;
+  });
+  if(anyPending)ctx.requestRedraw();
+}
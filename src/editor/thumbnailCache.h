@@ -0,0 +1,81 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../renderer/texture.h"
+
+namespace fs = std::filesystem;
+namespace Project { struct AssetManagerEntry; }
+
+namespace Editor
+{
+  /**
+   * Small previews of images for the asset browser, so it doesn't need their full textures.
+   * Generated on a background thread and kept as PNGs in '<project>/build/thumbs', named after a hash of the source.
+   * GPU textures only exist for thumbnails that were drawn recently.
+   */
+  class ThumbnailCache
+  {
+    private:
+      struct Request
+      {
+        std::string path{};
+        uint64_t fileAge{0};
+        fs::path thumbDir{};
+      };
+
+      struct Result
+      {
+        std::string path{};
+        uint64_t fileAge{0};
+        SDL_Surface *img{nullptr};
+      };
+
+      struct Thumb
+      {
+        std::shared_ptr<Renderer::Texture> texture{};
+        uint64_t fileAge{0}; // of the source when last requested
+        uint64_t lastUsedFrame{0};
+        uint64_t lastCheckFrame{0};
+        bool pending{false};
+      };
+
+      std::unordered_map<std::string, Thumb> thumbs{};
+      uint64_t frame{0};
+
+      std::thread worker{};
+      std::mutex mtx{};
+      std::condition_variable cond{};
+      std::vector<Request> requests{}; // guarded by 'mtx', like everything below
+      std::vector<Result> results{};
+      bool stopWorker{false};
+
+      void runWorker();
+
+    public:
+      ThumbnailCache() = default;
+      ~ThumbnailCache();
+
+      /**
+       * Returns the thumbnail of an image, only call it for visible ones.
+       * @return nullptr until it is ready, generating it in the background
+       */
+      Renderer::Texture* get(const Project::AssetManagerEntry &asset);
+
+      /**
+       * Uploads finished thumbnails and frees the ones not drawn for a while, call once per frame.
+       */
+      void update();
+  };
+}
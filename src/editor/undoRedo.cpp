@@ -4,52 +4,175 @@
 */
 #include "undoRedo.h"
 #include "../context.h"
+#include "../utils/json.h"
 #include "imgui.h"
 
 namespace
 {
   Editor::UndoRedo::History globalHistory;
+
+  // full snapshot at least every N edits, limits how many deltas an undo across a keyframe has to replay
+  constexpr uint32_t KEYFRAME_INTERVAL = 50;
+
+  std::string serializeObject(const Project::Object &obj) {
+    return Utils::JSON::toBinary(obj.serialize(false));
+  }
+
+  void applyObject(Project::Scene &scene, uint32_t uuid, const std::string &data) {
+    auto obj = scene.getObjectByUUID(uuid);
+    if(!obj)return;
+    auto doc = Utils::JSON::fromBinary(data);
+    obj->deserializeProps(doc);
+  }
+
+  void applyPrefab(uint64_t prefabUUID, const std::string &data) {
+    auto prefab = ctx.project->getAssets().getPrefabByUUID(prefabUUID);
+    if(!prefab)return;
+    auto doc = Utils::JSON::fromBinary(data);
+    prefab->obj.deserializeProps(doc);
+  }
+
+  // prefab edited through the selected instance, its changes don't show up in any scene object
+  std::shared_ptr<Project::Prefab> getEditedPrefab(Project::Scene &scene) {
+    auto obj = scene.getObjectByUUID(ctx.selObjectUUID);
+    if(!obj || !obj->isPrefabInstance() || !obj->isPrefabEdit)return nullptr;
+    return ctx.project->getAssets().getPrefabByUUID(obj->uuidPrefab.value);
+  }
+
+  void applyConf(Project::Scene &scene, const std::string &data) {
+    if(data.empty())return;
+    auto doc = Utils::JSON::fromBinary(data);
+    if(doc.is_object())scene.deserializeConf(doc);
+  }
+
+  // edits on top of the last keyframe
+  uint32_t countDeltas(const std::vector<std::unique_ptr<Editor::UndoRedo::Entry>> &stack) {
+    uint32_t res = 0;
+    for (auto it = stack.rbegin(); it != stack.rend() && !(*it)->isKeyframe(); ++it)++res;
+    return res;
+  }
+
+  // primary selection first, see 'getSelection'
+  void applySelection(Project::Scene &scene, const std::vector<uint32_t> &selection) {
+    ctx.selectObject(0);
+    for (auto it = selection.rbegin(); it != selection.rend(); ++it) {
+      if (scene.getObjectByUUID(*it) && !ctx.isObjectSelected(*it)) {
+        ctx.toggleObjectSelection(*it);
+      }
+    }
+  }
+
+  std::vector<uint32_t> getSelection() {
+    std::vector<uint32_t> res{};
+    if (ctx.selObjectUUID)res.push_back(ctx.selObjectUUID);
+    for (auto uuid : ctx.selObjectUUIDs) {
+      if (uuid != ctx.selObjectUUID)res.push_back(uuid);
+    }
+    return res;
+  }
 }
 
 namespace Editor::UndoRedo
 {
+  void History::rebuildKnownState(Project::Scene &scene)
+  {
+    knownObjects.clear();
+    for(auto &[uuid, obj] : scene.objectsMap) {
+      knownObjects[uuid] = serializeObject(*obj);
+    }
+    knownConf = Utils::JSON::toBinary(scene.conf.serialize());
+    knownStructure = scene.structureVersion;
+  }
+
+  void History::applyChange(Project::Scene &scene, const ObjectChange &change, bool isUndo)
+  {
+    auto &data = isUndo ? change.before : change.after;
+    if(change.prefabUUID) {
+      applyPrefab(change.prefabUUID, data);
+      knownPrefabs[change.prefabUUID] = data;
+    } else {
+      applyObject(scene, change.uuid, data);
+      knownObjects[change.uuid] = data;
+    }
+  }
+
+  void History::restoreTopState(Project::Scene &scene)
+  {
+    // the bottom entry is always a keyframe (see 'trim')
+    size_t idx = undoStack.size() - 1;
+    while(idx > 0 && !undoStack[idx]->isKeyframe())--idx;
+
+    scene.deserializeBinary(undoStack[idx]->state);
+    for(++idx; idx < undoStack.size(); ++idx) {
+      auto &entry = *undoStack[idx];
+      for(auto &change : entry.changes)applyChange(scene, change, false);
+      applyConf(scene, entry.confAfter);
+    }
+    rebuildKnownState(scene);
+  }
+
+  void History::trim()
+  {
+    if (undoStack.size() <= maxHistorySize)return;
+
+    // can only cut right before a keyframe, the deltas after it would be lost otherwise
+    size_t cut = undoStack.size() - maxHistorySize;
+    while(cut > 0 && !undoStack[cut]->isKeyframe())--cut;
+    if(cut > 0)undoStack.erase(undoStack.begin(), undoStack.begin() + cut);
+  }
+
   bool History::undo()
   {
-    if (!canUndo()) return false;
+    if (!canUndo() || !snapshotScene) return false;
+    ++changeCount;
 
     auto cmd = std::move(undoStack.back());
     undoStack.pop_back();
     const auto &prevCmd = undoStack.back();
 
-    if (!snapshotScene) return false;
-    snapshotScene->deserialize(prevCmd->state);
-
-    ctx.selObjectUUID = 0;
-    for (auto &selUUID : prevCmd->selection) {
-      if (snapshotScene->getObjectByUUID(selUUID)) {
-        ctx.selObjectUUID = selUUID;
-        break; // @TODO: change with multi-selection support
+    if (cmd->isKeyframe() && cmd->changes.empty() && cmd->confAfter.empty()) {
+      // hierarchy changed, rebuild from the last snapshot before it
+      restoreTopState(*snapshotScene);
+    } else {
+      for (auto it = cmd->changes.rbegin(); it != cmd->changes.rend(); ++it) {
+        applyChange(*snapshotScene, *it, true);
+      }
+      if (!cmd->confBefore.empty()) {
+        applyConf(*snapshotScene, cmd->confBefore);
+        knownConf = cmd->confBefore;
       }
     }
 
+    deltasSinceKeyframe = countDeltas(undoStack);
+    applySelection(*snapshotScene, prevCmd->selection);
     redoStack.push_back(std::move(cmd));
-    
     return true;
   }
   
   bool History::redo()
   {
-    if (!canRedo()) return false;
+    if (!canRedo() || !snapshotScene) return false;
+    ++changeCount;
 
     auto cmd = std::move(redoStack.back());
     redoStack.pop_back();
 
-    if (!snapshotScene) return false;
-    snapshotScene->deserialize(cmd->state);
-    ctx.selObjectUUID = snapshotScene->getObjectByUUID(cmd->selection[0]) ? cmd->selection[0] : 0;
+    if (cmd->changes.empty() && cmd->confAfter.empty()) {
+      snapshotScene->deserializeBinary(cmd->state);
+      rebuildKnownState(*snapshotScene);
+    } else {
+      for (auto &change : cmd->changes) {
+        applyChange(*snapshotScene, change, false);
+      }
+      if (!cmd->confAfter.empty()) {
+        applyConf(*snapshotScene, cmd->confAfter);
+        knownConf = cmd->confAfter;
+      }
+    }
 
+    applySelection(*snapshotScene, cmd->selection);
     undoStack.push_back(std::move(cmd));
-
+    deltasSinceKeyframe = countDeltas(undoStack);
     return true;
   }
   
@@ -59,7 +182,13 @@ namespace Editor::UndoRedo
     redoStack.clear();
     nextChangedReason.clear();
     snapshotScene = nullptr;
-    snapshotSelUUID = 0;
+    snapshotSelection.clear();
+    knownObjects.clear();
+    knownPrefabs.clear();
+    knownConf.clear();
+    knownStructure = 0;
+    deltasSinceKeyframe = 0;
+    ++changeCount;
   }
 
   void History::begin() {
@@ -68,15 +197,22 @@ namespace Editor::UndoRedo
 
     if (undoStack.empty()) {
       // If this is the first change, we need to save the initial state of the scene
-      std::string initialState = scene->serialize(true);
-      std::vector<uint32_t> ids{};
-      undoStack.push_back(std::make_unique<Entry>(
-        std::move(initialState), "Initial State", ids
-      ));
+      auto entry = std::make_unique<Entry>();
+      entry->state = scene->serializeBinary();
+      entry->description = "Initial State";
+      undoStack.push_back(std::move(entry));
+      rebuildKnownState(*scene);
+      deltasSinceKeyframe = 0;
+    }
+
+    // the state before the first edit of a prefab, later ones are diffed against the last known one
+    auto prefab = getEditedPrefab(*scene);
+    if (prefab && !knownPrefabs.contains(prefab->uuid.value)) {
+      knownPrefabs[prefab->uuid.value] = serializeObject(prefab->obj);
     }
 
     snapshotScene = scene;
-    snapshotSelUUID = ctx.selObjectUUID;
+    snapshotSelection = ctx.selObjectUUIDs;
   }
 
   void History::end() {
@@ -89,30 +225,72 @@ namespace Editor::UndoRedo
       return;
     }
 
-    redoStack.clear();
-    std::vector<uint32_t> ids{};
-    ids.push_back(ctx.selObjectUUID);
+    auto newEntry = std::make_unique<Entry>();
+    newEntry->description = std::move(nextChangedReason);
+    newEntry->selection = getSelection();
+    nextChangedReason.clear();
 
-    auto newEntry = std::make_unique<Entry>(
-      scene->serialize(true),
-      nextChangedReason,
-      ids
-    );
+    if (scene->structureVersion == knownStructure)
+    {
+      auto diffObject = [&](uint32_t uuid) {
+        auto obj = scene->getObjectByUUID(uuid);
+        auto known = knownObjects.find(uuid);
+        if (!obj || known == knownObjects.end())return;
+        for (auto &change : newEntry->changes) {
+          if (change.uuid == uuid)return;
+        }
 
-    nextChangedReason.clear();
+        auto state = serializeObject(*obj);
+        if (state != known->second) {
+          newEntry->changes.push_back({uuid, known->second, std::move(state)});
+        }
+      };
 
-    if (!undoStack.empty()) {
-      // check against last state to avoid pushing duplicate states
-      if (undoStack.back()->state == newEntry->state) {
-        return;
+      // almost all edits are done on the selection, so only that has to be serialized.
+      // changes to several selected objects end up as one entry
+      for (auto uuid : snapshotSelection)diffObject(uuid);
+      for (auto uuid : ctx.selObjectUUIDs)diffObject(uuid);
+
+      auto prefab = getEditedPrefab(*scene);
+      auto knownPrefab = prefab ? knownPrefabs.find(prefab->uuid.value) : knownPrefabs.end();
+      if (knownPrefab != knownPrefabs.end()) {
+        auto state = serializeObject(prefab->obj);
+        if (state != knownPrefab->second) {
+          newEntry->changes.push_back({prefab->obj.uuid, knownPrefab->second, std::move(state), prefab->uuid.value});
+        }
       }
-    }
 
-    undoStack.push_back(std::move(newEntry));
+      auto conf = Utils::JSON::toBinary(scene->conf.serialize());
+      if (conf != knownConf) {
+        newEntry->confBefore = knownConf;
+        newEntry->confAfter = std::move(conf);
+      }
+
+      if (newEntry->changes.empty() && newEntry->confAfter.empty()) {
+        for (auto &[uuid, obj] : scene->objectsMap)diffObject(uuid);
+      }
+      // avoid pushing duplicate states
+      if (newEntry->changes.empty() && newEntry->confAfter.empty())return;
 
-    if (undoStack.size() > maxHistorySize) {
-      undoStack.erase(undoStack.begin(), undoStack.end() - maxHistorySize);
+      for (auto &change : newEntry->changes) {
+        if (change.prefabUUID)knownPrefabs[change.prefabUUID] = change.after;
+        else knownObjects[change.uuid] = change.after;
+      }
+      if (!newEntry->confAfter.empty())knownConf = newEntry->confAfter;
+
+      if (++deltasSinceKeyframe >= KEYFRAME_INTERVAL) {
+        newEntry->state = scene->serializeBinary();
+        deltasSinceKeyframe = 0;
+      }
+    } else {
+      newEntry->state = scene->serializeBinary();
+      rebuildKnownState(*scene);
+      deltasSinceKeyframe = 0;
     }
+
+    redoStack.clear();
+    undoStack.push_back(std::move(newEntry));
+    trim();
   }
 
   std::string History::getUndoDescription() const
@@ -136,9 +314,7 @@ namespace Editor::UndoRedo
       return;
     }
 
-    if (undoStack.size() > maxHistorySize) {
-      undoStack.erase(undoStack.begin(), undoStack.end() - maxHistorySize);
-    }
+    trim();
 
     if (redoStack.size() > maxHistorySize) {
       redoStack.erase(redoStack.begin(), redoStack.end() - maxHistorySize);
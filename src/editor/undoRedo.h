@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace Project
@@ -15,20 +16,46 @@ namespace Project
 
 namespace Editor::UndoRedo
 {
+  /**
+   * Serialized state of a single object (without children), before and after an edit.
+   * Edits to a prefab (through an instance in prefab-edit mode) are stored the same way, with its UUID set.
+   */
+  struct ObjectChange
+  {
+    uint32_t uuid{};
+    std::string before{};
+    std::string after{};
+    uint64_t prefabUUID{0};
+  };
+
   struct Entry
   {
-    std::string state{};
+    std::string state{}; // full scene, only set for keyframes
     std::string description{};
     std::vector<uint32_t> selection{};
+    std::vector<ObjectChange> changes{};
+    std::string confBefore{}; // scene settings, empty if unchanged
+    std::string confAfter{};
+
+    [[nodiscard]] bool isKeyframe() const { return !state.empty(); }
 
     uint64_t getMemoryUsage() const {
-      return state.capacity() + description.capacity()
-      + sizeof(Entry) + selection.capacity() * sizeof(uint32_t);
+      uint64_t res = state.capacity() + description.capacity()
+        + confBefore.capacity() + confAfter.capacity()
+        + sizeof(Entry) + selection.capacity() * sizeof(uint32_t)
+        + changes.capacity() * sizeof(ObjectChange);
+      for(auto &change : changes) {
+        res += change.before.capacity() + change.after.capacity();
+      }
+      return res;
     }
   };
 
   /**
    * Manages undo/redo history.
+   * Edits are stored as the objects they changed, so undo/redo only touches those.
+   * Full snapshots of the scene (keyframes) are only made if its hierarchy changed,
+   * or every few edits so that restoring an older state never has to replay too many.
    */
   class History
   {
@@ -37,9 +64,22 @@ namespace Editor::UndoRedo
       std::vector<std::unique_ptr<Entry>> redoStack;
       size_t maxHistorySize{100};
       Project::Scene* snapshotScene{nullptr};
-      uint32_t snapshotSelUUID{0};
+      std::vector<uint32_t> snapshotSelection{};
       std::string nextChangedReason{};
-      
+      uint64_t changeCount{0};
+
+      // state of the scene as of the last entry, to diff the next edit against
+      std::unordered_map<uint32_t, std::string> knownObjects{};
+      std::unordered_map<uint64_t, std::string> knownPrefabs{}; // only the ones edited so far
+      std::string knownConf{};
+      uint32_t knownStructure{0};
+      uint32_t deltasSinceKeyframe{0};
+
+      void rebuildKnownState(Project::Scene &scene);
+      void applyChange(Project::Scene &scene, const ObjectChange &change, bool isUndo);
+      void restoreTopState(Project::Scene &scene);
+      void trim();
+
     public:
       /**
        * Undo the last command.
@@ -60,8 +100,15 @@ namespace Editor::UndoRedo
 
       void markChanged(std::string reason) {
         nextChangedReason = std::move(reason);
+        ++changeCount;
       }
 
+      /**
+       * Increases with every edit (call to 'markChanged'), undo, redo and clear.
+       * Lets views cache data derived from the scene, as long as they check it before each use.
+       */
+      [[nodiscard]] uint64_t getChangeCount() const { return changeCount; }
+
       uint32_t getUndoCount() const { return (uint32_t)undoStack.size(); }
       uint32_t getRedoCount() const { return (uint32_t)redoStack.size(); }
 
@@ -35,6 +35,14 @@
 Context ctx{};
 constinit SDL_GPUSampler *texSamplerRepeat{nullptr};
 
+namespace
+{
+  // the UI keeps drawing for a bit after input, for hover effects and delayed tooltips
+  constexpr uint64_t REDRAW_AFTER_INPUT_NS = 1'000'000'000;
+  constexpr int32_t IDLE_WAIT_MS = 100;
+  constexpr int32_t IDLE_WAIT_UNFOCUSED_MS = 250;
+}
+
 namespace T3DM
 {
   thread_local Config config{};
@@ -201,14 +209,25 @@ int main(int argc, char** argv)
 
     // Main loop
     bool done = false;
+    uint64_t lastInputTime = 0;
     while(!done) {
 
+      auto windowFlags = SDL_GetWindowFlags(window);
+      bool isMinimized = windowFlags & SDL_WINDOW_MINIMIZED;
+      bool hasFocus = windowFlags & SDL_WINDOW_INPUT_FOCUS;
+
+      // idle, sleep until there is input (the timeout keeps the asset watcher going)
+      if(ctx.redrawFrames == 0 && (SDL_GetTicksNS() - lastInputTime) > REDRAW_AFTER_INPUT_NS) {
+        SDL_WaitEventTimeout(nullptr, (hasFocus && !isMinimized) ? IDLE_WAIT_MS : IDLE_WAIT_UNFOCUSED_MS);
+      }
+
       auto frameStart = SDL_GetTicksNS();
       //printf("Frame Start | Time: %.2fms\n", ImGui::GetIO().DeltaTime * 1000.0f);
       SDL_Event event;
       while (SDL_PollEvent(&event))
       {
         ImGui_ImplSDL3_ProcessEvent(&event);
+        lastInputTime = frameStart;
 
         if(event.type == SDL_EVENT_QUIT)done = true;
         if(event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(window)) {
@@ -271,14 +290,22 @@ int main(int argc, char** argv)
 
       Utils::FilePicker::poll();
       if (ctx.project) {
-        ctx.project->getAssets().pollWatch();
+        if(ctx.project->getAssets().pollLoading())ctx.requestRedraw();
+        if(ctx.project->getAssets().pollWatch())ctx.requestRedraw();
       }
+      // log output and the build/run buttons
+      if(ctx.isBuildOrRunning())ctx.requestRedraw();
+      if(ImGui::GetIO().WantTextInput)ctx.requestRedraw();
 
-      if(SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) {
-        SDL_Delay(10);
+      if(isMinimized) {
+        ctx.redrawFrames = 0;
         continue;
       }
 
+      bool isActive = (frameStart - lastInputTime) <= REDRAW_AFTER_INPUT_NS;
+      if(!isActive && ctx.redrawFrames == 0)continue;
+      if(ctx.redrawFrames > 0)--ctx.redrawFrames;
+
       ImGui_ImplSDLGPU3_NewFrame();
       ImGui_ImplSDL3_NewFrame();
       ImGui::NewFrame();
@@ -303,9 +330,10 @@ int main(int argc, char** argv)
 
       ctx.timeCpuTotal = SDL_GetTicksNS() - timeTotal;
 
-      if(presentMode != SDL_GPU_PRESENTMODE_VSYNC)
+      // in the background, things like builds only need to show progress
+      if(presentMode != SDL_GPU_PRESENTMODE_VSYNC || !hasFocus)
       {
-        uint64_t targetFrameTime = 16'666'666; // ~60 FPS
+        uint64_t targetFrameTime = hasFocus ? 16'666'666 : 100'000'000; // ~60 / 10 FPS
         auto frameTime = SDL_GetTicksNS() - frameStart;
         if(frameTime < targetFrameTime) {
           SDL_DelayNS(targetFrameTime - frameTime);
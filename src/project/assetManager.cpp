@@ -7,9 +7,12 @@
 #include <filesystem>
 #include <format>
 #include <chrono>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
 #include "SHA256.h"
+#include "../renderer/scene.h"
 #include "../utils/codeParser.h"
 #include "../utils/fs.h"
 #include "../utils/hash.h"
@@ -19,12 +22,78 @@
 #include "../utils/meshGen.h"
 #include "../utils/string.h"
 #include "../utils/textureFormats.h"
+#include "../build/projectBuilder.h"
 #include "tiny3d/tools/gltf_importer/src/parser.h"
 
 namespace fs = std::filesystem;
 
 namespace
 {
+  // same file for any spelling of the path ('a//b', 'a/./b', '\\' on windows)
+  std::string getPathKey(const std::string &path) {
+    return Utils::FS::toUnixPath(fs::path{path}.lexically_normal());
+  }
+
+  // orders entry lists, with a name or an entry on either side
+  struct NameCompare
+  {
+    static const std::string &getName(const std::string &name) { return name; }
+    static const std::string &getName(const std::shared_ptr<Project::AssetManagerEntry> &entry) { return entry->name; }
+    bool operator()(const auto &a, const auto &b) const { return getName(a) < getName(b); }
+  };
+
+  // the importer is configured through a global, so only one model can be parsed at a time
+  std::mutex t3dmParseMtx{};
+
+  // see 'setParseCacheEnabled', guarded by 't3dmParseMtx'
+  struct CachedModel
+  {
+    std::string parseKey{};
+    T3DM::T3DMData data{};
+  };
+  std::unordered_map<std::string, CachedModel> parseCache{};
+  bool parseCacheEnabled{false};
+
+  T3DM::T3DMData parseModel(const std::string &path, float baseScale, int animSampleRate, bool createBVH, bool splitMeshes,
+    const std::string &assetPathFull, const std::string &parseKey)
+  {
+    std::lock_guard lock{t3dmParseMtx};
+    // one version per model and rate, a changed file replaces the old one
+    auto cacheKey = path + "@" + std::to_string(animSampleRate);
+    if(parseCacheEnabled) {
+      auto it = parseCache.find(cacheKey);
+      if(it != parseCache.end() && it->second.parseKey == parseKey)return it->second.data;
+    }
+
+    T3DM::config = {
+      .globalScale = baseScale,
+      .animSampleRate = animSampleRate,
+      //.ignoreMaterials = args.checkArg("--ignore-materials"),
+      //.ignoreTransforms = args.checkArg("--ignore-transforms"),
+      .createBVH = createBVH,
+      .verbose = false,
+      .assetPath = "assets/",
+      .assetPathFull = assetPathFull,
+    };
+    auto t3dm = T3DM::parseGLTF(path.c_str());
+    // done here and not only when building, mesh filters of components refer to the split objects
+    if(splitMeshes)Build::splitLargeMeshes(t3dm);
+
+    if(parseCacheEnabled)parseCache[cacheKey] = {parseKey, t3dm};
+    return t3dm;
+  }
+
+  void createModelMesh(Project::AssetManagerEntry &entry, Project::AssetManager &assets)
+  {
+    if (entry.t3dmData.models.empty()) {
+      return;
+    }
+    if (!entry.mesh3D) {
+      entry.mesh3D = std::make_shared<Renderer::N64Mesh>();
+    }
+    entry.mesh3D->fromT3DM(entry.t3dmData, assets);
+  }
+
   fs::path getCodePath(Project::Project *project) {
     auto res = fs::path{project->getPath()} / "src" / "user";
     if (!fs::exists(res)) {
@@ -66,12 +135,28 @@ namespace
       conf.baseScale = doc["baseScale"];
       conf.compression = (Project::ComprTypes)doc.value<int>("compression", 0);
       conf.gltfBVH = doc["gltfBVH"];
+      Utils::JSON::readProp(doc, conf.gltfBVHAuto, true);
+      Utils::JSON::readProp(doc, conf.gltfSplitMeshes);
+      Utils::JSON::readProp(doc, conf.atlasGroup);
+      Utils::JSON::readProp(doc, conf.gltfVertexCache);
       Utils::JSON::readProp(doc, conf.gltfCollision);
+      Utils::JSON::readProp(doc, conf.gltfCollSimplify);
+      Utils::JSON::readProp(doc, conf.gltfCollLeafSize);
+      Utils::JSON::readProp(doc, conf.gltfCollQuantize);
+      Utils::JSON::readProp(doc, conf.gltfAnimRate);
+      Utils::JSON::readProp(doc, conf.gltfAnimAuto);
+      Utils::JSON::readProp(doc, conf.gltfAnimMaxErr);
+      Utils::JSON::readProp(doc, conf.gltfBakeLight);
+      Utils::JSON::readProp(doc, conf.gltfBakeScene);
       Utils::JSON::readProp(doc, conf.wavForceMono);
       Utils::JSON::readProp(doc, conf.wavResampleRate);
       Utils::JSON::readProp(doc, conf.wavCompression);
+      Utils::JSON::readProp(doc, conf.wavLoop);
+      Utils::JSON::readProp(doc, conf.wavLoopOffset);
       Utils::JSON::readProp(doc, conf.fontId);
       Utils::JSON::readProp(doc, conf.fontCharset);
+      Utils::JSON::readProp(doc, conf.fontCharsetAuto);
+      Utils::JSON::readProp(doc, conf.prefabPoolSize);
 
       conf.exclude = doc["exclude"];
     }
@@ -195,15 +280,31 @@ std::string Project::AssetConf::serialize() const {
   return Utils::JSON::Builder{}
     .set("uuid", uuid)
     .set("format", format)
+    .set(atlasGroup)
     .set("baseScale", baseScale)
     .set("compression", static_cast<int>(compression))
     .set("gltfBVH", gltfBVH)
+    .set(gltfBVHAuto)
+    .set(gltfSplitMeshes)
+    .set(gltfVertexCache)
     .set(gltfCollision)
+    .set(gltfCollSimplify)
+    .set(gltfCollLeafSize)
+    .set(gltfCollQuantize)
+    .set(gltfAnimRate)
+    .set(gltfAnimAuto)
+    .set(gltfAnimMaxErr)
+    .set(gltfBakeLight)
+    .set(gltfBakeScene)
     .set(wavForceMono)
     .set(wavResampleRate)
     .set(wavCompression)
+    .set(wavLoop)
+    .set(wavLoopOffset)
     .set(fontId)
     .set(fontCharset)
+    .set(fontCharsetAuto)
+    .set(prefabPoolSize)
     .set("exclude", exclude)
     .toString();
 }
@@ -215,7 +316,23 @@ Project::AssetManager::AssetManager(Project* pr)
 }
 
 Project::AssetManager::~AssetManager() {
+  cancelLoading();
+  cancelImports();
+
+}
 
+std::string Project::AssetManagerEntry::getT3DMParseKey() const
+{
+  std::string key = path + ":" + std::to_string(Utils::FS::getFileAge(path));
+  // text glTFs keep their geometry in a separate buffer
+  if(fs::path{path}.extension() == ".gltf") {
+    key += ":" + std::to_string(Utils::FS::getFileAge(fs::path{path}.replace_extension(".bin")));
+  }
+  key += ":" + std::to_string(conf.baseScale);
+  key += ":" + std::to_string(conf.getAnimSampleRate());
+  key += ":" + std::to_string(conf.gltfBVH);
+  key += ":" + std::to_string(conf.gltfSplitMeshes.value);
+  return key;
 }
 
 void Project::AssetManager::reloadEntry(AssetManagerEntry &entry, const std::string &path)
@@ -236,25 +353,18 @@ void Project::AssetManager::reloadEntry(AssetManagerEntry &entry, const std::str
 
     case FileType::MODEL_3D:
     {
+      // big models take a while, the editor keeps showing the old mesh in the meantime
+      if (ctx.window) {
+        startImport(entry);
+        break;
+      }
       try{
-        T3DM::config = {
-          .globalScale = (float)entry.conf.baseScale,
-          .animSampleRate = 60,
-          //.ignoreMaterials = args.checkArg("--ignore-materials"),
-          //.ignoreTransforms = args.checkArg("--ignore-transforms"),
-          .createBVH = entry.conf.gltfBVH,
-          .verbose = false,
-          .assetPath = "assets/",
-          .assetPathFull = fs::absolute(project->getPath() + "/assets").string(),
-        };
-
-        entry.t3dmData = T3DM::parseGLTF(path.c_str());
-        if (!entry.t3dmData.models.empty()) {
-          if (!entry.mesh3D) {
-            entry.mesh3D = std::make_shared<Renderer::N64Mesh>();
-          }
-          entry.mesh3D->fromT3DM(entry.t3dmData, *this);
-        }
+        auto parseKey = entry.getT3DMParseKey();
+        entry.t3dmData = ::parseModel(path, (float)entry.conf.baseScale, (int)entry.conf.getAnimSampleRate(),
+          entry.conf.gltfBVH, entry.conf.gltfSplitMeshes.value, fs::absolute(project->getPath() + "/assets").string(),
+          parseKey);
+        entry.t3dmParseKey = parseKey;
+        createModelMesh(entry, *this);
       } catch (std::exception &e) {
         Utils::Logger::log("Failed to load 3D model asset: " + entry.path + " - " + e.what(), Utils::Logger::LEVEL_ERROR);
       }
@@ -266,8 +376,11 @@ void Project::AssetManager::reloadEntry(AssetManagerEntry &entry, const std::str
 }
 
 void Project::AssetManager::reload() {
+  cancelLoading();
+  cancelImports();
   for (auto &e : entries)e.clear();
   entriesMap.clear();
+  entriesPathMap.clear();
   watchFiles.clear();
   watchInitialized = false;
 
@@ -276,6 +389,12 @@ void Project::AssetManager::reload() {
     fs::create_directory(assetPath);
   }
 
+  // collected first, inserting them already sorted is cheaper
+  std::array<std::vector<AssetManagerEntry>, static_cast<size_t>(FileType::_SIZE)> newEntries{};
+  // in the editor, models and the images they use load in the background (see 'pollLoading')
+  auto load = std::make_unique<BackgroundLoad>();
+  load->assetPathFull = fs::absolute(assetPath).string();
+
   // scan all files
   for (const auto &entry : fs::recursive_directory_iterator{assetPath}) {
     if (entry.is_regular_file()) {
@@ -286,9 +405,10 @@ void Project::AssetManager::reload() {
         continue;
       }
 
+      // other images are only loaded once needed (see 'requestTexture'), the browser uses thumbnails
       if (assetEntry.type == FileType::IMAGE) {
         if (ctx.window) {
-          reloadEntry(assetEntry, path.string());
+          assetEntry.texture = getFallbackTexture();
         }
       }
 
@@ -299,16 +419,7 @@ void Project::AssetManager::reload() {
         }
       }
 
-      entries[(int)assetEntry.type].push_back(assetEntry);
-    }
-  }
-
-  // now load models (after all textures are there now)
-  for (auto &typed : entries) {
-    for (auto &entry : typed) {
-      if (entry.type == FileType::MODEL_3D) {
-        reloadEntry(entry, entry.path);
-      }
+      newEntries[(int)assetEntry.type].push_back(std::move(assetEntry));
     }
   }
 
@@ -324,95 +435,456 @@ void Project::AssetManager::reload() {
         continue;
       }
 
-      entries[(int)codeEntry.type].push_back(codeEntry);
+      newEntries[(int)codeEntry.type].push_back(std::move(codeEntry));
     }
   }
 
   // sort by name
-  for (auto &typed : entries) {
-    std::sort(typed.begin(), typed.end(), [](const AssetManagerEntry &a, const AssetManagerEntry &b) {
+  for (auto &typed : newEntries) {
+    std::stable_sort(typed.begin(), typed.end(), [](const AssetManagerEntry &a, const AssetManagerEntry &b) {
       return a.name < b.name;
     });
+    for (auto &entry : typed) {
+      addEntry(std::move(entry));
+    }
+  }
+
+  // now load models (after all textures are there and can be looked up)
+  for (auto &entry : entries[(int)FileType::MODEL_3D]) {
+    if (!ctx.window) {
+      reloadEntry(entry, entry.path);
+      continue;
+    }
+    load->models.push_back({
+      .path = entry.path,
+      .baseScale = (float)entry.conf.baseScale,
+      .animSampleRate = (int)entry.conf.getAnimSampleRate(),
+      .createBVH = entry.conf.gltfBVH,
+      .splitMeshes = entry.conf.gltfSplitMeshes.value,
+      .parseKey = entry.getT3DMParseKey(),
+    });
   }
 
-  for (auto &typed : entries)
+  if (!load->models.empty()) {
+    startLoading(std::move(load));
+  }
+}
+
+T3DM::T3DMData Project::AssetManager::parseModel(const AssetManagerEntry &entry, int animSampleRate, const std::string &assetPathFull)
+{
+  // the cache is split by rate, the key itself only has the configured one
+  return ::parseModel(entry.path, (float)entry.conf.baseScale, animSampleRate, entry.conf.gltfBVH,
+    entry.conf.gltfSplitMeshes.value, assetPathFull, entry.getT3DMParseKey());
+}
+
+void Project::AssetManager::setParseCacheEnabled(bool enabled)
+{
+  std::lock_guard lock{t3dmParseMtx};
+  parseCacheEnabled = enabled;
+  if(!enabled)parseCache.clear();
+}
+
+void Project::AssetManager::startLoading(std::unique_ptr<BackgroundLoad> load)
+{
+  loading = std::move(load);
+  auto &state = *loading;
+
+  // models in order on a single thread since parsing can't run in parallel
+  state.tasks.push_back(std::async(std::launch::async, [&state]() {
+    for (auto &model : state.models) {
+      if (state.cancel) break;
+      try {
+        model.data = ::parseModel(model.path, model.baseScale, model.animSampleRate, model.createBVH, model.splitMeshes,
+          state.assetPathFull, model.parseKey);
+      } catch (std::exception &e) {
+        model.error = e.what();
+      }
+    }
+    state.modelsDone = true;
+  }));
+}
+
+void Project::AssetManager::startImageLoading()
+{
+  auto &state = *loading;
+
+  // images are independent, spread over all cores
+  if (!state.images.empty()) {
+    uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+    threadCount = std::min<uint32_t>(threadCount, state.images.size());
+    for (uint32_t t = 0; t < threadCount; ++t) {
+      state.tasks.push_back(std::async(std::launch::async, [&state]() {
+        while (!state.cancel) {
+          size_t idx = state.nextImage++;
+          if (idx >= state.images.size()) break;
+
+          auto &image = state.images[idx];
+          image.img = Renderer::Texture::decode(image.path, image.isMono);
+
+          std::lock_guard lock{state.mtx};
+          state.imagesDone.push_back(idx);
+        }
+      }));
+    }
+  }
+}
+
+void Project::AssetManager::cancelLoading()
+{
+  if (!loading) return;
+  loading->cancel = true;
+  for (auto &task : loading->tasks) {
+    task.wait();
+  }
+  for (auto &image : loading->images) {
+    if (image.img) SDL_DestroySurface(image.img);
+  }
+  loading.reset();
+}
+
+void Project::AssetManager::startImport(AssetManagerEntry &entry)
+{
+  // a newer change replaces the result of a still running import
+  cancelImport(entry);
+
+  auto import = std::make_unique<ModelImport>();
+  import->model = {
+    .path = entry.path,
+    .baseScale = (float)entry.conf.baseScale,
+    .animSampleRate = (int)entry.conf.getAnimSampleRate(),
+    .createBVH = entry.conf.gltfBVH,
+    .splitMeshes = entry.conf.gltfSplitMeshes.value,
+    .parseKey = entry.getT3DMParseKey(),
+  };
+  import->assetPathFull = fs::absolute(project->getPath() + "/assets").string();
+  import->startTime = std::chrono::steady_clock::now();
+
+  auto &state = *import;
+  state.task = std::async(std::launch::async, [&state]() {
+    auto &model = state.model;
+    try {
+      model.data = ::parseModel(model.path, model.baseScale, model.animSampleRate, model.createBVH, model.splitMeshes,
+        state.assetPathFull, model.parseKey);
+    } catch (std::exception &e) {
+      model.error = e.what();
+    }
+    state.done = true;
+  });
+  imports.push_back(std::move(import));
+}
+
+bool Project::AssetManager::pollImports()
+{
+  if (imports.empty()) return false;
+
+  bool applied = false;
+  std::erase_if(imports, [&](const std::unique_ptr<ModelImport> &import) {
+    if (!import->done) return false;
+    import->task.wait();
+    if (import->cancel) return true;
+
+    auto &model = import->model;
+    auto entry = getByPath(model.path);
+    if (!entry || entry->type != FileType::MODEL_3D) return true;
+
+    auto secs = std::chrono::duration<float>(std::chrono::steady_clock::now() - import->startTime).count();
+    if (!model.error.empty()) {
+      Utils::Logger::log("Failed to load 3D model asset: " + model.path + " - " + model.error, Utils::Logger::LEVEL_ERROR);
+      return true;
+    }
+    entry->t3dmData = std::move(model.data);
+    entry->t3dmParseKey = model.parseKey;
+    createModelMesh(*entry, *this);
+    Utils::Logger::log(std::format("Imported {} ({:.1f}s)", entry->name, secs));
+    applied = true;
+    return true;
+  });
+  return applied || !imports.empty();
+}
+
+void Project::AssetManager::cancelImports()
+{
+  for (auto &import : imports) {
+    import->task.wait();
+  }
+  imports.clear();
+}
+
+float Project::AssetManager::getImportTime(const AssetManagerEntry &entry) const
+{
+  for (auto &import : imports) {
+    if (import->cancel || import->model.path != entry.path) continue;
+    return std::chrono::duration<float>(std::chrono::steady_clock::now() - import->startTime).count();
+  }
+  return -1.0f;
+}
+
+void Project::AssetManager::cancelImport(const AssetManagerEntry &entry)
+{
+  for (auto &import : imports) {
+    if (import->model.path == entry.path) import->cancel = true;
+  }
+}
+
+bool Project::AssetManager::pollLoading()
+{
+  bool importing = pollImports();
+  if (!loading) return importing;
+  auto &state = *loading;
+  if (!state.modelsDone) return true;
+
+  // textures used by the models are loaded next
+  if (!state.imagesQueued) {
+    state.imagesQueued = true;
+    std::unordered_set<std::string> queued{};
+    auto queueTexture = [&](const std::string &texPath) {
+      auto entry = texPath.empty() ? nullptr : getByPath(texPath);
+      if (!entry || entry->type != FileType::IMAGE || entry->texture != getFallbackTexture()) return;
+      if (!queued.insert(entry->path).second) return;
+      bool isMono = Utils::isTexFormatMono(static_cast<Utils::TexFormat>(entry->conf.format));
+      state.images.push_back({entry->path, isMono});
+    };
+    for (auto &model : state.models) {
+      for (auto &part : model.data.models) {
+        queueTexture(part.material.texA.texPath);
+        queueTexture(part.material.texB.texPath);
+      }
+    }
+    startImageLoading();
+  }
+
+  std::vector<size_t> imagesDone{};
+  {
+    std::lock_guard lock{state.mtx};
+    imagesDone.swap(state.imagesDone);
+  }
+
+  // textures are created here, their data is sent with the next copy pass of the frame
+  for (auto idx : imagesDone)
   {
-    int idx = 0;
-    for (auto &entry : typed)
+    auto &image = state.images[idx];
+    auto entry = getByPath(image.path);
+    if (image.img && entry && entry->type == FileType::IMAGE)
     {
-      entriesMap[entry.getUUID()] = {(int)entry.type, idx};
-      ++idx;
+      auto texture = std::make_shared<Renderer::Texture>(ctx.gpu, image.img);
+      if (ctx.scene) {
+        ctx.scene->addOneTimeCopyPass([texture](SDL_GPUCommandBuffer*, SDL_GPUCopyPass *copyPass) {
+          texture->upload(*copyPass);
+        });
+      } else {
+        SDL_GPUCommandBuffer* cmd = SDL_AcquireGPUCommandBuffer(ctx.gpu);
+        SDL_GPUCopyPass* copyPass = SDL_BeginGPUCopyPass(cmd);
+        texture->upload(*copyPass);
+        SDL_EndGPUCopyPass(copyPass);
+        SDL_SubmitGPUCommandBuffer(cmd);
+      }
+      entry->texture = texture;
+    }
+    if (image.img) {
+      SDL_DestroySurface(image.img);
+      image.img = nullptr;
+    }
+  }
+  state.imagesApplied += imagesDone.size();
+
+  // meshes reference the textures, so they are only created once all of those are there
+  if (state.imagesApplied < state.images.size()) {
+    return true;
+  }
+
+  for (auto &model : state.models)
+  {
+    auto entry = getByPath(model.path);
+    if (!entry || entry->type != FileType::MODEL_3D) continue;
+    if (!model.error.empty()) {
+      Utils::Logger::log("Failed to load 3D model asset: " + model.path + " - " + model.error, Utils::Logger::LEVEL_ERROR);
+      continue;
+    }
+    // changed in the meantime, reloaded by 'pollWatch' already
+    if (entry->getT3DMParseKey() != model.parseKey) continue;
+
+    entry->t3dmData = std::move(model.data);
+    entry->t3dmParseKey = model.parseKey;
+    createModelMesh(*entry, *this);
+  }
+
+  for (auto &task : state.tasks) {
+    task.wait();
+  }
+  loading.reset();
+  return importing;
+}
+
+Project::AssetManagerEntry& Project::AssetManager::addEntry(AssetManagerEntry &&newEntry)
+{
+  auto &entry = entries[static_cast<int>(newEntry.type)].insert(std::move(newEntry));
+  entriesMap[entry.getUUID()] = &entry;
+  entriesPathMap[getPathKey(entry.path)] = &entry;
+  return entry;
+}
+
+void Project::AssetManager::removeEntry(AssetManagerEntry *entry)
+{
+  auto itUUID = entriesMap.find(entry->getUUID());
+  if (itUUID != entriesMap.end() && itUUID->second == entry) {
+    entriesMap.erase(itUUID);
+  }
+  auto itPath = entriesPathMap.find(getPathKey(entry->path));
+  if (itPath != entriesPathMap.end() && itPath->second == entry) {
+    entriesPathMap.erase(itPath);
+  }
+  entries[static_cast<int>(entry->type)].erase(entry);
+}
+
+Project::AssetManagerEntry& Project::AssetEntryList::insert(AssetManagerEntry &&entry)
+{
+  auto it = std::upper_bound(items.begin(), items.end(), entry.name, NameCompare{});
+  it = items.insert(it, std::make_shared<AssetManagerEntry>(std::move(entry)));
+  return **it;
+}
+
+void Project::AssetEntryList::erase(const AssetManagerEntry *entry)
+{
+  auto range = std::equal_range(items.begin(), items.end(), entry->name, NameCompare{});
+  for (auto it = range.first; it != range.second; ++it) {
+    if (it->get() == entry) {
+      items.erase(it);
+      return;
     }
   }
 }
 
+Project::AssetManagerEntry* Project::AssetEntryList::findByName(const std::string &name) const
+{
+  auto it = std::lower_bound(items.begin(), items.end(), name, NameCompare{});
+  return (it != items.end() && (*it)->name == name) ? it->get() : nullptr;
+}
+
 bool Project::AssetManager::pollWatch()
 {
   using Clock = std::chrono::steady_clock;
-  // Check for changes every 2 seconds
+  // Check for changes every 2 seconds, only used if there is no native watcher
   constexpr auto kMinInterval = std::chrono::milliseconds(2000);
 
+  auto assetPath = fs::path{project->getPath()} / "assets";
+  auto codePath = getCodePath(project);
+
+  // started on first use, so builds from the CLI never spawn the watcher thread
+  if (!watcherStarted) {
+    watcherStarted = true;
+    if (fs::exists(assetPath) && fs::exists(codePath)) {
+      watcher.start({assetPath, codePath});
+    }
+  }
+
+  // the first poll always scans, that catches anything changed before the watcher started
+  bool fullScan = !watchInitialized || !watcher.isRunning();
+  Utils::FileWatcher::Changes changes{};
+  if (!fullScan) {
+    changes = watcher.takeChanges();
+    fullScan = changes.needsRescan;
+  }
+
   auto now = Clock::now();
-  if (watchInitialized && (now - watchLastCheck) < kMinInterval) {
+  if (fullScan && watchInitialized && !watcher.isRunning() && (now - watchLastCheck) < kMinInterval) {
     return false;
   }
   watchInitialized = true;
   watchLastCheck = now;
 
-  // Snapshot current files so we can diff against watchFiles
-  std::unordered_map<std::string, uint64_t> currentFiles{};
   std::vector<std::string> addedAssets{};
   std::vector<std::string> modifiedAssets{};
   std::vector<std::string> addedCode{};
   std::vector<std::string> modifiedCode{};
   std::vector<std::string> removedPaths{};
 
-  // Detect added/modified asset files
-  auto assetPath = fs::path{project->getPath()} / "assets";
-  if (fs::exists(assetPath)) {
-    for (const auto &entry : fs::recursive_directory_iterator{assetPath}) {
-      if (!entry.is_regular_file()) continue;
-      auto path = entry.path();
-      auto pathStr = path.string();
-      uint64_t age = Utils::FS::getFileAge(path);
-
-      currentFiles[pathStr] = age;
-      auto it = watchFiles.find(pathStr);
-      if (it == watchFiles.end()) {
-        addedAssets.push_back(pathStr);
-      } else if (it->second != age) {
-        modifiedAssets.push_back(pathStr);
-      }
+  auto isInside = [](const fs::path &path, const fs::path &dir) {
+    auto rel = path.lexically_relative(dir);
+    return !rel.empty() && *rel.begin() != "..";
+  };
+
+  // Compares a file against watchFiles, updating it
+  auto checkFile = [&](const fs::path &path, bool isCode) {
+    auto pathStr = path.string();
+    uint64_t age = Utils::FS::getFileAge(path);
+
+    auto it = watchFiles.find(pathStr);
+    if (it == watchFiles.end()) {
+      (isCode ? addedCode : addedAssets).push_back(pathStr);
+      watchFiles[pathStr] = age;
+    } else if (it->second != age) {
+      (isCode ? modifiedCode : modifiedAssets).push_back(pathStr);
+      it->second = age;
     }
-  }
+  };
 
-  // Detect added/modified script files.
-  auto codePath = getCodePath(project);
-  if (fs::exists(codePath)) {
-    for (const auto &entry : fs::recursive_directory_iterator{codePath}) {
-      if (!entry.is_regular_file()) continue;
-      auto path = entry.path();
-      if (path.extension().string() != ".cpp") continue;
+  if (fullScan)
+  {
+    // Snapshot current files so we can diff against watchFiles
+    std::unordered_set<std::string> currentFiles{};
+
+    // Detect added/modified asset files
+    if (fs::exists(assetPath)) {
+      for (const auto &entry : fs::recursive_directory_iterator{assetPath}) {
+        if (!entry.is_regular_file()) continue;
+        currentFiles.insert(entry.path().string());
+        checkFile(entry.path(), false);
+      }
+    }
 
-      auto pathStr = path.string();
-      uint64_t age = Utils::FS::getFileAge(path);
+    // Detect added/modified script files.
+    if (fs::exists(codePath)) {
+      for (const auto &entry : fs::recursive_directory_iterator{codePath}) {
+        if (!entry.is_regular_file()) continue;
+        if (entry.path().extension().string() != ".cpp") continue;
+        currentFiles.insert(entry.path().string());
+        checkFile(entry.path(), true);
+      }
+    }
 
-      currentFiles[pathStr] = age;
-      auto it = watchFiles.find(pathStr);
-      if (it == watchFiles.end()) {
-        addedCode.push_back(pathStr);
-      } else if (it->second != age) {
-        modifiedCode.push_back(pathStr);
+    // Anything missing from the snapshot is treated as removed
+    for (const auto &pair : watchFiles) {
+      if (currentFiles.find(pair.first) == currentFiles.end()) {
+        removedPaths.push_back(pair.first);
       }
     }
   }
+  else
+  {
+    // only look at what the watcher reported, directories may have been moved in or out as a whole
+    std::unordered_set<std::string> checked{};
+    auto checkPath = [&](const fs::path &path) {
+      if (!checked.insert(path.string()).second) return;
+      bool isCode = path.extension().string() == ".cpp" && isInside(path, codePath);
+      if (isCode || isInside(path, assetPath)) {
+        checkFile(path, isCode);
+      }
+    };
 
-  // Anything missing from the snapshot is treated as removed
-  for (const auto &pair : watchFiles) {
-    if (currentFiles.find(pair.first) == currentFiles.end()) {
-      removedPaths.push_back(pair.first);
+    for (const auto &pathStr : changes.paths)
+    {
+      fs::path path{pathStr};
+      std::error_code err{};
+      if (fs::is_directory(path, err)) {
+        for (const auto &entry : fs::recursive_directory_iterator{path, err}) {
+          if (entry.is_regular_file()) checkPath(entry.path());
+        }
+      } else if (fs::is_regular_file(path, err)) {
+        checkPath(path);
+      } else {
+        // gone, if it was a directory everything inside of it is too
+        auto prefix = (path / "").string();
+        for (const auto &pair : watchFiles) {
+          if (pair.first == pathStr || pair.first.starts_with(prefix)) {
+            removedPaths.push_back(pair.first);
+          }
+        }
+      }
     }
   }
+  for (const auto &pathStr : removedPaths) {
+    watchFiles.erase(pathStr);
+  }
 
   // Bail out if nothing changed
   bool changed = !addedAssets.empty() || !modifiedAssets.empty() ||
@@ -422,30 +894,39 @@ bool Project::AssetManager::pollWatch()
     return false;
   }
 
-  // Track which entry lists we need to re-sort
-  std::unordered_set<int> touchedTypes{};
   std::vector<std::string> modelReloadPaths{};
 
-  // Remove an entry by absolute path across all lists
-  auto removeEntryByPath = [&](const std::string &pathStr) {
-    fs::path pathIn{pathStr};
-    for (size_t typeIdx = 0; typeIdx < entries.size(); ++typeIdx) {
-      auto &typed = entries[typeIdx];
-      for (size_t i = 0; i < typed.size(); ++i) {
-        if (fs::path{typed[i].path} == pathIn) {
-          typed.erase(typed.begin() + i);
-          touchedTypes.insert(static_cast<int>(typeIdx));
-          return true;
-        }
-      }
-    }
-    return false;
-  };
-
   for (const auto &pathStr : removedPaths) {
-    removeEntryByPath(pathStr);
+    if (auto entry = getByPath(pathStr)) {
+      removeEntry(entry);
+    }
   }
 
+  // Updates an existing entry in place (keeping references to it valid) or adds a new one
+  auto storeEntry = [&](const std::string &pathStr, AssetManagerEntry &&newEntry) -> AssetManagerEntry& {
+    auto entry = getByPath(pathStr);
+    if (!entry || entry->type != newEntry.type) {
+      if (entry) removeEntry(entry);
+      return addEntry(std::move(newEntry));
+    }
+
+    // path and name stay the same, the UUID may not
+    auto oldUUID = entry->getUUID();
+    // models are imported again in the background, until then the old one is shown
+    if (newEntry.type == FileType::MODEL_3D) {
+      newEntry.t3dmData = std::move(entry->t3dmData);
+      newEntry.t3dmParseKey = entry->t3dmParseKey;
+      newEntry.mesh3D = std::move(entry->mesh3D);
+    }
+    *entry = std::move(newEntry);
+    if (oldUUID != entry->getUUID()) {
+      auto it = entriesMap.find(oldUUID);
+      if (it != entriesMap.end() && it->second == entry) entriesMap.erase(it);
+      entriesMap[entry->getUUID()] = entry;
+    }
+    return *entry;
+  };
+
   // Rebuild a single asset entry and reload if needed
   auto addOrUpdateAsset = [&](const std::string &pathStr) {
     AssetManagerEntry newEntry{};
@@ -453,24 +934,22 @@ bool Project::AssetManager::pollWatch()
       return;
     }
 
-    removeEntryByPath(pathStr);
-    entries[static_cast<int>(newEntry.type)].push_back(std::move(newEntry));
-    touchedTypes.insert(static_cast<int>(newEntry.type));
-
-    auto entry = getByPath(pathStr);
-    if (!entry) {
-      return;
-    }
-
-    if (entry->type == FileType::MODEL_3D) {
+    auto &entry = storeEntry(pathStr, std::move(newEntry));
+    if (entry.type == FileType::MODEL_3D) {
       modelReloadPaths.push_back(pathStr);
       return;
     }
 
-    if (entry->type == FileType::IMAGE || entry->type == FileType::PREFAB) {
-      reloadEntry(*entry, entry->path);
-      if (entry->type == FileType::PREFAB && entry->prefab) {
-        entry->conf.uuid = entry->prefab->uuid.value;
+    if (entry.type == FileType::IMAGE) {
+      reloadEntry(entry, entry.path);
+    }
+    if (entry.type == FileType::PREFAB) {
+      reloadEntry(entry, entry.path);
+      if (entry.prefab && entry.prefab->uuid.value != entry.getUUID()) {
+        auto it = entriesMap.find(entry.getUUID());
+        if (it != entriesMap.end() && it->second == &entry) entriesMap.erase(it);
+        entry.conf.uuid = entry.prefab->uuid.value;
+        entriesMap[entry.getUUID()] = &entry;
       }
     }
   };
@@ -481,10 +960,7 @@ bool Project::AssetManager::pollWatch()
     if (!buildCodeEntry(fs::path{pathStr}, newEntry)) {
       return;
     }
-
-    removeEntryByPath(pathStr);
-    entries[static_cast<int>(newEntry.type)].push_back(std::move(newEntry));
-    touchedTypes.insert(static_cast<int>(newEntry.type));
+    storeEntry(pathStr, std::move(newEntry));
   };
 
   // Add or update all the assets and scripts that were found
@@ -509,32 +985,15 @@ bool Project::AssetManager::pollWatch()
     }
   }
 
-  //sort by name
-  for (size_t typeIdx = 0; typeIdx < entries.size(); ++typeIdx) {
-    if (touchedTypes.find(static_cast<int>(typeIdx)) == touchedTypes.end()) {
-      continue;
-    }
-    auto &typed = entries[typeIdx];
-    std::sort(typed.begin(), typed.end(), [](const AssetManagerEntry &a, const AssetManagerEntry &b) {
-      return a.name < b.name;
-    });
-  }
-
-  // Rebuild UUID lookup after edits
-  entriesMap.clear();
-  for (auto &typed : entries) {
-    int idx = 0;
-    for (auto &entry : typed) {
-      entriesMap[entry.getUUID()] = {(int)entry.type, idx};
-      ++idx;
-    }
-  }
-
-  // Update watcher snapshot for next poll
-  watchFiles = std::move(currentFiles);
   return true;
 }
 
+void Project::AssetManager::requestTexture(AssetManagerEntry &entry) {
+  if (entry.type != FileType::IMAGE || !ctx.window) return;
+  if (entry.texture && entry.texture != getFallbackTexture()) return;
+  reloadEntry(entry, entry.path);
+}
+
 void Project::AssetManager::reloadAssetByUUID(uint64_t uuid) {
   auto asset = getEntryByUUID(uuid);
   if (!asset)return;
@@ -638,13 +1097,6 @@ uint64_t Project::AssetManager::createNodeGraph(const std::string &name)
 
 Project::AssetManagerEntry *Project::AssetManager::getByPath(const std::string &path)
 {
-  fs::path pathIn{path};
-  for (auto &typed : entries) {
-    for (auto &entry : typed) {
-      if (fs::path{entry.path} == pathIn) {
-        return &entry;
-      }
-    }
-  }
-  return nullptr;
+  auto it = entriesPathMap.find(getPathKey(path));
+  return it == entriesPathMap.end() ? nullptr : it->second;
 }
\ No newline at end of file
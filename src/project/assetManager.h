@@ -3,6 +3,11 @@
 * @license MIT
 */
 #pragma once
+#include <atomic>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,6 +16,7 @@
 #include "../renderer/n64Mesh.h"
 #include "../renderer/object.h"
 #include "../utils/codeParser.h"
+#include "../utils/fileWatcher.h"
 #include "../renderer/texture.h"
 #include "scene/prefab.h"
 #include "tiny3d/tools/gltf_importer/src/structs.h"
@@ -47,9 +53,29 @@ namespace Project
   {
     uint64_t uuid{0};
     int format{0};
+    PROP_STRING(atlasGroup); // images with the same group are packed into one sprite, see 'Build::assignAtlases'
     int baseScale{0};
     bool gltfBVH{0};
+    Property<bool> gltfBVHAuto{"gltfBVHAuto", true}; // enables the BVH for large models at build time, see 'Build::needsBVH'
+    PROP_BOOL(gltfSplitMeshes); // see 'Build::splitLargeMeshes'
+    PROP_BOOL(gltfVertexCache); // reorders triangles to reduce vertex loads, see 'Build::optimizeVertexCache'
     PROP_BOOL(gltfCollision);
+    PROP_BOOL(gltfCollSimplify); // merges coplanar and drops tiny triangles of collision meshes
+    PROP_U32(gltfCollLeafSize); // triangles per BVH leaf, 0 for the default
+    PROP_BOOL(gltfCollQuantize); // stores collision vertices as int16 (scaled by 'collScale') instead of floats
+    PROP_U32(gltfAnimRate); // keyframe sample-rate, 0 for the default
+    PROP_BOOL(gltfAnimAuto); // picks the rate at build time instead, see 'Build::analyzeAnimations'
+    PROP_U32(gltfAnimMaxErr); // max. bone rotation error of 'gltfAnimAuto' in 1/10th degrees, 0 for the default
+    PROP_BOOL(gltfBakeLight); // bakes the lights of 'gltfBakeScene' into vertex colors, drawn unlit
+    PROP_S32(gltfBakeScene);
+
+    uint32_t getAnimSampleRate() const {
+      return gltfAnimRate.value ? gltfAnimRate.value : 60;
+    }
+
+    float getAnimMaxError() const {
+      return (gltfAnimMaxErr.value ? gltfAnimMaxErr.value : 5) / 10.0f;
+    }
 
     ComprTypes compression{ComprTypes::DEFAULT};
     bool exclude{false};
@@ -57,9 +83,14 @@ namespace Project
     PROP_BOOL(wavForceMono);
     PROP_U32(wavResampleRate);
     PROP_S32(wavCompression);
+    PROP_BOOL(wavLoop);
+    PROP_U32(wavLoopOffset); // loop start in samples
 
     PROP_U32(fontId);
     PROP_STRING(fontCharset);
+    PROP_BOOL(fontCharsetAuto); // only keeps glyphs of the charset the project uses, see 'Build::buildFontAssets'
+
+    PROP_U32(prefabPoolSize);
 
     std::string serialize() const;
   };
@@ -73,6 +104,7 @@ namespace Project
     FileType type{};
     std::shared_ptr<Renderer::Texture> texture{nullptr};
     T3DM::T3DMData t3dmData{};
+    std::string t3dmParseKey{}; // 'getT3DMParseKey()' at the time 't3dmData' was parsed
     std::shared_ptr<Renderer::N64Mesh> mesh3D{};
     std::shared_ptr<Prefab> prefab{nullptr};
     AssetConf conf{};
@@ -80,27 +112,154 @@ namespace Project
 
     uint64_t getUUID() const { return conf.uuid; }
 
+    /**
+     * Source file state and importer settings of a model,
+     * builds can reuse 't3dmData' instead of parsing again as long as this matches 't3dmParseKey'.
+     */
+    std::string getT3DMParseKey() const;
+
     // imgui selectbox:
     uint64_t getId() const { return conf.uuid; }
     const std::string &getName() const { return name; }
   };
 
+  /**
+   * Entries of one type, sorted by name.
+   * Each entry is allocated on its own, so references to it stay valid while others get added or removed.
+   */
+  class AssetEntryList
+  {
+    private:
+      std::vector<std::shared_ptr<AssetManagerEntry>> items{};
+
+      template<typename T, typename It>
+      struct Iter
+      {
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::remove_const_t<T>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        It it{};
+
+        T& operator*() const { return **it; }
+        T* operator->() const { return it->get(); }
+        Iter& operator++() { ++it; return *this; }
+        Iter operator++(int) { auto res = *this; ++it; return res; }
+        bool operator==(const Iter &other) const = default;
+      };
+
+    public:
+      using iterator = Iter<AssetManagerEntry, std::vector<std::shared_ptr<AssetManagerEntry>>::iterator>;
+      using const_iterator = Iter<const AssetManagerEntry, std::vector<std::shared_ptr<AssetManagerEntry>>::const_iterator>;
+
+      iterator begin() { return {items.begin()}; }
+      iterator end() { return {items.end()}; }
+      const_iterator begin() const { return {items.cbegin()}; }
+      const_iterator end() const { return {items.cend()}; }
+
+      [[nodiscard]] size_t size() const { return items.size(); }
+      [[nodiscard]] bool empty() const { return items.empty(); }
+      AssetManagerEntry& operator[](size_t idx) { return *items[idx]; }
+      const AssetManagerEntry& operator[](size_t idx) const { return *items[idx]; }
+
+      /**
+       * Adds an entry at its sorted position, after any with the same name.
+       */
+      AssetManagerEntry& insert(AssetManagerEntry &&entry);
+      void erase(const AssetManagerEntry *entry);
+      void clear() { items.clear(); }
+
+      /**
+       * First entry with the given name, nullptr if none.
+       */
+      AssetManagerEntry* findByName(const std::string &name) const;
+  };
+
   class AssetManager
   {
     private:
       Project *project;
-      std::array<std::vector<AssetManagerEntry>, static_cast<size_t>(FileType::_SIZE)> entries{};
+      std::array<AssetEntryList, static_cast<size_t>(FileType::_SIZE)> entries{};
 
       std::unordered_map<std::string, uint64_t> watchFiles{};
       std::chrono::steady_clock::time_point watchLastCheck{};
       bool watchInitialized{false};
+      Utils::FileWatcher watcher{};
+      bool watcherStarted{false};
 
       std::string defaultScript{};
       std::shared_ptr<Renderer::Texture> fallbackTex{};
 
+      // lookup by normalised path, like 'entriesMap'
+      std::unordered_map<std::string, AssetManagerEntry*> entriesPathMap{};
+
       void reloadEntry(AssetManagerEntry &entry, const std::string &path);
+
+      // keeps the lookups in sync, only touches the rows of that one entry
+      AssetManagerEntry& addEntry(AssetManagerEntry &&entry);
+      void removeEntry(AssetManagerEntry *entry);
+
+      /**
+       * Models of a 'reload' and the images they use, parsed/decoded on worker threads.
+       * Results are handed to the entries (and GPU) on the main thread in 'pollLoading'.
+       */
+      struct BackgroundLoad
+      {
+        struct Image { std::string path{}; bool isMono{}; SDL_Surface *img{nullptr}; };
+        struct Model
+        {
+          std::string path{};
+          float baseScale{};
+          int animSampleRate{};
+          bool createBVH{};
+          bool splitMeshes{};
+          std::string parseKey{};
+          T3DM::T3DMData data{};
+          std::string error{};
+        };
+
+        std::string assetPathFull{};
+        std::vector<Image> images{};
+        std::vector<Model> models{};
+        std::atomic<size_t> nextImage{0};
+        std::atomic_bool cancel{false};
+        std::atomic_bool modelsDone{false};
+        bool imagesQueued{false};
+
+        std::mutex mtx{};
+        std::vector<size_t> imagesDone{}; // indices into 'images', guarded by 'mtx'
+        size_t imagesApplied{0};
+
+        std::vector<std::future<void>> tasks{};
+      };
+      std::unique_ptr<BackgroundLoad> loading{};
+
+      void startLoading(std::unique_ptr<BackgroundLoad> load);
+      void startImageLoading();
+      void cancelLoading();
+
+      /**
+       * Single model parsed again on a worker thread after it or its settings changed.
+       * The entry keeps its previous mesh until the result is applied in 'pollLoading'.
+       */
+      struct ModelImport
+      {
+        BackgroundLoad::Model model{};
+        std::string assetPathFull{};
+        std::chrono::steady_clock::time_point startTime{};
+        std::atomic_bool done{false};
+        bool cancel{false}; // result is thrown away, the parse itself can't be stopped
+        std::future<void> task{};
+      };
+      std::vector<std::unique_ptr<ModelImport>> imports{};
+
+      void startImport(AssetManagerEntry &entry);
+      bool pollImports();
+      void cancelImports();
     public:
-      std::unordered_map<uint64_t, std::pair<int, int>> entriesMap{};
+      std::unordered_map<uint64_t, AssetManagerEntry*> entriesMap{};
       //std::unordered_map<uint64_t, int> entriesMapScript{};
 
       explicit AssetManager(Project *pr);
@@ -108,21 +267,52 @@ namespace Project
 
       void reload();
       void reloadAssetByUUID(uint64_t uuid);
+
+      /**
+       * Parses a model with the settings of its entry, but a different sample-rate.
+       * Same as any other parse, this is taken from the shared cache if enabled.
+       */
+      static T3DM::T3DMData parseModel(const AssetManagerEntry &entry, int animSampleRate, const std::string &assetPathFull);
+
+      /**
+       * Keeps parsed models in memory, shared between all projects.
+       * A project loaded again (e.g. by the build server) then only parses models that changed.
+       */
+      static void setParseCacheEnabled(bool enabled);
       bool pollWatch();
 
+      /**
+       * Finishes what 'reload' loads in the background, call once per frame from the main thread.
+       * Textures of models show the fallback until then, models have no mesh yet.
+       * @return true while still loading
+       */
+      bool pollLoading();
+      [[nodiscard]] bool isLoading() const { return loading != nullptr; }
+
+      /**
+       * @return seconds the import of a model runs for, negative if none is running
+       */
+      [[nodiscard]] float getImportTime(const AssetManagerEntry &entry) const;
+      // keeps the current mesh of the model, a later change imports it again
+      void cancelImport(const AssetManagerEntry &entry);
+
+      /**
+       * Loads the full texture of an image if not done yet, until then it shows the fallback texture.
+       */
+      void requestTexture(AssetManagerEntry &entry);
+
       [[nodiscard]] const auto& getEntries() const {
         return entries;
       }
-      [[nodiscard]] const std::vector<AssetManagerEntry>& getTypeEntries(FileType type) const {
+      [[nodiscard]] const AssetEntryList& getTypeEntries(FileType type) const {
         return entries[static_cast<int>(type)];
       }
 
       AssetManagerEntry* getByName(const std::string &name) {
+        // lists are sorted by name already
         for (auto &typed : entries) {
-          for (auto &entry : typed) {
-            if (entry.name == name) {
-              return &entry;
-            }
+          if (auto entry = typed.findByName(name)) {
+            return entry;
           }
         }
         return nullptr;
@@ -135,7 +325,7 @@ namespace Project
         if (it == entriesMap.end()) {
           return nullptr;
         }
-        return &entries[it->second.first][it->second.second];
+        return it->second;
       }
 
       std::shared_ptr<Prefab> getPrefabByUUID(uint64_t uuid) {
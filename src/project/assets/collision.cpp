@@ -10,6 +10,7 @@
 #include "bvh/v2/node.h"
 #include "bvh/v2/default_builder.h"
 
+#include <algorithm>
 #include <vector>
 
 using Scalar  = double;
@@ -84,7 +85,8 @@ namespace
 
 std::vector<int16_t> Project::Assets::Collision::createBVH(
   const std::vector<glm::i16vec3> &vertices,
-  const std::vector<uint16_t> &indices
+  const std::vector<uint16_t> &indices,
+  uint32_t maxLeafSize
 ) {
   std::vector<BBox> aabbs;
   std::vector<BVec3> centers;
@@ -105,6 +107,8 @@ std::vector<int16_t> Project::Assets::Collision::createBVH(
   bvh::v2::ThreadPool thread_pool;
   typename bvh::v2::DefaultBuilder<Node>::Config config;
   config.quality = bvh::v2::DefaultBuilder<Node>::Quality::High;
+  config.max_leaf_size = maxLeafSize;
+  config.min_leaf_size = std::min<size_t>(config.min_leaf_size, maxLeafSize);
   auto bvh = bvh::v2::DefaultBuilder<Node>::build(thread_pool, aabbs, centers, config);
 
   std::vector<int16_t> treeData;
@@ -9,8 +9,13 @@
 
 namespace Project::Assets::Collision
 {
+  /**
+   * Builds the BVH of a collision mesh using the surface area heuristic.
+   * @param maxLeafSize triangles per leaf, larger leaves mean fewer nodes but more triangle tests per query (1-15)
+   */
   std::vector<int16_t> createBVH(
     const std::vector<glm::i16vec3> &vertices,
-    const std::vector<uint16_t> &indices
+    const std::vector<uint16_t> &indices,
+    uint32_t maxLeafSize
   );
 }
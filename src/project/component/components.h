@@ -20,6 +20,9 @@ struct SDL_GPUGraphicsPipeline;
 struct SDL_GPURenderPass;
 
 namespace Project { class Object; }
+namespace Renderer { struct Light; }
+namespace Utils { struct AABB; struct Frustum; }
+namespace Build { struct DrawCost; }
 
 namespace Project::Component
 {
@@ -68,16 +71,56 @@ namespace Project::Component
 
   MAKE_COMP(Code)
   MAKE_COMP(Model)
+  namespace Model
+  {
+    /**
+     * Adds the meshes drawn by the component to the estimate, see 'Build::estimateDrawCost'.
+     * @param view only counts it if the bounds are inside, null for always
+     */
+    void addDrawCost(Object& obj, Entry &entry, const Utils::Frustum* view, Build::DrawCost &cost);
+  }
   MAKE_COMP(Light)
+
+  namespace Light
+  {
+    /**
+     * Resolved light of a component (incl. overrides), also used to bake lights into models.
+     */
+    void getLight(Object& obj, Entry &entry, Renderer::Light &light);
+  }
   MAKE_COMP(Camera)
+  namespace Camera
+  {
+    /**
+     * View frustum of the camera at its placement in the editor.
+     * @param defAspect used if neither the aspect nor the viewport size are set
+     */
+    void getFrustum(Object& obj, Entry &entry, float defAspect, Utils::Frustum &frustum);
+  }
   MAKE_COMP(CollMesh)
   MAKE_COMP(CollBody)
   MAKE_COMP(Audio2D)
   MAKE_COMP(Constraint)
   MAKE_COMP(Culling)
+
+  namespace Culling
+  {
+    /**
+     * World-space box around the culling volume, used to compute group bounds.
+     * @return false for groups, their bounds come from the children instead
+     */
+    bool getWorldBounds(Object& obj, Entry &entry, Utils::AABB &bounds);
+  }
   MAKE_COMP(NodeGraph)
   MAKE_COMP(AnimModel)
+  namespace AnimModel
+  {
+    // same as 'Model::addDrawCost', incl. the bone matrices
+    void addDrawCost(Object& obj, Entry &entry, const Utils::Frustum* view, Build::DrawCost &cost);
+  }
   MAKE_COMP(Outline)
+  MAKE_COMP(Audio3D)
+  MAKE_COMP(ParticleEmitter)
 
   constexpr std::array TABLE{
     CompInfo{
@@ -214,6 +257,28 @@ namespace Project::Component
       .funcSerialize = Outline::serialize,
       .funcDeserialize = Outline::deserialize,
       .funcBuild = Outline::build
+    },
+    CompInfo{
+      .id = 12,
+      .icon = ICON_MDI_SPEAKER_WIRELESS " ",
+      .name = "Audio (3D)",
+      .funcInit = Audio3D::init,
+      .funcDraw = Audio3D::draw,
+      .funcDrawPost3D = Audio3D::draw3D,
+      .funcSerialize = Audio3D::serialize,
+      .funcDeserialize = Audio3D::deserialize,
+      .funcBuild = Audio3D::build
+    },
+    CompInfo{
+      .id = 13,
+      .icon = ICON_MDI_SHIMMER " ",
+      .name = "Particle Emitter",
+      .funcInit = ParticleEmitter::init,
+      .funcDraw = ParticleEmitter::draw,
+      .funcDrawPost3D = ParticleEmitter::draw3D,
+      .funcSerialize = ParticleEmitter::serialize,
+      .funcDeserialize = ParticleEmitter::deserialize,
+      .funcBuild = ParticleEmitter::build
     }
   };
 
@@ -24,6 +24,10 @@ namespace Project::Component::Shared
     PROP_STRING(meshFilter);
     std::vector<uint32_t> cache{};
 
+    MeshFilter() = default;
+    // custom property name, needed if a component has multiple filters
+    explicit MeshFilter(const char* propName) : meshFilter{propName} {}
+
     const std::vector<uint32_t>& filterT3DM(const std::vector<T3DM::Model> &models, Object& obj, bool withMaterial);
   };
 }
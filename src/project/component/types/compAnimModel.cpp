@@ -20,6 +20,9 @@
 #include "glm/gtx/matrix_decompose.hpp"
 
 #include "../shared/meshFilter.h"
+#include "../../../build/projectBuilder.h"
+#include "../../../utils/frustum.h"
+#include <algorithm>
 
 namespace Project::Component::AnimModel
 {
@@ -27,6 +30,9 @@ namespace Project::Component::AnimModel
   {
     PROP_U64(model);
     PROP_S32(layerIdx);
+    PROP_BOOL(skipCulled);
+    PROP_FLOAT(lodDist);
+    PROP_S32(lodRate);
 
     Shared::Material material{};
 
@@ -44,6 +50,9 @@ namespace Project::Component::AnimModel
     return Utils::JSON::Builder{}
       .set(data.model)
       .set(data.layerIdx)
+      .set(data.skipCulled)
+      .set(data.lodDist)
+      .set(data.lodRate)
       .set("material", data.material.serialize())
       .doc;
   }
@@ -52,6 +61,9 @@ namespace Project::Component::AnimModel
     auto data = std::make_shared<Data>();
     Utils::JSON::readProp(doc, data->layerIdx);
     Utils::JSON::readProp(doc, data->model);
+    Utils::JSON::readProp(doc, data->skipCulled, false);
+    Utils::JSON::readProp(doc, data->lodDist, 0.0f);
+    Utils::JSON::readProp(doc, data->lodRate, 15);
 
     data->material.deserialize(
       doc.value("material", nlohmann::json::object())
@@ -63,7 +75,7 @@ namespace Project::Component::AnimModel
   {
     Data &data = *static_cast<Data*>(entry.data.get());
 
-    auto res = ctx.assetUUIDToIdx.find(data.model.value);
+    auto res = ctx.findAsset(data.model.value);
     uint16_t id = 0xDEAD;
     if (res == ctx.assetUUIDToIdx.end()) {
       Utils::Logger::log("Component Model: Model UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
@@ -73,8 +85,34 @@ namespace Project::Component::AnimModel
 
     ctx.fileObj.write<uint16_t>(id);
     ctx.fileObj.write<uint8_t>(data.layerIdx.resolve(obj));
-    ctx.fileObj.write<uint8_t>(0); // flags, unused
+    uint8_t flags = 0;
+    if(data.skipCulled.resolve(obj))flags |= 1 << 0;
+    ctx.fileObj.write<uint8_t>(flags);
     data.material.build(ctx.fileObj, obj);
+    ctx.fileObj.write<float>(data.lodDist.resolve(obj));
+    ctx.fileObj.write<uint8_t>(std::clamp(data.lodRate.resolve(obj), 1, 60));
+  }
+
+  void addDrawCost(Object& obj, Entry &entry, const Utils::Frustum* view, Build::DrawCost &cost)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    auto asset = ctx.project->getAssets().getEntryByUUID(data.model.value);
+    if(!asset || asset->t3dmData.models.empty())return;
+
+    if(view && asset->mesh3D) {
+      glm::vec3 skew{0,0,0};
+      glm::vec4 persp{0,0,0,1};
+      glm::mat4 mat = glm::recompose(obj.scale.resolve(obj), obj.rot.resolve(obj), obj.pos.resolve(obj), skew, persp);
+      // mesh bounds are in model units, see 'Viewport3D::isVisible'
+      mat[0] *= 65536.0f;
+      mat[1] *= 65536.0f;
+      mat[2] *= 65536.0f;
+      if(!view->isVisible(asset->mesh3D->getAABB(), mat))return;
+    }
+
+    ++cost.objects;
+    cost.matrices += 1 + asset->t3dmData.skeletons.size();
+    cost.addMeshes(asset->t3dmData, {});
   }
 
   void draw(Object &obj, Entry &entry)
@@ -99,6 +137,11 @@ namespace Project::Component::AnimModel
           return ImGui::Combo("##", layer, layerNames.data(), layerNames.size());
         }, nullptr);
 
+      ImTable::addObjProp("Skip Culled", data.skipCulled);
+      ImTable::addObjProp("Anim-LOD Dist.", data.lodDist);
+      if(data.lodDist.resolve(obj) > 0.0f) {
+        ImTable::addObjProp("Anim-LOD Rate", data.lodRate);
+      }
 
       ImTable::end();
 
@@ -176,7 +219,7 @@ namespace Project::Component::AnimModel
 
     data.obj3D.draw(pass, cmdBuff);
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
+    bool isSelected = ctx.isObjectSelected(obj.uuid);
     if (isSelected)
     {
       Utils::AABB aabb = data.aabb;
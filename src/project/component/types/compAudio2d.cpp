@@ -13,6 +13,7 @@
 #include "../../../editor/pages/parts/viewport3D.h"
 #include "../../../renderer/scene.h"
 #include "../../../utils/meshGen.h"
+#include <algorithm>
 
 namespace Project::Component::Audio2D
 {
@@ -22,6 +23,8 @@ namespace Project::Component::Audio2D
     PROP_FLOAT(volume);
     PROP_BOOL(loop);
     PROP_BOOL(autoPlay);
+    PROP_S32(priority);
+    PROP_S32(maxInstances);
   };
 
   std::shared_ptr<void> init(Object &obj) {
@@ -36,6 +39,8 @@ namespace Project::Component::Audio2D
     builder.set(data.volume);
     builder.set(data.loop);
     builder.set(data.autoPlay);
+    builder.set(data.priority);
+    builder.set(data.maxInstances);
     return builder.doc;
   }
 
@@ -45,6 +50,8 @@ namespace Project::Component::Audio2D
     Utils::JSON::readProp(doc, data->volume, 1.0f);
     Utils::JSON::readProp(doc, data->loop);
     Utils::JSON::readProp(doc, data->autoPlay);
+    Utils::JSON::readProp(doc, data->priority, 128);
+    Utils::JSON::readProp(doc, data->maxInstances, 0);
     return data;
   }
 
@@ -52,7 +59,7 @@ namespace Project::Component::Audio2D
   {
     Data &data = *static_cast<Data*>(entry.data.get());
 
-    auto res = ctx.assetUUIDToIdx.find(data.audioUUID.value);
+    auto res = ctx.findAsset(data.audioUUID.value);
     uint16_t id = 0xDEAD;
     if (res == ctx.assetUUIDToIdx.end()) {
       Utils::Logger::log("Component Model: Audio UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
@@ -67,6 +74,8 @@ namespace Project::Component::Audio2D
     ctx.fileObj.write<uint16_t>(id);
     ctx.fileObj.write<uint16_t>((uint16_t)(data.volume.value * 0xFFFF));
     ctx.fileObj.write<uint8_t>(flags);
+    ctx.fileObj.write<uint8_t>(std::clamp(data.priority.value, 0, 255));
+    ctx.fileObj.write<uint8_t>(std::clamp(data.maxInstances.value, 0, 255));
     ctx.fileObj.write<uint8_t>(0); // padding
   }
 
@@ -82,6 +91,8 @@ namespace Project::Component::Audio2D
       ImTable::addProp("Volume", data.volume);
       ImTable::addProp("Loop", data.loop);
       ImTable::addProp("Auto-Play", data.autoPlay);
+      ImTable::addProp("Priority", data.priority);
+      ImTable::addProp("Max. Instances", data.maxInstances);
 
       ImTable::end();
     }
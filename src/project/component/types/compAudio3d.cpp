@@ -0,0 +1,125 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "../components.h"
+#include "../../../context.h"
+#include "../../../editor/imgui/helper.h"
+#include "../../../utils/json.h"
+#include "../../../utils/jsonBuilder.h"
+#include "../../../utils/binaryFile.h"
+#include "../../../utils/logger.h"
+#include "../../assetManager.h"
+#include "../../../editor/pages/parts/viewport3D.h"
+#include "../../../renderer/scene.h"
+#include "../../../utils/meshGen.h"
+#include <algorithm>
+
+namespace Project::Component::Audio3D
+{
+  struct Data
+  {
+    PROP_U64(audioUUID);
+    PROP_FLOAT(volume);
+    PROP_FLOAT(distMin);
+    PROP_FLOAT(distMax);
+    PROP_BOOL(loop);
+    PROP_BOOL(autoPlay);
+    PROP_S32(priority);
+    PROP_S32(maxInstances);
+  };
+
+  std::shared_ptr<void> init(Object &obj) {
+    auto data = std::make_shared<Data>();
+    data->volume.value = 1.0f;
+    data->distMin.value = 50.0f;
+    data->distMax.value = 500.0f;
+    data->priority.value = 128;
+    return data;
+  }
+
+  nlohmann::json serialize(const Entry &entry) {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    Utils::JSON::Builder builder{};
+    builder.set(data.audioUUID);
+    builder.set(data.volume);
+    builder.set(data.distMin);
+    builder.set(data.distMax);
+    builder.set(data.loop);
+    builder.set(data.autoPlay);
+    builder.set(data.priority);
+    builder.set(data.maxInstances);
+    return builder.doc;
+  }
+
+  std::shared_ptr<void> deserialize(nlohmann::json &doc) {
+    auto data = std::make_shared<Data>();
+    Utils::JSON::readProp(doc, data->audioUUID);
+    Utils::JSON::readProp(doc, data->volume, 1.0f);
+    Utils::JSON::readProp(doc, data->distMin, 50.0f);
+    Utils::JSON::readProp(doc, data->distMax, 500.0f);
+    Utils::JSON::readProp(doc, data->loop);
+    Utils::JSON::readProp(doc, data->autoPlay);
+    Utils::JSON::readProp(doc, data->priority, 128);
+    Utils::JSON::readProp(doc, data->maxInstances, 0);
+    return data;
+  }
+
+  void build(Object&, Entry &entry, Build::SceneCtx &ctx)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+
+    auto res = ctx.findAsset(data.audioUUID.value);
+    uint16_t id = 0xDEAD;
+    if (res == ctx.assetUUIDToIdx.end()) {
+      Utils::Logger::log("Component Audio3D: Audio UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
+    } else {
+      id = res->second;
+    }
+
+    uint8_t flags = 0;
+    if(data.loop.value)flags |= 1 << 0;
+    if(data.autoPlay.value)flags |= 1 << 1;
+
+    ctx.fileObj.write<uint16_t>(id);
+    ctx.fileObj.write<uint16_t>((uint16_t)(std::clamp(data.volume.value, 0.0f, 1.0f) * 0xFFFF));
+    ctx.fileObj.write<float>(std::max(data.distMin.value, 0.0f));
+    ctx.fileObj.write<float>(std::max(data.distMax.value, data.distMin.value));
+    ctx.fileObj.write<uint8_t>(flags);
+    ctx.fileObj.write<uint8_t>(std::clamp(data.priority.value, 0, 255));
+    ctx.fileObj.write<uint8_t>(std::clamp(data.maxInstances.value, 0, 255));
+    ctx.fileObj.write<uint8_t>(0); // padding
+  }
+
+  void draw(Object &obj, Entry &entry)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+
+    if (ImTable::start("Comp", &obj)) {
+      ImTable::add("Name", entry.name);
+
+      auto &audioList = ctx.project->getAssets().getTypeEntries(FileType::AUDIO);
+      ImTable::addAssetVecComboBox("Audio", audioList, data.audioUUID.value);
+      ImTable::addProp("Volume", data.volume);
+      ImTable::addProp("Dist. Min", data.distMin);
+      ImTable::addProp("Dist. Max", data.distMax);
+      ImTable::addProp("Loop", data.loop);
+      ImTable::addProp("Auto-Play", data.autoPlay);
+      ImTable::addProp("Priority", data.priority);
+      ImTable::addProp("Max. Instances", data.maxInstances);
+
+      ImTable::end();
+    }
+  }
+
+  void draw3D(Object& obj, Entry &entry, Editor::Viewport3D &vp, SDL_GPUCommandBuffer* cmdBuff, SDL_GPURenderPass* pass)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    auto &pos = obj.pos.resolve(obj.propOverrides);
+    Utils::Mesh::addSprite(*vp.getSprites(), pos, obj.uuid, 4);
+
+    // full volume inside the inner sphere, silent (and virtualized) outside the outer one
+    Utils::Mesh::addLineSphere(*vp.getLines(), pos, glm::vec3{data.distMin.value}, {0x55, 0xAA, 0xFF, 0xFF});
+    Utils::Mesh::addLineSphere(*vp.getLines(), pos, glm::vec3{data.distMax.value}, {0x22, 0x44, 0x88, 0xFF});
+  }
+}
@@ -13,9 +13,12 @@
 #include "../../../editor/pages/parts/viewport3D.h"
 #include "../../../renderer/scene.h"
 #include "../../../utils/meshGen.h"
+#include "../../../utils/frustum.h"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/matrix_decompose.hpp"
+#include "glm/ext/matrix_clip_space.hpp"
+#include "glm/ext/matrix_transform.hpp"
 
 namespace
 {
@@ -40,6 +43,7 @@ namespace Project::Component::Camera
     PROP_FLOAT(near);
     PROP_FLOAT(far);
     PROP_FLOAT(aspect);
+    PROP_U32(layerMask);
   };
 
   std::shared_ptr<void> init(Object &obj) {
@@ -57,6 +61,7 @@ namespace Project::Component::Camera
     builder.set(data.near);
     builder.set(data.far);
     builder.set(data.aspect);
+    builder.set(data.layerMask);
     return builder.doc;
   }
 
@@ -68,6 +73,7 @@ namespace Project::Component::Camera
     Utils::JSON::readProp(doc, data->near, 100.0f);
     Utils::JSON::readProp(doc, data->far, 1000.0f);
     Utils::JSON::readProp(doc, data->aspect, 0.0f);
+    Utils::JSON::readProp(doc, data->layerMask, 0xFFu);
     return data;
   }
 
@@ -81,6 +87,24 @@ namespace Project::Component::Camera
     ctx.fileObj.write<float>(data.near.resolve(obj));
     ctx.fileObj.write<float>(data.far.resolve(obj));
     ctx.fileObj.write<float>(data.aspect.resolve(obj));
+    ctx.fileObj.write<uint32_t>(data.layerMask.resolve(obj));
+  }
+
+  void getFrustum(Object& obj, Entry &entry, float defAspect, Utils::Frustum &frustum)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+
+    float aspect = data.aspect.resolve(obj);
+    auto vpSize = data.vpSize.resolve(obj);
+    if(aspect <= 0.0f) {
+      aspect = (vpSize.x > 0 && vpSize.y > 0) ? ((float)vpSize.x / (float)vpSize.y) : defAspect;
+    }
+
+    auto pos = obj.pos.resolve(obj);
+    auto rot = obj.rot.resolve(obj);
+    auto view = glm::lookAt(pos, pos + rot * glm::vec3{0,0,-1}, rot * glm::vec3{0,1,0});
+    auto proj = glm::perspective(glm::radians(data.fov.resolve(obj)), aspect, data.near.resolve(obj), data.far.resolve(obj));
+    frustum.fromMatrix(proj * view);
   }
 
   void update(Object &obj, Entry &entry)
@@ -112,6 +136,8 @@ namespace Project::Component::Camera
       ImTable::addObjProp("Far", data.far);
 
       ImTable::addObjProp("Aspect", data.aspect);
+      // secondary cameras (e.g. a minimap) can skip layers with details
+      ImTable::addBitMask8("Draw-Layers", data.layerMask.resolve(obj.propOverrides));
       //ImTable::addComboBox("Type", data.type, LIGHT_TYPES, LIGHT_TYPE_COUNT);
       ImTable::end();
     }
@@ -60,6 +60,7 @@ namespace Project::Component::Code
       Utils::Logger::log("Component Code: Script UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
     } else {
       id = idRes->second;
+      ctx.sceneScripts.insert(data.scriptUUID);
     }
 
     ctx.fileObj.write<uint16_t>(id);
@@ -77,7 +78,8 @@ namespace Project::Component::Code
       if(field.type == Utils::DataType::ASSET_SPRITE)
       {
         uint64_t uuid = Utils::parseU64(val);
-        ctx.fileObj.write<uint32_t>(ctx.assetUUIDToIdx[uuid]);
+        auto res = ctx.findAsset(uuid);
+        ctx.fileObj.write<uint32_t>(res == ctx.assetUUIDToIdx.end() ? 0 : res->second);
       } else if(field.type == Utils::DataType::OBJECT_REF) {
         uint32_t uuid = static_cast<uint32_t>(Utils::parseU64(val));
         auto refObj = ctx.scene->getObjectByUUID(uuid);
@@ -22,9 +22,18 @@
 
 namespace Project::Component::CollMesh
 {
+  namespace
+  {
+    // size of a pre-decoded triangle at runtime (Coll::PackedTri)
+    constexpr uint32_t TRI_CACHE_ENTRY_SIZE = 13 * sizeof(float);
+  }
+
   struct Data
   {
     PROP_U64(modelUUID);
+    PROP_BOOL(isStatic);
+    PROP_BOOL(triCache);
+    PROP_U32(maskWrite);
     Shared::MeshFilter filter{};
     Renderer::Object obj3D{};
     Utils::AABB aabb{};
@@ -40,6 +49,9 @@ namespace Project::Component::CollMesh
     return Utils::JSON::Builder{}
       .set(data.modelUUID)
       .set(data.filter.meshFilter)
+      .set(data.isStatic)
+      .set(data.triCache)
+      .set(data.maskWrite)
       .doc;
   }
 
@@ -47,6 +59,9 @@ namespace Project::Component::CollMesh
     auto data = std::make_shared<Data>();
     Utils::JSON::readProp(doc, data->modelUUID);
     Utils::JSON::readProp(doc, data->filter.meshFilter);
+    Utils::JSON::readProp(doc, data->isStatic, false);
+    Utils::JSON::readProp(doc, data->triCache, false);
+    Utils::JSON::readProp(doc, data->maskWrite, 0xFFu);
     return data;
   }
 
@@ -86,7 +101,15 @@ namespace Project::Component::CollMesh
       }
     }
 
-    auto res = ctx.assetUUIDToIdx.find(modelUUID);
+    // static meshes get baked into world-space once at runtime, the object must not move
+    if(data.isStatic.resolve(obj.propOverrides)) {
+      flags |= 1 << 1;
+    }
+    if(data.triCache.resolve(obj.propOverrides)) {
+      flags |= 1 << 2;
+    }
+
+    auto res = ctx.findAsset(modelUUID);
     if (res == ctx.assetUUIDToIdx.end()) {
       Utils::Logger::log("Component Model: Model UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
     } else {
@@ -95,6 +118,7 @@ namespace Project::Component::CollMesh
 
     ctx.fileObj.write<uint16_t>(id);
     ctx.fileObj.write<uint8_t>(flags);
+    ctx.fileObj.write<uint8_t>(data.maskWrite.resolve(obj.propOverrides));
   }
 
   void draw(Object &obj, Entry &entry)
@@ -134,6 +158,23 @@ namespace Project::Component::CollMesh
         data.modelUUID.value = selModel->getUUID();
       }
 
+      ImTable::addObjProp("Static", data.isStatic);
+      ImTable::addObjProp("Tri-Cache", data.triCache);
+      ImTable::addBitMask8("Mask Write", data.maskWrite.resolve(obj.propOverrides));
+
+      if(selModel && data.triCache.resolve(obj.propOverrides)) {
+        // no filter means the entire model is used
+        auto &meshes = data.filter.filterT3DM(selModel->t3dmData.models, obj, false);
+        uint32_t triCount = 0;
+        if(meshes.empty()) {
+          for(auto &model : selModel->t3dmData.models)triCount += model.triangles.size();
+        } else {
+          for(auto idx : meshes)triCount += selModel->t3dmData.models[idx].triangles.size();
+        }
+        ImTable::add("Cache-Size");
+        ImGui::Text("%.2f KB", (double)(triCount * TRI_CACHE_ENTRY_SIZE) / 1024.0);
+      }
+
       ImTable::end();
 
       if(selModel && ImGui::CollapsingSubHeader("Mesh Filter", ImGuiTreeNodeFlags_DefaultOpen) && ImTable::start("Filter", &obj))
@@ -187,12 +228,16 @@ namespace Project::Component::CollMesh
     if (!asset || !asset->mesh3D) {
       return;
     }
+    if (!vp.isVisible(asset->mesh3D->getAABB(), data.obj3D.uniform.modelMat)) {
+      return;
+    }
     auto &meshes = data.filter.filterT3DM(asset->t3dmData.models, obj, false);
 
     data.obj3D.draw(pass, cmdBuff, meshes);
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
-    if (isSelected)
+    bool isSelected = ctx.isObjectSelected(obj.uuid);
+    bool isHovered = vp.getHoveredObjectUUID() == obj.uuid;
+    if (isSelected || isHovered)
     {
       auto center = obj.pos.resolve(obj.propOverrides) + (data.aabb.getCenter() * obj.scale.resolve(obj.propOverrides) * (float)0xFFFF);
       auto halfExt = data.aabb.getHalfExtend() * obj.scale.resolve(obj.propOverrides) * (float)0xFFFF;
@@ -12,6 +12,9 @@
 #include "../../../editor/pages/parts/viewport3D.h"
 #include "../../../renderer/scene.h"
 #include "../../../utils/meshGen.h"
+#include "../../../utils/logger.h"
+#include "../../../utils/aabb.h"
+#include "../../../build/projectBuilder.h"
 
 #include "../../../../n64/engine/include/collision/flags.h"
 
@@ -19,6 +22,35 @@ namespace
 {
   constexpr int32_t TYPE_BOX      = 0;
   constexpr int32_t TYPE_SPHERE   = 1;
+
+  constexpr int32_t CELL_COUNT    = 32;
+  constexpr uint8_t CELL_NONE     = 0xFF;
+
+  // parses a list of cell indices like "1, 2, 5" into a bitmask
+  uint32_t parseCellList(const std::string &list, uint64_t uuid)
+  {
+    uint32_t mask = 0;
+    std::string num{};
+    for(size_t i=0; i<=list.size(); ++i)
+    {
+      char c = i < list.size() ? list[i] : ',';
+      if(c >= '0' && c <= '9') {
+        num += c;
+        continue;
+      }
+      if(num.empty())continue;
+
+      int32_t cell = num.size() > 3 ? CELL_COUNT : std::stoi(num);
+      num.clear();
+      if(cell >= CELL_COUNT) {
+        Utils::Logger::log("Component Culling: cell index out of range: " + std::to_string(cell)
+          + " (" + std::to_string(uuid) + ")", Utils::Logger::LEVEL_ERROR);
+        continue;
+      }
+      mask |= 1u << cell;
+    }
+    return mask;
+  }
 }
 
 namespace Project::Component::Culling
@@ -28,6 +60,9 @@ namespace Project::Component::Culling
     PROP_VEC3(halfExtend);
     PROP_VEC3(offset);
     PROP_S32(type);
+    PROP_BOOL(group);
+    PROP_S32(cell);
+    PROP_STRING(visibleCells);
   };
 
   std::shared_ptr<void> init(Object &obj) {
@@ -41,6 +76,9 @@ namespace Project::Component::Culling
       .set(data.halfExtend)
       .set(data.offset)
       .set(data.type)
+      .set(data.group)
+      .set(data.cell)
+      .set(data.visibleCells)
       .doc;
   }
 
@@ -49,15 +87,74 @@ namespace Project::Component::Culling
     Utils::JSON::readProp(doc, data->halfExtend, glm::vec3{1.0f, 1.0f, 1.0f});
     Utils::JSON::readProp(doc, data->offset);
     Utils::JSON::readProp(doc, data->type);
+    Utils::JSON::readProp(doc, data->group, false);
+    Utils::JSON::readProp(doc, data->cell, -1);
+    Utils::JSON::readProp(doc, data->visibleCells);
     return data;
   }
 
+  bool getWorldBounds(Object& obj, Entry &entry, Utils::AABB &bounds)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    if(data.group.resolve(obj.propOverrides))return false;
+
+    auto &objPos = obj.pos.resolve(obj.propOverrides);
+    auto &objScale = obj.scale.resolve(obj.propOverrides);
+
+    glm::vec3 center = objPos + data.offset.resolve(obj.propOverrides) * objScale;
+    glm::vec3 halfExt = data.halfExtend.resolve(obj.propOverrides);
+    if(data.type.resolve(obj.propOverrides) == TYPE_SPHERE) {
+      halfExt = glm::vec3{halfExt.x * fmaxf(fmaxf(objScale.x, objScale.y), objScale.z)};
+    } else {
+      halfExt *= objScale;
+    }
+
+    bounds.addPoint(center - halfExt);
+    bounds.addPoint(center + halfExt);
+    return true;
+  }
+
   void build(Object& obj, Entry &entry, Build::SceneCtx &ctx)
   {
     Data &data = *static_cast<Data*>(entry.data.get());
-    ctx.fileObj.write(data.halfExtend.resolve(obj.propOverrides));
-    ctx.fileObj.write(data.offset.resolve(obj.propOverrides));
-    ctx.fileObj.write<uint8_t>(data.type.resolve(obj.propOverrides));
+    glm::vec3 halfExtend = data.halfExtend.resolve(obj.propOverrides);
+    glm::vec3 offset = data.offset.resolve(obj.propOverrides);
+    uint8_t type = data.type.resolve(obj.propOverrides);
+    uint8_t flags = 0;
+
+    if(data.group.resolve(obj.propOverrides))
+    {
+      // box around all children, stored relative to the object like a manual volume
+      Utils::AABB bounds{};
+      if(Build::getGroupBounds(ctx, obj, bounds))
+      {
+        auto &objPos = obj.pos.resolve(obj.propOverrides);
+        auto scale = obj.scale.resolve(obj.propOverrides);
+        if(scale.x == 0.0f || scale.y == 0.0f || scale.z == 0.0f)scale = {1.0f, 1.0f, 1.0f};
+
+        halfExtend = bounds.getHalfExtend() / scale;
+        offset = (bounds.getCenter() - objPos) / scale;
+        type = TYPE_BOX;
+        flags |= 1 << 0;
+      } else {
+        Utils::Logger::log("Component Culling: group without any culled children, using own volume: "
+          + std::to_string(entry.uuid), Utils::Logger::LEVEL_WARN);
+      }
+    }
+
+    ctx.fileObj.write(halfExtend);
+    ctx.fileObj.write(offset);
+    ctx.fileObj.write<uint8_t>(type);
+    ctx.fileObj.write<uint8_t>(flags);
+
+    auto cell = data.cell.resolve(obj.propOverrides);
+    if(cell >= CELL_COUNT) {
+      Utils::Logger::log("Component Culling: cell index out of range: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
+      cell = -1;
+    }
+    ctx.fileObj.write<uint8_t>(cell < 0 ? CELL_NONE : cell);
+    ctx.fileObj.write<uint8_t>(0); // padding
+    ctx.fileObj.write<uint32_t>(cell < 0 ? 0 : parseCellList(data.visibleCells.resolve(obj.propOverrides), entry.uuid));
   }
 
   void draw(Object &obj, Entry &entry)
@@ -78,6 +175,19 @@ namespace Project::Component::Culling
         ImTable::addObjProp("Size", data.halfExtend);
       }
       ImTable::addObjProp("Offset", data.offset);
+      ImTable::addObjProp("Group", data.group);
+      if(data.group.resolve(obj.propOverrides)) {
+        ImGui::SameLine();
+        ImGui::TextDisabled("Size from children on build");
+      }
+
+      ImTable::addObjProp("Cell", data.cell);
+      if(data.cell.resolve(obj.propOverrides) >= 0) {
+        ImTable::addObjProp("Visible Cells", data.visibleCells);
+      } else {
+        ImGui::SameLine();
+        ImGui::TextDisabled("-1 = none");
+      }
       ImTable::end();
     }
   }
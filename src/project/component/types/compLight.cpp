@@ -80,15 +80,22 @@ namespace Project::Component::Light
     ctx.fileObj.write<int8_t>(dir.z);
   }
 
-  void update(Object &obj, Entry &entry)
+  void getLight(Object &obj, Entry &entry, Renderer::Light &light)
   {
     Data &data = *static_cast<Data*>(entry.data.get());
-    ctx.scene->addLight(Renderer::Light{
+    light = {
       .color = data.color.resolve(obj.propOverrides),
       .pos = glm::vec4{obj.pos.resolve(obj.propOverrides), 0.0f},
       .dir = rotToDir(obj),
       .type = data.type.resolve(obj.propOverrides),
-    });
+    };
+  }
+
+  void update(Object &obj, Entry &entry)
+  {
+    Renderer::Light light{};
+    getLight(obj, entry, light);
+    ctx.scene->addLight(light);
   }
 
   void draw(Object &obj, Entry &entry) {
@@ -113,7 +120,7 @@ namespace Project::Component::Light
     constexpr float LINE_LEN = 75.0f;
     glm::u8vec4 col = data.color.resolve(obj.propOverrides) * 255.0f;
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
+    bool isSelected = ctx.isObjectSelected(obj.uuid);
 
     auto pos = obj.pos.resolve(obj.propOverrides);
     if(isSelected)
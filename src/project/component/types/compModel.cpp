@@ -10,6 +10,8 @@
 #include "../../../utils/binaryFile.h"
 #include "../../../utils/logger.h"
 #include "../../assetManager.h"
+#include "../../../build/projectBuilder.h"
+#include "../../../utils/frustum.h"
 #include "../../../editor/pages/parts/viewport3D.h"
 #include "../../../renderer/scene.h"
 #include "../../../utils/meshGen.h"
@@ -23,20 +25,41 @@
 
 namespace Project::Component::Model
 {
+  // levels of detail (incl. the base mesh-filter), must match the runtime
+  constexpr uint32_t LOD_COUNT = 3;
+
   struct Data
   {
     PROP_U64(model);
     PROP_S32(layerIdx);
     PROP_BOOL(culling);
+    PROP_BOOL(instanced);
+    PROP_FLOAT(drawDistance);
 
     Shared::MeshFilter filter{};
 
+    // lower detail levels, used beyond the given camera distance (0 = disabled)
+    Shared::MeshFilter lod1Filter{"lod1Filter"};
+    Shared::MeshFilter lod2Filter{"lod2Filter"};
+    PROP_FLOAT(lod1Dist);
+    PROP_FLOAT(lod2Dist);
+
     Shared::Material material{};
 
     Renderer::Object obj3D{};
     Utils::AABB aabb{};
   };
 
+  bool isLodActive(Data &data, Object &obj, uint32_t level)
+  {
+    if(level == 1) {
+      return data.lod1Dist.resolve(obj) > 0.0f && !data.lod1Filter.meshFilter.resolve(obj).empty();
+    }
+    return isLodActive(data, obj, 1)
+      && data.lod2Dist.resolve(obj) > data.lod1Dist.resolve(obj)
+      && !data.lod2Filter.meshFilter.resolve(obj).empty();
+  }
+
   std::shared_ptr<void> init(Object &obj) {
     return std::make_shared<Data>();
   }
@@ -48,7 +71,13 @@ namespace Project::Component::Model
       .set(data.model)
       .set(data.layerIdx)
       .set(data.culling)
+      .set(data.instanced)
+      .set(data.drawDistance)
       .set(data.filter.meshFilter)
+      .set(data.lod1Filter.meshFilter)
+      .set(data.lod2Filter.meshFilter)
+      .set(data.lod1Dist)
+      .set(data.lod2Dist)
       .set("material", data.material.serialize())
       .doc;
   }
@@ -58,7 +87,13 @@ namespace Project::Component::Model
     Utils::JSON::readProp(doc, data->layerIdx);
     Utils::JSON::readProp(doc, data->model);
     Utils::JSON::readProp(doc, data->culling, false);
+    Utils::JSON::readProp(doc, data->instanced, false);
+    Utils::JSON::readProp(doc, data->drawDistance, 0.0f);
     Utils::JSON::readProp(doc, data->filter.meshFilter);
+    Utils::JSON::readProp(doc, data->lod1Filter.meshFilter);
+    Utils::JSON::readProp(doc, data->lod2Filter.meshFilter);
+    Utils::JSON::readProp(doc, data->lod1Dist, 0.0f);
+    Utils::JSON::readProp(doc, data->lod2Dist, 0.0f);
 
     data->material.deserialize(
       doc.value("material", nlohmann::json::object())
@@ -70,7 +105,7 @@ namespace Project::Component::Model
   {
     Data &data = *static_cast<Data*>(entry.data.get());
 
-    auto res = ctx.assetUUIDToIdx.find(data.model.value);
+    auto res = ctx.findAsset(data.model.value);
     uint16_t id = 0xDEAD;
     if (res == ctx.assetUUIDToIdx.end()) {
       Utils::Logger::log("Component Model: Model UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
@@ -80,17 +115,64 @@ namespace Project::Component::Model
 
     auto t3dm = ctx.project->getAssets().getEntryByUUID(data.model.value);
     assert(t3dm);
-    auto &meshes = data.filter.filterT3DM(t3dm->t3dmData.models, obj, true);
+    auto &models = t3dm->t3dmData.models;
+    std::vector<uint32_t> lodMeshes[LOD_COUNT]{
+      data.filter.filterT3DM(models, obj, true),
+    };
+    if(isLodActive(data, obj, 1))lodMeshes[1] = data.lod1Filter.filterT3DM(models, obj, true);
+    if(isLodActive(data, obj, 2))lodMeshes[2] = data.lod2Filter.filterT3DM(models, obj, true);
+
+    // an empty base filter means the whole model, which LODs need as explicit indices
+    if(!lodMeshes[1].empty() && lodMeshes[0].empty()) {
+      for(uint32_t i=0; i<models.size(); ++i)lodMeshes[0].push_back(i);
+    }
 
     ctx.fileObj.write<uint16_t>(id);
     ctx.fileObj.write<uint8_t>(data.layerIdx.resolve(obj));
-    ctx.fileObj.write<uint8_t>(data.culling.resolve(obj));
+    uint8_t flags = 0;
+    // culling queries the BVH, without one the whole model is drawn
+    if(data.culling.resolve(obj) && Build::needsBVH(*t3dm))flags |= 1 << 0;
+    if(data.instanced.resolve(obj))flags |= 1 << 1;
+    ctx.fileObj.write<uint8_t>(flags);
     data.material.build(ctx.fileObj, obj);
 
-    ctx.fileObj.write<uint8_t>(meshes.size());
-    for(auto meshIdx : meshes) {
-      ctx.fileObj.write<uint8_t>(meshIdx);
+    auto texGroup = ctx.textureGroups.find(data.model.value);
+    ctx.fileObj.write<uint16_t>(texGroup == ctx.textureGroups.end() ? 0 : texGroup->second);
+    ctx.fileObj.write<uint16_t>(0); // padding
+    ctx.fileObj.write<float>(data.drawDistance.resolve(obj));
+    ctx.fileObj.write<float>(lodMeshes[1].empty() ? 0.0f : data.lod1Dist.resolve(obj));
+    ctx.fileObj.write<float>(lodMeshes[2].empty() ? 0.0f : data.lod2Dist.resolve(obj));
+
+    for(auto &meshes : lodMeshes) {
+      ctx.fileObj.write<uint8_t>(meshes.size());
+    }
+    for(auto &meshes : lodMeshes) {
+      for(auto meshIdx : meshes) {
+        ctx.fileObj.write<uint8_t>(meshIdx);
+      }
+    }
+  }
+
+  void addDrawCost(Object& obj, Entry &entry, const Utils::Frustum* view, Build::DrawCost &cost)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    auto asset = ctx.project->getAssets().getEntryByUUID(data.model.value);
+    if(!asset || asset->t3dmData.models.empty())return;
+
+    if(view && asset->mesh3D) {
+      glm::vec3 skew{0,0,0};
+      glm::vec4 persp{0,0,0,1};
+      glm::mat4 mat = glm::recompose(obj.scale.resolve(obj), obj.rot.resolve(obj), obj.pos.resolve(obj), skew, persp);
+      // mesh bounds are in model units, see 'Viewport3D::isVisible'
+      mat[0] *= 65536.0f;
+      mat[1] *= 65536.0f;
+      mat[2] *= 65536.0f;
+      if(!view->isVisible(asset->mesh3D->getAABB(), mat))return;
     }
+
+    ++cost.objects;
+    ++cost.matrices;
+    cost.addMeshes(asset->t3dmData, data.filter.filterT3DM(asset->t3dmData.models, obj, true));
   }
 
   void draw(Object &obj, Entry &entry)
@@ -118,10 +200,17 @@ namespace Project::Component::Model
         }, nullptr);
 
       ImTable::addObjProp("Culling", data.culling);
+      ImTable::addObjProp("Instanced", data.instanced);
+      ImTable::addObjProp("Draw-Dist.", data.drawDistance);
+
+      if(data.instanced.resolve(obj.propOverrides) && data.culling.resolve(obj.propOverrides)) {
+        ImGui::SameLine();
+        ImGui::TextColored({1.0f, 0.5f, 0.5f, 1.0f}, "Note: instances only use the Draw-Dist.");
+      }
 
       if(data.culling.resolve(obj.propOverrides)) {
         auto modelAsset = ctx.project->getAssets().getEntryByUUID(data.model.value);
-        if(modelAsset && !modelAsset->conf.gltfBVH) {
+        if(modelAsset && !Build::needsBVH(*modelAsset)) {
           ImGui::SameLine();
           ImGui::TextColored({1.0f, 0.5f, 0.5f, 1.0f}, "Warning: BVH not enabled!");
         }
@@ -151,6 +240,30 @@ namespace Project::Component::Model
         ImTable::end();
       }
 
+      if(ImGui::CollapsingSubHeader("Level of Detail") && ImTable::start("LOD", &obj))
+      {
+        ImTable::addObjProp("LOD1-Filter", data.lod1Filter.meshFilter);
+        ImTable::addObjProp("LOD1-Dist.", data.lod1Dist);
+        ImTable::addObjProp("LOD2-Filter", data.lod2Filter.meshFilter);
+        ImTable::addObjProp("LOD2-Dist.", data.lod2Dist);
+
+        float drawDist = data.drawDistance.resolve(obj);
+        float lodStart[LOD_COUNT+1]{0.0f, data.lod1Dist.resolve(obj), data.lod2Dist.resolve(obj), drawDist};
+        ImTable::add("Ranges");
+        for(uint32_t l=0; l<LOD_COUNT; ++l) {
+          if(l != 0 && !isLodActive(data, obj, l))continue;
+          uint32_t next = l + 1;
+          while(next < LOD_COUNT && !isLodActive(data, obj, next))++next;
+
+          if(next == LOD_COUNT && drawDist <= 0.0f) {
+            ImGui::Text("LOD%u: %.1f - inf.", l, lodStart[l]);
+          } else {
+            ImGui::Text("LOD%u: %.1f - %.1f", l, lodStart[l], lodStart[next]);
+          }
+        }
+        ImTable::end();
+      }
+
       if(ImGui::CollapsingSubHeader("Material Sets", ImGuiTreeNodeFlags_DefaultOpen) && ImTable::start("Mat", &obj))
       {
         ImTable::addObjProp<int32_t>("Depth", data.material.depth, [](int32_t *depth)
@@ -222,11 +335,15 @@ namespace Project::Component::Model
     if (!asset || !asset->mesh3D) {
       return;
     }
+    if (!vp.isVisible(asset->mesh3D->getAABB(), data.obj3D.uniform.modelMat)) {
+      return;
+    }
     auto &meshes = data.filter.filterT3DM(asset->t3dmData.models, obj, true);
     data.obj3D.draw(pass, cmdBuff, meshes);
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
-    if (isSelected)
+    bool isSelected = ctx.isObjectSelected(obj.uuid);
+    bool isHovered = vp.getHoveredObjectUUID() == obj.uuid;
+    if (isSelected || isHovered)
     {
       Utils::AABB aabb = data.aabb;
       if(!meshes.empty()) {
@@ -249,6 +366,15 @@ namespace Project::Component::Model
 
       Utils::Mesh::addLineBox(*vp.getLines(), center, halfExt, aabbCol);
       Utils::Mesh::addLineBox(*vp.getLines(), center, halfExt + 0.002f, aabbCol);
+
+      // preview of the LOD switch distances around the origin
+      auto &objPos = obj.pos.resolve(obj.propOverrides);
+      if(isSelected && isLodActive(data, obj, 1)) {
+        Utils::Mesh::addLineSphere(*vp.getLines(), objPos, glm::vec3{data.lod1Dist.resolve(obj)}, {0x00,0xFF,0xAA,0xFF});
+      }
+      if(isSelected && isLodActive(data, obj, 2)) {
+        Utils::Mesh::addLineSphere(*vp.getLines(), objPos, glm::vec3{data.lod2Dist.resolve(obj)}, {0x00,0xAA,0xFF,0xFF});
+      }
     }
   }
 }
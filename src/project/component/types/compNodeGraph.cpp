@@ -51,7 +51,7 @@ namespace Project::Component::NodeGraph
   {
     Data &data = *static_cast<Data*>(entry.data.get());
 
-    auto res = ctx.assetUUIDToIdx.find(data.asset.resolve(obj));
+    auto res = ctx.findAsset(data.asset.resolve(obj));
     uint16_t id = 0xDEAD;
     if (res == ctx.assetUUIDToIdx.end()) {
       Utils::Logger::log("Component NodeGraph: UUID not found: " + std::to_string(entry.uuid), Utils::Logger::LEVEL_ERROR);
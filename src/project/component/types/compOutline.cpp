@@ -43,6 +43,7 @@ namespace Project::Component::Outline
     PROP_FLOAT(thickness); // expansion in model-space units
     PROP_S32(mode);        // 0=silhouette, 1=contour
     PROP_BOOL(enabled);    // toggle at scene level
+    PROP_FLOAT(drawDistance); // max. camera distance of the hull pass, 0 = always
   };
 
   std::shared_ptr<void> init(Object &obj) {
@@ -61,6 +62,7 @@ namespace Project::Component::Outline
     builder.set(data.thickness);
     builder.set(data.mode);
     builder.set(data.enabled);
+    builder.set(data.drawDistance);
     return builder.doc;
   }
 
@@ -70,6 +72,7 @@ namespace Project::Component::Outline
     Utils::JSON::readProp(doc, data->thickness);
     Utils::JSON::readProp(doc, data->mode);
     Utils::JSON::readProp(doc, data->enabled);
+    Utils::JSON::readProp(doc, data->drawDistance, 0.0f);
     return data;
   }
 
@@ -83,12 +86,14 @@ namespace Project::Component::Outline
     //   uint8_t  mode;        // 1 byte
     //   uint8_t  enabled;     // 1 byte
     //   uint16_t padding;     // 2 bytes (alignment)
+    //   float    drawDistance;// 4 bytes
 
     ctx.fileObj.writeRGBA(data.color.resolve(obj.propOverrides));
     ctx.fileObj.writeFloat(data.thickness.resolve(obj.propOverrides));
     ctx.fileObj.write<uint8_t>(data.mode.resolve(obj.propOverrides));
     ctx.fileObj.write<uint8_t>(data.enabled.resolve(obj.propOverrides) ? 1 : 0);
     ctx.fileObj.write<uint16_t>(0); // padding
+    ctx.fileObj.writeFloat(data.drawDistance.resolve(obj.propOverrides));
   }
 
   void update(Object &obj, Entry &entry)
@@ -107,6 +112,7 @@ namespace Project::Component::Outline
       ImTable::add("Thickness", data.thickness.value);
       ImTable::addComboBox("Mode", data.mode.value, OUTLINE_MODES, OUTLINE_MODE_COUNT);
       ImTable::add("Enabled", data.enabled.value);
+      ImTable::add("Draw-Dist.", data.drawDistance.value);
       ImTable::end();
     }
   }
@@ -118,7 +124,7 @@ namespace Project::Component::Outline
 
     if (!data.enabled.resolve(obj.propOverrides)) return;
 
-    bool isSelected = ctx.selObjectUUID == obj.uuid;
+    bool isSelected = ctx.isObjectSelected(obj.uuid);
     if (!isSelected) return;
 
     // Draw a wire-box slightly larger than the object to preview outline extent
@@ -0,0 +1,169 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "../components.h"
+#include "../../../context.h"
+#include "../../../editor/imgui/helper.h"
+#include "../../../utils/json.h"
+#include "../../../utils/jsonBuilder.h"
+#include "../../../utils/binaryFile.h"
+#include "../../../utils/logger.h"
+#include "../../../editor/pages/parts/viewport3D.h"
+#include "../../../renderer/scene.h"
+#include "../../../utils/meshGen.h"
+#include <algorithm>
+
+namespace Project::Component::ParticleEmitter
+{
+  struct Data
+  {
+    PROP_S32(maxCount);
+    PROP_S32(burstCount);
+    PROP_BOOL(emitting);
+    PROP_BOOL(rspSim);
+    PROP_FLOAT(emitRate);
+    PROP_FLOAT(speed);
+    PROP_FLOAT(spread);
+    PROP_FLOAT(life);
+    PROP_FLOAT(lifeVar);
+    PROP_FLOAT(gravity);
+    PROP_VEC4(colorStart);
+    PROP_VEC4(colorEnd);
+    PROP_S32(sizeStart);
+    PROP_S32(sizeEnd);
+    PROP_S32(layerIdx);
+  };
+
+  std::shared_ptr<void> init(Object &obj) {
+    auto data = std::make_shared<Data>();
+    data->maxCount.value = 64;
+    data->emitting.value = true;
+    data->emitRate.value = 10.0f;
+    data->speed.value = 50.0f;
+    data->spread.value = 10.0f;
+    data->life.value = 1.0f;
+    data->gravity.value = -50.0f;
+    data->colorStart.value = {1.0f, 1.0f, 1.0f, 1.0f};
+    data->colorEnd.value = {1.0f, 1.0f, 1.0f, 0.0f};
+    data->sizeStart.value = 64;
+    data->sizeEnd.value = 16;
+    return data;
+  }
+
+  nlohmann::json serialize(const Entry &entry) {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    return Utils::JSON::Builder{}
+      .set(data.maxCount)
+      .set(data.burstCount)
+      .set(data.emitting)
+      .set(data.rspSim)
+      .set(data.emitRate)
+      .set(data.speed)
+      .set(data.spread)
+      .set(data.life)
+      .set(data.lifeVar)
+      .set(data.gravity)
+      .set(data.colorStart)
+      .set(data.colorEnd)
+      .set(data.sizeStart)
+      .set(data.sizeEnd)
+      .set(data.layerIdx)
+      .doc;
+  }
+
+  std::shared_ptr<void> deserialize(nlohmann::json &doc) {
+    auto data = std::make_shared<Data>();
+    Utils::JSON::readProp(doc, data->maxCount, 64);
+    Utils::JSON::readProp(doc, data->burstCount, 0);
+    Utils::JSON::readProp(doc, data->emitting, true);
+    Utils::JSON::readProp(doc, data->rspSim, false);
+    Utils::JSON::readProp(doc, data->emitRate, 10.0f);
+    Utils::JSON::readProp(doc, data->speed, 50.0f);
+    Utils::JSON::readProp(doc, data->spread, 10.0f);
+    Utils::JSON::readProp(doc, data->life, 1.0f);
+    Utils::JSON::readProp(doc, data->lifeVar, 0.0f);
+    Utils::JSON::readProp(doc, data->gravity, -50.0f);
+    Utils::JSON::readProp(doc, data->colorStart, {1.0f, 1.0f, 1.0f, 1.0f});
+    Utils::JSON::readProp(doc, data->colorEnd, {1.0f, 1.0f, 1.0f, 0.0f});
+    Utils::JSON::readProp(doc, data->sizeStart, 64);
+    Utils::JSON::readProp(doc, data->sizeEnd, 16);
+    Utils::JSON::readProp(doc, data->layerIdx, 0);
+    return data;
+  }
+
+  void build(Object& obj, Entry &entry, Build::SceneCtx &ctx)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+
+    uint8_t flags = 0;
+    if(data.emitting.resolve(obj))flags |= 1 << 0;
+    if(data.rspSim.resolve(obj))flags |= 1 << 1;
+
+    ctx.fileObj.write<uint16_t>(std::clamp(data.maxCount.resolve(obj), 2, 0xFFFE));
+    ctx.fileObj.write<uint16_t>(std::clamp(data.burstCount.resolve(obj), 0, 0xFFFF));
+    ctx.fileObj.write<float>(std::max(data.emitRate.resolve(obj), 0.0f));
+    ctx.fileObj.write<float>(data.speed.resolve(obj));
+    ctx.fileObj.write<float>(std::max(data.spread.resolve(obj), 0.0f));
+    ctx.fileObj.write<float>(std::max(data.life.resolve(obj), 0.001f));
+    ctx.fileObj.write<float>(std::max(data.lifeVar.resolve(obj), 0.0f));
+    ctx.fileObj.write<float>(data.gravity.resolve(obj));
+    ctx.fileObj.writeRGBA(data.colorStart.resolve(obj));
+    ctx.fileObj.writeRGBA(data.colorEnd.resolve(obj));
+    ctx.fileObj.write<uint8_t>(std::clamp(data.sizeStart.resolve(obj), 0, 127));
+    ctx.fileObj.write<uint8_t>(std::clamp(data.sizeEnd.resolve(obj), 0, 127));
+    ctx.fileObj.write<uint8_t>(data.layerIdx.resolve(obj));
+    ctx.fileObj.write<uint8_t>(flags);
+  }
+
+  void draw(Object &obj, Entry &entry)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    auto scene = ctx.project->getScenes().getLoadedScene();
+
+    if (ImTable::start("Comp", &obj)) {
+      ImTable::add("Name", entry.name);
+
+      std::vector<const char*> layerNames{};
+      for (auto &layer : scene->conf.layersPtx) {
+        layerNames.push_back(layer.name.value.c_str());
+      }
+      ImTable::addObjProp<int32_t>("Draw-Layer", data.layerIdx, [&layerNames](int32_t *layer)
+        {
+          return ImGui::Combo("##", layer, layerNames.data(), layerNames.size());
+        }, nullptr);
+
+      ImTable::addObjProp("Max. Count", data.maxCount);
+      ImTable::addObjProp("Emitting", data.emitting);
+      ImTable::addObjProp("RSP Sim.", data.rspSim);
+      ImTable::addObjProp("Rate (1/s)", data.emitRate);
+      ImTable::addObjProp("Burst", data.burstCount);
+      ImTable::addObjProp("Speed", data.speed);
+      ImTable::addObjProp("Spread", data.spread);
+      ImTable::addObjProp("Gravity", data.gravity);
+      ImTable::addObjProp("Life (s)", data.life);
+      ImTable::addObjProp("Life Rand.", data.lifeVar);
+      ImTable::addObjProp("Size Start", data.sizeStart);
+      ImTable::addObjProp("Size End", data.sizeEnd);
+      ImTable::addColor("Color Start", data.colorStart.value, true);
+      ImTable::addColor("Color End", data.colorEnd.value, true);
+
+      ImTable::end();
+    }
+  }
+
+  void draw3D(Object& obj, Entry &entry, Editor::Viewport3D &vp, SDL_GPUCommandBuffer* cmdBuff, SDL_GPURenderPass* pass)
+  {
+    Data &data = *static_cast<Data*>(entry.data.get());
+    auto pos = obj.pos.resolve(obj.propOverrides);
+    glm::u8vec4 col = data.colorStart.resolve(obj) * 255.0f;
+    Utils::Mesh::addSprite(*vp.getSprites(), pos, obj.uuid, 4, col);
+
+    if(ctx.isObjectSelected(obj.uuid)) {
+      // rough reach of the particles, ignoring gravity
+      float reach = (std::abs(data.speed.resolve(obj)) + data.spread.resolve(obj)) * data.life.resolve(obj);
+      glm::vec3 dir = obj.rot.resolve(obj.propOverrides) * glm::vec3{0.0f, 1.0f, 0.0f};
+      Utils::Mesh::addLine(*vp.getLines(), pos, pos + dir * reach, col);
+    }
+  }
+}
@@ -3,6 +3,7 @@
 * @license MIT
 */
 #include "graph.h"
+#include <unordered_set>
 
 #include "json.hpp"
 #include "../../utils/string.h"
@@ -34,6 +35,20 @@ namespace
     const char* name;
   };
 
+  // stack estimate for coroutine graphs: context switch and interrupt frame, budget for user functions, variables
+  constexpr uint32_t STACK_BASE = 512;
+  constexpr uint32_t STACK_USER_FUNC = 1024;
+  constexpr uint32_t STACK_PER_VAR = 8;
+
+  // below this zoom node widgets are unreadable anyway, only frames and titles are drawn
+  constexpr float LOD_MIN_SCALE = 0.5f;
+  // canvas units around the view still drawn, so nodes don't pop in at the border while panning
+  constexpr float CULL_MARGIN = 64.0f;
+
+  bool isRefVar(const Project::Graph::BuildCtx::VarDef &var) {
+    return !var.type.empty() && var.type.back() == '&';
+  }
+
   uint32_t getIndexLeft(ImFlow::Pin* pin)
   {
     auto leftNode = (Project::Graph::Node::Base*)pin->getParent();
@@ -135,6 +150,25 @@ namespace Project::Graph
     return newNode;
   }
 
+  void Graph::updateCulling(const ImVec2 &viewSize)
+  {
+    float scale = graph.getGrid().scale();
+    bool isZoomedOut = scale < LOD_MIN_SCALE;
+
+    // nodes are placed in canvas units, shown at '(pos + scroll) * scale'
+    ImVec2 viewMin = ImVec2{-CULL_MARGIN, -CULL_MARGIN} - graph.getScroll();
+    ImVec2 viewMax = viewMin + viewSize / scale + ImVec2{CULL_MARGIN, CULL_MARGIN} * 2;
+
+    for (const auto& [uid, node] : graph.getNodes()) {
+      auto p64Node = (Node::Base*)node.get();
+      auto posMin = p64Node->getPos();
+      auto posMax = posMin + p64Node->getSize();
+      p64Node->isCulled = isZoomedOut
+        || posMax.x < viewMin.x || posMin.x > viewMax.x
+        || posMax.y < viewMin.y || posMin.y > viewMax.y;
+    }
+  }
+
   bool Graph::deserialize(const std::string &jsonData)
   {
     auto nodeData = nlohmann::json::parse(jsonData);
@@ -226,10 +260,6 @@ namespace Project::Graph
   {
     auto &nodes = graph.getNodes();
 
-    uint16_t stackSize = 4096;
-    f.write<uint64_t>(uuid);
-    f.write<uint16_t>(stackSize);
-
 
     // maps a node's UUID to its own position in the file
     std::unordered_map<uint64_t, uint32_t> nodeSelfPosMap{};
@@ -308,15 +338,108 @@ namespace Project::Graph
       ingoingVals = filteredIngoingVals;
     }
 
+    // ==== OPTIMIZATION ==== //
+
+    // fold constant value outputs, consumers read them as literals
+    for(auto node : nodeVec) {
+      if(auto val = node->getConstValue()) {
+        nodeCtx.constValues[node->uuid] = *val;
+      }
+    }
+
+    auto getConstBranch = [&](Node::Base* node) {
+      nodeCtx.inValUUIDs = &nodeIngoingValMap[node->uuid];
+      return node->getConstBranch(nodeCtx);
+    };
+
+    // walk the logic flow from the entry, branches with constant conditions only follow the taken output.
+    // Anything not visited (e.g. notes or disconnected nodes) is never jumped to and gets dropped.
+    std::unordered_set<uint64_t> reachable{};
+    if(!nodeVec.empty())
+    {
+      std::vector<Node::Base*> stack{nodeVec[0]};
+      while(!stack.empty())
+      {
+        auto node = stack.back();
+        stack.pop_back();
+        if(!reachable.insert(node->uuid).second)continue;
+
+        auto &outs = nodeOutgoingMap[node->uuid];
+        int branch = getConstBranch(node);
+        for(size_t i = 0; i < outs.size(); ++i) {
+          if(branch >= 0 && (int)i != branch)continue;
+          auto it = nodeMap.find(outs[i]);
+          if(it != nodeMap.end())stack.push_back(it->second);
+        }
+      }
+    }
+
+    // merge waits directly following each other, as long as nothing else jumps into the second one
+    for(bool merged = true; merged;)
+    {
+      merged = false;
+      std::unordered_map<uint64_t, uint32_t> refCount{};
+      for(auto nodeUUID : reachable) {
+        for(auto outUUID : nodeOutgoingMap[nodeUUID])++refCount[outUUID];
+      }
+
+      for(auto nodeUUID : reachable)
+      {
+        auto waitA = dynamic_cast<Node::Wait*>(nodeMap.at(nodeUUID));
+        auto &outsA = nodeOutgoingMap[nodeUUID];
+        if(!waitA || outsA.empty())continue;
+
+        auto itB = nodeMap.find(outsA[0]);
+        if(itB == nodeMap.end() || itB->second == waitA || itB->second == nodeVec[0])continue;
+        if(refCount[outsA[0]] != 1)continue;
+        auto waitB = dynamic_cast<Node::Wait*>(itB->second);
+        if(!waitB)continue;
+
+        // the graph is rebuilt from its file for every build, so the nodes can be modified here
+        waitA->addTime(waitB->getTime());
+        outsA = nodeOutgoingMap[waitB->uuid];
+        reachable.erase(waitB->uuid);
+        merged = true;
+        break;
+      }
+    }
+
+    // nodes only providing values to the logic flow, their code is never jumped to, only their variables are needed
+    std::unordered_set<uint64_t> valueOnly{};
+    {
+      std::vector<uint64_t> stack{};
+      for(auto nodeUUID : reachable) {
+        for(auto valUUID : nodeIngoingValMap[nodeUUID])stack.push_back(valUUID);
+      }
+      while(!stack.empty())
+      {
+        auto valUUID = stack.back();
+        stack.pop_back();
+        if(valUUID == 0 || reachable.contains(valUUID) || !valueOnly.insert(valUUID).second)continue;
+        for(auto inUUID : nodeIngoingValMap[valUUID])stack.push_back(inUUID);
+      }
+    }
+
+    std::erase_if(nodeVec, [&](Node::Base* node) {
+      return !reachable.contains(node->uuid) && !valueOnly.contains(node->uuid);
+    });
+
+    // without anything yielding on its own, the graph is compiled into a switch resumed once per frame,
+    // its variables then live in a struct instead of a coroutine stack
+    nodeCtx.stateMachine = true;
+    for(auto node : nodeVec) {
+      if(node->needsCoroutine()) {
+        nodeCtx.stateMachine = false;
+        break;
+      }
+    }
+
     source += R"(#include <script/nodeGraph.h>)" "\n";
     source += R"(#include <scene/object.h>)" "\n";
     source += R"(#include <scene/scene.h>)" "\n";
     source += "\n";
 
     source += "namespace P64::NodeGraph::G" + Utils::toHex64(uuid) + " {\n";
-    source += R"(void run(void* arg) {)" "\n";
-
-    source += R"(  P64::NodeGraph::Instance* inst = (P64::NodeGraph::Instance*)arg; )" "\n";
 
     auto nodeLabel = [&](uint64_t uuid) {
       return "NODE_" + Utils::toHex64(uuid);
@@ -327,9 +450,27 @@ namespace Project::Graph
       nodeCtx.outUUIDs = &nodeOutgoingMap[node->uuid];
       nodeCtx.inValUUIDs = &nodeIngoingValMap[node->uuid];
 
+      if(valueOnly.contains(node->uuid)) {
+        auto codeSize = nodeCtx.source.size();
+        node->build(nodeCtx);
+        nodeCtx.source.resize(codeSize);
+        continue;
+      }
+
       nodeCtx.source += "  " + nodeLabel(node->uuid) + ": // " + node->getName() + "\n";
       nodeCtx.source += "  {\n";
 
+      int branch = node->getConstBranch(nodeCtx);
+      if(branch >= 0) {
+        if((uint32_t)branch < nodeCtx.outUUIDs->size()) {
+          nodeCtx.jump(branch);
+        } else {
+          nodeCtx.line("return;");
+        }
+        nodeCtx.source += "  }\n";
+        continue;
+      }
+
       node->build(nodeCtx);
 
       if(nodeCtx.outUUIDs->empty()) {
@@ -341,15 +482,68 @@ namespace Project::Graph
       nodeCtx.source += "  }\n";
     }
 
-    source += "\n// ==== GLOBAL VARS ==== //\n";
+    if(!nodeCtx.stateMachine)
+    {
+      source += R"(void run(void* arg) {)" "\n";
+      source += R"(  P64::NodeGraph::Instance* inst = (P64::NodeGraph::Instance*)arg; )" "\n";
+
+      source += "\n// ==== GLOBAL VARS ==== //\n";
+      for(auto &globalVar : nodeCtx.vars) {
+        source += "  " + globalVar.type + " " + globalVar.name + " = " + globalVar.value + ";\n";
+      }
+
+      source += "\n// ==== CODE ==== //\n";
+      source += nodeCtx.source;
+      source += "}\n";
+      source += "}\n";
+
+      // only graphs calling user functions end up here, their own frame is just the variables
+      uint32_t stackSize = STACK_BASE + STACK_USER_FUNC + nodeCtx.vars.size() * STACK_PER_VAR;
+      stackSize = (stackSize + 15) & ~15u;
+      f.write<uint64_t>(uuid);
+      f.write<uint16_t>((uint16_t)stackSize);
+      return;
+    }
+
+    source += "struct State : P64::NodeGraph::StateBase {\n";
+    source += "// ==== GLOBAL VARS ==== //\n";
     for(auto &globalVar : nodeCtx.vars) {
+      if(isRefVar(globalVar))continue;
+      source += "  " + globalVar.type + " " + globalVar.name + ";\n";
+    }
+    source += "\n  void resume(P64::NodeGraph::Instance* inst);\n";
+    source += "};\n\n";
+
+    // every 'return' without setting 'step' first ends the graph
+    source += "void State::resume(P64::NodeGraph::Instance* inst) {\n";
+    // references (e.g. to the arguments) can't be part of the state, they are bound again on each resume
+    for(auto &globalVar : nodeCtx.vars) {
+      if(!isRefVar(globalVar))continue;
       source += "  " + globalVar.type + " " + globalVar.name + " = " + globalVar.value + ";\n";
     }
+    source += "  uint16_t resumeStep = step;\n";
+    source += "  step = STEP_DONE;\n";
+    source += "  switch(resumeStep) {\n";
+    source += "  case 0:\n";
+    for(auto &globalVar : nodeCtx.vars) {
+      if(isRefVar(globalVar))continue;
+      source += "  " + globalVar.name + " = " + globalVar.value + ";\n";
+    }
 
     source += "\n// ==== CODE ==== //\n";
     source += nodeCtx.source;
+    source += "  default: return;\n";
+    source += "  }\n";
+    source += "}\n\n";
+
+    source += R"(void run(void* arg) {)" "\n";
+    source += R"(  auto inst = (P64::NodeGraph::Instance*)arg;)" "\n";
+    source += R"(  ((State*)inst->getState(sizeof(State)))->resume(inst);)" "\n";
     source += "}\n";
     source += "}\n";
 
+    // no stack marks the graph as a state machine for the runtime
+    f.write<uint64_t>(uuid);
+    f.write<uint16_t>(0);
   }
 }
@@ -23,6 +23,12 @@ namespace Project::Graph
       static const std::vector<std::string>& getNodeNames();
       std::shared_ptr<Node::Base> addNode(uint32_t type, const ImVec2& pos);
 
+      /**
+       * Marks nodes outside the visible part of the canvas, or all of them when zoomed out too far.
+       * Must be called before drawing, with the same size the canvas is drawn at.
+       */
+      void updateCulling(const ImVec2 &viewSize);
+
       bool deserialize(const std::string &jsonData);
       std::string serialize();
 
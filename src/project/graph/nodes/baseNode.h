@@ -3,6 +3,8 @@
 * @license MIT
 */
 #pragma once
+#include <optional>
+#include <unordered_map>
 
 #include "ImNodeFlow.h"
 #include "json.hpp"
@@ -25,6 +27,11 @@ namespace Project::Graph
     std::vector<VarDef> vars{};
     std::vector<uint64_t> *outUUIDs{nullptr};
     std::vector<uint64_t> *inValUUIDs{nullptr};
+    // emit a resumable switch instead of coroutine code (see 'Graph::build')
+    bool stateMachine{false};
+    uint32_t stepCount{0};
+    // value outputs folded by the optimizer (see 'Graph::build'), inlined into their consumers
+    std::unordered_map<uint64_t, int> constValues{};
 
     inline std::string toStr(auto value)
     {
@@ -75,6 +82,29 @@ namespace Project::Graph
       return varName;
     }
 
+    // constant of a value input, 'fallback' if unconnected, empty if only known at runtime
+    [[nodiscard]] std::optional<int> inConst(uint32_t inIndex, int fallback) const
+    {
+      if(!inValUUIDs || inIndex >= inValUUIDs->size() || (*inValUUIDs)[inIndex] == 0) {
+        return fallback;
+      }
+      auto it = constValues.find((*inValUUIDs)[inIndex]);
+      if(it == constValues.end())return {};
+      return it->second;
+    }
+
+    // expression reading a value input, 'fallback' if unconnected
+    [[nodiscard]] std::string inVal(uint32_t inIndex, const std::string &fallback) const
+    {
+      if(!inValUUIDs || inIndex >= inValUUIDs->size() || (*inValUUIDs)[inIndex] == 0) {
+        return fallback;
+      }
+      auto uuidIn = (*inValUUIDs)[inIndex];
+      auto it = constValues.find(uuidIn);
+      if(it != constValues.end())return std::to_string(it->second);
+      return "res_" + Utils::toHex64(uuidIn);
+    }
+
     BuildCtx& jump(uint32_t outIndex) {
       if(outUUIDs && outIndex < outUUIDs->size()) {
         auto uuidOut = (*outUUIDs)[outIndex];
@@ -93,6 +123,36 @@ namespace Project::Graph
       source += "    " + str + "\n";
       return *this;
     }
+
+    /**
+     * Waits (at least one frame) until 'cond' is false.
+     * In a state machine this resumes at a new case label, so the current block must not declare any locals before it.
+     */
+    BuildCtx& yieldWhile(const std::string &cond)
+    {
+      if(!stateMachine) {
+        return line("while(" + cond + ") {")
+          .line("  coro_yield();")
+          .line("}");
+      }
+
+      auto stepStr = std::to_string(++stepCount);
+      return line("[[fallthrough]];")
+        .line("case " + stepStr + ":")
+        .line("if(" + cond + ") {")
+        .line("  step = " + stepStr + ";")
+        .line("  return;")
+        .line("}");
+    }
+
+    BuildCtx& sleep(const std::string &ticks)
+    {
+      if(!stateMachine) {
+        return line("coro_sleep(" + ticks + ");");
+      }
+      return line("wakeTicks = get_ticks() + " + ticks + ";")
+        .yieldWhile("get_ticks() < wakeTicks");
+    }
   };
 }
 
@@ -111,6 +171,37 @@ namespace Project::Graph::Node
       uint32_t type{};
       std::vector<uint8_t> valInputTypes{};
 
+      // set by 'Graph::updateCulling' for nodes out of view or too small to read
+      bool isCulled{false};
+      ImVec2 contentSize{};
+
+      /**
+       * Skips the content (widgets) of culled nodes, keeping the space it took up last time,
+       * so neither the node nor its pins move. The frame and title are still drawn by ImNodeFlow.
+       */
+      void draw() final
+      {
+        if(isCulled && contentSize.x > 0) {
+          ImGui::Dummy(contentSize);
+          return;
+        }
+        ImGui::BeginGroup();
+        drawContent();
+        ImGui::EndGroup();
+        contentSize = ImGui::GetItemRectSize();
+      }
+
+      virtual void drawContent() {}
+
+      // nodes that can yield outside of 'BuildCtx::yieldWhile', forcing the graph to run as a coroutine
+      [[nodiscard]] virtual bool needsCoroutine() const { return false; }
+
+      // value output known at build time, lets the optimizer fold it into all consumers
+      [[nodiscard]] virtual std::optional<int> getConstValue() const { return {}; }
+
+      // logic output always taken given the constant inputs in 'ctx', -1 if only known at runtime
+      [[nodiscard]] virtual int getConstBranch(const BuildCtx &ctx) const { return -1; }
+
       virtual void serialize(nlohmann::json &j) = 0;
       virtual void deserialize(nlohmann::json &j) = 0;
       virtual void build(BuildCtx &ctx) = 0;
@@ -37,7 +37,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, animName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("anim", buf, sizeof(buf))) animName = buf;
@@ -86,7 +86,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {}
+      void drawContent() override {}
 
       void serialize(nlohmann::json &) override {}
       void deserialize(nlohmann::json &) override {}
@@ -123,7 +123,7 @@ namespace Project::Graph::Node
         valInputTypes = {0, 1}; // index 0 = logic, index 1 = value
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, blendAnimName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("blend", buf, sizeof(buf))) blendAnimName = buf;
@@ -144,11 +144,9 @@ namespace Project::Graph::Node
       void build(BuildCtx &ctx) override {
         uint32_t hash = Utils::Hash::crc32(blendAnimName.c_str(), blendAnimName.size());
         // Use connected Blend value if available, otherwise fall back to constant
-        std::string blendExpr;
+        std::string blendExpr = std::to_string(blendFactor) + "f";
         if(ctx.inValUUIDs && !ctx.inValUUIDs->empty() && (*ctx.inValUUIDs)[0] != 0) {
-          blendExpr = "(float)res_" + Utils::toHex64((*ctx.inValUUIDs)[0]) + " / 65535.0f";
-        } else {
-          blendExpr = std::to_string(blendFactor) + "f";
+          blendExpr = "(float)" + ctx.inVal(0, "0") + " / 65535.0f";
         }
         ctx.line("// SetAnimBlend: \"" + blendAnimName + "\"")
            .localConst("uint32_t", "blend_hash", hash)
@@ -178,18 +176,16 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("Done", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {}
+      void drawContent() override {}
       void serialize(nlohmann::json &) override {}
       void deserialize(nlohmann::json &) override {}
 
       void build(BuildCtx &ctx) override {
         ctx.line("// WaitAnimEnd: poll until animation completes")
-           .line("{")
-           .line("  auto* amodel = inst->obj->getComponent<P64::Component::AnimModel>();")
-           .line("  while(amodel && !amodel->isAnimDone()) {")
-           .line("    coro_yield();")
-           .line("  }")
-           .line("}");
+           .yieldWhile("[&] {"
+             " auto* amodel = inst->obj->getComponent<P64::Component::AnimModel>();"
+             " return amodel && !amodel->isAnimDone();"
+           " }()");
       }
   };
 
@@ -216,7 +212,7 @@ namespace Project::Graph::Node
         valInputTypes = {0, 1};
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(60.f);
         ImGui::InputFloat("speed", &speed, 0, 0, "%.2f");
       }
@@ -231,11 +227,9 @@ namespace Project::Graph::Node
 
       void build(BuildCtx &ctx) override {
         // Use connected Speed value if available, otherwise fall back to constant
-        std::string speedExpr;
+        std::string speedExpr = std::to_string(speed) + "f";
         if(ctx.inValUUIDs && !ctx.inValUUIDs->empty() && (*ctx.inValUUIDs)[0] != 0) {
-          speedExpr = "(float)res_" + Utils::toHex64((*ctx.inValUUIDs)[0]) + " / 65535.0f";
-        } else {
-          speedExpr = std::to_string(speed) + "f";
+          speedExpr = "(float)" + ctx.inVal(0, "0") + " / 65535.0f";
         }
         ctx.line("auto* amodel = inst->obj->getComponent<P64::Component::AnimModel>();")
            .line("if(amodel) { amodel->setSpeed(" + speedExpr + "); }");
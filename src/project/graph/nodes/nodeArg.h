@@ -27,7 +27,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(50);
         ImGui::InputScalar("Index", ImGuiDataType_U16, &value);
       }
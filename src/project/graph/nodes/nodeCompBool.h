@@ -31,7 +31,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("False", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
 
       }
 
@@ -41,14 +41,15 @@ namespace Project::Graph::Node
       void deserialize(nlohmann::json &j) override {
       }
 
+      [[nodiscard]] int getConstBranch(const BuildCtx &ctx) const override {
+        auto val = ctx.inConst(0, 0);
+        if(!val)return -1;
+        return *val ? 0 : 1;
+      }
+
       void build(BuildCtx &ctx) override
       {
-        if(ctx.inValUUIDs->empty()) {
-          ctx.localVar("int", "t_comp", 0);
-        } else {
-          auto idStr = Utils::toHex64(ctx.inValUUIDs->at(0));
-          ctx.localVar("int", "t_comp", "res_" + idStr);
-        }
+        ctx.localVar("int", "t_comp", ctx.inVal(0, "0"));
 
         ctx.line("if(t_comp) {")
           .jump(0)
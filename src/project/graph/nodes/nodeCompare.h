@@ -44,7 +44,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("False", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         if(ImTable::start("Node", nullptr, 80.0f)) {
           if(ImTable::addComboBox("Oper.", compType, COMP_TYPES.data(), COMP_TYPES.size())) {
             updateTitle();
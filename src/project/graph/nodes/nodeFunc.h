@@ -37,7 +37,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         //ImGui::Text("Func:");
         //ImGui::SameLine();
         bool changed = false;
@@ -65,6 +65,9 @@ namespace Project::Graph::Node
         updateTitle();
       }
 
+      // user functions are free to yield
+      [[nodiscard]] bool needsCoroutine() const override { return true; }
+
       void build(BuildCtx &ctx) override {
         auto uuidStr = std::to_string(Utils::Hash::crc32(funcName));
         auto funcVar = ctx.globalVar("UserFunc", "P64::NodeGraph::getFunction("+uuidStr+")");
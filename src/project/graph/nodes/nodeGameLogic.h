@@ -38,7 +38,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("Moving", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, targetObjName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("target", buf, sizeof(buf))) targetObjName = buf;
@@ -112,7 +112,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(160.f);
         float v[3] = {x, y, z};
         if(ImGui::InputFloat3("pos", v)) { x=v[0]; y=v[1]; z=v[2]; }
@@ -156,7 +156,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(160.f);
         float v[3] = {vx, vy, vz};
         if(ImGui::InputFloat3("vel", v)) { vx=v[0]; vy=v[1]; vz=v[2]; }
@@ -203,7 +203,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, prefabName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("prefab", buf, sizeof(buf))) prefabName = buf;
@@ -260,7 +260,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("Dist", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, targetObjName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("target", buf, sizeof(buf))) targetObjName = buf;
@@ -310,7 +310,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::Checkbox("visible", &visible);
       }
 
@@ -348,7 +348,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         char buf[64]; strncpy(buf, soundName.c_str(), sizeof(buf)-1); buf[sizeof(buf)-1]=0;
         ImGui::SetNextItemWidth(100.f);
         if(ImGui::InputText("sound", buf, sizeof(buf))) soundName = buf;
@@ -393,7 +393,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("Other", PIN_STYLE_VALUE);
       }
 
-      void draw() override {}
+      void drawContent() override {}
       void serialize(nlohmann::json &) override {}
       void deserialize(nlohmann::json &) override {}
 
@@ -419,7 +419,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {}
+      void drawContent() override {}
       void serialize(nlohmann::json &) override {}
       void deserialize(nlohmann::json &) override {}
 
@@ -449,7 +449,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("Fire", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(60.f);
         ImGui::InputFloat("sec", &interval, 0, 0, "%.1f");
         ImGui::Checkbox("repeat", &repeat);
@@ -466,14 +466,14 @@ namespace Project::Graph::Node
       }
 
       void build(BuildCtx &ctx) override {
-        ctx.localConst("uint64_t", "timer_ms", (uint64_t)(interval * 1000.0f));
+        auto timerTicks = "TICKS_FROM_MS(" + std::to_string((uint64_t)(interval * 1000.0f)) + ")";
         if(repeat) {
           ctx.line("while(true) {")
-             .line("  coro_sleep(TICKS_FROM_MS(timer_ms));");
+             .sleep(timerTicks);
           ctx.jump(0);
           ctx.line("}");
         } else {
-          ctx.line("coro_sleep(TICKS_FROM_MS(timer_ms));");
+          ctx.sleep(timerTicks);
         }
       }
   };
@@ -495,7 +495,7 @@ namespace Project::Graph::Node
         addIN<TypeLogic>("", ImFlow::ConnectionFilter::SameType(), PIN_STYLE_LOGIC);
       }
 
-      void draw() override {}
+      void drawContent() override {}
       void serialize(nlohmann::json &) override {}
       void deserialize(nlohmann::json &) override {}
 
@@ -532,7 +532,7 @@ namespace Project::Graph::Node
         valInputTypes = {1, 1};
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(80.f);
         ImGui::Combo("op", &op, "Add +\0Sub -\0Mul *\0Div /\0");
         ImGui::SetNextItemWidth(60.f);
@@ -557,16 +557,10 @@ namespace Project::Graph::Node
         ctx.globalVar("uint16_t", resVar, 0);
 
         // Determine operand A (input pin 0)
-        std::string opA = "0";
-        if(ctx.inValUUIDs && !ctx.inValUUIDs->empty() && (*ctx.inValUUIDs)[0] != 0) {
-          opA = "res_" + Utils::toHex64((*ctx.inValUUIDs)[0]);
-        }
+        std::string opA = ctx.inVal(0, "0");
 
         // Determine operand B (input pin 1), fall back to constVal
-        std::string opB = std::to_string(constVal);
-        if(ctx.inValUUIDs && ctx.inValUUIDs->size() > 1 && (*ctx.inValUUIDs)[1] != 0) {
-          opB = "res_" + Utils::toHex64((*ctx.inValUUIDs)[1]);
-        }
+        std::string opB = ctx.inVal(1, std::to_string(constVal));
 
         ctx.line(resVar + " = (uint16_t)(" + opA + " " + opChar + " " + opB + ");");
       }
@@ -82,7 +82,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(90.f);
         ImGui::Combo("Button", &buttonIdx, BUTTON_NAMES, BUTTON_COUNT);
         ImGui::SetNextItemWidth(40.f);
@@ -128,7 +128,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(90.f);
         ImGui::Combo("Button", &buttonIdx, BUTTON_NAMES, BUTTON_COUNT);
         ImGui::SetNextItemWidth(40.f);
@@ -173,7 +173,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(90.f);
         ImGui::Combo("Button", &buttonIdx, BUTTON_NAMES, BUTTON_COUNT);
         ImGui::SetNextItemWidth(40.f);
@@ -222,7 +222,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("Y", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(40.f);
         ImGui::InputInt("Port", &port);
         port = port < 0 ? 0 : (port > 3 ? 3 : port);
@@ -277,7 +277,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(80.f);
         ImGui::InputText("Var", &stateName);
         ImGui::SetNextItemWidth(50.f);
@@ -323,7 +323,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("value", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(80.f);
         ImGui::InputText("Var", &stateName);
       }
@@ -368,7 +368,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("S2", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(80.f);
         ImGui::InputText("Var", &stateName);
         ImGui::SetNextItemWidth(40.f);
@@ -26,7 +26,7 @@ namespace Project::Graph::Node
         setStyle(std::make_shared<ImFlow::NodeStyle>(IM_COL32(0, 0, 0, 0x20), ImColor(0xFF, 0xFF, 0xFF, 0xFF), 0.0f));
       }
 
-      void draw() override {
+      void drawContent() override {
         auto editor = getHandler();
         if (!editor) {
           return;
@@ -28,7 +28,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         std::vector<ImTable::ComboEntry> entries;
         entries.push_back({0, "< Self >"});
 
@@ -30,7 +30,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         if(ImTable::start("Node", nullptr, 100.0f)) {
 
           std::vector<ImTable::ComboEntry> entries;
@@ -28,7 +28,7 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("Exit", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(50.f);
         ImGui::InputScalar("##Count", ImGuiDataType_U32, &count);
         //showIN("", 0, ImFlow::ConnectionFilter::SameType(), PIN_STYLE_LOGIC);
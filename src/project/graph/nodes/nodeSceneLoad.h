@@ -37,7 +37,7 @@ namespace Project::Graph::Node
         valInputTypes.push_back(1);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(110.f);
 
         if (usOwnValue()) {
@@ -55,11 +55,10 @@ namespace Project::Graph::Node
 
       void build(BuildCtx &ctx) override
       {
-        if(ctx.inValUUIDs->empty()) {
-          ctx.localConst("uint16_t", "sceneId", std::to_string(sceneId));
+        if(ctx.inConst(0, sceneId)) {
+          ctx.localConst("uint16_t", "sceneId", *ctx.inConst(0, sceneId));
         } else {
-          auto idStr = Utils::toHex64(ctx.inValUUIDs->at(0));
-          ctx.localVar("uint16_t", "sceneId", "res_" + idStr);
+          ctx.localVar("uint16_t", "sceneId", ctx.inVal(0, "0"));
         }
 
         ctx.line("P64::SceneManager::load(sceneId);");
@@ -28,7 +28,7 @@ namespace Project::Graph::Node
         //addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::Text("On Start");
         //ImGui::Text("On Event");
         //ImGui::Text("On Collision");
@@ -29,7 +29,7 @@ namespace Project::Graph::Node
         valInputTypes.push_back(1);
       }
 
-      void draw() override {
+      void drawContent() override {
 
         uint32_t idx = 0;
         for(auto &c : cases) {
@@ -59,14 +59,18 @@ namespace Project::Graph::Node
         }
       }
 
+      [[nodiscard]] int getConstBranch(const BuildCtx &ctx) const override {
+        auto val = ctx.inConst(0, 0);
+        if(!val)return -1;
+        for(size_t i = 0; i < cases.size(); ++i) {
+          if((int)cases[i] == *val)return static_cast<int>(i);
+        }
+        return 0; // no match continues at the first output, same as the generated switch
+      }
+
       void build(BuildCtx &ctx) override
       {
-        if(ctx.inValUUIDs->empty()) {
-          ctx.localVar("int", "t_comp", 0);
-        } else {
-          auto idStr = Utils::toHex64(ctx.inValUUIDs->at(0));
-          ctx.localVar("int", "t_comp", "res_" + idStr);
-        }
+        ctx.localVar("int", "t_comp", ctx.inVal(0, "0"));
 
         ctx.line("switch(t_comp) {");
         for(size_t i = 0; i < cases.size(); ++i) {
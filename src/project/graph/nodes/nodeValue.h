@@ -29,7 +29,7 @@ namespace Project::Graph::Node
         addOUT<TypeValue>("", PIN_STYLE_VALUE);
       }
 
-      void draw() override {
+      void drawContent() override {
         ImGui::SetNextItemWidth(50);
         ImGui::InputScalar("##Value", ImGuiDataType_U16, &value);
       }
@@ -42,7 +42,10 @@ namespace Project::Graph::Node
         value = j.value("value", 0);
       }
 
+      [[nodiscard]] std::optional<int> getConstValue() const override { return value; }
+
       void build(BuildCtx &ctx) override {
+        if(ctx.constValues.contains(uuid))return;
         auto resVar = "res_" + Utils::toHex64(uuid);
         ctx.globalVar("int", resVar, value);
       }
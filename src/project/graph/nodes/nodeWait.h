@@ -27,7 +27,12 @@ namespace Project::Graph::Node
         addOUT<TypeLogic>("", PIN_STYLE_LOGIC);
       }
 
-      void draw() override {
+      [[nodiscard]] float getTime() const { return time; }
+
+      // used by the optimizer to fold a following wait into this one
+      void addTime(float seconds) { time += seconds; }
+
+      void drawContent() override {
         ImGui::SetNextItemWidth(50.f);
         ImGui::InputFloat("sec.", &time);
 
@@ -43,8 +48,7 @@ namespace Project::Graph::Node
       }
 
       void build(BuildCtx &ctx) override {
-        ctx.localConst("uint64_t", "t_time", (uint64_t)(time * 1000.0f))
-          .line("coro_sleep(TICKS_FROM_MS(t_time));");
+        ctx.sleep("TICKS_FROM_MS(" + std::to_string((uint64_t)(time * 1000.0f)) + ")");
       }
   };
 }
\ No newline at end of file
@@ -16,10 +16,21 @@ std::string Project::ProjectConf::serialize() const {
     .set("name", name)
     .set("romName", romName)
     .set("pathEmu", pathEmu)
+    .set("pathLoader", pathLoader)
+    .set("pathHotReload", pathHotReload)
     .set("pathN64Inst", pathN64Inst)
     .set("sceneIdOnBoot", sceneIdOnBoot)
     .set("sceneIdOnReset", sceneIdOnReset)
     .set("sceneIdLastOpened", sceneIdLastOpened)
+    .set("memBudgetKB", memBudgetKB)
+    .set("budgetTris", budgetTris)
+    .set("budgetVertLoads", budgetVertLoads)
+    .set("budgetTexLoads", budgetTexLoads)
+    .set("budgetMatrices", budgetMatrices)
+    .set("scriptOverlays", scriptOverlays)
+    .set("fastRepack", fastRepack)
+    .set("unityBuild", unityBuild)
+    .set("unityPCH", unityPCH)
     .toString();
 }
 
@@ -27,10 +38,21 @@ void Project::Project::deserialize(const nlohmann::json &doc) {
   conf.name = doc.value("name", "New Project");
   conf.romName = doc.value("romName", "pyrite64");
   conf.pathEmu = doc.value("pathEmu", "ares");
+  conf.pathLoader = doc.value("pathLoader", "");
+  conf.pathHotReload = doc.value("pathHotReload", "");
   conf.pathN64Inst = doc.value("pathN64Inst", "");
   conf.sceneIdOnBoot = doc.value("sceneIdOnBoot", 1);
   conf.sceneIdOnReset = doc.value("sceneIdOnReset", 1);
   conf.sceneIdLastOpened = doc.value("sceneIdLastOpened", 1);
+  conf.memBudgetKB = doc.value("memBudgetKB", 4096u);
+  conf.budgetTris = doc.value("budgetTris", 4000u);
+  conf.budgetVertLoads = doc.value("budgetVertLoads", 6000u);
+  conf.budgetTexLoads = doc.value("budgetTexLoads", 48u);
+  conf.budgetMatrices = doc.value("budgetMatrices", 64u);
+  conf.scriptOverlays = doc.value("scriptOverlays", false);
+  conf.fastRepack = doc.value("fastRepack", true);
+  conf.unityBuild = doc.value("unityBuild", false);
+  conf.unityPCH = doc.value("unityPCH", false);
 }
 
 Project::Project::Project(const std::string &p64projPath)
@@ -15,11 +15,28 @@ namespace Project
     std::string name{};
     std::string romName{};
     std::string pathEmu{};
+    std::string pathLoader{}; // flashcart upload command, the ROM path is appended (e.g. 'UNFLoader -r')
+    // sends a file as binary data over the USB debug channel, the hot-reload packet path is appended (see 'Build::writeHotReloadPacket')
+    std::string pathHotReload{};
     std::string pathN64Inst{};
 
     uint32_t sceneIdOnBoot{1};
     uint32_t sceneIdOnReset{1};
     uint32_t sceneIdLastOpened{1};
+    // RDRAM available to a scene, checked in the ROM report after each build (see 'Build::writeRomReport')
+    uint32_t memBudgetKB{4096};
+    // per-frame draw cost the scene inspector warns about (see 'Build::estimateDrawCost'), 0 = no limit
+    uint32_t budgetTris{4000};
+    uint32_t budgetVertLoads{6000};
+    uint32_t budgetTexLoads{48};
+    uint32_t budgetMatrices{64};
+    // object scripts used by scenes are linked into per-scene DSOs instead of the main binary (see 'Build::buildScripts')
+    bool scriptOverlays{false};
+    // asset-only changes are patched into the last ROM instead of a full repack (see 'Build::patchRom')
+    bool fastRepack{true};
+    // user scripts and node graphs are compiled as a few combined sources (see 'Build::buildUnitySources')
+    bool unityBuild{false};
+    bool unityPCH{false};
 
     std::string serialize() const;
   };
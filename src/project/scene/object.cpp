@@ -14,7 +14,7 @@ using Builder = Utils::JSON::Builder;
 
 namespace
 {
-  nlohmann::json serializeObj(const Project::Object &obj)
+  nlohmann::json serializeObj(const Project::Object &obj, bool withChildren)
   {
     Builder builder{};
     builder.set("id", obj.id);
@@ -23,6 +23,9 @@ namespace
 
     builder.set("selectable", obj.selectable);
     builder.set("enabled", obj.enabled);
+    builder.set("streamed", obj.streamed);
+    builder.set("persistent", obj.persistent);
+    builder.set("updateTier", obj.updateTier);
 
     builder
       .set(obj.uuidPrefab)
@@ -47,10 +50,11 @@ namespace
       comps.push_back(c);
     }
     builder.doc["components"] = comps;
+    if(!withChildren)return builder.doc;
 
     nlohmann::json children = nlohmann::json::array();
     for (const auto &child : obj.children) {
-      children.push_back(serializeObj(*child));
+      children.push_back(serializeObj(*child, true));
     }
     builder.set("children", children);
     return builder.doc;
@@ -80,11 +84,31 @@ void Project::Object::removeComponent(uint64_t uuid) {
   );
 }
 
-nlohmann::json Project::Object::serialize() const {
-  return serializeObj(*this);
+nlohmann::json Project::Object::serialize(bool withChildren) const {
+  return serializeObj(*this, withChildren);
 }
 
 void Project::Object::deserialize(Scene *scene, nlohmann::json &doc)
+{
+  if(!doc.is_object())return;
+  deserializeProps(doc);
+
+  if(!doc.contains("children"))return;
+
+  auto &chArray = doc["children"];
+  size_t childCount = chArray.size();
+
+  assert(scene || childCount == 0);
+  if(!scene)return;
+
+  for (size_t i=0; i<childCount; ++i) {
+    auto childObj = std::make_shared<Object>(*this);
+    childObj->deserialize(scene, chArray[i]);
+    scene->addObject(*this, childObj);
+  }
+}
+
+void Project::Object::deserializeProps(nlohmann::json &doc)
 {
   if(!doc.is_object())return;
 
@@ -94,6 +118,9 @@ void Project::Object::deserialize(Scene *scene, nlohmann::json &doc)
 
   selectable = doc.value("selectable", true);
   enabled = doc.value("enabled", true);
+  streamed = doc.value("streamed", false);
+  persistent = doc.value("persistent", false);
+  updateTier = doc.value("updateTier", 0);
 
   Utils::JSON::readProp(doc, uuidPrefab);
   Utils::JSON::readProp(doc, pos);
@@ -113,6 +140,7 @@ void Project::Object::deserialize(Scene *scene, nlohmann::json &doc)
     }
   }
 
+  components.clear();
   if(doc.contains("components")) {
     auto &cmArray = doc["components"];
     int count = cmArray.size();
@@ -132,18 +160,4 @@ void Project::Object::deserialize(Scene *scene, nlohmann::json &doc)
 
     }
   }
-
-  if(!doc.contains("children"))return;
-
-  auto &chArray = doc["children"];
-  size_t childCount = chArray.size();
-
-  assert(scene || childCount == 0);
-  if(!scene)return;
-
-  for (size_t i=0; i<childCount; ++i) {
-    auto childObj = std::make_shared<Object>(*this);
-    childObj->deserialize(scene, chArray[i]);
-    scene->addObject(*this, childObj);
-  }
 }
@@ -35,6 +35,12 @@ namespace Project
 
       bool enabled{true};
       bool selectable{true};
+      // loaded with its chunk instead of the scene, only used for top-level objects (see 'SceneConf::chunkSize')
+      bool streamed{false};
+      // kept alive with its children when the next scene is loaded, only used for top-level objects (see 'SceneManager' in the engine)
+      bool persistent{false};
+      // components update every 2^n-th tick (0-3), see 'Scene::tick' in the engine
+      int updateTier{0};
       bool isPrefabEdit{false};
 
       std::unordered_map<uint64_t, GenericValue> propOverrides{};
@@ -48,9 +54,17 @@ namespace Project
       void addComponent(int compID);
       void removeComponent(uint64_t uuid);
 
-      nlohmann::json serialize() const;
+      /**
+       * @param withChildren false to only write the object itself (used by undo/redo)
+       */
+      nlohmann::json serialize(bool withChildren = true) const;
       void deserialize(Scene *scene, nlohmann::json &doc);
 
+      /**
+       * Reads everything but the children, replaces the current components.
+       */
+      void deserializeProps(nlohmann::json &doc);
+
       bool isPrefabInstance() const {
         return uuidPrefab.value != 0;
       }
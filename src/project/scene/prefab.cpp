@@ -28,9 +28,10 @@ void Project::Prefab::deserialize(const std::string &str)
 
 void Project::Prefab::save()
 {
+  // an unchanged file keeps its date, so neither the prefab nor the scenes using it get rebuilt
   auto prefabJson = serialize();
-  Utils::FS::saveTextFile(
-    ctx.project->getPath() + "/assets/" + obj.name + ".prefab",
-    prefabJson
-  );
+  auto path = ctx.project->getPath() + "/assets/" + obj.name + ".prefab";
+  if(Utils::FS::loadTextFile(path) == prefabJson)return;
+
+  Utils::FS::saveTextFile(path, prefabJson);
 }
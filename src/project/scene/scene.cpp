@@ -19,6 +19,15 @@
 namespace
 {
   constexpr float DEF_MODEL_SCALE = 1.0f;
+
+  // the cached copy of a scene is only used if the JSON next to it wasn't touched since
+  std::string getCacheKey(const fs::path &pathJson)
+  {
+    std::error_code err{};
+    auto size = fs::file_size(pathJson, err);
+    if(err)return "";
+    return std::to_string(Utils::FS::getFileAge(pathJson)) + ":" + std::to_string(size);
+  }
 }
 
 nlohmann::json Project::SceneConf::serialize() const {
@@ -33,6 +42,7 @@ nlohmann::json Project::SceneConf::serialize() const {
     b.set(layer.fogColor);
     b.set(layer.fogMin);
     b.set(layer.fogMax);
+    b.set(layer.bufferWords);
   };
 
   Utils::JSON::Builder builder{};
@@ -40,12 +50,36 @@ nlohmann::json Project::SceneConf::serialize() const {
     .set("fbWidth", fbWidth)
     .set("fbHeight", fbHeight)
     .set("fbFormat", fbFormat)
+    .set(fbCount)
     .set(clearColor)
     .set(doClearColor)
     .set(doClearDepth)
+    .set(backdrop)
+    .set(depthSlices)
+    .set(noDepth)
+    .set(dynamicRes)
     .set(renderPipeline)
     .set(frameLimit)
+    .set(tickRate)
+    .set(lowLatency)
+    .set(noAlloc)
     .set(filter)
+    .set(bloomQuality)
+    .set(matrixCapacity)
+    .set(audioSampleRate)
+    .set(audioBufferCount)
+    .set(audioChannelCount)
+    .set(chunkSize)
+    .set(chunkLoadDist)
+    .set(memBudgetKB)
+    .set(lowTier)
+    .set(lowTierAuto)
+    .set(lowTierWidth)
+    .set(lowTierHeight)
+    .set(lowTierBloomQuality)
+    .set(lowTierAudioChannels)
+    .set(lowTierLodScale)
+    .set(lowTierParticleScale)
     .setArray<LayerConf>("layers3D", layers3D, writeLayer)
     .setArray<LayerConf>("layersPtx", layersPtx, writeLayer)
     .setArray<LayerConf>("layers2D", layers2D, writeLayer);
@@ -58,22 +92,32 @@ Project::Scene::Scene(int id_, const std::string &projectPath)
 {
   Utils::Logger::log("Loading scene: " + std::to_string(id));
   scenePath = projectPath + "/data/scenes/" + std::to_string(id);
+  cachePath = projectPath + "/build/scenes/" + std::to_string(id) + ".msgpack";
 
-  deserialize(Utils::FS::loadTextFile(scenePath + "/scene.json"));
+  auto pathJson = scenePath + "/scene.json";
+  auto cacheKey = getCacheKey(pathJson);
+  auto cache = Utils::JSON::fromBinary(Utils::FS::loadTextFile(cachePath));
+
+  if(!cacheKey.empty() && cache.is_object() && cache.value("key", "") == cacheKey) {
+    deserializeDoc(cache["scene"]);
+  } else {
+    auto doc = nlohmann::json::parse(Utils::FS::loadTextFile(pathJson), nullptr, false);
+    deserializeDoc(doc);
+    if(doc.is_object())saveCache(doc);
+  }
 
   root.id = 0;
   root.name = "Scene";
   root.uuid = Utils::Hash::sha256_64bit(root.name);
 }
 
-std::shared_ptr<Project::Object> Project::Scene::addObject(std::string &objJson, uint64_t parentUUID)
+std::shared_ptr<Project::Object> Project::Scene::addObject(nlohmann::json &objDoc, uint64_t parentUUID)
 {
   auto p = getObjectByUUID(parentUUID);
   Object *parent = p ? p.get() : &root;
 
-  auto json = nlohmann::json::parse(objJson, nullptr, false);
   auto obj = std::make_shared<Object>(*parent);
-  obj->deserialize(this, json);
+  obj->deserialize(this, objDoc);
   return addObject(*parent, obj, true);
 }
 
@@ -87,6 +131,7 @@ std::shared_ptr<Project::Object> Project::Scene::addObject(Object &parent) {
 
 std::shared_ptr<Project::Object> Project::Scene::addObject(Object&parent, std::shared_ptr<Object> obj, bool generateIDs) {
   parent.children.push_back(obj);
+  ++structureVersion;
 
   auto setChildUUIDs = [this, generateIDs](const std::shared_ptr<Object> &objChild, auto& setChildUIDsRef) -> void
   {
@@ -128,8 +173,8 @@ std::shared_ptr<Project::Object> Project::Scene::addPrefabInstance(uint64_t pref
 }
 
 void Project::Scene::removeObject(Object &obj) {
-  if (ctx.selObjectUUID == obj.uuid) {
-    ctx.selObjectUUID = 0;
+  if (ctx.isObjectSelected(obj.uuid)) {
+    ctx.toggleObjectSelection(obj.uuid);
   }
 
   std::erase_if(
@@ -137,11 +182,13 @@ void Project::Scene::removeObject(Object &obj) {
     [&obj](const std::shared_ptr<Object> &ref) { return ref->uuid == obj.uuid; }
   );
   objectsMap.erase(obj.uuid);
+  ++structureVersion;
 }
 
 void Project::Scene::removeAllObjects() {
   objectsMap.clear();
   root.children.clear();
+  ++structureVersion;
 }
 
 bool Project::Scene::moveObject(uint32_t uuidObject, uint32_t uuidTarget, bool asChild)
@@ -158,6 +205,7 @@ bool Project::Scene::moveObject(uint32_t uuidObject, uint32_t uuidTarget, bool a
 
   auto obj = objIt->second;
   auto target = targetIt->second;
+  ++structureVersion;
 
   // Remove from current parent
   if (obj->parent) {
@@ -194,7 +242,20 @@ bool Project::Scene::moveObject(uint32_t uuidObject, uint32_t uuidTarget, bool a
 
 void Project::Scene::save()
 {
-  Utils::FS::saveTextFile(scenePath + "/scene.json", serialize());
+  auto doc = toJson();
+  Utils::FS::saveTextFile(scenePath + "/scene.json", doc.dump(2));
+  saveCache(doc);
+}
+
+void Project::Scene::saveCache(const nlohmann::json &doc)
+{
+  nlohmann::json cache{};
+  cache["key"] = getCacheKey(scenePath + "/scene.json");
+  cache["scene"] = doc;
+
+  std::error_code err{};
+  fs::create_directories(fs::path{cachePath}.parent_path(), err);
+  Utils::FS::saveTextFile(cachePath, Utils::JSON::toBinary(cache));
 }
 
 uint32_t Project::Scene::createPrefabFromObject(uint32_t uuid)
@@ -222,11 +283,19 @@ uint32_t Project::Scene::createPrefabFromObject(uint32_t uuid)
   return 0;
 }
 
-std::string Project::Scene::serialize(bool minify) {
+nlohmann::json Project::Scene::toJson() {
   nlohmann::json doc{};
   doc["conf"] = conf.serialize();
   doc["graph"] = root.serialize();
-  return doc.dump(minify ? -1 : 2);
+  return doc;
+}
+
+std::string Project::Scene::serialize(bool minify) {
+  return toJson().dump(minify ? -1 : 2);
+}
+
+std::string Project::Scene::serializeBinary() {
+  return Utils::JSON::toBinary(toJson());
 }
 
 void Project::Scene::resetLayers()
@@ -264,22 +333,64 @@ void Project::Scene::resetLayers()
 void Project::Scene::deserialize(const std::string &data)
 {
   if(data.empty())return;
-
   auto doc = nlohmann::json::parse(data, nullptr, false);
+  deserializeDoc(doc);
+}
+
+void Project::Scene::deserializeBinary(const std::string &data)
+{
+  auto doc = Utils::JSON::fromBinary(data);
+  deserializeDoc(doc);
+}
+
+void Project::Scene::deserializeDoc(nlohmann::json &doc)
+{
   if (!doc.is_object())return;
 
-  auto &docConf = doc["conf"];
+  deserializeConf(doc["conf"]);
+
+  removeAllObjects();
+  auto docGraph = doc["graph"];
+  root.deserialize(this, docGraph);
+}
+
+void Project::Scene::deserializeConf(nlohmann::json &docConf)
+{
   {
     Utils::JSON::readProp(docConf, conf.name);
     conf.fbWidth = docConf.value("fbWidth", 320);
     conf.fbHeight = docConf.value("fbHeight", 240);
     conf.fbFormat = docConf.value("fbFormat", 0);
+    Utils::JSON::readProp(docConf, conf.fbCount, 3);
     Utils::JSON::readProp(docConf, conf.clearColor);
     Utils::JSON::readProp(docConf, conf.doClearColor);
     Utils::JSON::readProp(docConf, conf.doClearDepth);
+    Utils::JSON::readProp(docConf, conf.backdrop, false);
+    Utils::JSON::readProp(docConf, conf.depthSlices, false);
+    Utils::JSON::readProp(docConf, conf.noDepth, false);
+    Utils::JSON::readProp(docConf, conf.dynamicRes, false);
     Utils::JSON::readProp(docConf, conf.renderPipeline);
     Utils::JSON::readProp(docConf, conf.frameLimit, 0);
+    Utils::JSON::readProp(docConf, conf.tickRate, 0);
+    Utils::JSON::readProp(docConf, conf.lowLatency, false);
+    Utils::JSON::readProp(docConf, conf.noAlloc, false);
     Utils::JSON::readProp(docConf, conf.filter, 0);
+    Utils::JSON::readProp(docConf, conf.bloomQuality, 0);
+    Utils::JSON::readProp(docConf, conf.matrixCapacity, 0);
+    Utils::JSON::readProp(docConf, conf.audioSampleRate, 0);
+    Utils::JSON::readProp(docConf, conf.audioBufferCount, 0);
+    Utils::JSON::readProp(docConf, conf.audioChannelCount, 0);
+    Utils::JSON::readProp(docConf, conf.chunkSize, 0);
+    Utils::JSON::readProp(docConf, conf.chunkLoadDist, 0);
+    Utils::JSON::readProp(docConf, conf.memBudgetKB, 0);
+    Utils::JSON::readProp(docConf, conf.lowTier, false);
+    Utils::JSON::readProp(docConf, conf.lowTierAuto, false);
+    Utils::JSON::readProp(docConf, conf.lowTierWidth, 0);
+    Utils::JSON::readProp(docConf, conf.lowTierHeight, 0);
+    Utils::JSON::readProp(docConf, conf.lowTierBloomQuality, 1);
+    Utils::JSON::readProp(docConf, conf.lowTierAudioChannels, 0);
+    Utils::JSON::readProp(docConf, conf.lowTierLodScale, 0.5f);
+    Utils::JSON::readProp(docConf, conf.lowTierParticleScale, 0.5f);
 
     auto readLayer = [](const nlohmann::json &dom) {
       LayerConf layer{};
@@ -292,6 +403,7 @@ void Project::Scene::deserialize(const std::string &data)
       Utils::JSON::readProp(dom, layer.fogColor);
       Utils::JSON::readProp(dom, layer.fogMin, 0.0f);
       Utils::JSON::readProp(dom, layer.fogMax, 0.0f);
+      Utils::JSON::readProp(dom, layer.bufferWords, 0u);
 
 
       return layer;
@@ -313,10 +425,6 @@ void Project::Scene::deserialize(const std::string &data)
       resetLayers();
     }
   }
-
-  removeAllObjects();
-  auto docGraph = doc["graph"];
-  root.deserialize(this, docGraph);
 }
 
 uint16_t Project::Scene::getFreeObjectId()
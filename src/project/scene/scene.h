@@ -23,6 +23,7 @@ namespace Project
     PROP_VEC4(fogColor);
     PROP_FLOAT(fogMin);
     PROP_FLOAT(fogMax);
+    PROP_U32(bufferWords); // 0 = picked by the build
   };
 
   struct SceneConf
@@ -31,12 +32,38 @@ namespace Project
     int fbWidth{320};
     int fbHeight{240};
     int fbFormat{0};
+    PROP_S32(fbCount); // 2 or 3, bigtex is always 3
     PROP_VEC4(clearColor);
     PROP_BOOL(doClearColor);
     PROP_BOOL(doClearDepth);
+    PROP_BOOL(backdrop); // sky/backdrop covers the screen, color is only cleared at the start
+    PROP_BOOL(depthSlices); // depth is cleared every second frame, at half the precision
+    PROP_BOOL(noDepth); // no depth-buffer, draws are sorted back-to-front instead (not for bigtex)
+    PROP_BOOL(dynamicRes); // default pipeline only
     PROP_S32(renderPipeline);
     PROP_S32(frameLimit);
+    PROP_S32(tickRate); // Hz, 0 = update once per frame
+    PROP_BOOL(lowLatency); // late input, at most one frame queued for the VI
+    PROP_BOOL(noAlloc); // heap allocations during gameplay assert (ROMs built with 'P64_ALLOC_TRACK=1' only)
     PROP_S32(filter);
+    PROP_S32(bloomQuality); // HDR-Bloom only, 0 = high
+    PROP_S32(matrixCapacity);
+    PROP_S32(audioSampleRate); // 0 = engine default
+    PROP_S32(audioBufferCount);
+    PROP_S32(audioChannelCount);
+    PROP_S32(chunkSize); // size of a streaming cell, 0 = streaming disabled
+    PROP_S32(chunkLoadDist); // distance from the camera to load chunks at
+    PROP_S32(memBudgetKB); // overrides the budget of the project in the ROM report, 0 = project default
+
+    // overrides for consoles without the expansion pak, see 'Quality' in the engine
+    PROP_BOOL(lowTier);
+    PROP_BOOL(lowTierAuto); // also switch to it if frames keep taking too long
+    PROP_S32(lowTierWidth); // 0 = keep
+    PROP_S32(lowTierHeight);
+    PROP_S32(lowTierBloomQuality);
+    PROP_S32(lowTierAudioChannels); // 0 = keep
+    PROP_FLOAT(lowTierLodScale);
+    PROP_FLOAT(lowTierParticleScale);
 
     std::vector<LayerConf> layers3D{};
     std::vector<LayerConf> layersPtx{};
@@ -51,6 +78,11 @@ namespace Project
       int id{};
       Object root{};
       std::string scenePath{};
+      std::string cachePath{};
+
+      nlohmann::json toJson();
+      void deserializeDoc(nlohmann::json &doc);
+      void saveCache(const nlohmann::json &doc);
 
     public:
       SceneConf conf{};
@@ -64,8 +96,10 @@ namespace Project
       Object& getRootObject() { return root; }
 
       std::unordered_map<uint32_t, std::shared_ptr<Object>> objectsMap{};
+      // changes whenever objects are added, removed or moved in the hierarchy
+      uint32_t structureVersion{0};
 
-      std::shared_ptr<Object> addObject(std::string &objJson, uint64_t parentUUID = 0);
+      std::shared_ptr<Object> addObject(nlohmann::json &objDoc, uint64_t parentUUID = 0);
       std::shared_ptr<Object> addObject(Object &parent);
       std::shared_ptr<Object> addObject(Object &parent, std::shared_ptr<Object> obj, bool generateIDs = false);
 
@@ -86,10 +120,17 @@ namespace Project
       uint32_t createPrefabFromObject(uint32_t uuid);
 
       std::string serialize(bool minify = false);
+      /**
+       * Same data as 'serialize', but as MessagePack (see 'Utils::JSON::toBinary').
+       * Used for undo snapshots, the project itself always stores JSON.
+       */
+      std::string serializeBinary();
 
       void resetLayers();
 
       void deserialize(const std::string &data);
+      void deserializeBinary(const std::string &data);
+      void deserializeConf(nlohmann::json &docConf);
 
       uint16_t getFreeObjectId();
   };
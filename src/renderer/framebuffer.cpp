@@ -5,6 +5,8 @@
 #include "framebuffer.h"
 #include "../context.h"
 
+#include <algorithm>
+
 Renderer::Framebuffer::Framebuffer()
 {
   texInfo.width = 0;
@@ -42,6 +44,10 @@ Renderer::Framebuffer::~Framebuffer() {
   if (transBufferRead) {
     SDL_ReleaseGPUTransferBuffer(ctx.gpu, transBufferRead);
   }
+  for (auto &read : asyncReads) {
+    if(read.fence)SDL_ReleaseGPUFence(ctx.gpu, read.fence);
+    if(read.buffer)SDL_ReleaseGPUTransferBuffer(ctx.gpu, read.buffer);
+  }
   if(gpuTex)SDL_ReleaseGPUTexture(ctx.gpu, gpuTex);
   if(gpuTexObj)SDL_ReleaseGPUTexture(ctx.gpu, gpuTexObj);
   if(gpuTexDepth)SDL_ReleaseGPUTexture(ctx.gpu, gpuTexDepth);
@@ -133,14 +139,65 @@ glm::u8vec4 Renderer::Framebuffer::readColor(uint32_t x, uint32_t y)
   return res;
 }
 
-uint32_t Renderer::Framebuffer::readObjectID(uint32_t x, uint32_t y) {
-  if (x >= texInfo.width || y >= texInfo.height) {
-    return 1;
+bool Renderer::Framebuffer::requestObjectID(uint32_t x, uint32_t y, uint32_t tag)
+{
+  if (!gpuTexObj || readCount == asyncReads.size())return false;
+  x = std::min(x, texInfo.width - 1);
+  y = std::min(y, texInfo.height - 1);
+
+  auto &read = asyncReads[(readIdx + readCount) % asyncReads.size()];
+  if (!read.buffer) {
+    SDL_GPUTransferBufferCreateInfo tbci{};
+    tbci.size = (Uint32)sizeof(uint32_t);
+    tbci.usage = SDL_GPU_TRANSFERBUFFERUSAGE_DOWNLOAD;
+    read.buffer = SDL_CreateGPUTransferBuffer(ctx.gpu, &tbci);
+    if (!read.buffer)return false;
   }
 
-  auto res = *static_cast<uint32_t*>(startGenericRead(x, y));
-  //printf("ID: %08X\n", res);
-  endGenericRead();
-  return res;
+  // own command buffer, submitted after the frame so it sees what was just drawn
+  SDL_GPUCommandBuffer* cmdBuff = SDL_AcquireGPUCommandBuffer(ctx.gpu);
+  SDL_GPUCopyPass *pass = SDL_BeginGPUCopyPass(cmdBuff);
+
+  SDL_GPUTextureRegion src{};
+  src.texture = gpuTexObj;
+  src.x = x;
+  src.y = y;
+  src.w = 1;
+  src.h = 1;
+  src.d = 1;
+
+  SDL_GPUTextureTransferInfo dst{};
+  dst.transfer_buffer = read.buffer;
+  dst.rows_per_layer = 1;
+  dst.pixels_per_row = 1;
+
+  SDL_DownloadFromGPUTexture(pass, &src, &dst);
+  SDL_EndGPUCopyPass(pass);
+
+  read.fence = SDL_SubmitGPUCommandBufferAndAcquireFence(cmdBuff);
+  if (!read.fence)return false;
+  read.tag = tag;
+  ++readCount;
+  return true;
+}
+
+bool Renderer::Framebuffer::pollObjectID(uint32_t &objectID, uint32_t &tag)
+{
+  if (readCount == 0)return false;
+
+  auto &read = asyncReads[readIdx];
+  if (!SDL_QueryGPUFence(ctx.gpu, read.fence))return false;
+
+  SDL_ReleaseGPUFence(ctx.gpu, read.fence);
+  read.fence = nullptr;
+  readIdx = (readIdx + 1) % asyncReads.size();
+  --readCount;
+
+  auto data = static_cast<uint32_t*>(SDL_MapGPUTransferBuffer(ctx.gpu, read.buffer, false));
+  if (!data)return false;
+  objectID = *data;
+  tag = read.tag;
+  SDL_UnmapGPUTransferBuffer(ctx.gpu, read.buffer);
+  return true;
 }
 
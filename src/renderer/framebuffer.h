@@ -3,6 +3,7 @@
 * @license MIT
 */
 #pragma once
+#include <array>
 #include <SDL3/SDL.h>
 
 #include "glm/vec4.hpp"
@@ -21,6 +22,17 @@ namespace Renderer
 
       SDL_GPUTransferBuffer *transBufferRead{nullptr};
 
+      // object ID reads in flight, oldest at 'readIdx'
+      struct AsyncRead
+      {
+        SDL_GPUTransferBuffer *buffer{nullptr};
+        SDL_GPUFence *fence{nullptr};
+        uint32_t tag{0};
+      };
+      std::array<AsyncRead, 4> asyncReads{};
+      uint32_t readIdx{0};
+      uint32_t readCount{0};
+
       void* startGenericRead(uint32_t x, uint32_t y);
       void endGenericRead();
 
@@ -47,6 +59,19 @@ namespace Renderer
       [[nodiscard]] SDL_GPUTexture* getTexture() const { return gpuTex; }
 
       glm::u8vec4 readColor(uint32_t x, uint32_t y);
-      uint32_t readObjectID(uint32_t x, uint32_t y);
+
+      /**
+       * Starts downloading the object ID at a pixel, without waiting for the GPU.
+       * Call after the frame got submitted, the result is ready a frame or two later (see 'pollObjectID').
+       * @param tag returned with the result, to tell multiple kinds of reads apart
+       * @return false if too many reads are in flight already
+       */
+      bool requestObjectID(uint32_t x, uint32_t y, uint32_t tag);
+
+      /**
+       * Returns the oldest finished read from 'requestObjectID', if any.
+       * @return false if nothing is done yet
+       */
+      bool pollObjectID(uint32_t &objectID, uint32_t &tag);
   };
 }
@@ -4,6 +4,8 @@
 */
 #include "n64Material.h"
 #include "../../shader/defines.h"
+#include "../../shader/ccVariants.h"
+#include <iterator>
 #include "ccMapping.h"
 #include "tiny3d/tools/gltf_importer/src/parser/rdp.h"
 
@@ -26,83 +28,148 @@ namespace
     if (c == CC_A_TEX0) c = CC_A_TEX1;
     else if (c == CC_A_TEX1) c = CC_A_TEX0;
   }
+
+  struct CCVariant
+  {
+    int32_t color[4];
+    int32_t alpha[4];
+  };
+
+  // same order as in 'ccVariants.h', index 0 is the uber-shader
+  constexpr CCVariant CC_VARIANTS[] = {
+    {},
+    {{CC_VARIANT_1_COLOR}, {CC_VARIANT_1_ALPHA}},
+    {{CC_VARIANT_2_COLOR}, {CC_VARIANT_2_ALPHA}},
+    {{CC_VARIANT_3_COLOR}, {CC_VARIANT_3_ALPHA}},
+    {{CC_VARIANT_4_COLOR}, {CC_VARIANT_4_ALPHA}},
+    {{CC_VARIANT_5_COLOR}, {CC_VARIANT_5_ALPHA}},
+  };
+  static_assert(std::size(CC_VARIANTS) == CC_VARIANT_COUNT + 1, "update 'CC_VARIANTS' to match ccVariants.h");
+
+  void appendKey(std::string &key, auto value) {
+    key.append((const char*)&value, sizeof(value));
+  }
+
+  void appendTileKey(std::string &key, const auto &tile) {
+    appendKey(key, tile.mask);
+    appendKey(key, tile.shift);
+    appendKey(key, tile.low);
+    appendKey(key, tile.high);
+    appendKey(key, tile.clamp);
+    appendKey(key, tile.mirror);
+  }
+}
+
+std::string Renderer::N64Material::getKey(const T3DM::Material &t3dMat)
+{
+  std::string key{};
+  appendKey(key, t3dMat.colorCombiner);
+  appendKey(key, t3dMat.otherModeValue);
+  appendKey(key, t3dMat.drawFlags);
+  appendKey(key, t3dMat.vertexFxFunc);
+  appendKey(key, t3dMat.setBlendColor);
+  appendKey(key, t3dMat.setEnvColor);
+  appendKey(key, t3dMat.setPrimColor);
+  for (int i=0; i<4; ++i) {
+    appendKey(key, t3dMat.primColor[i]);
+    appendKey(key, t3dMat.envColor[i]);
+  }
+  appendTileKey(key, t3dMat.texA.s);
+  appendTileKey(key, t3dMat.texA.t);
+  appendTileKey(key, t3dMat.texB.s);
+  appendTileKey(key, t3dMat.texB.t);
+  return key;
+}
+
+uint32_t Renderer::N64Material::getVariant(const UniformN64Material &mat)
+{
+  if (mat.otherModeH & G_CYC_2CYCLE)return 0;
+  for (uint32_t v=1; v<std::size(CC_VARIANTS); ++v) {
+    auto &variant = CC_VARIANTS[v];
+    bool matches = true;
+    for (int i=0; i<4; ++i) {
+      matches = matches && mat.cc0Color[i] == variant.color[i] && mat.cc0Alpha[i] == variant.alpha[i];
+    }
+    if (matches)return v;
+  }
+  return 0;
 }
 
-void Renderer::N64Material::convert(N64Mesh::MeshPart &part, const T3DM::Material &t3dMat)
+void Renderer::N64Material::convert(UniformN64Material &mat, const T3DM::Material &t3dMat)
 {
   auto &texA = t3dMat.texA;
   auto &texB = t3dMat.texB;
 
   uint64_t cc = t3dMat.colorCombiner;
 
-  part.material.vertexFX = t3dMat.vertexFxFunc;
-  part.material.otherModeH = t3dMat.otherModeValue >> 32;
-  part.material.otherModeL = t3dMat.otherModeValue & 0xFFFFFFFF;
-  part.material.flags = t3dMat.drawFlags;
+  mat.vertexFX = t3dMat.vertexFxFunc;
+  mat.otherModeH = t3dMat.otherModeValue >> 32;
+  mat.otherModeL = t3dMat.otherModeValue & 0xFFFFFFFF;
+  mat.flags = t3dMat.drawFlags;
 
-  part.material.flags |= t3dMat.setBlendColor ? UniformN64Material::FLAG_SET_BLEND_COL : 0;
-  part.material.flags |= t3dMat.setEnvColor ? UniformN64Material::FLAG_SET_ENV_COL : 0;
-  part.material.flags |= t3dMat.setPrimColor ? UniformN64Material::FLAG_SET_PRIM_COL : 0;
+  mat.flags |= t3dMat.setBlendColor ? UniformN64Material::FLAG_SET_BLEND_COL : 0;
+  mat.flags |= t3dMat.setEnvColor ? UniformN64Material::FLAG_SET_ENV_COL : 0;
+  mat.flags |= t3dMat.setPrimColor ? UniformN64Material::FLAG_SET_PRIM_COL : 0;
 
   if (cc & RDPQ_COMBINER_2PASS) {
-    part.material.otherModeH |= G_CYC_2CYCLE;
+    mat.otherModeH |= G_CYC_2CYCLE;
   }
 
-  part.material.lightDir[0].w = 0.0f; // no alpha clip
+  mat.lightDir[0].w = 0.0f; // no alpha clip
   if (t3dMat.otherModeValue & RDP::SOM::ALPHA_COMPARE) {
-    part.material.lightDir[0].w = 0.5f;
+    mat.lightDir[0].w = 0.5f;
   }
 
-  part.material.cc0Color = { getBits(cc, 52, 55), getBits(cc, 28, 31), getBits(cc, 47, 51), getBits(cc, 15, 17) };
-  part.material.cc0Alpha = { getBits(cc, 44, 46), getBits(cc, 12, 14), getBits(cc, 41, 43), getBits(cc, 9, 11)  };
-  part.material.cc1Color = { getBits(cc, 37, 40), getBits(cc, 24, 27), getBits(cc, 32, 36), getBits(cc, 6, 8)   };
-  part.material.cc1Alpha = { getBits(cc, 21, 23), getBits(cc, 3, 5),   getBits(cc, 18, 20), getBits(cc, 0, 2)   };
+  mat.cc0Color = { getBits(cc, 52, 55), getBits(cc, 28, 31), getBits(cc, 47, 51), getBits(cc, 15, 17) };
+  mat.cc0Alpha = { getBits(cc, 44, 46), getBits(cc, 12, 14), getBits(cc, 41, 43), getBits(cc, 9, 11)  };
+  mat.cc1Color = { getBits(cc, 37, 40), getBits(cc, 24, 27), getBits(cc, 32, 36), getBits(cc, 6, 8)   };
+  mat.cc1Alpha = { getBits(cc, 21, 23), getBits(cc, 3, 5),   getBits(cc, 18, 20), getBits(cc, 0, 2)   };
 
   for (int i=0; i<4; ++i) {
-    part.material.cc0Color[i] = CC_MAP_COLOR[i][part.material.cc0Color[i]];
-    part.material.cc1Color[i] = CC_MAP_COLOR[i][part.material.cc1Color[i]];
+    mat.cc0Color[i] = CC_MAP_COLOR[i][mat.cc0Color[i]];
+    mat.cc1Color[i] = CC_MAP_COLOR[i][mat.cc1Color[i]];
 
-    part.material.cc0Alpha[i] = CC_MAP_ALPHA[i][part.material.cc0Alpha[i]];
-    part.material.cc1Alpha[i] = CC_MAP_ALPHA[i][part.material.cc1Alpha[i]];
+    mat.cc0Alpha[i] = CC_MAP_ALPHA[i][mat.cc0Alpha[i]];
+    mat.cc1Alpha[i] = CC_MAP_ALPHA[i][mat.cc1Alpha[i]];
 
-    switchColTex2Cycle(part.material.cc1Color[i]);
-    switchAlphaTex2Cycle(part.material.cc1Alpha[i]);
+    switchColTex2Cycle(mat.cc1Color[i]);
+    switchAlphaTex2Cycle(mat.cc1Alpha[i]);
   }
 
-  part.material.colPrim = {
+  mat.colPrim = {
     t3dMat.primColor[0] / 255.0f,
     t3dMat.primColor[1] / 255.0f,
     t3dMat.primColor[2] / 255.0f,
     t3dMat.primColor[3] / 255.0f
   };
-  part.material.colEnv = {
+  mat.colEnv = {
     t3dMat.envColor[0] / 255.0f,
     t3dMat.envColor[1] / 255.0f,
     t3dMat.envColor[2] / 255.0f,
     t3dMat.envColor[3] / 255.0f,
   };
 
-  part.material.mask = {
+  mat.mask = {
     texA.s.mask, texA.t.mask,
     texB.s.mask, texB.t.mask,
   };
-  part.material.low = {
+  mat.low = {
     texA.s.low, texA.t.low,
     texB.s.low, texB.t.low,
   };
-  part.material.high = {
+  mat.high = {
     texA.s.high, texA.t.high,
     texB.s.high, texB.t.high,
   };
 
-  part.material.mask = {
+  mat.mask = {
     std::pow(2, texA.s.mask),
     std::pow(2, texA.t.mask),
     std::pow(2, texB.s.mask),
     std::pow(2, texB.t.mask),
   };
 
-  part.material.shift = {
+  mat.shift = {
     1.0f / std::pow(2, texA.s.shift),
     1.0f / std::pow(2, texA.t.shift),
     1.0f / std::pow(2, texB.s.shift),
@@ -126,13 +193,13 @@ void Renderer::N64Material::convert(N64Mesh::MeshPart &part, const T3DM::Materia
  if t1.S.mirror: conf[14] = -conf[14]
  if t1.T.mirror: conf[15] = -conf[15]
   */
-  if (texA.s.clamp) part.material.mask[0] = -part.material.mask[0];
-  if (texA.t.clamp) part.material.mask[1] = -part.material.mask[1];
-  if (texB.s.clamp) part.material.mask[2] = -part.material.mask[2];
-  if (texB.t.clamp) part.material.mask[3] = -part.material.mask[3];
-
-  if (texA.s.mirror) part.material.high[0] = -part.material.high[0];
-  if (texA.t.mirror) part.material.high[1] = -part.material.high[1];
-  if (texB.s.mirror) part.material.high[2] = -part.material.high[2];
-  if (texB.t.mirror) part.material.high[3] = -part.material.high[3];
+  if (texA.s.clamp) mat.mask[0] = -mat.mask[0];
+  if (texA.t.clamp) mat.mask[1] = -mat.mask[1];
+  if (texB.s.clamp) mat.mask[2] = -mat.mask[2];
+  if (texB.t.clamp) mat.mask[3] = -mat.mask[3];
+
+  if (texA.s.mirror) mat.high[0] = -mat.high[0];
+  if (texA.t.mirror) mat.high[1] = -mat.high[1];
+  if (texB.s.mirror) mat.high[2] = -mat.high[2];
+  if (texB.t.mirror) mat.high[3] = -mat.high[3];
 }
@@ -8,5 +8,11 @@
 
 namespace Renderer::N64Material
 {
-  void convert(N64Mesh::MeshPart &part, const T3DM::Material &t3dMat);
+  void convert(UniformN64Material &mat, const T3DM::Material &t3dMat);
+
+  // identical for materials that convert to the same uniforms, textures are not included
+  std::string getKey(const T3DM::Material &t3dMat);
+
+  // specialised shader for the combiner setup (see 'shader/ccVariants.h'), 0 for the uber-shader
+  uint32_t getVariant(const UniformN64Material &mat);
 }
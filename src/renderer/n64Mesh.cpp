@@ -6,6 +6,7 @@
 #include "../context.h"
 #include "../project/assetManager.h"
 #include <filesystem>
+#include <unordered_map>
 
 #include "scene.h"
 #include "n64/n64Material.h"
@@ -25,6 +26,10 @@ void Renderer::N64Mesh::fromT3DM(const T3DM::T3DMData &t3dmData, Project::AssetM
   mesh.vertices.clear();
   mesh.indices.clear();
   parts.clear();
+  materials.clear();
+
+  // models often split into many parts with only a few distinct materials
+  std::unordered_map<std::string, uint32_t> materialIndices{};
 
   parts.resize(t3dmData.models.size());
   auto part = parts.begin();
@@ -38,7 +43,12 @@ void Renderer::N64Mesh::fromT3DM(const T3DM::T3DMData &t3dmData, Project::AssetM
     part->indicesOffset = mesh.indices.size();
     part->indicesCount = model.triangles.size() * 3;
 
-    N64Material::convert(*part, model.material);
+    auto [matIt, isNewMat] = materialIndices.try_emplace(N64Material::getKey(model.material), (uint32_t)materials.size());
+    if (isNewMat) {
+      N64Material::convert(materials.emplace_back(), model.material);
+    }
+    part->materialIdx = matIt->second;
+    part->shaderVariant = N64Material::getVariant(materials[part->materialIdx]);
 
     part->texBindings[0].texture = part->refTex0.lock()->getGPUTex();
     part->texBindings[0].sampler = texSamplerRepeat;
@@ -107,6 +117,21 @@ void Renderer::N64Mesh::draw(
 {
   if (!scene)return;
 
+  // lights are the same for all parts
+  const glm::vec4 *ambientColor = nullptr;
+  const Light *dirLights[2]{};
+  int dirLightCount = 0;
+  for (auto &light : scene->getLights()) {
+    if (light.type == 0) {
+      ambientColor = &light.color;
+    } else if (dirLightCount < 2) {
+      dirLights[dirLightCount++] = &light;
+    }
+  }
+
+  // callers bind the 'n64' pipeline, parts with a specialised one switch to it and back at the end
+  const Pipeline* boundVariant = nullptr;
+
   auto drawPart = [&](MeshPart &part)
   {
     if(part.refTex1.expired() || part.refTex0.expired()) {
@@ -114,41 +139,38 @@ void Renderer::N64Mesh::draw(
       return;
     }
 
+    auto variant = part.shaderVariant ? scene->getPipelineN64Variant(part.shaderVariant) : nullptr;
+    if(variant != boundVariant) {
+      (variant ? *variant : scene->getPipeline("n64")).bind(pass);
+      boundVariant = variant;
+    }
+
     uint32_t flags = uniforms.mat.flags;
+    auto &material = materials[part.materialIdx];
 
-    if(part.material.flags & UniformN64Material::FLAG_SET_PRIM_COL) {
-      lastPrim = part.material.colPrim;
+    if(material.flags & UniformN64Material::FLAG_SET_PRIM_COL) {
+      lastPrim = material.colPrim;
     } else {
       if(overrides.setPrim)lastPrim = overrides.colPrim;
     }
 
-    if(part.material.flags & UniformN64Material::FLAG_SET_ENV_COL) {
-      lastEnv = part.material.colEnv;
+    if(material.flags & UniformN64Material::FLAG_SET_ENV_COL) {
+      lastEnv = material.colEnv;
     } else {
       if(overrides.setEnv)lastEnv = overrides.colEnv;
     }
 
-    uniforms.mat = part.material;
+    uniforms.mat = material;
     uniforms.mat.colPrim = lastPrim;
     uniforms.mat.colEnv = lastEnv;
 
     uniforms.mat.flags |= flags;
 
-    // @TODO: move out
     float clip = uniforms.mat.lightDir[0].w;
-    const auto &lights = scene->getLights();
-    int lightIdx = 0;
-    for (auto &light : lights) {
-      if (light.type == 0) {
-        uniforms.mat.ambientColor = light.color;
-      } else {
-        if (lightIdx < 2)
-        {
-          uniforms.mat.lightDir[lightIdx] = glm::vec4(light.dir, 0.0f);
-          uniforms.mat.lightColor[lightIdx] = light.color;
-          ++lightIdx;
-        }
-      }
+    if (ambientColor)uniforms.mat.ambientColor = *ambientColor;
+    for (int i=0; i<dirLightCount; ++i) {
+      uniforms.mat.lightDir[i] = glm::vec4(dirLights[i]->dir, 0.0f);
+      uniforms.mat.lightColor[i] = dirLights[i]->color;
     }
     uniforms.mat.lightDir[0].w = clip;
 
@@ -173,5 +195,6 @@ void Renderer::N64Mesh::draw(
       }
     }
   }
+  if(boundVariant)scene->getPipeline("n64").bind(pass);
   //mesh.draw(pass);
 }
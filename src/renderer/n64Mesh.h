@@ -19,7 +19,8 @@ namespace Renderer
       {
         uint32_t indicesOffset{0};
         uint32_t indicesCount{0};
-        UniformN64Material material{};
+        uint32_t materialIdx{0}; // into 'materials', shared by all parts with the same settings
+        uint32_t shaderVariant{0}; // see 'N64Material::getVariant'
 
         SDL_GPUTextureSamplerBinding texBindings[2]{};
 
@@ -30,6 +31,7 @@ namespace Renderer
 
       Mesh mesh{};
       std::vector<MeshPart> parts{};
+      std::vector<UniformN64Material> materials{};
       bool loaded{false};
       Renderer::Scene *scene{};
 
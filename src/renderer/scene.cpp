@@ -11,8 +11,19 @@
 
 #include "framebuffer.h"
 #include "shader.h"
+#include "../shader/ccVariants.h"
 
 Renderer::Scene::Scene()
+{
+  /**
+   * The driver compiles the shaders only once the pipelines are created, which is the slowest part of startup.
+   * Nothing draws 3D before a project is open, so that happens in the background until 'getPipeline' needs them.
+   * Compiled pipelines are cached on disk by the drivers themselves, SDL_GPU has no cache of its own.
+   */
+  pipelinesReady = std::async(std::launch::async, [this]{ createPipelines(); });
+}
+
+void Renderer::Scene::createPipelines()
 {
   shaderN64 = std::make_unique<Shader>(ctx.gpu, Shader::Config{
     .name = "n64",
@@ -36,19 +47,40 @@ Renderer::Scene::Scene()
     .fragTexCount = 1,
   });
 
-  pipelineN64 = std::make_unique<Pipeline>(Pipeline::Info{
-    .shader = *shaderN64,
-    .prim = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
-    .useDepth = true,
-    .drawsObjID = true,
-    .translucent = true,
-    .vertPitch = sizeof(Vertex),
-    .vertLayout = {
-      {SDL_GPU_VERTEXELEMENTFORMAT_SHORT4     , offsetof(Renderer::Vertex, pos)},
-      {SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM, offsetof(Renderer::Vertex, color)},
-      {SDL_GPU_VERTEXELEMENTFORMAT_SHORT2    ,  offsetof(Renderer::Vertex, uv)},
+  auto createPipelineN64 = [](const Shader &shader) {
+    return std::make_unique<Pipeline>(Pipeline::Info{
+      .shader = shader,
+      .prim = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+      .useDepth = true,
+      .drawsObjID = true,
+      .translucent = true,
+      .vertPitch = sizeof(Vertex),
+      .vertLayout = {
+        {SDL_GPU_VERTEXELEMENTFORMAT_SHORT4     , offsetof(Renderer::Vertex, pos)},
+        {SDL_GPU_VERTEXELEMENTFORMAT_UBYTE4_NORM, offsetof(Renderer::Vertex, color)},
+        {SDL_GPU_VERTEXELEMENTFORMAT_SHORT2    ,  offsetof(Renderer::Vertex, uv)},
+      }
+    });
+  };
+  pipelineN64 = createPipelineN64(*shaderN64);
+
+  // specialised combiner setups, any missing one (e.g. shaders not rebuilt yet) falls back to the uber-shader
+  shaderN64Variants.resize(CC_VARIANT_COUNT + 1);
+  pipelineN64Variants.resize(CC_VARIANT_COUNT + 1);
+  for(uint32_t i=1; i<=CC_VARIANT_COUNT; ++i) {
+    auto variantName = "_cc" + std::to_string(i);
+    shaderN64Variants[i] = std::make_unique<Shader>(ctx.gpu, Shader::Config{
+      .name = "n64",
+      .vertUboCount = 2,
+      .fragUboCount = 1,
+      .vertTexCount = 2,
+      .fragTexCount = 2,
+      .fragVariant = variantName.c_str(),
+    });
+    if(shaderN64Variants[i]->isValid()) {
+      pipelineN64Variants[i] = createPipelineN64(*shaderN64Variants[i]);
     }
-  });
+  }
 
   pipelineLines = std::make_unique<Pipeline>(Pipeline::Info{
     .shader = *shaderLines,
@@ -79,6 +111,12 @@ Renderer::Scene::Scene()
 
 Renderer::Scene::~Scene() {
   //SDL_ReleaseGPUTexture(ctx.gpu, fb3D);
+  if(pipelinesReady.valid())pipelinesReady.wait();
+}
+
+void Renderer::Scene::waitForPipelines() const {
+  // rethrows errors of the creation (e.g. an unsupported backend), once
+  if(pipelinesReady.valid())pipelinesReady.get();
 }
 
 void Renderer::Scene::update()
@@ -4,6 +4,7 @@
 */
 #pragma once
 #include <functional>
+#include <future>
 #include <memory>
 #include <SDL3/SDL.h>
 
@@ -42,9 +43,16 @@ namespace Renderer
       std::unique_ptr<Pipeline> pipelineN64{};
       std::unique_ptr<Pipeline> pipelineLines{};
       std::unique_ptr<Pipeline> pipelineSprites{};
+      // index is the variant, see 'N64Material::getVariant', unset if not available
+      std::vector<std::unique_ptr<Shader>> shaderN64Variants{};
+      std::vector<std::unique_ptr<Pipeline>> pipelineN64Variants{};
+      mutable std::future<void> pipelinesReady{};
 
       std::vector<Light> lights{};
 
+      void createPipelines();
+      void waitForPipelines() const;
+
     public:
       Scene();
       ~Scene();
@@ -68,10 +76,17 @@ namespace Renderer
       void addOneTimeCopyPass(const CbCopyPass& pass) { copyPassesOneTime.push_back(pass); }
 
       Pipeline& getPipeline(const std::string &name) const {
+        waitForPipelines();
         if (name == "n64") return *pipelineN64;
         if (name == "lines") return *pipelineLines;
         if (name == "sprites") return *pipelineSprites;
         throw std::runtime_error("Pipeline not found: " + name);
       }
+
+      // specialised 'n64' pipeline for a combiner setup, null if it doesn't have one
+      const Pipeline* getPipelineN64Variant(uint32_t variant) const {
+        waitForPipelines();
+        return variant < pipelineN64Variants.size() ? pipelineN64Variants[variant].get() : nullptr;
+      }
   };
 }
@@ -18,7 +18,7 @@ Renderer::Shader::Shader(SDL_GPUDevice* device, const Config &conf)
 	SDL_GPUShaderFormat format = SDL_GPU_SHADERFORMAT_INVALID;
 
   std::string pathVert = "data/shader/" + conf.name + ".vert.";
-  std::string pathFrag = "data/shader/" + conf.name + ".frag.";
+  std::string pathFrag = "data/shader/" + conf.name + conf.fragVariant + ".frag.";
   const char* entrypoint{};
 
   if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV) {
@@ -45,7 +45,11 @@ Renderer::Shader::Shader(SDL_GPUDevice* device, const Config &conf)
 
   size_t fragmentCodeSize;
   void* fragmentCode = SDL_LoadFile(pathFrag.c_str(), &fragmentCodeSize);
-  assert(vertexCode != nullptr);
+  if(!fragmentCode) {
+    assert(conf.fragVariant[0] != '\0');
+    SDL_free(vertexCode);
+    return;
+  }
 
   SDL_GPUShaderCreateInfo vertexInfo{};
   vertexInfo.code = (Uint8*)vertexCode;
@@ -80,6 +84,6 @@ Renderer::Shader::Shader(SDL_GPUDevice* device, const Config &conf)
 
 Renderer::Shader::~Shader()
 {
-  SDL_ReleaseGPUShader(gpuDevice, shaderVert);
-  SDL_ReleaseGPUShader(gpuDevice, shaderFrag);
+  if(shaderVert)SDL_ReleaseGPUShader(gpuDevice, shaderVert);
+  if(shaderFrag)SDL_ReleaseGPUShader(gpuDevice, shaderFrag);
 }
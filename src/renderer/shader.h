@@ -24,11 +24,15 @@ namespace Renderer
         uint32_t fragUboCount{0};
         uint32_t vertTexCount{0};
         uint32_t fragTexCount{0};
+        // appended to the name of the fragment shader, those are optional and may not exist (see 'isValid')
+        const char* fragVariant{""};
       };
 
       Shader(SDL_GPUDevice* device, const Config &conf);
       ~Shader();
 
+      [[nodiscard]] bool isValid() const { return shaderVert && shaderFrag; }
+
       void setToPipeline(SDL_GPUGraphicsPipelineCreateInfo &pipelineInfo) const {
         pipelineInfo.vertex_shader = shaderVert;
         pipelineInfo.fragment_shader = shaderFrag;
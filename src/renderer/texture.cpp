@@ -11,11 +11,8 @@
 
 extern SDL_GPUSampler *texSamplerRepeat;
 
-Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bool isMono, int rasterWidth, int rasterHeight)
-  : gpuDevice(device)
+SDL_Surface* Renderer::Texture::decode(const std::string &imgPath, bool isMono, int rasterWidth, int rasterHeight)
 {
-  if(!gpuDevice)return; // CLI mode
-
   SDL_Surface *imgRaw;
   if (imgPath.ends_with(".svg") && rasterWidth > 0 && rasterHeight > 0) {
     auto imgStream = SDL_IOFromFile(imgPath.c_str(), "rb");
@@ -23,8 +20,11 @@ Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bo
   } else {
     imgRaw = IMG_Load(imgPath.c_str());
   }
+  if(!imgRaw)return nullptr;
 
   auto img = SDL_ConvertSurface(imgRaw, SDL_PIXELFORMAT_BGRA32);
+  SDL_DestroySurface(imgRaw);
+  if(!img)return nullptr;
 
   if(isMono)
   {
@@ -41,9 +41,35 @@ Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bo
     }
     SDL_UnlockSurface(img);
   }
+  return img;
+}
 
-  SDL_DestroySurface(imgRaw);
+Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bool isMono, int rasterWidth, int rasterHeight)
+  : gpuDevice(device)
+{
+  if(!gpuDevice)return; // CLI mode
+
+  auto img = decode(imgPath, isMono, rasterWidth, rasterHeight);
+  if(!img)return;
+  create(img);
+  SDL_DestroySurface(img);
+
+  SDL_GPUCommandBuffer* cmd = SDL_AcquireGPUCommandBuffer(device);
+  SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(cmd);
+  upload(*copy_pass);
+  SDL_EndGPUCopyPass(copy_pass);
+  SDL_SubmitGPUCommandBuffer(cmd);
+}
+
+Renderer::Texture::Texture(SDL_GPUDevice* device, SDL_Surface *img)
+  : gpuDevice(device)
+{
+  if(!gpuDevice || !img)return;
+  create(img);
+}
 
+void Renderer::Texture::create(SDL_Surface *img)
+{
   width = img->w;
   height = img->h;
   char* image_data = (char*)img->pixels;
@@ -61,26 +87,34 @@ Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bo
   texture_info.num_levels = 1;
   texture_info.sample_count = SDL_GPU_SAMPLECOUNT_1;
 
-  texture = SDL_CreateGPUTexture(device, &texture_info);
+  texture = SDL_CreateGPUTexture(gpuDevice, &texture_info);
 
   // Create transfer buffer
   // FIXME: A real engine would likely keep one around, see what the SDL_GPU backend is doing.
   SDL_GPUTransferBufferCreateInfo transferbuffer_info = {};
   transferbuffer_info.usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD;
   transferbuffer_info.size = width * height * 4;
-  SDL_GPUTransferBuffer* transferbuffer = SDL_CreateGPUTransferBuffer(device, &transferbuffer_info);
-  assert(transferbuffer != nullptr);
+  pendingUpload = SDL_CreateGPUTransferBuffer(gpuDevice, &transferbuffer_info);
+  assert(pendingUpload != nullptr);
 
   // Copy to transfer buffer
   uint32_t upload_pitch = width * 4;
-  void* texture_ptr = SDL_MapGPUTransferBuffer(device, transferbuffer, true);
+  void* texture_ptr = SDL_MapGPUTransferBuffer(gpuDevice, pendingUpload, true);
   for (int y = 0; y < height; y++)
-      memcpy((void*)((uintptr_t)texture_ptr + y * upload_pitch), image_data + y * upload_pitch, upload_pitch);
-  SDL_UnmapGPUTransferBuffer(device, transferbuffer);
+      memcpy((void*)((uintptr_t)texture_ptr + y * upload_pitch), image_data + y * img->pitch, upload_pitch);
+  SDL_UnmapGPUTransferBuffer(gpuDevice, pendingUpload);
+
+  texBinding.texture = texture;
+  texBinding.sampler = texSamplerRepeat;
+}
+
+void Renderer::Texture::upload(SDL_GPUCopyPass &pass)
+{
+  if(!pendingUpload)return;
 
   SDL_GPUTextureTransferInfo transfer_info = {};
   transfer_info.offset = 0;
-  transfer_info.transfer_buffer = transferbuffer;
+  transfer_info.transfer_buffer = pendingUpload;
 
   SDL_GPUTextureRegion texture_region = {};
   texture_region.texture = texture;
@@ -90,21 +124,13 @@ Renderer::Texture::Texture(SDL_GPUDevice* device, const std::string &imgPath, bo
   texture_region.h = (Uint32)height;
   texture_region.d = 1;
 
-  SDL_GPUCommandBuffer* cmd = SDL_AcquireGPUCommandBuffer(device);
-  SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(cmd);
-  SDL_UploadToGPUTexture(copy_pass, &transfer_info, &texture_region, false);
-  SDL_EndGPUCopyPass(copy_pass);
-  SDL_SubmitGPUCommandBuffer(cmd);
-
-  SDL_ReleaseGPUTransferBuffer(device, transferbuffer);
-
-  SDL_DestroySurface(img);
-
-  texBinding.texture = texture;
-  texBinding.sampler = texSamplerRepeat;
+  SDL_UploadToGPUTexture(&pass, &transfer_info, &texture_region, false);
+  SDL_ReleaseGPUTransferBuffer(gpuDevice, pendingUpload);
+  pendingUpload = nullptr;
 }
 
 Renderer::Texture::~Texture() {
+ if(pendingUpload)SDL_ReleaseGPUTransferBuffer(gpuDevice, pendingUpload);
  SDL_ReleaseGPUTexture(gpuDevice, texture);
 }
 
@@ -5,6 +5,7 @@
 #pragma once
 #include <string>
 #include <SDL3/SDL_gpu.h>
+#include <SDL3/SDL_surface.h>
 
 #include "imgui.h"
 
@@ -21,10 +22,31 @@ namespace Renderer
       int width{0};
       int height{0};
 
+      SDL_GPUTransferBuffer* pendingUpload{nullptr};
+
+      void create(SDL_Surface *img);
+
     public:
+      /**
+       * Loads and converts an image into the format textures use, doesn't touch the GPU.
+       * Safe to call from any thread, the result must be freed with 'SDL_DestroySurface'.
+       * @return nullptr if the image can't be loaded
+       */
+      static SDL_Surface* decode(const std::string &imgPath, bool isMono = false, int rasterWidth = 0, int rasterHeight = 0);
+
       Texture(SDL_GPUDevice* device, const std::string &imgPath, bool isMono = false, int rasterWidth = 0, int rasterHeight = 0);
+
+      /**
+       * Creates a texture from a decoded image (see 'decode'), the data is only sent once 'upload' is called.
+       */
+      Texture(SDL_GPUDevice* device, SDL_Surface *img);
       ~Texture();
 
+      /**
+       * Uploads data given in the constructor, does nothing if already done.
+       */
+      void upload(SDL_GPUCopyPass &pass);
+
       [[nodiscard]] int getWidth() const { return width; };
       [[nodiscard]] int getHeight() const { return height; };
       [[nodiscard]] SDL_GPUTexture* getGPUTex() const { return texture; };
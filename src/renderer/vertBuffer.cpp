@@ -4,6 +4,23 @@
 */
 #include "vertBuffer.h"
 
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+  constexpr uint32_t MIN_CAPACITY = 256;
+
+  // leaves room to grow, so meshes that change every frame (lines, sprites) don't need a new buffer each time
+  uint32_t getCapacity(uint32_t size, uint32_t currCapacity)
+  {
+    if(size <= currCapacity && currCapacity != 0)return currCapacity;
+    uint32_t res = std::max(MIN_CAPACITY, currCapacity + currCapacity / 2);
+    while(res < size)res += res / 2;
+    return (res + 15) & ~15u; // keeps the index part aligned
+  }
+}
+
 Renderer::VertBuffer::VertBuffer(SDL_GPUDevice* device)
   : gpuDevice{device}
 {
@@ -13,85 +30,104 @@ Renderer::VertBuffer::~VertBuffer()
 {
   SDL_ReleaseGPUBuffer(gpuDevice, buffer);
   SDL_ReleaseGPUTransferBuffer(gpuDevice, bufferTrans);
-
-  SDL_ReleaseGPUBuffer(gpuDevice, bufferIdx);
-  SDL_ReleaseGPUTransferBuffer(gpuDevice, bufferIdxTrans);
 }
 
 void Renderer::VertBuffer::resize(uint32_t sizeVert, uint32_t sizeIndex) {
   assert(sizeVert != 0);
   assert(sizeIndex != 0);
 
+  // releasing is deferred by SDL until the GPU is done with them
+  if(buffer)SDL_ReleaseGPUBuffer(gpuDevice, buffer);
+  if(bufferTrans)SDL_ReleaseGPUTransferBuffer(gpuDevice, bufferTrans);
+
+  capacityVert = getCapacity(sizeVert, capacityVert);
+  capacityIdx = getCapacity(sizeIndex, capacityIdx);
+
   SDL_GPUBufferCreateInfo bufferInfo{
-    .usage = SDL_GPU_BUFFERUSAGE_VERTEX,
-    .size = sizeVert
+    .usage = SDL_GPU_BUFFERUSAGE_VERTEX | SDL_GPU_BUFFERUSAGE_INDEX,
+    .size = capacityVert + capacityIdx
   };
   buffer = SDL_CreateGPUBuffer(gpuDevice, &bufferInfo);
   assert(buffer != nullptr);
 
   SDL_GPUTransferBufferCreateInfo transferInfo{
     .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-    .size = sizeVert
+    .size = capacityVert + capacityIdx
   };
   bufferTrans = SDL_CreateGPUTransferBuffer(gpuDevice, &transferInfo);
   assert(bufferTrans != nullptr);
 
-  bufferInfo.usage = SDL_GPU_BUFFERUSAGE_INDEX;
-  bufferInfo.size = sizeIndex;
-  bufferIdx = SDL_CreateGPUBuffer(gpuDevice, &bufferInfo);
-  assert(bufferIdx != nullptr);
+  // new buffer has no contents yet
+  lastVerts.clear();
+  lastIndices.clear();
+  dirtyVert = {};
+  dirtyIdx = {};
+}
 
-  transferInfo = {
-    .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD,
-    .size = sizeIndex
-  };
-  bufferIdxTrans = SDL_CreateGPUTransferBuffer(gpuDevice, &transferInfo);
-  assert(bufferIdxTrans != nullptr);
+void Renderer::VertBuffer::writeRegion(
+  std::vector<char> &last, Range &dirty, const char* data, uint32_t size, uint32_t offset, bool fullWrite
+) {
+  Range range{0, size};
+  if(!fullWrite)
+  {
+    // anything past the old size is new, so only the common part needs a compare
+    uint32_t common = std::min<uint32_t>(size, last.size());
+    while(range.begin < common && last[range.begin] == data[range.begin])++range.begin;
+    if(size <= last.size()) {
+      while(range.end > range.begin && last[range.end-1] == data[range.end-1])--range.end;
+    }
+  }
+
+  if(setCount > 1)last.assign(data, data + size);
+  if(range.empty())return;
+
+  // a pending range is uploaded in one go, so everything between it and the new one gets written too
+  dirty.add({offset + range.begin, offset + range.end});
+  dirty.end = std::min(dirty.end, offset + size);
+  std::memcpy(mappedTrans + dirty.begin, data + (dirty.begin - offset), dirty.end - dirty.begin);
 }
 
 void Renderer::VertBuffer::setData(char* verts, uint32_t vertsSize, const std::vector<uint16_t>&indices)
 {
-  currIdxByteSize = indices.size() * sizeof(uint16_t);
+  auto idxSize = static_cast<uint32_t>(indices.size() * sizeof(uint16_t));
+  bool fullWrite = setCount < 2;
+  ++setCount;
 
-  if (vertsSize != currVertByteSize) {
-    resize(vertsSize, currIdxByteSize);
+  if (vertsSize > capacityVert || idxSize > capacityIdx || !buffer) {
+    resize(vertsSize, idxSize);
+    fullWrite = true;
   }
   currVertByteSize = vertsSize;
+  currIdxByteSize = idxSize;
 
-// @TODO: store vert/indices in one single buffer
-
-  auto data = (Vertex*)SDL_MapGPUTransferBuffer(gpuDevice, bufferTrans, false);
-  SDL_memcpy(data, verts, currVertByteSize);
-  SDL_UnmapGPUTransferBuffer(gpuDevice, bufferTrans);
+  // an upload still waiting in the copy pass has to keep what it wrote, a finished one doesn't matter
+  bool uploadPending = !dirtyVert.empty() || !dirtyIdx.empty();
+  mappedTrans = static_cast<char*>(SDL_MapGPUTransferBuffer(gpuDevice, bufferTrans, !uploadPending));
+  if(!mappedTrans)return;
 
-  data = (Vertex*)SDL_MapGPUTransferBuffer(gpuDevice, bufferIdxTrans, false);
-  SDL_memcpy(data, indices.data(), currIdxByteSize);
-  SDL_UnmapGPUTransferBuffer(gpuDevice, bufferIdxTrans);
+  writeRegion(lastVerts, dirtyVert, verts, vertsSize, 0, fullWrite);
+  writeRegion(lastIndices, dirtyIdx, (const char*)indices.data(), idxSize, capacityVert, fullWrite);
 
-  needsUpload = true;
+  SDL_UnmapGPUTransferBuffer(gpuDevice, bufferTrans);
+  mappedTrans = nullptr;
 }
 
 void Renderer::VertBuffer::upload(SDL_GPUCopyPass &pass) {
-  if (!needsUpload || currVertByteSize == 0)return;
-
-  SDL_GPUTransferBufferLocation location{};
-  location.transfer_buffer = bufferTrans;
-  location.offset = 0;
-
-  SDL_GPUBufferRegion region{};
-  region.buffer = buffer;
-  region.size = currVertByteSize;
-  region.offset = 0;
-
-  SDL_UploadToGPUBuffer(&pass, &location, &region, true);
-
-  location = {};
-  location.transfer_buffer = bufferIdxTrans;
-  region = {};
-  region.buffer = bufferIdx;
-  region.size = currIdxByteSize;
-
-  SDL_UploadToGPUBuffer(&pass, &location, &region, true);
-
-  needsUpload = false;
+  for(auto *range : {&dirtyVert, &dirtyIdx})
+  {
+    if(range->empty())continue;
+
+    SDL_GPUTransferBufferLocation location{};
+    location.transfer_buffer = bufferTrans;
+    location.offset = range->begin;
+
+    SDL_GPUBufferRegion region{};
+    region.buffer = buffer;
+    region.offset = range->begin;
+    region.size = range->end - range->begin;
+
+    // cycling would drop the parts that didn't change, SDL orders it after earlier draws instead
+    SDL_UploadToGPUBuffer(&pass, &location, &region, false);
+    *range = {};
+  }
 }
@@ -3,6 +3,8 @@
 * @license MIT
 */
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,22 +13,50 @@
 
 namespace Renderer
 {
+  /**
+   * Vertices and indices of a mesh, stored in one GPU buffer ('[vertices... | indices...]').
+   * The buffer only grows, and once data got set more than once (dynamic meshes)
+   * only the bytes that changed since the last call are uploaded.
+   */
   class VertBuffer
   {
     private:
+      struct Range
+      {
+        uint32_t begin{0};
+        uint32_t end{0};
+
+        [[nodiscard]] bool empty() const { return begin >= end; }
+        void add(const Range &r) {
+          if(r.empty())return;
+          if(empty()) { *this = r; return; }
+          begin = std::min(begin, r.begin);
+          end = std::max(end, r.end);
+        }
+      };
+
       SDL_GPUDevice* gpuDevice{nullptr};
 
       SDL_GPUBuffer* buffer{nullptr};
       SDL_GPUTransferBuffer* bufferTrans{nullptr};
-
-      SDL_GPUBuffer* bufferIdx{nullptr};
-      SDL_GPUTransferBuffer* bufferIdxTrans{nullptr};
+      char* mappedTrans{nullptr}; // only set during 'setData'
+      uint32_t capacityVert{0};
+      uint32_t capacityIdx{0};
 
       size_t currVertByteSize{0};
       size_t currIdxByteSize{0};
-      bool needsUpload{false};
+
+      // copy of the last data, to find what changed (only kept for dynamic meshes)
+      std::vector<char> lastVerts{};
+      std::vector<char> lastIndices{};
+      uint32_t setCount{0};
+
+      // byte ranges of 'buffer' waiting for 'upload'
+      Range dirtyVert{};
+      Range dirtyIdx{};
 
       void resize(uint32_t sizeVert, uint32_t sizeIndex);
+      void writeRegion(std::vector<char> &last, Range &dirty, const char* data, uint32_t size, uint32_t offset, bool fullWrite);
 
       void setData(char* verts, uint32_t vertsSize,
         const std::vector<uint16_t> &indices
@@ -64,8 +94,8 @@ namespace Renderer
         binding[0].buffer = buffer;
         binding[0].offset = 0;
 
-        binding[1].buffer = bufferIdx;
-        binding[1].offset = 0;
+        binding[1].buffer = buffer;
+        binding[1].offset = capacityVert;
       }
 
       uint32_t getIndexCount() const {
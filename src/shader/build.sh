@@ -6,22 +6,19 @@ OUT_DIR="../../data/shader"
 
 mkdir -p "$OUT_DIR"
 
-for shader in *.vert.glsl *.frag.glsl; do
-    # Skip if glob didn’t match anything
-    [ -e "$shader" ] || continue
-
-    base="${shader%.glsl}"          # n64.vert or n64.frag
-    name="${base%.*}"               # n64
-    stage="${base##*.}"              # vert or frag
+# compile_shader <source> <stage> <output name> [glslc args...]
+compile_shader() {
+    local shader="$1" stage="$2" base="$3"
+    shift 3
 
-    spv="$OUT_DIR/$base.spv"
-    hlsl="$OUT_DIR/$base.hlsl"
-    dxil="$OUT_DIR/$base.dxil"
+    local spv="$OUT_DIR/$base.spv"
+    local hlsl="$OUT_DIR/$base.hlsl"
+    local dxil="$OUT_DIR/$base.dxil"
 
-    echo "=== Compiling $shader ($stage) ==="
+    echo "=== Compiling $shader ($stage) -> $base ==="
 
     # GLSL -> SPIR-V
-    glslc -fshader-stage="$stage" "$shader" -o "$spv"
+    glslc -fshader-stage="$stage" "$@" "$shader" -o "$spv"
 
     # SPIR-V -> HLSL
     spirv-cross \
@@ -39,4 +36,20 @@ for shader in *.vert.glsl *.frag.glsl; do
     fi
 
     rm "$hlsl"
-done
\ No newline at end of file
+}
+
+for shader in *.vert.glsl *.frag.glsl; do
+    # Skip if glob didn’t match anything
+    [ -e "$shader" ] || continue
+
+    base="${shader%.glsl}"          # n64.vert or n64.frag
+    stage="${base##*.}"              # vert or frag
+
+    compile_shader "$shader" "$stage" "$base"
+done
+
+# specialised combiner setups of the n64 shader, see 'ccVariants.h'
+variantCount=$(sed -n 's/^#define CC_VARIANT_COUNT \([0-9]*\).*/\1/p' ccVariants.h)
+for variant in $(seq 1 "$variantCount"); do
+    compile_shader n64.frag.glsl frag "n64_cc$variant.frag" -DCC_VARIANT="$variant"
+done
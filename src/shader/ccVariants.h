@@ -0,0 +1,25 @@
+// Combiner setups that get their own build of 'n64.frag' (as 'n64_ccN.frag'), with the inputs known at compile time.
+// Only 1-cycle setups, everything else uses the uber-shader.
+// Shared with the editor (see 'Renderer::N64Material::getVariant'), both must list the same ones in the same order.
+// Per variant the color and alpha inputs (a, b, c, d) of the first cycle: (a - b) * c + d
+#define CC_VARIANT_COUNT 5
+
+// shade
+#define CC_VARIANT_1_COLOR CC_C_0, CC_C_0, CC_C_0, CC_C_SHADE
+#define CC_VARIANT_1_ALPHA CC_A_0, CC_A_0, CC_A_0, CC_A_SHADE
+
+// texture * shade
+#define CC_VARIANT_2_COLOR CC_C_TEX0, CC_C_0, CC_C_SHADE, CC_C_0
+#define CC_VARIANT_2_ALPHA CC_A_TEX0, CC_A_0, CC_A_SHADE, CC_A_0
+
+// texture
+#define CC_VARIANT_3_COLOR CC_C_0, CC_C_0, CC_C_0, CC_C_TEX0
+#define CC_VARIANT_3_ALPHA CC_A_0, CC_A_0, CC_A_0, CC_A_TEX0
+
+// prim * shade
+#define CC_VARIANT_4_COLOR CC_C_PRIM, CC_C_0, CC_C_SHADE, CC_C_0
+#define CC_VARIANT_4_ALPHA CC_A_PRIM, CC_A_0, CC_A_SHADE, CC_A_0
+
+// texture * prim
+#define CC_VARIANT_5_COLOR CC_C_TEX0, CC_C_0, CC_C_PRIM, CC_C_0
+#define CC_VARIANT_5_ALPHA CC_A_TEX0, CC_A_0, CC_A_PRIM, CC_A_0
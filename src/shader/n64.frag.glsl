@@ -22,6 +22,20 @@ layout(set = 2, binding = 0) uniform sampler2D tex0;
 layout(set = 2, binding = 1) uniform sampler2D tex1;
 
 #include "./utils.glsl"
+#include "./ccVariants.h"
+
+// 'CC_VARIANT' is set for the specialised builds, see 'build.sh'
+#ifdef CC_VARIANT
+  #define CC_VARIANT_GET_(n, part) CC_VARIANT_##n##_##part
+  #define CC_VARIANT_GET(n, part) CC_VARIANT_GET_(n, part)
+  #define CC0_COLOR ivec4(CC_VARIANT_GET(CC_VARIANT, COLOR))
+  #define CC0_ALPHA ivec4(CC_VARIANT_GET(CC_VARIANT, ALPHA))
+  #define CC_IS_2CYCLE false
+#else
+  #define CC0_COLOR material.cc0Color
+  #define CC0_ALPHA material.cc0Alpha
+  #define CC_IS_2CYCLE ((OTHER_MODE_H & G_CYC_2CYCLE) != 0)
+#endif
 
 void fetchTex01Filtered(in ivec4 texSize, out vec4 texData0, out vec4 texData1)
 {
@@ -249,19 +263,19 @@ void main()
 
   // @TODO: emulate other formats, e.g. quantization?
 
-  cc0[0].rgb = cc_fetchColor(material.cc0Color.x, ccShade, ccValue, texData0, texData1);
-  cc0[1].rgb = cc_fetchColor(material.cc0Color.y, ccShade, ccValue, texData0, texData1);
-  cc0[2].rgb = cc_fetchColor(material.cc0Color.z, ccShade, ccValue, texData0, texData1);
-  cc0[3].rgb = cc_fetchColor(material.cc0Color.w, ccShade, ccValue, texData0, texData1);
+  cc0[0].rgb = cc_fetchColor(CC0_COLOR.x, ccShade, ccValue, texData0, texData1);
+  cc0[1].rgb = cc_fetchColor(CC0_COLOR.y, ccShade, ccValue, texData0, texData1);
+  cc0[2].rgb = cc_fetchColor(CC0_COLOR.z, ccShade, ccValue, texData0, texData1);
+  cc0[3].rgb = cc_fetchColor(CC0_COLOR.w, ccShade, ccValue, texData0, texData1);
 
-  cc0[0].a = cc_fetchAlpha(material.cc0Alpha.x, ccShade, ccValue, texData0, texData1);
-  cc0[1].a = cc_fetchAlpha(material.cc0Alpha.y, ccShade, ccValue, texData0, texData1);
-  cc0[2].a = cc_fetchAlpha(material.cc0Alpha.z, ccShade, ccValue, texData0, texData1);
-  cc0[3].a = cc_fetchAlpha(material.cc0Alpha.w, ccShade, ccValue, texData0, texData1);
+  cc0[0].a = cc_fetchAlpha(CC0_ALPHA.x, ccShade, ccValue, texData0, texData1);
+  cc0[1].a = cc_fetchAlpha(CC0_ALPHA.y, ccShade, ccValue, texData0, texData1);
+  cc0[2].a = cc_fetchAlpha(CC0_ALPHA.z, ccShade, ccValue, texData0, texData1);
+  cc0[3].a = cc_fetchAlpha(CC0_ALPHA.w, ccShade, ccValue, texData0, texData1);
 
   ccValue = cc_overflowValue((cc0[0] - cc0[1]) * cc0[2] + cc0[3]);
 
-  if((OTHER_MODE_H & G_CYC_2CYCLE) != 0) {
+  if(CC_IS_2CYCLE) {
     cc1[0].rgb = cc_fetchColor(material.cc1Color.x, ccShade, ccValue, texData0, texData1);
     cc1[1].rgb = cc_fetchColor(material.cc1Color.y, ccShade, ccValue, texData0, texData1);
     cc1[2].rgb = cc_fetchColor(material.cc1Color.z, ccShade, ccValue, texData0, texData1);
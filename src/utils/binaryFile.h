@@ -4,12 +4,16 @@
 */
 #pragma once
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
 #include <unordered_map>
 #include <bit>
 #include <stdexcept>
 #include <cstdint>
 #include <filesystem>
+#include <string>
+#include <vector>
 
 #include "glm/vec3.hpp"
 #include "glm/vec4.hpp"
@@ -35,22 +39,40 @@ namespace Utils
       uint32_t dataPos{};
       uint32_t dataSize{};
 
-      void writeRaw(const uint8_t* ptr, size_t size) {
-        if(dataPos+size > data.size()) {
-          data.resize(data.size() + size);
-        }
-        for(size_t i=0; i<size; ++i) {
-          data[dataPos++] = ptr[i];
+      // grows by 1.5x, so building large files write-by-write stays linear
+      void ensureSpace(size_t size) {
+        size_t needed = (size_t)dataPos + size;
+        if(needed > data.size()) {
+          data.resize(std::max({needed, data.size() + data.size() / 2, (size_t)256}));
         }
+      }
+
+      void writeRaw(const uint8_t* ptr, size_t size) {
+        if(size == 0)return;
+        ensureSpace(size);
+        memcpy(data.data() + dataPos, ptr, size);
+        dataPos += size;
         dataSize = std::max(dataSize, dataPos);
       }
 
     public:
 
+      /**
+       * Pre-allocates space for the given total size, useful if the final size is known upfront.
+       */
+      void reserve(uint32_t size) {
+        if(size > data.size())data.resize(size);
+      }
+
+      /**
+       * Writes zeros, overwriting any data that was already there.
+       */
       void skip(uint32_t bytes) {
-        for(uint32_t i=0; i<bytes; ++i) {
-          write<uint8_t>(0);
-        }
+        if(bytes == 0)return;
+        ensureSpace(bytes);
+        memset(data.data() + dataPos, 0, bytes);
+        dataPos += bytes;
+        dataSize = std::max(dataSize, dataPos);
       }
 
       template<typename T>
@@ -95,13 +117,18 @@ namespace Utils
       }
 
       void writeChars(const char* str, size_t len) {
-        for(size_t i=0; i<len; ++i)write<uint8_t>(str[i]);
+        writeRaw(reinterpret_cast<const uint8_t*>(str), len);
       }
 
       template<typename T>
       void writeArray(const T* arr, size_t count) {
-        for(size_t i=0; i<count; ++i) {
-          write(arr[i]);
+        if constexpr (sizeof(T) == 1 && std::is_integral_v<T>) {
+          writeRaw(reinterpret_cast<const uint8_t*>(arr), count);
+        } else {
+          ensureSpace(count * sizeof(T));
+          for(size_t i=0; i<count; ++i) {
+            write(arr[i]);
+          }
         }
       }
 
@@ -116,8 +143,7 @@ namespace Utils
           case s8: write<int8_t>(std::stol(str)); break;
           case OBJECT_REF: write<uint32_t>(std::stoul(str)); break;
           case string:
-            for(char c : str)write<uint8_t>(c);
-            write<uint8_t>(0);
+            writeChars(str.c_str(), str.size() + 1);
             break;
           default:
             throw std::runtime_error("unsupported data type");
@@ -160,10 +186,7 @@ namespace Utils
         uint32_t pos = getPos();
         uint32_t offset = pos % alignment;
         if(offset != 0) {
-          uint32_t padding = alignment - offset;
-          for(uint32_t i=0; i<padding; ++i) {
-            write<uint8_t>(0);
-          }
+          skip(alignment - offset);
         }
       }
 
@@ -171,11 +194,15 @@ namespace Utils
         return dataSize;
       }
 
-      void writeToFile(const fs::path &filename) {
+      /**
+       * Writes everything in one go, returns false if the file couldn't be written.
+       */
+      bool writeToFile(const fs::path &filename) {
         FILE* file = fopen(filename.string().c_str(), "wb");
-        fwrite(data.data(), 1, dataSize, file);
-        fflush(file);
-        fclose(file);
+        if(!file)return false;
+        bool success = fwrite(data.data(), 1, dataSize, file) == dataSize;
+        success = (fclose(file) == 0) && success;
+        return success;
       }
 
       std::vector<uint8_t> &getData() {
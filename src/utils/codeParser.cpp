@@ -4,12 +4,14 @@
 */
 #include "codeParser.h"
 
-#include <iostream>
-#include <fstream>
-#include <regex>
+#include <algorithm>
+#include <charconv>
+#include <mutex>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "hash.h"
 #include "logger.h"
 
 namespace
@@ -54,6 +56,75 @@ namespace
     return s.substr(start, end - start + 1);
   }
 
+  // entries are tiny, this only guards against ones piling up from edits in a long session
+  constexpr size_t MAX_CACHED_STRUCTS = 1024;
+
+  std::mutex cacheMtx{};
+  std::unordered_map<uint64_t, Utils::CPP::Struct> structCache{};
+
+  bool isDigit(char c) { return c >= '0' && c <= '9'; }
+  bool isWordChar(char c) { return isDigit(c) || c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'); }
+  bool isTypeChar(char c) { return isWordChar(c) || c == ':' || c == '<' || c == '>'; }
+
+  std::string_view trimSpace(std::string_view s) {
+    size_t start = s.find_first_not_of(" \t\n\r");
+    if (start == std::string_view::npos) return {};
+    size_t end = s.find_last_not_of(" \t\n\r");
+    return s.substr(start, end - start + 1);
+  }
+
+  // removes line and block comments, leaving string and char literals untouched
+  std::string stripComments(const std::string &src)
+  {
+    std::string res{};
+    res.reserve(src.size());
+
+    for (size_t i = 0; i < src.size(); ++i)
+    {
+      char c = src[i];
+      char next = (i + 1 < src.size()) ? src[i + 1] : '\0';
+
+      if (c == '"' || c == '\'') {
+        size_t start = i++;
+        while (i < src.size() && src[i] != c && src[i] != '\n') {
+          if (src[i] == '\\')++i;
+          ++i;
+        }
+        i = std::min(i, src.size() - 1);
+        res.append(src, start, i - start + 1);
+      } else if (c == '/' && next == '/') {
+        i = src.find('\n', i);
+        if (i == std::string::npos)break;
+        res += '\n';
+      } else if (c == '/' && next == '*') {
+        i = src.find("*/", i + 2);
+        if (i == std::string::npos)break;
+        ++i;
+        res += ' ';
+      } else {
+        res += c;
+      }
+    }
+    return res;
+  }
+
+  // next ';' that isn't inside a string or char literal
+  size_t findStatementEnd(std::string_view code)
+  {
+    char quote = '\0';
+    for (size_t i = 0; i < code.size(); ++i)
+    {
+      char c = code[i];
+      if (quote) {
+        if (c == '\\')++i;
+        else if (c == quote)quote = '\0';
+      }
+      else if (c == '"' || c == '\'')quote = c;
+      else if (c == ';')return i;
+    }
+    return std::string_view::npos;
+  }
+
   std::unordered_map<std::string, std::string> parseAttributes(const std::string& attrText) {
     std::unordered_map<std::string, std::string> result;
     std::string text = trim(attrText);
@@ -93,76 +164,102 @@ namespace
 
 Utils::CPP::Struct Utils::CPP::parseDataStruct(const std::string &sourceCode, const std::string &structName)
 {
-  // remove line and multi-line comments
-  auto code = std::regex_replace(sourceCode, std::regex(R"(//[^\n]*)"), "");
-  code = std::regex_replace(code, std::regex(R"(/\*[\s\S]*?\*/)"), "");
+  // only 'P64_DATA' (named "Data") is supported for now
+  if (structName != "Data")return {};
 
-  std::vector<Struct> structs{};
+  // scripts get parsed again on every change, most of the time only the code outside the struct changed
+  auto cacheKey = Hash::xxh64(sourceCode, Hash::xxh64(structName));
+  {
+    std::lock_guard lock{cacheMtx};
+    auto it = structCache.find(cacheKey);
+    if (it != structCache.end())return it->second;
+  }
 
-  // match all structs to get the body of it
-  std::regex structRegex(R"(P64_DATA\(([\s\S]*?)\);)");
+  auto code = stripComments(sourceCode);
+  Struct s{.name = "Data"};
 
-  std::smatch structMatch;
-  auto structBegin = code.cbegin();
+  constexpr std::string_view MACRO_START{"P64_DATA("};
+  auto bodyStart = code.find(MACRO_START);
+  auto bodyEnd = bodyStart == std::string::npos ? bodyStart : code.find(");", bodyStart);
+  if (bodyEnd == std::string::npos)return {};
+  bodyStart += MACRO_START.size();
 
-  while (std::regex_search(structBegin, code.cend(), structMatch, structRegex))
+  std::string_view body{code.data() + bodyStart, bodyEnd - bodyStart};
+  while (!body.empty())
   {
-    Struct s{.name = "Data"};
-    if (s.name != structName)continue;
+    auto stmtEnd = findStatementEnd(body);
+    if (stmtEnd == std::string_view::npos)break; // no ';', not a field
+    auto stmt = trimSpace(body.substr(0, stmtEnd));
+    body.remove_prefix(stmtEnd + 1);
 
-    std::string body = structMatch[1];
+    // attributes, e.g. '[[P64::Name("Speed")]]'
+    std::unordered_map<std::string, std::string> attr{};
+    while (stmt.starts_with("[["))
+    {
+      auto attrEnd = stmt.find("]]");
+      if (attrEnd == std::string_view::npos)break;
+      attr.merge(parseAttributes(std::string{stmt.substr(2, attrEnd - 2)}));
+      stmt = trimSpace(stmt.substr(attrEnd + 2));
+    }
 
-    // Regex for attributes + field lines
-    std::regex fieldRegex(
-      R"((\[\[\s*([^\]]+)\s*\]\]\s*)?([\w:<>]+)\s+(\w+)(\[[0-9]+\])?(?:\s*\=(.*))?\s*;)"
-    );
+    // '<type> <name>[<size>] = <default>'
+    auto assignPos = stmt.find('=');
+    auto defaultValue = assignPos == std::string_view::npos ? std::string_view{} : trimSpace(stmt.substr(assignPos + 1));
+    auto decl = trimSpace(stmt.substr(0, assignPos));
 
-    std::smatch fieldMatch;
-    auto fieldBegin = body.cbegin();
+    std::string_view arraySize{};
+    if (decl.ends_with(']')) {
+      auto arrayStart = decl.rfind('[');
+      if (arrayStart == std::string_view::npos)continue;
+      arraySize = decl.substr(arrayStart + 1, decl.size() - arrayStart - 2);
+      if (arraySize.empty() || !std::all_of(arraySize.begin(), arraySize.end(), isDigit))continue;
+      decl = trimSpace(decl.substr(0, arrayStart));
+    }
 
-    while (std::regex_search(fieldBegin, body.cend(), fieldMatch, fieldRegex))
-    {
-      Field field{
-        .type = fromString(fieldMatch[3]),
-        .dataSize = getTypeSize(fromString(fieldMatch[3])),
-        .name = fieldMatch[4],
-        .attr = parseAttributes(fieldMatch[2]),
-        .defaultValue = fieldMatch[6],
-      };
-
-      if(field.type == DataType::string) {
-        try
-        {
-          auto strSize = fieldMatch[5].str(); // -> [42]
-          field.dataSize = std::stoul(strSize.substr(1, strSize.size() - 2)); // parse without brackets
-        } catch(...) {
-          Logger::log(
-            "Failed to parse size for string field: " + field.name + ", defaulting to 4 bytes.",
-            Logger::LEVEL_ERROR
-          );
-          field.dataSize = 4;
-        }
+    auto nameStart = decl.find_last_of(" \t\r\n");
+    if (nameStart == std::string_view::npos)continue; // needs both a type and a name
+    auto name = decl.substr(nameStart + 1);
+    decl = trimSpace(decl.substr(0, nameStart));
+    auto type = decl.substr(decl.find_last_of(" \t\r\n") + 1); // qualifiers in front are ignored
 
-      }
+    if (name.empty() || !std::all_of(name.begin(), name.end(), isWordChar))continue;
+    if (type.empty() || !std::all_of(type.begin(), type.end(), isTypeChar))continue;
 
-      s.fields.push_back(field);
-      fieldBegin = fieldMatch.suffix().first;
+    auto dataType = fromString(std::string{type});
+    Field field{
+      .type = dataType,
+      .dataSize = getTypeSize(dataType),
+      .name = std::string{name},
+      .attr = std::move(attr),
+      .defaultValue = std::string{defaultValue},
+    };
+
+    if (field.type == DataType::string) {
+      uint32_t strSize = 0;
+      auto res = std::from_chars(arraySize.data(), arraySize.data() + arraySize.size(), strSize);
+      if (arraySize.empty() || res.ec != std::errc{}) {
+        Logger::log(
+          "Failed to parse size for string field: " + field.name + ", defaulting to 4 bytes.",
+          Logger::LEVEL_ERROR
+        );
+        strSize = 4;
+      }
+      field.dataSize = strSize;
     }
 
-    //structs.push_back(std::move(s));
-    return s;
-    // structBegin = structMatch.suffix().first;
+    s.fields.push_back(std::move(field));
   }
 
-  return {};
+  std::lock_guard lock{cacheMtx};
+  if (structCache.size() >= MAX_CACHED_STRUCTS)structCache.clear();
+  structCache[cacheKey] = s;
+  return s;
 }
 
 bool Utils::CPP::hasFunction(const std::string&sourceCode, const std::string&retType, const std::string&name) {
-  // remove line and multi-line comments
-  auto code = std::regex_replace(sourceCode, std::regex(R"(//[^\n]*)"), "");
-  code = std::regex_replace(code, std::regex(R"(/\*[\s\S]*?\*/)"), "");
+  auto code = stripComments(sourceCode);
   // remove all spaces and newlines
-  code = std::regex_replace(code, std::regex(R"(\s+)"), "");
+  std::erase_if(code, [](char c) { return isspace((unsigned char)c); });
 
   auto expected = retType + name + "(";
   return code.find(expected) != std::string::npos;
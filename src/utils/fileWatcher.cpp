@@ -0,0 +1,316 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "fileWatcher.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#ifdef _WIN32
+  #include <windows.h>
+#elif __APPLE__
+  #include <CoreServices/CoreServices.h>
+#else
+  #include <sys/inotify.h>
+  #include <poll.h>
+  #include <unistd.h>
+#endif
+
+#include "logger.h"
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+  // time without new events before a batch is handed out
+  constexpr auto SETTLE_TIME = std::chrono::milliseconds(100);
+}
+
+struct Utils::FileWatcher::Impl
+{
+  std::mutex mtx{};
+  std::unordered_set<std::string> changed{};
+  bool needsRescan{false};
+  Clock::time_point lastEvent{};
+  bool running{false};
+
+  void push(const std::string &path) {
+    std::lock_guard lock{mtx};
+    changed.insert(path);
+    lastEvent = Clock::now();
+  }
+
+  void pushRescan() {
+    std::lock_guard lock{mtx};
+    needsRescan = true;
+    lastEvent = Clock::now();
+  }
+
+#ifdef _WIN32
+  struct WatchDir
+  {
+    fs::path path{};
+    HANDLE handle{INVALID_HANDLE_VALUE};
+    OVERLAPPED overlapped{};
+    alignas(DWORD) uint8_t buffer[64 * 1024]{};
+  };
+
+  std::vector<std::unique_ptr<WatchDir>> dirs{};
+  HANDLE stopEvent{nullptr};
+  std::thread thread{};
+
+  static bool requestChanges(WatchDir &dir) {
+    constexpr DWORD FILTER = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_DIR_NAME
+      | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+    return ReadDirectoryChangesW(dir.handle, dir.buffer, sizeof(dir.buffer), TRUE, FILTER, nullptr, &dir.overlapped, nullptr);
+  }
+
+  bool start(const std::vector<fs::path> &paths)
+  {
+    stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    for(auto &path : paths)
+    {
+      auto dir = std::make_unique<WatchDir>();
+      dir->path = path;
+      dir->handle = CreateFileW(path.wstring().c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+        OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr
+      );
+      if(dir->handle == INVALID_HANDLE_VALUE)return false;
+      dir->overlapped.hEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+      dirs.push_back(std::move(dir));
+      if(!requestChanges(*dirs.back()))return false;
+    }
+
+    thread = std::thread{[this]()
+    {
+      std::vector<HANDLE> handles{stopEvent};
+      for(auto &dir : dirs)handles.push_back(dir->overlapped.hEvent);
+
+      for(;;)
+      {
+        auto res = WaitForMultipleObjects(handles.size(), handles.data(), FALSE, INFINITE);
+        if(res == WAIT_OBJECT_0 || res == WAIT_FAILED)break;
+
+        auto &dir = *dirs[res - WAIT_OBJECT_0 - 1];
+        DWORD bytes = 0;
+        if(!GetOverlappedResult(dir.handle, &dir.overlapped, &bytes, FALSE) || bytes == 0) {
+          pushRescan(); // buffer overflowed, the event itself has no details
+        } else {
+          auto info = (const FILE_NOTIFY_INFORMATION*)dir.buffer;
+          for(;;) {
+            std::wstring name{info->FileName, info->FileNameLength / sizeof(WCHAR)};
+            push((dir.path / name).string());
+            if(info->NextEntryOffset == 0)break;
+            info = (const FILE_NOTIFY_INFORMATION*)((const uint8_t*)info + info->NextEntryOffset);
+          }
+        }
+        if(!requestChanges(dir))pushRescan();
+      }
+    }};
+    return true;
+  }
+
+  void stop()
+  {
+    if(stopEvent)SetEvent(stopEvent);
+    if(thread.joinable())thread.join();
+    for(auto &dir : dirs) {
+      CancelIo(dir->handle);
+      CloseHandle(dir->handle);
+      CloseHandle(dir->overlapped.hEvent);
+    }
+    dirs.clear();
+    if(stopEvent)CloseHandle(stopEvent);
+    stopEvent = nullptr;
+  }
+
+#elif __APPLE__
+  FSEventStreamRef stream{nullptr};
+  dispatch_queue_t queue{nullptr};
+
+  static void onEvents(ConstFSEventStreamRef, void *info, size_t count, void *paths,
+    const FSEventStreamEventFlags flags[], const FSEventStreamEventId[])
+  {
+    auto self = (Impl*)info;
+    constexpr FSEventStreamEventFlags FLAGS_LOST = kFSEventStreamEventFlagMustScanSubDirs
+      | kFSEventStreamEventFlagUserDropped | kFSEventStreamEventFlagKernelDropped;
+
+    for(size_t i=0; i<count; ++i) {
+      if(flags[i] & FLAGS_LOST) {
+        self->pushRescan();
+      } else {
+        self->push(((const char**)paths)[i]);
+      }
+    }
+  }
+
+  bool start(const std::vector<fs::path> &paths)
+  {
+    auto pathArray = CFArrayCreateMutable(nullptr, paths.size(), &kCFTypeArrayCallBacks);
+    for(auto &path : paths) {
+      auto str = CFStringCreateWithCString(nullptr, path.string().c_str(), kCFStringEncodingUTF8);
+      CFArrayAppendValue(pathArray, str);
+      CFRelease(str);
+    }
+
+    FSEventStreamContext context{0, this, nullptr, nullptr, nullptr};
+    stream = FSEventStreamCreate(nullptr, &onEvents, &context, pathArray, kFSEventStreamEventIdSinceNow,
+      0.05, kFSEventStreamCreateFlagFileEvents | kFSEventStreamCreateFlagNoDefer
+    );
+    CFRelease(pathArray);
+    if(!stream)return false;
+
+    queue = dispatch_queue_create("p64.fileWatcher", DISPATCH_QUEUE_SERIAL);
+    FSEventStreamSetDispatchQueue(stream, queue);
+    return FSEventStreamStart(stream);
+  }
+
+  void stop()
+  {
+    if(stream) {
+      FSEventStreamStop(stream);
+      FSEventStreamInvalidate(stream);
+      FSEventStreamRelease(stream);
+      stream = nullptr;
+    }
+    if(queue) {
+      dispatch_release(queue);
+      queue = nullptr;
+    }
+  }
+
+#else
+  int fd{-1};
+  int stopPipe[2]{-1, -1};
+  std::unordered_map<int, fs::path> watchPaths{}; // only used by the thread once started
+  std::thread thread{};
+
+  // inotify is not recursive, every directory needs its own watch (new ones are added as they appear)
+  bool addWatch(const fs::path &dir)
+  {
+    constexpr uint32_t MASK = IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY
+      | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+
+    int wd = inotify_add_watch(fd, dir.c_str(), MASK);
+    if(wd < 0)return false;
+    watchPaths[wd] = dir;
+
+    std::error_code err{};
+    for(auto &entry : fs::directory_iterator{dir, err}) {
+      if(entry.is_directory(err))addWatch(entry.path());
+    }
+    return true;
+  }
+
+  bool start(const std::vector<fs::path> &paths)
+  {
+    fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(fd < 0 || pipe(stopPipe) != 0)return false;
+    for(auto &path : paths) {
+      if(!addWatch(path))return false;
+    }
+
+    thread = std::thread{[this]()
+    {
+      alignas(inotify_event) char buffer[16 * 1024];
+      for(;;)
+      {
+        pollfd fds[2]{{fd, POLLIN, 0}, {stopPipe[0], POLLIN, 0}};
+        if(poll(fds, 2, -1) < 0)continue;
+        if(fds[1].revents)break;
+
+        for(;;)
+        {
+          auto len = read(fd, buffer, sizeof(buffer));
+          if(len <= 0)break;
+
+          for(char *ptr = buffer; ptr < buffer + len; )
+          {
+            auto event = (const inotify_event*)ptr;
+            ptr += sizeof(inotify_event) + event->len;
+
+            if(event->mask & IN_Q_OVERFLOW) {
+              pushRescan();
+              continue;
+            }
+            if(event->mask & IN_IGNORED) {
+              watchPaths.erase(event->wd);
+              continue;
+            }
+
+            auto it = watchPaths.find(event->wd);
+            if(it == watchPaths.end())continue;
+            auto path = event->len ? (it->second / event->name) : it->second;
+
+            if((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO)))addWatch(path);
+            push(path.string());
+          }
+        }
+      }
+    }};
+    return true;
+  }
+
+  void stop()
+  {
+    if(stopPipe[1] >= 0 && write(stopPipe[1], "x", 1) < 0) {
+      Utils::Logger::log("File watcher: failed to stop thread", Utils::Logger::LEVEL_WARN);
+    }
+    if(thread.joinable())thread.join();
+    for(int &f : {std::ref(fd), std::ref(stopPipe[0]), std::ref(stopPipe[1])}) {
+      if(f >= 0)close(f);
+      f = -1;
+    }
+    watchPaths.clear();
+  }
+#endif
+};
+
+Utils::FileWatcher::FileWatcher() = default;
+
+Utils::FileWatcher::~FileWatcher() {
+  stop();
+}
+
+bool Utils::FileWatcher::start(const std::vector<fs::path> &dirs)
+{
+  stop();
+  impl = std::make_unique<Impl>();
+  if(!impl->start(dirs)) {
+    Utils::Logger::log("File watcher not available, falling back to polling", Utils::Logger::LEVEL_WARN);
+    stop();
+    return false;
+  }
+  impl->running = true;
+  return true;
+}
+
+void Utils::FileWatcher::stop()
+{
+  if(!impl)return;
+  impl->stop();
+  impl.reset();
+}
+
+bool Utils::FileWatcher::isRunning() const {
+  return impl && impl->running;
+}
+
+Utils::FileWatcher::Changes Utils::FileWatcher::takeChanges()
+{
+  Changes res{};
+  if(!impl)return res;
+
+  std::lock_guard lock{impl->mtx};
+  if(Clock::now() - impl->lastEvent < SETTLE_TIME)return res;
+
+  res.paths.assign(impl->changed.begin(), impl->changed.end());
+  res.needsRescan = impl->needsRescan;
+  impl->changed.clear();
+  impl->needsRescan = false;
+  return res;
+}
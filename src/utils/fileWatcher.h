@@ -0,0 +1,52 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Utils
+{
+  /**
+   * Watches directories (recursively) for changes using the native API of the OS:
+   * inotify on Linux, ReadDirectoryChangesW on Windows and FSEvents on macOS.
+   * Events are collected in the background and handed out in batches, this never scans the directories itself.
+   */
+  class FileWatcher
+  {
+    public:
+      struct Changes
+      {
+        std::vector<std::string> paths{}; // files or directories that changed, were added or removed
+        bool needsRescan{false}; // events got lost (e.g. buffer overflow), only a full scan is reliable now
+      };
+
+    private:
+      struct Impl;
+      std::unique_ptr<Impl> impl;
+
+    public:
+      FileWatcher();
+      ~FileWatcher();
+
+      /**
+       * Starts watching, stops any previous watch first.
+       * @return false if not supported on this platform or any directory can't be watched
+       */
+      bool start(const std::vector<fs::path> &dirs);
+      void stop();
+
+      [[nodiscard]] bool isRunning() const;
+
+      /**
+       * Returns everything since the last call, once no new events arrived for a short time.
+       * That way saving a file (often a write + rename) ends up in a single batch.
+       */
+      Changes takeChanges();
+  };
+}
@@ -0,0 +1,64 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include "aabb.h"
+#include "glm/common.hpp"
+#include "glm/geometric.hpp"
+#include "glm/mat4x4.hpp"
+#include "glm/vec4.hpp"
+
+namespace Utils
+{
+  /**
+   * View frustum as 6 planes, for culling objects outside the camera.
+   * The near plane is taken from a -1 to 1 depth range, which is slightly loose for 0 to 1
+   * but never culls anything visible.
+   */
+  struct Frustum
+  {
+    glm::vec4 planes[6]{}; // xyz = normal pointing inside, w = distance
+
+    void fromMatrix(const glm::mat4 &viewProj)
+    {
+      glm::vec4 row0{viewProj[0][0], viewProj[1][0], viewProj[2][0], viewProj[3][0]};
+      glm::vec4 row1{viewProj[0][1], viewProj[1][1], viewProj[2][1], viewProj[3][1]};
+      glm::vec4 row2{viewProj[0][2], viewProj[1][2], viewProj[2][2], viewProj[3][2]};
+      glm::vec4 row3{viewProj[0][3], viewProj[1][3], viewProj[2][3], viewProj[3][3]};
+
+      planes[0] = row3 + row0;
+      planes[1] = row3 - row0;
+      planes[2] = row3 + row1;
+      planes[3] = row3 - row1;
+      planes[4] = row3 + row2;
+      planes[5] = row3 - row2;
+    }
+
+    /**
+     * Checks if a box, transformed by a matrix, is at least partially inside.
+     * @param aabb in local space, an empty box (see 'AABB::reset') counts as visible
+     */
+    [[nodiscard]] bool isVisible(const AABB &aabb, const glm::mat4 &mat) const
+    {
+      if(aabb.min.x > aabb.max.x)return true;
+
+      // world-space box around the transformed one
+      glm::vec3 center = mat * glm::vec4{aabb.getCenter(), 1.0f};
+      glm::vec3 halfExt = aabb.getHalfExtend();
+      glm::vec3 ext{
+        glm::abs(mat[0][0]) * halfExt.x + glm::abs(mat[1][0]) * halfExt.y + glm::abs(mat[2][0]) * halfExt.z,
+        glm::abs(mat[0][1]) * halfExt.x + glm::abs(mat[1][1]) * halfExt.y + glm::abs(mat[2][1]) * halfExt.z,
+        glm::abs(mat[0][2]) * halfExt.x + glm::abs(mat[1][2]) * halfExt.y + glm::abs(mat[2][2]) * halfExt.z,
+      };
+
+      for(const auto &plane : planes) {
+        glm::vec3 normal{plane};
+        float dist = glm::dot(normal, center) + plane.w;
+        float radius = glm::dot(glm::abs(normal), ext);
+        if(dist + radius < 0.0f)return false;
+      }
+      return true;
+    }
+  };
+}
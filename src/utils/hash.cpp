@@ -4,7 +4,10 @@
 */
 #include "hash.h"
 
+#include <cstdio>
+#include <cstring>
 #include <random>
+#include <vector>
 
 namespace
 {
@@ -14,9 +17,132 @@ namespace
     std::numeric_limits<std::uint64_t>::min(),
     std::numeric_limits<std::uint64_t>::max()
   );
+
+  constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87;
+  constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4F;
+  constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9;
+  constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63;
+  constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5;
+
+  constexpr size_t FILE_CHUNK_SIZE = 64 * 1024;
+
+  constexpr uint64_t rotl(uint64_t x, int r) {
+    return (x << r) | (x >> (64 - r));
+  }
+
+  // the editor only runs on little-endian hosts, so no byte swapping here
+  uint64_t read64(const uint8_t* p) {
+    uint64_t res;
+    memcpy(&res, p, sizeof(res));
+    return res;
+  }
+
+  uint32_t read32(const uint8_t* p) {
+    uint32_t res;
+    memcpy(&res, p, sizeof(res));
+    return res;
+  }
+
+  constexpr uint64_t round(uint64_t acc, uint64_t input) {
+    acc += input * PRIME64_2;
+    return rotl(acc, 31) * PRIME64_1;
+  }
+
+  constexpr uint64_t mergeRound(uint64_t acc, uint64_t val) {
+    acc ^= round(0, val);
+    return acc * PRIME64_1 + PRIME64_4;
+  }
 }
 
 uint64_t Utils::Hash::randomU64()
 {
   return dis(e);
 }
+
+Utils::Hash::XXH64::XXH64(uint64_t seed)
+  : seed{seed}
+{
+  acc[0] = seed + PRIME64_1 + PRIME64_2;
+  acc[1] = seed + PRIME64_2;
+  acc[2] = seed;
+  acc[3] = seed - PRIME64_1;
+}
+
+void Utils::Hash::XXH64::update(const void* data, size_t size)
+{
+  auto p = static_cast<const uint8_t*>(data);
+  auto end = p + size;
+  totalSize += size;
+
+  // fill up what was left over from the last call first
+  if(buffSize + size < sizeof(buff)) {
+    if(size)memcpy(buff + buffSize, p, size);
+    buffSize += size;
+    return;
+  }
+
+  if(buffSize) {
+    uint32_t fill = sizeof(buff) - buffSize;
+    memcpy(buff + buffSize, p, fill);
+    p += fill;
+    for(int i=0; i<4; ++i)acc[i] = round(acc[i], read64(buff + i*8));
+    buffSize = 0;
+  }
+
+  while(end - p >= 32) {
+    for(int i=0; i<4; ++i)acc[i] = round(acc[i], read64(p + i*8));
+    p += 32;
+  }
+
+  buffSize = end - p;
+  if(buffSize)memcpy(buff, p, buffSize);
+}
+
+bool Utils::Hash::XXH64::updateFile(const fs::path &path)
+{
+  FILE *file = fopen(path.string().c_str(), "rb");
+  if(!file)return false;
+
+  std::vector<uint8_t> chunk(FILE_CHUNK_SIZE);
+  size_t readSize;
+  while((readSize = fread(chunk.data(), 1, chunk.size(), file)) > 0) {
+    update(chunk.data(), readSize);
+  }
+  fclose(file);
+  return true;
+}
+
+uint64_t Utils::Hash::XXH64::digest() const
+{
+  uint64_t h;
+  if(totalSize >= 32) {
+    h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+    for(auto v : acc)h = mergeRound(h, v);
+  } else {
+    h = seed + PRIME64_5;
+  }
+  h += totalSize;
+
+  const uint8_t* p = buff;
+  const uint8_t* end = buff + buffSize;
+  for(; end - p >= 8; p += 8) {
+    h ^= round(0, read64(p));
+    h = rotl(h, 27) * PRIME64_1 + PRIME64_4;
+  }
+  if(end - p >= 4) {
+    h ^= (uint64_t)read32(p) * PRIME64_1;
+    h = rotl(h, 23) * PRIME64_2 + PRIME64_3;
+    p += 4;
+  }
+  for(; p < end; ++p) {
+    h ^= (*p) * PRIME64_5;
+    h = rotl(h, 11) * PRIME64_1;
+  }
+
+  h ^= h >> 33;
+  h *= PRIME64_2;
+  h ^= h >> 29;
+  h *= PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
@@ -3,8 +3,15 @@
 * @license MIT
 */
 #pragma once
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
 #include "SHA256.h"
 
+namespace fs = std::filesystem;
+
 namespace Utils::Hash
 {
   inline uint64_t sha256_64bit(const std::string& str)
@@ -23,37 +30,78 @@ namespace Utils::Hash
     return static_cast<uint32_t>(sha256_64bit(str) & 0xFFFFFFFF);
   }
 
+  namespace Detail
+  {
+    template<typename T>
+    constexpr std::array<T, 256> makeCrcTable(T poly)
+    {
+      std::array<T, 256> table{};
+      for (uint32_t i = 0; i < 256; i++) {
+        T crc = i;
+        for (int j = 0; j < 8; j++) {
+          crc = (crc & 1) ? ((crc >> 1) ^ poly) : (crc >> 1);
+        }
+        table[i] = crc;
+      }
+      return table;
+    }
+
+    constexpr auto CRC64_TABLE = makeCrcTable<uint64_t>(0xC96C5795D7870F42);
+    constexpr auto CRC32_TABLE = makeCrcTable<uint32_t>(0xEDB88320);
+  }
+
   constexpr uint64_t crc64(const std::string_view& str)
   {
     uint64_t crc = 0xFFFFFFFFFFFFFFFF;
     for (char c : str) {
-      crc ^= static_cast<uint8_t>(c);
-      for (int i = 0; i < 8; i++) {
-        if (crc & 1) {
-          crc = (crc >> 1) ^ 0xC96C5795D7870F42;
-        } else {
-          crc >>= 1;
-        }
-      }
+      crc = Detail::CRC64_TABLE[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
     }
     return crc;
   }
 
   constexpr uint32_t crc32(const std::string_view& str) {
     uint32_t crc = 0xFFFFFFFF;
-    for (size_t i = 0; i < str.size(); i++) {
-      crc ^= static_cast<uint8_t>(str[i]);
-      for (int j = 0; j < 8; j++) {
-        if (crc & 1) {
-          crc = (crc >> 1) ^ 0xEDB88320;
-        } else {
-          crc >>= 1;
-        }
-      }
+    for (char c : str) {
+      crc = Detail::CRC32_TABLE[(crc ^ static_cast<uint8_t>(c)) & 0xFF] ^ (crc >> 8);
     }
     return ~crc;
   }
 
+  /**
+   * Streaming XXH64, a fast non-cryptographic hash for content keys (build cache, thumbnails).
+   * Data can be fed in any chunks, the result only depends on the bytes as a whole.
+   * Not suited for anything security related, use 'sha256_64bit' there.
+   */
+  class XXH64
+  {
+    private:
+      uint64_t acc[4]{};
+      uint64_t seed{0};
+      uint64_t totalSize{0};
+      uint8_t buff[32]{};
+      uint32_t buffSize{0};
+
+    public:
+      explicit XXH64(uint64_t seed = 0);
+
+      void update(const void* data, size_t size);
+      void update(std::string_view str) { update(str.data(), str.size()); }
+
+      /**
+       * Hashes a file in chunks, without loading all of it.
+       * @return false if it couldn't be opened
+       */
+      bool updateFile(const fs::path &path);
+
+      [[nodiscard]] uint64_t digest() const;
+  };
+
+  inline uint64_t xxh64(std::string_view str, uint64_t seed = 0) {
+    XXH64 hash{seed};
+    hash.update(str);
+    return hash.digest();
+  }
+
   uint64_t randomU64();
 
   inline uint32_t randomU32() {
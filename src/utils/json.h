@@ -20,6 +20,24 @@ namespace Utils::JSON
   inline nlohmann::json loadFile(const fs::path &path) {
     return  loadFile(path.string());
   }
+
+  /**
+   * Compact MessagePack encoding of a document, for data that never ends up in the project itself
+   * (undo history, clipboard, caches). Smaller and a lot faster to read back than JSON text.
+   */
+  inline std::string toBinary(const nlohmann::json &doc) {
+    std::string res{};
+    nlohmann::json::to_msgpack(doc, res);
+    return res;
+  }
+
+  /**
+   * Reads data written by 'toBinary'.
+   * @return discarded value if the data is empty or invalid
+   */
+  inline nlohmann::json fromBinary(const std::string &data) {
+    return nlohmann::json::from_msgpack(data, true, false);
+  }
   /*
   template<typename RES, typename T>
   inline std::vector<RES> readArray(
@@ -4,24 +4,51 @@
 */
 #include "logger.h"
 
+#include <algorithm>
 #include <chrono>
 #include <iomanip>
 #include <mutex>
 #include <sstream>
+#include <vector>
 
 namespace
 {
   std::mutex mtx{};
-  constinit std::string buff{};
-  constexpr size_t MAX_BUFF_SIZE = 1024 * 64;
+  constexpr uint32_t MAX_LINES = 1024 * 32;
+
+  // ring buffer ('lineCount % MAX_LINES'), long builds just drop the oldest lines
+  constinit std::vector<Utils::Logger::Line> lines{};
+  constinit uint64_t firstLine{0};
+  constinit uint64_t lineCount{0};
+  constinit Utils::Logger::Line pendingLine{}; // raw output without a line break yet
 
   constinit Utils::Logger::LogOutputFunc outputFunc = nullptr;
   constinit int minLevel = Utils::Logger::LEVEL_INFO;
 
-  void trimBuffer()
+  void pushLine(Utils::Logger::Line &&line)
+  {
+    if(!line.text.empty() && line.text.back() == '\r')line.text.pop_back();
+    if(lines.empty())lines.resize(MAX_LINES);
+    lines[lineCount % MAX_LINES] = std::move(line);
+    ++lineCount;
+    firstLine = std::max(firstLine, lineCount - std::min<uint64_t>(lineCount, MAX_LINES));
+  }
+
+  void addText(const std::string &msg, int level)
   {
-    if (buff.length() > MAX_BUFF_SIZE) {
-      buff = buff.substr(buff.length() - MAX_BUFF_SIZE);
+    size_t pos = 0;
+    while(pos < msg.size())
+    {
+      auto end = msg.find('\n', pos);
+      pendingLine.level = std::max(pendingLine.level, level);
+      if(end == std::string::npos) {
+        pendingLine.text.append(msg, pos);
+        break;
+      }
+      pendingLine.text.append(msg, pos, end - pos);
+      pushLine(std::move(pendingLine));
+      pendingLine = {};
+      pos = end + 1;
     }
   }
 
@@ -77,12 +104,11 @@ void Utils::Logger::log(const std::string&msg, int level)
     return;
   }
 
-  buff += '[' + nowStr() + "] [" + levelTag(level) + "] " + msg + "\n";
-  trimBuffer();
-
+  auto line = '[' + nowStr() + "] [" + levelTag(level) + "] " + msg + "\n";
   if (outputFunc) {
-    outputFunc(buff);
-    buff = "";
+    outputFunc(line);
+  } else {
+    addText(line, level);
   }
 }
 
@@ -92,21 +118,36 @@ void Utils::Logger::logRaw(const std::string&msg, int level) {
     return;
   }
 
-  buff += msg;
-  trimBuffer();
-
   if (outputFunc) {
-    outputFunc(buff);
-    buff = "";
+    outputFunc(msg);
+  } else {
+    addText(msg, level);
   }
 }
 
 void Utils::Logger::clear() {
   std::lock_guard lock{mtx};
-  buff = "";
+  // numbers keep counting, so readers only miss what got cleared
+  lines.clear();
+  pendingLine = {};
+  firstLine = lineCount;
 }
 
 std::string Utils::Logger::getLog() {
   std::lock_guard lock{mtx};
-  return buff;
+  std::string res{};
+  for(uint64_t i = firstLine; i < lineCount; ++i) {
+    res += lines[i % MAX_LINES].text;
+    res += '\n';
+  }
+  return res + pendingLine.text;
+}
+
+uint64_t Utils::Logger::readLines(uint64_t nextLine, const std::function<void(uint64_t idx, const Line &line)> &func)
+{
+  std::lock_guard lock{mtx};
+  for(uint64_t i = std::max(nextLine, firstLine); i < lineCount; ++i) {
+    func(i, lines[i % MAX_LINES]);
+  }
+  return lineCount;
 }
@@ -4,6 +4,8 @@
 */
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
 
 namespace Utils::Logger
@@ -14,6 +16,12 @@ namespace Utils::Logger
 
   typedef void (*LogOutputFunc)(const std::string &msg);
 
+  struct Line
+  {
+    std::string text{}; // without the line break
+    int level{LEVEL_INFO};
+  };
+
   void setOutput(LogOutputFunc outFunc);
   void setMinLevel(int level);
   int getMinLevel();
@@ -22,4 +30,11 @@ namespace Utils::Logger
   void logRaw(const std::string &msg, int level = LEVEL_INFO);
   void clear();
   std::string getLog();
-}
\ No newline at end of file
+
+  /**
+   * Calls 'func' for each complete line since 'nextLine' that is still kept, oldest first.
+   * Lines are numbered from the start and never reused, so a caller can pick up where it left off.
+   * @return the number to pass in next time
+   */
+  uint64_t readLines(uint64_t nextLine, const std::function<void(uint64_t idx, const Line &line)> &func);
+}
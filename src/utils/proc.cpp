@@ -6,7 +6,9 @@
 
 #include <fstream>
 #include <memory>
+#include <mutex>
 #include <filesystem>
+#include <cerrno>
 #include <cstdio>
 
 #ifdef _WIN32
@@ -16,6 +18,8 @@
   #include <climits>
 #else
   #include <unistd.h>
+  #include <csignal>
+  #include <fcntl.h>
   #include <sys/wait.h>
 #endif
 
@@ -26,6 +30,32 @@ namespace fs = std::filesystem;
 namespace
 {
   constexpr uint32_t BUFF_SIZE = 128;
+  constexpr uint32_t READ_SIZE = 4096;
+
+  // a child inherits any pipe open at the time it starts, which keeps that pipe from ever reaching EOF.
+  // pipes are only inheritable while their own process starts, guarded by this
+  std::mutex spawnMtx{};
+
+#if defined(_WIN32)
+  // see 'CommandLineToArgvW' for the rules, backslashes only need escaping in front of quotes
+  std::string quoteArg(const std::string &arg)
+  {
+    if(!arg.empty() && arg.find_first_of(" \t\"") == std::string::npos)return arg;
+    std::string res{"\""};
+    uint32_t slashes = 0;
+    for(char c : arg) {
+      if(c == '\\') {
+        ++slashes;
+        continue;
+      }
+      res.append(c == '"' ? slashes * 2 + 1 : slashes, '\\');
+      res += c;
+      slashes = 0;
+    }
+    res.append(slashes * 2, '\\');
+    return res + "\"";
+  }
+#endif
 
   FILE* openPipeRead(const std::string &cmd)
   {
@@ -88,6 +118,183 @@ bool Utils::Proc::runSyncLogged(const std::string&cmd) {
   return closeStatusSuccess(status);
 }
 
+bool Utils::Proc::runSyncCapture(const std::string &cmd, std::string &output)
+{
+  FILE* pipe = openPipeRead(cmd + " 2>&1");
+  if(!pipe)return false;
+
+  char buffer[BUFF_SIZE];
+  while(fgets(buffer, BUFF_SIZE, pipe) != nullptr) {
+    output += buffer;
+  }
+  const int status = closePipe(pipe);
+  return closeStatusSuccess(status);
+}
+
+bool Utils::Proc::runArgsCapture(const std::vector<std::string> &args, std::string &output)
+{
+  if(args.empty())return false;
+  char buffer[READ_SIZE];
+
+#if defined(_WIN32)
+  std::string cmdLine{};
+  for(const auto &arg : args) {
+    if(!cmdLine.empty())cmdLine += ' ';
+    cmdLine += quoteArg(arg);
+  }
+
+  HANDLE pipeRead{}, pipeWrite{};
+  PROCESS_INFORMATION procInfo{};
+  {
+    std::lock_guard lock{spawnMtx};
+    SECURITY_ATTRIBUTES secAttr{sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE};
+    if(!CreatePipe(&pipeRead, &pipeWrite, &secAttr, 0))return false;
+    SetHandleInformation(pipeRead, HANDLE_FLAG_INHERIT, 0);
+
+    STARTUPINFOA startInfo{};
+    startInfo.cb = sizeof(startInfo);
+    startInfo.dwFlags = STARTF_USESTDHANDLES;
+    startInfo.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+    startInfo.hStdOutput = pipeWrite;
+    startInfo.hStdError = pipeWrite;
+
+    bool started = CreateProcessA(nullptr, cmdLine.data(), nullptr, nullptr, TRUE,
+      CREATE_NO_WINDOW, nullptr, nullptr, &startInfo, &procInfo);
+    CloseHandle(pipeWrite);
+    if(!started) {
+      CloseHandle(pipeRead);
+      return false;
+    }
+  }
+
+  DWORD count = 0;
+  while(ReadFile(pipeRead, buffer, sizeof(buffer), &count, nullptr) && count > 0) {
+    output.append(buffer, count);
+  }
+  CloseHandle(pipeRead);
+
+  WaitForSingleObject(procInfo.hProcess, INFINITE);
+  DWORD exitCode = 1;
+  GetExitCodeProcess(procInfo.hProcess, &exitCode);
+  CloseHandle(procInfo.hThread);
+  CloseHandle(procInfo.hProcess);
+  return exitCode == 0;
+#else
+  // prepared before forking, the child must not allocate
+  std::vector<char*> argv{};
+  for(const auto &arg : args)argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+
+  int fds[2];
+  pid_t pid;
+  {
+    std::lock_guard lock{spawnMtx};
+    if(pipe(fds) != 0)return false;
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+
+    pid = fork();
+    if(pid == 0) {
+      dup2(fds[1], STDOUT_FILENO);
+      dup2(fds[1], STDERR_FILENO);
+      execvp(argv[0], argv.data());
+      _exit(127);
+    }
+    close(fds[1]);
+  }
+  if(pid < 0) {
+    close(fds[0]);
+    return false;
+  }
+
+  ssize_t count;
+  while((count = read(fds[0], buffer, sizeof(buffer))) != 0) {
+    if(count < 0) {
+      if(errno == EINTR)continue;
+      break;
+    }
+    output.append(buffer, count);
+  }
+  close(fds[0]);
+
+  int status = 0;
+  while(waitpid(pid, &status, 0) < 0) {
+    if(errno != EINTR)return false;
+  }
+  return closeStatusSuccess(status);
+#endif
+}
+
+bool Utils::Proc::runSyncLines(const std::string &cmd, const std::function<bool(const std::string &line)> &onLine)
+{
+#if defined(_WIN32)
+  FILE* pipe = openPipeRead(cmd + " 2>&1");
+  if(!pipe)return false;
+
+  char buffer[BUFF_SIZE];
+  std::string line{};
+  bool keepReading = true;
+  while(fgets(buffer, BUFF_SIZE, pipe) != nullptr) {
+    line += buffer;
+    if(line.back() != '\n')continue;
+    if(keepReading)keepReading = onLine(line);
+    line.clear();
+  }
+  if(keepReading && !line.empty())onLine(line);
+  closePipe(pipe);
+  return true;
+#else
+  int fds[2];
+  if(pipe(fds) != 0)return false;
+
+  pid_t pid = fork();
+  if(pid < 0) {
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+
+  if(pid == 0) {
+    // own process group, so the shell and everything it started can be stopped at once
+    setpgid(0, 0);
+    dup2(fds[1], STDOUT_FILENO);
+    dup2(fds[1], STDERR_FILENO);
+    close(fds[0]);
+    close(fds[1]);
+    execl("/bin/sh", "sh", "-c", cmd.c_str(), (char*)nullptr);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  FILE* pipeRead = fdopen(fds[0], "r");
+  if(!pipeRead) {
+    close(fds[0]);
+    kill(-pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    return false;
+  }
+
+  char buffer[BUFF_SIZE];
+  std::string line{};
+  bool stopped = false;
+  while(fgets(buffer, BUFF_SIZE, pipeRead) != nullptr) {
+    line += buffer;
+    if(line.back() != '\n')continue;
+    if(!onLine(line)) {
+      stopped = true;
+      break;
+    }
+    line.clear();
+  }
+  if(!stopped && !line.empty())onLine(line);
+
+  if(stopped)kill(-pid, SIGTERM);
+  fclose(pipeRead);
+  waitpid(pid, nullptr, 0);
+  return true;
+#endif
+}
+
 std::string Utils::Proc::getSelfPath()
 {
 #ifdef _WIN32
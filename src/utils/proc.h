@@ -3,13 +3,37 @@
 * @license MIT
 */
 #pragma once
+#include <functional>
 #include <string>
+#include <vector>
 
 namespace Utils::Proc
 {
   std::string runSync(const std::string &cmd);
   bool runSyncLogged(const std::string &cmd);
 
+  /**
+   * Runs a command and appends its output (stdout + stderr) to 'output' instead of logging it.
+   * Safe to call from multiple threads at once.
+   * @return true if the command exited successfully
+   */
+  bool runSyncCapture(const std::string &cmd, std::string &output);
+
+  /**
+   * Same as 'runSyncCapture', but starts the program directly instead of going through a shell.
+   * Arguments are passed as they are, without any quoting or expansion.
+   * @param args path of the program (or name, looked up in 'PATH'), followed by its arguments
+   * @return true if the program was started and exited successfully
+   */
+  bool runArgsCapture(const std::vector<std::string> &args, std::string &output);
+
+  /**
+   * Runs a command and passes its output (stdout + stderr) line by line to a callback.
+   * If the callback returns false, the process is terminated (not supported on Windows, there it runs until it exits).
+   * @return false if the process could not be started
+   */
+  bool runSyncLines(const std::string &cmd, const std::function<bool(const std::string &line)> &onLine);
+
   std::string getSelfPath();
   std::string getSelfDir();
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include "toolchain.h"
 #include "logger.h"
 #include "proc.h"
+#include "fs.h"
+#include "string.h"
 #include <filesystem>
 #include <atomic>
 #include <thread>
@@ -109,21 +111,87 @@ bool Utils::Toolchain::isInstalling()
   return installing.load();
 }
 
-bool Utils::Toolchain::runCmdSyncLogged(const std::string &cmd)
+void Utils::Toolchain::cacheShellEnv()
+{
+  #if defined(_WIN32)
+    if(state.mingwPath.empty() || !shellEnvPath.empty())return;
+
+    std::string env{};
+    if(!runCmdSync("export -p", env))return;
+
+    // the rest is specific to the shell that printed it, 'N64_INST' is set by each build (see 'buildProject')
+    std::string script{};
+    for(auto line : Utils::splitString(env, '\n')) {
+      if(line.starts_with("declare -x PWD=") || line.starts_with("declare -x OLDPWD=")
+        || line.starts_with("declare -x SHLVL=") || line.starts_with("declare -x N64_INST=")
+      )continue;
+      script += line + "\n";
+    }
+
+    auto envPath = fs::temp_directory_path() / "pyrite64-shell-env.sh";
+    Utils::FS::saveTextFile(envPath, script);
+    shellEnvPath = envPath;
+  #endif
+}
+
+std::string Utils::Toolchain::getShellCmd(const std::string &cmd) const
 {
   #if defined(_WIN32)
     auto minttyPath = state.mingwPath / "usr" / "bin" / "bash.exe";
     //std::string command = minttyPath.string() + " --log - -w hide /bin/env MSYSTEM=MINGW64 " + cmd;
-    std::string command = minttyPath.string() + " -lc '" + cmd + "'";
+    std::string command = shellEnvPath.empty()
+      ? (minttyPath.string() + " -lc '" + cmd + "'")
+      : (minttyPath.string() + " -c '. \"" + shellEnvPath.string() + "\"; " + cmd + "'");
     //std::string command = cmd;
     for(char &c : command) {
       if(c == '\\')c = '/';
     }
-    return Utils::Proc::runSyncLogged(command);
-    //Utils::Logger::logRaw(run_bash(command));
-    //return true;
-    
+    return command;
+  #else
+    return cmd;
+  #endif
+}
+
+bool Utils::Toolchain::runCmdSyncLogged(const std::string &cmd)
+{
+  return Utils::Proc::runSyncLogged(getShellCmd(cmd));
+}
+
+bool Utils::Toolchain::runCmdSync(const std::string &cmd, std::string &output) const
+{
+  return Utils::Proc::runSyncCapture(getShellCmd(cmd), output);
+}
+
+fs::path Utils::Toolchain::getToolPath(const fs::path &tool) const
+{
+  #if defined(_WIN32)
+    auto res = tool;
+    // '/pyrite64-sdk/...' is relative to the msys root
+    auto str = tool.generic_string();
+    if(!state.mingwPath.empty() && str.starts_with("/"))res = state.mingwPath / str.substr(1);
+    if(!res.has_extension())res += ".exe";
+    return res;
   #else
-    return Utils::Proc::runSyncLogged(cmd);
+    return tool;
   #endif
 }
+
+bool Utils::Toolchain::runToolSync(const std::vector<std::string> &args, std::string &output) const
+{
+  if(args.empty())return false;
+  auto toolPath = getToolPath(args[0]);
+  std::error_code err{};
+  if(!fs::is_regular_file(toolPath, err))
+  {
+    std::string cmd{};
+    for(const auto &arg : args) {
+      if(!cmd.empty())cmd += ' ';
+      cmd += "\"" + arg + "\"";
+    }
+    return runCmdSync(cmd, output);
+  }
+
+  auto toolArgs = args;
+  toolArgs[0] = toolPath.string();
+  return Utils::Proc::runArgsCapture(toolArgs, output);
+}
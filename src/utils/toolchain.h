@@ -4,6 +4,7 @@
 */
 #pragma once
 #include <string>
+#include <vector>
 #include <filesystem>
 namespace fs = std::filesystem;
 
@@ -23,15 +24,41 @@ namespace Utils
 
     private:
       State state{};
+      fs::path shellEnvPath{}; // see 'cacheShellEnv', empty if not cached
+
+
+      // wraps a command to run in the toolchain's shell (msys on windows)
+      [[nodiscard]] std::string getShellCmd(const std::string &cmd) const;
+
+      // path of a tool as the OS sees it, the project stores it as an msys path on windows
+      [[nodiscard]] fs::path getToolPath(const fs::path &tool) const;
 
     public:
       void scan();
 
+      /**
+       * Stores the environment of the toolchain's login shell once, so later commands skip the login.
+       * On windows each command otherwise starts a full 'bash -l', which is slow. Does nothing on linux.
+       */
+      void cacheShellEnv();
+
       void install();
       bool isInstalling();
 
       bool runCmdSyncLogged(const std::string &cmd);
 
+      /**
+       * Same as 'runCmdSyncLogged', but collects the output instead, used by build jobs running in parallel.
+       */
+      bool runCmdSync(const std::string &cmd, std::string &output) const;
+
+      /**
+       * Runs a single tool (e.g. 'mksprite') directly, skipping the shell startup of 'runCmdSync'.
+       * Falls back to the shell if the tool can't be found as an executable.
+       * @param args path of the tool followed by its arguments, no quoting needed
+       */
+      bool runToolSync(const std::vector<std::string> &args, std::string &output) const;
+
       const State& getState() const { return state; }
   };
 }
@@ -0,0 +1,264 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#include "wav.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+
+#include "fs.h"
+
+namespace
+{
+  constexpr uint16_t FORMAT_PCM = 0x0001;
+  constexpr uint16_t FORMAT_FLOAT = 0x0003;
+  constexpr uint16_t FORMAT_EXTENSIBLE = 0xFFFE;
+
+  // resampling filter: zero-crossings on each side, and table entries between two of them
+  constexpr int32_t SINC_ZERO_CROSSINGS = 24;
+  constexpr int32_t SINC_TABLE_RES = 512;
+  // cutoff below the nyquist frequency, leaves room for the transition band of the filter
+  constexpr double SINC_CUTOFF = 0.97;
+
+  uint32_t readLE(const uint8_t* data, uint32_t bytes) {
+    uint32_t res = 0;
+    for(uint32_t i=0; i<bytes; ++i)res |= (uint32_t)data[i] << (i*8);
+    return res;
+  }
+
+  void writeLE(std::string &out, uint32_t value, uint32_t bytes) {
+    for(uint32_t i=0; i<bytes; ++i)out.push_back((char)((value >> (i*8)) & 0xFF));
+  }
+
+  float readSample(const uint8_t* data, uint32_t bits, bool isFloat)
+  {
+    if(isFloat) {
+      float res;
+      uint32_t raw = readLE(data, 4);
+      memcpy(&res, &raw, 4);
+      return std::isfinite(res) ? res : 0.0f;
+    }
+    // 8-bit is the only unsigned one
+    if(bits == 8)return ((int32_t)data[0] - 128) / 128.0f;
+
+    uint32_t bytes = bits / 8;
+    uint32_t raw = readLE(data, bytes) << (32 - bits);
+    return (float)((int32_t)raw / 2147483648.0);
+  }
+
+  // windowed sinc (blackman), sampled from 0 to the last zero-crossing
+  const std::vector<float>& getSincTable()
+  {
+    static std::vector<float> table = []() {
+      std::vector<float> res(SINC_ZERO_CROSSINGS * SINC_TABLE_RES + 1);
+      for(uint32_t i=0; i<res.size(); ++i) {
+        double x = (double)i / SINC_TABLE_RES;
+        double sinc = i == 0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x);
+        double w = (x / SINC_ZERO_CROSSINGS + 1.0) * 0.5;
+        double window = 0.42 - 0.5 * std::cos(2.0 * std::numbers::pi * w) + 0.08 * std::cos(4.0 * std::numbers::pi * w);
+        res[i] = (float)(sinc * window);
+      }
+      res.back() = 0.0f;
+      return res;
+    }();
+    return table;
+  }
+
+  float sampleSinc(const std::vector<float> &table, double x)
+  {
+    double pos = std::abs(x) * SINC_TABLE_RES;
+    auto idx = (uint32_t)pos;
+    if(idx >= table.size() - 1)return 0.0f;
+    float frac = (float)(pos - idx);
+    return table[idx] + (table[idx+1] - table[idx]) * frac;
+  }
+}
+
+bool Utils::Wav::readInfo(const fs::path &path, Info &info)
+{
+  FILE* file = fopen(path.string().c_str(), "rb");
+  if(!file)return false;
+
+  uint8_t header[12]{};
+  bool valid = fread(header, 1, sizeof(header), file) == sizeof(header)
+    && memcmp(header, "RIFF", 4) == 0 && memcmp(header + 8, "WAVE", 4) == 0;
+
+  // skips over the chunks instead of reading them, the data is usually the biggest part of the file
+  uint16_t format = 0;
+  uint32_t bits = 0;
+  uint32_t blockAlign = 0;
+  uint32_t dataSize = 0;
+  uint8_t chunkHeader[8]{};
+  while(valid && fread(chunkHeader, 1, sizeof(chunkHeader), file) == sizeof(chunkHeader))
+  {
+    uint32_t chunkSize = readLE(chunkHeader + 4, 4);
+    uint32_t skip = chunkSize + (chunkSize & 1);
+    if(memcmp(chunkHeader, "fmt ", 4) == 0 && chunkSize >= 16) {
+      uint8_t fmt[26]{};
+      uint32_t readSize = std::min<uint32_t>(chunkSize, sizeof(fmt));
+      if(fread(fmt, 1, readSize, file) != readSize)break;
+      format = readLE(fmt, 2);
+      info.channels = readLE(fmt + 2, 2);
+      info.sampleRate = readLE(fmt + 4, 4);
+      blockAlign = readLE(fmt + 12, 2);
+      bits = readLE(fmt + 14, 2);
+      if(format == FORMAT_EXTENSIBLE && readSize >= 26)format = readLE(fmt + 24, 2);
+      skip -= readSize;
+    } else if(memcmp(chunkHeader, "data", 4) == 0) {
+      dataSize = chunkSize;
+    }
+    if(fseek(file, skip, SEEK_CUR) != 0)break;
+  }
+  fclose(file);
+
+  bool isFloat = format == FORMAT_FLOAT;
+  if(!valid || (format != FORMAT_PCM && !isFloat))return false;
+  if(isFloat ? bits != 32 : (bits != 8 && bits != 16 && bits != 24 && bits != 32))return false;
+  if(info.channels == 0 || info.sampleRate == 0 || blockAlign < info.channels * (bits / 8))return false;
+  info.frameCount = dataSize / blockAlign;
+  return true;
+}
+
+bool Utils::Wav::load(const fs::path &path, PCM &pcm)
+{
+  auto file = Utils::FS::loadTextFile(path);
+  auto data = (const uint8_t*)file.data();
+  if(file.size() < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0)return false;
+
+  uint16_t format = 0;
+  uint32_t channels = 0;
+  uint32_t sampleRate = 0;
+  uint32_t bits = 0;
+  uint32_t blockAlign = 0;
+  const uint8_t* samples = nullptr;
+  uint32_t samplesSize = 0;
+
+  uint32_t pos = 12;
+  while(pos + 8 <= file.size())
+  {
+    uint32_t chunkSize = readLE(data + pos + 4, 4);
+    const uint8_t* chunk = data + pos + 8;
+    uint32_t available = std::min<uint32_t>(chunkSize, file.size() - pos - 8);
+
+    if(memcmp(data + pos, "fmt ", 4) == 0 && available >= 16) {
+      format = readLE(chunk, 2);
+      channels = readLE(chunk + 2, 2);
+      sampleRate = readLE(chunk + 4, 4);
+      blockAlign = readLE(chunk + 12, 2);
+      bits = readLE(chunk + 14, 2);
+      // the actual format is the start of the sub-format GUID
+      if(format == FORMAT_EXTENSIBLE && available >= 26)format = readLE(chunk + 24, 2);
+    } else if(memcmp(data + pos, "data", 4) == 0) {
+      samples = chunk;
+      samplesSize = available;
+    }
+    pos += 8 + chunkSize + (chunkSize & 1); // chunks are padded to 2 bytes
+  }
+
+  bool isFloat = format == FORMAT_FLOAT;
+  if(format != FORMAT_PCM && !isFloat)return false;
+  if(isFloat ? bits != 32 : (bits != 8 && bits != 16 && bits != 24 && bits != 32))return false;
+  if(!samples || channels == 0 || sampleRate == 0 || blockAlign < channels * (bits / 8))return false;
+
+  uint32_t frames = samplesSize / blockAlign;
+  pcm.sampleRate = sampleRate;
+  pcm.channels = channels;
+  pcm.samples.resize(frames * channels);
+  for(uint32_t f=0; f<frames; ++f) {
+    for(uint32_t c=0; c<channels; ++c) {
+      pcm.samples[f*channels + c] = readSample(samples + f*blockAlign + c*(bits/8), bits, isFloat);
+    }
+  }
+  return true;
+}
+
+bool Utils::Wav::save(const fs::path &path, const PCM &pcm)
+{
+  uint32_t dataSize = pcm.samples.size() * sizeof(int16_t);
+  std::string out{};
+  out.reserve(44 + dataSize);
+  out += "RIFF";
+  writeLE(out, 36 + dataSize, 4);
+  out += "WAVEfmt ";
+  writeLE(out, 16, 4);
+  writeLE(out, FORMAT_PCM, 2);
+  writeLE(out, pcm.channels, 2);
+  writeLE(out, pcm.sampleRate, 4);
+  writeLE(out, pcm.sampleRate * pcm.channels * sizeof(int16_t), 4);
+  writeLE(out, pcm.channels * sizeof(int16_t), 2);
+  writeLE(out, 16, 2);
+  out += "data";
+  writeLE(out, dataSize, 4);
+
+  // fixed seed, the same input always gives the same file
+  uint32_t rng = 0x12345678;
+  auto nextRand = [&rng]() {
+    rng = rng * 1664525u + 1013904223u;
+    return (float)(rng >> 8) / (float)(1 << 24);
+  };
+
+  for(float s : pcm.samples) {
+    float dither = nextRand() - nextRand();
+    auto value = (int32_t)std::lround(s * 32767.0f + dither);
+    writeLE(out, (uint16_t)(int16_t)std::clamp(value, -32768, 32767), 2);
+  }
+
+  FILE *file = fopen(path.string().c_str(), "wb");
+  if(!file)return false;
+  bool success = fwrite(out.data(), 1, out.size(), file) == out.size();
+  return fclose(file) == 0 && success;
+}
+
+void Utils::Wav::toMono(PCM &pcm)
+{
+  if(pcm.channels <= 1)return;
+  uint32_t frames = pcm.getFrameCount();
+  for(uint32_t f=0; f<frames; ++f) {
+    float sum = 0.0f;
+    for(uint32_t c=0; c<pcm.channels; ++c)sum += pcm.samples[f*pcm.channels + c];
+    pcm.samples[f] = sum / pcm.channels;
+  }
+  pcm.samples.resize(frames);
+  pcm.channels = 1;
+}
+
+void Utils::Wav::resample(PCM &pcm, uint32_t sampleRate)
+{
+  if(sampleRate == 0 || pcm.sampleRate == sampleRate || pcm.channels == 0)return;
+
+  const auto &table = getSincTable();
+  double step = (double)pcm.sampleRate / sampleRate; // in source frames per output frame
+  double cutoff = std::min(1.0, 1.0 / step) * SINC_CUTOFF;
+  double halfWidth = SINC_ZERO_CROSSINGS / cutoff;
+
+  auto framesIn = (int64_t)pcm.getFrameCount();
+  auto framesOut = (uint32_t)std::ceil(framesIn / step);
+  std::vector<float> res(framesOut * pcm.channels);
+  std::vector<double> sums(pcm.channels);
+
+  for(uint32_t f=0; f<framesOut; ++f)
+  {
+    double t = f * step;
+    auto first = std::max<int64_t>(0, (int64_t)std::ceil(t - halfWidth));
+    auto last = std::min<int64_t>(framesIn - 1, (int64_t)std::floor(t + halfWidth));
+
+    std::fill(sums.begin(), sums.end(), 0.0);
+    double weightSum = 0.0;
+    for(int64_t i=first; i<=last; ++i) {
+      double weight = sampleSinc(table, (t - i) * cutoff);
+      weightSum += weight;
+      for(uint32_t c=0; c<pcm.channels; ++c)sums[c] += pcm.samples[i*pcm.channels + c] * weight;
+    }
+
+    // normalized to keep the gain at 1, also near the start and end where the filter is cut off
+    double norm = std::abs(weightSum) > 1e-9 ? 1.0 / weightSum : 0.0;
+    for(uint32_t c=0; c<pcm.channels; ++c)res[f*pcm.channels + c] = (float)(sums[c] * norm);
+  }
+
+  pcm.samples = std::move(res);
+  pcm.sampleRate = sampleRate;
+}
@@ -0,0 +1,57 @@
+/**
+* @copyright 2026 - Max Bebök
+* @license MIT
+*/
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace Utils::Wav
+{
+  struct PCM
+  {
+    uint32_t sampleRate{};
+    uint32_t channels{};
+    std::vector<float> samples{}; // interleaved, in the range [-1, 1]
+
+    [[nodiscard]] uint32_t getFrameCount() const {
+      return channels ? samples.size() / channels : 0;
+    }
+  };
+
+  struct Info
+  {
+    uint32_t sampleRate{};
+    uint32_t channels{};
+    uint32_t frameCount{};
+  };
+
+  /**
+   * Reads only the format and length of an uncompressed WAV file, same formats as 'load' are accepted.
+   * @return false if the file can't be read or uses a different format
+   */
+  bool readInfo(const fs::path &path, Info &info);
+
+  /**
+   * Loads an uncompressed WAV file (8/16/24/32-bit integer or 32-bit float, incl. 'WAVE_FORMAT_EXTENSIBLE').
+   * @return false if the file can't be read or uses a different format (e.g. ADPCM)
+   */
+  bool load(const fs::path &path, PCM &pcm);
+
+  /**
+   * Saves as a 16-bit WAV file, with TPDF dither.
+   */
+  bool save(const fs::path &path, const PCM &pcm);
+
+  // averages all channels into one
+  void toMono(PCM &pcm);
+
+  /**
+   * Changes the sample rate with a windowed-sinc filter, which also filters out anything above the new nyquist frequency.
+   * NOP if the rate is already the same.
+   */
+  void resample(PCM &pcm, uint32_t sampleRate);
+}